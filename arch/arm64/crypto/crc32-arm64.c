@@ -22,6 +22,9 @@
 #include <linux/kernel.h>
 #include <linux/module.h>
 #include <linux/string.h>
+#include <linux/slab.h>
+#include <linux/ktime.h>
+#include <linux/sizes.h>
 
 #include <crypto/internal/hash.h>
 
@@ -42,6 +45,15 @@ static u32 crc32_arm64_le_hw(u32 crc, const u8 *p, unsigned int len)
 {
 	s64 length = len;
 
+	while (length >= 4 * sizeof(u64)) {
+		CRC32X(crc, get_unaligned_le64(p));
+		CRC32X(crc, get_unaligned_le64(p + 8));
+		CRC32X(crc, get_unaligned_le64(p + 16));
+		CRC32X(crc, get_unaligned_le64(p + 24));
+		p += 4 * sizeof(u64);
+		length -= 4 * sizeof(u64);
+	}
+
 	while ((length -= sizeof(u64)) >= 0) {
 		CRC32X(crc, get_unaligned_le64(p));
 		p += sizeof(u64);
@@ -66,6 +78,16 @@ static u32 crc32c_arm64_le_hw(u32 crc, const u8 *p, unsigned int len)
 {
 	s64 length = len;
 
+	/* metadata blocks are large, take them 32 bytes per iteration */
+	while (length >= 4 * sizeof(u64)) {
+		CRC32CX(crc, get_unaligned_le64(p));
+		CRC32CX(crc, get_unaligned_le64(p + 8));
+		CRC32CX(crc, get_unaligned_le64(p + 16));
+		CRC32CX(crc, get_unaligned_le64(p + 24));
+		p += 4 * sizeof(u64);
+		length -= 4 * sizeof(u64);
+	}
+
 	while ((length -= sizeof(u64)) >= 0) {
 		CRC32CX(crc, get_unaligned_le64(p));
 		p += sizeof(u64);
@@ -261,6 +283,60 @@ static struct shash_alg crc32c_alg = {
 	}
 };
 
+static bool bench;
+module_param(bench, bool, 0444);
+MODULE_PARM_DESC(bench, "Compare against the generic driver at load time");
+
+#define CRC32_BENCH_LEN		4096
+#define CRC32_BENCH_LOOPS	256
+
+/*
+ * Time a 4KB digest, the f2fs checkpoint and ext4 metadata block size, on
+ * the driver an allocation of @name resolves to and on @name-generic.
+ */
+static void __init crc32_bench(const char *name)
+{
+	static const char * const suffix[] = { "", "-generic" };
+	char drv[CRYPTO_MAX_ALG_NAME];
+	struct crypto_shash *tfm;
+	u8 *buf, out[CHKSUM_DIGEST_SIZE];
+	ktime_t start;
+	s64 ns;
+	int i, j;
+
+	buf = kmalloc(CRC32_BENCH_LEN, GFP_KERNEL);
+	if (!buf)
+		return;
+	for (i = 0; i < CRC32_BENCH_LEN; i++)
+		buf[i] = i * 7;
+
+	for (i = 0; i < ARRAY_SIZE(suffix); i++) {
+		snprintf(drv, sizeof(drv), "%s%s", name, suffix[i]);
+		tfm = crypto_alloc_shash(drv, 0, 0);
+		if (IS_ERR(tfm))
+			continue;
+
+		{
+			SHASH_DESC_ON_STACK(desc, tfm);
+
+			desc->tfm = tfm;
+			desc->flags = 0;
+			start = ktime_get();
+			for (j = 0; j < CRC32_BENCH_LOOPS; j++)
+				crypto_shash_digest(desc, buf, CRC32_BENCH_LEN, out);
+			ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+		}
+
+		pr_info("%s: %s %lld MB/s\n", drv,
+			crypto_tfm_alg_driver_name(crypto_shash_tfm(tfm)),
+			div64_s64((s64)CRC32_BENCH_LEN * CRC32_BENCH_LOOPS *
+				  NSEC_PER_SEC / SZ_1M, max_t(s64, ns, 1)));
+		crypto_free_shash(tfm);
+	}
+
+	kfree(buf);
+}
+
 static int __init crc32_mod_init(void)
 {
 	int err;
@@ -277,6 +353,11 @@ static int __init crc32_mod_init(void)
 		return err;
 	}
 
+	if (bench) {
+		crc32_bench("crc32");
+		crc32_bench("crc32c");
+	}
+
 	return 0;
 }
 
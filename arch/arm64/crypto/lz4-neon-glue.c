@@ -0,0 +1,220 @@
+/*
+ * LZ4 compression with a NEON accelerated decompressor
+ *
+ * Compression is done by the generic library code. Decompression runs
+ * the bulk of each block through a NEON fast loop and lets the generic
+ * safe decoder finish the tail, where bounds checking matters.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ */
+
+#include <linux/crypto.h>
+#include <linux/init.h>
+#include <linux/kernel.h>
+#include <linux/lz4.h>
+#include <linux/module.h>
+#include <linux/vmalloc.h>
+#include <asm/neon.h>
+
+MODULE_DESCRIPTION("LZ4 compression with NEON accelerated decompression");
+MODULE_LICENSE("GPL v2");
+MODULE_ALIAS_CRYPTO("lz4");
+
+/* keep the fast loop this far from both buffer ends */
+#define LZ4_NEON_MARGIN		32
+
+/* size of the block used by the self-test */
+#define LZ4_NEON_TEST_SIZE	PAGE_SIZE
+
+asmlinkage void lz4_decompress_neon_fast(u8 **dst, const u8 **src,
+					 const u8 *ip_limit, u8 *op_limit,
+					 const u8 *dst_start);
+
+struct lz4_neon_ctx {
+	void *lz4_comp_mem;
+};
+
+static int lz4_neon_decompress(const u8 *src, unsigned int slen, u8 *dst,
+			       unsigned int *dlen)
+{
+	const u8 *ip = src;
+	u8 *op = dst;
+	int ret;
+
+	if (slen > LZ4_NEON_MARGIN && *dlen > LZ4_NEON_MARGIN) {
+		kernel_neon_begin_partial(2);
+		lz4_decompress_neon_fast(&op, &ip, src + slen - LZ4_NEON_MARGIN,
+					 dst + *dlen - LZ4_NEON_MARGIN, dst);
+		kernel_neon_end();
+	}
+
+	ret = LZ4_decompress_safe_usingDict((const char *)ip, (char *)op,
+					    src + slen - ip,
+					    dst + *dlen - op,
+					    (const char *)dst, op - dst);
+	if (ret < 0)
+		return -EINVAL;
+
+	*dlen = op - dst + ret;
+	return 0;
+}
+
+static int lz4_neon_init(struct crypto_tfm *tfm)
+{
+	struct lz4_neon_ctx *ctx = crypto_tfm_ctx(tfm);
+
+	ctx->lz4_comp_mem = vmalloc(LZ4_MEM_COMPRESS);
+	if (!ctx->lz4_comp_mem)
+		return -ENOMEM;
+
+	return 0;
+}
+
+static void lz4_neon_exit(struct crypto_tfm *tfm)
+{
+	struct lz4_neon_ctx *ctx = crypto_tfm_ctx(tfm);
+
+	vfree(ctx->lz4_comp_mem);
+}
+
+static int lz4_neon_compress_crypto(struct crypto_tfm *tfm, const u8 *src,
+				    unsigned int slen, u8 *dst,
+				    unsigned int *dlen)
+{
+	struct lz4_neon_ctx *ctx = crypto_tfm_ctx(tfm);
+	size_t tmp_len = *dlen;
+	int err;
+
+	err = lz4_compress(src, slen, dst, &tmp_len, ctx->lz4_comp_mem);
+	if (err < 0)
+		return -EINVAL;
+
+	*dlen = tmp_len;
+	return 0;
+}
+
+static int lz4_neon_decompress_crypto(struct crypto_tfm *tfm, const u8 *src,
+				      unsigned int slen, u8 *dst,
+				      unsigned int *dlen)
+{
+	return lz4_neon_decompress(src, slen, dst, dlen);
+}
+
+static struct crypto_alg alg_lz4_neon = {
+	.cra_name		= "lz4",
+	.cra_driver_name	= "lz4-neon",
+	.cra_priority		= 200,
+	.cra_flags		= CRYPTO_ALG_TYPE_COMPRESS,
+	.cra_ctxsize		= sizeof(struct lz4_neon_ctx),
+	.cra_module		= THIS_MODULE,
+	.cra_list		= LIST_HEAD_INIT(alg_lz4_neon.cra_list),
+	.cra_init		= lz4_neon_init,
+	.cra_exit		= lz4_neon_exit,
+	.cra_u			= { .compress = {
+	.coa_compress		= lz4_neon_compress_crypto,
+	.coa_decompress		= lz4_neon_decompress_crypto } }
+};
+
+/*
+ * Fill the test block with a mix of literal runs, short and long
+ * distance matches and overlapping repeats, so that every copy path of
+ * the fast loop is taken.
+ */
+static void __init lz4_neon_fill_test(u8 *buf, size_t len)
+{
+	u32 seed = 0x12345678;
+	size_t i = 0;
+
+	while (i < len) {
+		unsigned int kind, run, j;
+
+		seed = seed * 1103515245 + 12345;
+		kind = (seed >> 16) & 3;
+		run = min_t(size_t, ((seed >> 8) & 63) + 1, len - i);
+
+		for (j = 0; j < run; j++, i++) {
+			switch (kind) {
+			case 0:		/* literals */
+				seed = seed * 1103515245 + 12345;
+				buf[i] = seed >> 24;
+				break;
+			case 1:		/* repeated byte */
+				buf[i] = (i >= 1) ? buf[i - 1] : 0;
+				break;
+			case 2:		/* short offset */
+				buf[i] = (i >= 5) ? buf[i - 5] : 0x5a;
+				break;
+			default:	/* long offset */
+				buf[i] = (i >= 300) ? buf[i - 300] : j;
+				break;
+			}
+		}
+	}
+}
+
+/* The NEON path must be bit-identical to the generic decoder */
+static int __init lz4_neon_selftest(void)
+{
+	size_t clen = LZ4_COMPRESSBOUND(LZ4_NEON_TEST_SIZE);
+	u8 *orig, *comp, *out_c, *out_neon;
+	unsigned int dlen = LZ4_NEON_TEST_SIZE;
+	void *wrkmem;
+	int ret = -ENOMEM;
+
+	orig = vmalloc(LZ4_NEON_TEST_SIZE);
+	comp = vmalloc(clen);
+	out_c = vmalloc(LZ4_NEON_TEST_SIZE);
+	out_neon = vmalloc(LZ4_NEON_TEST_SIZE);
+	wrkmem = vmalloc(LZ4_MEM_COMPRESS);
+	if (!orig || !comp || !out_c || !out_neon || !wrkmem)
+		goto out;
+
+	lz4_neon_fill_test(orig, LZ4_NEON_TEST_SIZE);
+	ret = -EINVAL;
+	if (lz4_compress(orig, LZ4_NEON_TEST_SIZE, comp, &clen, wrkmem) < 0)
+		goto out;
+
+	if (LZ4_decompress_safe((const char *)comp, (char *)out_c, clen,
+				LZ4_NEON_TEST_SIZE) != LZ4_NEON_TEST_SIZE)
+		goto out;
+
+	if (lz4_neon_decompress(comp, clen, out_neon, &dlen) ||
+	    dlen != LZ4_NEON_TEST_SIZE)
+		goto out;
+
+	if (memcmp(out_c, out_neon, LZ4_NEON_TEST_SIZE) ||
+	    memcmp(orig, out_neon, LZ4_NEON_TEST_SIZE))
+		goto out;
+
+	ret = 0;
+out:
+	vfree(wrkmem);
+	vfree(out_neon);
+	vfree(out_c);
+	vfree(comp);
+	vfree(orig);
+	return ret;
+}
+
+static int __init lz4_neon_mod_init(void)
+{
+	int err;
+
+	err = lz4_neon_selftest();
+	if (err) {
+		pr_err("lz4-neon: self-test failed, not registering\n");
+		return err;
+	}
+
+	return crypto_register_alg(&alg_lz4_neon);
+}
+
+static void __exit lz4_neon_mod_exit(void)
+{
+	crypto_unregister_alg(&alg_lz4_neon);
+}
+
+module_init(lz4_neon_mod_init);
+module_exit(lz4_neon_mod_exit);
@@ -669,6 +669,26 @@ static bool has_no_hw_prefetch(const struct arm64_cpu_capabilities *entry)
 	return MIDR_IS_CPU_MODEL_RANGE(midr, MIDR_THUNDERX, rv_min, rv_max);
 }
 
+/*
+ * Large copies on the Mongoose cores evict their whole L2 when done with
+ * allocating stores. The boot CPU is a little core, so check every CPU
+ * that came up rather than the one we are running on.
+ */
+static bool has_nt_large_copy(const struct arm64_cpu_capabilities *entry)
+{
+	int cpu;
+
+	for_each_online_cpu(cpu) {
+		u32 midr = per_cpu(cpu_data, cpu).reg_midr;
+
+		if (MIDR_IMPLEMENTOR(midr) == ARM_CPU_IMP_SEC &&
+		    MIDR_PARTNUM(midr) == ARM_CPU_PART_MONGOOSE)
+			return true;
+	}
+
+	return false;
+}
+
 #ifdef CONFIG_UNMAP_KERNEL_AT_EL0
 static int __kpti_forced; /* 0: not forced, >0: forced on, <0: forced off */
 
@@ -737,6 +757,11 @@ static const struct arm64_cpu_capabilities arm64_features[] = {
 		.capability = ARM64_HAS_NO_HW_PREFETCH,
 		.matches = has_no_hw_prefetch,
 	},
+	{
+		.desc = "Non-temporal stores for large copies",
+		.capability = ARM64_HAS_NT_LARGE_COPY,
+		.matches = has_nt_large_copy,
+	},
 #ifdef CONFIG_ARM64_UAO
 	{
 		.desc = "User Access Override",
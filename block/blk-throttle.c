@@ -21,6 +21,17 @@ static int throtl_quantum = 32;
 /* Throttling is performed over 100ms slice and after that slice is renewed */
 static unsigned long throtl_slice = HZ/10;	/* 100 ms */
 
+/*
+ * If non-zero, limits are not enforced while the root group has issued no
+ * reads for this many ms. On Android the foreground apps run in the root
+ * blkio group and background apps in limited child groups, so background
+ * I/O gets the whole device while nothing interactive is reading, and is
+ * held back again as soon as the foreground reads.
+ */
+static unsigned int throtl_fg_idle_ms;
+module_param_named(fg_idle_ms, throtl_fg_idle_ms, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(fg_idle_ms, "relax limits after this many ms without root group reads, 0 to disable");
+
 static struct blkcg_policy blkcg_policy_throtl;
 
 /* A workqueue to queue throttle related work */
@@ -152,6 +163,9 @@ struct throtl_data
 
 	/* Work for dispatching throttled bios */
 	struct work_struct dispatch_work;
+
+	/* jiffies of the last read issued from the root group */
+	unsigned long fg_last_read;
 };
 
 static void throtl_pending_timer_fn(unsigned long arg);
@@ -768,6 +782,14 @@ static bool tg_with_in_bps_limit(struct throtl_grp *tg, struct bio *bio,
 	return 0;
 }
 
+static bool throtl_fg_idle(struct throtl_data *td)
+{
+	unsigned int idle_ms = READ_ONCE(throtl_fg_idle_ms);
+
+	return idle_ms && time_after(jiffies, READ_ONCE(td->fg_last_read) +
+				     msecs_to_jiffies(idle_ms));
+}
+
 /*
  * Returns whether one can dispatch a bio or not. Also returns approx number
  * of jiffies to wait before this bio is with-in IO rate and can be dispatched
@@ -794,6 +816,17 @@ static bool tg_may_dispatch(struct throtl_grp *tg, struct bio *bio,
 		return true;
 	}
 
+	/*
+	 * No foreground reads lately, let the bio through. Restart the slice
+	 * so that what goes out now is not billed once limits apply again.
+	 */
+	if (throtl_fg_idle(tg->td)) {
+		throtl_start_new_slice(tg, rw);
+		if (wait)
+			*wait = 0;
+		return true;
+	}
+
 	/*
 	 * If previous slice expired, start a new one otherwise renew/extend
 	 * existing slice to make sure it is at least throtl_slice interval
@@ -1415,6 +1448,9 @@ bool blk_throtl_bio(struct request_queue *q, struct blkcg_gq *blkg,
 
 	WARN_ON_ONCE(!rcu_read_lock_held());
 
+	if (rw == READ && tg == blkg_to_tg(q->root_blkg))
+		WRITE_ONCE(tg->td->fg_last_read, jiffies);
+
 	/* see throtl_charge_bio() */
 	if ((bio->bi_rw & REQ_THROTTLED) || !tg->has_rules[rw])
 		goto out;
@@ -1574,6 +1610,7 @@ int blk_throtl_init(struct request_queue *q)
 
 	INIT_WORK(&td->dispatch_work, blk_throtl_dispatch_work_fn);
 	throtl_service_queue_init(&td->service_queue);
+	td->fg_last_read = jiffies;
 
 	q->td = td;
 	td->queue = q;
@@ -177,6 +177,29 @@ enum wl_type_t {
 	SYNC_WORKLOAD = 2
 };
 
+#ifdef CONFIG_CFQ_GROUP_IOSCHED
+/*
+ * Completion latency histogram, per IO type and per stage: time waiting
+ * in cfq, time on the device, and the sum of both. Bucket 0 counts IOs
+ * under 64us, each further bucket doubles, the last one is 1s and over.
+ */
+enum {
+	CFQG_LAT_READ,
+	CFQG_LAT_SYNC_WRITE,
+	CFQG_LAT_ASYNC_WRITE,
+	CFQG_LAT_NR_IO,
+};
+
+enum {
+	CFQG_LAT_QUEUE,
+	CFQG_LAT_DEVICE,
+	CFQG_LAT_TOTAL,
+	CFQG_LAT_NR_STAGE,
+};
+
+#define CFQG_LAT_BUCKETS	16
+#endif
+
 struct cfqg_stats {
 #ifdef CONFIG_CFQ_GROUP_IOSCHED
 	/* number of ios merged */
@@ -189,6 +212,8 @@ struct cfqg_stats {
 	struct blkg_rwstat		queued;
 	/* total disk time and nr sectors dispatched by this group */
 	struct blkg_stat		time;
+	/* completion latency histograms, updated under queue_lock */
+	u32 lat_hist[CFQG_LAT_NR_IO][CFQG_LAT_NR_STAGE][CFQG_LAT_BUCKETS];
 #ifdef CONFIG_DEBUG_BLK_CGROUP
 	/* time not charged to this cgroup */
 	struct blkg_stat		unaccounted_time;
@@ -690,17 +715,42 @@ static inline void cfqg_stats_update_io_merged(struct cfq_group *cfqg, int rw)
 	blkg_rwstat_add(&cfqg->stats.merged, rw, 1);
 }
 
+static inline int cfqg_lat_bucket(uint64_t ns)
+{
+	uint64_t us = ns >> 10;
+
+	if (us < 64)
+		return 0;
+	return min_t(int, ilog2(us) - 5, CFQG_LAT_BUCKETS - 1);
+}
+
 static inline void cfqg_stats_update_completion(struct cfq_group *cfqg,
 			uint64_t start_time, uint64_t io_start_time, int rw)
 {
 	struct cfqg_stats *stats = &cfqg->stats;
 	unsigned long long now = sched_clock();
+	uint64_t wait = 0, service = 0;
+	u32 (*hist)[CFQG_LAT_BUCKETS];
+
+	if (time_after64(now, io_start_time)) {
+		service = now - io_start_time;
+		blkg_rwstat_add(&stats->service_time, rw, service);
+	}
+	if (time_after64(io_start_time, start_time)) {
+		wait = io_start_time - start_time;
+		blkg_rwstat_add(&stats->wait_time, rw, wait);
+	}
 
-	if (time_after64(now, io_start_time))
-		blkg_rwstat_add(&stats->service_time, rw, now - io_start_time);
-	if (time_after64(io_start_time, start_time))
-		blkg_rwstat_add(&stats->wait_time, rw,
-				io_start_time - start_time);
+	if (!(rw & REQ_WRITE))
+		hist = stats->lat_hist[CFQG_LAT_READ];
+	else if (rw & REQ_SYNC)
+		hist = stats->lat_hist[CFQG_LAT_SYNC_WRITE];
+	else
+		hist = stats->lat_hist[CFQG_LAT_ASYNC_WRITE];
+
+	hist[CFQG_LAT_QUEUE][cfqg_lat_bucket(wait)]++;
+	hist[CFQG_LAT_DEVICE][cfqg_lat_bucket(service)]++;
+	hist[CFQG_LAT_TOTAL][cfqg_lat_bucket(wait + service)]++;
 }
 
 /* @stats = 0 */
@@ -711,6 +761,7 @@ static void cfqg_stats_reset(struct cfqg_stats *stats)
 	blkg_rwstat_reset(&stats->service_time);
 	blkg_rwstat_reset(&stats->wait_time);
 	blkg_stat_reset(&stats->time);
+	memset(stats->lat_hist, 0, sizeof(stats->lat_hist));
 #ifdef CONFIG_DEBUG_BLK_CGROUP
 	blkg_stat_reset(&stats->unaccounted_time);
 	blkg_stat_reset(&stats->avg_queue_size_sum);
@@ -725,6 +776,13 @@ static void cfqg_stats_reset(struct cfqg_stats *stats)
 /* @to += @from */
 static void cfqg_stats_add_aux(struct cfqg_stats *to, struct cfqg_stats *from)
 {
+	u32 *to_hist = &to->lat_hist[0][0][0];
+	u32 *from_hist = &from->lat_hist[0][0][0];
+	int i;
+
+	for (i = 0; i < sizeof(to->lat_hist) / sizeof(u32); i++)
+		to_hist[i] += from_hist[i];
+
 	/* queued stats shouldn't be cleared */
 	blkg_rwstat_add_aux(&to->merged, &from->merged);
 	blkg_rwstat_add_aux(&to->service_time, &from->service_time);
@@ -1925,6 +1983,46 @@ static int cfqg_print_rwstat_recursive(struct seq_file *sf, void *v)
 	return 0;
 }
 
+static u64 cfqg_prfill_lat_hist(struct seq_file *sf,
+				struct blkg_policy_data *pd, int off)
+{
+	static const char *io_str[CFQG_LAT_NR_IO] = {
+		[CFQG_LAT_READ]		= "Read",
+		[CFQG_LAT_SYNC_WRITE]	= "SyncWrite",
+		[CFQG_LAT_ASYNC_WRITE]	= "AsyncWrite",
+	};
+	static const char *stage_str[CFQG_LAT_NR_STAGE] = {
+		[CFQG_LAT_QUEUE]	= "queue",
+		[CFQG_LAT_DEVICE]	= "device",
+		[CFQG_LAT_TOTAL]	= "total",
+	};
+	struct cfq_group *cfqg = pd_to_cfqg(pd);
+	const char *dname = blkg_dev_name(pd->blkg);
+	int i, j, k;
+
+	if (!dname)
+		return 0;
+
+	for (i = 0; i < CFQG_LAT_NR_IO; i++) {
+		for (j = 0; j < CFQG_LAT_NR_STAGE; j++) {
+			seq_printf(sf, "%s %s %s", dname, io_str[i],
+				   stage_str[j]);
+			for (k = 0; k < CFQG_LAT_BUCKETS; k++)
+				seq_printf(sf, " %u",
+					   cfqg->stats.lat_hist[i][j][k]);
+			seq_putc(sf, '\n');
+		}
+	}
+	return 0;
+}
+
+static int cfqg_print_lat_hist(struct seq_file *sf, void *v)
+{
+	blkcg_print_blkgs(sf, css_to_blkcg(seq_css(sf)),
+			  cfqg_prfill_lat_hist, &blkcg_policy_cfq, 0, false);
+	return 0;
+}
+
 static u64 cfqg_prfill_sectors(struct seq_file *sf, struct blkg_policy_data *pd,
 			       int off)
 {
@@ -2065,6 +2163,10 @@ static struct cftype cfq_blkcg_legacy_files[] = {
 		.private = offsetof(struct cfq_group, stats.queued),
 		.seq_show = cfqg_print_rwstat,
 	},
+	{
+		.name = "io_latency_hist",
+		.seq_show = cfqg_print_lat_hist,
+	},
 
 	/* the same statictics which cover the cfqg and its descendants */
 	{
@@ -0,0 +1,544 @@
+/*
+ *  Flash i/o scheduler.
+ *
+ *  Based on the deadline i/o scheduler,
+ *  Copyright (C) 2002 Jens Axboe <axboe@kernel.dk>
+ *
+ *  Requests are split into three classes: synchronous reads from the
+ *  root blkio cgroup, where Android keeps the foreground and top-app
+ *  tasks; other synchronous requests; and asynchronous writes together
+ *  with every write from a background cgroup. Each class keeps its own
+ *  CSCAN sort list and fifo. Foreground reads are served first and
+ *  preempt batches of the lower classes, which are only allowed in
+ *  once they expired and have been starved fg_starved times. While
+ *  foreground reads were seen within fg_window, no more than
+ *  async_depth writes of the lowest class are left in flight, so a
+ *  deep device queue full of writeback cannot sit in front of an app
+ *  launch.
+ */
+#include <linux/kernel.h>
+#include <linux/fs.h>
+#include <linux/blkdev.h>
+#include <linux/blk-cgroup.h>
+#include <linux/elevator.h>
+#include <linux/bio.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/init.h>
+#include <linux/compiler.h>
+#include <linux/rbtree.h>
+
+static const int fg_read_expire = HZ / 10;	/* read latency target for the foreground */
+static const int sync_expire = HZ / 2;		/* other synchronous requests */
+static const int async_expire = 5 * HZ;		/* writeback, these limits are SOFT! */
+static const int fg_starved = 2;	/* max times fg reads can starve an expired class */
+static const int fifo_batch = 16;	/* # of sequential requests treated as one */
+static const int async_depth = 2;	/* async in flight while the foreground reads */
+static const int fg_window = HZ / 10;	/* foreground is active this long after a read */
+
+enum flash_class {
+	FLASH_FG_READ,
+	FLASH_SYNC,
+	FLASH_ASYNC,
+	FLASH_NR_CLASSES,
+};
+
+struct flash_data {
+	/*
+	 * run time data
+	 */
+
+	/*
+	 * requests are present on both sort_list and fifo_list of their class
+	 */
+	struct rb_root sort_list[FLASH_NR_CLASSES];
+	struct list_head fifo_list[FLASH_NR_CLASSES];
+
+	/*
+	 * next in sort order within each class
+	 */
+	struct request *next_rq[FLASH_NR_CLASSES];
+	unsigned int inflight[FLASH_NR_CLASSES];
+	int batch_class;		/* class of the running batch */
+	unsigned int batching;		/* number of sequential requests made */
+	unsigned int starved;		/* times fg reads have starved others */
+	unsigned long fg_last;		/* jiffies of the last foreground read */
+
+	/*
+	 * settings that change how the i/o scheduler behaves
+	 */
+	int fifo_expire[FLASH_NR_CLASSES];
+	int fifo_batch;
+	int fg_starved;
+	int async_depth;
+	int fg_window;
+	int front_merges;
+};
+
+static inline int flash_rq_class(struct request *rq)
+{
+	return (unsigned long)rq->elv.priv[0];
+}
+
+/*
+ * Tasks outside the root blkio cgroup are background. With cgroup
+ * writeback the flusher tags its bios with the owning cgroup, otherwise
+ * only direct submitters are told apart.
+ */
+static bool flash_rq_background(struct request *rq)
+{
+#ifdef CONFIG_BLK_CGROUP
+	struct blkcg *blkcg;
+	bool bg;
+
+	rcu_read_lock();
+	blkcg = bio_blkcg(rq->bio);
+	bg = blkcg && blkcg != &blkcg_root;
+	rcu_read_unlock();
+
+	return bg;
+#else
+	return false;
+#endif
+}
+
+static int flash_classify(struct request *rq)
+{
+	bool bg = flash_rq_background(rq);
+
+	if (rq_data_dir(rq) == WRITE && (!rq_is_sync(rq) || bg))
+		return FLASH_ASYNC;
+	if (rq_data_dir(rq) == READ && !bg)
+		return FLASH_FG_READ;
+	return FLASH_SYNC;
+}
+
+/*
+ * get the request after `rq' in sector-sorted order
+ */
+static inline struct request *
+flash_latter_request(struct request *rq)
+{
+	struct rb_node *node = rb_next(&rq->rb_node);
+
+	if (node)
+		return rb_entry_rq(node);
+
+	return NULL;
+}
+
+static void
+flash_add_rq_rb(struct flash_data *fd, struct request *rq)
+{
+	elv_rb_add(&fd->sort_list[flash_rq_class(rq)], rq);
+}
+
+static inline void
+flash_del_rq_rb(struct flash_data *fd, struct request *rq)
+{
+	const int class = flash_rq_class(rq);
+
+	if (fd->next_rq[class] == rq)
+		fd->next_rq[class] = flash_latter_request(rq);
+
+	elv_rb_del(&fd->sort_list[class], rq);
+}
+
+/*
+ * add rq to rbtree and fifo
+ */
+static void
+flash_add_request(struct request_queue *q, struct request *rq)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+	const int class = flash_classify(rq);
+
+	rq->elv.priv[0] = (void *)(unsigned long)class;
+	if (class == FLASH_FG_READ)
+		fd->fg_last = jiffies;
+
+	flash_add_rq_rb(fd, rq);
+
+	/*
+	 * set expire time and add to fifo list
+	 */
+	rq->fifo_time = jiffies + fd->fifo_expire[class];
+	list_add_tail(&rq->queuelist, &fd->fifo_list[class]);
+}
+
+/*
+ * remove rq from rbtree and fifo.
+ */
+static void flash_remove_request(struct request_queue *q, struct request *rq)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+
+	rq_fifo_clear(rq);
+	flash_del_rq_rb(fd, rq);
+}
+
+static int
+flash_merge(struct request_queue *q, struct request **req, struct bio *bio)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+	struct request *__rq;
+	int class;
+
+	/*
+	 * check for front merge, the bio may belong to any class
+	 */
+	if (fd->front_merges) {
+		sector_t sector = bio_end_sector(bio);
+
+		for (class = 0; class < FLASH_NR_CLASSES; class++) {
+			__rq = elv_rb_find(&fd->sort_list[class], sector);
+			if (__rq && elv_rq_merge_ok(__rq, bio)) {
+				BUG_ON(sector != blk_rq_pos(__rq));
+				*req = __rq;
+				return ELEVATOR_FRONT_MERGE;
+			}
+		}
+	}
+
+	return ELEVATOR_NO_MERGE;
+}
+
+static void flash_merged_request(struct request_queue *q,
+				 struct request *req, int type)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+
+	/*
+	 * if the merge was a front merge, we need to reposition request
+	 */
+	if (type == ELEVATOR_FRONT_MERGE) {
+		elv_rb_del(&fd->sort_list[flash_rq_class(req)], req);
+		flash_add_rq_rb(fd, req);
+	}
+}
+
+static void
+flash_merged_requests(struct request_queue *q, struct request *req,
+		      struct request *next)
+{
+	/*
+	 * if next expires before rq, assign its expire time to rq
+	 * and move into next position (next will be deleted) in fifo
+	 */
+	if (!list_empty(&req->queuelist) && !list_empty(&next->queuelist) &&
+	    flash_rq_class(req) == flash_rq_class(next)) {
+		if (time_before(next->fifo_time, req->fifo_time)) {
+			list_move(&req->queuelist, &next->queuelist);
+			req->fifo_time = next->fifo_time;
+		}
+	}
+
+	/*
+	 * kill knowledge of next, this one is a goner
+	 */
+	flash_remove_request(q, next);
+}
+
+/*
+ * move an entry to dispatch queue
+ */
+static void
+flash_move_request(struct flash_data *fd, struct request *rq)
+{
+	struct request_queue *q = rq->q;
+	const int class = flash_rq_class(rq);
+
+	fd->next_rq[class] = flash_latter_request(rq);
+	fd->inflight[class]++;
+
+	flash_remove_request(q, rq);
+	elv_dispatch_add_tail(q, rq);
+}
+
+static void flash_completed_request(struct request_queue *q,
+				    struct request *rq)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+	const int class = flash_rq_class(rq);
+
+	if (!WARN_ON_ONCE(!fd->inflight[class]))
+		fd->inflight[class]--;
+}
+
+/*
+ * flash_check_fifo returns 0 if there are no expired requests on the fifo,
+ * 1 otherwise. Requires !list_empty(&fd->fifo_list[class])
+ */
+static inline int flash_check_fifo(struct flash_data *fd, int class)
+{
+	struct request *rq = rq_entry_fifo(fd->fifo_list[class].next);
+
+	return time_after_eq(jiffies, rq->fifo_time);
+}
+
+/*
+ * Writes of the lowest class are held back while the foreground reads.
+ * The queue is run again when one of those in flight completes.
+ */
+static inline bool flash_class_ready(struct flash_data *fd, int class,
+				     int force)
+{
+	if (class != FLASH_ASYNC || force)
+		return true;
+
+	return fd->inflight[FLASH_ASYNC] < fd->async_depth ||
+		time_after(jiffies, fd->fg_last + fd->fg_window);
+}
+
+static int flash_select_class(struct flash_data *fd, int force)
+{
+	int class;
+
+	if (!list_empty(&fd->fifo_list[FLASH_FG_READ])) {
+		for (class = FLASH_SYNC; class < FLASH_NR_CLASSES; class++) {
+			if (list_empty(&fd->fifo_list[class]) ||
+			    !flash_check_fifo(fd, class))
+				continue;
+			if (fd->starved++ >= fd->fg_starved) {
+				fd->starved = 0;
+				return class;
+			}
+			break;
+		}
+
+		return FLASH_FG_READ;
+	}
+
+	fd->starved = 0;
+
+	if (!list_empty(&fd->fifo_list[FLASH_SYNC])) {
+		if (!list_empty(&fd->fifo_list[FLASH_ASYNC]) &&
+		    flash_check_fifo(fd, FLASH_ASYNC) &&
+		    flash_class_ready(fd, FLASH_ASYNC, force))
+			return FLASH_ASYNC;
+
+		return FLASH_SYNC;
+	}
+
+	if (!list_empty(&fd->fifo_list[FLASH_ASYNC]) &&
+	    flash_class_ready(fd, FLASH_ASYNC, force))
+		return FLASH_ASYNC;
+
+	return -1;
+}
+
+/*
+ * flash_dispatch_requests selects the best request according to
+ * class, expire, fifo_batch, etc
+ */
+static int flash_dispatch_requests(struct request_queue *q, int force)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+	const int class = fd->batch_class;
+	struct request *rq = fd->next_rq[class];
+	int next;
+
+	/*
+	 * keep batching unless a foreground read is waiting behind it
+	 */
+	if (rq && fd->batching < fd->fifo_batch &&
+	    (class == FLASH_FG_READ ||
+	     list_empty(&fd->fifo_list[FLASH_FG_READ])) &&
+	    flash_class_ready(fd, class, force))
+		goto dispatch_request;
+
+	next = flash_select_class(fd, force);
+	if (next < 0)
+		return 0;
+
+	BUG_ON(RB_EMPTY_ROOT(&fd->sort_list[next]));
+
+	if (flash_check_fifo(fd, next) || !fd->next_rq[next]) {
+		/*
+		 * A deadline has expired, the last request was in another
+		 * class, or we have run out of higher-sectored requests.
+		 * Start again from the request with the earliest expiry time.
+		 */
+		rq = rq_entry_fifo(fd->fifo_list[next].next);
+	} else {
+		rq = fd->next_rq[next];
+	}
+
+	fd->batch_class = next;
+	fd->batching = 0;
+
+dispatch_request:
+	/*
+	 * rq is the selected appropriate request.
+	 */
+	fd->batching++;
+	flash_move_request(fd, rq);
+
+	return 1;
+}
+
+static void flash_exit_queue(struct elevator_queue *e)
+{
+	struct flash_data *fd = e->elevator_data;
+	int class;
+
+	for (class = 0; class < FLASH_NR_CLASSES; class++)
+		BUG_ON(!list_empty(&fd->fifo_list[class]));
+
+	kfree(fd);
+}
+
+/*
+ * initialize elevator private data (flash_data).
+ */
+static int flash_init_queue(struct request_queue *q, struct elevator_type *e)
+{
+	struct flash_data *fd;
+	struct elevator_queue *eq;
+	int class;
+
+	eq = elevator_alloc(q, e);
+	if (!eq)
+		return -ENOMEM;
+
+	fd = kzalloc_node(sizeof(*fd), GFP_KERNEL, q->node);
+	if (!fd) {
+		kobject_put(&eq->kobj);
+		return -ENOMEM;
+	}
+	eq->elevator_data = fd;
+
+	for (class = 0; class < FLASH_NR_CLASSES; class++) {
+		INIT_LIST_HEAD(&fd->fifo_list[class]);
+		fd->sort_list[class] = RB_ROOT;
+	}
+	fd->fifo_expire[FLASH_FG_READ] = fg_read_expire;
+	fd->fifo_expire[FLASH_SYNC] = sync_expire;
+	fd->fifo_expire[FLASH_ASYNC] = async_expire;
+	fd->fg_starved = fg_starved;
+	fd->async_depth = async_depth;
+	fd->fg_window = fg_window;
+	fd->front_merges = 1;
+	fd->fifo_batch = fifo_batch;
+	fd->fg_last = jiffies - fg_window - 1;
+
+	spin_lock_irq(q->queue_lock);
+	q->elevator = eq;
+	spin_unlock_irq(q->queue_lock);
+	return 0;
+}
+
+/*
+ * sysfs parts below
+ */
+
+static ssize_t
+flash_var_show(int var, char *page)
+{
+	return sprintf(page, "%d\n", var);
+}
+
+static ssize_t
+flash_var_store(int *var, const char *page, size_t count)
+{
+	char *p = (char *) page;
+
+	*var = simple_strtol(p, &p, 10);
+	return count;
+}
+
+#define SHOW_FUNCTION(__FUNC, __VAR, __CONV)				\
+static ssize_t __FUNC(struct elevator_queue *e, char *page)		\
+{									\
+	struct flash_data *fd = e->elevator_data;			\
+	int __data = __VAR;						\
+	if (__CONV)							\
+		__data = jiffies_to_msecs(__data);			\
+	return flash_var_show(__data, (page));				\
+}
+SHOW_FUNCTION(flash_fg_read_expire_show, fd->fifo_expire[FLASH_FG_READ], 1);
+SHOW_FUNCTION(flash_sync_expire_show, fd->fifo_expire[FLASH_SYNC], 1);
+SHOW_FUNCTION(flash_async_expire_show, fd->fifo_expire[FLASH_ASYNC], 1);
+SHOW_FUNCTION(flash_fg_starved_show, fd->fg_starved, 0);
+SHOW_FUNCTION(flash_async_depth_show, fd->async_depth, 0);
+SHOW_FUNCTION(flash_fg_window_show, fd->fg_window, 1);
+SHOW_FUNCTION(flash_front_merges_show, fd->front_merges, 0);
+SHOW_FUNCTION(flash_fifo_batch_show, fd->fifo_batch, 0);
+#undef SHOW_FUNCTION
+
+#define STORE_FUNCTION(__FUNC, __PTR, MIN, MAX, __CONV)			\
+static ssize_t __FUNC(struct elevator_queue *e, const char *page, size_t count)	\
+{									\
+	struct flash_data *fd = e->elevator_data;			\
+	int __data;							\
+	int ret = flash_var_store(&__data, (page), count);		\
+	if (__data < (MIN))						\
+		__data = (MIN);						\
+	else if (__data > (MAX))					\
+		__data = (MAX);						\
+	if (__CONV)							\
+		*(__PTR) = msecs_to_jiffies(__data);			\
+	else								\
+		*(__PTR) = __data;					\
+	return ret;							\
+}
+STORE_FUNCTION(flash_fg_read_expire_store, &fd->fifo_expire[FLASH_FG_READ], 0, INT_MAX, 1);
+STORE_FUNCTION(flash_sync_expire_store, &fd->fifo_expire[FLASH_SYNC], 0, INT_MAX, 1);
+STORE_FUNCTION(flash_async_expire_store, &fd->fifo_expire[FLASH_ASYNC], 0, INT_MAX, 1);
+STORE_FUNCTION(flash_fg_starved_store, &fd->fg_starved, 0, INT_MAX, 0);
+STORE_FUNCTION(flash_async_depth_store, &fd->async_depth, 1, INT_MAX, 0);
+STORE_FUNCTION(flash_fg_window_store, &fd->fg_window, 0, INT_MAX, 1);
+STORE_FUNCTION(flash_front_merges_store, &fd->front_merges, 0, 1, 0);
+STORE_FUNCTION(flash_fifo_batch_store, &fd->fifo_batch, 0, INT_MAX, 0);
+#undef STORE_FUNCTION
+
+#define FD_ATTR(name) \
+	__ATTR(name, S_IRUGO|S_IWUSR, flash_##name##_show, \
+				      flash_##name##_store)
+
+static struct elv_fs_entry flash_attrs[] = {
+	FD_ATTR(fg_read_expire),
+	FD_ATTR(sync_expire),
+	FD_ATTR(async_expire),
+	FD_ATTR(fg_starved),
+	FD_ATTR(async_depth),
+	FD_ATTR(fg_window),
+	FD_ATTR(front_merges),
+	FD_ATTR(fifo_batch),
+	__ATTR_NULL
+};
+
+static struct elevator_type iosched_flash = {
+	.ops = {
+		.elevator_merge_fn = 		flash_merge,
+		.elevator_merged_fn =		flash_merged_request,
+		.elevator_merge_req_fn =	flash_merged_requests,
+		.elevator_dispatch_fn =		flash_dispatch_requests,
+		.elevator_add_req_fn =		flash_add_request,
+		.elevator_completed_req_fn =	flash_completed_request,
+		.elevator_former_req_fn =	elv_rb_former_request,
+		.elevator_latter_req_fn =	elv_rb_latter_request,
+		.elevator_init_fn =		flash_init_queue,
+		.elevator_exit_fn =		flash_exit_queue,
+	},
+
+	.elevator_attrs = flash_attrs,
+	.elevator_name = "flash",
+	.elevator_owner = THIS_MODULE,
+};
+
+static int __init flash_init(void)
+{
+	return elv_register(&iosched_flash);
+}
+
+static void __exit flash_exit(void)
+{
+	elv_unregister(&iosched_flash);
+}
+
+module_init(flash_init);
+module_exit(flash_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("flash IO scheduler");
@@ -68,8 +68,10 @@
 #include <linux/seq_file.h>
 #include <linux/uaccess.h>
 #include <linux/pid_namespace.h>
+#include <linux/percpu.h>
 #include <linux/security.h>
 #include <linux/spinlock.h>
+#include <linux/trace_lat_snapshot.h>
 
 #include <uapi/linux/android/binder.h>
 #include "binder_alloc.h"
@@ -144,6 +146,15 @@ module_param_named(debug_mask, binder_debug_mask, uint, 0644);
 static char *binder_devices_param = CONFIG_ANDROID_BINDER_DEVICES;
 module_param_named(devices, binder_devices_param, charp, S_IRUGO);
 
+/* oneway transactions to one node that may be handled at the same time */
+static uint binder_async_max_inflight = 1;
+module_param_named(async_max_inflight, binder_async_max_inflight, uint, 0644);
+
+/* run oneway transactions at the sender's priority, like sync ones */
+static bool binder_oneway_inherit_prio;
+module_param_named(oneway_inherit_prio, binder_oneway_inherit_prio,
+		   bool, 0644);
+
 static DECLARE_WAIT_QUEUE_HEAD(binder_user_error_wait);
 static int binder_stop_on_user_error;
 
@@ -215,6 +226,21 @@ static inline void binder_stats_created(enum binder_stat_types type)
 	atomic_inc(&binder_stats.obj_created[type]);
 }
 
+#ifdef CONFIG_ANDROID_BINDER_LATENCY_STATS
+/*
+ * Transaction to reply latency, bucket i counts replies that took
+ * less than 2^i usecs (and at least 2^(i-1)), the last bucket all
+ * the slower ones.
+ */
+#define BINDER_LAT_BUCKETS	21
+
+struct binder_lat_hist {
+	unsigned long count[BINDER_LAT_BUCKETS];
+};
+
+static DEFINE_PER_CPU(struct binder_lat_hist, binder_lat_hist);
+#endif
+
 struct binder_transaction_log_entry {
 	int debug_id;
 	int debug_id_done;
@@ -347,7 +373,8 @@ struct binder_error {
  * @pending_weak_ref:     userspace has acked notification of weak ref
  *                        (protected by @proc->inner_lock if @proc
  *                        and by @lock)
- * @has_async_transaction: async transaction to node in progress
+ * @async_active:         async transactions to node in progress, at
+ *                        most binder_async_max_inflight are started
  *                        (protected by @lock)
  * @sched_policy:         minimum scheduling policy for node
  *                        (invariant after initialized)
@@ -360,6 +387,8 @@ struct binder_error {
  *                        (invariant after initialized)
  * @async_todo:           list of async work items
  *                        (protected by @proc->inner_lock)
+ * @lat_hist:             latency of replies to transactions on node
+ *                        (atomics, no lock needed)
  *
  * Bookkeeping structure for binder nodes.
  */
@@ -399,8 +428,11 @@ struct binder_node {
 		u8 txn_security_ctx:1;
 		u8 min_priority;
 	};
-	bool has_async_transaction;
+	unsigned int async_active;
 	struct list_head async_todo;
+#ifdef CONFIG_ANDROID_BINDER_LATENCY_STATS
+	atomic_t lat_hist[BINDER_LAT_BUCKETS];
+#endif
 };
 
 struct binder_ref_death {
@@ -539,6 +571,7 @@ struct binder_priority {
  * @inner_lock:           can nest under outer_lock and/or node lock
  * @outer_lock:           no nesting under innor or node lock
  *                        Lock order: 1) outer, 2) node, 3) inner
+ * @lat_hist:             per cpu latency of replies sent by this proc
  *
  * Bookkeeping structure for binder processes
  */
@@ -571,6 +604,9 @@ struct binder_proc {
 	struct binder_context *context;
 	spinlock_t inner_lock;
 	spinlock_t outer_lock;
+#ifdef CONFIG_ANDROID_BINDER_LATENCY_STATS
+	struct binder_lat_hist __percpu *lat_hist;
+#endif
 };
 
 enum {
@@ -657,6 +693,9 @@ struct binder_transaction {
 	bool    set_priority_called;
 	kuid_t	sender_euid;
 	binder_uintptr_t security_ctx;
+#ifdef CONFIG_ANDROID_BINDER_LATENCY_STATS
+	ktime_t start_time;
+#endif
 	/**
 	 * @lock:  protects @from, @to_proc, and @to_thread
 	 *
@@ -2800,10 +2839,11 @@ static bool binder_proc_transaction(struct binder_transaction *t,
 
 	if (oneway) {
 		BUG_ON(thread);
-		if (node->has_async_transaction) {
+		if (node->async_active >=
+		    max_t(uint, READ_ONCE(binder_async_max_inflight), 1)) {
 			pending_async = true;
 		} else {
-			node->has_async_transaction = true;
+			node->async_active++;
 		}
 	}
 
@@ -2879,6 +2919,50 @@ static struct binder_node *binder_get_node_refs_for_txn(
 	return target_node;
 }
 
+#ifdef CONFIG_ANDROID_BINDER_LATENCY_STATS
+static void binder_lat_start(struct binder_transaction *t)
+{
+	t->start_time = ktime_get();
+}
+
+/**
+ * binder_lat_record() - account the latency of a reply
+ * @proc:         replying proc
+ * @in_reply_to:  transaction being replied to
+ *
+ * The node is taken from the transaction buffer, which holds a
+ * reference on it until BC_FREE_BUFFER detaches it under
+ * @proc->inner_lock. Replies sent after that only count for the proc.
+ */
+static void binder_lat_record(struct binder_proc *proc,
+			      struct binder_transaction *in_reply_to)
+{
+	s64 us = ktime_us_delta(ktime_get(), in_reply_to->start_time);
+	int bucket = min_t(int, fls64(max_t(s64, us, 0)),
+			   BINDER_LAT_BUCKETS - 1);
+	struct binder_buffer *buffer;
+
+	this_cpu_inc(binder_lat_hist.count[bucket]);
+	this_cpu_inc(proc->lat_hist->count[bucket]);
+	lat_snapshot_check(LAT_SNAPSHOT_BINDER, max_t(s64, us, 0), current);
+
+	binder_inner_proc_lock(proc);
+	buffer = in_reply_to->buffer;
+	if (buffer && buffer->target_node)
+		atomic_inc(&buffer->target_node->lat_hist[bucket]);
+	binder_inner_proc_unlock(proc);
+}
+#else
+static inline void binder_lat_start(struct binder_transaction *t)
+{
+}
+
+static inline void binder_lat_record(struct binder_proc *proc,
+				     struct binder_transaction *in_reply_to)
+{
+}
+#endif
+
 static void binder_transaction(struct binder_proc *proc,
 			       struct binder_thread *thread,
 			       struct binder_transaction_data *tr, int reply,
@@ -3094,6 +3178,8 @@ static void binder_transaction(struct binder_proc *proc,
 	binder_stats_created(BINDER_STAT_TRANSACTION_COMPLETE);
 
 	t->debug_id = t_debug_id;
+	if (!reply && !(tr->flags & TF_ONE_WAY))
+		binder_lat_start(t);
 
 	if (reply)
 		binder_debug(BINDER_DEBUG_TRANSACTION,
@@ -3123,9 +3209,12 @@ static void binder_transaction(struct binder_proc *proc,
 	t->to_thread = target_thread;
 	t->code = tr->code;
 	t->flags = tr->flags;
-	if (!(t->flags & TF_ONE_WAY) &&
+	if ((!(t->flags & TF_ONE_WAY) || binder_oneway_inherit_prio) &&
 	    binder_supported_policy(current->policy)) {
-		/* Inherit supported policies for synchronous transactions */
+		/*
+		 * Inherit supported policies for synchronous transactions,
+		 * and for oneway ones if asked to.
+		 */
 		t->priority.sched_policy = current->policy;
 		t->priority.prio = current->normal_prio;
 	} else {
@@ -3396,6 +3485,7 @@ static void binder_transaction(struct binder_proc *proc,
 		binder_enqueue_thread_work_ilocked(target_thread, &t->work);
 		binder_inner_proc_unlock(target_proc);
 		wake_up_interruptible_sync(&target_thread->wait);
+		binder_lat_record(proc, in_reply_to);
 		binder_restore_priority(current, in_reply_to->saved_priority);
 		binder_free_transaction(in_reply_to);
 	} else if (!(t->flags & TF_ONE_WAY)) {
@@ -3724,12 +3814,13 @@ static int binder_thread_write(struct binder_proc *proc,
 
 				buf_node = buffer->target_node;
 				binder_node_inner_lock(buf_node);
-				BUG_ON(!buf_node->has_async_transaction);
+				BUG_ON(!buf_node->async_active);
 				BUG_ON(buf_node->proc != proc);
+				/* the next pending one takes over our slot */
 				w = binder_dequeue_work_head_ilocked(
 						&buf_node->async_todo);
 				if (!w) {
-					buf_node->has_async_transaction = false;
+					buf_node->async_active--;
 				} else {
 					binder_enqueue_work_ilocked(
 							w, &proc->todo);
@@ -4559,6 +4650,9 @@ static void binder_free_proc(struct binder_proc *proc)
 	put_task_struct(proc->tsk);
 	put_cred(proc->cred);
 	binder_stats_deleted(BINDER_STAT_PROC);
+#ifdef CONFIG_ANDROID_BINDER_LATENCY_STATS
+	free_percpu(proc->lat_hist);
+#endif
 	kfree(proc);
 }
 
@@ -5021,6 +5115,13 @@ static int binder_open(struct inode *nodp, struct file *filp)
 	proc = kzalloc(sizeof(*proc), GFP_KERNEL);
 	if (proc == NULL)
 		return -ENOMEM;
+#ifdef CONFIG_ANDROID_BINDER_LATENCY_STATS
+	proc->lat_hist = alloc_percpu(struct binder_lat_hist);
+	if (!proc->lat_hist) {
+		kfree(proc);
+		return -ENOMEM;
+	}
+#endif
 	spin_lock_init(&proc->inner_lock);
 	spin_lock_init(&proc->outer_lock);
 	atomic_set(&proc->tmp_ref, 0);
@@ -5646,6 +5747,112 @@ static void print_binder_stats(struct seq_file *m, const char *prefix,
 	}
 }
 
+#ifdef CONFIG_ANDROID_BINDER_LATENCY_STATS
+static void binder_lat_sum(struct binder_lat_hist __percpu *hist,
+			   unsigned long *count)
+{
+	int cpu, i;
+
+	memset(count, 0, sizeof(count[0]) * BINDER_LAT_BUCKETS);
+	for_each_possible_cpu(cpu) {
+		struct binder_lat_hist *h = per_cpu_ptr(hist, cpu);
+
+		for (i = 0; i < BINDER_LAT_BUCKETS; i++)
+			count[i] += h->count[i];
+	}
+}
+
+static void binder_lat_reset(struct binder_lat_hist __percpu *hist)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		memset(per_cpu_ptr(hist, cpu), 0, sizeof(struct binder_lat_hist));
+}
+
+static void print_binder_lat_bucket(struct seq_file *m, int bucket)
+{
+	if (bucket == BINDER_LAT_BUCKETS - 1)
+		seq_printf(m, ">=%luus", 1UL << (bucket - 1));
+	else
+		seq_printf(m, "<%luus", 1UL << bucket);
+}
+
+static void print_binder_lat(struct seq_file *m, const char *prefix,
+			     const unsigned long *count, bool buckets)
+{
+	static const unsigned int pct[] = { 50, 90, 99 };
+	unsigned long total = 0, sum = 0;
+	int i, p = 0;
+
+	for (i = 0; i < BINDER_LAT_BUCKETS; i++)
+		total += count[i];
+	if (!total)
+		return;
+
+	seq_printf(m, "%slatency: count %lu", prefix, total);
+	for (i = 0; i < BINDER_LAT_BUCKETS; i++) {
+		sum += count[i];
+		for (; p < ARRAY_SIZE(pct) && sum * 100 >= total * pct[p]; p++) {
+			seq_printf(m, " p%u ", pct[p]);
+			print_binder_lat_bucket(m, i);
+		}
+	}
+	seq_puts(m, "\n");
+
+	if (!buckets)
+		return;
+	for (i = 0; i < BINDER_LAT_BUCKETS; i++) {
+		if (!count[i])
+			continue;
+		seq_printf(m, "%s  ", prefix);
+		print_binder_lat_bucket(m, i);
+		seq_printf(m, ": %lu\n", count[i]);
+	}
+}
+
+static void print_binder_proc_lat(struct seq_file *m,
+				  struct binder_proc *proc)
+{
+	unsigned long count[BINDER_LAT_BUCKETS];
+	char prefix[24];
+	struct rb_node *n;
+	int i;
+
+	binder_lat_sum(proc->lat_hist, count);
+	print_binder_lat(m, "  ", count, false);
+
+	binder_inner_proc_lock(proc);
+	for (n = rb_first(&proc->nodes); n != NULL; n = rb_next(n)) {
+		struct binder_node *node = rb_entry(n, struct binder_node,
+						    rb_node);
+
+		for (i = 0; i < BINDER_LAT_BUCKETS; i++)
+			count[i] = atomic_read(&node->lat_hist[i]);
+		snprintf(prefix, sizeof(prefix), "  node %d ", node->debug_id);
+		print_binder_lat(m, prefix, count, false);
+	}
+	binder_inner_proc_unlock(proc);
+}
+
+static void print_binder_global_lat(struct seq_file *m)
+{
+	unsigned long count[BINDER_LAT_BUCKETS];
+
+	binder_lat_sum(&binder_lat_hist, count);
+	print_binder_lat(m, "", count, true);
+}
+#else
+static inline void print_binder_proc_lat(struct seq_file *m,
+					 struct binder_proc *proc)
+{
+}
+
+static inline void print_binder_global_lat(struct seq_file *m)
+{
+}
+#endif
+
 static void print_binder_proc_stats(struct seq_file *m,
 				    struct binder_proc *proc)
 {
@@ -5708,6 +5915,7 @@ static void print_binder_proc_stats(struct seq_file *m,
 	seq_printf(m, "  pending transactions: %d\n", count);
 
 	print_binder_stats(m, "  ", &proc->stats);
+	print_binder_proc_lat(m, proc);
 }
 
 
@@ -5757,6 +5965,7 @@ static int binder_stats_show(struct seq_file *m, void *unused)
 	seq_puts(m, "binder stats:\n");
 
 	print_binder_stats(m, "", &binder_stats);
+	print_binder_global_lat(m);
 
 	mutex_lock(&binder_procs_lock);
 	hlist_for_each_entry(proc, &binder_procs, proc_node)
@@ -5859,6 +6068,43 @@ BINDER_DEBUG_ENTRY(stats);
 BINDER_DEBUG_ENTRY(transactions);
 BINDER_DEBUG_ENTRY(transaction_log);
 
+#ifdef CONFIG_ANDROID_BINDER_LATENCY_STATS
+static ssize_t binder_latency_reset_write(struct file *file,
+					  const char __user *ubuf,
+					  size_t count, loff_t *ppos)
+{
+	struct binder_proc *proc;
+	struct rb_node *n;
+	int i;
+
+	binder_lat_reset(&binder_lat_hist);
+
+	mutex_lock(&binder_procs_lock);
+	hlist_for_each_entry(proc, &binder_procs, proc_node) {
+		binder_lat_reset(proc->lat_hist);
+		binder_inner_proc_lock(proc);
+		for (n = rb_first(&proc->nodes); n != NULL; n = rb_next(n)) {
+			struct binder_node *node = rb_entry(n,
+					struct binder_node, rb_node);
+
+			for (i = 0; i < BINDER_LAT_BUCKETS; i++)
+				atomic_set(&node->lat_hist[i], 0);
+		}
+		binder_inner_proc_unlock(proc);
+	}
+	mutex_unlock(&binder_procs_lock);
+
+	return count;
+}
+
+static const struct file_operations binder_latency_reset_fops = {
+	.owner = THIS_MODULE,
+	.open = simple_open,
+	.write = binder_latency_reset_write,
+	.llseek = noop_llseek,
+};
+#endif
+
 static int __init init_binder_device(const char *name)
 {
 	int ret;
@@ -5935,6 +6181,13 @@ static int __init binder_init(void)
 				    binder_debugfs_dir_entry_root,
 				    &binder_transaction_log_failed,
 				    &binder_transaction_log_fops);
+#ifdef CONFIG_ANDROID_BINDER_LATENCY_STATS
+		debugfs_create_file("latency_reset",
+				    0200,
+				    binder_debugfs_dir_entry_root,
+				    NULL,
+				    &binder_latency_reset_fops);
+#endif
 	}
 
 	/*
@@ -19,6 +19,7 @@
 
 #include <asm/cacheflush.h>
 #include <linux/list.h>
+#include <linux/log2.h>
 #include <linux/mm.h>
 #include <linux/module.h>
 #include <linux/rtmutex.h>
@@ -26,6 +27,7 @@
 #include <linux/seq_file.h>
 #include <linux/vmalloc.h>
 #include <linux/slab.h>
+#include <linux/sizes.h>
 #include <linux/sched.h>
 #include <linux/list_lru.h>
 #include "binder_alloc.h"
@@ -45,6 +47,19 @@ static uint32_t binder_alloc_debug_mask;
 module_param_named(debug_mask, binder_alloc_debug_mask,
 		   uint, S_IWUSR | S_IRUGO);
 
+/* applied to a proc when it maps its buffer space */
+static bool binder_alloc_size_classes = true;
+module_param_named(size_classes, binder_alloc_size_classes,
+		   bool, S_IWUSR | S_IRUGO);
+static uint binder_alloc_pinned_kb = 16;
+module_param_named(pinned_kb, binder_alloc_pinned_kb,
+		   uint, S_IWUSR | S_IRUGO);
+
+/* pages put on the lru more recently than this get a second pass */
+static uint binder_alloc_lru_min_age_ms = 100;
+module_param_named(lru_min_age_ms, binder_alloc_lru_min_age_ms,
+		   uint, S_IWUSR | S_IRUGO);
+
 #define binder_alloc_debug(mask, x...) \
 	do { \
 		if (binder_alloc_debug_mask & mask) \
@@ -70,6 +85,25 @@ static size_t binder_alloc_buffer_size(struct binder_alloc *alloc,
 	return (u8 *)binder_buffer_next(buffer)->data - (u8 *)buffer->data;
 }
 
+/* size class serving @size, or -1 if it is too large for one */
+static int binder_size_class(struct binder_alloc *alloc, size_t size)
+{
+	int cls;
+
+	if (!alloc->class_cache)
+		return -1;
+	if (size <= BINDER_SIZE_CLASS_MIN)
+		return 0;
+
+	cls = order_base_2(size) - ilog2(BINDER_SIZE_CLASS_MIN);
+	return cls < BINDER_SIZE_CLASSES ? cls : -1;
+}
+
+static bool binder_page_pinned(struct binder_alloc *alloc, size_t index)
+{
+	return index < alloc->pinned_pages;
+}
+
 static void binder_insert_free_buffer(struct binder_alloc *alloc,
 				      struct binder_buffer *new_buffer)
 {
@@ -242,6 +276,9 @@ static int binder_update_page_range(struct binder_alloc *alloc, int allocate,
 		page = &alloc->pages[index];
 
 		if (page->page_ptr) {
+			if (binder_page_pinned(alloc, index))
+				continue;
+
 			trace_binder_alloc_lru_start(alloc, index);
 
 			on_lru = list_lru_del(&binder_alloc_lru, &page->lru);
@@ -306,8 +343,13 @@ free_range:
 		index = (page_addr - alloc->buffer) / PAGE_SIZE;
 		page = &alloc->pages[index];
 
+		if (binder_page_pinned(alloc, index))
+			continue;
+
 		trace_binder_free_lru_start(alloc, index);
 
+		page->lru_time = jiffies;
+		page->rotated = false;
 		ret = list_lru_add(&binder_alloc_lru, &page->lru);
 		WARN_ON(!ret);
 
@@ -344,8 +386,8 @@ static struct binder_buffer *binder_alloc_new_buf_locked(
 	struct rb_node *best_fit = NULL;
 	void *has_page_addr;
 	void *end_page_addr;
-	size_t size, data_offsets_size;
-	int ret;
+	size_t size, data_offsets_size, class_size;
+	int ret, cls;
 
 	if (alloc->vma == NULL) {
 		pr_err("%d: binder_alloc_buf, no vma\n",
@@ -380,15 +422,30 @@ static struct binder_buffer *binder_alloc_new_buf_locked(
 	/* Pad 0-size buffers so they get assigned unique addresses */
 	size = max(size, sizeof(void *));
 
+	/* small buffers come from their size class, pages included */
+	class_size = size;
+	cls = binder_size_class(alloc, size);
+	if (cls >= 0) {
+		class_size = BINDER_SIZE_CLASS_MIN << cls;
+		if (!list_empty(&alloc->class_free[cls])) {
+			buffer = list_first_entry(&alloc->class_free[cls],
+						  struct binder_buffer,
+						  class_entry);
+			list_del_init(&buffer->class_entry);
+			alloc->class_count[cls]--;
+			goto got_buffer;
+		}
+	}
+
 	while (n) {
 		buffer = rb_entry(n, struct binder_buffer, rb_node);
 		BUG_ON(!buffer->free);
 		buffer_size = binder_alloc_buffer_size(alloc, buffer);
 
-		if (size < buffer_size) {
+		if (class_size < buffer_size) {
 			best_fit = n;
 			n = n->rb_left;
-		} else if (size > buffer_size)
+		} else if (class_size > buffer_size)
 			n = n->rb_right;
 		else {
 			best_fit = n;
@@ -439,9 +496,9 @@ static struct binder_buffer *binder_alloc_new_buf_locked(
 
 	has_page_addr =
 		(void *)(((uintptr_t)buffer->data + buffer_size) & PAGE_MASK);
-	WARN_ON(n && buffer_size != size);
+	WARN_ON(n && buffer_size != class_size);
 	end_page_addr =
-		(void *)PAGE_ALIGN((uintptr_t)buffer->data + size);
+		(void *)PAGE_ALIGN((uintptr_t)buffer->data + class_size);
 	if (end_page_addr > has_page_addr)
 		end_page_addr = has_page_addr;
 	ret = binder_update_page_range(alloc, 1,
@@ -449,7 +506,7 @@ static struct binder_buffer *binder_alloc_new_buf_locked(
 	if (ret)
 		return ERR_PTR(ret);
 
-	if (buffer_size != size) {
+	if (buffer_size != class_size) {
 		struct binder_buffer *new_buffer;
 
 		new_buffer = kzalloc(sizeof(*buffer), GFP_KERNEL);
@@ -458,7 +515,8 @@ static struct binder_buffer *binder_alloc_new_buf_locked(
 			       __func__, alloc->pid);
 			goto err_alloc_buf_struct_failed;
 		}
-		new_buffer->data = (u8 *)buffer->data + size;
+		INIT_LIST_HEAD(&new_buffer->class_entry);
+		new_buffer->data = (u8 *)buffer->data + class_size;
 		list_add(&new_buffer->entry, &buffer->entry);
 		new_buffer->free = 1;
 		binder_insert_free_buffer(alloc, new_buffer);
@@ -466,6 +524,7 @@ static struct binder_buffer *binder_alloc_new_buf_locked(
 
 	rb_erase(best_fit, &alloc->free_buffers);
 	buffer->free = 0;
+got_buffer:
 	buffer->allow_user_free = 0;
 	binder_insert_allocated_buffer_locked(alloc, buffer);
 	binder_alloc_debug(BINDER_DEBUG_BUFFER_ALLOC,
@@ -576,6 +635,68 @@ static void binder_delete_free_buffer(struct binder_alloc *alloc,
 	kfree(buffer);
 }
 
+/* Return @buffer, no longer allocated, to the free space */
+static void binder_release_buf_locked(struct binder_alloc *alloc,
+				      struct binder_buffer *buffer,
+				      size_t buffer_size)
+{
+	binder_update_page_range(alloc, 0,
+		(void *)PAGE_ALIGN((uintptr_t)buffer->data),
+		(void *)(((uintptr_t)buffer->data + buffer_size) & PAGE_MASK));
+
+	buffer->free = 1;
+	if (!list_is_last(&buffer->entry, &alloc->buffers)) {
+		struct binder_buffer *next = binder_buffer_next(buffer);
+
+		if (next->free) {
+			rb_erase(&next->rb_node, &alloc->free_buffers);
+			binder_delete_free_buffer(alloc, next);
+		}
+	}
+	if (alloc->buffers.next != &buffer->entry) {
+		struct binder_buffer *prev = binder_buffer_prev(buffer);
+
+		if (prev->free) {
+			binder_delete_free_buffer(alloc, buffer);
+			rb_erase(&prev->rb_node, &alloc->free_buffers);
+			buffer = prev;
+		}
+	}
+	binder_insert_free_buffer(alloc, buffer);
+}
+
+/* Keep a freed small buffer for its size class, if there is room */
+static bool binder_class_cache_put(struct binder_alloc *alloc,
+				   struct binder_buffer *buffer,
+				   size_t buffer_size)
+{
+	int cls = binder_size_class(alloc, buffer_size);
+
+	if (cls < 0 || buffer_size != BINDER_SIZE_CLASS_MIN << cls ||
+	    alloc->class_count[cls] >= BINDER_SIZE_CLASS_CACHE)
+		return false;
+
+	list_add(&buffer->class_entry, &alloc->class_free[cls]);
+	alloc->class_count[cls]++;
+	return true;
+}
+
+static void binder_class_cache_flush_locked(struct binder_alloc *alloc)
+{
+	struct binder_buffer *buffer, *tmp;
+	int cls;
+
+	for (cls = 0; cls < BINDER_SIZE_CLASSES; cls++) {
+		list_for_each_entry_safe(buffer, tmp, &alloc->class_free[cls],
+					 class_entry) {
+			list_del_init(&buffer->class_entry);
+			binder_release_buf_locked(alloc, buffer,
+				binder_alloc_buffer_size(alloc, buffer));
+		}
+		alloc->class_count[cls] = 0;
+	}
+}
+
 static void binder_free_buf_locked(struct binder_alloc *alloc,
 				   struct binder_buffer *buffer)
 {
@@ -605,30 +726,11 @@ static void binder_free_buf_locked(struct binder_alloc *alloc,
 			      alloc->pid, size, alloc->free_async_space);
 	}
 
-	binder_update_page_range(alloc, 0,
-		(void *)PAGE_ALIGN((uintptr_t)buffer->data),
-		(void *)(((uintptr_t)buffer->data + buffer_size) & PAGE_MASK));
-
 	rb_erase(&buffer->rb_node, &alloc->allocated_buffers);
-	buffer->free = 1;
-	if (!list_is_last(&buffer->entry, &alloc->buffers)) {
-		struct binder_buffer *next = binder_buffer_next(buffer);
-
-		if (next->free) {
-			rb_erase(&next->rb_node, &alloc->free_buffers);
-			binder_delete_free_buffer(alloc, next);
-		}
-	}
-	if (alloc->buffers.next != &buffer->entry) {
-		struct binder_buffer *prev = binder_buffer_prev(buffer);
+	if (binder_class_cache_put(alloc, buffer, buffer_size))
+		return;
 
-		if (prev->free) {
-			binder_delete_free_buffer(alloc, buffer);
-			rb_erase(&prev->rb_node, &alloc->free_buffers);
-			buffer = prev;
-		}
-	}
-	binder_insert_free_buffer(alloc, buffer);
+	binder_release_buf_locked(alloc, buffer, buffer_size);
 }
 
 /**
@@ -714,10 +816,14 @@ int binder_alloc_mmap_handler(struct binder_alloc *alloc,
 	}
 
 	buffer->data = alloc->buffer;
+	INIT_LIST_HEAD(&buffer->class_entry);
 	list_add(&buffer->entry, &alloc->buffers);
 	buffer->free = 1;
 	binder_insert_free_buffer(alloc, buffer);
 	alloc->free_async_space = alloc->buffer_size / 2;
+	alloc->class_cache = binder_alloc_size_classes;
+	alloc->pinned_pages = min_t(size_t, alloc->buffer_size / PAGE_SIZE,
+				    binder_alloc_pinned_kb / (PAGE_SIZE / SZ_1K));
 	barrier();
 	alloc->vma = vma;
 	alloc->vma_vm_mm = vma->vm_mm;
@@ -761,6 +867,7 @@ void binder_alloc_deferred_release(struct binder_alloc *alloc)
 		binder_free_buf_locked(alloc, buffer);
 		buffers++;
 	}
+	binder_class_cache_flush_locked(alloc);
 
 	while (!list_empty(&alloc->buffers)) {
 		buffer = list_first_entry(&alloc->buffers,
@@ -897,74 +1004,139 @@ void binder_alloc_vma_close(struct binder_alloc *alloc)
 	WRITE_ONCE(alloc->vma, NULL);
 }
 
+/**
+ * struct binder_shrink_batch - pages of one proc isolated by the shrinker
+ * @alloc:  proc the pages belong to, its mutex and mmap_sem are held
+ * @mm:     @alloc->vma_vm_mm, referenced while @nr is not 0
+ * @pages:  isolated binder_lru_page entries
+ * @nr:     number of entries on @pages
+ */
+struct binder_shrink_batch {
+	struct binder_alloc *alloc;
+	struct mm_struct *mm;
+	struct list_head pages;
+	unsigned int nr;
+};
+
+/* pages freed under one mmap_sem hold of a proc */
+#define BINDER_SHRINK_BATCH	32
+
+static void binder_alloc_flush_batch(struct binder_shrink_batch *batch)
+{
+	struct binder_alloc *alloc = batch->alloc;
+	struct binder_lru_page *page, *tmp;
+	struct vm_area_struct *vma;
+	uintptr_t page_addr;
+	size_t index;
+
+	if (!batch->nr)
+		return;
+
+	vma = alloc->vma;
+	if (vma) {
+		list_for_each_entry(page, &batch->pages, lru) {
+			index = page - alloc->pages;
+			page_addr = (uintptr_t)alloc->buffer + index * PAGE_SIZE;
+
+			trace_binder_unmap_user_start(alloc, index);
+
+			zap_page_range(vma,
+				       page_addr +
+				       alloc->user_buffer_offset,
+				       PAGE_SIZE, NULL);
+
+			trace_binder_unmap_user_end(alloc, index);
+		}
+	}
+	up_write(&batch->mm->mmap_sem);
+	mmput(batch->mm);
+
+	list_for_each_entry_safe(page, tmp, &batch->pages, lru) {
+		list_del_init(&page->lru);
+		index = page - alloc->pages;
+		page_addr = (uintptr_t)alloc->buffer + index * PAGE_SIZE;
+
+		trace_binder_unmap_kernel_start(alloc, index);
+
+		unmap_kernel_range(page_addr, PAGE_SIZE);
+		__free_page(page->page_ptr);
+		page->page_ptr = NULL;
+
+		trace_binder_unmap_kernel_end(alloc, index);
+	}
+
+	mutex_unlock(&alloc->mutex);
+	batch->alloc = NULL;
+	batch->nr = 0;
+}
+
 /**
  * binder_alloc_free_page() - shrinker callback to free pages
  * @item:   item to free
  * @lock:   lock protecting the item
- * @cb_arg: callback argument
+ * @cb_arg: struct binder_shrink_batch, or NULL to free @item alone
  *
- * Called from list_lru_walk() in binder_shrink_scan() to free
+ * Called from list_lru_walk() in binder_alloc_shrink() to free
  * up pages when the system is under memory pressure.
+ *
+ * With a batch, pages of the proc that owns the first isolated page
+ * are collected while its alloc->mutex and mmap_sem are held and
+ * freed every BINDER_SHRINK_BATCH pages, pages of other procs are
+ * left for a later walk. Pages that only just went on the lru are
+ * rotated once so that buffers in steady use keep their pages.
  */
 enum lru_status binder_alloc_free_page(struct list_head *item,
 				       struct list_lru_one *lru,
 				       spinlock_t *lock,
 				       void *cb_arg)
 {
+	struct binder_shrink_batch single = { .nr = 0 };
+	struct binder_shrink_batch *batch = cb_arg ?: &single;
 	struct mm_struct *mm = NULL;
 	struct binder_lru_page *page = container_of(item,
 						    struct binder_lru_page,
 						    lru);
 	struct binder_alloc *alloc;
-	uintptr_t page_addr;
-	size_t index;
-	struct vm_area_struct *vma;
 
 	alloc = page->alloc;
-	if (!mutex_trylock(&alloc->mutex))
-		goto err_get_alloc_mutex_failed;
-
-	if (!page->page_ptr)
-		goto err_page_already_freed;
-
-	index = page - alloc->pages;
-	page_addr = (uintptr_t)alloc->buffer + index * PAGE_SIZE;
-
-	mm = alloc->vma_vm_mm;
-	/* Same as mmget_not_zero() in later kernel versions */
-	if (!atomic_inc_not_zero(&alloc->vma_vm_mm->mm_users))
-		goto err_mmget;
-	if (!down_write_trylock(&mm->mmap_sem))
-		goto err_down_write_mmap_sem_failed;
-	vma = alloc->vma;
-
-	list_lru_isolate(lru, item);
-	spin_unlock(lock);
-
-	if (vma) {
-		trace_binder_unmap_user_start(alloc, index);
-
-		zap_page_range(vma,
-			       page_addr +
-			       alloc->user_buffer_offset,
-			       PAGE_SIZE, NULL);
-
-		trace_binder_unmap_user_end(alloc, index);
+	if (batch->nr && batch->alloc != alloc)
+		return LRU_SKIP;
+
+	if (cb_arg && !page->rotated &&
+	    time_before(jiffies, page->lru_time +
+			msecs_to_jiffies(binder_alloc_lru_min_age_ms))) {
+		page->rotated = true;
+		return LRU_ROTATE;
 	}
-	up_write(&mm->mmap_sem);
-	mmput(mm);
 
-	trace_binder_unmap_kernel_start(alloc, index);
+	if (!batch->nr) {
+		if (!mutex_trylock(&alloc->mutex))
+			goto err_get_alloc_mutex_failed;
 
-	unmap_kernel_range(page_addr, PAGE_SIZE);
-	__free_page(page->page_ptr);
-	page->page_ptr = NULL;
+		if (!page->page_ptr)
+			goto err_page_already_freed;
 
-	trace_binder_unmap_kernel_end(alloc, index);
+		mm = alloc->vma_vm_mm;
+		/* Same as mmget_not_zero() in later kernel versions */
+		if (!atomic_inc_not_zero(&alloc->vma_vm_mm->mm_users))
+			goto err_mmget;
+		if (!down_write_trylock(&mm->mmap_sem))
+			goto err_down_write_mmap_sem_failed;
+
+		batch->alloc = alloc;
+		batch->mm = mm;
+		INIT_LIST_HEAD(&batch->pages);
+	}
 
-	spin_lock(lock);
-	mutex_unlock(&alloc->mutex);
-	return LRU_REMOVED_RETRY;
+	list_lru_isolate_move(lru, item, &batch->pages);
+	batch->nr++;
+	if (batch == &single || batch->nr >= BINDER_SHRINK_BATCH) {
+		spin_unlock(lock);
+		binder_alloc_flush_batch(batch);
+		spin_lock(lock);
+		return LRU_REMOVED_RETRY;
+	}
+	return LRU_REMOVED;
 
 err_down_write_mmap_sem_failed:
 	mmput_async(mm);
@@ -975,6 +1147,23 @@ err_get_alloc_mutex_failed:
 	return LRU_SKIP;
 }
 
+/**
+ * binder_alloc_shrink() - free up to @nr_to_scan pages from the lru
+ * @nr_to_scan: number of lru entries to walk
+ *
+ * Return: number of pages freed
+ */
+unsigned long binder_alloc_shrink(unsigned long nr_to_scan)
+{
+	struct binder_shrink_batch batch = { .nr = 0 };
+	unsigned long ret;
+
+	ret = list_lru_walk(&binder_alloc_lru, binder_alloc_free_page,
+			    &batch, nr_to_scan);
+	binder_alloc_flush_batch(&batch);
+	return ret;
+}
+
 static unsigned long
 binder_shrink_count(struct shrinker *shrink, struct shrink_control *sc)
 {
@@ -985,11 +1174,7 @@ binder_shrink_count(struct shrinker *shrink, struct shrink_control *sc)
 static unsigned long
 binder_shrink_scan(struct shrinker *shrink, struct shrink_control *sc)
 {
-	unsigned long ret;
-
-	ret = list_lru_walk(&binder_alloc_lru, binder_alloc_free_page,
-			    NULL, sc->nr_to_scan);
-	return ret;
+	return binder_alloc_shrink(sc->nr_to_scan);
 }
 
 static struct shrinker binder_shrinker = {
@@ -1007,9 +1192,13 @@ static struct shrinker binder_shrinker = {
  */
 void binder_alloc_init(struct binder_alloc *alloc)
 {
+	int cls;
+
 	alloc->pid = current->group_leader->pid;
 	mutex_init(&alloc->mutex);
 	INIT_LIST_HEAD(&alloc->buffers);
+	for (cls = 0; cls < BINDER_SIZE_CLASSES; cls++)
+		INIT_LIST_HEAD(&alloc->class_free[cls]);
 }
 
 int binder_alloc_shrinker_init(void)
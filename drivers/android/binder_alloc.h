@@ -26,10 +26,21 @@
 extern struct list_lru binder_alloc_lru;
 struct binder_transaction;
 
+/*
+ * Small buffers are rounded up to one of BINDER_SIZE_CLASSES power of
+ * two sizes starting at BINDER_SIZE_CLASS_MIN, and up to
+ * BINDER_SIZE_CLASS_CACHE freed buffers of each class are kept, with
+ * their pages, for the next allocation of that class.
+ */
+#define BINDER_SIZE_CLASS_MIN	256
+#define BINDER_SIZE_CLASSES	5
+#define BINDER_SIZE_CLASS_CACHE	4
+
 /**
  * struct binder_buffer - buffer used for binder transactions
  * @entry:              entry alloc->buffers
  * @rb_node:            node for allocated_buffers/free_buffers rb trees
+ * @class_entry:        entry in alloc->class_free while cached
  * @free:               true if buffer is free
  * @allow_user_free:    describe the second member of struct blah,
  * @async_transaction:  describe the second member of struct blah,
@@ -47,6 +58,7 @@ struct binder_buffer {
 	struct list_head entry; /* free and allocated entries by address */
 	struct rb_node rb_node; /* free entry by size or allocated entry */
 				/* by address */
+	struct list_head class_entry;
 	unsigned free:1;
 	unsigned allow_user_free:1;
 	unsigned async_transaction:1;
@@ -66,11 +78,15 @@ struct binder_buffer {
  * @page_ptr: pointer to physical page in mmap'd space
  * @lru:      entry in binder_alloc_lru
  * @alloc:    binder_alloc for a proc
+ * @lru_time: jiffies when the page was put on binder_alloc_lru
+ * @rotated:  the shrinker already passed over the page once
  */
 struct binder_lru_page {
 	struct list_head lru;
 	struct page *page_ptr;
 	struct binder_alloc *alloc;
+	unsigned long lru_time;
+	bool rotated;
 };
 
 /**
@@ -92,6 +108,12 @@ struct binder_lru_page {
  * @buffer_size:        size of address space specified via mmap
  * @pid:                pid for associated binder_proc (invariant after init)
  * @pages_high:         high watermark of offset in @pages
+ * @class_free:         cached buffers per size class, neither free nor
+ *                      allocated, their pages are kept off the lru
+ * @class_count:        number of buffers on each @class_free list
+ * @class_cache:        size classes are in use (set at mmap)
+ * @pinned_pages:       pages at the start of the buffer space that never
+ *                      go to the lru once allocated (set at mmap)
  *
  * Bookkeeping structure for per-proc address space management for binder
  * buffers. It is normally initialized during binder_init() and binder_mmap()
@@ -113,6 +135,10 @@ struct binder_alloc {
 	uint32_t buffer_free;
 	int pid;
 	size_t pages_high;
+	struct list_head class_free[BINDER_SIZE_CLASSES];
+	unsigned int class_count[BINDER_SIZE_CLASSES];
+	bool class_cache;
+	size_t pinned_pages;
 };
 
 #ifdef CONFIG_ANDROID_BINDER_IPC_SELFTEST
@@ -123,6 +149,7 @@ static inline void binder_selftest_alloc(struct binder_alloc *alloc) {}
 enum lru_status binder_alloc_free_page(struct list_head *item,
 				       struct list_lru_one *lru,
 				       spinlock_t *lock, void *cb_arg);
+extern unsigned long binder_alloc_shrink(unsigned long nr_to_scan);
 extern struct binder_buffer *binder_alloc_new_buf(struct binder_alloc *alloc,
 						  size_t data_size,
 						  size_t offsets_size,
@@ -19,6 +19,8 @@
 
 #include <linux/mm_types.h>
 #include <linux/err.h>
+#include <linux/ktime.h>
+#include <linux/sizes.h>
 #include "binder_alloc.h"
 
 #define BUFFER_NUM 5
@@ -279,6 +281,53 @@ static void binder_selftest_alloc_offset(struct binder_alloc *alloc,
 	}
 }
 
+/**
+ * binder_selftest_reclaim() - Time the shrinker reclaiming 64MB.
+ * @alloc: Pointer to alloc struct.
+ *
+ * Populate the whole buffer space, free it to the lru and time
+ * binder_alloc_shrink() taking it back, until 64MB went through.
+ */
+static void binder_selftest_reclaim(struct binder_alloc *alloc)
+{
+	struct binder_buffer *buffer;
+	unsigned long freed, count;
+	size_t reclaimed = 0;
+	s64 elapsed = 0;
+	ktime_t start;
+	int idle;
+
+	while (reclaimed < SZ_64M) {
+		buffer = binder_alloc_new_buf(alloc, alloc->buffer_size,
+					      0, 0, 0);
+		if (IS_ERR(buffer)) {
+			pr_err("reclaim: failed to alloc %zu bytes\n",
+			       alloc->buffer_size);
+			binder_selftest_failures++;
+			return;
+		}
+		binder_alloc_free_buf(alloc, buffer);
+
+		start = ktime_get();
+		idle = 0;
+		while ((count = list_lru_count(&binder_alloc_lru)) &&
+		       idle < 2) {
+			freed = binder_alloc_shrink(count);
+			reclaimed += freed * PAGE_SIZE;
+			idle = freed ? 0 : idle + 1;
+		}
+		elapsed += ktime_to_ns(ktime_sub(ktime_get(), start));
+
+		if (count) {
+			pr_err("reclaim: %lu pages left on lru\n", count);
+			binder_selftest_failures++;
+			return;
+		}
+	}
+	pr_info("reclaimed %zu MB in %lld us\n", reclaimed / SZ_1M,
+		div_s64(elapsed, NSEC_PER_USEC));
+}
+
 /**
  * binder_selftest_alloc() - Test alloc and free of buffer pages.
  * @alloc: Pointer to alloc struct.
@@ -286,11 +335,14 @@ static void binder_selftest_alloc_offset(struct binder_alloc *alloc,
  * Allocate BUFFER_NUM buffers to cover all page alignment cases,
  * then free them in all orders possible. Check that pages are
  * correctly allocated, put onto lru when buffers are freed, and
- * are freed when binder_alloc_free_page is called.
+ * are freed when binder_alloc_free_page is called. Then time the
+ * shrinker reclaiming 64MB of buffer pages.
  */
 void binder_selftest_alloc(struct binder_alloc *alloc)
 {
 	size_t end_offset[BUFFER_NUM];
+	size_t pinned_pages;
+	bool class_cache;
 
 	if (!binder_selftest_run)
 		return;
@@ -298,7 +350,19 @@ void binder_selftest_alloc(struct binder_alloc *alloc)
 	if (!binder_selftest_run || !alloc->vma)
 		goto done;
 	pr_info("STARTED\n");
+	/*
+	 * The test expects exact sized buffers and every freed page on
+	 * the lru. It runs before any transaction, so nothing is cached
+	 * or pinned yet.
+	 */
+	pinned_pages = alloc->pinned_pages;
+	class_cache = alloc->class_cache;
+	alloc->pinned_pages = 0;
+	alloc->class_cache = false;
 	binder_selftest_alloc_offset(alloc, end_offset, 0);
+	binder_selftest_reclaim(alloc);
+	alloc->pinned_pages = pinned_pages;
+	alloc->class_cache = class_cache;
 	binder_selftest_run = false;
 	if (binder_selftest_failures > 0)
 		pr_info("%d tests FAILED\n", binder_selftest_failures);
@@ -25,6 +25,7 @@
 #include <linux/async.h>
 #include <linux/pm_runtime.h>
 #include <linux/pinctrl/devinfo.h>
+#include <linux/sec_ext.h>
 
 #include "base.h"
 #include "power/power.h"
@@ -281,6 +282,10 @@ static int really_probe(struct device *dev, struct device_driver *drv)
 {
 	int ret = 0;
 	int local_trigger_count = atomic_read(&deferred_trigger_count);
+#ifdef CONFIG_SEC_INITCALL_DEBUG
+	ktime_t calltime = ktime_get();
+	bool deferred = false;
+#endif
 
 	atomic_inc(&probe_count);
 	pr_debug("bus: '%s': %s: probing driver %s with device %s\n",
@@ -343,6 +348,9 @@ probe_failed:
 	case -EPROBE_DEFER:
 		/* Driver requested deferred probing */
 		dev_dbg(dev, "Driver %s requests probe deferral\n", drv->name);
+#ifdef CONFIG_SEC_INITCALL_DEBUG
+		deferred = true;
+#endif
 		driver_deferred_probe_add(dev);
 		/* Did a trigger occur while probing? Need to re-trigger if yes */
 		if (local_trigger_count != atomic_read(&deferred_trigger_count))
@@ -365,6 +373,11 @@ probe_failed:
 	 */
 	ret = 0;
 done:
+#ifdef CONFIG_SEC_INITCALL_DEBUG
+	sec_initcall_debug_add_probe(dev, drv,
+		(unsigned long long)ktime_to_ns(ktime_sub(ktime_get(), calltime)) >> 10,
+		deferred);
+#endif
 	atomic_dec(&probe_count);
 	wake_up_all(&probe_waitqueue);
 	return ret;
@@ -786,6 +786,8 @@ static int device_resume(struct device *dev, pm_message_t state, bool async)
 	TRACE_DEVICE(dev);
 	TRACE_RESUME(0);
 
+	dev->power.resume_start = ktime_get();
+
 	if (dev->power.syscore)
 		goto Complete;
 
@@ -799,6 +801,12 @@ static int device_resume(struct device *dev, pm_message_t state, bool async)
 	}
 
 	dpm_wait(dev->parent, async);
+	/* A parent finishing after we started waiting held us up */
+	if (dev->parent && ktime_after(dev->parent->power.resume_end,
+				       dev->power.resume_start)) {
+		dev->power.resume_blocker = dev->parent;
+		dev->power.resume_start = dev->parent->power.resume_end;
+	}
 	dpm_watchdog_set(&wd, dev);
 	device_lock(dev);
 
@@ -861,6 +869,7 @@ static int device_resume(struct device *dev, pm_message_t state, bool async)
 	dpm_watchdog_clear(&wd);
 
  Complete:
+	dev->power.resume_end = ktime_get();
 	complete_all(&dev->power.completion);
 
 	TRACE_RESUME(error);
@@ -868,6 +877,59 @@ static int device_resume(struct device *dev, pm_message_t state, bool async)
 	return error;
 }
 
+#define DPM_CRITICAL_PATH_MAX	16
+
+static bool dpm_resumed_in(struct device *dev, ktime_t starttime)
+{
+	struct device *d;
+
+	list_for_each_entry(d, &dpm_prepared_list, power.entry)
+		if (d == dev)
+			return !ktime_before(dev->power.resume_end, starttime);
+
+	return false;
+}
+
+/**
+ * dpm_show_critical_path - Log the chain of devices that bounded resume.
+ * @starttime: Start of the resume phase.
+ *
+ * Start from the device that finished last and follow what each device
+ * waited on, its parent or the synchronous device resumed before it.
+ * Must be called with dpm_list_mtx held.
+ */
+static void dpm_show_critical_path(ktime_t starttime)
+{
+	struct device *path[DPM_CRITICAL_PATH_MAX];
+	struct device *dev, *last = NULL;
+	int n = 0;
+
+	list_for_each_entry(dev, &dpm_prepared_list, power.entry) {
+		if (ktime_before(dev->power.resume_end, starttime))
+			continue;
+		if (!last || ktime_after(dev->power.resume_end,
+					 last->power.resume_end))
+			last = dev;
+	}
+
+	for (dev = last; dev && n < DPM_CRITICAL_PATH_MAX;
+	     dev = dev->power.resume_blocker) {
+		path[n++] = dev;
+		if (!dev->power.resume_blocker ||
+		    !dpm_resumed_in(dev->power.resume_blocker, starttime))
+			break;
+	}
+
+	while (n--) {
+		dev = path[n];
+		pr_info("PM: resume path: %s%s %lld usecs at +%lld usecs\n",
+			dev_name(dev), is_async(dev) ? " (async)" : "",
+			ktime_us_delta(dev->power.resume_end,
+				       dev->power.resume_start),
+			ktime_us_delta(dev->power.resume_start, starttime));
+	}
+}
+
 static void async_resume(void *data, async_cookie_t cookie)
 {
 	struct device *dev = (struct device *)data;
@@ -888,7 +950,7 @@ static void async_resume(void *data, async_cookie_t cookie)
  */
 void dpm_resume(pm_message_t state)
 {
-	struct device *dev;
+	struct device *dev, *prev_sync = NULL;
 	ktime_t starttime = ktime_get();
 
 	trace_suspend_resume(TPS("dpm_resume"), state.event, true);
@@ -900,6 +962,7 @@ void dpm_resume(pm_message_t state)
 
 	list_for_each_entry(dev, &dpm_suspended_list, power.entry) {
 		reinit_completion(&dev->power.completion);
+		dev->power.resume_blocker = NULL;
 		if (is_async(dev)) {
 			get_device(dev);
 			async_schedule(async_resume, dev);
@@ -912,6 +975,9 @@ void dpm_resume(pm_message_t state)
 		if (!is_async(dev)) {
 			int error;
 
+			/* synchronous devices queue behind each other */
+			dev->power.resume_blocker = prev_sync;
+			prev_sync = dev;
 			mutex_unlock(&dpm_list_mtx);
 
 			error = device_resume(dev, state, false);
@@ -932,6 +998,12 @@ void dpm_resume(pm_message_t state)
 	async_synchronize_full();
 	dpm_show_time(starttime, state, NULL);
 
+	if (pm_print_times_enabled) {
+		mutex_lock(&dpm_list_mtx);
+		dpm_show_critical_path(starttime);
+		mutex_unlock(&dpm_list_mtx);
+	}
+
 	cpufreq_resume();
 	trace_suspend_resume(TPS("dpm_resume"), state.event, false);
 }
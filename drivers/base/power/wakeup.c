@@ -133,6 +133,16 @@ void wakeup_source_drop(struct wakeup_source *ws)
 }
 EXPORT_SYMBOL_GPL(wakeup_source_drop);
 
+/*
+ * Move the events counted without the lock into the plain counters.
+ * Only the owner of ws->lock or the last user of @ws may call this.
+ */
+static void wakeup_source_fold(struct wakeup_source *ws)
+{
+	ws->event_count += atomic_xchg(&ws->lazy_events, 0);
+	ws->wakeup_count += atomic_xchg(&ws->lazy_wakeups, 0);
+}
+
 /*
  * Record wakeup_source statistics being deleted into a dummy wakeup_source.
  */
@@ -142,6 +152,7 @@ static void wakeup_source_record(struct wakeup_source *ws)
 
 	spin_lock_irqsave(&deleted_ws.lock, flags);
 
+	wakeup_source_fold(ws);
 	if (ws->event_count) {
 		deleted_ws.total_time =
 			ktime_add(deleted_ws.total_time, ws->total_time);
@@ -661,6 +672,22 @@ void __pm_stay_awake(struct wakeup_source *ws)
 	if (!ws)
 		return;
 
+	/*
+	 * Already active with no timeout to cancel: nothing changes but the
+	 * event counters, so skip the lock. A racing __pm_relax() simply
+	 * orders before this call.
+	 */
+	if (ws->active && !READ_ONCE(ws->timer_expires)
+#ifdef CONFIG_BOEFFLA_WL_BLOCKER
+	    && !wl_blocker_active && !wl_blocker_debug
+#endif
+	    ) {
+		atomic_inc(&ws->lazy_events);
+		if (events_check_enabled)
+			atomic_inc(&ws->lazy_wakeups);
+		return;
+	}
+
 	spin_lock_irqsave(&ws->lock, flags);
 
 	wakeup_source_report_event(ws);
@@ -849,6 +876,10 @@ void __pm_relax(struct wakeup_source *ws)
 	if (!ws)
 		return;
 
+	/* Nothing to do, and a racing activation orders after this call */
+	if (!ws->active)
+		return;
+
 	spin_lock_irqsave(&ws->lock, flags);
 	if (ws->active)
 		wakeup_source_deactivate(ws);
@@ -1188,6 +1219,7 @@ static int print_wakeup_source_stats(struct seq_file *m,
 
 	spin_lock_irqsave(&ws->lock, flags);
 
+	wakeup_source_fold(ws);
 	total_time = ws->total_time;
 	max_time = ws->max_time;
 	prevent_sleep_time = ws->prevent_sleep_time;
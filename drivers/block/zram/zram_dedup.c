@@ -0,0 +1,160 @@
+/*
+ * Content-based deduplication of zram objects
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ */
+
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <linux/jhash.h>
+#include <linux/log2.h>
+
+#include "zram_drv.h"
+
+/* One hash bucket per this many disk pages */
+#define ZRAM_DEDUP_PAGES_PER_BUCKET	16
+
+u64 zram_dedup_dup_size(struct zram *zram)
+{
+	return (u64)atomic64_read(&zram->stats.dup_data_size);
+}
+
+u64 zram_dedup_meta_size(struct zram *zram)
+{
+	return (u64)atomic64_read(&zram->stats.meta_data_size);
+}
+
+u32 zram_dedup_checksum(const void *mem)
+{
+	return jhash2(mem, PAGE_SIZE / sizeof(u32), 0);
+}
+
+static struct zram_dedup_bucket *zram_dedup_bucket(struct zram *zram,
+						u32 checksum)
+{
+	return &zram->dedup_hash[checksum & (zram->dedup_hash_size - 1)];
+}
+
+/*
+ * Compressors are deterministic, so identical pages produce identical
+ * objects and comparing the object bytes is enough to confirm a match.
+ * On a hit the entry gains a reference on behalf of the caller.
+ */
+struct zram_dedup_entry *zram_dedup_find(struct zram *zram, u32 checksum,
+				const void *src, unsigned int len)
+{
+	struct zram_dedup_bucket *bucket = zram_dedup_bucket(zram, checksum);
+	struct zram_dedup_entry *entry;
+	void *obj;
+	bool match;
+
+	spin_lock(&bucket->lock);
+	hlist_for_each_entry(entry, &bucket->head, node) {
+		if (entry->checksum != checksum || entry->len != len)
+			continue;
+
+		obj = zs_map_object(zram->mem_pool, entry->handle, ZS_MM_RO);
+		match = !memcmp(obj, src, len);
+		zs_unmap_object(zram->mem_pool, entry->handle);
+
+		if (match) {
+			entry->refcount++;
+			spin_unlock(&bucket->lock);
+			atomic64_add(len, &zram->stats.dup_data_size);
+			return entry;
+		}
+	}
+	spin_unlock(&bucket->lock);
+
+	return NULL;
+}
+
+struct zram_dedup_entry *zram_dedup_insert(struct zram *zram, u32 checksum,
+				unsigned long handle, unsigned int len)
+{
+	struct zram_dedup_bucket *bucket = zram_dedup_bucket(zram, checksum);
+	struct zram_dedup_entry *entry;
+
+	entry = kmalloc(sizeof(*entry), GFP_ATOMIC | __GFP_NOWARN);
+	if (!entry)
+		return NULL;
+
+	entry->handle = handle;
+	entry->refcount = 1;
+	entry->len = len;
+	entry->checksum = checksum;
+
+	spin_lock(&bucket->lock);
+	hlist_add_head(&entry->node, &bucket->head);
+	spin_unlock(&bucket->lock);
+
+	atomic64_add(sizeof(*entry), &zram->stats.meta_data_size);
+
+	return entry;
+}
+
+/*
+ * Drop a slot's reference. Returns true if it was the last one, in which
+ * case the object has been freed.
+ */
+bool zram_dedup_put(struct zram *zram, struct zram_dedup_entry *entry)
+{
+	struct zram_dedup_bucket *bucket;
+	unsigned long refcount;
+	unsigned int len;
+
+	bucket = zram_dedup_bucket(zram, entry->checksum);
+
+	spin_lock(&bucket->lock);
+	refcount = --entry->refcount;
+	/* a concurrent final put may free the entry once we unlock */
+	len = entry->len;
+	if (!refcount)
+		hlist_del(&entry->node);
+	spin_unlock(&bucket->lock);
+
+	if (refcount) {
+		atomic64_sub(len, &zram->stats.dup_data_size);
+		return false;
+	}
+
+	zs_free(zram->mem_pool, entry->handle);
+	kfree(entry);
+	atomic64_sub(sizeof(*entry), &zram->stats.meta_data_size);
+
+	return true;
+}
+
+int zram_dedup_init(struct zram *zram, size_t num_pages)
+{
+	size_t i;
+
+	if (!zram->use_dedup)
+		return 0;
+
+	zram->dedup_hash_size = roundup_pow_of_two(max_t(size_t, 1,
+				num_pages / ZRAM_DEDUP_PAGES_PER_BUCKET));
+	zram->dedup_hash = vzalloc(zram->dedup_hash_size *
+				sizeof(struct zram_dedup_bucket));
+	if (!zram->dedup_hash)
+		return -ENOMEM;
+
+	for (i = 0; i < zram->dedup_hash_size; i++) {
+		spin_lock_init(&zram->dedup_hash[i].lock);
+		INIT_HLIST_HEAD(&zram->dedup_hash[i].head);
+	}
+
+	atomic64_add(zram->dedup_hash_size * sizeof(struct zram_dedup_bucket),
+			&zram->stats.meta_data_size);
+	return 0;
+}
+
+void zram_dedup_fini(struct zram *zram)
+{
+	vfree(zram->dedup_hash);
+	zram->dedup_hash = NULL;
+	zram->dedup_hash_size = 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * Content-based deduplication of zram objects
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef _ZRAM_DEDUP_H_
+#define _ZRAM_DEDUP_H_
+
+#include <linux/list.h>
+#include <linux/spinlock.h>
+
+struct zram;
+
+/* Compressed object shared by every slot holding the same page content */
+struct zram_dedup_entry {
+	struct hlist_node node;
+	unsigned long handle;
+	unsigned long refcount;
+	unsigned int len;
+	u32 checksum;
+};
+
+struct zram_dedup_bucket {
+	spinlock_t lock;
+	struct hlist_head head;
+};
+
+#ifdef CONFIG_ZRAM_DEDUP
+u64 zram_dedup_dup_size(struct zram *zram);
+u64 zram_dedup_meta_size(struct zram *zram);
+
+u32 zram_dedup_checksum(const void *mem);
+struct zram_dedup_entry *zram_dedup_find(struct zram *zram, u32 checksum,
+				const void *src, unsigned int len);
+struct zram_dedup_entry *zram_dedup_insert(struct zram *zram, u32 checksum,
+				unsigned long handle, unsigned int len);
+bool zram_dedup_put(struct zram *zram, struct zram_dedup_entry *entry);
+
+int zram_dedup_init(struct zram *zram, size_t num_pages);
+void zram_dedup_fini(struct zram *zram);
+#else
+static inline u64 zram_dedup_dup_size(struct zram *zram) { return 0; }
+static inline u64 zram_dedup_meta_size(struct zram *zram) { return 0; }
+
+static inline u32 zram_dedup_checksum(const void *mem) { return 0; }
+static inline struct zram_dedup_entry *zram_dedup_find(struct zram *zram,
+		u32 checksum, const void *src, unsigned int len) { return NULL; }
+static inline struct zram_dedup_entry *zram_dedup_insert(struct zram *zram,
+		u32 checksum, unsigned long handle,
+		unsigned int len) { return NULL; }
+static inline bool zram_dedup_put(struct zram *zram,
+		struct zram_dedup_entry *entry) { return true; }
+
+static inline int zram_dedup_init(struct zram *zram,
+		size_t num_pages) { return 0; }
+static inline void zram_dedup_fini(struct zram *zram) {}
+#endif
+
+#endif /* _ZRAM_DEDUP_H_ */
@@ -32,6 +32,13 @@
 #include <linux/idr.h>
 #include <linux/sysfs.h>
 #include <linux/debugfs.h>
+#include <linux/kthread.h>
+#include <linux/cpumask.h>
+#include <linux/log2.h>
+#include <linux/percpu.h>
+#include <linux/memcontrol.h>
+#include <linux/hash.h>
+#include <linux/seq_file.h>
 
 #include "zram_drv.h"
 
@@ -51,15 +58,87 @@ static unsigned int num_devices = 1;
 static size_t huge_class_size;
 
 static void zram_free_page(struct zram *zram, size_t index);
+static int zram_read_obj(struct zram *zram, u32 index, struct page *page);
+
+#ifdef CONFIG_ZRAM_LOCK_STAT
+static unsigned int zram_lock_hist_bucket(s64 ns)
+{
+	unsigned int bucket = fls64(ns >> ZRAM_LOCK_HIST_SHIFT);
+
+	return min_t(unsigned int, bucket, ZRAM_LOCK_HIST_BUCKETS - 1);
+}
+
+/* preemption is disabled while a slot lock is held */
+static void zram_lock_stat_acquired(struct zram *zram, ktime_t wait_start)
+{
+	struct zram_lock_stat *stat = this_cpu_ptr(zram->lock_stat);
+
+	stat->hold_start = ktime_get();
+	stat->acquired++;
+	if (wait_start.tv64) {
+		stat->contended++;
+		stat->wait_hist[zram_lock_hist_bucket(ktime_to_ns(
+			ktime_sub(stat->hold_start, wait_start)))]++;
+	}
+}
+
+static void zram_lock_stat_release(struct zram *zram)
+{
+	struct zram_lock_stat *stat = this_cpu_ptr(zram->lock_stat);
+
+	stat->hold_hist[zram_lock_hist_bucket(ktime_to_ns(
+		ktime_sub(ktime_get(), stat->hold_start)))]++;
+}
+
+static ktime_t zram_lock_stat_clock(void)
+{
+	return ktime_get();
+}
+#else
+static void zram_lock_stat_acquired(struct zram *zram, ktime_t wait_start) {}
+static void zram_lock_stat_release(struct zram *zram) {}
+static ktime_t zram_lock_stat_clock(void) { return ktime_set(0, 0); }
+#endif
+
+static spinlock_t *zram_slot_spinlock(struct zram *zram, u32 index)
+{
+	/* adjacent slots map to different, cacheline-aligned buckets */
+	return &zram->slot_locks[index & (zram->nr_slot_locks - 1)].lock;
+}
 
 static void zram_slot_lock(struct zram *zram, u32 index)
 {
-	bit_spin_lock(ZRAM_LOCK, &zram->table[index].value);
+	ktime_t wait_start;
+
+	if (zram->slot_locks) {
+		spinlock_t *lock = zram_slot_spinlock(zram, index);
+
+		if (likely(spin_trylock(lock))) {
+			zram_lock_stat_acquired(zram, ktime_set(0, 0));
+			return;
+		}
+		wait_start = zram_lock_stat_clock();
+		spin_lock(lock);
+	} else {
+		unsigned long *value = &zram->table[index].value;
+
+		if (likely(bit_spin_trylock(ZRAM_LOCK, value))) {
+			zram_lock_stat_acquired(zram, ktime_set(0, 0));
+			return;
+		}
+		wait_start = zram_lock_stat_clock();
+		bit_spin_lock(ZRAM_LOCK, value);
+	}
+	zram_lock_stat_acquired(zram, wait_start);
 }
 
 static void zram_slot_unlock(struct zram *zram, u32 index)
 {
-	bit_spin_unlock(ZRAM_LOCK, &zram->table[index].value);
+	zram_lock_stat_release(zram);
+	if (zram->slot_locks)
+		spin_unlock(zram_slot_spinlock(zram, index));
+	else
+		bit_spin_unlock(ZRAM_LOCK, &zram->table[index].value);
 }
 
 static inline bool init_done(struct zram *zram)
@@ -81,7 +160,11 @@ static inline struct zram *dev_to_zram(struct device *dev)
 
 static unsigned long zram_get_handle(struct zram *zram, u32 index)
 {
-	return zram->table[index].handle;
+	unsigned long handle = zram->table[index].handle;
+
+	if (zram->table[index].value & BIT(ZRAM_DEDUP))
+		return ((struct zram_dedup_entry *)handle)->handle;
+	return handle;
 }
 
 static void zram_set_handle(struct zram *zram, u32 index, unsigned long handle)
@@ -205,6 +288,87 @@ static inline void zram_fill_page(char *ptr, unsigned long len,
 	}
 }
 
+#ifdef CONFIG_ZRAM_DEDUP
+static bool zram_dedup_enabled(struct zram *zram)
+{
+	return zram->use_dedup;
+}
+
+static ssize_t use_dedup_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%d\n", zram->use_dedup);
+}
+
+static ssize_t use_dedup_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	bool val;
+
+	if (strtobool(buf, &val))
+		return -EINVAL;
+
+	down_write(&zram->init_lock);
+	if (init_done(zram)) {
+		up_write(&zram->init_lock);
+		pr_info("Can't change dedup usage for initialized device\n");
+		return -EBUSY;
+	}
+
+	zram->use_dedup = val;
+	up_write(&zram->init_lock);
+
+	return len;
+}
+#else
+static bool zram_dedup_enabled(struct zram *zram) { return false; }
+#endif
+
+/*
+ * Share an identical object already in the dedup index, if there is one.
+ * @buffer holds the compressed data; huge objects are stored as the raw
+ * @page and are compared as such.
+ */
+static struct zram_dedup_entry *zram_dedup_match(struct zram *zram,
+			u32 checksum, struct page *page, void *buffer,
+			unsigned int comp_len)
+{
+	struct zram_dedup_entry *entry;
+	void *src = buffer;
+
+	if (comp_len == PAGE_SIZE)
+		src = kmap_atomic(page);
+	entry = zram_dedup_find(zram, checksum, src, comp_len);
+	if (comp_len == PAGE_SIZE)
+		kunmap_atomic(src);
+
+	return entry;
+}
+
+/*
+ * Random-looking data (compressed media, encrypted files) uses nearly
+ * every byte value in a small sample, while anything a compressor can
+ * shrink keeps repeating a few of them.
+ */
+static bool page_incompressible(void *ptr)
+{
+	DECLARE_BITMAP(seen, 256);
+	unsigned int i, j;
+	u8 *line;
+
+	bitmap_zero(seen, 256);
+	for (i = 0; i < ZRAM_ENTROPY_LINES; i++) {
+		line = (u8 *)ptr + i * (PAGE_SIZE / ZRAM_ENTROPY_LINES);
+		for (j = 0; j < ZRAM_ENTROPY_LINE_SIZE; j++)
+			__set_bit(line[j], seen);
+	}
+
+	return bitmap_weight(seen, 256) >= ZRAM_ENTROPY_THRESHOLD;
+}
+
 static bool page_same_filled(void *ptr, unsigned long *element)
 {
 	unsigned int pos;
@@ -297,6 +461,9 @@ static void reset_bdev(struct zram *zram)
 	if (!zram_wb_enabled(zram))
 		return;
 
+	if (zram->wb_readahead)
+		zram_ra_free(zram);
+
 	bdev = zram->bdev;
 	if (zram->old_block_size)
 		set_blocksize(bdev, zram->old_block_size);
@@ -611,165 +778,1162 @@ static int write_to_bdev(struct zram *zram, struct bio_vec *bvec,
 	return 0;
 }
 
-static void zram_wb_clear(struct zram *zram, u32 index)
+/*
+ * Writeback readahead: when written-back slots are read in sequence, the
+ * following slots whose blocks are contiguous on the backing device are
+ * fetched with one bio into a small per-device cache. A cache page is
+ * locked while its read is in flight, and held with get_page() by
+ * readers copying out of it.
+ */
+static void zram_ra_free(struct zram *zram)
 {
-	unsigned long entry;
-
-	zram_clear_flag(zram, index, ZRAM_WB);
-	entry = zram_get_element(zram, index);
-	zram_set_element(zram, index, 0);
-	put_entry_bdev(zram, entry);
-}
+	int i;
 
-#else
-static bool zram_wb_enabled(struct zram *zram) { return false; }
-static inline void reset_bdev(struct zram *zram) {};
-static int write_to_bdev(struct zram *zram, struct bio_vec *bvec,
-					u32 index, struct bio *parent,
-					unsigned long *pentry)
+	for (i = 0; i < ZRAM_RA_PAGES; i++) {
+		struct page *page = zram->ra[i].page;
 
-{
-	return -EIO;
+		if (!page)
+			continue;
+		wait_on_page_locked(page);
+		__free_page(page);
+		zram->ra[i].page = NULL;
+	}
+	zram->wb_readahead = false;
 }
 
-static int read_from_bdev(struct zram *zram, struct bio_vec *bvec,
-			unsigned long entry, struct bio *parent, bool sync)
+static int zram_ra_alloc(struct zram *zram)
 {
-	return -EIO;
-}
-static void zram_wb_clear(struct zram *zram, u32 index) {}
-#endif
-
-#ifdef CONFIG_ZRAM_MEMORY_TRACKING
+	int i;
 
-static struct dentry *zram_debugfs_root;
+	spin_lock_init(&zram->ra_lock);
+	zram->ra_last_index = ZRAM_RA_INVALID;
+	for (i = 0; i < ZRAM_RA_PAGES; i++) {
+		zram->ra[i].page = alloc_page(GFP_NOIO);
+		if (!zram->ra[i].page) {
+			zram_ra_free(zram);
+			return -ENOMEM;
+		}
+		zram->ra[i].index = ZRAM_RA_INVALID;
+	}
 
-static void zram_debugfs_create(void)
-{
-	zram_debugfs_root = debugfs_create_dir("zram", NULL);
+	return 0;
 }
 
-static void zram_debugfs_destroy(void)
+/* Called with the slot lock of @index held */
+static void zram_ra_invalidate(struct zram *zram, u32 index)
 {
-	debugfs_remove_recursive(zram_debugfs_root);
+	int i;
+
+	if (!zram->wb_readahead)
+		return;
+
+	spin_lock(&zram->ra_lock);
+	for (i = 0; i < ZRAM_RA_PAGES; i++) {
+		if (zram->ra[i].index == index)
+			zram->ra[i].index = ZRAM_RA_INVALID;
+	}
+	spin_unlock(&zram->ra_lock);
 }
 
-static void zram_accessed(struct zram *zram, u32 index)
+/* Copy slot @index out of the readahead cache. Returns true on a hit. */
+static bool zram_ra_read(struct zram *zram, u32 index, unsigned long entry,
+			struct page *page)
 {
-	zram->table[index].ac_time = ktime_get_boottime();
+	struct zram_ra_entry *ra = NULL;
+	struct page *cpage;
+	bool hit;
+	int i;
+
+	if (!zram->wb_readahead)
+		return false;
+
+	spin_lock(&zram->ra_lock);
+	for (i = 0; i < ZRAM_RA_PAGES; i++) {
+		if (zram->ra[i].index == index && zram->ra[i].entry == entry) {
+			ra = &zram->ra[i];
+			break;
+		}
+	}
+	if (!ra) {
+		spin_unlock(&zram->ra_lock);
+		return false;
+	}
+	cpage = ra->page;
+	get_page(cpage);
+	spin_unlock(&zram->ra_lock);
+
+	/*
+	 * Inside ->make_request_fn our own prefetch bio may still sit on
+	 * current->bio_list, so only wait for it from a plain context.
+	 */
+	if (PageLocked(cpage)) {
+		if (current->bio_list) {
+			put_page(cpage);
+			return false;
+		}
+		wait_on_page_locked(cpage);
+	}
+
+	hit = PageUptodate(cpage);
+	if (hit) {
+		copy_highpage(page, cpage);
+		atomic64_inc(&zram->stats.wb_ra_hits);
+	}
+
+	spin_lock(&zram->ra_lock);
+	if (ra->index == index)
+		ra->index = ZRAM_RA_INVALID;
+	spin_unlock(&zram->ra_lock);
+	put_page(cpage);
+
+	return hit;
 }
 
-static void zram_reset_access(struct zram *zram, u32 index)
+static void zram_ra_end_io(struct bio *bio)
 {
-	zram->table[index].ac_time.tv64 = 0;
+	struct bio_vec *bvec;
+	int i;
+
+	bio_for_each_segment_all(bvec, bio, i) {
+		struct page *page = bvec->bv_page;
+
+		if (bio->bi_error)
+			ClearPageUptodate(page);
+		else
+			SetPageUptodate(page);
+		unlock_page(page);
+	}
+	bio_put(bio);
 }
 
-static ssize_t read_block_state(struct file *file, char __user *buf,
-				size_t count, loff_t *ppos)
+/*
+ * Claim an idle cache page for slot @index and lock it for I/O.
+ * Returns NULL if the slot is already cached or every page is busy.
+ */
+static struct page *zram_ra_claim(struct zram *zram, u32 index,
+				unsigned long entry)
 {
-	char *kbuf;
-	ssize_t index, written = 0;
-	struct zram *zram = file->private_data;
-	unsigned long nr_pages = zram->disksize >> PAGE_SHIFT;
-	struct timespec64 ts;
-	gfp_t kmalloc_flags;
+	struct page *page = NULL;
+	int i, n;
 
-	kmalloc_flags = GFP_KERNEL;
-	if (count > PAGE_SIZE)
-		kmalloc_flags |= __GFP_NOWARN | __GFP_NORETRY;
+	spin_lock(&zram->ra_lock);
+	for (i = 0; i < ZRAM_RA_PAGES; i++) {
+		if (zram->ra[i].index == index)
+			goto out;
+	}
 
-	kbuf = kmalloc_node(count, kmalloc_flags, NUMA_NO_NODE);
-	if (!kbuf && count > PAGE_SIZE)
-		kbuf = vmalloc(count);
+	for (n = 0; n < ZRAM_RA_PAGES; n++) {
+		struct zram_ra_entry *ra;
 
-	if (!kbuf)
-		return -ENOMEM;
+		ra = &zram->ra[zram->ra_next];
+		zram->ra_next = (zram->ra_next + 1) % ZRAM_RA_PAGES;
+		if (page_count(ra->page) != 1 || !trylock_page(ra->page))
+			continue;
 
-	down_read(&zram->init_lock);
-	if (!init_done(zram)) {
-		up_read(&zram->init_lock);
-		kvfree(kbuf);
-		return -EINVAL;
+		ClearPageUptodate(ra->page);
+		ra->index = index;
+		ra->entry = entry;
+		page = ra->page;
+		break;
 	}
+out:
+	spin_unlock(&zram->ra_lock);
+	return page;
+}
 
-	for (index = *ppos; index < nr_pages; index++) {
-		int copied;
+static void zram_ra_prefetch(struct zram *zram, u32 index, unsigned long entry)
+{
+	u32 nr_slots = zram->disksize >> PAGE_SHIFT;
+	struct page *pages[ZRAM_RA_PAGES];
+	struct bio *bio;
+	int i, nr = 0;
 
-		zram_slot_lock(zram, index);
-		if (!zram_allocated(zram, index))
-			goto next;
+	while (nr < ZRAM_RA_PAGES && index + nr + 1 < nr_slots) {
+		u32 next = index + nr + 1;
+		bool contiguous;
 
-		ts = ktime_to_timespec64(zram->table[index].ac_time);
-		copied = snprintf(kbuf + written, count,
-			"%12zd %12lld.%06lu %c%c%c\n",
-			index, (s64)ts.tv_sec,
-			ts.tv_nsec / NSEC_PER_USEC,
-			zram_test_flag(zram, index, ZRAM_SAME) ? 's' : '.',
-			zram_test_flag(zram, index, ZRAM_WB) ? 'w' : '.',
-			zram_test_flag(zram, index, ZRAM_HUGE) ? 'h' : '.');
+		zram_slot_lock(zram, next);
+		contiguous = zram_test_flag(zram, next, ZRAM_WB) &&
+			zram_get_element(zram, next) == entry + nr + 1;
+		zram_slot_unlock(zram, next);
+		if (!contiguous)
+			break;
 
-		if (count <= copied) {
-			zram_slot_unlock(zram, index);
+		pages[nr] = zram_ra_claim(zram, next, entry + nr + 1);
+		if (!pages[nr])
 			break;
-		}
-		written += copied;
-		count -= copied;
-next:
-		zram_slot_unlock(zram, index);
-		*ppos += 1;
+		nr++;
 	}
 
-	up_read(&zram->init_lock);
-	if (copy_to_user(buf, kbuf, written))
-		written = -EFAULT;
-	kvfree(kbuf);
+	if (!nr)
+		return;
 
-	return written;
-}
+	bio = bio_alloc(GFP_NOIO, nr);
+	if (!bio)
+		goto fail;
 
-static const struct file_operations proc_zram_block_state_op = {
-	.open = simple_open,
-	.read = read_block_state,
-	.llseek = default_llseek,
-};
+	bio->bi_iter.bi_sector = (entry + 1) * (PAGE_SIZE >> 9);
+	bio->bi_bdev = zram->bdev;
+	bio->bi_rw = READA;
+	bio->bi_end_io = zram_ra_end_io;
+	for (i = 0; i < nr; i++) {
+		if (!bio_add_page(bio, pages[i], PAGE_SIZE, 0))
+			break;
+	}
 
-static void zram_debugfs_register(struct zram *zram)
-{
-	if (!zram_debugfs_root)
-		return;
+	/* pages the bio could not take stay !Uptodate and just miss */
+	for (; i < nr; i++)
+		unlock_page(pages[i]);
 
-	zram->debugfs_dir = debugfs_create_dir(zram->disk->disk_name,
-						zram_debugfs_root);
-	debugfs_create_file("block_state", 0400, zram->debugfs_dir,
-				zram, &proc_zram_block_state_op);
+	atomic64_add(bio->bi_vcnt, &zram->stats.wb_ra_pages);
+	submit_bio(READA, bio);
+	return;
+fail:
+	for (i = 0; i < nr; i++)
+		unlock_page(pages[i]);
 }
 
-static void zram_debugfs_unregister(struct zram *zram)
+static void zram_ra_update(struct zram *zram, u32 index, unsigned long entry)
 {
-	debugfs_remove_recursive(zram->debugfs_dir);
+	bool sequential;
+
+	if (!zram->wb_readahead)
+		return;
+
+	spin_lock(&zram->ra_lock);
+	sequential = zram->ra_last_index != ZRAM_RA_INVALID &&
+			index == zram->ra_last_index + 1;
+	zram->ra_last_index = index;
+	spin_unlock(&zram->ra_lock);
+
+	if (sequential)
+		zram_ra_prefetch(zram, index, entry);
 }
-#else
-static void zram_debugfs_create(void) {};
-static void zram_debugfs_destroy(void) {};
-static void zram_accessed(struct zram *zram, u32 index) {};
-static void zram_reset_access(struct zram *zram, u32 index) {};
-static void zram_debugfs_register(struct zram *zram) {};
-static void zram_debugfs_unregister(struct zram *zram) {};
-#endif
 
-/*
- * We switched to per-cpu streams and this attr is not needed anymore.
- * However, we will keep it around for some time, because:
- * a) we may revert per-cpu streams in the future
- * b) it's visible to user space and we need to follow our 2 years
- *    retirement rule; but we already have a number of 'soon to be
- *    altered' attrs, so max_comp_streams need to wait for the next
- *    layoff cycle.
- */
-static ssize_t max_comp_streams_show(struct device *dev,
+static ssize_t wb_readahead_show(struct device *dev,
 		struct device_attribute *attr, char *buf)
 {
-	return scnprintf(buf, PAGE_SIZE, "%d\n", num_online_cpus());
+	struct zram *zram = dev_to_zram(dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%d\n", zram->wb_readahead);
+}
+
+static ssize_t wb_readahead_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	bool val;
+	int err = 0;
+
+	if (strtobool(buf, &val))
+		return -EINVAL;
+
+	down_write(&zram->init_lock);
+	if (init_done(zram)) {
+		pr_info("Can't change readahead for initialized device\n");
+		err = -EBUSY;
+		goto out;
+	}
+
+	if (!zram_wb_enabled(zram)) {
+		err = -ENODEV;
+		goto out;
+	}
+
+	if (val && !zram->wb_readahead) {
+		err = zram_ra_alloc(zram);
+		if (!err)
+			zram->wb_readahead = true;
+	} else if (!val && zram->wb_readahead) {
+		zram_ra_free(zram);
+	}
+out:
+	up_write(&zram->init_lock);
+	return err ? err : len;
+}
+
+static void zram_wb_clear(struct zram *zram, u32 index)
+{
+	unsigned long entry;
+
+	zram_clear_flag(zram, index, ZRAM_WB);
+	entry = zram_get_element(zram, index);
+	zram_set_element(zram, index, 0);
+	put_entry_bdev(zram, entry);
+	zram_ra_invalidate(zram, index);
+}
+
+/* Reserve @nr contiguous backing device blocks, 0 if there is no room */
+static unsigned long get_entries_bdev(struct zram *zram, unsigned int nr)
+{
+	unsigned long entry;
+
+	spin_lock(&zram->bitmap_lock);
+	/* skip 0 bit to confuse zram.handle = 0 */
+	entry = bitmap_find_next_zero_area(zram->bitmap, zram->nr_pages,
+					   1, nr, 0);
+	if (entry >= zram->nr_pages) {
+		spin_unlock(&zram->bitmap_lock);
+		return 0;
+	}
+
+	bitmap_set(zram->bitmap, entry, nr);
+	spin_unlock(&zram->bitmap_lock);
+
+	return entry;
+}
+
+/*
+ * Writeback daemon: idle in-memory slots are decompressed and written to
+ * the backing device in runs of up to ZRAM_WB_BATCH contiguous blocks,
+ * so the device sees a few large sequential writes. The amount written
+ * is capped by a daily byte budget.
+ */
+static void zram_wb_refill_budget(struct zram *zram)
+{
+	if (time_after(jiffies, zram->wb_budget_start + ZRAM_WB_BUDGET_PERIOD)) {
+		zram->wb_budget_start = jiffies;
+		zram->wb_budget_used = 0;
+	}
+}
+
+static unsigned int zram_wb_budget_pages(struct zram *zram)
+{
+	u64 left;
+
+	if (!zram->wb_budget)
+		return ZRAM_WB_BATCH;
+	if (zram->wb_budget_used >= zram->wb_budget)
+		return 0;
+
+	left = (zram->wb_budget - zram->wb_budget_used) >> PAGE_SHIFT;
+	return min_t(u64, left, ZRAM_WB_BATCH);
+}
+
+/*
+ * Gather up to @max idle slots from *@index on, decompressing them into
+ * @pages. Returns the number of slots gathered.
+ */
+static unsigned int zram_wb_gather(struct zram *zram, u32 *index,
+			struct page **pages, u32 *slots,
+			unsigned long *handles, unsigned int max)
+{
+	u32 nr_slots = zram->disksize >> PAGE_SHIFT;
+	unsigned int nr = 0;
+
+	for (; *index < nr_slots && nr < max; (*index)++) {
+		u32 i = *index;
+
+		zram_slot_lock(zram, i);
+		if (!zram_allocated(zram, i) ||
+				!zram_test_flag(zram, i, ZRAM_IDLE) ||
+				zram_test_flag(zram, i, ZRAM_WB) ||
+				zram_test_flag(zram, i, ZRAM_SAME) ||
+				!zram_get_handle(zram, i)) {
+			zram_slot_unlock(zram, i);
+			continue;
+		}
+
+		if (zram_read_obj(zram, i, pages[nr])) {
+			zram_slot_unlock(zram, i);
+			continue;
+		}
+		handles[nr] = zram->table[i].handle;
+		slots[nr++] = i;
+		zram_slot_unlock(zram, i);
+	}
+
+	return nr;
+}
+
+static int zram_wb_submit(struct zram *zram, struct page **pages,
+			unsigned int nr, unsigned long entry)
+{
+	struct bio *bio;
+	unsigned int i;
+	int ret;
+
+	bio = bio_alloc(GFP_KERNEL, nr);
+	if (!bio)
+		return -ENOMEM;
+
+	bio->bi_iter.bi_sector = entry * (PAGE_SIZE >> 9);
+	bio->bi_bdev = zram->bdev;
+	for (i = 0; i < nr; i++) {
+		if (!bio_add_page(bio, pages[i], PAGE_SIZE, 0)) {
+			bio_put(bio);
+			return -EIO;
+		}
+	}
+
+	ret = submit_bio_wait(WRITE, bio);
+	bio_put(bio);
+
+	return ret;
+}
+
+/* Run one writeback pass. Called with init_lock held for read. */
+static void zram_wb_run(struct zram *zram)
+{
+	struct page *pages[ZRAM_WB_BATCH] = { NULL };
+	unsigned long handles[ZRAM_WB_BATCH];
+	u32 slots[ZRAM_WB_BATCH];
+	unsigned long start = jiffies;
+	u64 written = 0;
+	u32 index = 0;
+	int i;
+
+	for (i = 0; i < ZRAM_WB_BATCH; i++) {
+		pages[i] = alloc_page(GFP_KERNEL);
+		if (!pages[i])
+			goto out;
+	}
+
+	mutex_lock(&zram->wb_lock);
+	zram_wb_refill_budget(zram);
+	for (;;) {
+		unsigned int nr, n, max;
+		unsigned long entry = 0;
+
+		max = zram_wb_budget_pages(zram);
+		if (!max)
+			break;
+
+		nr = zram_wb_gather(zram, &index, pages, slots, handles, max);
+		if (!nr)
+			break;
+
+		/* fall back to shorter runs on a fragmented device */
+		for (n = nr; n; n /= 2) {
+			entry = get_entries_bdev(zram, n);
+			if (entry)
+				break;
+		}
+		if (!entry)
+			break;
+
+		/* slots beyond the run are picked up by the next round */
+		if (n < nr)
+			index = slots[n];
+
+		if (zram_wb_submit(zram, pages, n, entry)) {
+			for (i = 0; i < n; i++)
+				put_entry_bdev(zram, entry + i);
+			break;
+		}
+
+		for (i = 0; i < n; i++) {
+			u32 idx = slots[i];
+
+			zram_slot_lock(zram, idx);
+			/* the slot was rewritten or accessed meanwhile */
+			if (zram->table[idx].handle != handles[i] ||
+					!zram_test_flag(zram, idx, ZRAM_IDLE) ||
+					zram_test_flag(zram, idx, ZRAM_WB)) {
+				zram_slot_unlock(zram, idx);
+				put_entry_bdev(zram, entry + i);
+				continue;
+			}
+
+			zram_free_page(zram, idx);
+			zram_set_flag(zram, idx, ZRAM_WB);
+			zram_set_element(zram, idx, entry + i);
+			zram_slot_unlock(zram, idx);
+			atomic64_inc(&zram->stats.pages_stored);
+		}
+
+		written += (u64)n << PAGE_SHIFT;
+		zram->wb_budget_used += (u64)n << PAGE_SHIFT;
+		atomic64_add(n, &zram->stats.wb_pages);
+		cond_resched();
+	}
+
+	if (written) {
+		unsigned int ms = max(jiffies_to_msecs(jiffies - start), 1U);
+
+		zram->wb_last_kbps = div_u64(written * MSEC_PER_SEC, ms) >> 10;
+	}
+	mutex_unlock(&zram->wb_lock);
+out:
+	for (i = 0; i < ZRAM_WB_BATCH; i++) {
+		if (pages[i])
+			__free_page(pages[i]);
+	}
+}
+
+/* called with wb_lock held */
+static void zram_wb_queue(struct zram *zram)
+{
+	if (zram->wb_active && zram_wb_enabled(zram) && zram->wb_interval)
+		mod_delayed_work(system_freezable_power_efficient_wq,
+				 &zram->wb_work, zram->wb_interval * HZ);
+}
+
+static void zram_wb_work(struct work_struct *work)
+{
+	struct zram *zram = container_of(to_delayed_work(work),
+					 struct zram, wb_work);
+
+	down_read(&zram->init_lock);
+	if (!init_done(zram) || !zram_wb_enabled(zram)) {
+		up_read(&zram->init_lock);
+		return;
+	}
+
+	zram_wb_run(zram);
+	mutex_lock(&zram->wb_lock);
+	zram_wb_queue(zram);
+	mutex_unlock(&zram->wb_lock);
+	up_read(&zram->init_lock);
+}
+
+static void zram_wb_start(struct zram *zram)
+{
+	mutex_lock(&zram->wb_lock);
+	zram->wb_active = true;
+	zram_wb_queue(zram);
+	mutex_unlock(&zram->wb_lock);
+}
+
+/*
+ * Clearing wb_active under wb_lock keeps wb_interval_store() from queueing
+ * the daemon again once reset has started tearing the device down.
+ */
+static void zram_wb_stop(struct zram *zram)
+{
+	mutex_lock(&zram->wb_lock);
+	zram->wb_active = false;
+	mutex_unlock(&zram->wb_lock);
+	cancel_delayed_work_sync(&zram->wb_work);
+}
+
+static ssize_t writeback_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	ssize_t ret = len;
+
+	if (!sysfs_streq(buf, "idle"))
+		return -EINVAL;
+
+	down_read(&zram->init_lock);
+	if (!init_done(zram) || !zram_wb_enabled(zram))
+		ret = -EINVAL;
+	else
+		zram_wb_run(zram);
+	up_read(&zram->init_lock);
+
+	return ret;
+}
+
+static ssize_t wb_interval_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n", zram->wb_interval);
+}
+
+/* seconds between daemon passes, 0 stops the daemon */
+static ssize_t wb_interval_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	unsigned int val;
+
+	if (kstrtouint(buf, 10, &val))
+		return -EINVAL;
+
+	down_read(&zram->init_lock);
+	mutex_lock(&zram->wb_lock);
+	zram->wb_interval = val;
+	zram_wb_queue(zram);
+	mutex_unlock(&zram->wb_lock);
+	up_read(&zram->init_lock);
+
+	return len;
+}
+
+static ssize_t wb_budget_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%llu\n", zram->wb_budget);
+}
+
+/* bytes the daemon may write per day, 0 means unlimited */
+static ssize_t wb_budget_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	u64 val;
+	char *tmp;
+
+	val = memparse(buf, &tmp);
+	if (buf == tmp) /* no chars parsed, invalid input */
+		return -EINVAL;
+
+	mutex_lock(&zram->wb_lock);
+	zram->wb_budget = val;
+	mutex_unlock(&zram->wb_lock);
+
+	return len;
+}
+
+#else
+static bool zram_wb_enabled(struct zram *zram) { return false; }
+static inline void reset_bdev(struct zram *zram) {};
+static int write_to_bdev(struct zram *zram, struct bio_vec *bvec,
+					u32 index, struct bio *parent,
+					unsigned long *pentry)
+
+{
+	return -EIO;
+}
+
+static int read_from_bdev(struct zram *zram, struct bio_vec *bvec,
+			unsigned long entry, struct bio *parent, bool sync)
+{
+	return -EIO;
+}
+static void zram_wb_clear(struct zram *zram, u32 index) {}
+static void zram_wb_start(struct zram *zram) {}
+static void zram_wb_stop(struct zram *zram) {}
+static bool zram_ra_read(struct zram *zram, u32 index, unsigned long entry,
+			struct page *page)
+{
+	return false;
+}
+static void zram_ra_update(struct zram *zram, u32 index,
+			unsigned long entry) {}
+#endif
+
+#ifdef CONFIG_ZRAM_MEMCG_STAT
+/*
+ * Find or claim the memcg_stat entry of the cgroup owning @page. Entries
+ * are claimed with cmpxchg and never released while the device is
+ * initialized, so the write path takes no lock. Pages without a memcg
+ * and cgroups that find the table full land in the overflow entry.
+ */
+static u16 zram_memcg_id(struct zram *zram, struct page *page)
+{
+	unsigned long ino = page_cgroup_ino(page);
+	unsigned int i, slot;
+
+	if (!ino)
+		return ZRAM_MEMCG_SLOTS;
+
+	slot = hash_long(ino, ZRAM_MEMCG_SHIFT);
+	for (i = 0; i < ZRAM_MEMCG_SLOTS; i++) {
+		struct zram_memcg_stat *stat = &zram->memcg_stat[slot];
+		unsigned long cur = READ_ONCE(stat->ino);
+
+		if (!cur)
+			cur = cmpxchg(&stat->ino, 0, ino) ? : ino;
+		if (cur == ino)
+			return slot;
+		slot = (slot + 1) & (ZRAM_MEMCG_SLOTS - 1);
+	}
+
+	return ZRAM_MEMCG_SLOTS;
+}
+
+/* Called with the slot lock held, after the slot has been filled */
+static void zram_memcg_charge(struct zram *zram, u32 index, u16 id)
+{
+	struct zram_memcg_stat *stat = &zram->memcg_stat[id];
+
+	/* written back objects do not occupy memory */
+	if (zram_test_flag(zram, index, ZRAM_WB))
+		return;
+
+	zram->table[index].memcg = id + 1;
+	atomic64_inc(&stat->pages);
+	if (!zram_test_flag(zram, index, ZRAM_SAME))
+		atomic64_add(zram_get_obj_size(zram, index), &stat->compr_size);
+}
+
+/* Called with the slot lock held, before the slot is emptied */
+static void zram_memcg_uncharge(struct zram *zram, u32 index)
+{
+	struct zram_memcg_stat *stat;
+	u16 id = zram->table[index].memcg;
+
+	if (!id)
+		return;
+
+	stat = &zram->memcg_stat[id - 1];
+	zram->table[index].memcg = 0;
+	atomic64_dec(&stat->pages);
+	if (!zram_test_flag(zram, index, ZRAM_SAME))
+		atomic64_sub(zram_get_obj_size(zram, index), &stat->compr_size);
+}
+
+/* The object of a charged slot was replaced by one of @new_size bytes */
+static void zram_memcg_resize(struct zram *zram, u32 index, size_t new_size)
+{
+	u16 id = zram->table[index].memcg;
+
+	if (id)
+		atomic64_add((s64)new_size - zram_get_obj_size(zram, index),
+				&zram->memcg_stat[id - 1].compr_size);
+}
+
+static void zram_memcg_reset(struct zram *zram)
+{
+	memset(zram->memcg_stat, 0, sizeof(zram->memcg_stat));
+}
+
+static int zram_memcg_stat_show(struct seq_file *m, void *v)
+{
+	struct zram *zram = m->private;
+	int i;
+
+	seq_printf(m, "%12s %12s %16s\n", "ino", "pages", "compr_bytes");
+	for (i = 0; i <= ZRAM_MEMCG_SLOTS; i++) {
+		struct zram_memcg_stat *stat = &zram->memcg_stat[i];
+		u64 pages = atomic64_read(&stat->pages);
+
+		if (!pages)
+			continue;
+		seq_printf(m, "%12lu %12llu %16llu\n", READ_ONCE(stat->ino),
+				pages, (u64)atomic64_read(&stat->compr_size));
+	}
+
+	return 0;
+}
+
+static int zram_memcg_stat_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, zram_memcg_stat_show, inode->i_private);
+}
+
+static const struct file_operations zram_memcg_stat_fops = {
+	.open = zram_memcg_stat_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static void zram_memcg_debugfs_register(struct zram *zram)
+{
+	debugfs_create_file("memcg_stat", 0400, zram->debugfs_dir,
+				zram, &zram_memcg_stat_fops);
+}
+#else
+static u16 zram_memcg_id(struct zram *zram, struct page *page) { return 0; }
+static void zram_memcg_charge(struct zram *zram, u32 index, u16 id) {}
+static void zram_memcg_uncharge(struct zram *zram, u32 index) {}
+static void zram_memcg_resize(struct zram *zram, u32 index,
+			size_t new_size) {}
+static void zram_memcg_reset(struct zram *zram) {}
+static void zram_memcg_debugfs_register(struct zram *zram) {}
+#endif
+
+#ifdef CONFIG_ZRAM_MEMORY_TRACKING
+
+static struct dentry *zram_debugfs_root;
+
+static void zram_debugfs_create(void)
+{
+	zram_debugfs_root = debugfs_create_dir("zram", NULL);
+}
+
+static void zram_debugfs_destroy(void)
+{
+	debugfs_remove_recursive(zram_debugfs_root);
+}
+
+static void zram_accessed(struct zram *zram, u32 index)
+{
+	zram_clear_flag(zram, index, ZRAM_IDLE);
+	zram->table[index].ac_time = ktime_get_boottime();
+}
+
+static void zram_reset_access(struct zram *zram, u32 index)
+{
+	zram->table[index].ac_time.tv64 = 0;
+}
+
+static ssize_t read_block_state(struct file *file, char __user *buf,
+				size_t count, loff_t *ppos)
+{
+	char *kbuf;
+	ssize_t index, written = 0;
+	struct zram *zram = file->private_data;
+	unsigned long nr_pages = zram->disksize >> PAGE_SHIFT;
+	struct timespec64 ts;
+	gfp_t kmalloc_flags;
+
+	kmalloc_flags = GFP_KERNEL;
+	if (count > PAGE_SIZE)
+		kmalloc_flags |= __GFP_NOWARN | __GFP_NORETRY;
+
+	kbuf = kmalloc_node(count, kmalloc_flags, NUMA_NO_NODE);
+	if (!kbuf && count > PAGE_SIZE)
+		kbuf = vmalloc(count);
+
+	if (!kbuf)
+		return -ENOMEM;
+
+	down_read(&zram->init_lock);
+	if (!init_done(zram)) {
+		up_read(&zram->init_lock);
+		kvfree(kbuf);
+		return -EINVAL;
+	}
+
+	for (index = *ppos; index < nr_pages; index++) {
+		int copied;
+
+		zram_slot_lock(zram, index);
+		if (!zram_allocated(zram, index))
+			goto next;
+
+		ts = ktime_to_timespec64(zram->table[index].ac_time);
+		copied = snprintf(kbuf + written, count,
+			"%12zd %12lld.%06lu %c%c%c%c%c\n",
+			index, (s64)ts.tv_sec,
+			ts.tv_nsec / NSEC_PER_USEC,
+			zram_test_flag(zram, index, ZRAM_SAME) ? 's' : '.',
+			zram_test_flag(zram, index, ZRAM_WB) ? 'w' : '.',
+			zram_test_flag(zram, index, ZRAM_HUGE) ? 'h' : '.',
+			zram_test_flag(zram, index, ZRAM_IDLE) ? 'i' : '.',
+			zram_test_flag(zram, index, ZRAM_RECOMP) ? 'r' : '.');
+
+		if (count <= copied) {
+			zram_slot_unlock(zram, index);
+			break;
+		}
+		written += copied;
+		count -= copied;
+next:
+		zram_slot_unlock(zram, index);
+		*ppos += 1;
+	}
+
+	up_read(&zram->init_lock);
+	if (copy_to_user(buf, kbuf, written))
+		written = -EFAULT;
+	kvfree(kbuf);
+
+	return written;
+}
+
+static const struct file_operations proc_zram_block_state_op = {
+	.open = simple_open,
+	.read = read_block_state,
+	.llseek = default_llseek,
+};
+
+static void zram_debugfs_register(struct zram *zram)
+{
+	if (!zram_debugfs_root)
+		return;
+
+	zram->debugfs_dir = debugfs_create_dir(zram->disk->disk_name,
+						zram_debugfs_root);
+	debugfs_create_file("block_state", 0400, zram->debugfs_dir,
+				zram, &proc_zram_block_state_op);
+	zram_memcg_debugfs_register(zram);
+}
+
+static void zram_debugfs_unregister(struct zram *zram)
+{
+	debugfs_remove_recursive(zram->debugfs_dir);
+}
+#else
+static void zram_debugfs_create(void) {};
+static void zram_debugfs_destroy(void) {};
+static void zram_accessed(struct zram *zram, u32 index)
+{
+	zram_clear_flag(zram, index, ZRAM_IDLE);
+};
+static void zram_reset_access(struct zram *zram, u32 index) {};
+static void zram_debugfs_register(struct zram *zram) {};
+static void zram_debugfs_unregister(struct zram *zram) {};
+#endif
+
+static ssize_t idle_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	unsigned long nr_pages = zram->disksize >> PAGE_SHIFT;
+	unsigned long index;
+
+	if (!sysfs_streq(buf, "all"))
+		return -EINVAL;
+
+	down_read(&zram->init_lock);
+	if (!init_done(zram)) {
+		up_read(&zram->init_lock);
+		return -EINVAL;
+	}
+
+	for (index = 0; index < nr_pages; index++) {
+		zram_slot_lock(zram, index);
+		if (zram_allocated(zram, index) &&
+				!zram_test_flag(zram, index, ZRAM_WB))
+			zram_set_flag(zram, index, ZRAM_IDLE);
+		zram_slot_unlock(zram, index);
+	}
+
+	up_read(&zram->init_lock);
+
+	return len;
+}
+
+#ifdef CONFIG_ZRAM_MULTI_COMP
+static struct zcomp *zram_slot_comp(struct zram *zram, u32 index)
+{
+	if (zram_test_flag(zram, index, ZRAM_RECOMP))
+		return zram->recomp;
+	return zram->comp;
+}
+
+static ssize_t recomp_algorithm_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	size_t sz;
+	struct zram *zram = dev_to_zram(dev);
+
+	down_read(&zram->init_lock);
+	sz = zcomp_available_show(zram->recomp_compressor, buf);
+	up_read(&zram->init_lock);
+
+	return sz;
+}
+
+static ssize_t recomp_algorithm_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	char compressor[ARRAY_SIZE(zram->recomp_compressor)];
+	size_t sz;
+
+	strlcpy(compressor, buf, sizeof(compressor));
+	/* ignore trailing newline */
+	sz = strlen(compressor);
+	if (sz > 0 && compressor[sz - 1] == '\n')
+		compressor[sz - 1] = 0x00;
+
+	if (!zcomp_available_algorithm(compressor))
+		return -EINVAL;
+
+	down_write(&zram->init_lock);
+	if (init_done(zram)) {
+		up_write(&zram->init_lock);
+		pr_info("Can't change algorithm for initialized device\n");
+		return -EBUSY;
+	}
+
+	strcpy(zram->recomp_compressor, compressor);
+	up_write(&zram->init_lock);
+	return len;
+}
+
+/*
+ * Recompress an idle slot with the secondary algorithm. @page is a
+ * scratch page. The slot is only replaced when the new object is
+ * smaller and nobody touched the slot while we were compressing.
+ */
+static int zram_recompress(struct zram *zram, u32 index, struct page *page,
+				unsigned int threshold)
+{
+	unsigned long handle, new_handle;
+	unsigned int size, comp_len;
+	struct zcomp_strm *zstrm;
+	void *src, *dst;
+	int ret;
+
+	zram_slot_lock(zram, index);
+	handle = zram_get_handle(zram, index);
+	size = zram_get_obj_size(zram, index);
+	if (!handle || !zram_test_flag(zram, index, ZRAM_IDLE) ||
+			zram_test_flag(zram, index, ZRAM_SAME) ||
+			zram_test_flag(zram, index, ZRAM_WB) ||
+			zram_test_flag(zram, index, ZRAM_RECOMP) ||
+			zram_test_flag(zram, index, ZRAM_DEDUP) ||
+			size < threshold) {
+		zram_slot_unlock(zram, index);
+		return 0;
+	}
+
+	ret = zram_read_obj(zram, index, page);
+	zram_slot_unlock(zram, index);
+
+	if (ret)
+		return ret;
+
+	zstrm = zcomp_stream_get(zram->recomp);
+	src = kmap_atomic(page);
+	ret = zcomp_compress(zstrm, src, &comp_len);
+	kunmap_atomic(src);
+
+	if (ret || comp_len >= size || comp_len >= huge_class_size) {
+		zcomp_stream_put(zram->recomp);
+		return ret;
+	}
+
+	new_handle = zs_malloc(zram->mem_pool, comp_len,
+			__GFP_KSWAPD_RECLAIM |
+			__GFP_NOWARN |
+			__GFP_HIGHMEM |
+			__GFP_MOVABLE |
+			__GFP_CMA);
+	if (!new_handle) {
+		zcomp_stream_put(zram->recomp);
+		return -ENOMEM;
+	}
+
+	dst = zs_map_object(zram->mem_pool, new_handle, ZS_MM_WO);
+	memcpy(dst, zstrm->buffer, comp_len);
+	zs_unmap_object(zram->mem_pool, new_handle);
+	zcomp_stream_put(zram->recomp);
+
+	zram_slot_lock(zram, index);
+	/* the slot was rewritten or accessed in the meantime */
+	if (zram_get_handle(zram, index) != handle ||
+			!zram_test_flag(zram, index, ZRAM_IDLE)) {
+		zram_slot_unlock(zram, index);
+		zs_free(zram->mem_pool, new_handle);
+		return 0;
+	}
+
+	zs_free(zram->mem_pool, handle);
+	atomic64_sub(size - comp_len, &zram->stats.compr_data_size);
+	zram_memcg_resize(zram, index, comp_len);
+	if (zram_test_flag(zram, index, ZRAM_HUGE)) {
+		zram_clear_flag(zram, index, ZRAM_HUGE);
+		atomic64_dec(&zram->stats.huge_pages);
+	}
+	zram_set_handle(zram, index, new_handle);
+	zram_set_obj_size(zram, index, comp_len);
+	zram_set_flag(zram, index, ZRAM_RECOMP);
+	zram_slot_unlock(zram, index);
+
+	return 0;
+}
+
+/*
+ * Recompress idle slots whose object is at least 'threshold' bytes
+ * (huge pages by default): echo "threshold=2048" > recompress
+ */
+static ssize_t recompress_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	unsigned long nr_pages = zram->disksize >> PAGE_SHIFT;
+	unsigned int threshold = PAGE_SIZE;
+	unsigned long index;
+	struct page *page;
+	int ret = len;
+
+	if (sscanf(buf, "threshold=%u", &threshold) != 1 &&
+			!sysfs_streq(buf, "huge"))
+		return -EINVAL;
+
+	page = alloc_page(GFP_KERNEL);
+	if (!page)
+		return -ENOMEM;
+
+	down_read(&zram->init_lock);
+	if (!init_done(zram) || !zram->recomp) {
+		ret = -EINVAL;
+		goto out;
+	}
+
+	for (index = 0; index < nr_pages; index++) {
+		int err = zram_recompress(zram, index, page, threshold);
+
+		if (err && err != -ENOMEM) {
+			ret = err;
+			break;
+		}
+		cond_resched();
+	}
+out:
+	up_read(&zram->init_lock);
+	__free_page(page);
+
+	return ret;
+}
+
+static int zram_recomp_create(struct zram *zram)
+{
+	struct zcomp *comp;
+
+	if (!zram->recomp_compressor[0])
+		return 0;
+
+	comp = zcomp_create(zram->recomp_compressor);
+	if (IS_ERR(comp)) {
+		pr_err("Cannot initialise %s recompression backend\n",
+				zram->recomp_compressor);
+		return PTR_ERR(comp);
+	}
+
+	zram->recomp = comp;
+	return 0;
+}
+
+static void zram_recomp_destroy(struct zram *zram)
+{
+	if (zram->recomp)
+		zcomp_destroy(zram->recomp);
+	zram->recomp = NULL;
+}
+#else
+static struct zcomp *zram_slot_comp(struct zram *zram, u32 index)
+{
+	return zram->comp;
+}
+static int zram_recomp_create(struct zram *zram) { return 0; }
+static void zram_recomp_destroy(struct zram *zram) {}
+#endif
+
+/*
+ * Decompress the zsmalloc object of slot @index into @page. The caller
+ * holds the slot lock and has checked that the slot has a handle.
+ */
+static int zram_read_obj(struct zram *zram, u32 index, struct page *page)
+{
+	unsigned long handle = zram_get_handle(zram, index);
+	unsigned int size = zram_get_obj_size(zram, index);
+	void *src, *dst;
+	int ret = 0;
+
+	src = zs_map_object(zram->mem_pool, handle, ZS_MM_RO);
+	dst = kmap_atomic(page);
+	if (size == PAGE_SIZE) {
+		memcpy(dst, src, PAGE_SIZE);
+	} else {
+		struct zcomp *comp = zram_slot_comp(zram, index);
+		struct zcomp_strm *zstrm = zcomp_stream_get(comp);
+
+		ret = zcomp_decompress(zstrm, src, size, dst);
+		zcomp_stream_put(comp);
+	}
+	kunmap_atomic(dst);
+	zs_unmap_object(zram->mem_pool, handle);
+
+	return ret;
+}
+
+/*
+ * We switched to per-cpu streams and this attr is not needed anymore.
+ * However, we will keep it around for some time, because:
+ * a) we may revert per-cpu streams in the future
+ * b) it's visible to user space and we need to follow our 2 years
+ *    retirement rule; but we already have a number of 'soon to be
+ *    altered' attrs, so max_comp_streams need to wait for the next
+ *    layoff cycle.
+ */
+static ssize_t max_comp_streams_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	return scnprintf(buf, PAGE_SIZE, "%d\n", num_online_cpus());
 }
 
 static ssize_t max_comp_streams_store(struct device *dev,
@@ -778,6 +1942,89 @@ static ssize_t max_comp_streams_store(struct device *dev,
 	return len;
 }
 
+static ssize_t slot_lock_shards_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n", zram->slot_lock_shards);
+}
+
+/*
+ * 0 keeps the per-slot bit spinlock. Any other value selects that many
+ * (rounded up to a power of two) cacheline-aligned spinlocks, striped
+ * over the slots.
+ */
+static ssize_t slot_lock_shards_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	unsigned int val;
+
+	if (kstrtouint(buf, 10, &val) || val > ZRAM_MAX_SLOT_LOCKS)
+		return -EINVAL;
+
+	down_write(&zram->init_lock);
+	if (init_done(zram)) {
+		up_write(&zram->init_lock);
+		pr_info("Can't change slot locking for initialized device\n");
+		return -EBUSY;
+	}
+
+	zram->slot_lock_shards = val ? roundup_pow_of_two(val) : 0;
+	up_write(&zram->init_lock);
+
+	return len;
+}
+
+static ssize_t batch_write_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%d\n", zram->batch_write);
+}
+
+static ssize_t batch_write_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	bool val;
+
+	if (strtobool(buf, &val))
+		return -EINVAL;
+
+	down_write(&zram->init_lock);
+	zram->batch_write = val;
+	up_write(&zram->init_lock);
+
+	return len;
+}
+
+static ssize_t skip_incompressible_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%d\n", zram->skip_incompressible);
+}
+
+static ssize_t skip_incompressible_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	bool val;
+
+	if (strtobool(buf, &val))
+		return -EINVAL;
+
+	down_write(&zram->init_lock);
+	zram->skip_incompressible = val;
+	up_write(&zram->init_lock);
+
+	return len;
+}
+
 static ssize_t comp_algorithm_show(struct device *dev,
 		struct device_attribute *attr, char *buf)
 {
@@ -844,11 +2091,20 @@ static ssize_t io_stat_show(struct device *dev,
 
 	down_read(&zram->init_lock);
 	ret = scnprintf(buf, PAGE_SIZE,
-			"%8llu %8llu %8llu %8llu\n",
+			"%8llu %8llu %8llu %8llu",
 			(u64)atomic64_read(&zram->stats.failed_reads),
 			(u64)atomic64_read(&zram->stats.failed_writes),
 			(u64)atomic64_read(&zram->stats.invalid_io),
 			(u64)atomic64_read(&zram->stats.notify_free));
+#ifdef CONFIG_ZRAM_WRITEBACK
+	ret += scnprintf(buf + ret, PAGE_SIZE - ret,
+			" %8llu %8llu %8llu %8u",
+			(u64)atomic64_read(&zram->stats.wb_pages),
+			zram->wb_budget_used,
+			zram->wb_budget,
+			zram->wb_last_kbps);
+#endif
+	ret += scnprintf(buf + ret, PAGE_SIZE - ret, "\n");
 	up_read(&zram->init_lock);
 
 	return ret;
@@ -875,7 +2131,7 @@ static ssize_t mm_stat_show(struct device *dev,
 	max_used = atomic_long_read(&zram->stats.max_used_pages);
 
 	ret = scnprintf(buf, PAGE_SIZE,
-			"%8llu %8llu %8llu %8lu %8ld %8llu %8lu %8llu\n",
+			"%8llu %8llu %8llu %8lu %8ld %8llu %8lu %8llu %8llu %8llu\n",
 			orig_size << PAGE_SHIFT,
 			(u64)atomic64_read(&zram->stats.compr_data_size),
 			mem_used << PAGE_SHIFT,
@@ -883,31 +2139,119 @@ static ssize_t mm_stat_show(struct device *dev,
 			max_used << PAGE_SHIFT,
  			(u64)atomic64_read(&zram->stats.same_pages),
 			atomic_long_read(&pool_stats.pages_compacted),
- 			(u64)atomic64_read(&zram->stats.huge_pages));
+ 			(u64)atomic64_read(&zram->stats.huge_pages),
+			zram_dedup_dup_size(zram),
+			zram_dedup_meta_size(zram));
  	up_read(&zram->init_lock);
 	return ret;
 }
 
+#ifdef CONFIG_ZRAM_LOCK_STAT
+static ssize_t lock_stat_show(struct zram *zram, char *buf, ssize_t sz)
+{
+	u64 wait_hist[ZRAM_LOCK_HIST_BUCKETS] = { 0 };
+	u64 hold_hist[ZRAM_LOCK_HIST_BUCKETS] = { 0 };
+	u64 acquired = 0, contended = 0;
+	int cpu, i;
+
+	if (!zram->lock_stat)
+		return sz;
+
+	for_each_possible_cpu(cpu) {
+		struct zram_lock_stat *stat = per_cpu_ptr(zram->lock_stat, cpu);
+
+		acquired += stat->acquired;
+		contended += stat->contended;
+		for (i = 0; i < ZRAM_LOCK_HIST_BUCKETS; i++) {
+			wait_hist[i] += stat->wait_hist[i];
+			hold_hist[i] += stat->hold_hist[i];
+		}
+	}
+
+	sz += scnprintf(buf + sz, PAGE_SIZE - sz,
+			"lock: %8llu %8llu\nlock_wait:", acquired, contended);
+	for (i = 0; i < ZRAM_LOCK_HIST_BUCKETS; i++)
+		sz += scnprintf(buf + sz, PAGE_SIZE - sz, " %llu", wait_hist[i]);
+	sz += scnprintf(buf + sz, PAGE_SIZE - sz, "\nlock_hold:");
+	for (i = 0; i < ZRAM_LOCK_HIST_BUCKETS; i++)
+		sz += scnprintf(buf + sz, PAGE_SIZE - sz, " %llu", hold_hist[i]);
+	sz += scnprintf(buf + sz, PAGE_SIZE - sz, "\n");
+
+	return sz;
+}
+#else
+static ssize_t lock_stat_show(struct zram *zram, char *buf, ssize_t sz)
+{
+	return sz;
+}
+#endif
+
 static ssize_t debug_stat_show(struct device *dev,
 		struct device_attribute *attr, char *buf)
 {
-	int version = 1;
+	int version = 2;
 	struct zram *zram = dev_to_zram(dev);
 	ssize_t ret;
 
-	down_read(&zram->init_lock);
-	ret = scnprintf(buf, PAGE_SIZE,
-			"version: %d\n%8llu\n",
-			version,
-			(u64)atomic64_read(&zram->stats.writestall));
-	up_read(&zram->init_lock);
+	down_read(&zram->init_lock);
+	ret = scnprintf(buf, PAGE_SIZE,
+			"version: %d\n%8llu %8llu\n%8llu %8llu\n",
+			version,
+			(u64)atomic64_read(&zram->stats.writestall),
+			(u64)atomic64_read(&zram->stats.incompressible),
+			(u64)atomic64_read(&zram->stats.wb_ra_pages),
+			(u64)atomic64_read(&zram->stats.wb_ra_hits));
+	if (init_done(zram))
+		ret = lock_stat_show(zram, buf, ret);
+	up_read(&zram->init_lock);
+
+	return ret;
+}
+
+static DEVICE_ATTR_RO(io_stat);
+static DEVICE_ATTR_RO(mm_stat);
+static DEVICE_ATTR_RO(debug_stat);
+
+static int zram_slot_locks_init(struct zram *zram)
+{
+	unsigned int i;
+
+#ifdef CONFIG_ZRAM_LOCK_STAT
+	zram->lock_stat = alloc_percpu(struct zram_lock_stat);
+	if (!zram->lock_stat)
+		return -ENOMEM;
+#endif
+
+	if (!zram->slot_lock_shards)
+		return 0;
+
+	zram->slot_locks = vmalloc(zram->slot_lock_shards *
+				sizeof(struct zram_slot_lock_bucket));
+	if (!zram->slot_locks) {
+#ifdef CONFIG_ZRAM_LOCK_STAT
+		free_percpu(zram->lock_stat);
+		zram->lock_stat = NULL;
+#endif
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < zram->slot_lock_shards; i++)
+		spin_lock_init(&zram->slot_locks[i].lock);
+	zram->nr_slot_locks = zram->slot_lock_shards;
 
-	return ret;
+	return 0;
 }
 
-static DEVICE_ATTR_RO(io_stat);
-static DEVICE_ATTR_RO(mm_stat);
-static DEVICE_ATTR_RO(debug_stat);
+static void zram_slot_locks_fini(struct zram *zram)
+{
+	vfree(zram->slot_locks);
+	zram->slot_locks = NULL;
+	zram->nr_slot_locks = 0;
+#ifdef CONFIG_ZRAM_LOCK_STAT
+	free_percpu(zram->lock_stat);
+	zram->lock_stat = NULL;
+#endif
+}
 
 static void zram_meta_free(struct zram *zram, u64 disksize)
 {
@@ -918,8 +2262,11 @@ static void zram_meta_free(struct zram *zram, u64 disksize)
 	for (index = 0; index < num_pages; index++)
 		zram_free_page(zram, index);
 
+	zram_dedup_fini(zram);
 	zs_destroy_pool(zram->mem_pool);
+	zram_slot_locks_fini(zram);
 	vfree(zram->table);
+	zram_memcg_reset(zram);
 }
 
 static bool zram_meta_alloc(struct zram *zram, u64 disksize)
@@ -931,15 +2278,27 @@ static bool zram_meta_alloc(struct zram *zram, u64 disksize)
 	if (!zram->table)
 		return false;
 
+	if (zram_slot_locks_init(zram))
+		goto out_free_table;
+
 	zram->mem_pool = zs_create_pool(zram->disk->disk_name);
-	if (!zram->mem_pool) {
-		vfree(zram->table);
-		return false;
+	if (!zram->mem_pool)
+		goto out_free_locks;
+
+	if (zram_dedup_init(zram, num_pages)) {
+		zs_destroy_pool(zram->mem_pool);
+		goto out_free_locks;
 	}
 
 	if (!huge_class_size)
 		huge_class_size = zs_huge_class_size(zram->mem_pool);
 	return true;
+
+out_free_locks:
+	zram_slot_locks_fini(zram);
+out_free_table:
+	vfree(zram->table);
+	return false;
 }
 
 /*
@@ -951,7 +2310,10 @@ static void zram_free_page(struct zram *zram, size_t index)
 {
 	unsigned long handle;
 
+	zram_memcg_uncharge(zram, index);
 	zram_reset_access(zram, index);
+	zram_clear_flag(zram, index, ZRAM_IDLE);
+	zram_clear_flag(zram, index, ZRAM_RECOMP);
 
 	if (zram_test_flag(zram, index, ZRAM_HUGE)) {
 		zram_clear_flag(zram, index, ZRAM_HUGE);
@@ -980,10 +2342,19 @@ static void zram_free_page(struct zram *zram, size_t index)
 	if (!handle)
 		return;
 
-	zs_free(zram->mem_pool, handle);
+	if (zram_test_flag(zram, index, ZRAM_DEDUP)) {
+		struct zram_dedup_entry *entry;
 
-	atomic64_sub(zram_get_obj_size(zram, index),
-			&zram->stats.compr_data_size);
+		entry = (struct zram_dedup_entry *)zram->table[index].handle;
+		zram_clear_flag(zram, index, ZRAM_DEDUP);
+		if (zram_dedup_put(zram, entry))
+			atomic64_sub(zram_get_obj_size(zram, index),
+					&zram->stats.compr_data_size);
+	} else {
+		zs_free(zram->mem_pool, handle);
+		atomic64_sub(zram_get_obj_size(zram, index),
+				&zram->stats.compr_data_size);
+	}
 	atomic64_dec(&zram->stats.pages_stored);
 
 	zram_set_handle(zram, index, 0);
@@ -1001,16 +2372,21 @@ static int __zram_bvec_read(struct zram *zram, struct page *page, u32 index,
 	if (zram_wb_enabled(zram)) {
 		zram_slot_lock(zram, index);
 		if (zram_test_flag(zram, index, ZRAM_WB)) {
+			unsigned long entry = zram_get_element(zram, index);
 			struct bio_vec bvec;
 
 			zram_slot_unlock(zram, index);
 
+			if (zram_ra_read(zram, index, entry, page))
+				return 0;
+
 			bvec.bv_page = page;
 			bvec.bv_len = PAGE_SIZE;
 			bvec.bv_offset = 0;
-			return read_from_bdev(zram, &bvec,
-					zram_get_element(zram, index),
-					bio, partial_io);
+			ret = read_from_bdev(zram, &bvec, entry, bio, partial_io);
+			if (ret >= 0)
+				zram_ra_update(zram, index, entry);
+			return ret;
 		}
 		zram_slot_unlock(zram, index);
 	}
@@ -1038,12 +2414,13 @@ static int __zram_bvec_read(struct zram *zram, struct page *page, u32 index,
 		kunmap_atomic(dst);
 		ret = 0;
 	} else {
-		struct zcomp_strm *zstrm = zcomp_stream_get(zram->comp);
+		struct zcomp *comp = zram_slot_comp(zram, index);
+		struct zcomp_strm *zstrm = zcomp_stream_get(comp);
 
 		dst = kmap_atomic(page);
 		ret = zcomp_decompress(zstrm, src, size, dst);
 		kunmap_atomic(dst);
-		zcomp_stream_put(zram->comp);
+		zcomp_stream_put(comp);
 	}
 	zs_unmap_object(zram->mem_pool, handle);
 	zram_slot_unlock(zram, index);
@@ -1088,6 +2465,47 @@ out:
 	return ret;
 }
 
+/*
+ * Install a freshly written object into slot @index. @flags is ZRAM_SAME
+ * or ZRAM_WB for objects described by @element rather than by a zsmalloc
+ * @handle, and ZRAM_DEDUP when @handle is a zram_dedup_entry. Whatever
+ * the slot held before is released first.
+ */
+static void zram_slot_store(struct zram *zram, u32 index,
+			unsigned long handle, unsigned int comp_len,
+			enum zram_pageflags flags, unsigned long element,
+			struct page *page)
+{
+	u16 memcg = zram_memcg_id(zram, page);
+
+	/*
+	 * Free memory associated with this sector
+	 * before overwriting unused sectors.
+	 */
+	zram_slot_lock(zram, index);
+	zram_free_page(zram, index);
+
+	if (comp_len == PAGE_SIZE) {
+		zram_set_flag(zram, index, ZRAM_HUGE);
+		atomic64_inc(&zram->stats.huge_pages);
+	}
+
+	if (flags == ZRAM_SAME || flags == ZRAM_WB) {
+		zram_set_flag(zram, index, flags);
+		zram_set_element(zram, index, element);
+	}  else {
+		zram_set_handle(zram, index, handle);
+		zram_set_obj_size(zram, index, comp_len);
+		if (flags)
+			zram_set_flag(zram, index, flags);
+	}
+	zram_memcg_charge(zram, index, memcg);
+	zram_slot_unlock(zram, index);
+
+	/* Update stats */
+	atomic64_inc(&zram->stats.pages_stored);
+}
+
 static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 				u32 index, struct bio *bio)
 {
@@ -1101,6 +2519,9 @@ static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 	unsigned long element = 0;
 	enum zram_pageflags flags = 0;
 	bool allow_wb = true;
+	struct zram_dedup_entry *entry;
+	u32 checksum = 0;
+	bool incompressible = false;
 
 	mem = kmap_atomic(page);
 	if (page_same_filled(mem, &element)) {
@@ -1110,13 +2531,25 @@ static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 		atomic64_inc(&zram->stats.same_pages);
 		goto out;
 	}
+	if (zram_dedup_enabled(zram))
+		checksum = zram_dedup_checksum(mem);
+	if (zram->skip_incompressible && page_incompressible(mem)) {
+		incompressible = true;
+		atomic64_inc(&zram->stats.incompressible);
+	}
 	kunmap_atomic(mem);
 
 compress_again:
 	zstrm = zcomp_stream_get(zram->comp);
-	src = kmap_atomic(page);
-	ret = zcomp_compress(zstrm, src, &comp_len);
-	kunmap_atomic(src);
+	if (incompressible) {
+		/* stored as huge below; the paths there expect a stream */
+		comp_len = PAGE_SIZE;
+		ret = 0;
+	} else {
+		src = kmap_atomic(page);
+		ret = zcomp_compress(zstrm, src, &comp_len);
+		kunmap_atomic(src);
+	}
 
 	if (unlikely(ret)) {
 		zcomp_stream_put(zram->comp);
@@ -1153,6 +2586,17 @@ compress_again:
 	 * if we have a 'non-null' handle here then we are coming
 	 * from the slow path and handle has already been allocated.
 	 */
+	if (!handle && zram_dedup_enabled(zram)) {
+		entry = zram_dedup_match(zram, checksum, page, zstrm->buffer,
+					comp_len);
+		if (entry) {
+			zcomp_stream_put(zram->comp);
+			handle = (unsigned long)entry;
+			flags = ZRAM_DEDUP;
+			goto out;
+		}
+	}
+
 	if (!handle)
 		handle = zs_malloc(zram->mem_pool, comp_len,
 				__GFP_KSWAPD_RECLAIM |
@@ -1192,30 +2636,16 @@ compress_again:
 	zcomp_stream_put(zram->comp);
 	zs_unmap_object(zram->mem_pool, handle);
 	atomic64_add(comp_len, &zram->stats.compr_data_size);
-out:
-	/*
-	 * Free memory associated with this sector
-	 * before overwriting unused sectors.
-	 */
-	zram_slot_lock(zram, index);
-	zram_free_page(zram, index);
-
-	if (comp_len == PAGE_SIZE) {
-		zram_set_flag(zram, index, ZRAM_HUGE);
-		atomic64_inc(&zram->stats.huge_pages);
-	}
 
-	if (flags) {
-		zram_set_flag(zram, index, flags);
-		zram_set_element(zram, index, element);
-	}  else {
-		zram_set_handle(zram, index, handle);
-		zram_set_obj_size(zram, index, comp_len);
+	if (zram_dedup_enabled(zram)) {
+		entry = zram_dedup_insert(zram, checksum, handle, comp_len);
+		if (entry) {
+			handle = (unsigned long)entry;
+			flags = ZRAM_DEDUP;
+		}
 	}
-	zram_slot_unlock(zram, index);
-
-	/* Update stats */
-	atomic64_inc(&zram->stats.pages_stored);
+out:
+	zram_slot_store(zram, index, handle, comp_len, flags, element, page);
 	return ret;
 }
 
@@ -1260,6 +2690,145 @@ out:
 	return ret;
 }
 
+/*
+ * Batched write path for multi-page bios: up to ZRAM_WRITE_BATCH full
+ * pages are compressed under a single stream acquisition and their
+ * handles come from the non-blocking zs_malloc() fast path. A page that
+ * needs anything slower (allocation stall, writeback of a huge page) is
+ * handed over to __zram_bvec_write() with the stream released.
+ */
+static int zram_bvec_write_batch(struct zram *zram, struct bio_vec *bvecs,
+				int nr, u32 index, struct bio *bio)
+{
+	unsigned long start_time = jiffies;
+	unsigned long alloced_pages;
+	struct zcomp_strm *zstrm = NULL;
+	int i, ret = 0;
+
+	generic_start_io_acct(WRITE, nr << SECTORS_PER_PAGE_SHIFT,
+			&zram->disk->part0);
+
+	for (i = 0; i < nr; i++, index++) {
+		struct page *page = bvecs[i].bv_page;
+		unsigned long handle, element;
+		struct zram_dedup_entry *entry;
+		unsigned int comp_len;
+		u32 checksum = 0;
+		bool incompressible;
+		void *src, *dst;
+
+		atomic64_inc(&zram->stats.num_writes);
+
+		src = kmap_atomic(page);
+		if (page_same_filled(src, &element)) {
+			kunmap_atomic(src);
+			atomic64_inc(&zram->stats.same_pages);
+			zram_slot_store(zram, index, 0, 0, ZRAM_SAME, element,
+					page);
+			goto next;
+		}
+		if (zram_dedup_enabled(zram))
+			checksum = zram_dedup_checksum(src);
+
+		if (!zstrm)
+			zstrm = zcomp_stream_get(zram->comp);
+		incompressible = zram->skip_incompressible &&
+				page_incompressible(src);
+		if (incompressible) {
+			comp_len = PAGE_SIZE;
+			ret = 0;
+		} else {
+			ret = zcomp_compress(zstrm, src, &comp_len);
+		}
+		kunmap_atomic(src);
+		if (unlikely(ret)) {
+			pr_err("Compression failed! err=%d\n", ret);
+			break;
+		}
+
+		if (unlikely(comp_len >= huge_class_size)) {
+			if (zram_wb_enabled(zram))
+				goto slow_path;
+			comp_len = PAGE_SIZE;
+		}
+		if (incompressible)
+			atomic64_inc(&zram->stats.incompressible);
+
+		if (zram_dedup_enabled(zram)) {
+			entry = zram_dedup_match(zram, checksum, page,
+						zstrm->buffer, comp_len);
+			if (entry) {
+				zram_slot_store(zram, index,
+						(unsigned long)entry, comp_len,
+						ZRAM_DEDUP, 0, page);
+				goto next;
+			}
+		}
+
+		handle = zs_malloc(zram->mem_pool, comp_len,
+				__GFP_KSWAPD_RECLAIM |
+				__GFP_NOWARN |
+				__GFP_HIGHMEM |
+				__GFP_MOVABLE |
+				__GFP_CMA);
+		if (!handle)
+			goto slow_path;
+
+		alloced_pages = zs_get_total_pages(zram->mem_pool);
+		update_used_max(zram, alloced_pages);
+
+		if (zram->limit_pages && alloced_pages > zram->limit_pages) {
+			zs_free(zram->mem_pool, handle);
+			ret = -ENOMEM;
+			break;
+		}
+
+		dst = zs_map_object(zram->mem_pool, handle, ZS_MM_WO);
+		if (comp_len == PAGE_SIZE) {
+			src = kmap_atomic(page);
+			memcpy(dst, src, PAGE_SIZE);
+			kunmap_atomic(src);
+		} else {
+			memcpy(dst, zstrm->buffer, comp_len);
+		}
+		zs_unmap_object(zram->mem_pool, handle);
+		atomic64_add(comp_len, &zram->stats.compr_data_size);
+
+		entry = NULL;
+		if (zram_dedup_enabled(zram))
+			entry = zram_dedup_insert(zram, checksum, handle,
+						comp_len);
+		if (entry)
+			zram_slot_store(zram, index, (unsigned long)entry,
+					comp_len, ZRAM_DEDUP, 0, page);
+		else
+			zram_slot_store(zram, index, handle, comp_len, 0, 0,
+					page);
+		goto next;
+
+slow_path:
+		zcomp_stream_put(zram->comp);
+		zstrm = NULL;
+		ret = __zram_bvec_write(zram, &bvecs[i], index, bio);
+		if (ret < 0)
+			break;
+next:
+		zram_slot_lock(zram, index);
+		zram_accessed(zram, index);
+		zram_slot_unlock(zram, index);
+	}
+
+	if (zstrm)
+		zcomp_stream_put(zram->comp);
+
+	generic_end_io_acct(WRITE, &zram->disk->part0, start_time);
+
+	if (unlikely(ret < 0))
+		atomic64_inc(&zram->stats.failed_writes);
+
+	return ret;
+}
+
 /*
  * zram_bio_discard - handler on discard request
  * @index: physical block index in PAGE_SIZE units
@@ -1337,6 +2906,26 @@ static int zram_bvec_rw(struct zram *zram, struct bio_vec *bvec, u32 index,
 	return ret;
 }
 
+/*
+ * A bio qualifies for the batched write path when it starts on a page
+ * boundary and consists of at least two whole, page-aligned segments.
+ */
+static bool zram_bio_batchable(struct zram *zram, struct bio *bio, int offset)
+{
+	struct bio_vec bvec;
+	struct bvec_iter iter;
+
+	if (!zram->batch_write || offset || bio->bi_iter.bi_size <= PAGE_SIZE)
+		return false;
+
+	bio_for_each_segment(bvec, bio, iter) {
+		if (bvec.bv_offset || bvec.bv_len != PAGE_SIZE)
+			return false;
+	}
+
+	return true;
+}
+
 static void __zram_make_request(struct zram *zram, struct bio *bio)
 {
 	int offset, rw;
@@ -1355,6 +2944,27 @@ static void __zram_make_request(struct zram *zram, struct bio *bio)
 	}
 
 	rw = bio_data_dir(bio);
+	if (rw == WRITE && zram_bio_batchable(zram, bio, offset)) {
+		struct bio_vec bvecs[ZRAM_WRITE_BATCH];
+		int nr = 0;
+
+		bio_for_each_segment(bvec, bio, iter) {
+			bvecs[nr++] = bvec;
+			if (nr < ZRAM_WRITE_BATCH)
+				continue;
+			if (zram_bvec_write_batch(zram, bvecs, nr, index, bio) < 0)
+				goto out;
+			index += nr;
+			nr = 0;
+		}
+
+		if (nr && zram_bvec_write_batch(zram, bvecs, nr, index, bio) < 0)
+			goto out;
+
+		bio_endio(bio);
+		return;
+	}
+
 	bio_for_each_segment(bvec, bio, iter) {
 		struct bio_vec bv = bvec;
 		unsigned int unwritten = bvec.bv_len;
@@ -1379,6 +2989,148 @@ out:
 	bio_io_error(bio);
 }
 
+#ifdef CONFIG_ZRAM_ASYNC_WRITE
+static bool zram_async_enabled(struct zram *zram)
+{
+	return zram->nr_async_workers;
+}
+
+static int zram_async_thread(void *data)
+{
+	struct zram_async_worker *worker = data;
+	struct bio_list bios;
+	struct bio *bio;
+
+	for (;;) {
+		wait_event(worker->wait, !bio_list_empty(&worker->bios) ||
+				kthread_should_stop());
+
+		spin_lock_irq(&worker->lock);
+		bios = worker->bios;
+		bio_list_init(&worker->bios);
+		spin_unlock_irq(&worker->lock);
+
+		/* drain everything queued before honouring a stop request */
+		if (bio_list_empty(&bios) && kthread_should_stop())
+			break;
+
+		while ((bio = bio_list_pop(&bios)))
+			__zram_make_request(worker->zram, bio);
+
+		cond_resched();
+	}
+
+	return 0;
+}
+
+static void zram_async_queue(struct zram *zram, struct bio *bio)
+{
+	struct zram_async_worker *worker;
+	unsigned int next = atomic_inc_return(&zram->async_next);
+	unsigned long flags;
+
+	worker = &zram->async_workers[next % zram->nr_async_workers];
+
+	spin_lock_irqsave(&worker->lock, flags);
+	bio_list_add(&worker->bios, bio);
+	spin_unlock_irqrestore(&worker->lock, flags);
+
+	wake_up(&worker->wait);
+}
+
+static void zram_async_stop(struct zram *zram)
+{
+	unsigned int i;
+
+	if (!zram_async_enabled(zram))
+		return;
+
+	for (i = 0; i < zram->nr_async_workers; i++)
+		kthread_stop(zram->async_workers[i].task);
+
+	kfree(zram->async_workers);
+	zram->async_workers = NULL;
+	zram->nr_async_workers = 0;
+}
+
+static int zram_async_start(struct zram *zram)
+{
+	struct zram_async_worker *workers;
+	unsigned int i, nr;
+
+	if (!zram->async_write)
+		return 0;
+
+	nr = cpumask_weight(cpu_lp_mask);
+	if (!nr)
+		return -ENODEV;
+
+	workers = kcalloc(nr, sizeof(*workers), GFP_KERNEL);
+	if (!workers)
+		return -ENOMEM;
+
+	zram->async_workers = workers;
+	for (i = 0; i < nr; i++) {
+		struct zram_async_worker *worker = &workers[i];
+		struct task_struct *task;
+
+		worker->zram = zram;
+		spin_lock_init(&worker->lock);
+		bio_list_init(&worker->bios);
+		init_waitqueue_head(&worker->wait);
+
+		task = kthread_create(zram_async_thread, worker, "%s_comp/%u",
+				zram->disk->disk_name, i);
+		if (IS_ERR(task)) {
+			zram_async_stop(zram);
+			return PTR_ERR(task);
+		}
+
+		kthread_bind_mask(task, cpu_lp_mask);
+		worker->task = task;
+		zram->nr_async_workers++;
+		wake_up_process(task);
+	}
+
+	return 0;
+}
+
+static ssize_t async_write_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%d\n", zram->async_write);
+}
+
+static ssize_t async_write_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	bool val;
+
+	if (strtobool(buf, &val))
+		return -EINVAL;
+
+	down_write(&zram->init_lock);
+	if (init_done(zram)) {
+		up_write(&zram->init_lock);
+		pr_info("Can't change async_write for initialized device\n");
+		return -EBUSY;
+	}
+
+	zram->async_write = val;
+	up_write(&zram->init_lock);
+
+	return len;
+}
+#else
+static bool zram_async_enabled(struct zram *zram) { return false; }
+static void zram_async_queue(struct zram *zram, struct bio *bio) {}
+static void zram_async_stop(struct zram *zram) {}
+static int zram_async_start(struct zram *zram) { return 0; }
+#endif
+
 /*
  * Handler function for all zram I/O requests.
  */
@@ -1392,6 +3144,12 @@ static blk_qc_t zram_make_request(struct request_queue *queue, struct bio *bio)
 		goto error;
 	}
 
+	if (zram_async_enabled(zram) && bio_data_dir(bio) == WRITE &&
+			!(bio->bi_rw & REQ_DISCARD)) {
+		zram_async_queue(zram, bio);
+		return BLK_QC_T_NONE;
+	}
+
 	__zram_make_request(zram, bio);
 	return BLK_QC_T_NONE;
 
@@ -1423,6 +3181,13 @@ static int zram_rw_page(struct block_device *bdev, sector_t sector,
 
 	zram = bdev->bd_disk->private_data;
 
+	/*
+	 * Let the caller resubmit async writes as a bio so that they
+	 * reach the compression workers.
+	 */
+	if ((rw & WRITE) && zram_async_enabled(zram))
+		return -EOPNOTSUPP;
+
 	if (!valid_io_request(zram, sector, PAGE_SIZE)) {
 		atomic64_inc(&zram->stats.invalid_io);
 		ret = -EINVAL;
@@ -1467,6 +3232,9 @@ static void zram_reset_device(struct zram *zram)
 	struct zcomp *comp;
 	u64 disksize;
 
+	/* the daemon takes init_lock itself */
+	zram_wb_stop(zram);
+
 	down_write(&zram->init_lock);
 
 	zram->limit_pages = 0;
@@ -1484,10 +3252,13 @@ static void zram_reset_device(struct zram *zram)
 	part_stat_set_all(&zram->disk->part0, 0);
 
 	up_write(&zram->init_lock);
+	/* Let the workers store whatever is still queued */
+	zram_async_stop(zram);
 	/* I/O operation under all of CPU are done so let's free */
 	zram_meta_free(zram, disksize);
 	memset(&zram->stats, 0, sizeof(zram->stats));
 	zcomp_destroy(comp);
+	zram_recomp_destroy(zram);
 	reset_bdev(zram);
 }
 
@@ -1524,11 +3295,26 @@ static ssize_t disksize_store(struct device *dev,
 		goto out_free_meta;
 	}
 
+	err = zram_recomp_create(zram);
+	if (err) {
+		zcomp_destroy(comp);
+		goto out_free_meta;
+	}
+
+	err = zram_async_start(zram);
+	if (err) {
+		pr_err("Cannot start compression workers\n");
+		zram_recomp_destroy(zram);
+		zcomp_destroy(comp);
+		goto out_free_meta;
+	}
+
 	zram->comp = comp;
 	zram->disksize = disksize;
 	set_capacity(zram->disk, zram->disksize >> SECTOR_SHIFT);
 
 	revalidate_disk(zram->disk);
+	zram_wb_start(zram);
 	up_write(&zram->init_lock);
 
 	return len;
@@ -1615,8 +3401,26 @@ static DEVICE_ATTR_WO(mem_limit);
 static DEVICE_ATTR_WO(mem_used_max);
 static DEVICE_ATTR_RW(max_comp_streams);
 static DEVICE_ATTR_RW(comp_algorithm);
+static DEVICE_ATTR_RW(batch_write);
+static DEVICE_ATTR_RW(skip_incompressible);
+static DEVICE_ATTR_RW(slot_lock_shards);
+#ifdef CONFIG_ZRAM_DEDUP
+static DEVICE_ATTR_RW(use_dedup);
+#endif
+static DEVICE_ATTR_WO(idle);
+#ifdef CONFIG_ZRAM_MULTI_COMP
+static DEVICE_ATTR_RW(recomp_algorithm);
+static DEVICE_ATTR_WO(recompress);
+#endif
 #ifdef CONFIG_ZRAM_WRITEBACK
 static DEVICE_ATTR_RW(backing_dev);
+static DEVICE_ATTR_RW(wb_readahead);
+static DEVICE_ATTR_WO(writeback);
+static DEVICE_ATTR_RW(wb_interval);
+static DEVICE_ATTR_RW(wb_budget);
+#endif
+#ifdef CONFIG_ZRAM_ASYNC_WRITE
+static DEVICE_ATTR_RW(async_write);
 #endif
 
 static struct attribute *zram_disk_attrs[] = {
@@ -1628,8 +3432,26 @@ static struct attribute *zram_disk_attrs[] = {
 	&dev_attr_mem_used_max.attr,
 	&dev_attr_max_comp_streams.attr,
 	&dev_attr_comp_algorithm.attr,
+	&dev_attr_batch_write.attr,
+	&dev_attr_skip_incompressible.attr,
+	&dev_attr_slot_lock_shards.attr,
+#ifdef CONFIG_ZRAM_DEDUP
+	&dev_attr_use_dedup.attr,
+#endif
+	&dev_attr_idle.attr,
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	&dev_attr_recomp_algorithm.attr,
+	&dev_attr_recompress.attr,
+#endif
 #ifdef CONFIG_ZRAM_WRITEBACK
 	&dev_attr_backing_dev.attr,
+	&dev_attr_wb_readahead.attr,
+	&dev_attr_writeback.attr,
+	&dev_attr_wb_interval.attr,
+	&dev_attr_wb_budget.attr,
+#endif
+#ifdef CONFIG_ZRAM_ASYNC_WRITE
+	&dev_attr_async_write.attr,
 #endif
 	&dev_attr_io_stat.attr,
 	&dev_attr_mm_stat.attr,
@@ -1666,6 +3488,10 @@ static int zram_add(void)
 	device_id = ret;
 
 	init_rwsem(&zram->init_lock);
+#ifdef CONFIG_ZRAM_WRITEBACK
+	mutex_init(&zram->wb_lock);
+	INIT_DELAYED_WORK(&zram->wb_work, zram_wb_work);
+#endif
 
 	queue = blk_alloc_queue(GFP_KERNEL);
 	if (!queue) {
@@ -16,10 +16,13 @@
 #define _ZRAM_DRV_H_
 
 #include <linux/rwsem.h>
+#include <linux/mutex.h>
+#include <linux/workqueue.h>
 #include <linux/zsmalloc.h>
 #include <linux/crypto.h>
 
 #include "zcomp.h"
+#include "zram_dedup.h"
 
 /*-- Configurable parameters */
 
@@ -35,6 +38,47 @@ static const size_t max_zpage_size = PAGE_SIZE / 4 * 3;
  * always return failure.
  */
 
+/*
+ * Maximum number of pages compressed under one stream acquisition
+ * when batch_write is enabled.
+ */
+#define ZRAM_WRITE_BATCH	16
+
+/* Largest run of pages written back with one bio */
+#define ZRAM_WB_BATCH		32
+/* The writeback budget is per this period */
+#define ZRAM_WB_BUDGET_PERIOD	(24 * 60 * 60 * HZ)
+
+/* Pages cached by writeback readahead */
+#define ZRAM_RA_PAGES		8
+#define ZRAM_RA_INVALID		((u32)-1)
+
+/* Upper bound for the slot_lock_shards attribute */
+#define ZRAM_MAX_SLOT_LOCKS	4096
+
+/*
+ * Lock wait/hold histograms: bucket 0 is below 256ns, every following
+ * bucket doubles, the last one is open-ended.
+ */
+#define ZRAM_LOCK_HIST_SHIFT	8
+#define ZRAM_LOCK_HIST_BUCKETS	12
+
+/*
+ * Incompressibility estimate: distinct byte values seen in
+ * ZRAM_ENTROPY_LINES cache lines spread over the page. Uniformly random
+ * data hits about 221 of 256 values in those 512 bytes.
+ */
+#define ZRAM_ENTROPY_LINES	8
+#define ZRAM_ENTROPY_LINE_SIZE	64
+#define ZRAM_ENTROPY_THRESHOLD	200
+
+/*
+ * Memory cgroups tracked by memcg_stat. Groups beyond this share the
+ * trailing overflow entry.
+ */
+#define ZRAM_MEMCG_SHIFT	6
+#define ZRAM_MEMCG_SLOTS	(1 << ZRAM_MEMCG_SHIFT)
+
 /*-- End of configurable params */
 
 #define SECTORS_PER_PAGE_SHIFT	(PAGE_SHIFT - SECTOR_SHIFT)
@@ -64,12 +108,26 @@ enum zram_pageflags {
 	ZRAM_SAME,	/* Page consists the same element */
 	ZRAM_WB,	/* page is stored on backing_device */
 	ZRAM_HUGE,	/* Incompressible page */
+	ZRAM_IDLE,	/* not accessed page since last idle marking */
+	ZRAM_RECOMP,	/* page compressed with the secondary algorithm */
+	ZRAM_DEDUP,	/* handle points to a shared zram_dedup_entry */
 
 	__NR_ZRAM_PAGEFLAGS,
 };
 
 /*-- Data structures */
 
+#ifdef CONFIG_ZRAM_ASYNC_WRITE
+/* Compression worker, one per little CPU */
+struct zram_async_worker {
+	struct task_struct *task;
+	struct zram *zram;
+	spinlock_t lock;
+	struct bio_list bios;	/* write bios waiting to be stored */
+	wait_queue_head_t wait;
+};
+#endif
+
 /* Allocated for each disk page */
 struct zram_table_entry {
 	union {
@@ -80,8 +138,43 @@ struct zram_table_entry {
 #ifdef CONFIG_ZRAM_MEMORY_TRACKING
 	ktime_t ac_time;
 #endif
+#ifdef CONFIG_ZRAM_MEMCG_STAT
+	u16 memcg;	/* memcg_stat index + 1, 0 when not charged */
+#endif
 };
 
+/* Striped slot lock, used instead of the ZRAM_LOCK bit when sharded */
+struct zram_slot_lock_bucket {
+	spinlock_t lock;
+} ____cacheline_aligned_in_smp;
+
+#ifdef CONFIG_ZRAM_LOCK_STAT
+struct zram_lock_stat {
+	u64 acquired;
+	u64 contended;
+	u64 wait_hist[ZRAM_LOCK_HIST_BUCKETS];
+	u64 hold_hist[ZRAM_LOCK_HIST_BUCKETS];
+	ktime_t hold_start;
+};
+#endif
+
+#ifdef CONFIG_ZRAM_MEMCG_STAT
+/* Compressed memory charged to one memory cgroup */
+struct zram_memcg_stat {
+	unsigned long ino;	/* claimed once with cmpxchg, 0 = free */
+	atomic64_t pages;
+	atomic64_t compr_size;
+};
+#endif
+
+#ifdef CONFIG_ZRAM_WRITEBACK
+struct zram_ra_entry {
+	struct page *page;
+	u32 index;		/* slot cached in @page or ZRAM_RA_INVALID */
+	unsigned long entry;	/* backing device block of @index */
+};
+#endif
+
 struct zram_stats {
 	atomic64_t compr_data_size;	/* compressed size of pages stored */
 	atomic64_t num_reads;	/* failed + successful */
@@ -95,10 +188,22 @@ struct zram_stats {
 	atomic64_t pages_stored;	/* no. of pages currently stored */
 	atomic_long_t max_used_pages;	/* no. of maximum pages stored */
 	atomic64_t writestall;		/* no. of write slow paths */
+	atomic64_t incompressible;	/* pages stored without compressing */
+	atomic64_t wb_pages;		/* pages written back by the daemon */
+	atomic64_t wb_ra_pages;		/* pages prefetched from backing dev */
+	atomic64_t wb_ra_hits;		/* reads served by the prefetch cache */
+	atomic64_t dup_data_size;	/* compressed bytes saved by dedup */
+	atomic64_t meta_data_size;	/* bytes used by the dedup index */
 };
 
 struct zram {
 	struct zram_table_entry *table;
+	struct zram_slot_lock_bucket *slot_locks;
+	unsigned int nr_slot_locks;
+	unsigned int slot_lock_shards;	/* requested via sysfs */
+#ifdef CONFIG_ZRAM_LOCK_STAT
+	struct zram_lock_stat __percpu *lock_stat;
+#endif
 	struct zs_pool *mem_pool;
 	struct zcomp *comp;
 	struct gendisk *disk;
@@ -116,10 +221,19 @@ struct zram {
 	 */
 	u64 disksize;	/* bytes */
 	char compressor[CRYPTO_MAX_ALG_NAME];
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	/* secondary, high-ratio algorithm used to recompress idle slots */
+	struct zcomp *recomp;
+	char recomp_compressor[CRYPTO_MAX_ALG_NAME];
+#endif
 	/*
 	 * zram is claimed so open request will be failed
 	 */
 	bool claim; /* Protected by bdev->bd_mutex */
+	/* compress multi-page write bios under one stream acquisition */
+	bool batch_write;
+	/* store pages that look random as huge without compressing them */
+	bool skip_incompressible;
 #ifdef CONFIG_ZRAM_WRITEBACK
 	struct file *backing_dev;
 	struct block_device *bdev;
@@ -127,9 +241,36 @@ struct zram {
 	unsigned long *bitmap;
 	unsigned long nr_pages;
 	spinlock_t bitmap_lock;
+	bool wb_readahead;
+	struct mutex wb_lock;		/* serialises writeback passes */
+	struct delayed_work wb_work;
+	bool wb_active;			/* daemon may be queued, wb_lock */
+	unsigned int wb_interval;	/* seconds, 0 = daemon disabled */
+	u64 wb_budget;			/* bytes per day, 0 = unlimited */
+	u64 wb_budget_used;
+	unsigned long wb_budget_start;
+	unsigned int wb_last_kbps;
+	spinlock_t ra_lock;
+	struct zram_ra_entry ra[ZRAM_RA_PAGES];
+	unsigned int ra_next;
+	u32 ra_last_index;
+#endif
+#ifdef CONFIG_ZRAM_DEDUP
+	bool use_dedup;
+	struct zram_dedup_bucket *dedup_hash;
+	size_t dedup_hash_size;
+#endif
+#ifdef CONFIG_ZRAM_ASYNC_WRITE
+	bool async_write;
+	struct zram_async_worker *async_workers;
+	unsigned int nr_async_workers;
+	atomic_t async_next;
 #endif
 #ifdef CONFIG_ZRAM_MEMORY_TRACKING
 	struct dentry *debugfs_dir;
 #endif
+#ifdef CONFIG_ZRAM_MEMCG_STAT
+	struct zram_memcg_stat memcg_stat[ZRAM_MEMCG_SLOTS + 1];
+#endif
 };
 #endif
@@ -15,6 +15,7 @@
 #include <linux/suspend.h>
 #include <linux/debugfs.h>
 #include <linux/slab.h>
+#include <linux/workqueue.h>
 
 #include <soc/samsung/bts.h>
 #include "cal_bts8895.h"
@@ -25,6 +26,9 @@
 #define MIF_UTIL		65
 #define INT_UTIL		70
 #define INITIAL_MIF_FREQ	2093000
+#define BTS_PLAN_EXPIRE_MS	50
+/* a lower MIF/INT vote has to hold this long before it is applied */
+#define BTS_LOWER_DELAY_MS	100
 
 #define QBUSY_DEFAULT          4
 #define QFULL_LOW_DEFAULT      0xa
@@ -111,6 +115,29 @@ static struct pm_qos_request exynos_mif_bts_qos;
 static struct pm_qos_request exynos_int_bts_qos;
 static DEFINE_MUTEX(media_mutex);
 
+/*
+ * "ip_bw" is the bandwidth each IP is using now. "plan_bw" is the
+ * bandwidth an IP announced for its next configuration, valid until the
+ * IP updates its bandwidth or the plan expires.
+ */
+static struct bts_bw ip_bw[BTS_BW_MAX];
+static struct bts_bw plan_bw[BTS_BW_MAX];
+static unsigned long plan_expires[BTS_BW_MAX];
+static DEFINE_SPINLOCK(plan_lock);
+static ATOMIC_NOTIFIER_HEAD(bts_plan_notifier);
+
+/*
+ * MIF/INT frequency voted for the sum of "ip_bw". A raise is voted at once,
+ * a drop only after the lower sum held for BTS_LOWER_DELAY_MS, so clients
+ * that update their bandwidth at different points of a frame do not make
+ * the bus frequency go down and up again within the frame.
+ */
+static unsigned int bts_mif_vote;
+static unsigned int bts_int_vote;
+static unsigned int bts_vote_cnt;
+static void bts_lower_work_fn(struct work_struct *work);
+static DECLARE_DELAYED_WORK(bts_lower_work, bts_lower_work_fn);
+
 struct trex_info {
 	unsigned int pa_base;
 	void __iomem *va_base;
@@ -914,6 +941,50 @@ static const struct file_operations debug_qos_status_fops = {
 	.release	= single_release,
 };
 
+static const char *bts_bw_name[BTS_BW_MAX] = {
+	[BTS_BW_DECON0] = "decon0",
+	[BTS_BW_DECON1] = "decon1",
+	[BTS_BW_DECON2] = "decon2",
+	[BTS_BW_CAMERA] = "camera",
+	[BTS_BW_AUDIO] = "audio",
+	[BTS_BW_CP] = "cp",
+	[BTS_BW_G2D] = "g2d",
+	[BTS_BW_MFC] = "mfc",
+	[BTS_BW_MCSL] = "mcsl",
+#ifndef CONFIG_SOC_EMULATOR8895
+	[BTS_BW_IVA] = "iva",
+	[BTS_BW_DSP] = "dsp",
+#endif
+};
+
+static int exynos_bw_status_open_show(struct seq_file *buf, void *d)
+{
+	int i;
+
+	mutex_lock(&media_mutex);
+	for (i = 0; i < BTS_BW_MAX; i++)
+		seq_printf(buf, "%-8s peak %8u read %8u write %8u\n",
+			   bts_bw_name[i], ip_bw[i].peak,
+			   ip_bw[i].read, ip_bw[i].write);
+	seq_printf(buf, "vote(KHz): mif %u int %u, %u updates\n",
+		   bts_mif_vote, bts_int_vote, bts_vote_cnt);
+	mutex_unlock(&media_mutex);
+
+	return 0;
+}
+
+static int exynos_bw_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, exynos_bw_status_open_show, inode->i_private);
+}
+
+static const struct file_operations debug_bw_status_fops = {
+	.open		= exynos_bw_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
 static int exynos_tq_status_open_show(struct seq_file *buf, void *d)
 {
 	int i;
@@ -1124,6 +1195,7 @@ static int bts_debugfs(void)
 	debugfs_create_file("qbusy", 0440, den, NULL,
 			    &debug_qbusy_status_fops);
 	debugfs_create_file("tq", 0440, den, NULL, &debug_tq_status_fops);
+	debugfs_create_file("bw", 0440, den, NULL, &debug_bw_status_fops);
 	if (!debugfs_create_u32("log", 0644, den, &exynos_bts_log)) {
 		pr_err("[BTS]: could't create debugfs bts log\n");
 	}
@@ -1269,50 +1341,147 @@ unsigned int bts_calc_bw(enum bts_bw_type type, void *data)
 	return bw;
 }
 
+static void bts_calc_freq(struct bts_bw *bws, unsigned int *mif_freq,
+				unsigned int *int_freq)
+{
+	unsigned int bw_r = 0, bw_w = 0, int_bw = 0;
+	int i;
+
+	for (i = 0; i < BTS_BW_MAX; i++) {
+		if (int_bw < bws[i].peak)
+			int_bw = bws[i].peak;
+		bw_r += bws[i].read;
+		bw_w += bws[i].write;
+	}
+	if (int_bw < (bw_w / NUM_CHANNEL))
+		int_bw = bw_w / NUM_CHANNEL;
+	if (int_bw < (bw_r / NUM_CHANNEL))
+		int_bw = bw_r / NUM_CHANNEL;
+
+	*mif_freq = (bw_r + bw_w) * 100 / BUS_WIDTH / exynos_mif_util;
+	*int_freq = int_bw * 100 / BUS_WIDTH / exynos_int_util;
+}
+
+/*
+ * Announce the bandwidth (KB/s) an IP will use with its next configuration
+ * before that configuration is applied, so bus governors can raise the
+ * frequency ahead of it.
+ */
+void bts_plan_bw(enum bts_bw_type type, struct bts_bw bw)
+{
+	unsigned long flags;
+
+	if (type >= BTS_BW_MAX)
+		return;
+
+	spin_lock_irqsave(&plan_lock, flags);
+	plan_bw[type] = bw;
+	plan_expires[type] = jiffies + msecs_to_jiffies(BTS_PLAN_EXPIRE_MS);
+	spin_unlock_irqrestore(&plan_lock, flags);
+
+	atomic_notifier_call_chain(&bts_plan_notifier, type, NULL);
+}
+
+/*
+ * Frequency (KHz) needed by the bandwidth in use, with announced plans
+ * replacing the current bandwidth of their IPs.
+ */
+unsigned int bts_plan_freq(enum bts_plan_domain domain)
+{
+	struct bts_bw bws[BTS_BW_MAX];
+	unsigned int mif_freq, int_freq;
+	unsigned long flags;
+	int i;
+
+	spin_lock_irqsave(&plan_lock, flags);
+	for (i = 0; i < BTS_BW_MAX; i++) {
+		if (plan_expires[i] && time_before(jiffies, plan_expires[i]))
+			bws[i] = plan_bw[i];
+		else
+			bws[i] = ip_bw[i];
+	}
+	spin_unlock_irqrestore(&plan_lock, flags);
+
+	bts_calc_freq(bws, &mif_freq, &int_freq);
+
+	return domain == BTS_PLAN_INT ? int_freq : mif_freq;
+}
+
+int bts_plan_register_notifier(struct notifier_block *nb)
+{
+	return atomic_notifier_chain_register(&bts_plan_notifier, nb);
+}
+
+int bts_plan_unregister_notifier(struct notifier_block *nb)
+{
+	return atomic_notifier_chain_unregister(&bts_plan_notifier, nb);
+}
+
+/* Must be called with media_mutex held */
+static void bts_vote_freq(unsigned int mif_freq, unsigned int int_freq)
+{
+	if (mif_freq == bts_mif_vote && int_freq == bts_int_vote)
+		return;
+
+	pm_qos_update_request(&exynos_mif_bts_qos, mif_freq);
+	pm_qos_update_request(&exynos_int_bts_qos, int_freq);
+	bts_mif_vote = mif_freq;
+	bts_int_vote = int_freq;
+	bts_vote_cnt++;
+}
+
+static void bts_lower_work_fn(struct work_struct *work)
+{
+	unsigned int mif_freq;
+	unsigned int int_freq;
+
+	mutex_lock(&media_mutex);
+	bts_calc_freq(ip_bw, &mif_freq, &int_freq);
+	bts_vote_freq(mif_freq, int_freq);
+	mutex_unlock(&media_mutex);
+}
+
 void bts_update_bw(enum bts_bw_type type, struct bts_bw bw)
 {
-	static struct bts_bw ip_bw[BTS_BW_MAX];
+	unsigned long flags;
 	unsigned int mif_freq;
 	unsigned int int_freq;
-	unsigned int total_bw = 0;
-	unsigned int bw_r = 0;
-	unsigned int bw_w = 0;
-	unsigned int int_bw = 0;
-	int i;
 
 	if (type >= BTS_BW_MAX)
 		return;
+
+	/* The plan of this IP is realized now */
+	spin_lock_irqsave(&plan_lock, flags);
+	plan_expires[type] = 0;
+	spin_unlock_irqrestore(&plan_lock, flags);
+
 	if (ip_bw[type].peak == bw.peak
 	    && ip_bw[type].read == bw.read
 	    && ip_bw[type].write == bw.write)
 		return;
 	mutex_lock(&media_mutex);
 
+	spin_lock_irqsave(&plan_lock, flags);
 	ip_bw[type] = bw;
-	for (i = 0; i < BTS_BW_MAX; i++) {
-		if (int_bw < ip_bw[i].peak)
-			int_bw = ip_bw[i].peak;
-		bw_r += ip_bw[i].read;
-		bw_w += ip_bw[i].write;
-	}
-	total_bw = bw_r + bw_w;
-	if (int_bw < (bw_w / NUM_CHANNEL))
-		int_bw = bw_w / NUM_CHANNEL;
-	if (int_bw < (bw_r / NUM_CHANNEL))
-		int_bw = bw_r / NUM_CHANNEL;
+	spin_unlock_irqrestore(&plan_lock, flags);
 
 	/* MIF minimum frequency calculation as per BTS guide */
-	mif_freq = total_bw * 100 / BUS_WIDTH / exynos_mif_util;
-	int_freq = int_bw * 100 / BUS_WIDTH / exynos_int_util;
-
-	pm_qos_update_request(&exynos_mif_bts_qos, mif_freq);
-	pm_qos_update_request(&exynos_int_bts_qos, int_freq);
+	bts_calc_freq(ip_bw, &mif_freq, &int_freq);
+
+	if (mif_freq >= bts_mif_vote && int_freq >= bts_int_vote) {
+		cancel_delayed_work(&bts_lower_work);
+		bts_vote_freq(mif_freq, int_freq);
+	} else {
+		/* raise the domain going up now, keep the other one for a while */
+		bts_vote_freq(max(mif_freq, bts_mif_vote),
+			      max(int_freq, bts_int_vote));
+		mod_delayed_work(system_wq, &bts_lower_work,
+				 msecs_to_jiffies(BTS_LOWER_DELAY_MS));
+	}
 
 	BTS_DBG("[BTS] BW(KB/s): type%i bw %up %ur %uw, "
-		"int %u total %u, read %u, write %u, "
 		"freq(Khz): mif %u, int %u\n",
-		type, bw.peak, bw.read, bw.write, int_bw, total_bw,
-		bw_r, bw_w, mif_freq, int_freq);
+		type, bw.peak, bw.read, bw.write, mif_freq, int_freq);
 
 	mutex_unlock(&media_mutex);
 }
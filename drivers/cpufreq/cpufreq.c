@@ -1951,6 +1951,47 @@ static int __target_index(struct cpufreq_policy *policy,
 	return retval;
 }
 
+/**
+ * cpufreq_enable_fast_switch - Enable fast frequency switching for policy.
+ * @policy: cpufreq policy to enable fast frequency switching for.
+ *
+ * Only has an effect if the driver set policy->fast_switch_possible.
+ * Governors call this on start and then use cpufreq_driver_fast_switch()
+ * instead of __cpufreq_driver_target() while fast_switch_enabled is set.
+ */
+void cpufreq_enable_fast_switch(struct cpufreq_policy *policy)
+{
+	if (!policy->fast_switch_possible || !cpufreq_driver->fast_switch)
+		return;
+
+	policy->fast_switch_enabled = true;
+}
+EXPORT_SYMBOL_GPL(cpufreq_enable_fast_switch);
+
+void cpufreq_disable_fast_switch(struct cpufreq_policy *policy)
+{
+	policy->fast_switch_enabled = false;
+}
+EXPORT_SYMBOL_GPL(cpufreq_disable_fast_switch);
+
+/**
+ * cpufreq_driver_fast_switch - Carry out a fast CPU frequency switch.
+ * @policy: cpufreq policy to switch the frequency for.
+ * @target_freq: New frequency to set (may be approximate).
+ *
+ * Runs from scheduler context, so neither the policy rwsem nor the
+ * transition notifiers are used. Returns the frequency actually set or 0
+ * if the driver left it unchanged.
+ */
+unsigned int cpufreq_driver_fast_switch(struct cpufreq_policy *policy,
+					unsigned int target_freq)
+{
+	target_freq = clamp_val(target_freq, policy->min, policy->max);
+
+	return cpufreq_driver->fast_switch(policy, target_freq);
+}
+EXPORT_SYMBOL_GPL(cpufreq_driver_fast_switch);
+
 int __cpufreq_driver_target(struct cpufreq_policy *policy,
 			    unsigned int target_freq,
 			    unsigned int relation)
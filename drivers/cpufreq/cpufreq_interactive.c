@@ -81,6 +81,17 @@ static struct mutex gov_lock;
 #define DEFAULT_TARGET_LOAD 90
 static unsigned int default_target_loads[] = {DEFAULT_TARGET_LOAD};
 
+/*
+ * Adaptive target load. Frames missing their deadline while the CPU ran
+ * near its target load at an OPP lower that OPP's target load, frames on
+ * time slowly raise it again, within these bounds.
+ */
+#define ADAPTIVE_TL_MIN 40
+#define ADAPTIVE_TL_MAX 95
+#define ADAPTIVE_TL_STEP 5
+#define ADAPTIVE_TL_MARGIN 10
+#define ADAPTIVE_MISS_PCT 5
+
 #define DEFAULT_TIMER_RATE (20 * USEC_PER_MSEC)
 #define DEFAULT_ABOVE_HISPEED_DELAY DEFAULT_TIMER_RATE
 static unsigned int default_above_hispeed_delay[] = {
@@ -104,6 +115,16 @@ struct cpufreq_interactive_tunables {
 	spinlock_t target_loads_lock;
 	unsigned int *target_loads;
 	int ntarget_loads;
+	/*
+	 * Target load learned per frequency table index from frame_feedback,
+	 * 0 where nothing was learned yet, and the average load measured at
+	 * each index. Protected by target_loads_lock.
+	 */
+	bool adaptive_target_load;
+	struct cpufreq_policy *adaptive_policy;
+	struct cpufreq_frequency_table *adaptive_table;
+	unsigned int *learned_loads;
+	unsigned int *opp_load;
 	/*
 	 * The minimum amount of time to spend at a frequency before we can ramp
 	 * down.
@@ -271,24 +292,105 @@ static unsigned int freq_to_above_hispeed_delay(
 	return ret;
 }
 
-static unsigned int freq_to_targetload(
+static int adaptive_opp_index(struct cpufreq_interactive_tunables *tunables,
+		unsigned int freq)
+{
+	struct cpufreq_frequency_table *pos;
+
+	if (!tunables->adaptive_table)
+		return -1;
+
+	cpufreq_for_each_valid_entry(pos, tunables->adaptive_table)
+		if (pos->frequency == freq)
+			return pos - tunables->adaptive_table;
+
+	return -1;
+}
+
+/* The caller shall hold target_loads_lock */
+static unsigned int __freq_to_targetload(
 	struct cpufreq_interactive_tunables *tunables, unsigned int freq)
 {
 	int i;
-	unsigned int ret;
-	unsigned long flags;
 
-	spin_lock_irqsave(&tunables->target_loads_lock, flags);
+	if (tunables->adaptive_target_load && tunables->learned_loads) {
+		i = adaptive_opp_index(tunables, freq);
+		if (i >= 0 && tunables->learned_loads[i])
+			return tunables->learned_loads[i];
+	}
 
 	for (i = 0; i < tunables->ntarget_loads - 1 &&
 		    freq >= tunables->target_loads[i+1]; i += 2)
 		;
 
-	ret = tunables->target_loads[i];
+	return tunables->target_loads[i];
+}
+
+static unsigned int freq_to_targetload(
+	struct cpufreq_interactive_tunables *tunables, unsigned int freq)
+{
+	unsigned int ret;
+	unsigned long flags;
+
+	spin_lock_irqsave(&tunables->target_loads_lock, flags);
+	ret = __freq_to_targetload(tunables, freq);
 	spin_unlock_irqrestore(&tunables->target_loads_lock, flags);
 	return ret;
 }
 
+static void adaptive_record_load(struct cpufreq_interactive_tunables *tunables,
+		unsigned int freq, unsigned int load)
+{
+	unsigned long flags;
+	int i;
+
+	if (!tunables->adaptive_target_load || !tunables->opp_load)
+		return;
+
+	spin_lock_irqsave(&tunables->target_loads_lock, flags);
+	i = adaptive_opp_index(tunables, freq);
+	if (i >= 0)
+		tunables->opp_load[i] = (tunables->opp_load[i] * 7 +
+					 min(load, 100U)) >> 3;
+	spin_unlock_irqrestore(&tunables->target_loads_lock, flags);
+}
+
+static int adaptive_init(struct cpufreq_interactive_tunables *tunables,
+		struct cpufreq_policy *policy,
+		struct cpufreq_frequency_table *freq_table)
+{
+	struct cpufreq_frequency_table *pos;
+	unsigned int *learned, *opp_load;
+	int size = 1;
+	unsigned long flags;
+
+	if (!freq_table)
+		return -EINVAL;
+
+	for (pos = freq_table; pos->frequency != CPUFREQ_TABLE_END; pos++)
+		size++;
+
+	if (!tunables->learned_loads) {
+		learned = kcalloc(size, sizeof(unsigned int), GFP_KERNEL);
+		opp_load = kcalloc(size, sizeof(unsigned int), GFP_KERNEL);
+		if (!learned || !opp_load) {
+			kfree(learned);
+			kfree(opp_load);
+			return -ENOMEM;
+		}
+
+		spin_lock_irqsave(&tunables->target_loads_lock, flags);
+		tunables->learned_loads = learned;
+		tunables->opp_load = opp_load;
+		spin_unlock_irqrestore(&tunables->target_loads_lock, flags);
+	}
+
+	tunables->adaptive_policy = policy;
+	tunables->adaptive_table = freq_table;
+
+	return 0;
+}
+
 /*
  * If increasing frequencies never map to a lower target load then
  * choose_freq() will find the minimum frequency that does not exceed its
@@ -548,6 +650,7 @@ static void cpufreq_interactive_timer(unsigned long data)
 #endif
 	loadadjfreq = (unsigned int)cputime_speedadj * 100;
 	cpu_load = loadadjfreq / pcpu->policy->cur;
+	adaptive_record_load(tunables, pcpu->policy->cur, cpu_load);
 	tunables->boosted = tunables->boost_val || now < tunables->boostpulse_endtime;
 
 	if (cpu_load >= tunables->go_hispeed_load || tunables->boosted) {
@@ -1310,6 +1413,93 @@ static ssize_t store_io_is_busy(struct cpufreq_interactive_tunables *tunables,
 	return count;
 }
 
+static ssize_t show_adaptive_target_load(struct cpufreq_interactive_tunables
+		*tunables, char *buf)
+{
+	return sprintf(buf, "%u\n", tunables->adaptive_target_load);
+}
+
+static ssize_t store_adaptive_target_load(struct cpufreq_interactive_tunables
+		*tunables, const char *buf, size_t count)
+{
+	int ret;
+	unsigned long val;
+
+	ret = kstrtoul(buf, 0, &val);
+	if (ret < 0)
+		return ret;
+	tunables->adaptive_target_load = val;
+	return count;
+}
+
+/*
+ * Frame feedback: "<missed> <total>" frames since the last write, all
+ * accounted to the frequency the policy is running at now.
+ */
+static ssize_t store_frame_feedback(struct cpufreq_interactive_tunables
+		*tunables, const char *buf, size_t count)
+{
+	unsigned int missed, total, tl, freq;
+	unsigned long flags;
+	int i;
+
+	if (sscanf(buf, "%u %u", &missed, &total) != 2 || missed > total)
+		return -EINVAL;
+
+	if (!tunables->adaptive_target_load || !tunables->learned_loads ||
+	    !total)
+		return count;
+
+	spin_lock_irqsave(&tunables->target_loads_lock, flags);
+	if (!tunables->adaptive_policy)
+		goto out;
+	freq = tunables->adaptive_policy->cur;
+	i = adaptive_opp_index(tunables, freq);
+	if (i < 0)
+		goto out;
+
+	tl = __freq_to_targetload(tunables, freq);
+	if (missed * 100 > total * ADAPTIVE_MISS_PCT) {
+		/* Only a CPU bound miss says the target load is too high */
+		if (tunables->opp_load[i] + ADAPTIVE_TL_MARGIN >= tl)
+			tl = max(tl - ADAPTIVE_TL_STEP, (unsigned int)ADAPTIVE_TL_MIN);
+	} else if (!missed) {
+		tl = min(tl + 1, (unsigned int)ADAPTIVE_TL_MAX);
+	}
+	tunables->learned_loads[i] = tl;
+
+out:
+	spin_unlock_irqrestore(&tunables->target_loads_lock, flags);
+	return count;
+}
+
+static ssize_t show_learned_target_loads(struct cpufreq_interactive_tunables
+		*tunables, char *buf)
+{
+	struct cpufreq_frequency_table *pos;
+	unsigned long flags;
+	ssize_t ret = 0;
+	int i;
+
+	spin_lock_irqsave(&tunables->target_loads_lock, flags);
+	if (tunables->adaptive_table && tunables->learned_loads) {
+		cpufreq_for_each_valid_entry(pos, tunables->adaptive_table) {
+			i = pos - tunables->adaptive_table;
+			if (!tunables->learned_loads[i])
+				continue;
+			ret += scnprintf(buf + ret, PAGE_SIZE - ret, "%u:%u ",
+					pos->frequency,
+					tunables->learned_loads[i]);
+		}
+	}
+	spin_unlock_irqrestore(&tunables->target_loads_lock, flags);
+
+	if (ret)
+		ret--;
+	ret += scnprintf(buf + ret, PAGE_SIZE - ret, "\n");
+	return ret;
+}
+
 #ifdef CONFIG_DYNAMIC_MODE_SUPPORT
 static ssize_t show_mode(struct cpufreq_interactive_tunables
 		*tunables, char *buf)
@@ -1410,6 +1600,9 @@ show_store_gov_pol_sys(boost);
 store_gov_pol_sys(boostpulse);
 show_store_gov_pol_sys(boostpulse_duration);
 show_store_gov_pol_sys(io_is_busy);
+show_store_gov_pol_sys(adaptive_target_load);
+store_gov_pol_sys(frame_feedback);
+show_gov_pol_sys(learned_target_loads);
 #ifdef CONFIG_EXYNOS_WD_DVFS
 show_store_gov_pol_sys(wd_boundary);
 #endif
@@ -1440,6 +1633,7 @@ gov_sys_pol_attr_rw(timer_slack);
 gov_sys_pol_attr_rw(boost);
 gov_sys_pol_attr_rw(boostpulse_duration);
 gov_sys_pol_attr_rw(io_is_busy);
+gov_sys_pol_attr_rw(adaptive_target_load);
 #ifdef CONFIG_EXYNOS_WD_DVFS
 gov_sys_pol_attr_rw(wd_boundary);
 #endif
@@ -1454,6 +1648,18 @@ static struct global_attr boostpulse_gov_sys =
 static struct freq_attr boostpulse_gov_pol =
 	__ATTR(boostpulse, 0200, NULL, store_boostpulse_gov_pol);
 
+static struct global_attr frame_feedback_gov_sys =
+	__ATTR(frame_feedback, 0200, NULL, store_frame_feedback_gov_sys);
+
+static struct freq_attr frame_feedback_gov_pol =
+	__ATTR(frame_feedback, 0200, NULL, store_frame_feedback_gov_pol);
+
+static struct global_attr learned_target_loads_gov_sys =
+	__ATTR(learned_target_loads, 0444, show_learned_target_loads_gov_sys, NULL);
+
+static struct freq_attr learned_target_loads_gov_pol =
+	__ATTR(learned_target_loads, 0444, show_learned_target_loads_gov_pol, NULL);
+
 /* One Governor instance for entire system */
 static struct attribute *interactive_attributes_gov_sys[] = {
 	&target_loads_gov_sys.attr,
@@ -1467,6 +1673,9 @@ static struct attribute *interactive_attributes_gov_sys[] = {
 	&boostpulse_gov_sys.attr,
 	&boostpulse_duration_gov_sys.attr,
 	&io_is_busy_gov_sys.attr,
+	&adaptive_target_load_gov_sys.attr,
+	&frame_feedback_gov_sys.attr,
+	&learned_target_loads_gov_sys.attr,
 #ifdef CONFIG_EXYNOS_WD_DVFS
 	&wd_boundary_gov_sys.attr,
 #endif
@@ -1495,6 +1704,9 @@ static struct attribute *interactive_attributes_gov_pol[] = {
 	&boostpulse_gov_pol.attr,
 	&boostpulse_duration_gov_pol.attr,
 	&io_is_busy_gov_pol.attr,
+	&adaptive_target_load_gov_pol.attr,
+	&frame_feedback_gov_pol.attr,
+	&learned_target_loads_gov_pol.attr,
 #ifdef CONFIG_EXYNOS_WD_DVFS
 	&wd_boundary_gov_pol.attr,
 #endif
@@ -1710,6 +1922,8 @@ static int cpufreq_governor_interactive(struct cpufreq_policy *policy,
 		mutex_lock(&gov_lock);
 
 		freq_table = cpufreq_frequency_get_table(policy->cpu);
+		if (adaptive_init(tunables, policy, freq_table))
+			pr_warn("%s: adaptive target load unavailable\n", __func__);
 		if (!tunables->hispeed_freq)
 			tunables->hispeed_freq = policy->max;
 #ifdef CONFIG_DYNAMIC_MODE_SUPPORT
@@ -1742,6 +1956,9 @@ static int cpufreq_governor_interactive(struct cpufreq_policy *policy,
 
 	case CPUFREQ_GOV_STOP:
 		mutex_lock(&gov_lock);
+		spin_lock_irqsave(&tunables->target_loads_lock, flags);
+		tunables->adaptive_policy = NULL;
+		spin_unlock_irqrestore(&tunables->target_loads_lock, flags);
 		for_each_cpu(j, policy->cpus) {
 			pcpu = &per_cpu(cpuinfo, j);
 			down_write(&pcpu->enable_sem);
@@ -16,6 +16,7 @@
 #include <linux/cpu.h>
 #include <linux/cpumask.h>
 #include <linux/cpufreq.h>
+#include <linux/exynos-cpufreq.h>
 #include <linux/exynos-ss.h>
 #include <linux/pm_opp.h>
 
@@ -267,6 +268,181 @@ static int update_freq(struct exynos_cpufreq_domain *domain,
 	return ret;
 }
 
+/*********************************************************************
+ *                     ASYNCHRONOUS FREQUENCY UPDATE                 *
+ *********************************************************************/
+static LIST_HEAD(async_reqs);
+static DEFINE_SPINLOCK(async_lock);
+
+static void complete_async_reqs(struct list_head *reqs,
+				struct exynos_cpufreq_domain *domain, int err)
+{
+	struct exynos_cpufreq_req *req, *tmp;
+
+	list_for_each_entry_safe(req, tmp, reqs, list) {
+		if (domain && !cpumask_test_cpu(req->cpu, &domain->cpus))
+			continue;
+
+		list_del(&req->list);
+		if (req->done)
+			req->done(req, err);
+	}
+}
+
+/* The last frequency requested for @domain, if it has pending requests */
+static bool async_target(struct list_head *reqs,
+			 struct exynos_cpufreq_domain *domain,
+			 unsigned int *target)
+{
+	struct exynos_cpufreq_req *req;
+	bool pending = false;
+
+	list_for_each_entry(req, reqs, list) {
+		if (cpumask_test_cpu(req->cpu, &domain->cpus)) {
+			*target = req->freq;
+			pending = true;
+		}
+	}
+
+	return pending;
+}
+
+/*
+ * Resolve the last requested frequency of every domain with pending
+ * requests, then scale all of them with one batched CAL request while
+ * holding the domain locks in domain list order. Domains with DVFS
+ * Manager constraints are scaled one by one after the batch is done and
+ * its locks are released, since their constraints chain into other
+ * domains and update_freq() takes those domain locks again.
+ */
+static void exynos_cpufreq_async_work(struct work_struct *work)
+{
+	struct exynos_cpufreq_domain *domain, *batch[CAL_DFS_BATCH_MAX];
+	struct cpufreq_policy *policy[CAL_DFS_BATCH_MAX];
+	struct cpufreq_freqs freqs[CAL_DFS_BATCH_MAX];
+	unsigned int id[CAL_DFS_BATCH_MAX];
+	unsigned long rate[CAL_DFS_BATCH_MAX];
+	unsigned int target;
+	LIST_HEAD(reqs);
+	int i, count = 0, ret;
+
+	spin_lock_irq(&async_lock);
+	list_splice_init(&async_reqs, &reqs);
+	spin_unlock_irq(&async_lock);
+
+	list_for_each_entry(domain, &domains, list) {
+		struct cpufreq_policy *p;
+		unsigned int index;
+
+		/* scaled one by one below */
+		if (!list_empty(&domain->dm_list) || count == CAL_DFS_BATCH_MAX)
+			continue;
+
+		if (!async_target(&reqs, domain, &target))
+			continue;
+
+		p = cpufreq_cpu_get(cpumask_first(&domain->cpus));
+		if (!p) {
+			complete_async_reqs(&reqs, domain, -ENODEV);
+			continue;
+		}
+
+		mutex_lock(&domain->lock);
+
+		ret = 0;
+		if (!domain->enabled || static_governor(p))
+			goto skip;
+
+		target = clamp(target, p->min, p->max);
+		target = apply_pm_qos(domain, p, target);
+		ret = cpufreq_frequency_table_target(p, domain->freq_table,
+					target, CPUFREQ_RELATION_L, &index);
+		if (ret)
+			goto skip;
+
+		target = index_to_freq(domain->freq_table, index);
+		if (domain->old == target)
+			goto skip;
+
+		batch[count] = domain;
+		policy[count] = p;
+		id[count] = domain->cal_id;
+		rate[count] = target;
+		count++;
+		continue;
+
+skip:
+		mutex_unlock(&domain->lock);
+		cpufreq_cpu_put(p);
+		complete_async_reqs(&reqs, domain, ret);
+	}
+
+	if (!count)
+		goto unbatched;
+
+	for (i = 0; i < count; i++) {
+		freqs[i].cpu = policy[i]->cpu;
+		freqs[i].old = batch[i]->old;
+		freqs[i].new = rate[i];
+		freqs[i].flags = 0;
+
+		cpufreq_freq_transition_begin(policy[i], &freqs[i]);
+		exynos_ss_freq(batch[i]->id, batch[i]->old, rate[i], ESS_FLAG_IN);
+	}
+
+	ret = pre_scale();
+	if (!ret)
+		ret = cal_dfs_set_rate_batch(id, rate, count);
+	if (!ret)
+		ret = post_scale();
+	if (ret)
+		pr_err("failed to scale %d domains in a batch (%d)\n",
+							count, ret);
+
+	for (i = 0; i < count; i++) {
+		domain = batch[i];
+
+		exynos_ss_freq(domain->id, domain->old, rate[i],
+					ret < 0 ? ret : ESS_FLAG_OUT);
+		cpufreq_freq_transition_end(policy[i], &freqs[i], ret);
+		if (!ret)
+			domain->old = rate[i];
+
+		mutex_unlock(&domain->lock);
+		cpufreq_cpu_put(policy[i]);
+		complete_async_reqs(&reqs, domain, ret);
+	}
+
+unbatched:
+	/* no domain lock is held anymore */
+	list_for_each_entry(domain, &domains, list) {
+		if (async_target(&reqs, domain, &target))
+			complete_async_reqs(&reqs, domain,
+					update_freq(domain, target));
+	}
+
+	/* Requests whose domain went away meanwhile */
+	complete_async_reqs(&reqs, NULL, -ENODEV);
+}
+
+static DECLARE_WORK(async_work, exynos_cpufreq_async_work);
+
+int exynos_cpufreq_target_async(struct exynos_cpufreq_req *req)
+{
+	unsigned long flags;
+
+	if (!find_domain(req->cpu))
+		return -EINVAL;
+
+	spin_lock_irqsave(&async_lock, flags);
+	list_add_tail(&req->list, &async_reqs);
+	spin_unlock_irqrestore(&async_lock, flags);
+
+	schedule_work(&async_work);
+
+	return 0;
+}
+
 /*********************************************************************
  *                   EXYNOS CPUFREQ DRIVER INTERFACE                 *
  *********************************************************************/
@@ -286,6 +462,7 @@ static int exynos_cpufreq_driver_init(struct cpufreq_policy *policy)
 
 	policy->cur = get_freq(domain);
 	policy->cpuinfo.transition_latency = TRANSITION_LATENCY;
+	policy->fast_switch_possible = domain->fast_switch;
 	cpumask_copy(policy->cpus, &domain->cpus);
 
 	pr_info("CPUFREQ domain%d registered\n", domain->id);
@@ -319,7 +496,11 @@ static int __exynos_cpufreq_target(struct cpufreq_policy *policy,
 	if (!domain->enabled)
 		goto out;
 
-	if (domain->old != get_freq(domain)) {
+	/*
+	 * A fast switch only posts the request to ACPM, CAL may still
+	 * report the previous rate while it is being applied.
+	 */
+	if (!policy->fast_switch_enabled && domain->old != get_freq(domain)) {
 		pr_err("oops, inconsistency between domain->old:%d, real clk:%d\n",
 			domain->old, get_freq(domain));
 		BUG_ON(1);
@@ -375,6 +556,41 @@ static int exynos_cpufreq_target(struct cpufreq_policy *policy,
 	return DM_CALL(domain->dm_type, &freq);
 }
 
+static unsigned int exynos_cpufreq_fast_switch(struct cpufreq_policy *policy,
+					unsigned int target_freq)
+{
+	struct exynos_cpufreq_domain *domain = find_domain(policy->cpu);
+	unsigned int index;
+	int ret;
+
+	if (!domain || !domain->enabled)
+		return 0;
+
+	/* A PM QoS or suspend update owns the domain, let it finish */
+	if (mutex_is_locked(&domain->lock))
+		return 0;
+
+	target_freq = apply_pm_qos(domain, policy, target_freq);
+	if (cpufreq_frequency_table_target(policy, domain->freq_table,
+				target_freq, CPUFREQ_RELATION_L, &index))
+		return 0;
+
+	target_freq = index_to_freq(domain->freq_table, index);
+	if (domain->old == target_freq)
+		return 0;
+
+	exynos_ss_freq(domain->id, domain->old, target_freq, ESS_FLAG_IN);
+	ret = cal_dfs_set_rate_async(domain->cal_id, target_freq);
+	exynos_ss_freq(domain->id, domain->old, target_freq,
+					ret < 0 ? ret : ESS_FLAG_OUT);
+	if (ret)
+		return 0;
+
+	domain->old = target_freq;
+
+	return target_freq;
+}
+
 static unsigned int exynos_cpufreq_get(unsigned int cpu)
 {
 	struct exynos_cpufreq_domain *domain = find_domain(cpu);
@@ -437,6 +653,7 @@ static struct cpufreq_driver exynos_driver = {
 	.init		= exynos_cpufreq_driver_init,
 	.verify		= exynos_cpufreq_verify,
 	.target		= exynos_cpufreq_target,
+	.fast_switch	= exynos_cpufreq_fast_switch,
 	.get		= exynos_cpufreq_get,
 	.suspend	= exynos_cpufreq_suspend,
 	.resume		= exynos_cpufreq_resume,
@@ -1280,6 +1497,14 @@ init_table:
 	 */
 	init_dm(domain, dn);
 
+	/*
+	 * Fast switching posts the request to ACPM straight from the
+	 * scheduler, which cannot go through the DVFS Manager constraints.
+	 */
+	if (of_property_read_bool(dn, "fast-switch") &&
+				list_empty(&domain->dm_list))
+		domain->fast_switch = true;
+
 	pr_info("Complete to initialize cpufreq-domain%d\n", domain->id);
 
 	return ret;
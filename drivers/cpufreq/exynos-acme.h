@@ -37,6 +37,7 @@ struct exynos_cpufreq_domain {
 
 	/* frequency scaling */
 	bool				enabled;
+	bool				fast_switch;
 
 	unsigned int			table_size;
 	struct cpufreq_frequency_table	*freq_table;
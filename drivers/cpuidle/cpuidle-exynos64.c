@@ -120,6 +120,8 @@ static void post_idle(unsigned int cpu, int index, int fail)
 
 	exynos_cpu_pm_exit(cpu, fail);
 	cpu_pm_exit();
+
+	cpuidle_profile_exit_done(cpu);
 }
 
 static int enter_idle(unsigned int index)
@@ -0,0 +1,234 @@
+/*
+ * exynos.c - the exynos idle governor
+ *
+ * Copyright (c) 2017 Samsung Electronics Co., Ltd.
+ *		http://www.samsung.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * The governor keeps, per cpu, the history of what woke the cpu up from
+ * idle: the expected timer, an IPI or a device interrupt. When the recent
+ * non-timer wakeups are regular enough, their typical interval predicts
+ * the next idle length better than the next timer alone. The prediction
+ * selects the C state, and is also handed to exynos-powermode which uses
+ * it to decide on CPD and SICD for the cluster.
+ */
+
+#include <linux/kernel.h>
+#include <linux/cpuidle.h>
+#include <linux/pm_qos.h>
+#include <linux/ktime.h>
+#include <linux/tick.h>
+#include <linux/hardirq.h>
+#include <linux/module.h>
+
+#include <soc/samsung/exynos-powermode.h>
+
+#define HISTORY_SHIFT		3
+#define HISTORY_SIZE		(1 << HISTORY_SHIFT)
+/* Waking up this close to the next timer is counted as a timer wakeup */
+#define TIMER_SLACK_US		50
+
+enum wake_source {
+	WAKE_TIMER,
+	WAKE_IPI,
+	WAKE_IRQ,
+};
+
+struct exynos_gov_device {
+	int		last_state_idx;
+	int		needs_update;
+
+	unsigned int	next_timer_us;
+	unsigned int	predicted_us;
+	u64		ipi_count;
+
+	unsigned int	history[HISTORY_SIZE];
+	u8		source[HISTORY_SIZE];
+	int		history_ptr;
+};
+
+static DEFINE_PER_CPU(struct exynos_gov_device, exynos_gov_devices);
+
+static u64 ipi_count(unsigned int cpu)
+{
+	u64 sum = 0;
+	int i;
+
+	for (i = 0; i < NR_IPI; i++)
+		sum += __get_irq_stat(cpu, ipi_irqs[i]);
+
+	return sum;
+}
+
+/*
+ * Take the mean of the idle lengths that ended by an IPI or a device
+ * interrupt. It is trusted only if most of the history was such wakeups
+ * and they spread less than a quarter of the mean, otherwise the next
+ * timer is the best guess.
+ */
+static unsigned int exynos_gov_predict(struct exynos_gov_device *data)
+{
+	u64 sum = 0, sq_sum = 0, avg, variance;
+	unsigned int count = 0;
+	int i;
+
+	for (i = 0; i < HISTORY_SIZE; i++) {
+		if (data->source[i] == WAKE_TIMER)
+			continue;
+
+		sum += data->history[i];
+		sq_sum += (u64)data->history[i] * data->history[i];
+		count++;
+	}
+
+	if (count <= HISTORY_SIZE / 2)
+		return data->next_timer_us;
+
+	avg = div_u64(sum, count);
+	variance = div_u64(sq_sum, count) - avg * avg;
+
+	if (variance * 16 > avg * avg)
+		return data->next_timer_us;
+
+	return min_t(unsigned int, avg, data->next_timer_us);
+}
+
+/**
+ * exynos_gov_update - records the wakeup of the last idle period
+ * @drv: cpuidle driver containing state data
+ * @dev: the CPU
+ */
+static void exynos_gov_update(struct cpuidle_driver *drv,
+				struct cpuidle_device *dev)
+{
+	struct exynos_gov_device *data = this_cpu_ptr(&exynos_gov_devices);
+	struct cpuidle_state *target = &drv->states[data->last_state_idx];
+	unsigned int measured_us = cpuidle_get_last_residency(dev);
+	u8 source;
+
+	/* The wakeup began before the exit latency was paid */
+	if (measured_us > target->exit_latency)
+		measured_us -= target->exit_latency;
+
+	if (measured_us + TIMER_SLACK_US >= data->next_timer_us) {
+		source = WAKE_TIMER;
+		measured_us = data->next_timer_us;
+	} else if (ipi_count(dev->cpu) != data->ipi_count) {
+		source = WAKE_IPI;
+	} else {
+		source = WAKE_IRQ;
+	}
+
+	data->history[data->history_ptr] = measured_us;
+	data->source[data->history_ptr] = source;
+	data->history_ptr = (data->history_ptr + 1) & (HISTORY_SIZE - 1);
+}
+
+/**
+ * exynos_gov_select - selects the next idle state to enter
+ * @drv: cpuidle driver containing state data
+ * @dev: the CPU
+ */
+static int exynos_gov_select(struct cpuidle_driver *drv,
+				struct cpuidle_device *dev)
+{
+	struct exynos_gov_device *data = this_cpu_ptr(&exynos_gov_devices);
+	int latency_req = pm_qos_request(PM_QOS_CPU_DMA_LATENCY);
+	int i;
+
+	if (data->needs_update) {
+		exynos_gov_update(drv, dev);
+		data->needs_update = 0;
+	}
+
+	data->last_state_idx = 0;
+
+	/* Special case when user has set very strict latency requirement */
+	if (unlikely(latency_req == 0))
+		return 0;
+
+	data->next_timer_us = ktime_to_us(tick_nohz_get_sleep_length());
+	data->ipi_count = ipi_count(dev->cpu);
+	data->predicted_us = exynos_gov_predict(data);
+
+	for (i = 1; i < drv->state_count; i++) {
+		struct cpuidle_state *s = &drv->states[i];
+		struct cpuidle_state_usage *su = &dev->states_usage[i];
+
+		if (s->disabled || su->disable)
+			continue;
+		if (s->target_residency > data->predicted_us)
+			continue;
+		if (s->exit_latency > latency_req)
+			continue;
+
+		data->last_state_idx = i;
+	}
+
+	if (data->last_state_idx)
+		exynos_cpu_idle_predict(dev->cpu, data->predicted_us);
+
+	return data->last_state_idx;
+}
+
+/**
+ * exynos_gov_reflect - records that data structures need update
+ * @dev: the CPU
+ * @index: the index of actual entered state
+ */
+static void exynos_gov_reflect(struct cpuidle_device *dev, int index)
+{
+	struct exynos_gov_device *data = this_cpu_ptr(&exynos_gov_devices);
+
+	data->last_state_idx = index;
+	data->needs_update = 1;
+}
+
+/**
+ * exynos_gov_enable_device - clears the history of a CPU
+ * @drv: cpuidle driver
+ * @dev: the CPU
+ */
+static int exynos_gov_enable_device(struct cpuidle_driver *drv,
+				struct cpuidle_device *dev)
+{
+	struct exynos_gov_device *data = &per_cpu(exynos_gov_devices, dev->cpu);
+
+	memset(data, 0, sizeof(struct exynos_gov_device));
+
+	return 0;
+}
+
+/**
+ * exynos_gov_disable_device - drops the prediction of a CPU
+ * @drv: cpuidle driver
+ * @dev: the CPU
+ */
+static void exynos_gov_disable_device(struct cpuidle_driver *drv,
+				struct cpuidle_device *dev)
+{
+	exynos_cpu_idle_predict(dev->cpu, 0);
+}
+
+static struct cpuidle_governor exynos_governor = {
+	.name =		"exynos",
+	.rating =	25,
+	.enable =	exynos_gov_enable_device,
+	.disable =	exynos_gov_disable_device,
+	.select =	exynos_gov_select,
+	.reflect =	exynos_gov_reflect,
+	.owner =	THIS_MODULE,
+};
+
+/**
+ * init_exynos_gov - initializes the governor
+ */
+static int __init init_exynos_gov(void)
+{
+	return cpuidle_register_governor(&exynos_governor);
+}
+
+postcore_initcall(init_exynos_gov);
@@ -15,6 +15,8 @@
 #include <linux/err.h>
 #include <linux/fs.h>
 
+#include "fmp_derive_iv.h"
+
 #define FMP_MAX_IV_BYTES		16
 #define FMP_MAX_OFFSET_BYTES		16
 #define DEFAULT_HASH			"md5"
@@ -146,3 +148,53 @@ out:
 	return ret;
 }
 
+
+/*
+ * Derive the IVs of nr consecutive pages from offset, iv_size bytes each,
+ * holding the tfm lock once for the whole run.
+ */
+int file_enc_derive_ivs(struct address_space *mapping, loff_t offset, int nr,
+			char *ivs, int iv_size)
+{
+	char src[FMP_MAX_IV_BYTES + FMP_MAX_OFFSET_BYTES];
+	char digest[SHA256_HASH_SIZE];
+	struct scatterlist sg;
+	struct hash_desc desc = {
+		.tfm = mapping->hash_tfm,
+		.flags = 0
+	};
+	unsigned long flag;
+	int ret = 0;
+	int i;
+
+	/* without a tfm of the file, each IV allocates its own */
+	if (!desc.tfm) {
+		for (i = 0; i < nr; i++) {
+			ret = file_enc_derive_iv(mapping, offset + i, digest);
+			if (ret)
+				return ret;
+			memcpy(ivs + i * iv_size, digest, iv_size);
+		}
+		return 0;
+	}
+
+	spin_lock_irqsave(&fmp_tfm_lock, flag);
+	for (i = 0; i < nr; i++) {
+		memcpy(src, mapping->iv, FMP_MAX_IV_BYTES);
+		memset(src + FMP_MAX_IV_BYTES, 0, FMP_MAX_OFFSET_BYTES);
+		snprintf(src + FMP_MAX_IV_BYTES, FMP_MAX_OFFSET_BYTES, "%lld",
+			 offset + i);
+		sg_init_one(&sg, (u8 *)src, sizeof(src));
+
+		ret = crypto_hash_digest(&desc, &sg, sizeof(src), digest);
+		if (ret) {
+			printk(KERN_ERR "%s: Error computing IV; ret = [%d]\n",
+			       __func__, ret);
+			break;
+		}
+		memcpy(ivs + i * iv_size, digest, iv_size);
+	}
+	spin_unlock_irqrestore(&fmp_tfm_lock, flag);
+
+	return ret;
+}
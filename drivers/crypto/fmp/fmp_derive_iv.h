@@ -18,5 +18,7 @@
 int calculate_sha256(struct crypto_hash *hash_tfm, char *dst, char *src, int len);
 int calculate_md5(struct crypto_hash *hash_tfm, char *dst, char *src, int len);
 int file_enc_derive_iv(struct address_space *mapping, loff_t offset, char *extent_iv);
+int file_enc_derive_ivs(struct address_space *mapping, loff_t offset, int nr,
+			char *ivs, int iv_size);
 
 #endif
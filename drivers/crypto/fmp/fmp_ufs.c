@@ -164,17 +164,56 @@ static int configure_fmp_file_key_length(struct ufshcd_sg_entry *prd_table,
 	return 0;
 }
 
+/*
+ * IV of a CBC page, from the cache when an earlier entry of the request
+ * derived it. Otherwise derive it along with the following entries that
+ * are the next pages of the same file.
+ */
+static int fmp_get_file_iv(struct fmp_ufs_cache *cache,
+				struct scatterlist *sg, loff_t index, char **iv)
+{
+	struct page *page = sg_page(sg);
+	struct address_space *mapping = page->mapping;
+	struct scatterlist *next;
+	int nr, ret;
+
+	if (cache->mapping == mapping && index >= cache->iv_index &&
+	    index < cache->iv_index + cache->nr_ivs) {
+		*iv = cache->ivs[index - cache->iv_index];
+		return 0;
+	}
+
+	for (nr = 1, next = sg_next(sg); next && nr < FMP_IV_BATCH;
+	     next = sg_next(next), nr++) {
+		struct page *next_page = sg_page(next);
+
+		if (next_page->mapping != mapping ||
+		    next_page->index != page->index + nr)
+			break;
+	}
+
+	ret = file_enc_derive_ivs(mapping, index, nr, cache->ivs[0], FMP_IV_SIZE);
+	if (ret) {
+		cache->mapping = NULL;
+		return ret;
+	}
+
+	cache->mapping = mapping;
+	cache->iv_index = index;
+	cache->nr_ivs = nr;
+	*iv = cache->ivs[0];
+
+	return 0;
+}
+
 static int configure_fmp_file_iv(struct ufshcd_sg_entry *prd_table,
 				int algo_mode, struct scatterlist *sg,
-				uint32_t idx, uint32_t sector)
+				uint32_t idx, uint32_t sector,
+				struct fmp_ufs_cache *cache)
 {
 	int ret;
 	struct page *page = sg_page(sg);
-#ifdef CONFIG_CRYPTO_FIPS
-	char extent_iv[SHA256_HASH_SIZE];
-#else
-	char extent_iv[MD5_DIGEST_SIZE];
-#endif
+	char *extent_iv;
 	loff_t index;
 
 	switch (algo_mode) {
@@ -187,7 +226,7 @@ static int configure_fmp_file_iv(struct ufshcd_sg_entry *prd_table,
 	case FMP_CBC_ALGO_MODE:
 		index = page->index;
 		index = index - page->mapping->sensitive_data_index;
-		ret = file_enc_derive_iv(page->mapping, index, extent_iv);
+		ret = fmp_get_file_iv(cache, sg, index, &extent_iv);
 		if (ret) {
 			printk(KERN_ERR "Error attemping to derive IV. ret = %c\n", ret);
 			return -EINVAL;
@@ -208,23 +247,35 @@ static int configure_fmp_file_iv(struct ufshcd_sg_entry *prd_table,
 
 static void configure_fmp_file_key(struct ufshcd_sg_entry *prd_table,
 				uint32_t idx, unsigned char *key,
-				unsigned long key_length)
+				unsigned long key_length,
+				struct fmp_ufs_cache *cache)
 {
 	int i;
 
+	/* Same key as an earlier entry of this request */
+	if (cache->key && cache->key == key && cache->key_length == key_length) {
+		memcpy(&prd_table[idx].file_enckey0,
+			&prd_table[cache->key_idx].file_enckey0, key_length);
+		return;
+	}
+
 	/* File Enc key */
 	for (i = 0; i < key_length >> 2; i++) {
 		*(&prd_table[idx].file_enckey0 + i) =
 			word_in(key, (key_length >> 2) - (i + 1));
 	}
 
+	cache->key = key;
+	cache->key_length = key_length;
+	cache->key_idx = idx;
+
 	return;
 }
 
 static int configure_fmp_file_enc(struct ufshcd_sg_entry *prd_table,
 				uint32_t enc_mode, uint32_t idx,
 				uint32_t sector, struct scatterlist *sg,
-				uint32_t size)
+				uint32_t size, struct fmp_ufs_cache *cache)
 {
 	int ret, algo_mode;
 	struct page *page = sg_page(sg);
@@ -247,13 +298,14 @@ static int configure_fmp_file_enc(struct ufshcd_sg_entry *prd_table,
 		return ret;
 	}
 
-	ret = configure_fmp_file_iv(prd_table, algo_mode, sg, idx, sector);
+	ret = configure_fmp_file_iv(prd_table, algo_mode, sg, idx, sector, cache);
 	if (ret) {
 		printk(KERN_ERR "Fail to configure key length(%d)\n", ret);
 		return ret;
 	}
 
-	configure_fmp_file_key(prd_table, idx, page->mapping->key, page->mapping->key_length);
+	configure_fmp_file_key(prd_table, idx, page->mapping->key,
+				page->mapping->key_length, cache);
 
 #if defined(CONFIG_FIPS_FMP)
 	if (algo_mode == AES_XTS) {
@@ -272,7 +324,8 @@ static int configure_fmp_file_enc(struct ufshcd_sg_entry *prd_table,
 static int configure_fmp_file_enc_direct_io(struct ufshcd_sg_entry *prd_table,
 				uint32_t enc_mode, uint32_t idx,
 				uint32_t sector, struct bio *bio,
-				struct scatterlist *sg, uint32_t size)
+				struct scatterlist *sg, uint32_t size,
+				struct fmp_ufs_cache *cache)
 {
 	int ret, algo_mode;
 
@@ -290,13 +343,13 @@ static int configure_fmp_file_enc_direct_io(struct ufshcd_sg_entry *prd_table,
 		return ret;
 	}
 
-	ret = configure_fmp_file_iv(prd_table, algo_mode, sg, idx, sector);
+	ret = configure_fmp_file_iv(prd_table, algo_mode, sg, idx, sector, cache);
 	if (ret) {
 		printk(KERN_ERR "Fail to configure key length(%d)\n", ret);
 		return ret;
 	}
 
-	configure_fmp_file_key(prd_table, idx, bio->key, bio->key_length);
+	configure_fmp_file_key(prd_table, idx, bio->key, bio->key_length, cache);
 
 #if defined(CONFIG_FIPS_FMP)
 	if (algo_mode == FMP_XTS_ALGO_MODE) {
@@ -314,7 +367,8 @@ static int configure_fmp_file_enc_direct_io(struct ufshcd_sg_entry *prd_table,
 
 int fmp_ufs_map_sg(struct ufshcd_sg_entry *prd_table, struct scatterlist *sg,
 					uint32_t enc_mode, uint32_t idx,
-					uint32_t sector, struct bio *bio)
+					uint32_t sector, struct bio *bio,
+					struct fmp_ufs_cache *cache)
 {
 	int ret;
 	uint32_t size;
@@ -337,7 +391,7 @@ int fmp_ufs_map_sg(struct ufshcd_sg_entry *prd_table, struct scatterlist *sg,
 
 	if (bio->private_enc_mode == FMP_FILE_ENC_MODE) {
 		ret = configure_fmp_file_enc_direct_io(prd_table, enc_mode,
-						idx, sector, bio, sg, size);
+						idx, sector, bio, sg, size, cache);
 		if (ret) {
 			printk(KERN_ERR "Fail to confgure fmp file enc mode\n");
 			return ret;
@@ -346,7 +400,7 @@ int fmp_ufs_map_sg(struct ufshcd_sg_entry *prd_table, struct scatterlist *sg,
 	}
 
 	ret = configure_fmp_file_enc(prd_table, enc_mode, idx, sector,
-							sg, size);
+							sg, size, cache);
 	if (ret) {
 		printk(KERN_ERR "Fail to confgure fmp file enc mode\n");
 		return ret;
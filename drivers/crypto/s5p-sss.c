@@ -30,6 +30,14 @@
 #include <crypto/aes.h>
 #include <crypto/ctr.h>
 
+/*
+ * Below this size the DMA mapping, interrupt and tasklet round trip cost
+ * more than running the request on the CPU cipher.
+ */
+static unsigned int fallback_bytes = 512;
+module_param(fallback_bytes, uint, 0644);
+MODULE_PARM_DESC(fallback_bytes, "Requests up to this size use the CPU cipher");
+
 #define _SBF(s, v)                      ((v) << (s))
 #define _BIT(b)                         _SBF(b, 1)
 
@@ -167,6 +175,7 @@ struct s5p_aes_reqctx {
 
 struct s5p_aes_ctx {
 	struct s5p_aes_dev         *dev;
+	struct crypto_blkcipher    *fallback;
 
 	uint8_t                     aes_key[AES_MAX_KEY_SIZE];
 	uint8_t                     nonce[CTR_RFC3686_NONCE_SIZE];
@@ -527,6 +536,20 @@ static int s5p_aes_crypt(struct ablkcipher_request *req, unsigned long mode)
 		return -EINVAL;
 	}
 
+	if (ctx->fallback && req->nbytes <= fallback_bytes) {
+		struct blkcipher_desc desc = {
+			.tfm	= ctx->fallback,
+			.info	= req->info,
+			.flags	= req->base.flags,
+		};
+
+		if (mode & FLAGS_AES_DECRYPT)
+			return crypto_blkcipher_decrypt_iv(&desc, req->dst,
+							   req->src, req->nbytes);
+		return crypto_blkcipher_encrypt_iv(&desc, req->dst, req->src,
+						   req->nbytes);
+	}
+
 	reqctx->mode = mode;
 
 	return s5p_aes_handle_req(dev, req);
@@ -546,6 +569,14 @@ static int s5p_aes_setkey(struct crypto_ablkcipher *cipher,
 	memcpy(ctx->aes_key, key, keylen);
 	ctx->keylen = keylen;
 
+	if (ctx->fallback) {
+		crypto_blkcipher_clear_flags(ctx->fallback, CRYPTO_TFM_REQ_MASK);
+		crypto_blkcipher_set_flags(ctx->fallback,
+				crypto_ablkcipher_get_flags(cipher) &
+				CRYPTO_TFM_REQ_MASK);
+		return crypto_blkcipher_setkey(ctx->fallback, key, keylen);
+	}
+
 	return 0;
 }
 
@@ -576,9 +607,27 @@ static int s5p_aes_cra_init(struct crypto_tfm *tfm)
 	ctx->dev = s5p_dev;
 	tfm->crt_ablkcipher.reqsize = sizeof(struct s5p_aes_reqctx);
 
+	/* optional, the hardware still takes every request without it */
+	ctx->fallback = crypto_alloc_blkcipher(crypto_tfm_alg_name(tfm), 0,
+			CRYPTO_ALG_ASYNC | CRYPTO_ALG_NEED_FALLBACK);
+	if (IS_ERR(ctx->fallback)) {
+		dev_warn(s5p_dev->dev, "no fallback for %s\n",
+			 crypto_tfm_alg_name(tfm));
+		ctx->fallback = NULL;
+	}
+
 	return 0;
 }
 
+static void s5p_aes_cra_exit(struct crypto_tfm *tfm)
+{
+	struct s5p_aes_ctx  *ctx = crypto_tfm_ctx(tfm);
+
+	if (ctx->fallback)
+		crypto_free_blkcipher(ctx->fallback);
+	ctx->fallback = NULL;
+}
+
 static struct crypto_alg algs[] = {
 	{
 		.cra_name		= "ecb(aes)",
@@ -586,6 +635,7 @@ static struct crypto_alg algs[] = {
 		.cra_priority		= 100,
 		.cra_flags		= CRYPTO_ALG_TYPE_ABLKCIPHER |
 					  CRYPTO_ALG_ASYNC |
+					  CRYPTO_ALG_NEED_FALLBACK |
 					  CRYPTO_ALG_KERN_DRIVER_ONLY,
 		.cra_blocksize		= AES_BLOCK_SIZE,
 		.cra_ctxsize		= sizeof(struct s5p_aes_ctx),
@@ -593,6 +643,7 @@ static struct crypto_alg algs[] = {
 		.cra_type		= &crypto_ablkcipher_type,
 		.cra_module		= THIS_MODULE,
 		.cra_init		= s5p_aes_cra_init,
+		.cra_exit		= s5p_aes_cra_exit,
 		.cra_u.ablkcipher = {
 			.min_keysize	= AES_MIN_KEY_SIZE,
 			.max_keysize	= AES_MAX_KEY_SIZE,
@@ -607,6 +658,7 @@ static struct crypto_alg algs[] = {
 		.cra_priority		= 100,
 		.cra_flags		= CRYPTO_ALG_TYPE_ABLKCIPHER |
 					  CRYPTO_ALG_ASYNC |
+					  CRYPTO_ALG_NEED_FALLBACK |
 					  CRYPTO_ALG_KERN_DRIVER_ONLY,
 		.cra_blocksize		= AES_BLOCK_SIZE,
 		.cra_ctxsize		= sizeof(struct s5p_aes_ctx),
@@ -614,6 +666,7 @@ static struct crypto_alg algs[] = {
 		.cra_type		= &crypto_ablkcipher_type,
 		.cra_module		= THIS_MODULE,
 		.cra_init		= s5p_aes_cra_init,
+		.cra_exit		= s5p_aes_cra_exit,
 		.cra_u.ablkcipher = {
 			.min_keysize	= AES_MIN_KEY_SIZE,
 			.max_keysize	= AES_MAX_KEY_SIZE,
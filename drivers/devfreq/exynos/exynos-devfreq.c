@@ -32,6 +32,7 @@
 #include <soc/samsung/tmu.h>
 #include <soc/samsung/ect_parser.h>
 #include <soc/samsung/exynos-dm.h>
+#include <soc/samsung/bts.h>
 #include "../../soc/samsung/acpm/acpm.h"
 #include "../../soc/samsung/acpm/acpm_ipc.h"
 
@@ -831,6 +832,7 @@ static int exynos_devfreq_parse_dt(struct device_node *np, struct exynos_devfreq
 #endif
 	const char *buf;
 	const char *use_delay_time;
+	const char *bw_plan;
 	int ntokens;
 	int not_using_ect = true;
 
@@ -970,6 +972,19 @@ static int exynos_devfreq_parse_dt(struct device_node *np, struct exynos_devfreq
 			return -EINVAL;
 		}
 
+		/* optional: follow the bandwidth planned by BTS */
+		data->simple_interactive_data.bw_plan = BTS_PLAN_NONE;
+		if (!of_property_read_string(np, "bw_plan", &bw_plan)) {
+			if (!strcmp(bw_plan, "mif")) {
+				data->simple_interactive_data.bw_plan = BTS_PLAN_MIF;
+			} else if (!strcmp(bw_plan, "int")) {
+				data->simple_interactive_data.bw_plan = BTS_PLAN_INT;
+			} else {
+				dev_err(data->dev, "invalid bw_plan : (%s)\n", bw_plan);
+				return -EINVAL;
+			}
+		}
+
 		if (data->simple_interactive_data.use_delay_time) {
 			if (of_property_read_string(np, "delay_time_list", &buf)) {
 				/*
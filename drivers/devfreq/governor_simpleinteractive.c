@@ -20,6 +20,8 @@
 #include <linux/kthread.h>
 #include <linux/pm_opp.h>
 
+#include <soc/samsung/bts.h>
+
 #include "governor.h"
 
 static int devfreq_simple_interactive_notifier(struct notifier_block *nb, unsigned long val,
@@ -36,6 +38,22 @@ static int devfreq_simple_interactive_notifier(struct notifier_block *nb, unsign
 	return NOTIFY_OK;
 }
 
+/*
+ * An IP announced the bandwidth of its next configuration. Reevaluate now
+ * so the bus is already fast enough when the configuration is applied.
+ */
+static int devfreq_simple_interactive_plan_notifier(struct notifier_block *nb,
+						unsigned long val, void *v)
+{
+	struct devfreq_simple_interactive_data *data;
+
+	data = container_of(nb, struct devfreq_simple_interactive_data, plan_nb);
+
+	wake_up_process(data->change_freq_task);
+
+	return NOTIFY_OK;
+}
+
 #ifdef CONFIG_EXYNOS_WD_DVFS
 #define NEXTBUF(x, b)	if (++(x) > &(b)[SIMPLE_LOAD_MAX - 1]) (x) = (b)
 #define POSTBUF(x, b)	((x) = ((--(x) < (b)) ?				\
@@ -189,6 +207,10 @@ static int devfreq_simple_interactive_func(struct devfreq *df,
 		*freq = max(*freq, update_load(stat, data));
 	}
 #endif
+	/* bandwidth planned by BTS leads the measured load */
+	if (data->bw_plan != BTS_PLAN_NONE)
+		*freq = max(*freq, (unsigned long)bts_plan_freq(data->bw_plan));
+
 	if (!data->use_delay_time)
 		goto out;
 
@@ -346,6 +368,11 @@ static int devfreq_simple_interactive_register_notifier(struct devfreq *df)
 	kthread_bind(data->change_freq_task, BOUND_CPU_NUM);
 #endif
 
+	if (data->bw_plan != BTS_PLAN_NONE) {
+		data->plan_nb.notifier_call = devfreq_simple_interactive_plan_notifier;
+		bts_plan_register_notifier(&data->plan_nb);
+	}
+
 	return 0;
 
 err2:
@@ -373,6 +400,9 @@ static int devfreq_simple_interactive_unregister_notifier(struct devfreq *df)
 
 	ret = pm_qos_remove_notifier(data->pm_qos_class, &data->nb.nb);
 
+	if (data->bw_plan != BTS_PLAN_NONE)
+		bts_plan_unregister_notifier(&data->plan_nb);
+
 #ifdef CONFIG_EXYNOS_WD_DVFS
 	destroy_timer_on_stack(&data->freq_slack_timer);
 #endif
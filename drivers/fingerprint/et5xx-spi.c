@@ -36,6 +36,7 @@
 #include <linux/miscdevice.h>
 #include <linux/gpio.h>
 #include <linux/of_gpio.h>
+#include <linux/pm_runtime.h>
 #ifdef ENABLE_SENSORS_FPRINT_SECURE
 #include <linux/smc.h>
 #endif
@@ -59,6 +60,29 @@ static unsigned int bufsiz = 1024;
 module_param(bufsiz, uint, 0444);
 MODULE_PARM_DESC(bufsiz, "data bytes in biggest supported SPI message");
 
+#ifndef ENABLE_SENSORS_FPRINT_SECURE
+/*
+ * Start resuming the spi controller as soon as the finger is detected, so
+ * that it is up by the time the first frame is read rather than resumed
+ * synchronously by that read. Dropped after the frame or on interrupt free.
+ */
+void etspi_spi_wake(struct etspi_data *etspi)
+{
+	if (!etspi->spi || atomic_xchg(&etspi->spi_awake, 1))
+		return;
+
+	pm_runtime_get(etspi->spi->master->dev.parent);
+}
+
+void etspi_spi_unwake(struct etspi_data *etspi)
+{
+	if (!etspi->spi || !atomic_xchg(&etspi->spi_awake, 0))
+		return;
+
+	pm_runtime_put(etspi->spi->master->dev.parent);
+}
+#endif
+
 static irqreturn_t etspi_fingerprint_interrupt(int irq, void *dev_id)
 {
 	struct etspi_data *etspi = (struct etspi_data *)dev_id;
@@ -66,6 +90,9 @@ static irqreturn_t etspi_fingerprint_interrupt(int irq, void *dev_id)
 	etspi->int_count++;
 	etspi->finger_on = 1;
 	disable_irq_nosync(gpio_irq);
+#ifndef ENABLE_SENSORS_FPRINT_SECURE
+	etspi_spi_wake(etspi);
+#endif
 	wake_up_interruptible(&interrupt_waitq);
 	wake_lock_timeout(&etspi->fp_signal_lock, 1 * HZ);
 	pr_info("%s FPS triggered.int_count(%d) On(%d)\n", __func__,
@@ -128,6 +155,9 @@ int etspi_Interrupt_Free(struct etspi_data *etspi)
 			free_irq(gpio_irq, etspi);
 			etspi->drdy_irq_flag = DRDY_IRQ_DISABLE;
 		}
+#ifndef ENABLE_SENSORS_FPRINT_SECURE
+		etspi_spi_unwake(etspi);
+#endif
 		etspi->finger_on = 0;
 		etspi->int_count = 0;
 	}
@@ -828,6 +858,11 @@ static int etspi_release(struct inode *inode, struct file *filp)
 
 		kfree(etspi->buf);
 		etspi->buf = NULL;
+#ifndef ENABLE_SENSORS_FPRINT_SECURE
+		kfree(etspi->frame_buf);
+		etspi->frame_buf = NULL;
+		etspi->frame_bufsiz = 0;
+#endif
 
 		/* ... after we unbound from the underlying device? */
 		spin_lock_irq(&etspi->spi_lock);
@@ -916,12 +916,23 @@ int etspi_io_get_frame(struct etspi_data *etspi, u8 *fr, u32 size)
 			xfer.len = xfer.len + (DIVISION_OF_IMAGE - (xfer.len % DIVISION_OF_IMAGE));
 	}
 
-	buf = kzalloc(xfer.len, GFP_KERNEL);
+	/*
+	 * The whole frame goes in one transfer, so the controller can DMA it.
+	 * Keep the buffer between frames instead of allocating per capture.
+	 */
+	if (xfer.len > etspi->frame_bufsiz) {
+		buf = kmalloc(xfer.len, GFP_KERNEL);
+		if (buf == NULL)
+			return -ENOMEM;
 
-	if (buf == NULL)
-		return -ENOMEM;
+		kfree(etspi->frame_buf);
+		etspi->frame_buf = buf;
+		etspi->frame_bufsiz = xfer.len;
+	}
+	buf = etspi->frame_buf;
 
 	xfer.tx_buf = xfer.rx_buf = buf;
+	memset(buf, 0, xfer.len);
 	buf[0] = OP_IMG_R;
 
 	pr_debug("%s size = %d, xfer.len = %d, buf = %p, fr = %p\n", __func__,
@@ -930,18 +941,16 @@ int etspi_io_get_frame(struct etspi_data *etspi, u8 *fr, u32 size)
 	spi_message_init(&m);
 	spi_message_add_tail(&xfer, &m);
 	status = spi_sync(etspi->spi, &m);
+	etspi_spi_unwake(etspi);
 	if (status < 0) {
 		pr_err("%s read data error status = %d\n", __func__, status);
-		goto end;
+		return status;
 	}
 
 	if (copy_to_user((u8 __user *) (uintptr_t) fr, buf + 1, size)) {
 		pr_err("%s buffer copy_to_user fail status\n", __func__);
 		status = -EFAULT;
 	}
-end:
-	if (buf)
-		kfree(buf);
 	return status;
 #endif
 }
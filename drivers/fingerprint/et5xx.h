@@ -222,6 +222,13 @@ struct etspi_data {
 	struct wake_lock fp_spi_lock;
 #endif
 	struct wake_lock fp_signal_lock;
+#ifndef ENABLE_SENSORS_FPRINT_SECURE
+	/* frame buffer kept across captures, sized by the largest frame */
+	u8 *frame_buf;
+	u32 frame_bufsiz;
+	/* spi controller resumed from finger detect, until next frame */
+	atomic_t spi_awake;
+#endif
 	bool tz_mode;
 	int detect_period;
 	int detect_threshold;
@@ -250,5 +257,9 @@ int etspi_io_nvm_off(struct etspi_data *etspi, struct egis_ioc_transfer *ioc);
 int etspi_io_vdm_read(struct etspi_data *etspi, struct egis_ioc_transfer *ioc);
 int etspi_io_vdm_write(struct etspi_data *etspi, struct egis_ioc_transfer *ioc);
 int etspi_io_get_frame(struct etspi_data *etspi, u8 *frame, u32 size);
+#ifndef ENABLE_SENSORS_FPRINT_SECURE
+void etspi_spi_wake(struct etspi_data *etspi);
+void etspi_spi_unwake(struct etspi_data *etspi);
+#endif
 
 #endif
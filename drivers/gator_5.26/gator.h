@@ -17,6 +17,7 @@
 #define GATOR_PERF_PMU_SUPPORT  (defined(CONFIG_PERF_EVENTS) && (!(defined(__arm__) || defined(__aarch64__)) || defined(CONFIG_HW_PERF_EVENTS)))
 #define GATOR_CPU_FREQ_SUPPORT  defined(CONFIG_CPU_FREQ)
 #define GATOR_IKS_SUPPORT       defined(CONFIG_BL_SWITCHER)
+#define GATOR_HEADLESS_SUPPORT  (defined(CONFIG_GATOR_HEADLESS) && GATOR_PERF_PMU_SUPPORT && LINUX_VERSION_CODE >= KERNEL_VERSION(4, 4, 0))
 
 /* cpu ids */
 #define CORTEX_A5    0x41c05
@@ -0,0 +1,480 @@
+/**
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ */
+
+/*
+ * Headless mode: count cycles, instructions, cache and branch misses on
+ * every CPU without gatord, attribute them to tasks at sched_switch and
+ * roll them up per cluster and per task every headless_period_ms into
+ * /proc/gator_headless. Enabled with /sys/module/gator/parameters/headless.
+ */
+
+#if GATOR_HEADLESS_SUPPORT
+
+#include <linux/hash.h>
+#include <linux/proc_fs.h>
+#include <linux/seq_file.h>
+#include <linux/workqueue.h>
+
+enum {
+    HEADLESS_CYCLES,
+    HEADLESS_INSTRUCTIONS,
+    HEADLESS_CACHE_MISSES,
+    HEADLESS_BRANCH_MISSES,
+    HEADLESS_EVENTS,
+};
+
+static const u64 headless_config[HEADLESS_EVENTS] = {
+    [HEADLESS_CYCLES] = PERF_COUNT_HW_CPU_CYCLES,
+    [HEADLESS_INSTRUCTIONS] = PERF_COUNT_HW_INSTRUCTIONS,
+    [HEADLESS_CACHE_MISSES] = PERF_COUNT_HW_CACHE_MISSES,
+    [HEADLESS_BRANCH_MISSES] = PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+/* Tasks tracked per CPU per period, and in the merged summary */
+#define HEADLESS_TASK_BITS 6
+#define HEADLESS_TASKS (1 << HEADLESS_TASK_BITS)
+#define HEADLESS_MERGE_BITS (HEADLESS_TASK_BITS + 2)
+#define HEADLESS_MERGE (1 << HEADLESS_MERGE_BITS)
+#define HEADLESS_PROBES 8
+#define HEADLESS_TOP 16
+
+struct headless_task {
+    pid_t pid;
+    char comm[TASK_COMM_LEN];
+    u64 count[HEADLESS_EVENTS];
+};
+
+struct headless_cpu {
+    raw_spinlock_t lock;
+    struct perf_event *pevent[HEADLESS_EVENTS];
+    u64 prev[HEADLESS_EVENTS];
+    u64 total[HEADLESS_EVENTS];
+    unsigned long dropped;
+    struct headless_task tasks[HEADLESS_TASKS];
+};
+
+static bool headless_enabled;
+static unsigned int headless_period_ms = 1000;
+module_param_named(headless_period_ms, headless_period_ms, uint, 0644);
+
+static struct headless_cpu __percpu *headless_cpus;
+static struct headless_task *headless_merge;
+static DEFINE_MUTEX(headless_mutex);
+static struct delayed_work headless_work;
+
+/* Last rolled-up period, protected by headless_mutex */
+static u64 headless_cluster[GATOR_CLUSTER_COUNT][HEADLESS_EVENTS];
+static struct headless_task headless_top[HEADLESS_TOP];
+static int headless_top_count;
+static unsigned long headless_dropped;
+static unsigned int headless_last_ms;
+
+static struct headless_task *headless_find(struct headless_task *tasks, int bits,
+                                           const struct task_struct *task, pid_t pid, const char *comm)
+{
+    u32 idx = hash_32(pid, bits);
+    int i;
+
+    for (i = 0; i < HEADLESS_PROBES; i++) {
+        struct headless_task *t = &tasks[(idx + i) & ((1 << bits) - 1)];
+
+        if (t->pid == pid)
+            return t;
+        if (t->pid == 0) {
+            t->pid = pid;
+            memcpy(t->comm, task ? task->comm : comm, TASK_COMM_LEN);
+            return t;
+        }
+    }
+
+    return NULL;
+}
+
+static void headless_sched_switch(void *data, bool preempt, struct task_struct *prev, struct task_struct *next)
+{
+    struct headless_cpu *hc = this_cpu_ptr(headless_cpus);
+    struct headless_task *t = NULL;
+    int i;
+
+    raw_spin_lock(&hc->lock);
+    if (hc->pevent[HEADLESS_CYCLES] == NULL)
+        goto out;
+
+    /* The idle task only counts towards its cluster */
+    if (prev->pid)
+        t = headless_find(hc->tasks, HEADLESS_TASK_BITS, prev, prev->pid, NULL);
+    if (prev->pid && t == NULL)
+        hc->dropped++;
+
+    for (i = 0; i < HEADLESS_EVENTS; i++) {
+        u64 val, delta;
+
+        if (hc->pevent[i] == NULL)
+            continue;
+
+        val = perf_event_read_local(hc->pevent[i]);
+        delta = val - hc->prev[i];
+        hc->prev[i] = val;
+        hc->total[i] += delta;
+        if (t)
+            t->count[i] += delta;
+    }
+out:
+    raw_spin_unlock(&hc->lock);
+}
+
+static void headless_overflow_handler(struct perf_event *event, struct perf_sample_data *data, struct pt_regs *regs)
+{
+    /* Required by perf_event_create_kernel_counter(), the counters are only polled */
+}
+
+static void headless_cpu_online(int cpu)
+{
+    struct headless_cpu *hc = per_cpu_ptr(headless_cpus, cpu);
+    struct perf_event *pevent[HEADLESS_EVENTS];
+    unsigned long flags;
+    int i;
+
+    for (i = 0; i < HEADLESS_EVENTS; i++) {
+        struct perf_event_attr attr = {
+            .type = PERF_TYPE_HARDWARE,
+            .config = headless_config[i],
+            .size = sizeof(struct perf_event_attr),
+            .pinned = 1,
+        };
+
+        pevent[i] = perf_event_create_kernel_counter(&attr, cpu, NULL, headless_overflow_handler, NULL);
+        if (IS_ERR(pevent[i])) {
+            pr_err("gator: headless: unable to online counter %d on cpu %d\n", i, cpu);
+            pevent[i] = NULL;
+        }
+    }
+
+    raw_spin_lock_irqsave(&hc->lock, flags);
+    for (i = 0; i < HEADLESS_EVENTS; i++) {
+        hc->pevent[i] = pevent[i];
+        hc->prev[i] = pevent[i] ? local64_read(&pevent[i]->count) : 0;
+    }
+    raw_spin_unlock_irqrestore(&hc->lock, flags);
+}
+
+static void headless_cpu_offline(int cpu)
+{
+    struct headless_cpu *hc = per_cpu_ptr(headless_cpus, cpu);
+    struct perf_event *pevent[HEADLESS_EVENTS];
+    unsigned long flags;
+    int i;
+
+    raw_spin_lock_irqsave(&hc->lock, flags);
+    for (i = 0; i < HEADLESS_EVENTS; i++) {
+        pevent[i] = hc->pevent[i];
+        hc->pevent[i] = NULL;
+    }
+    raw_spin_unlock_irqrestore(&hc->lock, flags);
+
+    for (i = 0; i < HEADLESS_EVENTS; i++)
+        if (pevent[i])
+            perf_event_release_kernel(pevent[i]);
+}
+
+/* Called with headless_mutex held */
+static void headless_rollup(void)
+{
+    unsigned long dropped = 0;
+    int cpu, i, j, k, n;
+
+    memset(headless_cluster, 0, sizeof(headless_cluster));
+    memset(headless_merge, 0, HEADLESS_MERGE * sizeof(*headless_merge));
+
+    for_each_possible_cpu(cpu) {
+        struct headless_cpu *hc = per_cpu_ptr(headless_cpus, cpu);
+        int cluster = gator_clusterids[cpu];
+        unsigned long flags;
+
+        if (cluster < 0 || cluster >= GATOR_CLUSTER_COUNT)
+            cluster = 0;
+
+        raw_spin_lock_irqsave(&hc->lock, flags);
+        for (i = 0; i < HEADLESS_EVENTS; i++)
+            headless_cluster[cluster][i] += hc->total[i];
+        memset(hc->total, 0, sizeof(hc->total));
+
+        for (j = 0; j < HEADLESS_TASKS; j++) {
+            struct headless_task *src = &hc->tasks[j];
+            struct headless_task *dst;
+
+            if (src->pid == 0)
+                continue;
+
+            dst = headless_find(headless_merge, HEADLESS_MERGE_BITS, NULL, src->pid, src->comm);
+            if (dst == NULL) {
+                dropped++;
+                continue;
+            }
+            for (i = 0; i < HEADLESS_EVENTS; i++)
+                dst->count[i] += src->count[i];
+        }
+        memset(hc->tasks, 0, sizeof(hc->tasks));
+        dropped += hc->dropped;
+        hc->dropped = 0;
+        raw_spin_unlock_irqrestore(&hc->lock, flags);
+    }
+
+    /* Keep the tasks with the most cycles */
+    n = 0;
+    for (j = 0; j < HEADLESS_MERGE; j++) {
+        struct headless_task *t = &headless_merge[j];
+
+        if (t->pid == 0)
+            continue;
+
+        if (n < HEADLESS_TOP) {
+            i = n++;
+        } else {
+            i = 0;
+            for (k = 1; k < HEADLESS_TOP; k++)
+                if (headless_top[k].count[HEADLESS_CYCLES] < headless_top[i].count[HEADLESS_CYCLES])
+                    i = k;
+            if (headless_top[i].count[HEADLESS_CYCLES] >= t->count[HEADLESS_CYCLES])
+                continue;
+        }
+        headless_top[i] = *t;
+    }
+
+    headless_top_count = n;
+    headless_dropped = dropped;
+}
+
+static void headless_work_func(struct work_struct *work)
+{
+    unsigned int period = max(READ_ONCE(headless_period_ms), 100U);
+
+    mutex_lock(&headless_mutex);
+    if (headless_enabled) {
+        headless_rollup();
+        headless_last_ms = period;
+        schedule_delayed_work(&headless_work, msecs_to_jiffies(period));
+    }
+    mutex_unlock(&headless_mutex);
+}
+
+/* Ratio scaled by 1000, 0 if undefined */
+static u64 headless_ratio(u64 num, u64 den)
+{
+    return den ? div64_u64(num * 1000, den) : 0;
+}
+
+static void headless_show_counts(struct seq_file *m, const u64 *count)
+{
+    seq_printf(m, "%llu %llu %llu %llu %llu\n",
+               count[HEADLESS_CYCLES], count[HEADLESS_INSTRUCTIONS],
+               headless_ratio(count[HEADLESS_INSTRUCTIONS], count[HEADLESS_CYCLES]),
+               headless_ratio(count[HEADLESS_CACHE_MISSES], count[HEADLESS_INSTRUCTIONS]),
+               headless_ratio(count[HEADLESS_BRANCH_MISSES], count[HEADLESS_INSTRUCTIONS]));
+}
+
+static int headless_show(struct seq_file *m, void *v)
+{
+    int i;
+
+    mutex_lock(&headless_mutex);
+    seq_printf(m, "enabled: %d\nperiod_ms: %u\ndropped: %lu\n",
+               headless_enabled, headless_last_ms, headless_dropped);
+
+    seq_puts(m, "cluster cycles instructions ipc_x1000 cache_miss_pki branch_miss_pki\n");
+    for (i = 0; i < gator_cluster_count && i < GATOR_CLUSTER_COUNT; i++) {
+        seq_printf(m, "%d ", i);
+        headless_show_counts(m, headless_cluster[i]);
+    }
+
+    seq_puts(m, "pid comm cycles instructions ipc_x1000 cache_miss_pki branch_miss_pki\n");
+    for (i = 0; i < headless_top_count; i++) {
+        seq_printf(m, "%d %s ", headless_top[i].pid, headless_top[i].comm);
+        headless_show_counts(m, headless_top[i].count);
+    }
+    mutex_unlock(&headless_mutex);
+
+    return 0;
+}
+
+static int headless_open(struct inode *inode, struct file *file)
+{
+    return single_open(file, headless_show, NULL);
+}
+
+static const struct file_operations headless_fops = {
+    .open = headless_open,
+    .read = seq_read,
+    .llseek = seq_lseek,
+    .release = single_release,
+};
+
+static int headless_start(void)
+{
+    int cpu, ret;
+
+    for_each_possible_cpu(cpu) {
+        struct headless_cpu *hc = per_cpu_ptr(headless_cpus, cpu);
+
+        memset(hc->tasks, 0, sizeof(hc->tasks));
+        memset(hc->total, 0, sizeof(hc->total));
+        hc->dropped = 0;
+    }
+
+    get_online_cpus();
+    for_each_online_cpu(cpu)
+        headless_cpu_online(cpu);
+    headless_enabled = true;
+    put_online_cpus();
+
+    ret = tracepoint_probe_register(gator_tracepoint_sched_switch, headless_sched_switch, NULL);
+    if (ret) {
+        pr_err("gator: headless: unable to hook sched_switch\n");
+        goto fail;
+    }
+
+    schedule_delayed_work(&headless_work, msecs_to_jiffies(max(headless_period_ms, 100U)));
+    return 0;
+
+fail:
+    get_online_cpus();
+    headless_enabled = false;
+    for_each_online_cpu(cpu)
+        headless_cpu_offline(cpu);
+    put_online_cpus();
+    return ret;
+}
+
+static void headless_stop(void)
+{
+    int cpu;
+
+    tracepoint_probe_unregister(gator_tracepoint_sched_switch, headless_sched_switch, NULL);
+    tracepoint_synchronize_unregister();
+
+    get_online_cpus();
+    headless_enabled = false;
+    for_each_online_cpu(cpu)
+        headless_cpu_offline(cpu);
+    put_online_cpus();
+}
+
+static int headless_param_set(const char *val, const struct kernel_param *kp)
+{
+    bool enable;
+    int ret;
+
+    ret = strtobool(val, &enable);
+    if (ret)
+        return ret;
+
+    if (headless_cpus == NULL || gator_tracepoint_sched_switch == NULL)
+        return -ENODEV;
+
+    mutex_lock(&headless_mutex);
+    if (enable && !headless_enabled)
+        ret = headless_start();
+    else if (!enable && headless_enabled)
+        headless_stop();
+    mutex_unlock(&headless_mutex);
+
+    /* The work takes headless_mutex and stops rearming once disabled */
+    if (!enable)
+        cancel_delayed_work_sync(&headless_work);
+
+    return ret;
+}
+
+static int headless_param_get(char *buffer, const struct kernel_param *kp)
+{
+    return sprintf(buffer, "%c", headless_enabled ? 'Y' : 'N');
+}
+
+static const struct kernel_param_ops headless_param_ops = {
+    .set = headless_param_set,
+    .get = headless_param_get,
+};
+module_param_cb(headless, &headless_param_ops, NULL, 0644);
+
+static int gator_headless_hotcpu_notify(struct notifier_block *self, unsigned long action, void *hcpu)
+{
+    int cpu = (long)hcpu;
+
+    /* Hotplug runs under cpu_hotplug_begin(), which excludes start and stop */
+    if (!headless_enabled)
+        return NOTIFY_OK;
+
+    switch (action & ~CPU_TASKS_FROZEN) {
+    case CPU_ONLINE:
+    case CPU_DOWN_FAILED:
+        headless_cpu_online(cpu);
+        break;
+    case CPU_DOWN_PREPARE:
+        headless_cpu_offline(cpu);
+        break;
+    }
+
+    return NOTIFY_OK;
+}
+
+static struct notifier_block __refdata gator_headless_hotcpu_notifier = {
+    .notifier_call = gator_headless_hotcpu_notify,
+};
+
+static void gator_headless_init(void)
+{
+    int cpu;
+
+    INIT_DELAYED_WORK(&headless_work, headless_work_func);
+
+    headless_cpus = alloc_percpu(struct headless_cpu);
+    headless_merge = kcalloc(HEADLESS_MERGE, sizeof(*headless_merge), GFP_KERNEL);
+    if (headless_cpus == NULL || headless_merge == NULL) {
+        pr_err("gator: headless: out of memory\n");
+        free_percpu(headless_cpus);
+        kfree(headless_merge);
+        headless_cpus = NULL;
+        headless_merge = NULL;
+        return;
+    }
+
+    for_each_possible_cpu(cpu)
+        raw_spin_lock_init(&per_cpu_ptr(headless_cpus, cpu)->lock);
+
+    register_hotcpu_notifier(&gator_headless_hotcpu_notifier);
+    proc_create("gator_headless", 0444, NULL, &headless_fops);
+}
+
+static void gator_headless_exit(void)
+{
+    if (headless_cpus == NULL)
+        return;
+
+    mutex_lock(&headless_mutex);
+    if (headless_enabled)
+        headless_stop();
+    mutex_unlock(&headless_mutex);
+    cancel_delayed_work_sync(&headless_work);
+
+    remove_proc_entry("gator_headless", NULL);
+    unregister_hotcpu_notifier(&gator_headless_hotcpu_notifier);
+    free_percpu(headless_cpus);
+    kfree(headless_merge);
+    headless_cpus = NULL;
+}
+
+#else
+
+static void gator_headless_init(void)
+{
+}
+
+static void gator_headless_exit(void)
+{
+}
+
+#endif
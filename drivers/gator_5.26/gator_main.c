@@ -265,6 +265,7 @@ GATOR_EVENTS_LIST
 #include "gator_trace_gpu.c"
 #include "gator_backtrace.c"
 #include "gator_events_perf_pmu.c"
+#include "gator_headless.c"
 
 /******************************************************************************
  * Misc
@@ -1366,6 +1367,8 @@ static int __init gator_module_init(void)
     memset(gator_cpuids, -1, sizeof(gator_cpuids));
     on_each_cpu(gator_read_cpuid, NULL, 1);
 
+    gator_headless_init();
+
     return 0;
 }
 
@@ -1376,6 +1379,7 @@ static void __exit gator_module_exit(void)
     unregister_tracepoint_module_notifier(&tracepoint_notifier_block);
 #endif
 
+    gator_headless_exit();
     del_timer_sync(&gator_buffer_wake_up_timer);
     tracepoint_synchronize_unregister();
     gator_exit();
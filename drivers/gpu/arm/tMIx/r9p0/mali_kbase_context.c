@@ -191,6 +191,9 @@ kbase_create_context(struct kbase_device *kbdev, bool is_compat)
 	/* MALI_SEC_INTEGRATION */
 	atomic_set(&kctx->mem_profile_showing_state, 0);
 	init_waitqueue_head(&kctx->mem_profile_wait);
+
+	/* a new context is about to load its resources */
+	kbase_mem_prefill(kbdev);
 	return kctx;
 
 no_jit:
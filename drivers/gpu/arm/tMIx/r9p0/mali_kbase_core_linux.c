@@ -3465,6 +3465,40 @@ static ssize_t kbase_show_gpuinfo(struct device *dev,
 }
 static DEVICE_ATTR(gpuinfo, S_IRUGO, kbase_show_gpuinfo, NULL);
 
+/**
+ * show_as_stats - Show callback for the as_stats sysfs file.
+ * @dev:  The device this sysfs file is for.
+ * @attr: The attributes of the sysfs file.
+ * @buf:  The output buffer for the sysfs file contents.
+ *
+ * This function is called to get how often a context was given back its
+ * previous address space, how often an address space was programmed for
+ * another context and how often that evicted an idle context.
+ *
+ * Return: The number of bytes output to @buf.
+ */
+static ssize_t show_as_stats(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct kbase_device *kbdev;
+	unsigned long flags;
+	u32 reuse, sw, evict;
+
+	kbdev = to_kbase_device(dev);
+	if (!kbdev)
+		return -ENODEV;
+
+	spin_lock_irqsave(&kbdev->hwaccess_lock, flags);
+	reuse = kbdev->as_reuse_count;
+	sw = kbdev->as_switch_count;
+	evict = kbdev->as_evict_count;
+	spin_unlock_irqrestore(&kbdev->hwaccess_lock, flags);
+
+	return scnprintf(buf, PAGE_SIZE, "reuse %u switch %u evict %u\n",
+			reuse, sw, evict);
+}
+static DEVICE_ATTR(as_stats, S_IRUGO, show_as_stats, NULL);
+
 /**
  * set_dvfs_period - Store callback for the dvfs_period sysfs file.
  * @dev:   The device with sysfs file is for
@@ -3864,6 +3898,124 @@ static ssize_t set_lp_mem_pool_max_size(struct device *dev,
 static DEVICE_ATTR(lp_mem_pool_max_size, S_IRUGO | S_IWUSR, show_lp_mem_pool_max_size,
 		set_lp_mem_pool_max_size);
 
+/**
+ * show_mem_pool_prefill - Show the prefill size of the memory pool.
+ * @dev:  The device this sysfs file is for.
+ * @attr: The attributes of the sysfs file.
+ * @buf:  The output buffer to receive the prefill size.
+ *
+ * This function is called to get the number of pages the kbdev pool is filled
+ * up to when a context is created.
+ *
+ * Return: The number of bytes output to @buf.
+ */
+static ssize_t show_mem_pool_prefill(struct device *dev,
+		struct device_attribute *attr, char * const buf)
+{
+	struct kbase_device *kbdev;
+
+	kbdev = to_kbase_device(dev);
+	if (!kbdev)
+		return -ENODEV;
+
+	return scnprintf(buf, PAGE_SIZE, "%zu\n", kbdev->memdev.prefill_pages);
+}
+
+/**
+ * set_mem_pool_prefill - Set the prefill size of the memory pool.
+ * @dev:   The device this sysfs file is for.
+ * @attr:  The attributes of the sysfs file.
+ * @buf:   The value written to the sysfs file.
+ * @count: The number of bytes written to the sysfs file.
+ *
+ * This function is called to set the number of pages the kbdev pool is filled
+ * up to when a context is created, 0 to disable. It is limited by the maximum
+ * size of the pool.
+ *
+ * Return: @count if the function succeeded. An error code on failure.
+ */
+static ssize_t set_mem_pool_prefill(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count)
+{
+	struct kbase_device *kbdev;
+	unsigned long new_size;
+	int err;
+
+	kbdev = to_kbase_device(dev);
+	if (!kbdev)
+		return -ENODEV;
+
+	err = kstrtoul(buf, 0, &new_size);
+	if (err)
+		return -EINVAL;
+
+	kbdev->memdev.prefill_pages = new_size;
+
+	return count;
+}
+
+static DEVICE_ATTR(mem_pool_prefill, S_IRUGO | S_IWUSR, show_mem_pool_prefill,
+		set_mem_pool_prefill);
+
+/**
+ * show_lp_mem_pool_prefill - Show the prefill size of the large memory pages pool.
+ * @dev:  The device this sysfs file is for.
+ * @attr: The attributes of the sysfs file.
+ * @buf:  The output buffer to receive the prefill size.
+ *
+ * This function is called to get the number of large memory pages the kbdev
+ * pool is filled up to when a context is created.
+ *
+ * Return: The number of bytes output to @buf.
+ */
+static ssize_t show_lp_mem_pool_prefill(struct device *dev,
+		struct device_attribute *attr, char * const buf)
+{
+	struct kbase_device *kbdev;
+
+	kbdev = to_kbase_device(dev);
+	if (!kbdev)
+		return -ENODEV;
+
+	return scnprintf(buf, PAGE_SIZE, "%zu\n", kbdev->memdev.lp_prefill_pages);
+}
+
+/**
+ * set_lp_mem_pool_prefill - Set the prefill size of the large memory pages pool.
+ * @dev:   The device this sysfs file is for.
+ * @attr:  The attributes of the sysfs file.
+ * @buf:   The value written to the sysfs file.
+ * @count: The number of bytes written to the sysfs file.
+ *
+ * This function is called to set the number of large memory pages the kbdev
+ * pool is filled up to when a context is created, 0 to disable. Large pages
+ * are only used with CONFIG_MALI_2MB_ALLOC.
+ *
+ * Return: @count if the function succeeded. An error code on failure.
+ */
+static ssize_t set_lp_mem_pool_prefill(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count)
+{
+	struct kbase_device *kbdev;
+	unsigned long new_size;
+	int err;
+
+	kbdev = to_kbase_device(dev);
+	if (!kbdev)
+		return -ENODEV;
+
+	err = kstrtoul(buf, 0, &new_size);
+	if (err)
+		return -EINVAL;
+
+	kbdev->memdev.lp_prefill_pages = new_size;
+
+	return count;
+}
+
+static DEVICE_ATTR(lp_mem_pool_prefill, S_IRUGO | S_IWUSR, show_lp_mem_pool_prefill,
+		set_lp_mem_pool_prefill);
+
 #ifdef CONFIG_DEBUG_FS
 
 /* Number of entries in serialize_jobs_settings[] */
@@ -4564,6 +4716,9 @@ static struct attribute *kbase_attrs[] = {
 	&dev_attr_mem_pool_max_size.attr,
 	&dev_attr_lp_mem_pool_size.attr,
 	&dev_attr_lp_mem_pool_max_size.attr,
+	&dev_attr_mem_pool_prefill.attr,
+	&dev_attr_lp_mem_pool_prefill.attr,
+	&dev_attr_as_stats.attr,
 	NULL
 };
 
@@ -70,12 +70,16 @@ void kbase_ctx_sched_term(struct kbase_device *kbdev)
  *
  * This function returns an address space available for use. It would prefer
  * returning an AS that has been previously assigned to the context to
- * avoid having to reprogram the MMU.
+ * avoid having to reprogram the MMU. Otherwise it prefers an AS that no
+ * context owns, then the AS of the context that has been idle the longest,
+ * so that recently used contexts stay resident.
  */
 static int kbasep_ctx_sched_find_as_for_ctx(struct kbase_context *kctx)
 {
 	struct kbase_device *const kbdev = kctx->kbdev;
-	int free_as;
+	int free_as = KBASEP_AS_NR_INVALID;
+	u32 age, oldest = 0;
+	int i;
 
 	lockdep_assert_held(&kbdev->hwaccess_lock);
 
@@ -87,11 +91,23 @@ static int kbasep_ctx_sched_find_as_for_ctx(struct kbase_context *kctx)
 	/* The previously assigned AS was taken, we'll be returning any free
 	 * AS at this point.
 	 */
-	free_as = ffs(kbdev->as_free) - 1;
-	if (free_as >= 0 && free_as < kbdev->nr_hw_address_spaces)
-		return free_as;
+	for (i = 0; i < kbdev->nr_hw_address_spaces; i++) {
+		struct kbase_context *const owner = kbdev->as_to_kctx[i];
 
-	return KBASEP_AS_NR_INVALID;
+		if (!(kbdev->as_free & (1u << i)))
+			continue;
+
+		if (!owner)
+			return i;
+
+		age = kbdev->as_use_seq - owner->as_last_used;
+		if (free_as == KBASEP_AS_NR_INVALID || age > oldest) {
+			free_as = i;
+			oldest = age;
+		}
+	}
+
+	return free_as;
 }
 
 int kbase_ctx_sched_retain_ctx(struct kbase_context *kctx)
@@ -108,6 +124,8 @@ int kbase_ctx_sched_retain_ctx(struct kbase_context *kctx)
 
 		if (free_as != KBASEP_AS_NR_INVALID) {
 			kbdev->as_free &= ~(1u << free_as);
+			if (free_as == kctx->as_nr)
+				kbdev->as_reuse_count++;
 			/* Only program the MMU if the context has not been
 			 * assigned the same address space before.
 			 */
@@ -115,10 +133,12 @@ int kbase_ctx_sched_retain_ctx(struct kbase_context *kctx)
 				struct kbase_context *const prev_kctx =
 					kbdev->as_to_kctx[free_as];
 
+				kbdev->as_switch_count++;
 				if (prev_kctx) {
 					WARN_ON(atomic_read(&prev_kctx->refcount) != 0);
 					kbase_mmu_disable(prev_kctx);
 					prev_kctx->as_nr = KBASEP_AS_NR_INVALID;
+					kbdev->as_evict_count++;
 				}
 
 				kctx->as_nr = free_as;
@@ -156,8 +176,10 @@ void kbase_ctx_sched_release_ctx(struct kbase_context *kctx)
 
 	lockdep_assert_held(&kbdev->hwaccess_lock);
 
-	if (atomic_dec_return(&kctx->refcount) == 0)
+	if (atomic_dec_return(&kctx->refcount) == 0) {
 		kbdev->as_free |= (1u << kctx->as_nr);
+		kctx->as_last_used = ++kbdev->as_use_seq;
+	}
 }
 
 void kbase_ctx_sched_remove_ctx(struct kbase_context *kctx)
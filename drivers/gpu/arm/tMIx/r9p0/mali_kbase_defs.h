@@ -770,6 +770,11 @@ struct kbasep_mem_device {
 	atomic_t used_pages;   /* Tracks usage of OS shared memory. Updated
 				   when OS memory is allocated/freed. */
 
+	/* Number of pages the device pools are filled up to in the
+	 * background when a context is created, 0 to disable. */
+	size_t prefill_pages;
+	size_t lp_prefill_pages;
+	struct work_struct prefill_work;
 };
 
 #define KBASE_TRACE_CODE(X) KBASE_TRACE_CODE_ ## X
@@ -1076,6 +1081,13 @@ struct kbase_device {
 	u16 as_free; /* Bitpattern of free Address Spaces */
 	/* Mapping from active Address Spaces to kbase_context */
 	struct kbase_context *as_to_kctx[BASE_MAX_NR_AS];
+	/* Stamp given to a context when it becomes idle, to find the least
+	 * recently used one when an AS must be taken from an idle context */
+	u32 as_use_seq;
+	/* Context Scheduler statistics, under the same lock */
+	u32 as_reuse_count;  /* context got back the AS it had before */
+	u32 as_switch_count; /* AS programmed for another context */
+	u32 as_evict_count;  /* ... taken from an idle context that had it */
 
 
 	spinlock_t mmu_mask_change;
@@ -1511,6 +1523,9 @@ struct kbase_context {
 	 */
 	atomic_t refcount;
 
+	/* kbase_device::as_use_seq when the refcount last dropped to 0 */
+	u32 as_last_used;
+
 	/* NOTE:
 	 *
 	 * Flags are in jctx.sched_info.ctx.flags
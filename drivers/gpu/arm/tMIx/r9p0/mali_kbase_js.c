@@ -2457,6 +2457,8 @@ struct kbase_jd_atom *kbase_js_complete_atom(struct kbase_jd_atom *katom,
 		/* MALI_SEC_INTEGRATION */
 		if (kbdev->vendor_callbacks->cl_boost_update_utilization)
 			kbdev->vendor_callbacks->cl_boost_update_utilization(kbdev, katom, microseconds_spent);
+		if (kbdev->vendor_callbacks->dvfs_job_done)
+			kbdev->vendor_callbacks->dvfs_job_done(kbdev, katom, end_timestamp);
 
 		do_div(microseconds_spent, 1000);
 
@@ -774,6 +774,42 @@ int kbase_region_tracker_init_jit(struct kbase_context *kctx, u64 jit_va_pages,
     return 0;
 }
 
+static void kbase_mem_pool_prefill(struct kbase_mem_pool *pool,
+		size_t target)
+{
+	size_t cur_size = kbase_mem_pool_size(pool);
+
+	target = min(target, kbase_mem_pool_max_size(pool));
+	if (target > cur_size)
+		kbase_mem_pool_grow(pool, target - cur_size);
+}
+
+/*
+ * A new context usually comes before its process loads its resources, so
+ * the device pools are filled then, outside the allocation path, and the
+ * page-by-page allocation of the load is served from the pools.
+ */
+static void kbase_mem_prefill_worker(struct work_struct *work)
+{
+	struct kbasep_mem_device *memdev = container_of(work,
+			struct kbasep_mem_device, prefill_work);
+	struct kbase_device *kbdev = container_of(memdev,
+			struct kbase_device, memdev);
+
+	kbase_mem_pool_prefill(&kbdev->mem_pool, memdev->prefill_pages);
+#ifdef CONFIG_MALI_2MB_ALLOC
+	kbase_mem_pool_prefill(&kbdev->lp_mem_pool, memdev->lp_prefill_pages);
+#endif
+}
+
+void kbase_mem_prefill(struct kbase_device *kbdev)
+{
+	struct kbasep_mem_device *memdev = &kbdev->memdev;
+
+	if (memdev->prefill_pages || memdev->lp_prefill_pages)
+		queue_work(system_unbound_wq, &memdev->prefill_work);
+}
+
 int kbase_mem_init(struct kbase_device *kbdev)
 {
 	struct kbasep_mem_device *memdev;
@@ -787,6 +823,10 @@ int kbase_mem_init(struct kbase_device *kbdev)
 	/* Initialize memory usage */
 	atomic_set(&memdev->used_pages, 0);
 
+	memdev->prefill_pages = 0;
+	memdev->lp_prefill_pages = 0;
+	INIT_WORK(&memdev->prefill_work, kbase_mem_prefill_worker);
+
 	ret = kbase_mem_pool_init(&kbdev->mem_pool,
 			KBASE_MEM_POOL_MAX_SIZE_KBDEV,
 			KBASE_MEM_POOL_4KB_PAGE_TABLE_ORDER,
@@ -824,6 +864,8 @@ void kbase_mem_term(struct kbase_device *kbdev)
 	if (pages != 0)
 		dev_warn(kbdev->dev, "%s: %d pages in use!\n", __func__, pages);
 
+	cancel_work_sync(&memdev->prefill_work);
+
 	kbase_mem_pool_term(&kbdev->mem_pool);
 	kbase_mem_pool_term(&kbdev->lp_mem_pool);
 }
@@ -220,6 +220,16 @@ int kbase_mem_init(struct kbase_device *kbdev);
 void kbase_mem_halt(struct kbase_device *kbdev);
 void kbase_mem_term(struct kbase_device *kbdev);
 
+/**
+ * kbase_mem_prefill - Fill the device memory pools in the background
+ * @kbdev: The kbase device
+ *
+ * Grows the device pools up to the mem_pool_prefill and lp_mem_pool_prefill
+ * sizes from a worker, so that a following burst of allocations does not
+ * allocate from the kernel page by page.
+ */
+void kbase_mem_prefill(struct kbase_device *kbdev);
+
 static inline struct kbase_mem_phy_alloc *kbase_mem_phy_alloc_get(struct kbase_mem_phy_alloc *alloc)
 {
 	kref_get(&alloc->kref);
@@ -38,6 +38,7 @@ static int gpu_dvfs_governor_default(struct exynos_context *platform, int utiliz
 static int gpu_dvfs_governor_interactive(struct exynos_context *platform, int utilization);
 static int gpu_dvfs_governor_static(struct exynos_context *platform, int utilization);
 static int gpu_dvfs_governor_booster(struct exynos_context *platform, int utilization);
+static int gpu_dvfs_governor_frame(struct exynos_context *platform, int utilization);
 
 static gpu_dvfs_governor_info governor_info[G3D_MAX_GOVERNOR_NUM] = {
 	{
@@ -64,6 +65,12 @@ static gpu_dvfs_governor_info governor_info[G3D_MAX_GOVERNOR_NUM] = {
 		gpu_dvfs_governor_booster,
 		NULL
 	},
+	{
+		G3D_DVFS_GOVERNOR_FRAME,
+		"Frame",
+		gpu_dvfs_governor_frame,
+		NULL
+	},
 };
 
 void gpu_dvfs_update_start_clk(int governor_type, int clk)
@@ -226,6 +233,97 @@ static int gpu_dvfs_governor_booster(struct exynos_context *platform, int utiliz
 	return 0;
 }
 
+/*
+ * The frame governor takes the GPU time of the frames rendered since the
+ * last decision. A frame is counted from the first job started after the
+ * previous fragment job until the next fragment job completes. The longest
+ * frame, scaled by the clock, gives the lowest clock that still finishes a
+ * frame within G3D_GOVERNOR_FRAME_HEADROOM percent of the display period.
+ * Without frames (compute or idle) it works as the default governor.
+ */
+#define G3D_GOVERNOR_FRAME_HEADROOM		85
+static int gpu_dvfs_governor_frame(struct exynos_context *platform, int utilization)
+{
+	int step, max_step, min_step;
+	unsigned long flags;
+	u32 count, max_us;
+	u64 need_clock, budget_us;
+
+	DVFS_ASSERT(platform);
+
+	spin_lock_irqsave(&platform->frame.lock, flags);
+	count = platform->frame.count;
+	max_us = platform->frame.max_us;
+	platform->frame.count = 0;
+	platform->frame.max_us = 0;
+	spin_unlock_irqrestore(&platform->frame.lock, flags);
+
+	if (!count || platform->frame.period_us <= 0)
+		return gpu_dvfs_governor_default(platform, utilization);
+
+	budget_us = (u64)platform->frame.period_us * G3D_GOVERNOR_FRAME_HEADROOM / 100;
+	need_clock = div64_u64((u64)platform->cur_clock * max_us, budget_us);
+
+	max_step = gpu_dvfs_get_level(platform->gpu_max_clock);
+	if (platform->using_max_limit_clock)
+		max_step = max(max_step, gpu_dvfs_get_level(platform->gpu_max_clock_limit));
+	min_step = gpu_dvfs_get_level(platform->gpu_min_clock);
+
+	/* the table goes from the highest clock to the lowest */
+	for (step = min_step; step > max_step; step--)
+		if (platform->table[step].clock >= need_clock)
+			break;
+
+	if (step < platform->step) {
+		platform->step = step;
+		platform->down_requirement = platform->table[step].down_staycount;
+	} else if (step > platform->step) {
+		/* go down one level at a time, after down_staycount periods */
+		if (--platform->down_requirement <= 0) {
+			platform->step++;
+			platform->down_requirement = platform->table[platform->step].down_staycount;
+		}
+	} else {
+		platform->down_requirement = platform->table[platform->step].down_staycount;
+	}
+
+	DVFS_ASSERT((platform->step >= max_step) && (platform->step <= min_step));
+
+	return 0;
+}
+
+/*
+ * Called by the job scheduler when an atom leaves the GPU, holds the frame
+ * accounting of the frame governor.
+ */
+void gpu_dvfs_frame_job_done(void *dev, void *atom, void *end_timestamp)
+{
+	struct kbase_device *kbdev = (struct kbase_device *)dev;
+	struct kbase_jd_atom *katom = (struct kbase_jd_atom *)atom;
+	struct exynos_context *platform = (struct exynos_context *)kbdev->platform_context;
+	unsigned long flags;
+	u32 frame_us;
+
+	if (!platform || platform->governor_type != G3D_DVFS_GOVERNOR_FRAME)
+		return;
+
+	spin_lock_irqsave(&platform->frame.lock, flags);
+	if (!platform->frame.in_frame ||
+			ktime_before(katom->start_timestamp, platform->frame.start)) {
+		platform->frame.start = katom->start_timestamp;
+		platform->frame.in_frame = true;
+	}
+
+	if (katom->core_req & BASE_JD_REQ_FS) {
+		frame_us = (u32)ktime_us_delta(*(ktime_t *)end_timestamp,
+					platform->frame.start);
+		platform->frame.max_us = max(platform->frame.max_us, frame_us);
+		platform->frame.count++;
+		platform->frame.in_frame = false;
+	}
+	spin_unlock_irqrestore(&platform->frame.lock, flags);
+}
+
 static int gpu_dvfs_decide_next_governor(struct exynos_context *platform)
 {
 	return 0;
@@ -209,6 +209,16 @@ static int gpu_validate_attrib_data(struct exynos_context *platform)
 	gpu_dvfs_update_table(G3D_DVFS_GOVERNOR_INTERACTIVE, (gpu_dvfs_info *) data);
 	data = gpu_get_attrib_data(attrib, GPU_GOVERNOR_TABLE_SIZE_INTERACTIVE);
 	gpu_dvfs_update_table_size(G3D_DVFS_GOVERNOR_INTERACTIVE, (u32) data);
+
+	/* the frame governor works on the default table */
+	data = gpu_get_attrib_data(attrib, GPU_GOVERNOR_START_CLOCK_DEFAULT);
+	gpu_dvfs_update_start_clk(G3D_DVFS_GOVERNOR_FRAME, data == 0 ? 266 : (u32) data);
+	data = gpu_get_attrib_data(attrib, GPU_GOVERNOR_TABLE_DEFAULT);
+	gpu_dvfs_update_table(G3D_DVFS_GOVERNOR_FRAME, (gpu_dvfs_info *) data);
+	data = gpu_get_attrib_data(attrib, GPU_GOVERNOR_TABLE_SIZE_DEFAULT);
+	gpu_dvfs_update_table_size(G3D_DVFS_GOVERNOR_FRAME, (u32) data);
+	platform->frame.period_us = 16667;
+
 	data = gpu_get_attrib_data(attrib, GPU_GOVERNOR_INTERACTIVE_HIGHSPEED_CLOCK);
 	platform->interactive.highspeed_clock = data == 0 ? 500 : (u32) data;
 	data = gpu_get_attrib_data(attrib, GPU_GOVERNOR_INTERACTIVE_HIGHSPEED_LOAD);
@@ -311,6 +321,9 @@ static int gpu_context_init(struct kbase_device *kbdev)
 	mutex_init(&platform->gpu_clock_lock);
 	mutex_init(&platform->gpu_dvfs_handler_lock);
 	spin_lock_init(&platform->gpu_dvfs_spinlock);
+#ifdef CONFIG_MALI_DVFS
+	spin_lock_init(&platform->frame.lock);
+#endif
 
 #ifdef CONFIG_SCHED_HMP
 	mutex_init(&platform->gpu_sched_hmp_lock);
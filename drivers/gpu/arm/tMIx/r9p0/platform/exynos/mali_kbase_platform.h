@@ -261,6 +261,16 @@ struct exynos_context {
 		int highspeed_delay;
 		int delay_count;
 	} interactive;
+
+	/* For the frame governor */
+	struct {
+		spinlock_t lock;
+		int period_us;
+		bool in_frame;
+		ktime_t start;
+		u32 count;
+		u32 max_us;
+	} frame;
 #ifdef CONFIG_CPU_THERMAL_IPA
 	int norm_utilisation;
 	int freq_for_normalisation;
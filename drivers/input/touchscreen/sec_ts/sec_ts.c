@@ -952,6 +952,84 @@ void sec_ts_reinit(struct sec_ts_data *ts)
 	return;
 }
 
+static void sec_ts_account_latency(struct sec_ts_data *ts)
+{
+	s64 delta;
+	u32 us;
+	int i;
+
+	/* the secure touch path calls the thread without an interrupt */
+	if (!ktime_to_ns(ts->irq_stamp))
+		return;
+
+	delta = ktime_us_delta(ktime_get(), ts->irq_stamp);
+	ts->irq_stamp = ktime_set(0, 0);
+	if (delta < 0)
+		return;
+
+	us = (u32)min_t(s64, delta, U32_MAX);
+	ts->latency.last_us = us;
+	if (us > ts->latency.max_us)
+		ts->latency.max_us = us;
+	ts->latency.sum_us += us;
+	ts->latency.count++;
+
+	for (i = 0; i < SEC_TS_LAT_BUCKETS - 1; i++)
+		if (us < (USEC_PER_MSEC << i))
+			break;
+	ts->latency.hist[i]++;
+}
+
+static int sec_ts_latency_show(struct seq_file *s, void *unused)
+{
+	struct sec_ts_data *ts = s->private;
+	u64 avg = 0;
+	int i;
+
+	mutex_lock(&ts->eventlock);
+	if (ts->latency.count)
+		avg = div64_u64(ts->latency.sum_us, ts->latency.count);
+
+	seq_printf(s, "count %llu last %u avg %llu max %u us\n",
+			ts->latency.count, ts->latency.last_us, avg,
+			ts->latency.max_us);
+	for (i = 0; i < SEC_TS_LAT_BUCKETS; i++) {
+		if (i < SEC_TS_LAT_BUCKETS - 1)
+			seq_printf(s, "<%2dms %u\n", 1 << i, ts->latency.hist[i]);
+		else
+			seq_printf(s, ">=%dms %u\n", 1 << (i - 1),
+					ts->latency.hist[i]);
+	}
+	mutex_unlock(&ts->eventlock);
+
+	return 0;
+}
+
+static int sec_ts_latency_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, sec_ts_latency_show, inode->i_private);
+}
+
+static ssize_t sec_ts_latency_write(struct file *file, const char __user *buf,
+		size_t count, loff_t *ppos)
+{
+	struct sec_ts_data *ts = ((struct seq_file *)file->private_data)->private;
+
+	mutex_lock(&ts->eventlock);
+	memset(&ts->latency, 0, sizeof(ts->latency));
+	mutex_unlock(&ts->eventlock);
+
+	return count;
+}
+
+static const struct file_operations sec_ts_latency_fops = {
+	.open		= sec_ts_latency_open,
+	.read		= seq_read,
+	.write		= sec_ts_latency_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
 #define MAX_EVENT_COUNT 32
 static void sec_ts_read_event(struct sec_ts_data *ts)
 {
@@ -1472,6 +1550,22 @@ static void sec_ts_read_event(struct sec_ts_data *ts)
 	} while (remain_event_count >= 0);
 
 	input_sync(ts->input_dev);
+	sec_ts_account_latency(ts);
+}
+
+static irqreturn_t sec_ts_irq_handler(int irq, void *ptr)
+{
+	struct sec_ts_data *ts = (struct sec_ts_data *)ptr;
+
+	ts->irq_stamp = ktime_get();
+
+#ifdef CONFIG_SCHED_HMP
+	/* let the scheduler place the reader and the consumers on big cores */
+	if (ts->plat_data->boost_us && ts->power_status == SEC_TS_STATE_POWER_ON)
+		set_hmp_boostpulse(ts->plat_data->boost_us);
+#endif
+
+	return IRQ_WAKE_THREAD;
 }
 
 static irqreturn_t sec_ts_irq_thread(int irq, void *ptr)
@@ -1805,6 +1899,13 @@ static int sec_ts_parse_dt(struct i2c_client *client)
 		pdata->i2c_burstmax = 256;
 	}
 
+	/* CPU the touch IRQ and its thread are bound to, -1 leaves it floating */
+	if (of_property_read_u32(np, "sec,irq_affinity", &pdata->irq_affinity))
+		pdata->irq_affinity = -1;
+
+	if (of_property_read_u32(np, "sec,boost_us", &pdata->boost_us))
+		pdata->boost_us = 0;
+
 	if (of_property_read_u32_array(np, "sec,max_coords", coords, 2)) {
 		input_err(true, &client->dev, "%s: Failed to get max_coords property\n", __func__);
 		return -EINVAL;
@@ -2373,13 +2474,24 @@ static int sec_ts_probe(struct i2c_client *client, const struct i2c_device_id *i
 
 	input_info(true, &ts->client->dev, "%s: request_irq = %d\n", __func__, client->irq);
 
-	ret = request_threaded_irq(client->irq, NULL, sec_ts_irq_thread,
+	ret = request_threaded_irq(client->irq, sec_ts_irq_handler, sec_ts_irq_thread,
 			ts->plat_data->irq_type, SEC_TS_I2C_NAME, ts);
 	if (ret < 0) {
 		input_err(true, &ts->client->dev, "%s: Unable to request threaded irq\n", __func__);
 		goto err_irq;
 	}
 
+	/* the SCHED_FIFO irq thread follows the affinity of its interrupt */
+	if (ts->plat_data->irq_affinity >= 0 &&
+			cpu_possible(ts->plat_data->irq_affinity))
+		irq_set_affinity_hint(client->irq,
+				cpumask_of(ts->plat_data->irq_affinity));
+
+	ts->debugfs = debugfs_create_dir(dev_name(&client->dev), NULL);
+	if (!IS_ERR_OR_NULL(ts->debugfs))
+		debugfs_create_file("latency", 0600, ts->debugfs, ts,
+				&sec_ts_latency_fops);
+
 #ifdef CONFIG_TRUSTONIC_TRUSTED_UI
 	tsp_info = ts;
 
@@ -2449,6 +2561,8 @@ static int sec_ts_probe(struct i2c_client *client, const struct i2c_device_id *i
 
 err_fb_client:
 #endif
+	debugfs_remove_recursive(ts->debugfs);
+	irq_set_affinity_hint(client->irq, NULL);
 err_irq:
 	pm_qos_remove_request(&ts->pm_i2c_req);
 	pm_qos_remove_request(&ts->pm_touch_req);
@@ -2935,7 +3049,10 @@ static int sec_ts_remove(struct i2c_client *client)
 	cancel_delayed_work_sync(&ts->work_read_info);
 	flush_delayed_work(&ts->work_read_info);
 
+	debugfs_remove_recursive(ts->debugfs);
+
 	disable_irq_nosync(ts->client->irq);
+	irq_set_affinity_hint(ts->client->irq, NULL);
 	free_irq(ts->client->irq, ts);
 	input_info(true, &ts->client->dev, "%s: irq disabled\n", __func__);
 
@@ -16,6 +16,7 @@
 #include <asm/unaligned.h>
 #include <linux/completion.h>
 #include <linux/ctype.h>
+#include <linux/debugfs.h>
 #include <linux/delay.h>
 #include <linux/firmware.h>
 #include <linux/gpio.h>
@@ -33,6 +34,8 @@
 #include <linux/platform_device.h>
 #include <linux/pm_qos.h>
 #include <linux/regulator/consumer.h>
+#include <linux/sched.h>
+#include <linux/seq_file.h>
 #include <linux/slab.h>
 #include <linux/time.h>
 #include <linux/uaccess.h>
@@ -485,6 +488,9 @@ typedef enum {
 #define CMD_RESULT_WORD_LEN		10
 
 #define SEC_TS_I2C_RETRY_CNT		3
+
+/* IRQ to input_sync latency buckets, 1ms doubling up to 16ms */
+#define SEC_TS_LAT_BUCKETS		6
 #define SEC_TS_WAIT_RETRY_CNT		100
 
 #define SEC_TS_MODE_SPONGE_SPAY			(1 << 1)
@@ -709,6 +715,17 @@ struct sec_ts_data {
 	struct pm_qos_request pm_i2c_req;
 	struct pm_qos_request pm_touch_req;
 
+	/* stamped by the hard IRQ handler, consumed at input_sync */
+	ktime_t irq_stamp;
+	struct {
+		u64 count;
+		u64 sum_us;
+		u32 last_us;
+		u32 max_us;
+		u32 hist[SEC_TS_LAT_BUCKETS];
+	} latency;
+	struct dentry *debugfs;
+
 	struct delayed_work work_read_info;
 #ifdef USE_POWER_RESET_WORK
 	struct delayed_work reset_work;
@@ -831,6 +848,8 @@ struct sec_ts_plat_data {
 	unsigned irq_gpio;
 	int irq_type;
 	int i2c_burstmax;
+	int irq_affinity;
+	int boost_us;
 	int always_lpmode;
 	int bringup;
 	int mis_cal_check;
@@ -20,6 +20,7 @@
 #include <linux/iommu.h>
 #include <linux/irq.h>
 #include <linux/clk.h>
+#include <linux/workqueue.h>
 
 #include <linux/exynos_iovmm.h>
 
@@ -295,6 +296,20 @@ struct exynos_vm_region {
 	u32 dummy_size;
 };
 
+/*
+ * Freed iovm regions are kept allocated in the bitmap for a while, grouped by
+ * log2 of their size in pages, so that a map of the same size as a recent
+ * unmap does not search the bitmap.
+ */
+#define IOVM_CACHE_CLASSES	8
+#define IOVM_CACHE_DEPTH	8
+
+struct exynos_iovm_magazine {
+	u32 index[IOVM_CACHE_DEPTH];	/* first page of the region */
+	u32 vsize[IOVM_CACHE_DEPTH];	/* number of pages of the region */
+	unsigned int cnt;
+};
+
 struct exynos_iovmm {
 	struct iommu_domain *domain;	/* iommu domain for this iovmm */
 	size_t iovm_size;		/* iovm bitmap size per plane */
@@ -303,6 +318,19 @@ struct exynos_iovmm {
 	struct list_head regions_list;	/* list of exynos_vm_region */
 	spinlock_t vmlist_lock;		/* lock for updating regions_list */
 	spinlock_t bitmap_lock;		/* lock for manipulating bitmaps */
+	struct exynos_iovm_magazine cache[IOVM_CACHE_CLASSES];
+	spinlock_t cache_lock;		/* lock for the region cache */
+	unsigned int cache_hit;
+	unsigned int cache_miss;
+	/* unmapped regions waiting for one TLB invalidation together */
+	bool deferred_unmap;
+	struct list_head flush_list;
+	spinlock_t flush_lock;
+	unsigned int flush_cnt;
+	u32 flush_start;
+	u32 flush_end;
+	unsigned int num_flush;
+	struct delayed_work flush_work;
 	struct device *dev;	/* peripheral device that has this iovmm */
 	size_t allocated_size;
 	int num_areas;
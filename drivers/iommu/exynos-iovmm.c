@@ -26,6 +26,92 @@
 
 #define sg_physically_continuous(sg) (sg_next(sg) == NULL)
 
+/* a deferred TLB invalidation is done once this many regions are unmapped */
+#define IOVM_FLUSH_BATCH	16
+/* or this long after the first of them is unmapped */
+#define IOVM_FLUSH_DELAY_MS	4
+
+static bool iovm_flush_deferred(struct exynos_iovmm *vmm);
+
+static unsigned int iovm_cache_class(u32 vsize)
+{
+	/* vsize is not smaller than SZ_128K, 32 pages */
+	return min_t(unsigned int, fls(vsize >> 5) - 1, IOVM_CACHE_CLASSES - 1);
+}
+
+/* takes a cached region of exactly @vsize pages */
+static bool iovm_cache_get(struct exynos_iovmm *vmm, u32 vsize, u32 *index)
+{
+	struct exynos_iovm_magazine *mag = &vmm->cache[iovm_cache_class(vsize)];
+	unsigned int i;
+	bool found = false;
+
+	spin_lock(&vmm->cache_lock);
+	for (i = mag->cnt; i > 0; i--) {
+		if (mag->vsize[i - 1] != vsize)
+			continue;
+
+		*index = mag->index[i - 1];
+		mag->cnt--;
+		mag->index[i - 1] = mag->index[mag->cnt];
+		mag->vsize[i - 1] = mag->vsize[mag->cnt];
+		found = true;
+		break;
+	}
+
+	if (found)
+		vmm->cache_hit++;
+	else
+		vmm->cache_miss++;
+	spin_unlock(&vmm->cache_lock);
+
+	return found;
+}
+
+/* returns false if the magazine is full and the region should be freed */
+static bool iovm_cache_put(struct exynos_iovmm *vmm, u32 index, u32 vsize)
+{
+	struct exynos_iovm_magazine *mag = &vmm->cache[iovm_cache_class(vsize)];
+	bool cached = false;
+
+	spin_lock(&vmm->cache_lock);
+	if (mag->cnt < IOVM_CACHE_DEPTH) {
+		mag->index[mag->cnt] = index;
+		mag->vsize[mag->cnt] = vsize;
+		mag->cnt++;
+		cached = true;
+	}
+	spin_unlock(&vmm->cache_lock);
+
+	return cached;
+}
+
+/* returns the cached regions to the bitmap, and whether there were any */
+static bool iovm_cache_flush(struct exynos_iovmm *vmm)
+{
+	struct exynos_iovm_magazine cache[IOVM_CACHE_CLASSES];
+	unsigned int c, i;
+	bool flushed = false;
+
+	spin_lock(&vmm->cache_lock);
+	memcpy(cache, vmm->cache, sizeof(cache));
+	for (c = 0; c < IOVM_CACHE_CLASSES; c++)
+		vmm->cache[c].cnt = 0;
+	spin_unlock(&vmm->cache_lock);
+
+	spin_lock(&vmm->bitmap_lock);
+	for (c = 0; c < IOVM_CACHE_CLASSES; c++) {
+		for (i = 0; i < cache[c].cnt; i++) {
+			bitmap_clear(vmm->vm_map, cache[c].index[i],
+					cache[c].vsize[i]);
+			flushed = true;
+		}
+	}
+	spin_unlock(&vmm->bitmap_lock);
+
+	return flushed;
+}
+
 /* alloc_iovm_region - Allocate IO virtual memory region
  * vmm: virtual memory allocator
  * size: total size to allocate vm region from @vmm.
@@ -55,6 +141,7 @@ static dma_addr_t alloc_iovm_region(struct exynos_iovmm *vmm, size_t size,
 	unsigned long end, i;
 	struct exynos_vm_region *region;
 	size_t align = SZ_1M;
+	bool flushed = false;
 
 	BUG_ON(page_offset >= PAGE_SIZE);
 
@@ -63,6 +150,9 @@ static dma_addr_t alloc_iovm_region(struct exynos_iovmm *vmm, size_t size,
 	align >>= PAGE_SHIFT;
 	section_offset >>= PAGE_SHIFT;
 
+	if (iovm_cache_get(vmm, vsize, &index))
+		goto found;
+
 	spin_lock(&vmm->bitmap_lock);
 again:
 	index = find_next_zero_bit(vmm->vm_map,
@@ -70,10 +160,8 @@ again:
 
 	if (align) {
 		index = ALIGN(index, align);
-		if (index >= IOVM_NUM_PAGES(vmm->iovm_size)) {
-			spin_unlock(&vmm->bitmap_lock);
-			return 0;
-		}
+		if (index >= IOVM_NUM_PAGES(vmm->iovm_size))
+			goto nospace;
 
 		if (test_bit(index, vmm->vm_map))
 			goto again;
@@ -81,10 +169,8 @@ again:
 
 	end = index + vsize;
 
-	if (end >= IOVM_NUM_PAGES(vmm->iovm_size)) {
-		spin_unlock(&vmm->bitmap_lock);
-		return 0;
-	}
+	if (end >= IOVM_NUM_PAGES(vmm->iovm_size))
+		goto nospace;
 
 	i = find_next_bit(vmm->vm_map, end, index);
 	if (i < end) {
@@ -95,7 +181,7 @@ again:
 	bitmap_set(vmm->vm_map, index, vsize);
 
 	spin_unlock(&vmm->bitmap_lock);
-
+found:
 	vstart = (index << PAGE_SHIFT) + vmm->iova_start + page_offset;
 
 	region = kmalloc(sizeof(*region), GFP_KERNEL);
@@ -120,6 +206,19 @@ again:
 	spin_unlock(&vmm->vmlist_lock);
 
 	return region->start + region->section_off;
+
+nospace:
+	spin_unlock(&vmm->bitmap_lock);
+
+	/* the unflushed and cached regions may be what is in the way */
+	if (!flushed && (iovm_flush_deferred(vmm) | iovm_cache_flush(vmm))) {
+		flushed = true;
+		index = 0;
+		spin_lock(&vmm->bitmap_lock);
+		goto again;
+	}
+
+	return 0;
 }
 
 struct exynos_vm_region *find_iovm_region(struct exynos_iovmm *vmm,
@@ -168,14 +267,17 @@ static struct exynos_vm_region *remove_iovm_region(struct exynos_iovmm *vmm,
 static void free_iovm_region(struct exynos_iovmm *vmm,
 				struct exynos_vm_region *region)
 {
+	u32 index;
+
 	if (!region)
 		return;
 
-	spin_lock(&vmm->bitmap_lock);
-	bitmap_clear(vmm->vm_map,
-		(region->start - vmm->iova_start) >> PAGE_SHIFT,
-			region->size >> PAGE_SHIFT);
-	spin_unlock(&vmm->bitmap_lock);
+	index = (region->start - vmm->iova_start) >> PAGE_SHIFT;
+	if (!iovm_cache_put(vmm, index, region->size >> PAGE_SHIFT)) {
+		spin_lock(&vmm->bitmap_lock);
+		bitmap_clear(vmm->vm_map, index, region->size >> PAGE_SHIFT);
+		spin_unlock(&vmm->bitmap_lock);
+	}
 
 	SYSMMU_EVENT_LOG_IOVMM_UNMAP(IOVMM_TO_LOG(vmm),
 			region->start, region->start + region->size);
@@ -183,6 +285,94 @@ static void free_iovm_region(struct exynos_iovmm *vmm,
 	kfree(region);
 }
 
+/*
+ * Invalidates the TLB once for all the deferred regions and frees them. The
+ * regions are kept out of the allocator until then, so their iova cannot be
+ * mapped again while the System MMU may hold stale entries of them.
+ */
+static bool iovm_flush_deferred(struct exynos_iovmm *vmm)
+{
+	struct exynos_vm_region *region, *next;
+	LIST_HEAD(flush_list);
+	u32 start, end;
+
+	spin_lock(&vmm->flush_lock);
+	list_splice_init(&vmm->flush_list, &flush_list);
+	start = vmm->flush_start;
+	end = vmm->flush_end;
+	vmm->flush_cnt = 0;
+	spin_unlock(&vmm->flush_lock);
+
+	if (list_empty(&flush_list))
+		return false;
+
+	exynos_sysmmu_tlb_invalidate(vmm->domain, start, end - start);
+
+	/* TODO: for sysmmu v6, remove it later */
+	/* 60us is required to guarantee that PTW ends itself */
+	udelay(60);
+
+	list_for_each_entry_safe(region, next, &flush_list, node) {
+		list_del(&region->node);
+		free_iovm_region(vmm, region);
+	}
+
+	spin_lock(&vmm->vmlist_lock);
+	vmm->num_flush++;
+	spin_unlock(&vmm->vmlist_lock);
+
+	return true;
+}
+
+static void iovm_flush_work_fn(struct work_struct *work)
+{
+	struct exynos_iovmm *vmm = container_of(to_delayed_work(work),
+					struct exynos_iovmm, flush_work);
+
+	iovm_flush_deferred(vmm);
+}
+
+static void iovm_defer_free(struct exynos_iovmm *vmm,
+				struct exynos_vm_region *region)
+{
+	bool batch_full;
+
+	spin_lock(&vmm->flush_lock);
+	if (!vmm->flush_cnt) {
+		vmm->flush_start = region->start;
+		vmm->flush_end = region->start + region->size;
+	} else {
+		vmm->flush_start = min(vmm->flush_start, region->start);
+		vmm->flush_end = max(vmm->flush_end,
+					region->start + region->size);
+	}
+	list_add_tail(&region->node, &vmm->flush_list);
+	batch_full = ++vmm->flush_cnt >= IOVM_FLUSH_BATCH;
+	spin_unlock(&vmm->flush_lock);
+
+	if (batch_full)
+		iovm_flush_deferred(vmm);
+	else
+		schedule_delayed_work(&vmm->flush_work,
+				msecs_to_jiffies(IOVM_FLUSH_DELAY_MS));
+}
+
+void iovmm_set_deferred_unmap(struct device *dev, bool enable)
+{
+	struct exynos_iovmm *vmm = exynos_get_iovmm(dev);
+
+	if (!vmm) {
+		dev_err(dev, "%s: IOVMM not found\n", __func__);
+		return;
+	}
+
+	vmm->deferred_unmap = enable;
+	if (!enable) {
+		cancel_delayed_work_sync(&vmm->flush_work);
+		iovm_flush_deferred(vmm);
+	}
+}
+
 static dma_addr_t add_iovm_region(struct exynos_iovmm *vmm,
 					dma_addr_t start, size_t size)
 {
@@ -488,13 +678,18 @@ void iovmm_unmap(struct device *dev, dma_addr_t iova)
 			return;
 		}
 
-		exynos_sysmmu_tlb_invalidate(vmm->domain, region->start, region->size);
+		if (vmm->deferred_unmap) {
+			iovm_defer_free(vmm, region);
+		} else {
+			exynos_sysmmu_tlb_invalidate(vmm->domain,
+					region->start, region->size);
 
-		/* TODO: for sysmmu v6, remove it later */
-		/* 60us is required to guarantee that PTW ends itself */
-		udelay(60);
+			/* TODO: for sysmmu v6, remove it later */
+			/* 60us is required to guarantee that PTW ends itself */
+			udelay(60);
 
-		free_iovm_region(vmm, region);
+			free_iovm_region(vmm, region);
+		}
 
 		dev_dbg(dev, "IOVMM: Unmapped %#x bytes from %#x.\n",
 				(unsigned int)unmap_size, (unsigned int)iova);
@@ -650,6 +845,15 @@ static int iovmm_debug_show(struct seq_file *s, void *unused)
 	seq_printf(s, "Total number of unmappings: %d\n", vmm->num_unmap);
 	spin_unlock(&vmm->vmlist_lock);
 
+	spin_lock(&vmm->cache_lock);
+	seq_printf(s, "Region cache hit/miss     : %u/%u\n",
+			vmm->cache_hit, vmm->cache_miss);
+	spin_unlock(&vmm->cache_lock);
+
+	if (vmm->deferred_unmap)
+		seq_printf(s, "Deferred TLB flushes      : %u\n",
+				vmm->num_flush);
+
 	return 0;
 }
 
@@ -668,6 +872,10 @@ static ssize_t iovmm_debug_write(struct file *filp, const char __user *p,
 	vmm->num_map = 0;
 	vmm->num_unmap = 0;
 	spin_unlock(&vmm->vmlist_lock);
+	spin_lock(&vmm->cache_lock);
+	vmm->cache_hit = 0;
+	vmm->cache_miss = 0;
+	spin_unlock(&vmm->cache_lock);
 	return len;
 }
 
@@ -726,8 +934,12 @@ struct exynos_iovmm *exynos_create_single_iovmm(const char *name,
 
 	spin_lock_init(&vmm->vmlist_lock);
 	spin_lock_init(&vmm->bitmap_lock);
+	spin_lock_init(&vmm->cache_lock);
+	spin_lock_init(&vmm->flush_lock);
 
 	INIT_LIST_HEAD(&vmm->regions_list);
+	INIT_LIST_HEAD(&vmm->flush_list);
+	INIT_DELAYED_WORK(&vmm->flush_work, iovm_flush_work_fn);
 
 	vmm->domain_name = name;
 
@@ -349,6 +349,12 @@ struct cached_dev {
 
 	/* The rest of this all shows up in sysfs */
 	unsigned		sequential_cutoff;
+	/*
+	 * Reads get their own cutoff: when a slow device is cached, streaming
+	 * reads (e.g. executables mapped from it) are usually worth caching
+	 * while streaming writes are not.
+	 */
+	unsigned		read_sequential_cutoff;
 	unsigned		readahead;
 
 	unsigned		verify:1;
@@ -371,6 +371,9 @@ static bool check_should_bypass(struct cached_dev *dc, struct bio *bio)
 	struct cache_set *c = dc->disk.c;
 	unsigned mode = cache_mode(dc, bio);
 	unsigned sectors, congested = bch_get_congested(c);
+	unsigned cutoff = (bio->bi_rw & REQ_WRITE)
+		? dc->sequential_cutoff
+		: dc->read_sequential_cutoff;
 	struct task_struct *task = current;
 	struct io *i;
 
@@ -397,7 +400,7 @@ static bool check_should_bypass(struct cached_dev *dc, struct bio *bio)
 			goto rescale;
 	}
 
-	if (!congested && !dc->sequential_cutoff)
+	if (!congested && !cutoff)
 		goto rescale;
 
 	if (!congested &&
@@ -434,8 +437,8 @@ found:
 	sectors = max(task->sequential_io,
 		      task->sequential_io_avg) >> 9;
 
-	if (dc->sequential_cutoff &&
-	    sectors >= dc->sequential_cutoff >> 9) {
+	if (cutoff &&
+	    sectors >= cutoff >> 9) {
 		trace_bcache_bypass_sequential(bio);
 		goto skip;
 	}
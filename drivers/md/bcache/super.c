@@ -1129,6 +1129,7 @@ static int cached_dev_init(struct cached_dev *dc, unsigned block_size)
 	bch_cache_accounting_init(&dc->accounting, &dc->disk.cl);
 
 	dc->sequential_cutoff		= 4 << 20;
+	dc->read_sequential_cutoff	= 4 << 20;
 
 	for (io = dc->io; io < dc->io + RECENT_IO; io++) {
 		list_add(&io->lru, &dc->io_lru);
@@ -71,6 +71,7 @@ rw_attribute(congested_read_threshold_us);
 rw_attribute(congested_write_threshold_us);
 
 rw_attribute(sequential_cutoff);
+rw_attribute(read_sequential_cutoff);
 rw_attribute(data_csum);
 rw_attribute(cache_mode);
 rw_attribute(writeback_metadata);
@@ -170,6 +171,7 @@ SHOW(__bch_cached_dev)
 	var_printf(partial_stripes_expensive,	"%u");
 
 	var_hprint(sequential_cutoff);
+	var_hprint(read_sequential_cutoff);
 	var_hprint(readahead);
 
 	sysfs_print(running,		atomic_read(&dc->running));
@@ -218,6 +220,9 @@ STORE(__cached_dev)
 	sysfs_strtoul_clamp(sequential_cutoff,
 			    dc->sequential_cutoff,
 			    0, UINT_MAX);
+	sysfs_strtoul_clamp(read_sequential_cutoff,
+			    dc->read_sequential_cutoff,
+			    0, UINT_MAX);
 	d_strtoi_h(readahead);
 
 	if (attr == &sysfs_clear_stats)
@@ -330,6 +335,7 @@ static struct attribute *bch_cached_dev_files[] = {
 	&sysfs_stripe_size,
 	&sysfs_partial_stripes_expensive,
 	&sysfs_sequential_cutoff,
+	&sysfs_read_sequential_cutoff,
 	&sysfs_clear_stats,
 	&sysfs_running,
 	&sysfs_state,
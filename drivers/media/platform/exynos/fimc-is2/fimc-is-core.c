@@ -1433,6 +1433,7 @@ static int fimc_is_probe(struct platform_device *pdev)
 	return 0;
 
 p_err3:
+	fimc_is_groupmgr_remove(&core->groupmgr);
 	iounmap(core->regs);
 #if defined (ENABLE_IS_CORE) || defined (USE_MCUCTL)
 p_err2:
@@ -1445,6 +1446,11 @@ p_err1:
 
 static int fimc_is_remove(struct platform_device *pdev)
 {
+	struct fimc_is_core *core = platform_get_drvdata(pdev);
+
+	if (core)
+		fimc_is_groupmgr_remove(&core->groupmgr);
+
 	return 0;
 }
 
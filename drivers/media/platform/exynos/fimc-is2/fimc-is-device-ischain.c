@@ -3180,6 +3180,40 @@ int fimc_is_ischain_probe(struct fimc_is_device_ischain *device,
 	return ret;
 }
 
+/*
+ * Ramp the clocks up to the scenario of the planned stream config while the
+ * pipeline is still being set up, instead of waiting for stream on to find
+ * it from the real one. Stream on selects the static scenario again.
+ */
+void fimc_is_ischain_plan_dvfs(struct fimc_is_device_ischain *device)
+{
+#ifdef ENABLE_DVFS
+	struct fimc_is_dvfs_ctrl *dvfs_ctrl;
+	int scenario_id;
+
+	if (!device->stream_plan || !device->sensor)
+		return;
+
+	if (pm_qos_request_active(&device->user_qos) || !sysfs_debug.en_dvfs)
+		return;
+
+	dvfs_ctrl = &device->resourcemgr->dvfs_ctrl;
+	if (!test_bit(FIMC_IS_DVFS_SEL_TABLE, &dvfs_ctrl->state))
+		return;
+
+	mutex_lock(&dvfs_ctrl->lock);
+
+	scenario_id = fimc_is_dvfs_sel_plan(device);
+	if (scenario_id >= 0) {
+		minfo("[ISC:D] tbl[%d] planned scenario(%d)\n", device,
+			dvfs_ctrl->dvfs_table_idx, scenario_id);
+		fimc_is_set_dvfs((struct fimc_is_core *)device->interface->core, device, scenario_id);
+	}
+
+	mutex_unlock(&dvfs_ctrl->lock);
+#endif
+}
+
 static int fimc_is_ischain_open(struct fimc_is_device_ischain *device)
 {
 	struct fimc_is_minfo *minfo = NULL;
@@ -3217,6 +3251,7 @@ static int fimc_is_ischain_open(struct fimc_is_device_ischain *device)
 	device->sensor		= NULL;
 	device->module		= 0;
 	device->vid_to_vra	= 0;
+	device->stream_plan	= 0;
 
 #ifdef ENABLE_IS_CORE
 	offset_region = (FW_MEM_SIZE - ((device->instance + 1) * PARAM_REGION_SIZE));
@@ -3827,6 +3862,8 @@ static int fimc_is_ischain_start(struct fimc_is_device_ischain *device)
 		merr("fimc_is_dvfs_sel_table is fail(%d)", device, ret);
 		goto p_err;
 	}
+
+	fimc_is_ischain_plan_dvfs(device);
 #endif
 
 	set_bit(FIMC_IS_ISCHAIN_START, &device->state);
@@ -39,6 +39,17 @@
 #define MODULE_MASK			0x000000FF
 
 #define FIMC_IS_SETFILE_MASK		0x0000FFFF
+
+/*
+ * V4L2_CID_IS_S_STREAM_PLAN: the stream config the HAL is about to set up
+ * [31:24] output width / 16, [23:16] output height / 16,
+ * [9] recording, [8] hdr, [7:0] fps
+ */
+#define STREAM_PLAN_WIDTH(plan)		((((plan) >> 24) & 0xFF) << 4)
+#define STREAM_PLAN_HEIGHT(plan)	((((plan) >> 16) & 0xFF) << 4)
+#define STREAM_PLAN_RECORDING(plan)	(((plan) >> 9) & 0x1)
+#define STREAM_PLAN_HDR(plan)		(((plan) >> 8) & 0x1)
+#define STREAM_PLAN_FPS(plan)		((plan) & 0xFF)
 #define FIMC_IS_SCENARIO_MASK		0xFFFF0000
 #define FIMC_IS_SCENARIO_SHIFT		16
 #define FIMC_IS_ISP_CRANGE_MASK		0x0F000000
@@ -102,6 +113,7 @@ struct fimc_is_device_ischain {
 	atomic_t				init_cnt;
 
 	u32					setfile;
+	u32					stream_plan;
 
 	struct camera2_uctl			cur_peri_ctl;
 	struct camera2_uctl			peri_ctls[SENSOR_MAX_CTL];
@@ -167,6 +179,7 @@ int fimc_is_ischain_g_capability(struct fimc_is_device_ischain *this,
 void fimc_is_ischain_meta_invalid(struct fimc_is_frame *frame);
 
 int fimc_is_ischain_open_wrap(struct fimc_is_device_ischain *device, bool EOS);
+void fimc_is_ischain_plan_dvfs(struct fimc_is_device_ischain *device);
 int fimc_is_ischain_close_wrap(struct fimc_is_device_ischain *device);
 int fimc_is_ischain_start_wrap(struct fimc_is_device_ischain *device,
 	struct fimc_is_group *group);
@@ -224,6 +224,70 @@ int fimc_is_dvfs_sel_static(struct fimc_is_device_ischain *device)
 	return FIMC_IS_SN_DEFAULT;
 }
 
+/*
+ * The same static selection, but from the stream config the HAL planned
+ * through V4L2_CID_IS_S_STREAM_PLAN. Before the HAL sets the setfile, the
+ * planned recording and hdr bits stand in for its scenario.
+ */
+int fimc_is_dvfs_sel_plan(struct fimc_is_device_ischain *device)
+{
+	struct fimc_is_core *core;
+	struct fimc_is_dvfs_ctrl *dvfs_ctrl;
+	struct fimc_is_dvfs_scenario_ctrl *static_ctrl;
+	struct fimc_is_dvfs_scenario *scenarios;
+	int i, scenario_id, scenario_cnt;
+	int position, resol, fps, stream_cnt, hdr;
+	u32 plan, setfile;
+
+	BUG_ON(!device);
+	BUG_ON(!device->interface);
+
+	core = (struct fimc_is_core *)device->interface->core;
+	dvfs_ctrl = &(device->resourcemgr->dvfs_ctrl);
+	static_ctrl = dvfs_ctrl->static_ctrl;
+	plan = device->stream_plan;
+
+	if (!test_bit(FIMC_IS_DVFS_SEL_TABLE, &dvfs_ctrl->state))
+		return -EINVAL;
+
+	if (!static_ctrl || !static_ctrl->scenario_cnt || !device->sensor)
+		return -EINVAL;
+
+	scenarios = static_ctrl->scenarios;
+	scenario_cnt = static_ctrl->scenario_cnt;
+	position = fimc_is_sensor_g_position(device->sensor);
+	resol = STREAM_PLAN_WIDTH(plan) * STREAM_PLAN_HEIGHT(plan);
+	fps = STREAM_PLAN_FPS(plan);
+	stream_cnt = max(fimc_is_get_start_sensor_cnt(core), 1);
+	hdr = STREAM_PLAN_HDR(plan);
+
+	setfile = device->setfile;
+	if (!(setfile & FIMC_IS_SETFILE_MASK) && STREAM_PLAN_RECORDING(plan)) {
+		if (resol > SIZE_WHD)
+			device->setfile |= hdr ? ISS_SUB_SCENARIO_UHD_30FPS_WDR_ON :
+				ISS_SUB_SCENARIO_UHD_30FPS;
+		else
+			device->setfile |= hdr ? ISS_SUB_SCENARIO_VIDEO_WDR_ON :
+				ISS_SUB_SCENARIO_VIDEO;
+	}
+
+	scenario_id = FIMC_IS_SN_MAX;
+	for (i = 0; i < scenario_cnt; i++) {
+		if (!scenarios[i].check_func)
+			continue;
+
+		if ((scenarios[i].check_func(device, NULL, position, resol, fps,
+			stream_cnt, core->sensor_map, &core->dual_info)) > 0) {
+			scenario_id = scenarios[i].scenario_id;
+			break;
+		}
+	}
+
+	device->setfile = setfile;
+
+	return scenario_id;
+}
+
 int fimc_is_dvfs_sel_dynamic(struct fimc_is_device_ischain *device, struct fimc_is_group *group)
 {
 	int ret;
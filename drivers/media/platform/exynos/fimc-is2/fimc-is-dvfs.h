@@ -84,6 +84,7 @@ int fimc_is_get_target_resol(struct fimc_is_device_ischain *device);
 int fimc_is_dvfs_init(struct fimc_is_resourcemgr *resourcemgr);
 int fimc_is_dvfs_sel_table(struct fimc_is_resourcemgr *resourcemgr);
 int fimc_is_dvfs_sel_static(struct fimc_is_device_ischain *device);
+int fimc_is_dvfs_sel_plan(struct fimc_is_device_ischain *device);
 int fimc_is_dvfs_sel_dynamic(struct fimc_is_device_ischain *device, struct fimc_is_group *group);
 int fimc_is_dvfs_sel_external(struct fimc_is_device_sensor *device);
 int fimc_is_get_qos(struct fimc_is_core *core, u32 type, u32 scenario_id);
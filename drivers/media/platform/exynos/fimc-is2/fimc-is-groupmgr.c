@@ -29,6 +29,8 @@
 #include <linux/videodev2_exynos_camera.h>
 #include <linux/v4l2-mediabus.h>
 #include <linux/bug.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 
 #include "fimc-is-type.h"
 #include "fimc-is-core.h"
@@ -1082,6 +1084,109 @@ p_err:
 	return ret;
 }
 
+static const char * const latency_slot_name[GROUP_SLOT_MAX] = {
+	"SS", "3AA", "ISP", "DIS", "MCS", "VRA"
+};
+
+/*
+ * Records are written without a lock by the shot and done paths of each
+ * group; a record is recycled when a newer fcount lands on its slot.
+ */
+static struct fimc_is_latency_record *fimc_is_group_latency(struct fimc_is_groupmgr *groupmgr,
+	struct fimc_is_group *group, u32 fcount)
+{
+	struct fimc_is_latency_record *rec;
+
+	if (unlikely(group->instance >= FIMC_IS_STREAM_COUNT ||
+		group->slot >= GROUP_SLOT_MAX))
+		return NULL;
+
+	rec = &groupmgr->latency[group->instance][fcount % FIMC_IS_LATENCY_RECORDS];
+	if (rec->fcount != fcount) {
+		memset(rec, 0, sizeof(*rec));
+		rec->fcount = fcount;
+	}
+
+	return rec;
+}
+
+static void fimc_is_group_latency_shot(struct fimc_is_groupmgr *groupmgr,
+	struct fimc_is_group *group, struct fimc_is_frame *frame)
+{
+	struct fimc_is_latency_record *rec;
+
+	rec = fimc_is_group_latency(groupmgr, group, frame->fcount);
+	if (rec)
+		rec->shot[group->slot] = fimc_is_get_timestamp();
+}
+
+static void fimc_is_group_latency_done(struct fimc_is_groupmgr *groupmgr,
+	struct fimc_is_group *group, struct fimc_is_frame *frame)
+{
+	struct fimc_is_device_sensor *sensor = group->device->sensor;
+	struct fimc_is_latency_record *rec;
+
+	rec = fimc_is_group_latency(groupmgr, group, frame->fcount);
+	if (!rec)
+		return;
+
+	rec->done[group->slot] = fimc_is_get_timestamp();
+	if (!rec->vsync && sensor)
+		rec->vsync = sensor->timestamp[frame->fcount % FIMC_IS_TIMESTAMP_HASH_KEY];
+}
+
+#ifdef ENABLE_DBG_FS
+/*
+ * One line per frame: the shot and done time of each group in us,
+ * relative to the sensor frame start.
+ */
+static int fimc_is_groupmgr_latency_show(struct seq_file *s, void *unused)
+{
+	struct fimc_is_groupmgr *groupmgr = s->private;
+	struct fimc_is_latency_record rec;
+	u32 stream, i, slot;
+	u64 base;
+
+	for (stream = 0; stream < FIMC_IS_STREAM_COUNT; stream++) {
+		for (i = 0; i < FIMC_IS_LATENCY_RECORDS; i++) {
+			/* a copy, the record may be recycled meanwhile */
+			rec = groupmgr->latency[stream][i];
+			if (!rec.fcount)
+				continue;
+
+			base = rec.vsync;
+			for (slot = 0; !base && slot < GROUP_SLOT_MAX; slot++)
+				base = rec.shot[slot];
+
+			seq_printf(s, "[%d][F%d]", stream, rec.fcount);
+			for (slot = 0; slot < GROUP_SLOT_MAX; slot++) {
+				if (!rec.shot[slot] && !rec.done[slot])
+					continue;
+
+				seq_printf(s, " %s %lld/%lld", latency_slot_name[slot],
+					rec.shot[slot] ? div_s64((s64)(rec.shot[slot] - base), 1000) : -1,
+					rec.done[slot] ? div_s64((s64)(rec.done[slot] - base), 1000) : -1);
+			}
+			seq_puts(s, "\n");
+		}
+	}
+
+	return 0;
+}
+
+static int fimc_is_groupmgr_latency_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, fimc_is_groupmgr_latency_show, inode->i_private);
+}
+
+static const struct file_operations latency_fops = {
+	.open		= fimc_is_groupmgr_latency_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+#endif
+
 int fimc_is_groupmgr_probe(struct fimc_is_groupmgr *groupmgr)
 {
 	int ret = 0;
@@ -1113,10 +1218,24 @@ int fimc_is_groupmgr_probe(struct fimc_is_groupmgr *groupmgr)
 		}
 	}
 
+	memset(groupmgr->latency, 0, sizeof(groupmgr->latency));
+#ifdef ENABLE_DBG_FS
+	groupmgr->latency_file = debugfs_create_file("latency", S_IRUSR,
+		fimc_is_debug.root, groupmgr, &latency_fops);
+#endif
+
 p_err:
 	return ret;
 }
 
+void fimc_is_groupmgr_remove(struct fimc_is_groupmgr *groupmgr)
+{
+#ifdef ENABLE_DBG_FS
+	debugfs_remove_recursive(groupmgr->latency_file);
+	groupmgr->latency_file = NULL;
+#endif
+}
+
 int fimc_is_groupmgr_init(struct fimc_is_groupmgr *groupmgr,
 	struct fimc_is_device_ischain *device)
 {
@@ -3038,6 +3157,7 @@ p_skip_sync:
 		}
 	}
 
+	fimc_is_group_latency_shot(groupmgr, group, frame);
 	fimc_is_itf_grp_shot(device, group, frame);
 	atomic_inc(&group->scount);
 
@@ -3112,6 +3232,8 @@ int fimc_is_group_done(struct fimc_is_groupmgr *groupmgr,
 	fimc_is_group_debug_aa_done(group, frame);
 #endif
 
+	fimc_is_group_latency_done(groupmgr, group, frame);
+
 	/* sensor tagging */
 	if (test_bit(FIMC_IS_GROUP_OTF_INPUT, &group->state))
 		fimc_is_sensor_dm_tag(device->sensor, frame);
@@ -222,14 +222,28 @@ struct fimc_is_group_task {
 #endif
 };
 
+/* per frame latency trace, a ring indexed by fcount */
+#define FIMC_IS_LATENCY_RECORDS		64
+
+struct fimc_is_latency_record {
+	u32				fcount;
+	u64				vsync; /* sensor frame start */
+	u64				shot[GROUP_SLOT_MAX];
+	u64				done[GROUP_SLOT_MAX];
+};
+
 struct fimc_is_groupmgr {
 	struct fimc_is_group_framemgr	gframemgr[FIMC_IS_STREAM_COUNT];
 	struct fimc_is_group		*leader[FIMC_IS_STREAM_COUNT];
 	struct fimc_is_group		*group[FIMC_IS_STREAM_COUNT][GROUP_SLOT_MAX];
 	struct fimc_is_group_task	gtask[GROUP_ID_MAX];
+
+	struct fimc_is_latency_record	latency[FIMC_IS_STREAM_COUNT][FIMC_IS_LATENCY_RECORDS];
+	struct dentry			*latency_file;
 };
 
 int fimc_is_groupmgr_probe(struct fimc_is_groupmgr *groupmgr);
+void fimc_is_groupmgr_remove(struct fimc_is_groupmgr *groupmgr);
 int fimc_is_groupmgr_init(struct fimc_is_groupmgr *groupmgr,
 	struct fimc_is_device_ischain *device);
 int fimc_is_groupmgr_start(struct fimc_is_groupmgr *groupmgr,
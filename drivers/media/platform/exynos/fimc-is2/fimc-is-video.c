@@ -1676,6 +1676,14 @@ int fimc_is_video_s_ctrl(struct file *file,
 		}
 		resourcemgr->hal_version = ctrl->value;
 		break;
+	case V4L2_CID_IS_S_STREAM_PLAN:
+		device->stream_plan = ctrl->value;
+		mvinfo("stream plan : %d x %d @%d rec(%d) hdr(%d)\n", vctx, video,
+			STREAM_PLAN_WIDTH(ctrl->value), STREAM_PLAN_HEIGHT(ctrl->value),
+			STREAM_PLAN_FPS(ctrl->value), STREAM_PLAN_RECORDING(ctrl->value),
+			STREAM_PLAN_HDR(ctrl->value));
+		fimc_is_ischain_plan_dvfs(device);
+		break;
 	case V4L2_CID_IS_DEBUG_DUMP:
 		info("Print fimc-is info dump by HAL");
 		fimc_is_resource_dump();
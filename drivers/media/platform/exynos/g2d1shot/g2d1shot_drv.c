@@ -192,6 +192,11 @@ static void g2d1shot_request_bts_performance(struct g2d1shot_dev *g2d_dev,
 	if (list_empty(&g2d_ctx->qos_node) && !rbw && !wbw)
 		return;
 
+	/* back-to-back jobs of a batch usually repeat the same request */
+	if (!list_empty(&g2d_ctx->qos_node) &&
+			(g2d_ctx->r_bw == rbw) && (g2d_ctx->w_bw == wbw))
+		return;
+
 	mutex_lock(&g2d_dev->lock_qos);
 
 	if (!list_empty(&g2d_dev->qos_contexts)) {
@@ -860,6 +865,34 @@ static int disable_g2d(struct g2d1shot_dev *g2d_dev)
 	return 0;
 }
 
+static bool g2d1shot_has_pending_context(struct g2d1shot_dev *g2d_dev)
+{
+	struct m2m1shot2_device *m21dev = g2d_dev->oneshot2_dev;
+	unsigned long flags;
+	bool pending;
+
+	spin_lock_irqsave(&m21dev->lock_ctx, flags);
+	pending = !list_empty(&m21dev->active_contexts);
+	spin_unlock_irqrestore(&m21dev->lock_ctx, flags);
+
+	return pending;
+}
+
+/* drop the power kept for a next job that did not take it over */
+static void g2d1shot_put_held_power(struct g2d1shot_dev *g2d_dev)
+{
+	unsigned long flags;
+	bool held;
+
+	spin_lock_irqsave(&g2d_dev->state_lock, flags);
+	held = g2d_dev->state & G2D_STATE_POWER_HELD;
+	g2d_dev->state &= ~G2D_STATE_POWER_HELD;
+	spin_unlock_irqrestore(&g2d_dev->state_lock, flags);
+
+	if (held)
+		disable_g2d(g2d_dev);
+}
+
 static void g2d_set_source(struct g2d1shot_dev *g2d_dev,
 		struct m2m1shot2_context *ctx,
 		struct m2m1shot2_source_image *source, int layer_num)
@@ -995,7 +1028,8 @@ static int m2m1shot2_g2d_device_run(struct m2m1shot2_context *ctx)
 	struct g2d1shot_ctx *g2d_ctx = ctx->priv;
 	struct g2d1shot_dev *g2d_dev = g2d_ctx->g2d_dev;
 	unsigned long flags;
-	int ret;
+	bool held;
+	int ret = 0;
 	int i;
 
 	g2d_dbg_begin();
@@ -1006,11 +1040,15 @@ static int m2m1shot2_g2d_device_run(struct m2m1shot2_context *ctx)
 		spin_unlock_irqrestore(&g2d_dev->state_lock, flags);
 		return -EAGAIN;
 	}
+	/* take over the power left on by the previous job of the batch */
+	held = g2d_dev->state & G2D_STATE_POWER_HELD;
+	g2d_dev->state &= ~G2D_STATE_POWER_HELD;
 	g2d_dev->state |= G2D_STATE_RUNNING;
 	spin_unlock_irqrestore(&g2d_dev->state_lock, flags);
 
 	/* enable power, clock */
-	ret = enable_g2d(g2d_dev);
+	if (!held)
+		ret = enable_g2d(g2d_dev);
 	if (ret) {
 		spin_lock_irqsave(&g2d_dev->state_lock, flags);
 		g2d_dev->state &= ~G2D_STATE_RUNNING;
@@ -1084,7 +1122,7 @@ static irqreturn_t exynos_g2d_irq_handler(int irq, void *priv)
 	struct g2d1shot_dev *g2d_dev = priv;
 	struct m2m1shot2_context *m21ctx;
 	unsigned long flags;
-	bool suspending;
+	bool suspending, pending;
 	unsigned long long t_stop;
 	bool status = true;
 	u32 irqpend;
@@ -1140,12 +1178,23 @@ static irqreturn_t exynos_g2d_irq_handler(int irq, void *priv)
 	}
 
 	g2d_disable_secure(g2d_dev, m21ctx);
-	disable_g2d(g2d_dev);
+
+	/*
+	 * When more jobs are queued, the next one is started right from
+	 * m2m1shot2_finish_context() below. Keep power and clock on for it
+	 * so that a batch of small blits doesn't toggle them per job.
+	 */
+	pending = !suspending && g2d1shot_has_pending_context(g2d_dev);
 
 	spin_lock_irqsave(&g2d_dev->state_lock, flags);
 	g2d_dev->state &= ~G2D_STATE_RUNNING;
+	if (pending)
+		g2d_dev->state |= G2D_STATE_POWER_HELD;
 	spin_unlock_irqrestore(&g2d_dev->state_lock, flags);
 
+	if (!pending)
+		disable_g2d(g2d_dev);
+
 	m21ctx->work_delay_in_nsec = t_stop - g2d_dev->t_start;
 	if (g2d_debug == DBG_PERF) {
 		g2d_info("G2D_operation time = %llu.%06llu ms\n",
@@ -1159,6 +1208,9 @@ static irqreturn_t exynos_g2d_irq_handler(int irq, void *priv)
 		g2d_dev->suspend_ctx_success = true;
 	}
 
+	if (pending)
+		g2d1shot_put_held_power(g2d_dev);
+
 	wake_up(&g2d_dev->suspend_wait);
 
 	g2d_dbg_end();
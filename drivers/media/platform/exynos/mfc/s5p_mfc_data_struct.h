@@ -479,6 +479,8 @@ struct s5p_mfc_dev {
 #ifdef CONFIG_MFC_USE_BUS_DEVFREQ
 	struct list_head qos_queue;
 	atomic_t qos_req_cur;
+	unsigned int qos_cur_int;
+	unsigned int qos_cur_mif;
 	struct pm_qos_request qos_req_int;
 	struct pm_qos_request qos_req_mif;
 #ifdef CONFIG_ARM_EXYNOS_MP_CPUFREQ
@@ -1093,6 +1095,9 @@ struct s5p_mfc_ctx {
 	int qos_ratio;
 	int framerate;
 	int last_framerate;
+	ktime_t sched_deadline;
+	int nal_q_inflight;
+	int nal_q_throttled;
 
 	struct mfc_timestamp ts_array[MFC_TIME_INDEX];
 	struct list_head ts_list;
@@ -685,6 +685,7 @@ int s5p_mfc_just_run(struct s5p_mfc_dev *dev, int new_ctx_index)
 
 	mfc_debug(2, "New context: %d\n", new_ctx_index);
 	dev->curr_ctx = ctx->num;
+	s5p_mfc_sched_advance(ctx);
 
 	/* Got context to run in ctx */
 	mfc_debug(2, "src: %d, dst: %d, state: %d, dpb_count = %d\n",
@@ -51,12 +51,21 @@ int s5p_mfc_nal_q_check_enable(struct s5p_mfc_dev *dev)
 				mfc_debug(2, "There is a drm ctx. Can't start NAL-Q\n");
 				return 0;
 			}
-			/* NAL-Q can be enabled when all ctx are in running state */
+			/*
+			 * A ctx which is not in running state needs the command
+			 * path only once it has work, until then the others can
+			 * keep sharing the queue.
+			 */
 			if (temp_ctx->state != MFCINST_RUNNING &&
 					temp_ctx->state != MFCINST_RUNNING_NO_OUTPUT) {
-				mfc_debug(2, "There is a ctx which is not in running state. "
+				if (test_bit(i, &dev->work_bits.bits)) {
+					mfc_debug(2, "There is a ctx which is not in running state. "
+							"index: %d, state: %d\n", i, temp_ctx->state);
+					return 0;
+				}
+				mfc_debug(2, "Idle ctx is not in running state. "
 						"index: %d, state: %d\n", i, temp_ctx->state);
-				return 0;
+				continue;
 			}
 			/* NAL-Q can't use the command about last frame */
 			if (s5p_mfc_is_last_frame(temp_ctx) == 1) {
@@ -109,6 +118,35 @@ int s5p_mfc_nal_q_check_enable(struct s5p_mfc_dev *dev)
 	return 1;
 }
 
+/*
+ * The firmware has a single in/out queue pair, every ctx gets an equal
+ * share of its slots so that one instance can't fill it and the
+ * firmware keeps interleaving all of them.
+ */
+int s5p_mfc_nal_q_ctx_has_room(struct s5p_mfc_ctx *ctx)
+{
+	struct s5p_mfc_dev *dev = ctx->dev;
+	int i, running = 0;
+
+	for (i = 0; i < MFC_NUM_CONTEXTS; i++) {
+		if (dev->ctx[i] && (dev->ctx[i]->state == MFCINST_RUNNING ||
+				dev->ctx[i]->state == MFCINST_RUNNING_NO_OUTPUT))
+			running++;
+	}
+
+	if (running <= 1)
+		return 1;
+
+	if (ctx->nal_q_inflight < max(NAL_Q_IN_QUEUE_SIZE / running, 1))
+		return 1;
+
+	mfc_debug(2, "NAL Q: ctx %d used its share (%d in flight, %d running)\n",
+			ctx->num, ctx->nal_q_inflight, running);
+	ctx->nal_q_throttled = 1;
+
+	return 0;
+}
+
 static int mfc_nal_q_find_ctx(struct s5p_mfc_dev *dev, EncoderOutputStr *pOutputStr)
 {
 	int i;
@@ -473,6 +511,8 @@ void s5p_mfc_nal_q_cleanup_queue(struct s5p_mfc_dev *dev)
 		ctx = dev->ctx[i];
 		if (ctx) {
 			s5p_mfc_cleanup_nal_queue(ctx);
+			ctx->nal_q_inflight = 0;
+			ctx->nal_q_throttled = 0;
 			if (s5p_mfc_ctx_ready(ctx)) {
 				s5p_mfc_set_bit(ctx->num, &dev->work_bits);
 				mfc_debug(2, "NAL Q: set work_bits after cleanup,"
@@ -1459,6 +1499,13 @@ int s5p_mfc_nal_q_handle_out_buf(struct s5p_mfc_dev *dev, EncoderOutputStr *pOut
 		mfc_nal_q_handle_frame(ctx, (DecoderOutputStr *)pOutStr);
 	}
 
+	/* The slot it was waiting for is free now */
+	if (ctx->nal_q_throttled) {
+		ctx->nal_q_throttled = 0;
+		if (s5p_mfc_is_work_to_do(dev))
+			queue_work(dev->butler_wq, &dev->butler_work);
+	}
+
 	mfc_debug_leave();
 
 	return 0;
@@ -1540,6 +1587,7 @@ int s5p_mfc_nal_q_enqueue_in_buf(struct s5p_mfc_dev *dev, struct s5p_mfc_ctx *ct
 		printk("...\n");
 	}
 	input_count++;
+	ctx->nal_q_inflight++;
 
 	s5p_mfc_update_nal_queue_input_count(dev, input_count);
 
@@ -1615,6 +1663,8 @@ EncoderOutputStr *s5p_mfc_nal_q_dequeue_out_buf(struct s5p_mfc_dev *dev,
 	}
 
 	ctx = dev->ctx[nal_q_out_handle->nal_q_ctx];
+	if (ctx->nal_q_inflight > 0)
+		ctx->nal_q_inflight--;
 	if (nal_q_dump == 1) {
 		mfc_err_dev("[NAL-Q][DUMP][%s OUTPUT][c: %d] diff: %d, count: %d, exe: %d\n",
 				ctx->type == MFCINST_ENCODER ? "ENC" : "DEC",
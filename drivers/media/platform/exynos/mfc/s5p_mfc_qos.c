@@ -23,71 +23,74 @@ enum {
 	MFC_QOS_BW,
 };
 
-static void mfc_qos_operate(struct s5p_mfc_ctx *ctx, int opr_type, int idx)
+static void mfc_qos_operate(struct s5p_mfc_ctx *ctx, int opr_type, int idx,
+		struct s5p_mfc_qos *req)
 {
 	struct s5p_mfc_dev *dev = ctx->dev;
-	struct s5p_mfc_platdata *pdata = dev->pdata;
-	struct s5p_mfc_qos *qos_table = pdata->qos_table;
 
 	switch (opr_type) {
 	case MFC_QOS_ADD:
 		MFC_TRACE_CTX("++ QOS add[%d] (int:%d, mif:%d)\n",
-			idx, qos_table[idx].freq_int, qos_table[idx].freq_mif);
+			idx, req->freq_int, req->freq_mif);
 
 		pm_qos_add_request(&dev->qos_req_int,
 				PM_QOS_DEVICE_THROUGHPUT,
-				qos_table[idx].freq_int);
+				req->freq_int);
 		pm_qos_add_request(&dev->qos_req_mif,
 				PM_QOS_BUS_THROUGHPUT,
-				qos_table[idx].freq_mif);
+				req->freq_mif);
 
 #ifdef CONFIG_ARM_EXYNOS_MP_CPUFREQ
 		pm_qos_add_request(&dev->qos_req_cluster1,
 				PM_QOS_CLUSTER1_FREQ_MIN,
-				qos_table[idx].freq_cpu);
+				req->freq_cpu);
 		pm_qos_add_request(&dev->qos_req_cluster0,
 				PM_QOS_CLUSTER0_FREQ_MIN,
-				qos_table[idx].freq_kfc);
+				req->freq_kfc);
 #endif
 
 		if (ctx->type == MFCINST_DECODER)
-			bts_update_scen(BS_MFC_UHD_10BIT, qos_table[idx].mo_10bit_value);
-		bts_update_scen(BS_MFC_UHD, qos_table[idx].mo_value);
+			bts_update_scen(BS_MFC_UHD_10BIT, req->mo_10bit_value);
+		bts_update_scen(BS_MFC_UHD, req->mo_value);
 
 		atomic_set(&dev->qos_req_cur, idx + 1);
+		dev->qos_cur_int = req->freq_int;
+		dev->qos_cur_mif = req->freq_mif;
 		MFC_TRACE_CTX("-- QOS add[%d] (int:%d, mif:%d, mo:%d, mo_10bit:%d)\n",
-				idx, qos_table[idx].freq_int, qos_table[idx].freq_mif,
-				qos_table[idx].mo_value, qos_table[idx].mo_10bit_value);
+				idx, req->freq_int, req->freq_mif,
+				req->mo_value, req->mo_10bit_value);
 		mfc_debug(2, "QOS add[%d] (int:%d, mif:%d, mo:%d, mo_10bit:%d)\n",
-				idx, qos_table[idx].freq_int, qos_table[idx].freq_mif,
-				qos_table[idx].mo_value, qos_table[idx].mo_10bit_value);
+				idx, req->freq_int, req->freq_mif,
+				req->mo_value, req->mo_10bit_value);
 		break;
 	case MFC_QOS_UPDATE:
 		MFC_TRACE_CTX("++ QOS update[%d] (int:%d, mif:%d)\n",
-				idx, qos_table[idx].freq_int, qos_table[idx].freq_mif);
+				idx, req->freq_int, req->freq_mif);
 
 		pm_qos_update_request(&dev->qos_req_int,
-				qos_table[idx].freq_int);
+				req->freq_int);
 		pm_qos_update_request(&dev->qos_req_mif,
-				qos_table[idx].freq_mif);
+				req->freq_mif);
 
 #ifdef CONFIG_ARM_EXYNOS_MP_CPUFREQ
 		pm_qos_update_request(&dev->qos_req_cluster1,
-				qos_table[idx].freq_cpu);
+				req->freq_cpu);
 		pm_qos_update_request(&dev->qos_req_cluster0,
-				qos_table[idx].freq_kfc);
+				req->freq_kfc);
 #endif
 		if (ctx->type == MFCINST_DECODER)
-			bts_update_scen(BS_MFC_UHD_10BIT, qos_table[idx].mo_10bit_value);
-		bts_update_scen(BS_MFC_UHD, qos_table[idx].mo_value);
+			bts_update_scen(BS_MFC_UHD_10BIT, req->mo_10bit_value);
+		bts_update_scen(BS_MFC_UHD, req->mo_value);
 
 		atomic_set(&dev->qos_req_cur, idx + 1);
+		dev->qos_cur_int = req->freq_int;
+		dev->qos_cur_mif = req->freq_mif;
 		MFC_TRACE_CTX("-- QOS update[%d] (int:%d, mif:%d, mo:%d, mo_10bit:%d)\n",
-				idx, qos_table[idx].freq_int, qos_table[idx].freq_mif,
-				qos_table[idx].mo_value, qos_table[idx].mo_10bit_value);
+				idx, req->freq_int, req->freq_mif,
+				req->mo_value, req->mo_10bit_value);
 		mfc_debug(2, "QOS update[%d] (int:%d, mif:%d, mo:%d, mo_10bit:%d)\n",
-				idx, qos_table[idx].freq_int, qos_table[idx].freq_mif,
-				qos_table[idx].mo_value, qos_table[idx].mo_10bit_value);
+				idx, req->freq_int, req->freq_mif,
+				req->mo_value, req->mo_10bit_value);
 		break;
 	case MFC_QOS_REMOVE:
 		MFC_TRACE_CTX("++ QOS remove\n");
@@ -110,6 +113,8 @@ static void mfc_qos_operate(struct s5p_mfc_ctx *ctx, int opr_type, int idx)
 		bts_update_bw(BTS_BW_MFC, dev->mfc_bw);
 
 		atomic_set(&dev->qos_req_cur, 0);
+		dev->qos_cur_int = 0;
+		dev->qos_cur_mif = 0;
 		MFC_TRACE_CTX("-- QOS remove\n");
 		mfc_debug(2, "QoS remove\n");
 		break;
@@ -130,11 +135,59 @@ static void mfc_qos_operate(struct s5p_mfc_ctx *ctx, int opr_type, int idx)
 	}
 }
 
-static void mfc_qos_set(struct s5p_mfc_ctx *ctx, struct bts_bw *mfc_bw, int i)
+static inline unsigned int mfc_qos_lerp(unsigned int lo, unsigned int hi,
+		unsigned long num, unsigned long den)
+{
+	if (hi <= lo)
+		return hi;
+
+	return lo + (unsigned int)div64_u64((u64)(hi - lo) * num, den);
+}
+
+/*
+ * A qos step is sized for the top of its mb range, so a load inside the
+ * range gets INT/MIF interpolated from the step below. The MIF request
+ * is also kept above what the estimated bandwidth needs, but never above
+ * the step itself.
+ */
+static void mfc_qos_get_request(struct s5p_mfc_ctx *ctx, struct bts_bw *mfc_bw,
+		int i, unsigned long total_mb, struct s5p_mfc_qos *req)
+{
+	struct s5p_mfc_platdata *pdata = ctx->dev->pdata;
+	struct s5p_mfc_qos *qos_table = pdata->qos_table;
+	unsigned long lo_mb, hi_mb;
+	unsigned int mif_bw;
+
+	*req = qos_table[i];
+	if (i == 0)
+		return;
+
+	lo_mb = qos_table[i].threshold_mb;
+	hi_mb = (i == pdata->num_qos_steps - 1) ?
+			pdata->max_mb : qos_table[i + 1].threshold_mb;
+	if (total_mb <= lo_mb || total_mb >= hi_mb)
+		return;
+
+	req->freq_int = mfc_qos_lerp(qos_table[i - 1].freq_int,
+			qos_table[i].freq_int, total_mb - lo_mb, hi_mb - lo_mb);
+	req->freq_mif = mfc_qos_lerp(qos_table[i - 1].freq_mif,
+			qos_table[i].freq_mif, total_mb - lo_mb, hi_mb - lo_mb);
+
+	/* KB/s over bytes per MIF cycle gives kHz */
+	mif_bw = (mfc_bw->read + mfc_bw->write) / MFC_QOS_MIF_BYTES_PER_CYCLE;
+	req->freq_mif = min(max(req->freq_mif, mif_bw), qos_table[i].freq_mif);
+
+	mfc_debug(2, "QoS table[%d] interpolated mb %ld (int:%d, mif:%d, bw mif:%d)\n",
+			i, total_mb, req->freq_int, req->freq_mif, mif_bw);
+}
+
+static void mfc_qos_set(struct s5p_mfc_ctx *ctx, struct bts_bw *mfc_bw, int i,
+		unsigned long total_mb)
 {
 	struct s5p_mfc_dev *dev = ctx->dev;
 	struct s5p_mfc_platdata *pdata = dev->pdata;
 	struct s5p_mfc_qos *qos_table = pdata->qos_table;
+	struct s5p_mfc_qos req;
 
 	mfc_debug(2, "QoS table[%d] covered mb %d ~ %d (int:%d, mif:%d)\n",
 			i, qos_table[i].threshold_mb,
@@ -146,13 +199,17 @@ static void mfc_qos_set(struct s5p_mfc_ctx *ctx, struct bts_bw *mfc_bw, int i)
 		dev->mfc_bw.peak = mfc_bw->peak;
 		dev->mfc_bw.read = mfc_bw->read;
 		dev->mfc_bw.write = mfc_bw->write;
-		mfc_qos_operate(ctx, MFC_QOS_BW, i);
+		mfc_qos_operate(ctx, MFC_QOS_BW, i, NULL);
 	}
 
+	mfc_qos_get_request(ctx, mfc_bw, i, total_mb, &req);
+
 	if (atomic_read(&dev->qos_req_cur) == 0)
-		mfc_qos_operate(ctx, MFC_QOS_ADD, i);
-	else if (atomic_read(&dev->qos_req_cur) != (i + 1))
-		mfc_qos_operate(ctx, MFC_QOS_UPDATE, i);
+		mfc_qos_operate(ctx, MFC_QOS_ADD, i, &req);
+	else if (atomic_read(&dev->qos_req_cur) != (i + 1) ||
+			dev->qos_cur_int != req.freq_int ||
+			dev->qos_cur_mif != req.freq_mif)
+		mfc_qos_operate(ctx, MFC_QOS_UPDATE, i, &req);
 }
 
 static inline unsigned long mfc_qos_get_weighted_mb(struct s5p_mfc_ctx *ctx,
@@ -335,6 +392,13 @@ static void mfc_qos_get_bw_per_second(struct s5p_mfc_ctx *ctx, struct bts_bw *mf
 	read_bw_per_sec = (bw_data.read * mb) / mb_count_per_uhd_frame;
 	write_bw_per_sec = (bw_data.write * mb) / mb_count_per_uhd_frame;
 
+	/* The table covers the frame traffic, add the stream (bps to KB/s) */
+	if (ctx->type == MFCINST_ENCODER && ctx->enc_priv) {
+		struct s5p_mfc_enc *enc = ctx->enc_priv;
+
+		write_bw_per_sec += enc->params.rc_bitrate / 8000;
+	}
+
 	if (peak_bw_per_sec == 0) {
 		mfc_debug(2, "fix lower peak bound (mb: %ld, fps: %ld)\n", mb, fps);
 		peak_bw_per_sec = MIN_BW_PER_SEC;
@@ -405,7 +469,7 @@ void s5p_mfc_qos_on(struct s5p_mfc_ctx *ctx)
 	if (total_mb > pdata->max_mb)
 		mfc_debug(4, "QoS overspec mb %ld > %d\n", total_mb, pdata->max_mb);
 
-	mfc_qos_set(ctx, &mfc_bw, i);
+	mfc_qos_set(ctx, &mfc_bw, i, total_mb);
 }
 
 void s5p_mfc_qos_off(struct s5p_mfc_ctx *ctx)
@@ -422,7 +486,7 @@ void s5p_mfc_qos_off(struct s5p_mfc_ctx *ctx)
 	if (list_empty(&dev->qos_queue)) {
 		if (atomic_read(&dev->qos_req_cur) != 0) {
 			mfc_err_ctx("MFC request count is wrong!\n");
-			mfc_qos_operate(ctx, MFC_QOS_REMOVE, 0);
+			mfc_qos_operate(ctx, MFC_QOS_REMOVE, 0, NULL);
 		}
 		return;
 	}
@@ -470,9 +534,9 @@ void s5p_mfc_qos_off(struct s5p_mfc_ctx *ctx)
 		list_del(&ctx->qos_list);
 
 	if (list_empty(&dev->qos_queue) || total_mb == 0)
-		mfc_qos_operate(ctx, MFC_QOS_REMOVE, 0);
+		mfc_qos_operate(ctx, MFC_QOS_REMOVE, 0, NULL);
 	else
-		mfc_qos_set(ctx, &mfc_bw, i);
+		mfc_qos_set(ctx, &mfc_bw, i, total_mb);
 }
 #endif
 
@@ -27,6 +27,9 @@
 
 #define MFC_DRV_TIME		1000
 
+/* Effective bytes the MIF moves per cycle, for the bandwidth based floor */
+#define MFC_QOS_MIF_BYTES_PER_CYCLE	8
+
 #define MFC_QOS_WEIGHT_3PLANE		80
 #define MFC_QOS_WEIGHT_OTHER_CODEC	25
 #define MFC_QOS_WEIGHT_10BIT		75
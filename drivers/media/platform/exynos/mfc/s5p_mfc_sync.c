@@ -13,6 +13,7 @@
 #include "s5p_mfc_sync.h"
 
 #include "s5p_mfc_queue.h"
+#include "s5p_mfc_nal_q.h"
 
 #define R2H_BIT(x)	(((x) > 0) ? (1 << ((x) - 1)) : 0)
 
@@ -125,11 +126,89 @@ void s5p_mfc_wake_up_ctx(struct s5p_mfc_ctx *ctx, unsigned int reason,
 	wake_up(&ctx->cmd_wq);
 }
 
+/* Used when a context has no framerate yet, in 1/1000 fps like ctx->framerate */
+#define MFC_SCHED_DEFAULT_FPS	30000
+
+static inline s64 mfc_sched_period_ns(struct s5p_mfc_ctx *ctx)
+{
+	int fps = ctx->framerate > 0 ? ctx->framerate : MFC_SCHED_DEFAULT_FPS;
+
+	return div_s64(NSEC_PER_SEC * 1000LL, fps);
+}
+
+/*
+ * Called when a context is given the hardware: its next frame is due one
+ * frame interval later. A context that stayed idle for longer than an
+ * interval restarts from now, so it can't bank credit while sleeping.
+ */
+void s5p_mfc_sched_advance(struct s5p_mfc_ctx *ctx)
+{
+	s64 period = mfc_sched_period_ns(ctx);
+	ktime_t now = ktime_get();
+
+	if (ktime_before(ktime_add_ns(ctx->sched_deadline, period), now))
+		ctx->sched_deadline = now;
+	ctx->sched_deadline = ktime_add_ns(ctx->sched_deadline, period);
+
+	mfc_debug(2, "[c:%d] next deadline %lld (period %lld ns)\n", ctx->num,
+			ktime_to_ns(ctx->sched_deadline), period);
+}
+
+/*
+ * Should be called with work_bits.lock
+ *
+ * Earliest deadline first among the contexts with work. The scan starts
+ * after the current context so equal deadlines stay round-robin. On NAL-Q
+ * the current context keeps the queue on a tie, but not ahead of an
+ * earlier deadline.
+ */
+static int mfc_sched_pick_ctx(struct s5p_mfc_dev *dev)
+{
+	struct s5p_mfc_ctx *ctx;
+	int index = -EAGAIN;
+	ktime_t deadline = ktime_set(0, 0);
+	int i, num;
+
+#ifdef NAL_Q_ENABLE
+	int nal_q = dev->nal_q_handle &&
+		dev->nal_q_handle->nal_q_state == NAL_Q_STATE_STARTED;
+
+	/* Repeated submissions of the current context stay on NAL-Q */
+	if (nal_q && test_bit(dev->curr_ctx, &dev->work_bits.bits) &&
+	    dev->ctx[dev->curr_ctx] &&
+	    s5p_mfc_nal_q_ctx_has_room(dev->ctx[dev->curr_ctx])) {
+		index = dev->curr_ctx;
+		deadline = dev->ctx[index]->sched_deadline;
+	}
+#endif
+
+	for (i = 1; i <= MFC_NUM_CONTEXTS; i++) {
+		num = (dev->curr_ctx + i) % MFC_NUM_CONTEXTS;
+		if (!test_bit(num, &dev->work_bits.bits))
+			continue;
+
+		ctx = dev->ctx[num];
+		if (!ctx)
+			continue;
+#ifdef NAL_Q_ENABLE
+		/* Waits for its own output, the queue serves the others */
+		if (nal_q && !s5p_mfc_nal_q_ctx_has_room(ctx))
+			continue;
+#endif
+
+		if (index < 0 || ktime_before(ctx->sched_deadline, deadline)) {
+			index = num;
+			deadline = ctx->sched_deadline;
+		}
+	}
+
+	return index;
+}
+
 int s5p_mfc_get_new_ctx(struct s5p_mfc_dev *dev)
 {
 	unsigned long wflags;
 	int new_ctx_index = 0;
-	int cnt = 0;
 
 	if (!dev) {
 		mfc_err_dev("no mfc device to run\n");
@@ -145,16 +224,13 @@ int s5p_mfc_get_new_ctx(struct s5p_mfc_dev *dev)
 		new_ctx_index = dev->preempt_ctx;
 		mfc_debug(2, "preempt_ctx is : %d\n", new_ctx_index);
 	} else {
-		new_ctx_index = (dev->curr_ctx + 1) % MFC_NUM_CONTEXTS;
-		while (!test_bit(new_ctx_index, &dev->work_bits.bits)) {
-			new_ctx_index = (new_ctx_index + 1) % MFC_NUM_CONTEXTS;
-			cnt++;
-			if (cnt > MFC_NUM_CONTEXTS) {
-				/* No contexts to run */
-				spin_unlock_irqrestore(&dev->work_bits.lock, wflags);
-				return -EAGAIN;
-			}
+		new_ctx_index = mfc_sched_pick_ctx(dev);
+		if (new_ctx_index < 0) {
+			/* No contexts to run */
+			spin_unlock_irqrestore(&dev->work_bits.lock, wflags);
+			return -EAGAIN;
 		}
+		mfc_debug(2, "EDF picked ctx %d\n", new_ctx_index);
 	}
 
 	spin_unlock_irqrestore(&dev->work_bits.lock, wflags);
@@ -49,6 +49,18 @@ module_param_named(sc_set_blur, sc_set_blur, uint, 0644);
 int __measure_hw_latency;
 module_param_named(measure_hw_latency, __measure_hw_latency, int, 0644);
 
+/*
+ * If not zero, jobs taller than this many destination lines are processed
+ * in stripes of that height and other contexts waiting for the scaler run
+ * between the stripes. It bounds the latency a small job sees behind a
+ * large one at the cost of an IRQ per stripe.
+ */
+unsigned int sc_stripe_lines;
+module_param_named(stripe_lines, sc_stripe_lines, uint, 0644);
+
+/* source lines above a stripe fed to the vertical filter */
+#define SC_STRIPE_OVERLAP	4
+
 struct vb2_sc_buffer {
 	struct v4l2_m2m_buffer mb;
 	struct sc_ctx *ctx;
@@ -2310,6 +2322,7 @@ static void sc_watchdog(unsigned long arg)
 		spin_unlock_irqrestore(&sc->ctxlist_lock, flags);
 
 		BUG_ON(!ctx);
+		clear_bit(CTX_STRIPE, &ctx->flags);
 		sc_job_finish(sc, ctx);
 		sc_clk_power_disable(sc);
 		return;
@@ -2499,6 +2512,97 @@ static void sc_set_initial_phase(struct sc_ctx *ctx)
 	sc_hwset_src_init_phase(sc, &ctx->init_phase);
 }
 
+static int sc_run_next_job(struct sc_dev *sc);
+
+static bool sc_stripe_possible(struct sc_dev *sc, struct sc_ctx *ctx)
+{
+	if (!sc_stripe_lines || !sc->variant->ratio_20bit ||
+			!sc->variant->initphase)
+		return false;
+
+	if (ctx->i_frame || ctx->flip_rot_cfg ||
+			ctx->pre_h_ratio || ctx->pre_v_ratio ||
+			ctx->init_phase.yv || ctx->init_phase.h)
+		return false;
+
+	return ctx->d_frame.crop.height > ALIGN(sc_stripe_lines, 16);
+}
+
+/*
+ * Narrows the job to the destination lines of the current stripe. The
+ * source window starts a few lines above the stripe and the integer part
+ * of the initial phase skips them so that the vertical filter still sees
+ * the real neighbours at the stripe boundary.
+ */
+static void sc_set_stripe(struct sc_dev *sc, struct sc_ctx *ctx)
+{
+	struct sc_frame *s_frame = &ctx->s_frame;
+	struct sc_frame *d_frame = &ctx->d_frame;
+	unsigned int h_shift = s_frame->sc_fmt->h_shift;
+	unsigned int v_shift = s_frame->sc_fmt->v_shift;
+	unsigned int top = ctx->stripe_top;
+	unsigned int lines, src_top;
+	u64 pos;
+	u32 yphase;
+
+	lines = min(d_frame->crop.height - top, ctx->stripe_lines);
+
+	pos = (u64)top * ctx->v_ratio;
+	src_top = (unsigned int)(pos >> 20);
+	src_top = (src_top > SC_STRIPE_OVERLAP) ?
+				src_top - SC_STRIPE_OVERLAP : 0;
+	src_top = round_down(src_top, 1 << v_shift);
+	yphase = (u32)(pos - ((u64)src_top << 20));
+
+	sc_hwset_src_pos(sc, s_frame->crop.left, s_frame->crop.top + src_top,
+			h_shift, v_shift);
+	sc_hwset_src_wh(sc, s_frame->crop.width,
+			s_frame->crop.height - src_top, 0, 0, h_shift, v_shift);
+
+	sc_hwset_dst_pos(sc, d_frame->crop.left, d_frame->crop.top + top);
+	sc_hwset_dst_wh(sc, d_frame->crop.width, lines);
+
+	sc_hwset_src_vinit_phase(sc, yphase, yphase >> v_shift);
+}
+
+/*
+ * Puts the context back to the queue after a stripe so that the other
+ * contexts waiting for the scaler have their turn before the next stripe.
+ */
+static bool sc_yield_stripe(struct sc_dev *sc, struct sc_ctx *ctx)
+{
+	if (!test_bit(CTX_STRIPE, &ctx->flags))
+		return false;
+
+	ctx->stripe_top += ctx->stripe_lines;
+	if (ctx->stripe_top >= ctx->d_frame.crop.height) {
+		clear_bit(CTX_STRIPE, &ctx->flags);
+		return false;
+	}
+
+	del_timer(&sc->wdt.timer);
+
+#ifdef CONFIG_EXYNOS_CONTENT_PATH_PROTECTION
+	if (test_bit(DEV_CP, &sc->state)) {
+		sc_ctrl_protection(sc, ctx, false);
+		clear_bit(DEV_CP, &sc->state);
+	}
+#endif
+	clear_bit(DEV_RUN, &sc->state);
+
+	/* CTX_RUN stays set: the job of the context is still in flight */
+	spin_lock(&sc->ctxlist_lock);
+	sc->current_ctx = NULL;
+	list_add_tail(&ctx->node, &sc->context_list);
+	spin_unlock(&sc->ctxlist_lock);
+
+	sc_run_next_job(sc);
+
+	sc_clk_power_disable(sc);
+
+	return true;
+}
+
 static int sc_run_next_job(struct sc_dev *sc)
 {
 	unsigned long flags;
@@ -2575,6 +2679,12 @@ static int sc_run_next_job(struct sc_dev *sc)
 	s_frame = &ctx->s_frame;
 	d_frame = &ctx->d_frame;
 
+	if (!test_bit(CTX_STRIPE, &ctx->flags) && sc_stripe_possible(sc, ctx)) {
+		ctx->stripe_top = 0;
+		ctx->stripe_lines = ALIGN(sc_stripe_lines, 16);
+		set_bit(CTX_STRIPE, &ctx->flags);
+	}
+
 	sc_hwset_init(sc);
 
 	if (ctx->i_frame) {
@@ -2649,6 +2759,9 @@ static int sc_run_next_job(struct sc_dev *sc)
 	if (sc->variant->initphase)
 		sc_set_initial_phase(ctx);
 
+	if (test_bit(CTX_STRIPE, &ctx->flags))
+		sc_set_stripe(sc, ctx);
+
 	sc_hwset_src_addr(sc, &s_frame->addr);
 	sc_hwset_dst_addr(sc, &d_frame->addr);
 
@@ -2668,7 +2781,8 @@ static int sc_run_next_job(struct sc_dev *sc)
 
 	mod_timer(&sc->wdt.timer, jiffies + SC_TIMEOUT);
 
-	if (__measure_hw_latency) {
+	if (__measure_hw_latency &&
+		(!test_bit(CTX_STRIPE, &ctx->flags) || !ctx->stripe_top)) {
 		if (ctx->context_type == SC_CTX_V4L2_TYPE) {
 			struct vb2_v4l2_buffer *vb =
 					v4l2_m2m_next_dst_buf(ctx->m2m_ctx);
@@ -2732,6 +2846,9 @@ static irqreturn_t sc_irq_handler(int irq, void *priv)
 	if (SCALER_INT_OK(irq_status) && sc_process_2nd_stage(sc, ctx))
 		goto isr_unlock;
 
+	if (SCALER_INT_OK(irq_status) && sc_yield_stripe(sc, ctx))
+		goto isr_unlock;
+
 	del_timer(&sc->wdt.timer);
 
 #ifdef CONFIG_EXYNOS_CONTENT_PATH_PROTECTION
@@ -2745,6 +2862,7 @@ static irqreturn_t sc_irq_handler(int irq, void *priv)
 
 	clear_bit(DEV_RUN, &sc->state);
 	clear_bit(CTX_RUN, &ctx->flags);
+	clear_bit(CTX_STRIPE, &ctx->flags);
 
 	if (ctx->context_type == SC_CTX_V4L2_TYPE) {
 		BUG_ON(ctx != v4l2_m2m_get_curr_priv(sc->m2m.m2m_dev));
@@ -324,6 +324,13 @@ static inline void sc_hwset_src_init_phase(struct sc_dev *sc, struct sc_init_pha
 	}
 }
 
+/* raw vertical phases with the integer part in [23:20] */
+static inline void sc_hwset_src_vinit_phase(struct sc_dev *sc, u32 yv, u32 cv)
+{
+	__raw_writel(yv & 0xffffff, sc->regs + SCALER_SRC_YV_INIT_PHASE);
+	__raw_writel(cv & 0xffffff, sc->regs + SCALER_SRC_CV_INIT_PHASE);
+}
+
 void sc_hwset_polyphase_hcoef(struct sc_dev *sc,
 		unsigned int yratio, unsigned int cratio, unsigned int filter);
 void sc_hwset_polyphase_vcoef(struct sc_dev *sc,
@@ -70,6 +70,7 @@ extern int sc_log_level;
 #define CTX_DST_FMT	6
 #define CTX_INT_FRAME	7 /* intermediate frame available */
 #define CTX_INT_FRAME_CP 8 /* intermediate frame available */
+#define CTX_STRIPE	9 /* job is processed in stripes */
 
 
 /* CSC equation */
@@ -488,6 +489,8 @@ struct sc_ctx {
 	struct sc_csc			csc;
 	struct sc_init_phase		init_phase;
 	struct sc_dnoise_filter		dnoise_ft;
+	unsigned int			stripe_top;
+	unsigned int			stripe_lines;
 };
 
 static inline struct sc_frame *ctx_get_frame(struct sc_ctx *ctx,
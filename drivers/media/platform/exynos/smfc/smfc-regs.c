@@ -123,13 +123,31 @@ static inline u32 smfc_calc_quantizers(unsigned int idx, unsigned int factor,
 }
 #pragma GCC diagnostic pop
 
-static void smfc_hwconfigure_qtable(void __iomem *reg, unsigned int factor,
-				    const u8 table[])
+/*
+ * Writes the luma and chroma quantizers scaled by @factor. The scaled values
+ * are kept in @ctx, and the following frames with the same factor only
+ * copy them to H/W.
+ */
+static void smfc_hwconfigure_qtable(struct smfc_ctx *ctx, int slot,
+				    void __iomem *reg, unsigned int factor)
 {
+	u32 (*quants)[SMFC_MCU_SIZE / 4] = ctx->quantizers[slot];
 	size_t i;
 
-	for (i = 0; i < SMFC_MCU_SIZE; i += 4)
-		__raw_writel(smfc_calc_quantizers(i, factor, table), reg + i);
+	if (ctx->quantizers_factor[slot] != factor) {
+		for (i = 0; i < SMFC_MCU_SIZE; i += 4) {
+			quants[0][i / 4] = smfc_calc_quantizers(i, factor,
+							default_luma_qtbl);
+			quants[1][i / 4] = smfc_calc_quantizers(i, factor,
+							default_chroma_qtbl);
+		}
+		ctx->quantizers_factor[slot] = factor;
+	}
+
+	for (i = 0; i < SMFC_MCU_SIZE; i += 4) {
+		__raw_writel(quants[0][i / 4], reg + i);
+		__raw_writel(quants[1][i / 4], reg + SMFC_MCU_SIZE + i);
+	}
 }
 
 static void smfc_hwconfigure_custom_qtable(void __iomem *reg, const u8 table[])
@@ -155,10 +173,7 @@ void smfc_hwconfigure_tables(struct smfc_ctx *ctx,
 
 	if (qfactor > 0) {
 		qfactor = (qfactor < 50) ? 5000 / qfactor : 200 - qfactor * 2;
-		smfc_hwconfigure_qtable(base + REG_QTBL_BASE,
-					qfactor, default_luma_qtbl);
-		smfc_hwconfigure_qtable(base + REG_QTBL_BASE + SMFC_MCU_SIZE,
-					qfactor, default_chroma_qtbl);
+		smfc_hwconfigure_qtable(ctx, 0, base + REG_QTBL_BASE, qfactor);
 	} else {
 		smfc_hwconfigure_custom_qtable(base + REG_QTBL_BASE, qtbl);
 		smfc_hwconfigure_custom_qtable(
@@ -201,32 +216,31 @@ void smfc_hwconfigure_2nd_tables(struct smfc_ctx *ctx, unsigned int qfactor)
 	void __iomem *qtblbase = base + REG_QTBL_BASE + SMFC_MCU_SIZE * 2;
 	qfactor = (qfactor < 50) ? 5000 / qfactor : 200 - qfactor * 2;
 
-	smfc_hwconfigure_qtable(qtblbase, qfactor, default_luma_qtbl);
-	smfc_hwconfigure_qtable(qtblbase + SMFC_MCU_SIZE,
-				qfactor, default_chroma_qtbl);
+	smfc_hwconfigure_qtable(ctx, 1, qtblbase, qfactor);
 	/* Huffman table for the secondary image is the same as the main image */
 	__raw_writel(VAL_SEC_TABLE_SELECT, base + REG_SEC_TABLE_SELECT);
 	__raw_writel(SMFC_DHT_LEN, base + REG_SEC_DHT_LEN);
 }
 
-void smfc_hwconfigure_tables_for_decompression(struct smfc_ctx *ctx)
+void smfc_hwconfigure_tables_for_decompression(struct smfc_ctx *ctx,
+				const struct smfc_stream_header *hdr)
 {
 	void __iomem *base = ctx->smfc->reg;
 	void __iomem *qtbl_base = ctx->smfc->reg + REG_QTBL_BASE;
-	u32 tblsel = ctx->num_components << 16;
+	u32 tblsel = hdr->num_components << 16;
 	int i;
 
 	/* Huffman table selector configuration */
-	for (i = 0; i < ctx->num_components; i++) {
-		u32 val = (ctx->huffman_tables->compsel[i].idx_dc |
-			(ctx->huffman_tables->compsel[i].idx_ac << 1)) & 3;
+	for (i = 0; i < hdr->num_components; i++) {
+		u32 val = (hdr->huffman_tables.compsel[i].idx_dc |
+			(hdr->huffman_tables.compsel[i].idx_ac << 1)) & 3;
 		tblsel |= val << (i * 2 + 4);
 	}
 
 	/* quantization table configuration */
-	for (i = 0; i < ctx->num_components; i++) {
-		if (ctx->quantizer_tables->compsel[i] != INVALID_QTBLIDX) {
-			u8 *table = ctx->quantizer_tables->table[i];
+	for (i = 0; i < hdr->num_components; i++) {
+		if (hdr->quantizer_tables.compsel[i] != INVALID_QTBLIDX) {
+			const u8 *table = hdr->quantizer_tables.table[i];
 			int j;
 
 			for (j = 0; j < SMFC_MCU_SIZE; j += 4) {
@@ -240,30 +254,30 @@ void smfc_hwconfigure_tables_for_decompression(struct smfc_ctx *ctx)
 					qtbl_base + SMFC_MCU_SIZE * i + j);
 			}
 			/* quantization table selector */
-			tblsel |= ctx->quantizer_tables->compsel[i] << (i * 2);
+			tblsel |= hdr->quantizer_tables.compsel[i] << (i * 2);
 		}
 	}
 
 	/* Huffman table configuration */
 	for (i = 0; i < 4; i++) {
-		__raw_writel(ctx->huffman_tables->dc[0].code32[i],
+		__raw_writel(hdr->huffman_tables.dc[0].code32[i],
 				base + REG_HTBL_LUMA_DCLEN + i * sizeof(u32));
-		__raw_writel(ctx->huffman_tables->dc[0].value32[i],
+		__raw_writel(hdr->huffman_tables.dc[0].value32[i],
 				base + REG_HTBL_LUMA_DCVAL + i * sizeof(u32));
-		__raw_writel(ctx->huffman_tables->dc[1].code32[i],
+		__raw_writel(hdr->huffman_tables.dc[1].code32[i],
 				base + REG_HTBL_CHROMA_DCLEN + i * sizeof(u32));
-		__raw_writel(ctx->huffman_tables->dc[1].value32[i],
+		__raw_writel(hdr->huffman_tables.dc[1].value32[i],
 				base + REG_HTBL_CHROMA_DCVAL + i * sizeof(u32));
-		__raw_writel(ctx->huffman_tables->ac[0].code32[i],
+		__raw_writel(hdr->huffman_tables.ac[0].code32[i],
 				base + REG_HTBL_LUMA_ACLEN + i * sizeof(u32));
-		__raw_writel(ctx->huffman_tables->ac[1].code32[i],
+		__raw_writel(hdr->huffman_tables.ac[1].code32[i],
 				base + REG_HTBL_CHROMA_ACLEN + i * sizeof(u32));
 	}
 
 	for (i = 0; i < (SMFC_NUM_AC_HVAL / 4); i++) {
-		__raw_writel(ctx->huffman_tables->ac[0].value32[i],
+		__raw_writel(hdr->huffman_tables.ac[0].value32[i],
 				base + REG_HTBL_LUMA_ACVAL + i * sizeof(u32));
-		__raw_writel(ctx->huffman_tables->ac[1].value32[i],
+		__raw_writel(hdr->huffman_tables.ac[1].value32[i],
 				base + REG_HTBL_CHROMA_ACVAL + i * sizeof(u32));
 	}
 
@@ -386,6 +400,7 @@ void smfc_hwconfigure_image(struct smfc_ctx *ctx,
 {
 	struct vb2_buffer *vb2buf_img, *vb2buf_jpg;
 	u32 stream_address;
+	u32 offset_of_sos = 0;
 	u32 format = ctx->img_fmt->regcfg;
 	unsigned char num_plane = ctx->img_fmt->num_planes;
 	u32 burstlen = 1 << ctx->smfc->devdata->burstlenth_bits;
@@ -397,6 +412,7 @@ void smfc_hwconfigure_image(struct smfc_ctx *ctx,
 
 		vb2buf_img = v4l2_m2m_next_dst_buf(ctx->fh.m2m_ctx);
 		vb2buf_jpg = v4l2_m2m_next_src_buf(ctx->fh.m2m_ctx);
+		offset_of_sos = vb2_to_smfc_buffer(vb2buf_jpg)->hdr.offset_of_sos;
 		format |= smfc_get_jpeg_format(hfactor, vfactor);
 	} else {
 		__raw_writel(ctx->crop.width | (ctx->crop.height << 16),
@@ -425,11 +441,11 @@ void smfc_hwconfigure_image(struct smfc_ctx *ctx,
 	smfc_hwconfigure_image_base(ctx, vb2buf_img, false);
 	__raw_writel(format, ctx->smfc->reg + REG_MAIN_IMAGE_FORMAT);
 	stream_address = smfc_hwconfigure_jpeg_base(ctx, vb2buf_jpg,
-						    ctx->offset_of_sos, false);
+						    offset_of_sos, false);
 	if (!(ctx->flags & SMFC_CTX_COMPRESS)) {
 		u32 streamsize = vb2_plane_size(vb2buf_jpg, 0);
 
-		streamsize -= ctx->offset_of_sos;
+		streamsize -= offset_of_sos;
 		streamsize += stream_address & SMFC_ADDR_ALIGN_MASK(burstlen);
 		streamsize = ALIGN(streamsize, burstlen);
 		streamsize >>= ctx->smfc->devdata->burstlenth_bits;
@@ -441,3 +441,16 @@ int smfc_parse_jpeg_header(struct smfc_ctx *ctx, struct vb2_buffer *vb)
 
 	return -EINVAL;
 }
+
+void smfc_save_stream_header(struct smfc_ctx *ctx,
+			     struct smfc_stream_header *hdr)
+{
+	hdr->quantizer_tables = *ctx->quantizer_tables;
+	hdr->huffman_tables = *ctx->huffman_tables;
+	hdr->stream_hfactor = ctx->stream_hfactor;
+	hdr->stream_vfactor = ctx->stream_vfactor;
+	hdr->num_components = ctx->num_components;
+	hdr->offset_of_sos = ctx->offset_of_sos;
+	hdr->stream_width = ctx->stream_width;
+	hdr->stream_height = ctx->stream_height;
+}
@@ -280,6 +280,9 @@ static int smfc_vb2_buf_prepare(struct vb2_buffer *vb)
 
 			if (ret != 0)
 				return ret;
+
+			smfc_save_stream_header(ctx,
+					&vb2_to_smfc_buffer(vb)->hdr);
 		}
 	} else {
 		/*
@@ -381,7 +384,7 @@ static int smfc_queue_init(void *priv, struct vb2_queue *src_vq,
 	src_vq->ops = &smfc_vb2_ops;
 	src_vq->mem_ops = &vb2_ion_memops;
 	src_vq->drv_priv = ctx;
-	src_vq->buf_struct_size = sizeof(struct v4l2_m2m_buffer);
+	src_vq->buf_struct_size = sizeof(struct smfc_buffer);
 	src_vq->timestamp_flags = V4L2_BUF_FLAG_TIMESTAMP_COPY;
 	src_vq->lock = &ctx->smfc->video_device_mutex;
 
@@ -435,6 +438,9 @@ static int exynos_smfc_open(struct file *filp)
 	}
 
 	ctx->smfc = smfc;
+	/* no quantizers are computed yet */
+	ctx->quantizers_factor[0] = UINT_MAX;
+	ctx->quantizers_factor[1] = UINT_MAX;
 
 	v4l2_fh_init(&ctx->fh, smfc->videodev);
 
@@ -599,8 +605,16 @@ static void smfc_m2m_device_run(void *priv)
 			smfc_hwconfigure_2nd_image(ctx, !!enable_hwfc);
 		}
 	} else {
-		if ((ctx->stream_width != ctx->width) ||
-				(ctx->stream_height != ctx->height)) {
+		struct vb2_buffer *vb = v4l2_m2m_next_src_buf(ctx->fh.m2m_ctx);
+		/*
+		 * The stream may not be the one parsed last, and the header in
+		 * ctx may be rewritten by a buffer being queued meanwhile.
+		 */
+		const struct smfc_stream_header *hdr =
+					&vb2_to_smfc_buffer(vb)->hdr;
+
+		if ((hdr->stream_width != ctx->width) ||
+				(hdr->stream_height != ctx->height)) {
 			dev_err(ctx->smfc->dev,
 				"Downscaling on decompression not allowed\n");
 			/* It is okay to abort after reset */
@@ -608,8 +622,8 @@ static void smfc_m2m_device_run(void *priv)
 		}
 
 		smfc_hwconfigure_image(ctx,
-				ctx->stream_hfactor, ctx->stream_vfactor);
-		smfc_hwconfigure_tables_for_decompression(ctx);
+				hdr->stream_hfactor, hdr->stream_vfactor);
+		smfc_hwconfigure_tables_for_decompression(ctx, hdr);
 	}
 
 	spin_lock_irqsave(&ctx->smfc->flag_lock, flags);
@@ -156,6 +156,31 @@ struct smfc_decomp_qtable {
 	char compsel[SMFC_MAX_QTBL_COUNT];
 };
 
+/*
+ * The stream header is parsed when a buffer to decompress is prepared and is
+ * kept with the buffer so that several JPEG streams can be queued at once.
+ */
+struct smfc_stream_header {
+	struct smfc_decomp_qtable quantizer_tables;
+	struct smfc_decomp_htable huffman_tables;
+	unsigned char stream_hfactor;
+	unsigned char stream_vfactor;
+	unsigned char num_components;
+	unsigned int offset_of_sos;
+	__u16 stream_width;
+	__u16 stream_height;
+};
+
+struct smfc_buffer {
+	struct v4l2_m2m_buffer mb;
+	struct smfc_stream_header hdr;
+};
+
+static inline struct smfc_buffer *vb2_to_smfc_buffer(struct vb2_buffer *vb)
+{
+	return container_of(to_vb2_v4l2_buffer(vb), struct smfc_buffer, mb.vb);
+}
+
 struct smfc_crop {
 	u32 width;
 	u32 height;
@@ -192,6 +217,12 @@ struct smfc_ctx {
 	__u32 thumb_height;
 	unsigned char thumb_quality_factor;
 	unsigned char enable_hwfc;
+	/*
+	 * quantizers of the last quality factors of the main image and the
+	 * thumbnail. They are reused by the following frames of a burst.
+	 */
+	u32 quantizers[2][2][SMFC_MCU_SIZE / 4];
+	unsigned int quantizers_factor[2];
 
 	/* Decompression settings */
 	struct smfc_decomp_qtable *quantizer_tables;
@@ -227,11 +258,14 @@ static inline bool smfc_is_compressed_type(struct smfc_ctx *ctx, __u32 type)
 int smfc_init_controls(struct smfc_dev *smfc, struct v4l2_ctrl_handler *hdlr);
 
 int smfc_parse_jpeg_header(struct smfc_ctx *ctx, struct vb2_buffer *vb);
+void smfc_save_stream_header(struct smfc_ctx *ctx,
+			     struct smfc_stream_header *hdr);
 
 /* H/W Configuration */
 void smfc_hwconfigure_tables(struct smfc_ctx *ctx,
 			     unsigned int qfactor, const u8 qtbl[]);
-void smfc_hwconfigure_tables_for_decompression(struct smfc_ctx *ctx);
+void smfc_hwconfigure_tables_for_decompression(struct smfc_ctx *ctx,
+				const struct smfc_stream_header *hdr);
 void smfc_hwconfigure_image(struct smfc_ctx *ctx,
 			    unsigned int hfactor, unsigned int vfactor);
 void smfc_hwconfigure_start(struct smfc_ctx *ctx,
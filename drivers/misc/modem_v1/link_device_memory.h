@@ -178,6 +178,7 @@ struct mem_ipc_device {
 #ifdef GROUP_MEM_FLOW_CONTROL
 #define MAX_SKB_TXQ_DEPTH		1024
 #define TX_PERIOD_MS			1	/* 1 ms */
+#define TX_BATCH_FRAMES			32
 #define MAX_TX_BUSY_COUNT		1024
 #define BUSY_COUNT_MASK			0xF
 
@@ -493,6 +494,10 @@ struct mem_link_device {
 	struct dentry *dbgfs_frame;
 #endif
 	unsigned int tx_period_ms;
+	/* Frames queued at the end of a burst that ring the doorbell early */
+	unsigned int tx_batch;
+	unsigned long tx_frame_count;
+	unsigned long tx_doorbell_count;
 	unsigned int force_use_memcpy;
 	unsigned int memcpy_packet_count;
 	unsigned int zeromemcpy_packet_count;
@@ -316,8 +316,11 @@ static inline void start_tx_timer(struct mem_link_device *mld,
 		goto exit;
 
 	if (!hrtimer_is_queued(timer)) {
-		ktime_t ktime = ktime_set(0, ms2ns(TX_PERIOD_MS));
-		hrtimer_start(timer, ktime, HRTIMER_MODE_REL);
+		u64 period = ms2ns(TX_PERIOD_MS);
+
+		/* let the TX batch ride along with a nearby wakeup */
+		hrtimer_start_range_ns(timer, ns_to_ktime(period), period >> 2,
+				       HRTIMER_MODE_REL);
 	}
 
 exit:
@@ -41,6 +41,7 @@
 #endif
 
 #include <trace/events/napi.h>
+#include <net/busy_poll.h>
 #include "modem_prj.h"
 #include "modem_utils.h"
 #include "link_device_memory.h"
@@ -810,14 +811,36 @@ static inline void start_tx_timer(struct mem_link_device *mld,
 		goto exit;
 
 	if (!hrtimer_is_queued(timer)) {
-		ktime_t ktime = ktime_set(0, mld->tx_period_ms * NSEC_PER_MSEC);
-		hrtimer_start(timer, ktime, HRTIMER_MODE_REL);
+		u64 period = mld->tx_period_ms * NSEC_PER_MSEC;
+
+		/* let the TX batch ride along with a nearby wakeup */
+		hrtimer_start_range_ns(timer, ns_to_ktime(period), period >> 2,
+				       HRTIMER_MODE_REL);
 	}
 
 exit:
 	spin_unlock_irqrestore(&mc->lock, flags);
 }
 
+/*
+ * Fire the TX timer now instead of after tx_period_ms, the pending frames
+ * of all SBD rings still go with a single doorbell.
+ */
+static inline void kick_tx_timer(struct mem_link_device *mld,
+				 struct hrtimer *timer)
+{
+	struct link_device *ld = &mld->link_dev;
+	struct modem_ctl *mc = ld->mc;
+	unsigned long flags;
+
+	spin_lock_irqsave(&mc->lock, flags);
+
+	if (likely(cp_online(mc)))
+		hrtimer_start(timer, ktime_set(0, 0), HRTIMER_MODE_REL);
+
+	spin_unlock_irqrestore(&mc->lock, flags);
+}
+
 static inline void cancel_tx_timer(struct mem_link_device *mld,
 				   struct hrtimer *timer)
 {
@@ -887,6 +910,7 @@ static inline void cancel_datalloc_timer(struct mem_link_device *mld)
 
 static int tx_frames_to_rb(struct sbd_ring_buffer *rb)
 {
+	struct mem_link_device *mld = ld_to_mem_link_device(rb->ld);
 	struct sk_buff_head *skb_txq = &rb->skb_q;
 	int tx_bytes = 0;
 	int ret = 0;
@@ -906,6 +930,7 @@ static int tx_frames_to_rb(struct sbd_ring_buffer *rb)
 		}
 
 		tx_bytes += ret;
+		mld->tx_frame_count++;
 #ifdef DEBUG_MODEM_IF_LINK_TX
 		mif_pkt(rb->ch, "LNK-TX", skb);
 #endif
@@ -1005,6 +1030,7 @@ static enum hrtimer_restart sbd_tx_timer_func(struct hrtimer *timer)
 			goto exit;
 		}
 		send_ipc_irq(mld, mask2int(mask));
+		mld->tx_doorbell_count++;
 		spin_unlock_irqrestore(&mc->lock, flags);
 	}
 
@@ -1058,6 +1084,7 @@ static int xmit_ipc_to_rb(struct mem_link_device *mld, enum sipc_ch_id ch,
 	struct sbd_ring_buffer *rb = sbd_ch2rb_with_skb(&mld->sbd_link_dev, ch, TX, skb);
 	struct sk_buff_head *skb_txq;
 	unsigned long flags;
+	bool more = skb->xmit_more;
 
 	if (!rb) {
 		mif_err("%s: %s->%s: ERR! NO SBD RB {ch:%d}\n",
@@ -1085,7 +1112,15 @@ static int xmit_ipc_to_rb(struct mem_link_device *mld, enum sipc_ch_id ch,
 
 		ret = skb->len;
 		skb_queue_tail(skb_txq, skb);
-		start_tx_timer(mld, &mld->sbd_tx_timer);
+
+		/*
+		 * A burst that already fills a batch does not wait for the
+		 * period, but nothing is rung while the stack has more to send.
+		 */
+		if (!more && mld->tx_batch && skb_txq->qlen >= mld->tx_batch)
+			kick_tx_timer(mld, &mld->sbd_tx_timer);
+		else
+			start_tx_timer(mld, &mld->sbd_tx_timer);
 	}
 
 	spin_unlock_irqrestore(&rb->lock, flags);
@@ -1539,10 +1574,10 @@ static int rx_net_frames_from_zerocopy_adaptor(struct sbd_ring_buffer *rb,
 	if (mld->force_use_memcpy || (num_frames > ld->mif_buff_mng->free_cell_count)
 		|| (FREE_RB_BUF_COUNT > circ_get_space(zdptr->len, *(zdptr->rp), *(zdptr->wp)))) {
 		use_memcpy = 1;
-		mld->memcpy_packet_count++;
+		mld->memcpy_packet_count += num_frames;
 	} else {
 		use_memcpy = 0;
-		mld->zeromemcpy_packet_count++;
+		mld->zeromemcpy_packet_count += num_frames;
 	}
 
 	while (rcvd < num_frames) {
@@ -2191,7 +2226,7 @@ static int shmem_enqueue_snapshot(struct mem_link_device *mld);
  * If the RAW NAPI functions are no longer scheduled at the end of this poll
  * function, we can enable the mailbox interrupt and stop polling.
  */
-static int mld_rx_int_poll(struct napi_struct *napi, int budget)
+static int __mld_rx_int_poll(struct napi_struct *napi, int budget)
 {
 	struct mem_link_device *mld = container_of(napi, struct mem_link_device,
 			mld_napi);
@@ -2266,6 +2301,59 @@ dummy_poll_complete:
 	return 0;
 }
 
+/*
+ * The PS frames received while the poll runs are handed to GRO through
+ * ld->gro_napi. GRO is flushed by napi_complete_done(), or by the NET RX
+ * softirq when the whole budget was used.
+ */
+static int mld_rx_int_poll(struct napi_struct *napi, int budget)
+{
+	struct mem_link_device *mld = container_of(napi, struct mem_link_device,
+			mld_napi);
+	struct link_device *ld = &mld->link_dev;
+	int rcvd;
+
+	ld->gro_cpu = smp_processor_id();
+	ld->gro_napi = napi;
+	rcvd = __mld_rx_int_poll(napi, budget);
+	ld->gro_napi = NULL;
+
+	return rcvd;
+}
+
+#ifdef CONFIG_NET_RX_BUSY_POLL
+#define MLD_BUSY_POLL_BUDGET	8
+
+/*
+ * Drain the RX rings for a busy-polling socket instead of waiting for the
+ * mailbox interrupt and NET_RX. The rings are claimed the same way the
+ * interrupt handler does, so the two never poll at the same time.
+ */
+static int mld_busy_poll(struct napi_struct *napi)
+{
+	struct mem_link_device *mld = container_of(napi, struct mem_link_device,
+			mld_napi);
+	struct link_device *ld = &mld->link_dev;
+	int rcvd;
+
+	if (!napi_schedule_prep(napi))
+		return LL_FLUSH_BUSY;
+
+	ld->disable_rx_int(ld);
+	rcvd = mld_rx_int_poll(napi, MLD_BUSY_POLL_BUDGET);
+
+	/* More is pending, NET_RX takes over as after an interrupt */
+	if (rcvd >= MLD_BUSY_POLL_BUDGET)
+		__napi_schedule(napi);
+
+	return rcvd;
+}
+
+static const struct net_device_ops mld_dummy_netdev_ops = {
+	.ndo_busy_poll = mld_busy_poll,
+};
+#endif
+
 static void sync_net_dev(struct link_device *ld)
 {
 	struct mem_link_device *mld = to_mem_link_device(ld);
@@ -3047,6 +3135,35 @@ static ssize_t tx_period_ms_store(struct device *dev,
 	return ret;
 }
 
+static ssize_t tx_batch_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct modem_data *modem;
+	modem = (struct modem_data *)dev->platform_data;
+	return sprintf(buf, "%u frames(%lu)/doorbells(%lu)\n",
+			modem->mld->tx_batch, modem->mld->tx_frame_count,
+			modem->mld->tx_doorbell_count);
+}
+
+static ssize_t tx_batch_store(struct device *dev,
+		struct device_attribute *attr,
+		const char *buf, size_t count)
+{
+	int ret;
+	struct modem_data *modem;
+	modem = (struct modem_data *)dev->platform_data;
+
+	ret = sscanf(buf, "%u", &modem->mld->tx_batch);
+	if (ret != 1)
+		return -EINVAL;
+
+	modem->mld->tx_frame_count = 0;
+	modem->mld->tx_doorbell_count = 0;
+
+	ret = count;
+	return ret;
+}
+
 static int rb_ch_id = 8;
 static ssize_t rb_info_show(struct device *dev,
 		struct device_attribute *attr, char *buf)
@@ -3129,9 +3246,10 @@ static ssize_t mif_buff_mng_show(struct device *dev,
 	if (!g_mif_buff_mng)
 		return 0;
 
-	return sprintf(buf, "used(%d)/free(%d)/total(%d)\n",
+	return sprintf(buf, "used(%d)/free(%d)/total(%d) recycled(%u) hit(%lu)/miss(%lu)\n",
 			g_mif_buff_mng->used_cell_count, g_mif_buff_mng->free_cell_count,
-			g_mif_buff_mng->cell_count);
+			g_mif_buff_mng->cell_count, g_mif_buff_mng->recycle_cnt,
+			g_mif_buff_mng->recycle_hit, g_mif_buff_mng->recycle_miss);
 }
 
 static ssize_t force_use_memcpy_show(struct device *dev,
@@ -3162,6 +3280,7 @@ static ssize_t force_use_memcpy_store(struct device *dev,
 #endif
 
 static DEVICE_ATTR_RW(tx_period_ms);
+static DEVICE_ATTR_RW(tx_batch);
 static DEVICE_ATTR_RW(rb_info);
 #if defined(CONFIG_CP_ZEROCOPY)
 static DEVICE_ATTR_RO(mif_buff_mng);
@@ -3171,6 +3290,7 @@ static DEVICE_ATTR_RW(force_use_memcpy);
 
 static struct attribute *shmem_attrs[] = {
 	&dev_attr_tx_period_ms.attr,
+	&dev_attr_tx_batch.attr,
 	&dev_attr_rb_info.attr,
 #if defined(CONFIG_CP_ZEROCOPY)
 	&dev_attr_mif_buff_mng.attr,
@@ -3283,6 +3403,7 @@ static ssize_t rx_poll_count_show(struct device *dev,
 
 	count += sprintf(&buf[count],
 		"%s: %d\n", netdev_name(&mld->dummy_net), mld->rx_poll_count);
+	count += sprintf(&buf[count], "gro_rx: %lu\n", mld->link_dev.gro_rx);
 
 	for (i = 0; i < sl->num_channels; i++) {
 		struct sbd_ring_buffer *rb = sbd_id2rb(sl, i, RX);
@@ -3319,6 +3440,7 @@ static ssize_t rx_poll_count_store(struct device *dev,
 		}
 	}
 	mld->rx_poll_count = 0;
+	mld->link_dev.gro_rx = 0;
 	return count;
 }
 
@@ -3485,6 +3607,10 @@ struct link_device *shmem_create_link_device(struct platform_device *pdev)
 
 	init_dummy_netdev(&mld->dummy_net);
 	netif_napi_add(&mld->dummy_net, &mld->mld_napi, mld_rx_int_poll, 64);
+#ifdef CONFIG_NET_RX_BUSY_POLL
+	mld->dummy_net.netdev_ops = &mld_dummy_netdev_ops;
+	napi_hash_add(&mld->mld_napi);
+#endif
 	napi_enable(&mld->mld_napi);
 #endif /* CONFIG_LINK_DEVICE_NAPI */
 
@@ -3768,6 +3894,7 @@ struct link_device *shmem_create_link_device(struct platform_device *pdev)
 	clean_vss_magic_code();
 
 	mld->tx_period_ms = TX_PERIOD_MS;
+	mld->tx_batch = TX_BATCH_FRAMES;
 
 	if (sysfs_create_group(&pdev->dev.kobj, &shmem_group))
 		mif_err("failed to create sysfs node related shmem\n");
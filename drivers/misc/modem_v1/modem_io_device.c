@@ -19,12 +19,16 @@
 #include <linux/poll.h>
 #include <linux/if_arp.h>
 #include <linux/ip.h>
+#include <linux/ipv6.h>
+#include <linux/jhash.h>
 #include <linux/if_ether.h>
 #include <linux/etherdevice.h>
 #include <linux/device.h>
 #include <linux/module.h>
 #include <soc/samsung/pmu-cp.h>
+#include <asm/unaligned.h>
 #include <trace/events/napi.h>
+#include <net/busy_poll.h>
 
 #include "modem_prj.h"
 #include "modem_utils.h"
@@ -293,6 +297,50 @@ static int rx_raw_misc(struct sk_buff *skb)
 	return queue_skb_to_iod(skb, iod);
 }
 
+#ifdef CONFIG_RPS
+/*
+ * All the PDNs are received on the CPU running the link RX. Hash the flow
+ * from the IP header, which is still hot, and the PDN channel. RPS then
+ * spreads the flows over the rps_cpus of the rmnet without running the flow
+ * dissector on the RX CPU.
+ */
+static void set_rx_flow_hash(struct io_device *iod, struct sk_buff *skb)
+{
+	u32 saddr, daddr, ports = 0;
+	unsigned int thoff;
+	u8 proto;
+
+	if (skb->protocol == htons(ETH_P_IP)) {
+		struct iphdr *iph = (struct iphdr *)skb->data;
+
+		if (skb->len < sizeof(struct iphdr))
+			return;
+		saddr = (__force u32)iph->saddr;
+		daddr = (__force u32)iph->daddr;
+		proto = iph->protocol;
+		thoff = iph->ihl * 4;
+		if (ip_is_fragment(iph))
+			proto = 0;
+	} else {
+		struct ipv6hdr *ip6h = (struct ipv6hdr *)skb->data;
+
+		if (skb->len < sizeof(struct ipv6hdr))
+			return;
+		saddr = ipv6_addr_hash(&ip6h->saddr);
+		daddr = ipv6_addr_hash(&ip6h->daddr);
+		proto = ip6h->nexthdr;
+		thoff = sizeof(struct ipv6hdr);
+	}
+
+	if ((proto == IPPROTO_TCP || proto == IPPROTO_UDP) &&
+	    skb->len >= thoff + sizeof(u32))
+		ports = get_unaligned((u32 *)(skb->data + thoff));
+
+	skb_set_hash(skb, jhash_3words(saddr, daddr, ports ^ iod->id, proto),
+		     ports ? PKT_HASH_TYPE_L4 : PKT_HASH_TYPE_L3);
+}
+#endif
+
 static int rx_multi_pdp(struct sk_buff *skb)
 {
 	struct link_device *ld = skbpriv(skb)->ld;
@@ -324,6 +372,10 @@ static int rx_multi_pdp(struct sk_buff *skb)
 	else
 		skb->protocol = htons(ETH_P_IP);
 
+#ifdef CONFIG_RPS
+	set_rx_flow_hash(iod, skb);
+#endif
+
 	if (iod->use_handover) {
 		struct ethhdr *ehdr;
 		const char source[ETH_ALEN] = SOURCE_MAC_ADDR;
@@ -345,7 +397,24 @@ static int rx_multi_pdp(struct sk_buff *skb)
 #endif
 
 #ifdef CONFIG_LINK_DEVICE_NAPI
-	ret = netif_receive_skb(skb);
+	/*
+	 * Only the poll of the link's own NAPI context may feed GRO; frames
+	 * from the reclaim tasklet or the UDL work go straight up the stack.
+	 */
+	if (ld->gro_napi)
+		skb_mark_napi_id(skb, ld->gro_napi);
+
+	if (ld->gro_napi && in_serving_softirq() &&
+	    ld->gro_cpu == smp_processor_id()) {
+		skb_reset_network_header(skb);
+		if (!iod->use_handover)
+			skb_reset_mac_header(skb);
+		ld->gro_rx++;
+		ret = napi_gro_receive(ld->gro_napi, skb);
+		ret = (ret == GRO_DROP) ? NET_RX_DROP : NET_RX_SUCCESS;
+	} else {
+		ret = netif_receive_skb(skb);
+	}
 #else /* !CONFIG_LINK_DEVICE_NAPI */
 	if (in_interrupt())
 		ret = netif_rx(skb);
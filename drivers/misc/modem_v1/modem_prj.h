@@ -518,6 +518,11 @@ struct link_device {
 	void (*reset_zerocopy)(struct link_device *ld);
 
 #ifdef CONFIG_LINK_DEVICE_NAPI
+	/* NAPI context running the RX poll, for GRO of the PS frames */
+	struct napi_struct *gro_napi;
+	int gro_cpu;
+	unsigned long gro_rx;
+
 	/* Poll function for NAPI */
 	int (*poll_recv_on_iod)(struct link_device *ld, struct io_device *iod,
 			int budget);
@@ -1236,6 +1236,14 @@ struct mif_buff_mng *init_mif_buff_mng(unsigned char *buffer_start,
 		return NULL;
 	}
 
+	bm->recycle_map = kzalloc((MIF_BUFF_MAP_CELL_SIZE * bm->buffer_map_size),
+		GFP_KERNEL);
+	if (bm->recycle_map == NULL) {
+		kfree(bm->buffer_map);
+		kfree(bm);
+		return NULL;
+	}
+
 	mif_info("cell_count:%u, map_size:%u, map_size_byte:%lu  buff_map:%pK\n"
 		, bm->cell_count, bm->buffer_map_size,
 		(sizeof(unsigned int) * bm->buffer_map_size), bm->buffer_map);
@@ -1254,6 +1262,7 @@ struct mif_buff_mng *init_mif_buff_mng(unsigned char *buffer_start,
 void exit_mif_buff_mng(struct mif_buff_mng *bm)
 {
 	if (bm) {
+		kfree(bm->recycle_map);
 		kfree(bm->buffer_map);
 		kfree(bm);
 	}
@@ -1280,6 +1289,21 @@ void *alloc_mif_buff(struct mif_buff_mng *bm)
 
 	spin_lock_irqsave(&bm->lock, flags);
 
+	/* The last freed cell is the most likely to be still in the cache */
+	if (bm->recycle_cnt) {
+		buff_allocated = bm->recycle[--bm->recycle_cnt];
+		location = (unsigned int)(buff_allocated - bm->buffer_start) /
+				bm->cell_size;
+		bm->recycle_map[location / MIF_BITS_FOR_MAP_CELL] &=
+			~(MIF_64BIT_FIRST_BIT >> (location % MIF_BITS_FOR_MAP_CELL));
+		bm->free_cell_count--;
+		bm->used_cell_count++;
+		bm->recycle_hit++;
+		spin_unlock_irqrestore(&bm->lock, flags);
+		return (void *)buff_allocated;
+	}
+	bm->recycle_miss++;
+
 	for (i = bm->current_map_index ; i < bm->buffer_map_size; i++) {
 		test_map = (uint64_t) bm->buffer_map[i];
 		test_map = ~test_map;
@@ -1397,7 +1421,20 @@ int free_mif_buff(struct mif_buff_mng *bm, void *buffer)
 
 	spin_lock_irqsave(&bm->lock, flags);
 
-	bm->buffer_map[i] &= ~(MIF_64BIT_FIRST_BIT >> j);
+	/* still set in the buffer_map while it waits in the LIFO */
+	if (bm->recycle_map[i] & (MIF_64BIT_FIRST_BIT >> j)) {
+		spin_unlock_irqrestore(&bm->lock, flags);
+		mif_err("ERR Buffer:%pK is allready freed\n", uc_buffer);
+		return -1;
+	}
+
+	if (bm->recycle_cnt < MIF_BUFF_RECYCLE_SIZE) {
+		bm->recycle[bm->recycle_cnt++] = bm->buffer_start +
+						(location * bm->cell_size);
+		bm->recycle_map[i] |= (MIF_64BIT_FIRST_BIT >> j);
+	} else {
+		bm->buffer_map[i] &= ~(MIF_64BIT_FIRST_BIT >> j);
+	}
 	bm->free_cell_count++;
 	bm->used_cell_count--;
 
@@ -534,6 +534,9 @@ void set_wakeup_packet_log(bool enable);
 #define MIF_BITS_FOR_MAP_CELL	(MIF_BUFF_MAP_CELL_SIZE * MIF_BITS_FOR_BYTE)
 #define MIF_64BIT_FIRST_BIT	(0x8000000000000000ULL)
 
+/* Freed cells kept for reuse before going back to the bitmap */
+#define MIF_BUFF_RECYCLE_SIZE	256
+
 struct mif_buff_mng {
 	unsigned char *buffer_start;
 	unsigned char *buffer_end;
@@ -549,6 +552,16 @@ struct mif_buff_mng {
 	uint64_t *buffer_map;
 	unsigned int buffer_map_size;
 	int current_map_index;
+
+	/*
+	 * LIFO of freed cells, still marked as used in the buffer_map.
+	 * recycle_map has the same layout and marks the cells in the LIFO.
+	 */
+	uint64_t *recycle_map;
+	void *recycle[MIF_BUFF_RECYCLE_SIZE];
+	unsigned int recycle_cnt;
+	unsigned long recycle_hit;
+	unsigned long recycle_miss;
 };
 
 struct mif_buff_mng *init_mif_buff_mng(unsigned char *buffer_start,
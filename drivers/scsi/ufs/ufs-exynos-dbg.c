@@ -9,6 +9,7 @@
 
 #include <linux/clk.h>
 #include <linux/smc.h>
+#include <linux/blkdev.h>
 
 #include "ufshcd.h"
 #include "unipro.h"
@@ -1072,6 +1073,43 @@ static void exynos_ufs_dump_attr(struct ufs_hba *hba,
 	}
 }
 
+/*
+ * Cost of clock gating: how often and how long requests waited for the
+ * clocks and the link to come back, and the idle gaps behind the delay.
+ */
+static ssize_t gating_stats_show(struct device *dev,
+				 struct device_attribute *attr, char *buf)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+	struct ufs_clk_gating *gating = &hba->clk_gating;
+	unsigned long flags;
+	ssize_t len = 0;
+	int i;
+
+	spin_lock_irqsave(hba->host->host_lock, flags);
+	len += scnprintf(buf + len, PAGE_SIZE - len,
+			"ungate: %lu, %llu us\n", gating->ungate_cnt,
+			gating->ungate_us);
+	len += scnprintf(buf + len, PAGE_SIZE - len,
+			"hibern8 exit: %llu us\n", gating->h8_exit_us);
+	len += scnprintf(buf + len, PAGE_SIZE - len,
+			"delay: %lu ms%s\n",
+			gating->predict ? gating->predicted_ms : gating->delay_ms,
+			gating->predict ? " (predicted)" : "");
+	len += scnprintf(buf + len, PAGE_SIZE - len, "idle gaps:");
+	for (i = 0; i < UFSHCD_GAP_BUCKETS; i++)
+		len += scnprintf(buf + len, PAGE_SIZE - len, " %u",
+				gating->gap_hist[i]);
+	len += scnprintf(buf + len, PAGE_SIZE - len, "\n");
+	spin_unlock_irqrestore(hba->host->host_lock, flags);
+
+	return len;
+}
+
+static DEVICE_ATTR_RO(gating_stats);
+
+static void exynos_ufs_init_lat(struct ufs_hba *hba);
+
 /*
  * Functions to be provied externally
  *
@@ -1142,6 +1180,12 @@ int exynos_ufs_init_dbg(struct ufs_hba *hba)
 	hba->secure_log.paddr = exynos_ss_get_spare_paddr(0);
 	hba->secure_log.vaddr = (u32 *)exynos_ss_get_spare_vaddr(0);
 
+	if (ufshcd_is_clkgating_allowed(hba) &&
+	    device_create_file(hba->dev, &dev_attr_gating_stats))
+		dev_err(hba->dev, "Failed to create gating_stats sysfs entry\n");
+
+	exynos_ufs_init_lat(hba);
+
 	return 0;
 }
 
@@ -1191,4 +1235,198 @@ void exynos_ufs_cmd_log_end(struct ufs_hba *hba, int tag)
 	int cpu = raw_smp_processor_id();
 
 	ufs_cmd_queue.addr_per_tag[tag]->end_time = cpu_clock(cpu);
-}
\ No newline at end of file
+}
+#ifdef CONFIG_SCSI_UFS_LATENCY_STATS
+/*
+ * Per-request latency breakdown. Every request is stamped when the block
+ * layer started it, when it reached queuecommand, when the doorbell was
+ * rung and when its completion interrupt was handled. On completion, each
+ * stage is added to a log2 histogram of microseconds per opcode class.
+ */
+enum {
+	LAT_STAGE_BLOCK,	/* block layer start -> queuecommand */
+	LAT_STAGE_DRIVER,	/* queuecommand -> doorbell */
+	LAT_STAGE_DEVICE,	/* doorbell -> completion interrupt */
+	LAT_STAGE_COMPL,	/* completion interrupt -> request done */
+	LAT_STAGE_MAX,
+};
+
+enum {
+	LAT_OP_READ,
+	LAT_OP_WRITE,
+	LAT_OP_UNMAP,
+	LAT_OP_SYNC,
+	LAT_OP_OTHER,
+	LAT_OP_MAX,
+};
+
+#define LAT_BUCKETS	16
+
+static const char * const lat_stage_name[LAT_STAGE_MAX] = {
+	"block", "driver", "device", "compl",
+};
+
+static const char * const lat_op_name[LAT_OP_MAX] = {
+	"read", "write", "unmap", "sync", "other",
+};
+
+struct ufs_lat_tag {
+	u8 op;
+	u64 start;
+	u64 issue;
+	u64 doorbell;
+	u64 irq;
+};
+
+struct ufs_lat_hist {
+	u32 hist[LAT_OP_MAX][LAT_STAGE_MAX][LAT_BUCKETS];
+};
+
+/* indexed by tag, which stays owned by the request until it is done */
+static struct ufs_lat_tag ufs_lat_tags[32];
+static DEFINE_PER_CPU(struct ufs_lat_hist, ufs_lat_hist);
+
+static u8 exynos_ufs_lat_op(unsigned char opcode)
+{
+	switch (opcode) {
+	case READ_6:
+	case READ_10:
+	case READ_16:
+		return LAT_OP_READ;
+	case WRITE_6:
+	case WRITE_10:
+	case WRITE_16:
+		return LAT_OP_WRITE;
+	case UNMAP:
+		return LAT_OP_UNMAP;
+	case SYNCHRONIZE_CACHE:
+		return LAT_OP_SYNC;
+	default:
+		return LAT_OP_OTHER;
+	}
+}
+
+void exynos_ufs_lat_issue(struct ufs_hba *hba, struct scsi_cmnd *cmd)
+{
+	struct ufs_lat_tag *t;
+	int tag = cmd->request->tag;
+
+	if (tag < 0 || tag >= ARRAY_SIZE(ufs_lat_tags))
+		return;
+
+	t = &ufs_lat_tags[tag];
+	t->op = exynos_ufs_lat_op(cmd->cmnd[0]);
+	/* zero unless the block layer keeps request start times */
+	t->start = rq_start_time_ns(cmd->request);
+	t->issue = sched_clock();
+	t->doorbell = 0;
+	t->irq = 0;
+}
+
+void exynos_ufs_lat_doorbell(struct ufs_hba *hba, int tag)
+{
+	if (tag < 0 || tag >= ARRAY_SIZE(ufs_lat_tags))
+		return;
+
+	ufs_lat_tags[tag].doorbell = sched_clock();
+}
+
+void exynos_ufs_lat_irq(struct ufs_hba *hba, int tag, u64 irq_time)
+{
+	if (tag < 0 || tag >= ARRAY_SIZE(ufs_lat_tags))
+		return;
+
+	ufs_lat_tags[tag].irq = irq_time;
+}
+
+static void exynos_ufs_lat_add(struct ufs_lat_hist *h, u8 op, int stage,
+				u64 from, u64 to)
+{
+	u64 us;
+	int i;
+
+	if (!from || to < from)
+		return;
+
+	us = div_u64(to - from, NSEC_PER_USEC);
+	i = min_t(int, fls64(us), LAT_BUCKETS - 1);
+	h->hist[op][stage][i]++;
+}
+
+void exynos_ufs_lat_done(struct ufs_hba *hba, struct request *rq)
+{
+	struct ufs_lat_hist *h;
+	struct ufs_lat_tag *t;
+	u64 now = sched_clock();
+
+	if (rq->tag < 0 || rq->tag >= ARRAY_SIZE(ufs_lat_tags))
+		return;
+
+	t = &ufs_lat_tags[rq->tag];
+	/* never reached the controller, e.g. failed in the error state */
+	if (!t->doorbell || !t->irq)
+		return;
+
+	h = get_cpu_ptr(&ufs_lat_hist);
+	exynos_ufs_lat_add(h, t->op, LAT_STAGE_BLOCK, t->start, t->issue);
+	exynos_ufs_lat_add(h, t->op, LAT_STAGE_DRIVER, t->issue, t->doorbell);
+	exynos_ufs_lat_add(h, t->op, LAT_STAGE_DEVICE, t->doorbell, t->irq);
+	exynos_ufs_lat_add(h, t->op, LAT_STAGE_COMPL, t->irq, now);
+	put_cpu_ptr(&ufs_lat_hist);
+
+	t->doorbell = 0;
+	t->irq = 0;
+}
+
+/*
+ * One line per opcode class and stage, bucket i counting latencies in
+ * [2^(i-1), 2^i) us, bucket 0 below 1us. Writing anything clears them.
+ */
+static ssize_t latency_breakdown_show(struct device *dev,
+				      struct device_attribute *attr, char *buf)
+{
+	ssize_t len = 0;
+	int op, stage, i, cpu;
+
+	for (op = 0; op < LAT_OP_MAX; op++) {
+		for (stage = 0; stage < LAT_STAGE_MAX; stage++) {
+			len += scnprintf(buf + len, PAGE_SIZE - len, "%s %s:",
+					lat_op_name[op], lat_stage_name[stage]);
+			for (i = 0; i < LAT_BUCKETS; i++) {
+				u32 sum = 0;
+
+				for_each_possible_cpu(cpu)
+					sum += per_cpu(ufs_lat_hist, cpu).hist[op][stage][i];
+				len += scnprintf(buf + len, PAGE_SIZE - len,
+						" %u", sum);
+			}
+			len += scnprintf(buf + len, PAGE_SIZE - len, "\n");
+		}
+	}
+
+	return len;
+}
+
+static ssize_t latency_breakdown_store(struct device *dev,
+				       struct device_attribute *attr,
+				       const char *buf, size_t count)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		memset(per_cpu_ptr(&ufs_lat_hist, cpu), 0,
+		       sizeof(struct ufs_lat_hist));
+
+	return count;
+}
+
+static DEVICE_ATTR_RW(latency_breakdown);
+
+static void exynos_ufs_init_lat(struct ufs_hba *hba)
+{
+	if (device_create_file(hba->dev, &dev_attr_latency_breakdown))
+		dev_err(hba->dev, "Failed to create latency_breakdown sysfs entry\n");
+}
+#else
+static inline void exynos_ufs_init_lat(struct ufs_hba *hba) {}
+#endif
@@ -790,6 +790,10 @@ extern int exynos_ufs_init_dbg(struct ufs_hba *hba);
 extern void exynos_ufs_show_uic_info(struct ufs_hba *hba);
 extern void exynos_ufs_cmd_log_start(struct ufs_hba *hba, struct scsi_cmnd *cmd);
 extern void exynos_ufs_cmd_log_end(struct ufs_hba *hba, int tag);
+extern void exynos_ufs_lat_issue(struct ufs_hba *hba, struct scsi_cmnd *cmd);
+extern void exynos_ufs_lat_doorbell(struct ufs_hba *hba, int tag);
+extern void exynos_ufs_lat_irq(struct ufs_hba *hba, int tag, u64 irq_time);
+extern void exynos_ufs_lat_done(struct ufs_hba *hba, struct request *rq);
 #ifndef __EXYNOS_UFS_VS_DEBUG__
 #define __EXYNOS_UFS_VS_DEBUG__
 #endif
@@ -87,10 +87,19 @@
 
 /* Interrupt aggregation default timeout, unit: 40us */
 #define INT_AGGR_DEF_TO	0x01
+/* Adaptive aggregation timeout with all slots in flight, unit: 40us */
+#define INT_AGGR_ADAPT_MAX_TO	0x04
 
 /* Link Hibernation delay, msecs */
 #define LINK_H8_DELAY  20
 
+/*
+ * Predictive gating weighs an ungate as this much idle time spent ungated,
+ * and halves the idle gap histogram every UFSHCD_GAP_DECAY gaps.
+ */
+#define UFSHCD_GATE_EXIT_COST_MS	8
+#define UFSHCD_GAP_DECAY		64
+
 /* UFS link setup retries */
 #define UFS_LINK_SETUP_RETRIES 5
 
@@ -235,7 +244,8 @@ static int ufshcd_send_request_sense(struct ufs_hba *hba,
 #if defined(CONFIG_FMP_UFS)
 extern int fmp_ufs_map_sg(struct ufshcd_sg_entry *prd_table, struct scatterlist *sg,
 				int enc_mode, uint32_t idx,
-				uint32_t sector, struct bio *bio);
+				uint32_t sector, struct bio *bio,
+				struct fmp_ufs_cache *cache);
 #if defined(CONFIG_FIPS_FMP)
 extern int fmp_map_sg_st(struct ufs_hba *hba, struct ufshcd_sg_entry *prd_table,
 					struct scatterlist *sg, int enc_mode,
@@ -849,6 +859,8 @@ ufshcd_reset_intr_aggr(struct ufs_hba *hba)
 static inline void
 ufshcd_config_intr_aggr(struct ufs_hba *hba, u8 cnt, u8 tmout)
 {
+	hba->intr_aggr.cnt = cnt;
+	hba->intr_aggr.tmout = tmout;
 	ufshcd_writel(hba, INT_AGGR_ENABLE | INT_AGGR_PARAM_WRITE |
 		      INT_AGGR_COUNTER_THLD_VAL(cnt) |
 		      INT_AGGR_TIMEOUT_VAL(tmout),
@@ -861,9 +873,48 @@ ufshcd_config_intr_aggr(struct ufs_hba *hba, u8 cnt, u8 tmout)
  */
 static inline void ufshcd_disable_intr_aggr(struct ufs_hba *hba)
 {
+	hba->intr_aggr.cnt = 0;
+	hba->intr_aggr.tmout = 0;
 	ufshcd_writel(hba, 0, REG_UTP_TRANSFER_REQ_INT_AGG_CONTROL);
 }
 
+/**
+ * ufshcd_adapt_intr_aggr - Follow the queue depth with interrupt aggregation
+ * @hba: per adapter instance
+ * @depth: requests outstanding when the completion interrupt came
+ *
+ * A single outstanding request gets its interrupt right away. Deeper
+ * queues wait for half of the requests in flight, and for longer, so the
+ * device stays busy with the other half while fewer interrupts are taken.
+ * Must be called with host lock acquired.
+ */
+static void ufshcd_adapt_intr_aggr(struct ufs_hba *hba, int depth)
+{
+	struct ufs_intr_aggr *aggr = &hba->intr_aggr;
+	unsigned int avg;
+	u8 cnt, tmout;
+
+	if (!aggr->adaptive || !ufshcd_is_intr_aggr_allowed(hba))
+		return;
+
+	aggr->depth += depth - (aggr->depth >> 3);
+	avg = DIV_ROUND_UP(aggr->depth, 8);
+
+	/* reacts to QD1 at once, so interactive reads are not delayed */
+	if (depth <= 1 || avg <= 1) {
+		if (aggr->cnt)
+			ufshcd_disable_intr_aggr(hba);
+		return;
+	}
+
+	cnt = min_t(unsigned int, avg / 2, hba->nutrs - 1);
+	tmout = DIV_ROUND_UP(INT_AGGR_ADAPT_MAX_TO * avg, hba->nutrs);
+	if (cnt == aggr->cnt && tmout == aggr->tmout)
+		return;
+
+	ufshcd_config_intr_aggr(hba, cnt, tmout);
+}
+
 /**
  * ufshcd_enable_run_stop_reg - Enable run-stop registers,
  *			When run-stop registers are set to 1, it indicates the
@@ -898,6 +949,62 @@ static inline int ufshcd_is_hba_active(struct ufs_hba *hba)
 	return (ufshcd_readl(hba, REG_CONTROLLER_ENABLE) & 0x1) ? 0 : 1;
 }
 
+/*
+ * Pick the gating delay among the bucket bounds 2^(k-1) ms, minimizing the
+ * ungates it would have caused, each worth UFSHCD_GATE_EXIT_COST_MS, plus
+ * the idle time it would have left ungated. Bursty I/O moves the delay past
+ * its gaps, while long idle periods bring it down to 1ms.
+ * Must be called with host lock acquired.
+ */
+static void ufshcd_gating_predict(struct ufs_hba *hba)
+{
+	struct ufs_clk_gating *gating = &hba->clk_gating;
+	unsigned long best_cost = ULONG_MAX, cost, delay;
+	int i, k;
+
+	for (k = 1; k < UFSHCD_GAP_BUCKETS; k++) {
+		delay = 1UL << (k - 1);
+		cost = 0;
+		for (i = 0; i < UFSHCD_GAP_BUCKETS; i++) {
+			if (i < k)
+				/* ended before gating, about 3/4 of the bucket */
+				cost += gating->gap_hist[i] * ((3UL << i) >> 2);
+			else
+				cost += gating->gap_hist[i] *
+					(delay + UFSHCD_GATE_EXIT_COST_MS);
+		}
+		if (cost < best_cost) {
+			best_cost = cost;
+			gating->predicted_ms = delay;
+		}
+	}
+}
+
+/* Must be called with host lock acquired */
+static void ufshcd_gating_record_gap(struct ufs_hba *hba)
+{
+	struct ufs_clk_gating *gating = &hba->clk_gating;
+	s64 gap_ms;
+	int i;
+
+	if (!ktime_to_ns(gating->idle_start))
+		return;
+
+	gap_ms = ktime_ms_delta(ktime_get(), gating->idle_start);
+	gating->idle_start = ktime_set(0, 0);
+
+	i = min_t(int, fls64(max_t(s64, gap_ms, 0)), UFSHCD_GAP_BUCKETS - 1);
+	gating->gap_hist[i]++;
+
+	if (++gating->gap_samples >= UFSHCD_GAP_DECAY) {
+		for (i = 0; i < UFSHCD_GAP_BUCKETS; i++)
+			gating->gap_hist[i] >>= 1;
+		gating->gap_samples = 0;
+	}
+
+	ufshcd_gating_predict(hba);
+}
+
 static void ufshcd_ungate_work(struct work_struct *work)
 {
 	int ret;
@@ -905,6 +1012,7 @@ static void ufshcd_ungate_work(struct work_struct *work)
 	struct ufs_hba *hba = container_of(work, struct ufs_hba,
 			clk_gating.ungate_work);
 	bool gating_allowed = !ufshcd_can_fake_clkgating(hba);
+	ktime_t start = ktime_get();
 
 	cancel_delayed_work_sync(&hba->clk_gating.gate_work);
 
@@ -928,6 +1036,8 @@ static void ufshcd_ungate_work(struct work_struct *work)
 		/* Prevent gating in this path */
 		hba->clk_gating.is_suspended = true;
 		if (ufshcd_is_link_hibern8(hba)) {
+			ktime_t h8_start = ktime_get();
+
 			ufshcd_set_link_trans_active(hba);
 			ret = ufshcd_link_hibern8_ctrl(hba, false);
 			if (ret) {
@@ -937,9 +1047,13 @@ static void ufshcd_ungate_work(struct work_struct *work)
 			} else {
 				ufshcd_set_link_active(hba);
 			}
+			hba->clk_gating.h8_exit_us +=
+				ktime_us_delta(ktime_get(), h8_start);
 		}
 		hba->clk_gating.is_suspended = false;
 	}
+	hba->clk_gating.ungate_cnt++;
+	hba->clk_gating.ungate_us += ktime_us_delta(ktime_get(), start);
 unblock_reqs:
 #if defined(CONFIG_PM_DEVFREQ)
 	if (ufshcd_is_clkscaling_enabled(hba))
@@ -964,6 +1078,7 @@ int ufshcd_hold(struct ufs_hba *hba, bool async)
 		goto out;
 	spin_lock_irqsave(hba->host->host_lock, flags);
 	hba->clk_gating.active_reqs++;
+	ufshcd_gating_record_gap(hba);
 
 start:
 	switch (hba->clk_gating.state) {
@@ -1129,8 +1244,11 @@ static void __ufshcd_release(struct ufs_hba *hba)
 		return;
 
 	hba->clk_gating.state = REQ_CLKS_OFF;
+	hba->clk_gating.idle_start = ktime_get();
 	queue_delayed_work(hba->ufshcd_workq, &hba->clk_gating.gate_work,
-			msecs_to_jiffies(hba->clk_gating.delay_ms));
+			msecs_to_jiffies(hba->clk_gating.predict ?
+					 hba->clk_gating.predicted_ms :
+					 hba->clk_gating.delay_ms));
 }
 
 void ufshcd_release(struct ufs_hba *hba)
@@ -1166,6 +1284,30 @@ static ssize_t ufshcd_clkgate_delay_store(struct device *dev,
 	return count;
 }
 
+static ssize_t ufshcd_clkgate_predict_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+
+	return snprintf(buf, PAGE_SIZE, "%d\n", hba->clk_gating.predict);
+}
+
+static ssize_t ufshcd_clkgate_predict_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+	unsigned long flags;
+	bool value;
+
+	if (strtobool(buf, &value))
+		return -EINVAL;
+
+	spin_lock_irqsave(hba->host->host_lock, flags);
+	hba->clk_gating.predict = value;
+	spin_unlock_irqrestore(hba->host->host_lock, flags);
+	return count;
+}
+
 static int ufshcd_init_clk_gating(struct ufs_hba *hba)
 {
 	int ret = 0;
@@ -1180,6 +1322,8 @@ static int ufshcd_init_clk_gating(struct ufs_hba *hba)
 	}
 
 	hba->clk_gating.delay_ms = LINK_H8_DELAY;
+	hba->clk_gating.predict = true;
+	hba->clk_gating.predicted_ms = LINK_H8_DELAY;
 	INIT_DELAYED_WORK(&hba->clk_gating.gate_work, ufshcd_gate_work);
 	INIT_WORK(&hba->clk_gating.ungate_work, ufshcd_ungate_work);
 
@@ -1191,6 +1335,14 @@ static int ufshcd_init_clk_gating(struct ufs_hba *hba)
 	if (device_create_file(hba->dev, &hba->clk_gating.delay_attr))
 		dev_err(hba->dev, "Failed to create sysfs for clkgate_delay\n");
 
+	hba->clk_gating.predict_attr.show = ufshcd_clkgate_predict_show;
+	hba->clk_gating.predict_attr.store = ufshcd_clkgate_predict_store;
+	sysfs_attr_init(&hba->clk_gating.predict_attr.attr);
+	hba->clk_gating.predict_attr.attr.name = "clkgate_predict";
+	hba->clk_gating.predict_attr.attr.mode = S_IRUGO | S_IWUSR;
+	if (device_create_file(hba->dev, &hba->clk_gating.predict_attr))
+		dev_err(hba->dev, "Failed to create sysfs for clkgate_predict\n");
+
 out:
 	return ret;
 }
@@ -1201,6 +1353,7 @@ static void ufshcd_exit_clk_gating(struct ufs_hba *hba)
 		return;
 	destroy_workqueue(hba->ufshcd_workq);
 	device_remove_file(hba->dev, &hba->clk_gating.delay_attr);
+	device_remove_file(hba->dev, &hba->clk_gating.predict_attr);
 }
 
 #if defined(CONFIG_PM_DEVFREQ)
@@ -1231,6 +1384,23 @@ static void ufshcd_clk_scaling_update_busy(struct ufs_hba *hba)
 	}
 }
 #endif
+/*
+ * All LUs share the device, so each of their queues sees the same idle
+ * stamp. Called with host_lock held when outstanding_reqs changes from
+ * or to zero.
+ */
+static void ufshcd_update_dev_idle(struct ufs_hba *hba, bool idle)
+{
+	struct scsi_device *sdev;
+	ktime_t stamp = idle ? ktime_get() : ktime_set(0, 0);
+
+	__shost_for_each_device(sdev, hba->host) {
+		if (sdev->sdev_state == SDEV_DEL || !sdev->request_queue)
+			continue;
+		WRITE_ONCE(sdev->request_queue->dev_idle_stamp, stamp);
+	}
+}
+
 /**
  * ufshcd_send_command - Send SCSI or device management commands
  * @hba: per adapter instance
@@ -1242,6 +1412,8 @@ void ufshcd_send_command(struct ufs_hba *hba, unsigned int task_tag)
 #if defined(CONFIG_PM_DEVFREQ)
 	ufshcd_clk_scaling_start_busy(hba);
 #endif
+	if (!hba->outstanding_reqs)
+		ufshcd_update_dev_idle(hba, false);
 	__set_bit(task_tag, &hba->outstanding_reqs);
 	ufshcd_writel(hba, 1 << task_tag, REG_UTP_TRANSFER_REQ_DOOR_BELL);
 }
@@ -1548,6 +1720,7 @@ static int ufshcd_map_sg(struct ufs_hba *hba, struct ufshcd_lrb *lrbp)
 	int ret;
         unsigned int sector = 0;
 	int enc_mode = 0;
+	struct fmp_ufs_cache fmp_cache = { .key = NULL, .mapping = NULL };
 #endif
 
 	cmd = lrbp->cmd;
@@ -1588,7 +1761,8 @@ static int ufshcd_map_sg(struct ufs_hba *hba, struct ufshcd_lrb *lrbp)
 				SET_FAS(&prd_table[i], CLEAR);
 			} else {
 				unsigned long flags;
-				ret = fmp_ufs_map_sg(prd_table, sg, enc_mode, i, sector, cmd->request->bio);
+				ret = fmp_ufs_map_sg(prd_table, sg, enc_mode, i, sector,
+						cmd->request->bio, &fmp_cache);
 				if (ret) {
 					dev_err(hba->dev, "failed to make fmp descriptor. ret = %d\n", ret);
 					spin_lock_irqsave(hba->host->host_lock, flags);
@@ -1946,6 +2120,9 @@ static int ufshcd_queuecommand(struct Scsi_Host *host, struct scsi_cmnd *cmd)
 
 	tag = cmd->request->tag;
 
+#ifdef CONFIG_SCSI_UFS_LATENCY_STATS
+	exynos_ufs_lat_issue(hba, cmd);
+#endif
 	spin_lock_irqsave(hba->host->host_lock, flags);
 	switch (hba->ufshcd_state) {
 	case UFSHCD_STATE_OPERATIONAL:
@@ -2042,6 +2219,9 @@ static int ufshcd_queuecommand(struct Scsi_Host *host, struct scsi_cmnd *cmd)
 	exynos_ufs_cmd_log_start(hba, cmd);
 #endif
 	ufshcd_send_command(hba, tag);
+#ifdef CONFIG_SCSI_UFS_LATENCY_STATS
+	exynos_ufs_lat_doorbell(hba, tag);
+#endif
 
 	if (hba->monitor.flag & UFSHCD_MONITOR_LEVEL1)
 		dev_info(hba->dev, "IO issued(%d)\n", tag);
@@ -2166,6 +2346,8 @@ static int ufshcd_wait_for_dev_cmd(struct ufs_hba *hba,
 		if (!ufshcd_clear_cmd(hba, lrbp->task_tag)) {
 			spin_lock_irqsave(hba->host->host_lock, flags);
 			__clear_bit(lrbp->task_tag, &hba->outstanding_reqs);
+			if (!hba->outstanding_reqs)
+				ufshcd_update_dev_idle(hba, true);
 			spin_unlock_irqrestore(hba->host->host_lock, flags);
 
 			/* sucessfully cleared the command, retry if needed */
@@ -4025,6 +4207,9 @@ static void ufshcd_done(struct request *rq)
 {
 	struct scsi_cmnd *cmd = rq->special;
 	scsi_dma_unmap(cmd);
+#ifdef CONFIG_SCSI_UFS_LATENCY_STATS
+	exynos_ufs_lat_done(shost_priv(cmd->device->host), rq);
+#endif
 	scsi_softirq_done(rq);
 }
 
@@ -4058,6 +4243,7 @@ static int ufshcd_slave_alloc(struct scsi_device *sdev)
 
 	ufshcd_get_bootlunID(sdev);
 
+	/* also replaces the scsi-mq complete op, which calls the same path */
 	blk_queue_softirq_done(sdev->request_queue, ufshcd_done);
 
 
@@ -4094,6 +4280,9 @@ static int ufshcd_slave_configure(struct scsi_device *sdev)
 	blk_queue_max_segment_size(q, PRDT_DATA_BYTE_COUNT_MAX);
 	blk_queue_update_dma_alignment(q, PAGE_SIZE - 1);
 
+	q->dev_idle_stamp = ktime_get();
+	queue_flag_set_unlocked(QUEUE_FLAG_IDLE_TRACK, q);
+
 	return 0;
 }
 
@@ -4297,6 +4486,9 @@ static void __ufshcd_transfer_req_compl(struct ufs_hba *hba, int reason)
 	int result;
 	int index;
 	struct request *req;
+#ifdef CONFIG_SCSI_UFS_LATENCY_STATS
+	u64 irq_time = sched_clock();
+#endif
 
 	/* Resetting interrupt aggregation counters first and reading the
 	 * DOOR_BELL afterward allows us to handle all the completed requests.
@@ -4305,7 +4497,9 @@ static void __ufshcd_transfer_req_compl(struct ufs_hba *hba, int reason)
 	 * false interrupt if device completes another request after resetting
 	 * aggregation and before reading the DB.
 	 */
-	if ((ufshcd_is_intr_aggr_allowed(hba))
+	ufshcd_adapt_intr_aggr(hba, hweight_long(hba->outstanding_reqs));
+
+	if ((ufshcd_is_intr_aggr_allowed(hba)) && hba->intr_aggr.cnt
 		&& !(hba->quirks & UFSHCI_QUIRK_SKIP_INTR_AGGR))
 		ufshcd_reset_intr_aggr(hba);
 
@@ -4344,6 +4538,9 @@ static void __ufshcd_transfer_req_compl(struct ufs_hba *hba, int reason)
 						delta_us);
 				}
 			}
+#ifdef CONFIG_SCSI_UFS_LATENCY_STATS
+			exynos_ufs_lat_irq(hba, index, irq_time);
+#endif
 			/* Do not touch lrbp after scsi done */
 			cmd->scsi_done(cmd);
 #ifdef CONFIG_SCSI_UFS_CMD_LOGGING
@@ -4362,6 +4559,8 @@ static void __ufshcd_transfer_req_compl(struct ufs_hba *hba, int reason)
 
 	/* clear corresponding bits of completed commands */
 	hba->outstanding_reqs ^= completed_reqs;
+	if (completed_reqs && !hba->outstanding_reqs)
+		ufshcd_update_dev_idle(hba, true);
 
 	if (!tr_doorbell) {
 		hba->tcx_replay_timer_expired_cnt = 0;
@@ -5259,6 +5458,8 @@ clean:
 
 	spin_lock_irqsave(host->host_lock, flags);
 	__clear_bit(tag, &hba->outstanding_reqs);
+	if (!hba->outstanding_reqs)
+		ufshcd_update_dev_idle(hba, true);
 	hba->lrb[tag].cmd = NULL;
 	spin_unlock_irqrestore(host->host_lock, flags);
 
@@ -7220,6 +7421,47 @@ latency_hist_show(struct device *dev, struct device_attribute *attr,
 static DEVICE_ATTR(latency_hist, S_IRUGO | S_IWUSR,
 		   latency_hist_show, latency_hist_store);
 
+/*
+ * 1 -> Interrupt aggregation follows the queue depth (default)
+ * 0 -> Static aggregation
+ */
+static ssize_t
+intr_aggr_adaptive_store(struct device *dev, struct device_attribute *attr,
+			 const char *buf, size_t count)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+	unsigned long flags;
+	long value;
+
+	if (kstrtol(buf, 0, &value) || (value != 0 && value != 1))
+		return -EINVAL;
+
+	pm_runtime_get_sync(hba->dev);
+	ufshcd_hold(hba, false);
+	spin_lock_irqsave(hba->host->host_lock, flags);
+	hba->intr_aggr.adaptive = value;
+	hba->intr_aggr.depth = 0;
+	if (!value && ufshcd_is_intr_aggr_allowed(hba))
+		ufshcd_config_intr_aggr(hba, hba->nutrs - 1, INT_AGGR_DEF_TO);
+	spin_unlock_irqrestore(hba->host->host_lock, flags);
+	ufshcd_release(hba);
+	pm_runtime_put_sync(hba->dev);
+
+	return count;
+}
+
+static ssize_t
+intr_aggr_adaptive_show(struct device *dev, struct device_attribute *attr,
+			char *buf)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+
+	return snprintf(buf, PAGE_SIZE, "%d\n", hba->intr_aggr.adaptive);
+}
+
+static DEVICE_ATTR(intr_aggr_adaptive, S_IRUGO | S_IWUSR,
+		   intr_aggr_adaptive_show, intr_aggr_adaptive_store);
+
 static void
 ufshcd_init_latency_hist(struct ufs_hba *hba)
 {
@@ -7227,6 +7469,26 @@ ufshcd_init_latency_hist(struct ufs_hba *hba)
 		dev_err(hba->dev, "Failed to create latency_hist sysfs entry\n");
 }
 
+static void
+ufshcd_init_intr_aggr(struct ufs_hba *hba)
+{
+	if (!ufshcd_is_intr_aggr_allowed(hba))
+		return;
+
+	hba->intr_aggr.adaptive = true;
+	if (device_create_file(hba->dev, &dev_attr_intr_aggr_adaptive))
+		dev_err(hba->dev, "Failed to create intr_aggr_adaptive sysfs entry\n");
+}
+
+static void
+ufshcd_exit_intr_aggr(struct ufs_hba *hba)
+{
+	if (!ufshcd_is_intr_aggr_allowed(hba))
+		return;
+
+	device_remove_file(hba->dev, &dev_attr_intr_aggr_adaptive);
+}
+
 static void
 ufshcd_exit_latency_hist(struct ufs_hba *hba)
 {
@@ -7247,6 +7509,7 @@ void ufshcd_remove(struct ufs_hba *hba)
 
 	ufshcd_exit_clk_gating(hba);
 	ufshcd_exit_latency_hist(hba);
+	ufshcd_exit_intr_aggr(hba);
 #if defined(CONFIG_PM_DEVFREQ)
 	if (ufshcd_is_clkscaling_enabled(hba))
 		devfreq_remove_device(hba->devfreq);
@@ -7740,6 +8003,14 @@ int ufshcd_init(struct ufs_hba *hba, void __iomem *mmio_base, unsigned int irq)
 
 	host->can_queue = hba->nutrs;
 	host->cmd_per_lun = hba->nutrs;
+#ifdef CONFIG_SCSI_UFSHCD_BLK_MQ
+	/*
+	 * UTRL has a single doorbell, so one hardware queue whose tags are
+	 * the UTRL slots. The midlayer sizes the tag set from can_queue.
+	 */
+	host->use_blk_mq = 1;
+	host->nr_hw_queues = 1;
+#endif
 	host->max_id = UFSHCD_MAX_ID;
 	host->max_lun = UFS_MAX_LUNS;
 	host->max_channel = UFSHCD_MAX_CHANNEL;
@@ -7817,6 +8088,7 @@ int ufshcd_init(struct ufs_hba *hba, void __iomem *mmio_base, unsigned int irq)
 	pm_runtime_get_sync(dev);
 
 	ufshcd_init_latency_hist(hba);
+	ufshcd_init_intr_aggr(hba);
 
 	/*
 	 * The device-initialize-sequence hasn't been invoked yet.
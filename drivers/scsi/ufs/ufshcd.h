@@ -340,6 +340,9 @@ enum clk_gating_state {
  * @active_reqs: number of requests that are pending and should be waited for
  * completion before gating clocks.
  */
+/* idle gap histogram buckets: 0ms, then [2^(i-1), 2^i) ms */
+#define UFSHCD_GAP_BUCKETS	10
+
 struct ufs_clk_gating {
 	struct delayed_work gate_work;
 	struct work_struct ungate_work;
@@ -347,7 +350,18 @@ struct ufs_clk_gating {
 	unsigned long delay_ms;
 	bool is_suspended;
 	struct device_attribute delay_attr;
+	struct device_attribute predict_attr;
 	int active_reqs;
+	/* gating delay predicted from the idle gaps */
+	bool predict;
+	unsigned long predicted_ms;
+	ktime_t idle_start;
+	unsigned int gap_hist[UFSHCD_GAP_BUCKETS];
+	unsigned int gap_samples;
+	/* cost of coming back, for the debug interface */
+	unsigned long ungate_cnt;
+	u64 ungate_us;
+	u64 h8_exit_us;
 };
 
 struct ufs_clk_scaling {
@@ -357,6 +371,20 @@ struct ufs_clk_scaling {
 	unsigned long window_start_t;
 };
 
+/**
+ * struct ufs_intr_aggr - interrupt aggregation following the queue depth
+ * @adaptive: counter and timeout follow the queue depth
+ * @cnt: programmed counter threshold, 0 if aggregation is disabled
+ * @tmout: programmed timeout
+ * @depth: average queue depth seen at completion, in 1/8 units
+ */
+struct ufs_intr_aggr {
+	bool adaptive;
+	u8 cnt;
+	u8 tmout;
+	unsigned int depth;
+};
+
 /**
  * struct ufs_init_prefetch - contains data that is pre-fetched once during
  * initialization
@@ -668,6 +696,7 @@ struct ufs_hba {
 	struct ufs_pwr_mode_info max_pwr_info;
 
 	struct ufs_clk_gating clk_gating;
+	struct ufs_intr_aggr intr_aggr;
 	/* Control to enable/disable host capabilities */
 	u32 caps;
 	/* Allow dynamic clk gating */
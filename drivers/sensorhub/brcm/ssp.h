@@ -102,6 +102,10 @@
 #endif
 
 #define SSP_SW_RESET_TIME	3000
+#define SSP_TS_SYNC_SAMPLES	8
+#define SSP_TS_SYNC_PERIOD_MS	5000
+#define SSP_TS_SYNC_MAX_STEP	NSEC_PER_SEC
+#define SSP_TS_SYNC_MAX_DRIFT	1000000	/* ppb */
 #define DEFUALT_POLLING_DELAY	(200 * NSEC_PER_MSEC)
 #define PROX_AVG_READ_NUM	80
 #define DEFAULT_RETRIES		3
@@ -618,6 +622,30 @@ struct ssp_time_diff {
 };
 #endif
 
+struct ssp_ring;
+
+/* offset and drift of the MCU clock against AP boottime */
+struct ssp_ts_sync {
+	u64 ap[SSP_TS_SYNC_SAMPLES];
+	u64 mcu[SSP_TS_SYNC_SAMPLES];
+	int head;
+	int count;
+	s64 offset;		/* AP - MCU at mcu_ref, ns */
+	s64 drift_ppb;
+	u64 mcu_ref;
+	s64 sent_offset;	/* offset the MCU applies to its timestamps */
+	bool sent;
+	u64 last_sync;
+	u32 syncs;
+};
+
+struct ssp_latency {
+	u64 last;
+	u64 max;
+	u64 sum;
+	u32 count;
+};
+
 struct ssp_data {
 	struct iio_dev *indio_dev[SENSOR_MAX];
 	struct iio_dev *indio_scontext_dev;
@@ -914,7 +942,14 @@ struct ssp_data {
 
 /* variables for timestamp sync */
 	struct delayed_work work_ssp_tiemstamp_sync;
+	struct delayed_work work_ssp_ts_resync;
 	u64 timestamp_offset;
+	spinlock_t ts_sync_lock;
+	struct ssp_ts_sync ts_sync;
+	struct ssp_latency latency[SENSOR_MAX];
+
+/* mmap ring for batched delivery of high rate sensors */
+	struct ssp_ring *ring;
 
 /* information of sensorhub for big data */
 	bool IsGpsWorking;
@@ -942,6 +977,12 @@ struct reg_index_table {
 
 int ssp_iio_configure_ring(struct iio_dev *indio_dev);
 void ssp_iio_unconfigure_ring(struct iio_dev *indio_dev);
+int ssp_ring_initialize(struct ssp_data *data);
+void ssp_ring_remove(struct ssp_data *data);
+bool ssp_ring_push(struct ssp_data *data, int type, u8 *buf, int len,
+		u64 timestamp);
+void ssp_ring_flush(struct ssp_data *data);
+bool ssp_ring_routed(struct ssp_data *data, int type);
 int ssp_iio_probe_trigger(struct ssp_data *data,
 		struct iio_dev *indio_dev, struct iio_trigger *trig);
 void ssp_iio_remove_trigger(struct iio_trigger *trig);
@@ -1148,6 +1189,7 @@ int send_sensor_dump_command(struct ssp_data *data, u8 sensor_type);
 int send_all_sensor_dump_command(struct ssp_data *data);
 
 void ssp_timestamp_sync_work_func(struct work_struct *work);
+void ssp_ts_resync_work_func(struct work_struct *work);
 void ssp_reset_work_func(struct work_struct *work);
 void set_AccelCalibrationInfoData(char *pchRcvDataFrame, int *iDataIdx);
 void set_GyroCalibrationInfoData(char *pchRcvDataFrame, int *iDataIdx);
@@ -78,6 +78,51 @@ exit_current:
 	return ret;
 }
 
+/*
+ * The MCU stamps samples as its own clock plus the offset sent with the
+ * last timestamp sync. Apply the offset and drift measured since then.
+ */
+static u64 ssp_ts_sync_correct(struct ssp_data *data, u64 timestamp)
+{
+	struct ssp_ts_sync *sync = &data->ts_sync;
+	unsigned long flags;
+	s64 mcu, corr;
+
+	spin_lock_irqsave(&data->ts_sync_lock, flags);
+	if (!sync->sent || sync->count < 3) {
+		spin_unlock_irqrestore(&data->ts_sync_lock, flags);
+		return timestamp;
+	}
+
+	mcu = (s64)timestamp - sync->sent_offset;
+	corr = sync->offset - sync->sent_offset +
+		div_s64((mcu - (s64)sync->mcu_ref) * sync->drift_ppb,
+			NSEC_PER_SEC);
+	spin_unlock_irqrestore(&data->ts_sync_lock, flags);
+
+	if (abs(corr) > SSP_TS_SYNC_MAX_STEP)
+		return timestamp;
+
+	return timestamp + corr;
+}
+
+static void ssp_account_latency(struct ssp_data *data, int sensor_type,
+		u64 update_timestamp, u64 current_timestamp)
+{
+	struct ssp_latency *lat = &data->latency[sensor_type];
+	u64 delay;
+
+	if (current_timestamp < update_timestamp)
+		return;
+
+	delay = current_timestamp - update_timestamp;
+	lat->last = delay;
+	if (delay > lat->max)
+		lat->max = delay;
+	lat->sum += delay;
+	lat->count++;
+}
+
 static void get_timestamp(struct ssp_data *data, char *pchRcvDataFrame,
 		int *iDataIdx, struct sensor_value *sensorsdata,
 		u16 batch_mode, int sensor_type)
@@ -89,7 +134,12 @@ static void get_timestamp(struct ssp_data *data, char *pchRcvDataFrame,
 	memset(&time_delta_ns, 0, 8);
 	memcpy(&time_delta_ns, pchRcvDataFrame + *iDataIdx, 8);
 
+	time_delta_ns = ssp_ts_sync_correct(data, time_delta_ns);
 	update_timestamp = time_delta_ns;
+	/* batched samples are held back on purpose */
+	if (batch_mode != BATCH_MODE_RUN)
+		ssp_account_latency(data, sensor_type, update_timestamp,
+				current_timestamp);
 	ssp_debug_time("[SSP_DEBUG_TIME] sensor_type: %2d update_ts: %lld current_ts: %lld diff: %lld latency: %lld\n",
 			sensor_type, update_timestamp, current_timestamp,
 			update_timestamp - data->lastTimestamp[sensor_type], current_timestamp - update_timestamp);
@@ -501,7 +551,9 @@ void ssp_batch_report(struct ssp_data *data)
 			return;
 		}
 
-		usleep_range(150, 151);
+		/* pacing is only needed by the IIO kfifo readers */
+		if (!ssp_ring_routed(data, sensor_type))
+			usleep_range(150, 151);
 		//ssp_dbg("[SSP_BAT] cnt %d\n", count);
 		data->get_sensor_data[sensor_type](data->batch_event.batch_data, &idx_data, &sensor_data);
 
@@ -513,6 +565,7 @@ void ssp_batch_report(struct ssp_data *data)
 		data->reportedData[sensor_type] = true;
 		count++;
 	}
+	ssp_ring_flush(data);
 	ssp_dbg("[SSP_BAT] max cnt %d\n", count);
 }
 
@@ -624,13 +677,95 @@ int handle_big_data(struct ssp_data *data, char *pchRcvDataFrame, int *pDataIdx)
 	return SUCCESS;
 }
 
+/*
+ * Fit the drift as the least squares slope of (AP - MCU) over the sync
+ * history. The transport delay only ever adds to the AP side, so the
+ * offset is the lower envelope of the drift corrected samples.
+ */
+static void ssp_ts_sync_fit(struct ssp_ts_sync *sync)
+{
+	s64 sx = 0, sy = 0, sxx = 0, sxy = 0;
+	s64 n = sync->count, num, den, off0, best = S64_MAX;
+	int newest = (sync->head + SSP_TS_SYNC_SAMPLES - 1) % SSP_TS_SYNC_SAMPLES;
+	int oldest = (sync->head + SSP_TS_SYNC_SAMPLES - sync->count) %
+			SSP_TS_SYNC_SAMPLES;
+	int i, j;
+
+	sync->mcu_ref = sync->mcu[newest];
+	off0 = (s64)(sync->ap[oldest] - sync->mcu[oldest]);
+
+	for (i = 0; i < sync->count; i++) {
+		/* x in ms, y in ns keeps the sums well inside s64 */
+		s64 x, y;
+
+		j = (oldest + i) % SSP_TS_SYNC_SAMPLES;
+		x = div_s64((s64)(sync->mcu[j] - sync->mcu[oldest]),
+			NSEC_PER_MSEC);
+		y = (s64)(sync->ap[j] - sync->mcu[j]) - off0;
+		sx += x;
+		sy += y;
+		sxx += x * x;
+		sxy += x * y;
+	}
+
+	den = n * sxx - sx * sx;
+	if (n >= 3 && den > 0) {
+		/* ns per ms is ppm */
+		num = (n * sxy - sx * sy) * 1000;
+		sync->drift_ppb = clamp_t(s64, div64_s64(num, den),
+				-SSP_TS_SYNC_MAX_DRIFT, SSP_TS_SYNC_MAX_DRIFT);
+	} else {
+		sync->drift_ppb = 0;
+	}
+
+	for (i = 0; i < sync->count; i++) {
+		s64 off;
+
+		j = (oldest + i) % SSP_TS_SYNC_SAMPLES;
+		off = (s64)(sync->ap[j] - sync->mcu[j]) +
+			div_s64((s64)(sync->mcu_ref - sync->mcu[j]) *
+				sync->drift_ppb, NSEC_PER_SEC);
+		if (off < best)
+			best = off;
+	}
+	sync->offset = best;
+}
+
 void handle_timestamp_sync(struct ssp_data *data, char *pchRcvDataFrame, int *index)
 {
+	struct ssp_ts_sync *sync = &data->ts_sync;
 	u64 mcu_timestamp;
 	u64 current_timestamp = get_current_timestamp();
+	unsigned long flags;
 
 	memcpy(&mcu_timestamp, pchRcvDataFrame + *index, sizeof(mcu_timestamp));
-	data->timestamp_offset = current_timestamp - mcu_timestamp;
+
+	spin_lock_irqsave(&data->ts_sync_lock, flags);
+	/* the MCU clock restarted or stepped, the history is useless */
+	if (sync->count) {
+		int last = (sync->head + SSP_TS_SYNC_SAMPLES - 1) %
+				SSP_TS_SYNC_SAMPLES;
+		s64 step = (s64)(current_timestamp - mcu_timestamp) -
+				sync->offset;
+
+		if (mcu_timestamp <= sync->mcu[last] ||
+		    abs(step) > SSP_TS_SYNC_MAX_STEP) {
+			sync->count = 0;
+			sync->sent = false;
+		}
+	}
+
+	sync->ap[sync->head] = current_timestamp;
+	sync->mcu[sync->head] = mcu_timestamp;
+	sync->head = (sync->head + 1) % SSP_TS_SYNC_SAMPLES;
+	if (sync->count < SSP_TS_SYNC_SAMPLES)
+		sync->count++;
+	ssp_ts_sync_fit(sync);
+	sync->last_sync = current_timestamp;
+	sync->syncs++;
+	data->timestamp_offset = sync->offset;
+	spin_unlock_irqrestore(&data->ts_sync_lock, flags);
+
 	queue_delayed_work(system_power_efficient_wq, &data->work_ssp_tiemstamp_sync, msecs_to_jiffies(100));
 
 	*index += 8;
@@ -777,6 +912,7 @@ int parse_dataframe(struct ssp_data *data, char *pchRcvDataFrame, int iLength)
 	}
 	if (data->pktErrCnt >= 1) // if input error packet doesn't comes continually, do not reset
 		data->pktErrCnt = 0;
+	ssp_ring_flush(data);
 	return SUCCESS;
 error_return:
 	pr_err("[SSP] %s err Inst 0x%02x\n", __func__, msg_inst);
@@ -629,8 +629,50 @@ void ssp_timestamp_sync_work_func(struct work_struct *work)
 	pr_info("handle_timestamp_sync: %lld\n", data->timestamp_offset);
 	memcpy(msg->buffer, &(data->timestamp_offset), sizeof(data->timestamp_offset));
 
-	ssp_spi_sync(data, msg, 1000);
+	if (ssp_spi_sync(data, msg, 1000) == SUCCESS) {
+		unsigned long flags;
+
+		spin_lock_irqsave(&data->ts_sync_lock, flags);
+		data->ts_sync.sent_offset = data->timestamp_offset;
+		data->ts_sync.sent = true;
+		spin_unlock_irqrestore(&data->ts_sync_lock, flags);
+	}
 	//pr_info("[SSP] %s : Motor state %d, iRet %d\n",__func__, data->motor_state, iRet);
+
+	mod_delayed_work(system_power_efficient_wq, &data->work_ssp_ts_resync,
+		msecs_to_jiffies(SSP_TS_SYNC_PERIOD_MS));
+}
+
+/* Hand the MCU our time, it answers with a fresh timestamp sync */
+void ssp_ts_resync_work_func(struct work_struct *work)
+{
+	struct ssp_data *data = container_of((struct delayed_work *)work,
+					struct ssp_data, work_ssp_ts_resync);
+	struct ssp_msg *msg;
+	u64 timestamp;
+
+	if (data->bSspShutdown || data->resetting)
+		return;
+
+	msg = kzalloc(sizeof(*msg), GFP_KERNEL);
+	if (msg == NULL)
+		return;
+
+	msg->cmd = MSG2SSP_INST_CURRENT_TIMESTAMP;
+	msg->length = sizeof(timestamp);
+	msg->options = AP2HUB_WRITE;
+	msg->buffer = (char *) kzalloc(sizeof(timestamp), GFP_KERNEL);
+	msg->free_buffer = 1;
+	if (msg->buffer == NULL) {
+		kfree(msg);
+		return;
+	}
+
+	timestamp = get_current_timestamp();
+	memcpy(msg->buffer, &timestamp, sizeof(timestamp));
+
+	if (ssp_spi_async(data, msg) != SUCCESS)
+		pr_err("[SSP]: %s - timestamp resync failed\n", __func__);
 }
 
 void ssp_reset_work_func(struct work_struct *work)
@@ -853,6 +895,8 @@ static int ssp_probe(struct spi_device *spi)
 #endif
 
 	INIT_DELAYED_WORK(&data->work_ssp_tiemstamp_sync, ssp_timestamp_sync_work_func);
+	INIT_DELAYED_WORK(&data->work_ssp_ts_resync, ssp_ts_resync_work_func);
+	spin_lock_init(&data->ts_sync_lock);
 	INIT_DELAYED_WORK(&data->work_ssp_reset, ssp_reset_work_func);
 
 	goto exit;
@@ -930,6 +974,9 @@ static void ssp_shutdown(struct spi_device *spi)
 
 	bbd_register(NULL, NULL);
 
+	cancel_delayed_work_sync(&data->work_ssp_tiemstamp_sync);
+	cancel_delayed_work_sync(&data->work_ssp_ts_resync);
+
 	mutex_lock(&shutdown_lock);
 
 	cancel_work_sync(&data->work_bbd_on_packet); /* should be cancel before removing iio dev */
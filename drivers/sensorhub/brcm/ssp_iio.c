@@ -159,6 +159,9 @@ void report_meta_data(struct ssp_data *data, struct sensor_value *s)
 void report_iio_data(struct ssp_data *data, int type, struct sensor_value *sensor_data)
 {
 	memcpy(&data->buf[type], sensor_data, sensors_info[type].get_data_len);
+	if (ssp_ring_push(data, type, (u8 *)(&data->buf[type]),
+			sensors_info[type].report_data_len, sensor_data->timestamp))
+		return;
 	ssp_push_iio_buffer(data->indio_dev[type], sensor_data->timestamp, (u8 *)(&data->buf[type]), sensors_info[type].report_data_len);
 }
 
@@ -517,10 +520,13 @@ int initialize_input_dev(struct ssp_data *data)
 		}
 	}
 
+	/* optional, sensors stay on IIO without it */
+	ssp_ring_initialize(data);
+
 	return iRet;
 }
 
 void remove_input_dev(struct ssp_data *data)
 {
-	return;
+	ssp_ring_remove(data);
 }
@@ -35,6 +35,38 @@
 
 #define PROX_AVG_READ_NUM	80
 
+/*
+ * Shared ring of /dev/ssp_sensor_ring. The first page holds the header,
+ * records follow from the second page. The driver advances head, the
+ * reader consumes records from its mmap and writes tail back.
+ */
+#define SSP_RING_RECORDS	2048
+#define SSP_RING_DATA_MAX	16
+
+struct ssp_ring_header {
+	__u32 head;
+	__u32 tail;
+	__u32 records;
+	__u32 record_size;
+	__u32 dropped;
+	__u32 watermark;
+};
+
+struct ssp_ring_record {
+	__u8 type;
+	__u8 len;
+	__u16 reserved;
+	__u32 seq;
+	__u64 timestamp;
+	__u8 data[SSP_RING_DATA_MAX];
+};
+
+#define SSP_RING_IOCTL_MAGIC		0xFB
+/* bitmask of sensor types delivered through the ring instead of IIO */
+#define SSP_RING_IOCTL_SET_MASK		_IOW(SSP_RING_IOCTL_MAGIC, 1, __u64)
+/* poll() reports POLLIN once this many records are pending */
+#define SSP_RING_IOCTL_SET_WATERMARK	_IOW(SSP_RING_IOCTL_MAGIC, 2, __u32)
+
 struct sensor_value;
 
 void report_sensor_data(struct ssp_data *, int, struct sensor_value *);
@@ -28,8 +28,11 @@
 #include <linux/kfifo.h>
 #include <linux/poll.h>
 #include <linux/miscdevice.h>
+#include <linux/vmalloc.h>
+#include <linux/mm.h>
 
 #include "ssp.h"
+#include "ssp_iio.h"
 #include <linux/iio/iio.h>
 #include <linux/iio/kfifo_buf.h>
 #include <linux/iio/trigger_consumer.h>
@@ -86,3 +89,238 @@ int ssp_iio_configure_ring(struct iio_dev *indio_dev)
 	return 0;
 }
 
+
+struct ssp_ring {
+	struct miscdevice misc;
+	void *buf;
+	struct ssp_ring_header *hdr;
+	struct ssp_ring_record *rec;
+	spinlock_t lock;
+	wait_queue_head_t wait;
+	atomic_t opened;
+	u64 mask;
+	/*
+	 * The header is mapped writable by the reader, so the kernel keeps
+	 * its own indices and only publishes them; anything read back from
+	 * the header is masked before use.
+	 */
+	u32 head;
+	u32 seq;
+	u32 dropped;
+	u32 watermark;
+};
+
+#define SSP_RING_BYTES	(PAGE_SIZE + \
+		PAGE_ALIGN(SSP_RING_RECORDS * sizeof(struct ssp_ring_record)))
+
+static u32 ssp_ring_pending(struct ssp_ring *ring)
+{
+	u32 tail = READ_ONCE(ring->hdr->tail) % SSP_RING_RECORDS;
+
+	return (ring->head + SSP_RING_RECORDS - tail) % SSP_RING_RECORDS;
+}
+
+bool ssp_ring_routed(struct ssp_data *data, int type)
+{
+	return data->ring && (READ_ONCE(data->ring->mask) & (1ULL << type));
+}
+
+/*
+ * Queue one sample for the ring reader. Returns false if the sensor is
+ * not routed to the ring, so that the caller reports it through IIO.
+ * The record is dropped, and counted, if the reader is a full ring behind.
+ */
+bool ssp_ring_push(struct ssp_data *data, int type, u8 *buf, int len,
+		u64 timestamp)
+{
+	struct ssp_ring *ring = data->ring;
+	struct ssp_ring_record *rec;
+	unsigned long flags;
+	u32 head;
+
+	if (!ssp_ring_routed(data, type) || len > SSP_RING_DATA_MAX)
+		return false;
+
+	spin_lock_irqsave(&ring->lock, flags);
+
+	head = ring->head;
+	if (ssp_ring_pending(ring) == SSP_RING_RECORDS - 1) {
+		ring->hdr->dropped = ++ring->dropped;
+		goto out;
+	}
+
+	rec = &ring->rec[head];
+	rec->type = type;
+	rec->len = len;
+	rec->seq = ring->seq++;
+	rec->timestamp = timestamp;
+	memcpy(rec->data, buf, len);
+
+	/* record before index, the reader does not take the lock */
+	smp_wmb();
+	ring->head = (head + 1) % SSP_RING_RECORDS;
+	WRITE_ONCE(ring->hdr->head, ring->head);
+out:
+	spin_unlock_irqrestore(&ring->lock, flags);
+
+	return true;
+}
+
+/* Called once per MCU frame: wake the reader only past its watermark */
+void ssp_ring_flush(struct ssp_data *data)
+{
+	struct ssp_ring *ring = data->ring;
+
+	if (!ring || !READ_ONCE(ring->mask))
+		return;
+
+	if (ssp_ring_pending(ring) >= max_t(u32, ring->watermark, 1))
+		wake_up_interruptible(&ring->wait);
+}
+
+static int ssp_ring_open(struct inode *inode, struct file *file)
+{
+	struct ssp_ring *ring = container_of(file->private_data,
+			struct ssp_ring, misc);
+
+	if (atomic_cmpxchg(&ring->opened, 0, 1))
+		return -EBUSY;
+
+	return nonseekable_open(inode, file);
+}
+
+static int ssp_ring_release(struct inode *inode, struct file *file)
+{
+	struct ssp_ring *ring = container_of(file->private_data,
+			struct ssp_ring, misc);
+	unsigned long flags;
+
+	/* back to IIO if the reader goes away */
+	spin_lock_irqsave(&ring->lock, flags);
+	WRITE_ONCE(ring->mask, 0);
+	ring->head = 0;
+	ring->hdr->head = 0;
+	ring->hdr->tail = 0;
+	spin_unlock_irqrestore(&ring->lock, flags);
+
+	atomic_set(&ring->opened, 0);
+
+	return 0;
+}
+
+static unsigned int ssp_ring_poll(struct file *file, poll_table *wait)
+{
+	struct ssp_ring *ring = container_of(file->private_data,
+			struct ssp_ring, misc);
+
+	poll_wait(file, &ring->wait, wait);
+
+	if (ssp_ring_pending(ring) >= max_t(u32, ring->watermark, 1))
+		return POLLIN | POLLRDNORM;
+
+	return 0;
+}
+
+static int ssp_ring_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	struct ssp_ring *ring = container_of(file->private_data,
+			struct ssp_ring, misc);
+
+	if (vma->vm_pgoff ||
+			vma->vm_end - vma->vm_start > SSP_RING_BYTES)
+		return -EINVAL;
+
+	return remap_vmalloc_range(vma, ring->buf, 0);
+}
+
+static long ssp_ring_ioctl(struct file *file, unsigned int cmd,
+		unsigned long arg)
+{
+	struct ssp_ring *ring = container_of(file->private_data,
+			struct ssp_ring, misc);
+	void __user *argp = (void __user *)arg;
+	u64 mask;
+	u32 watermark;
+
+	switch (cmd) {
+	case SSP_RING_IOCTL_SET_MASK:
+		if (copy_from_user(&mask, argp, sizeof(mask)))
+			return -EFAULT;
+		WRITE_ONCE(ring->mask, mask);
+		pr_info("[SSP] ring mask 0x%llx\n", mask);
+		return 0;
+	case SSP_RING_IOCTL_SET_WATERMARK:
+		if (copy_from_user(&watermark, argp, sizeof(watermark)))
+			return -EFAULT;
+		if (watermark >= SSP_RING_RECORDS)
+			return -EINVAL;
+		ring->watermark = watermark;
+		ring->hdr->watermark = watermark;
+		return 0;
+	default:
+		return -ENOTTY;
+	}
+}
+
+static const struct file_operations ssp_ring_fops = {
+	.owner = THIS_MODULE,
+	.open = ssp_ring_open,
+	.release = ssp_ring_release,
+	.poll = ssp_ring_poll,
+	.mmap = ssp_ring_mmap,
+	.unlocked_ioctl = ssp_ring_ioctl,
+};
+
+int ssp_ring_initialize(struct ssp_data *data)
+{
+	struct ssp_ring *ring;
+	int ret;
+
+	ring = kzalloc(sizeof(*ring), GFP_KERNEL);
+	if (!ring)
+		return -ENOMEM;
+
+	ring->buf = vmalloc_user(SSP_RING_BYTES);
+	if (!ring->buf) {
+		ret = -ENOMEM;
+		goto err_alloc;
+	}
+	ring->hdr = ring->buf;
+	ring->rec = ring->buf + PAGE_SIZE;
+	ring->hdr->records = SSP_RING_RECORDS;
+	ring->hdr->record_size = sizeof(struct ssp_ring_record);
+
+	spin_lock_init(&ring->lock);
+	init_waitqueue_head(&ring->wait);
+
+	ring->misc.minor = MISC_DYNAMIC_MINOR;
+	ring->misc.name = "ssp_sensor_ring";
+	ring->misc.fops = &ssp_ring_fops;
+	ret = misc_register(&ring->misc);
+	if (ret)
+		goto err_register;
+
+	data->ring = ring;
+
+	return 0;
+
+err_register:
+	vfree(ring->buf);
+err_alloc:
+	kfree(ring);
+	pr_err("[SSP]: %s - failed %d\n", __func__, ret);
+	return ret;
+}
+
+void ssp_ring_remove(struct ssp_data *data)
+{
+	struct ssp_ring *ring = data->ring;
+
+	if (!ring)
+		return;
+
+	data->ring = NULL;
+	misc_deregister(&ring->misc);
+	vfree(ring->buf);
+	kfree(ring);
+}
@@ -1396,6 +1396,61 @@ static ssize_t reset_info_show(struct device *dev,
 	return ret;
 }
 
+static ssize_t time_sync_show(struct device *dev,
+	struct device_attribute *attr, char *buf)
+{
+	struct ssp_data *data = dev_get_drvdata(dev);
+	struct ssp_ts_sync sync;
+	unsigned long flags;
+	u64 age = 0;
+
+	spin_lock_irqsave(&data->ts_sync_lock, flags);
+	sync = data->ts_sync;
+	spin_unlock_irqrestore(&data->ts_sync_lock, flags);
+
+	if (sync.syncs)
+		age = div_u64(get_current_timestamp() - sync.last_sync,
+			NSEC_PER_MSEC);
+
+	return snprintf(buf, PAGE_SIZE,
+		"offset %lld ns\ndrift %lld ppb\nsamples %d\nsyncs %u\nage %llu ms\n",
+		sync.offset, sync.drift_ppb, sync.count, sync.syncs, age);
+}
+
+static ssize_t sensor_latency_show(struct device *dev,
+	struct device_attribute *attr, char *buf)
+{
+	struct ssp_data *data = dev_get_drvdata(dev);
+	int type, len = 0;
+
+	for (type = 0; type < SENSOR_MAX; type++) {
+		struct ssp_latency *lat = &data->latency[type];
+
+		if (!lat->count)
+			continue;
+
+		len += snprintf(buf + len, PAGE_SIZE - len,
+			"%d last %llu avg %llu max %llu us (%u)\n", type,
+			div_u64(lat->last, NSEC_PER_USEC),
+			div_u64(div_u64(lat->sum, lat->count), NSEC_PER_USEC),
+			div_u64(lat->max, NSEC_PER_USEC), lat->count);
+		if (len >= PAGE_SIZE)
+			return PAGE_SIZE - 1;
+	}
+
+	return len;
+}
+
+static ssize_t sensor_latency_store(struct device *dev,
+	struct device_attribute *attr, const char *buf, size_t size)
+{
+	struct ssp_data *data = dev_get_drvdata(dev);
+
+	memset(data->latency, 0, sizeof(data->latency));
+
+	return size;
+}
+
 static DEVICE_ATTR(poll_delay, 0664, show_sensor_delay, set_sensor_delay);
 
 static DEVICE_ATTR(mcu_rev, 0444, mcu_revision_show, NULL);
@@ -1505,6 +1560,9 @@ static DEVICE_ATTR(ssp_control, 0220, NULL, set_ssp_control);
 static DEVICE_ATTR(sensor_dump, 0664,
 	sensor_dump_show, sensor_dump_store);
 static DEVICE_ATTR(reset_info, 0440, reset_info_show, NULL);
+static DEVICE_ATTR(time_sync, 0444, time_sync_show, NULL);
+static DEVICE_ATTR(sensor_latency, 0664,
+	sensor_latency_show, sensor_latency_store);
 
 
 /*
@@ -1562,6 +1620,8 @@ static struct device_attribute *mcu_attrs[] = {
 	&dev_attr_register_rw,
 #endif
 	&dev_attr_reset_info,
+	&dev_attr_time_sync,
+	&dev_attr_sensor_latency,
 	NULL,
 };
 
@@ -15,6 +15,7 @@
 #include <linux/of_address.h>
 #include <linux/platform_device.h>
 #include <linux/debugfs.h>
+#include <linux/seq_file.h>
 #include <linux/interrupt.h>
 #include <linux/slab.h>
 #include <linux/exynos-ss.h>
@@ -205,6 +206,18 @@ DEFINE_SIMPLE_ATTRIBUTE(debug_log_level_fops,
 DEFINE_SIMPLE_ATTRIBUTE(debug_ipc_loopback_test_fops,
 		debug_ipc_loopback_test_get, debug_ipc_loopback_test_set, "%llu\n");
 
+static int debug_ipc_latency_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, acpm_ipc_latency_show, inode->i_private);
+}
+
+static const struct file_operations debug_ipc_latency_fops = {
+	.open		= debug_ipc_latency_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
 static void acpm_debugfs_init(struct acpm_info *acpm)
 {
 	struct dentry *den;
@@ -212,6 +225,7 @@ static void acpm_debugfs_init(struct acpm_info *acpm)
 	den = debugfs_create_dir("acpm_framework", NULL);
 	debugfs_create_file("ipc_loopback_test", 0644, den, acpm, &debug_ipc_loopback_test_fops);
 	debugfs_create_file("log_level", 0644, den, NULL, &debug_log_level_fops);
+	debugfs_create_file("ipc_latency", 0444, den, NULL, &debug_ipc_latency_fops);
 }
 
 void *memcpy_align_4(void *dest, const void *src, unsigned int n)
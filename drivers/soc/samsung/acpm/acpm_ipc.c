@@ -19,6 +19,7 @@
 #include <linux/list.h>
 #include <linux/wait.h>
 #include <linux/slab.h>
+#include <linux/seq_file.h>
 
 #include "acpm.h"
 #include "acpm_ipc.h"
@@ -237,6 +238,53 @@ unsigned int acpm_ipc_release_channel(struct device_node *np, unsigned int chann
 	return 0;
 }
 
+static void latency_update(struct acpm_ipc_ch *channel, struct ipc_latency *lat,
+		unsigned long long start)
+{
+	unsigned long long delta = sched_clock() - start;
+	unsigned long flags;
+
+	spin_lock_irqsave(&channel->async_lock, flags);
+	lat->count++;
+	lat->total += delta;
+	if (delta > lat->max)
+		lat->max = delta;
+	spin_unlock_irqrestore(&channel->async_lock, flags);
+}
+
+/* Hand a response to the asynchronous request that sent it, if any */
+static bool complete_async(struct acpm_ipc_ch *channel, unsigned int *cmd)
+{
+	unsigned int seq_num = (cmd[0] >> ACPM_IPC_PROTOCOL_SEQ_NUM) & 0x3f;
+	struct ipc_async_req *req, *found = NULL;
+	unsigned long flags;
+
+	if (seq_num < ACPM_IPC_SEQ_ASYNC)
+		return false;
+
+	spin_lock_irqsave(&channel->async_lock, flags);
+	channel->async_busy &= ~BIT(seq_num - ACPM_IPC_SEQ_ASYNC);
+	list_for_each_entry(req, &channel->async_list, list) {
+		if (req->seq_num == seq_num) {
+			list_del_init(&req->list);
+			found = req;
+			break;
+		}
+	}
+	spin_unlock_irqrestore(&channel->async_lock, flags);
+
+	/* the request was cancelled, nobody waits for it */
+	if (!found)
+		return true;
+
+	latency_update(channel, &channel->async_lat, found->queued);
+	memcpy_align_4(found->cmd, cmd, channel->rx_ch.size);
+	if (found->done)
+		found->done(found->cmd, channel->rx_ch.size, found->priv);
+
+	return true;
+}
+
 static bool check_response(struct acpm_ipc_ch *channel, struct ipc_config *cfg)
 {
 	unsigned int front;
@@ -338,7 +386,7 @@ static void dequeue_policy(struct acpm_ipc_ch *channel)
 		else
 			rear++;
 
-		if (!channel->polling)
+		if (!complete_async(channel, channel->cmd) && !channel->polling)
 			complete(&channel->wait);
 
 		__raw_writel(rear, channel->rx_ch.rear);
@@ -438,6 +486,7 @@ int acpm_ipc_send_data_sync(unsigned int channel_id, struct ipc_config *cfg)
 {
 	int ret;
 	struct acpm_ipc_ch *channel;
+	unsigned long long start = sched_clock();
 
 	ret = acpm_ipc_send_data(channel_id, cfg);
 
@@ -451,6 +500,7 @@ int acpm_ipc_send_data_sync(unsigned int channel_id, struct ipc_config *cfg)
 				pr_err("[%s] ipc_timeout!!!\n", __func__);
 				ret = -ETIMEDOUT;
 			} else {
+				latency_update(channel, &channel->sync_lat, start);
 				ret = 0;
 			}
 		}
@@ -459,6 +509,178 @@ int acpm_ipc_send_data_sync(unsigned int channel_id, struct ipc_config *cfg)
 	return ret;
 }
 
+/* Next async sequence number with no response outstanding, or 0 */
+static unsigned int async_seq_get(struct acpm_ipc_ch *channel)
+{
+	unsigned int seq_num = channel->async_seq_num;
+	int i;
+
+	for (i = ACPM_IPC_SEQ_ASYNC; i < ACPM_IPC_SEQ_MAX; i++) {
+		if (++seq_num >= ACPM_IPC_SEQ_MAX || seq_num < ACPM_IPC_SEQ_ASYNC)
+			seq_num = ACPM_IPC_SEQ_ASYNC;
+
+		if (!(channel->async_busy & BIT(seq_num - ACPM_IPC_SEQ_ASYNC))) {
+			channel->async_busy |= BIT(seq_num - ACPM_IPC_SEQ_ASYNC);
+			channel->async_seq_num = seq_num;
+			return seq_num;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Put a command in the channel's TX queue without ringing APM. Several
+ * commands can be queued back to back and sent with a single
+ * acpm_ipc_flush_async(). Never waits: -EBUSY is returned when the queue
+ * is full, after ringing APM so that it drains, or when all the async
+ * sequence numbers are in flight.
+ * Only interrupt driven queue channels complete asynchronous requests.
+ */
+int acpm_ipc_queue_async(unsigned int channel_id, struct ipc_async_req *req)
+{
+	struct acpm_ipc_ch *channel;
+	unsigned int front;
+	unsigned int tmp_index;
+	unsigned long flags;
+
+	if (channel_id >= acpm_ipc->num_channels || !req || !req->cmd)
+		return -EIO;
+
+	channel = &acpm_ipc->channel[channel_id];
+	if (channel->polling || channel->type == TYPE_BUFFER)
+		return -EINVAL;
+
+	spin_lock_irqsave(&channel->tx_lock, flags);
+
+	front = __raw_readl(channel->tx_ch.front);
+	tmp_index = front + 1;
+	if (tmp_index >= channel->tx_ch.len)
+		tmp_index = 0;
+
+	if (tmp_index == __raw_readl(channel->tx_ch.rear)) {
+		if (channel->async_kick) {
+			apm_interrupt_gen(channel->id);
+			channel->async_kick = false;
+		}
+		spin_unlock_irqrestore(&channel->tx_lock, flags);
+		return -EBUSY;
+	}
+
+	/* visible to the irq thread before APM can answer */
+	spin_lock(&channel->async_lock);
+	req->seq_num = async_seq_get(channel);
+	if (!req->seq_num) {
+		spin_unlock(&channel->async_lock);
+		spin_unlock_irqrestore(&channel->tx_lock, flags);
+		return -EBUSY;
+	}
+
+	req->cmd[0] &= ~(0x3f << ACPM_IPC_PROTOCOL_SEQ_NUM);
+	req->cmd[0] |= (req->seq_num & 0x3f) << ACPM_IPC_PROTOCOL_SEQ_NUM;
+	req->queued = sched_clock();
+	list_add_tail(&req->list, &channel->async_list);
+	channel->async_cmds++;
+	spin_unlock(&channel->async_lock);
+
+	memcpy_align_4(channel->tx_ch.base + channel->tx_ch.size * front, req->cmd,
+			channel->tx_ch.size);
+	__raw_writel(tmp_index, channel->tx_ch.front);
+	channel->async_kick = true;
+
+	spin_unlock_irqrestore(&channel->tx_lock, flags);
+
+	return 0;
+}
+
+/* Ring APM once for everything queued since the last flush */
+void acpm_ipc_flush_async(unsigned int channel_id)
+{
+	struct acpm_ipc_ch *channel;
+	unsigned long flags;
+
+	if (channel_id >= acpm_ipc->num_channels)
+		return;
+
+	channel = &acpm_ipc->channel[channel_id];
+
+	spin_lock_irqsave(&channel->tx_lock, flags);
+	if (channel->async_kick) {
+		timestamp_write();
+		apm_interrupt_gen(channel->id);
+		channel->async_kick = false;
+		channel->async_batches++;
+	}
+	spin_unlock_irqrestore(&channel->tx_lock, flags);
+}
+
+int acpm_ipc_send_data_async(unsigned int channel_id, struct ipc_async_req *req)
+{
+	int ret;
+
+	ret = acpm_ipc_queue_async(channel_id, req);
+	if (!ret)
+		acpm_ipc_flush_async(channel_id);
+
+	return ret;
+}
+
+/*
+ * Forget a request that is still waiting for its response, e.g. when the
+ * client times out on its own. Returns false if done() already ran or is
+ * about to run. Its sequence number is not reused until the late response
+ * has arrived and been dropped.
+ */
+bool acpm_ipc_cancel_async(unsigned int channel_id, struct ipc_async_req *req)
+{
+	struct acpm_ipc_ch *channel;
+	unsigned long flags;
+	bool pending;
+
+	if (channel_id >= acpm_ipc->num_channels)
+		return false;
+
+	channel = &acpm_ipc->channel[channel_id];
+
+	spin_lock_irqsave(&channel->async_lock, flags);
+	pending = !list_empty(&req->list);
+	if (pending)
+		list_del_init(&req->list);
+	spin_unlock_irqrestore(&channel->async_lock, flags);
+
+	return pending;
+}
+
+int acpm_ipc_latency_show(struct seq_file *s, void *unused)
+{
+	struct acpm_ipc_ch *channel;
+	int i;
+
+	seq_puts(s, "ch  sync_cnt  sync_avg(ns)  sync_max(ns)  async_cnt  async_avg(ns)  async_max(ns)  cmds/batch\n");
+
+	for (i = 0; i < acpm_ipc->num_channels; i++) {
+		channel = &acpm_ipc->channel[i];
+
+		seq_printf(s, "%2u  %8llu  %12llu  %12llu  %9llu  %13llu  %13llu  %10llu\n",
+				channel->id,
+				channel->sync_lat.count,
+				channel->sync_lat.count ?
+				div64_u64(channel->sync_lat.total,
+					channel->sync_lat.count) : 0,
+				channel->sync_lat.max,
+				channel->async_lat.count,
+				channel->async_lat.count ?
+				div64_u64(channel->async_lat.total,
+					channel->async_lat.count) : 0,
+				channel->async_lat.max,
+				channel->async_batches ?
+				div64_u64(channel->async_cmds,
+					channel->async_batches) : 0);
+	}
+
+	return 0;
+}
+
 int acpm_ipc_send_data(unsigned int channel_id, struct ipc_config *cfg)
 {
 	unsigned int front;
@@ -469,13 +691,15 @@ int acpm_ipc_send_data(unsigned int channel_id, struct ipc_config *cfg)
 	int ret;
 	u64 timeout, now;
 	u32 retry_cnt = 0;
+	unsigned long flags;
+	unsigned long long start = sched_clock();
 
 	if (channel_id >= acpm_ipc->num_channels && !cfg)
 		return -EIO;
 
 	channel = &acpm_ipc->channel[channel_id];
 
-	spin_lock(&channel->tx_lock);
+	spin_lock_irqsave(&channel->tx_lock, flags);
 
 	front = __raw_readl(channel->tx_ch.front);
 	rear = __raw_readl(channel->tx_ch.rear);
@@ -490,17 +714,17 @@ int acpm_ipc_send_data(unsigned int channel_id, struct ipc_config *cfg)
 	if (timeout_flag) {
 		acpm_log_print();
 		acpm_debug->debug_log_level = 1;
-		spin_unlock(&channel->tx_lock);
+		spin_unlock_irqrestore(&channel->tx_lock, flags);
 		pr_err("[%s] tx buffer full! timeout!!!\n", __func__);
 		return -ETIMEDOUT;
 	}
 
 	if (!cfg->cmd) {
-		spin_unlock(&channel->tx_lock);
+		spin_unlock_irqrestore(&channel->tx_lock, flags);
 		return -EIO;
 	}
 
-	if (++channel->seq_num == 64)
+	if (++channel->seq_num == ACPM_IPC_SEQ_ASYNC)
 		channel->seq_num = 1;
 
 	cfg->cmd[0] |= (channel->seq_num & 0x3f) << ACPM_IPC_PROTOCOL_SEQ_NUM;
@@ -515,7 +739,7 @@ int acpm_ipc_send_data(unsigned int channel_id, struct ipc_config *cfg)
 	ret = enqueue_indirection_cmd(channel, cfg);
 	if (ret) {
 		pr_err("[ACPM] indirection command fail %d\n", ret);
-		spin_unlock(&channel->tx_lock);
+		spin_unlock_irqrestore(&channel->tx_lock, flags);
 		return ret;
 	}
 
@@ -524,7 +748,7 @@ int acpm_ipc_send_data(unsigned int channel_id, struct ipc_config *cfg)
 	timestamp_write();
 
 	apm_interrupt_gen(channel->id);
-	spin_unlock(&channel->tx_lock);
+	spin_unlock_irqrestore(&channel->tx_lock, flags);
 
 	if (channel->polling && cfg->response) {
 retry:
@@ -571,6 +795,7 @@ retry:
 			return -ETIMEDOUT;
 		}
 
+		latency_update(channel, &channel->sync_lat, start);
 		acpm_log_print();
 	}
 
@@ -675,7 +900,9 @@ static int channel_init(void)
 		spin_lock_init(&acpm_ipc->channel[i].rx_lock);
 		spin_lock_init(&acpm_ipc->channel[i].tx_lock);
 		spin_lock_init(&acpm_ipc->channel[i].ch_lock);
+		spin_lock_init(&acpm_ipc->channel[i].async_lock);
 		INIT_LIST_HEAD(&acpm_ipc->channel[i].list);
+		INIT_LIST_HEAD(&acpm_ipc->channel[i].async_list);
 	}
 
 	__raw_writel(mask, acpm_ipc->intr + INTMR1);
@@ -3,6 +3,8 @@
 
 #include <soc/samsung/acpm_ipc_ctrl.h>
 
+struct seq_file;
+
 struct buff_info {
 	void __iomem *rear;
 	void __iomem *front;
@@ -20,6 +22,20 @@ struct callback_info {
 	struct list_head list;
 };
 
+struct ipc_latency {
+	unsigned long long count;
+	unsigned long long total;
+	unsigned long long max;
+};
+
+/*
+ * Sequence numbers 1..31 are used by synchronous commands, 32..63 by
+ * asynchronous ones, so that a response nobody waits for anymore is never
+ * taken for the response of a synchronous command.
+ */
+#define ACPM_IPC_SEQ_ASYNC	(32)
+#define ACPM_IPC_SEQ_MAX	(64)
+
 struct acpm_ipc_ch {
 	struct buff_info rx_ch;
 	struct buff_info tx_ch;
@@ -36,6 +52,19 @@ struct acpm_ipc_ch {
 
 	struct completion wait;
 	bool polling;
+
+	/* asynchronous requests waiting for their response */
+	struct list_head async_list;
+	spinlock_t async_lock;
+	bool async_kick;
+	unsigned int async_seq_num;
+	/* async sequence numbers sent and not answered yet, even if cancelled */
+	u32 async_busy;
+
+	struct ipc_latency sync_lat;
+	struct ipc_latency async_lat;
+	unsigned long long async_cmds;
+	unsigned long long async_batches;
 };
 
 struct acpm_ipc_info {
@@ -118,5 +147,6 @@ extern void timestamp_write(void);
 extern void acpm_ramdump(void);
 extern void acpm_fw_log_level(unsigned int on);
 extern void acpm_ipc_set_waiting_mode(bool mode);
+extern int acpm_ipc_latency_show(struct seq_file *s, void *unused);
 
 #endif
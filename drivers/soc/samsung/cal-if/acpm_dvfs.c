@@ -40,6 +40,68 @@ int exynos_acpm_set_rate(unsigned int id, unsigned long rate)
 	return ret;
 }
 
+/*
+ * Post a frequency request without waiting for APM to acknowledge it.
+ * Only takes the channel spinlock, so it can be used from scheduler
+ * context; the request completes in the background.
+ */
+int exynos_acpm_set_rate_async(unsigned int id, unsigned long rate)
+{
+	struct ipc_config config;
+	unsigned int cmd[4];
+	int ret;
+
+	config.cmd = cmd;
+	config.response = false;
+	config.indirection = false;
+	config.cmd[0] = id;
+	config.cmd[1] = rate;
+	config.cmd[2] = FREQ_REQ;
+	config.cmd[3] = 0;
+
+	ret = acpm_ipc_send_data(acpm_dvfs.ch_num, &config);
+	if (ret)
+		pr_err("%s:[%d] ret = %d", __func__, id, ret);
+
+	return ret;
+}
+
+/*
+ * Post several frequency requests back to back and wait only for the
+ * last one. APM serves the channel in order, so its response covers the
+ * whole batch and the caller pays a single round-trip.
+ */
+int exynos_acpm_set_rate_batch(unsigned int *id, unsigned long *rate,
+			       int count)
+{
+	struct ipc_config config;
+	unsigned int cmd[4];
+	unsigned long long before, after, latency;
+	int i, ret = 0;
+
+	before = sched_clock();
+	for (i = 0; i < count; i++) {
+		config.cmd = cmd;
+		config.response = (i == count - 1);
+		config.indirection = false;
+		config.cmd[0] = id[i];
+		config.cmd[1] = rate[i];
+		config.cmd[2] = FREQ_REQ;
+		config.cmd[3] = 0;
+
+		ret = acpm_ipc_send_data(acpm_dvfs.ch_num, &config);
+		if (ret)
+			break;
+	}
+	after = sched_clock();
+	latency = after - before;
+	if (ret)
+		pr_err("%s:[%d/%d] latency = %llu ret = %d",
+			__func__, i, count, latency, ret);
+
+	return ret;
+}
+
 unsigned long exynos_acpm_get_rate(unsigned int id)
 {
 	struct ipc_config config;
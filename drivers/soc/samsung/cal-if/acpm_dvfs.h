@@ -26,6 +26,9 @@ struct acpm_dvfs {
 
 #ifdef CONFIG_ACPM_DVFS
 extern int exynos_acpm_set_rate(unsigned int id, unsigned long rate);
+extern int exynos_acpm_set_rate_async(unsigned int id, unsigned long rate);
+extern int exynos_acpm_set_rate_batch(unsigned int *id, unsigned long *rate,
+				      int count);
 extern unsigned long exynos_acpm_get_rate(unsigned int id);
 extern void exynos_acpm_set_device(void *dev);
 extern int exynos_acpm_set_volt_margin(unsigned int id, int volt);
@@ -37,6 +40,17 @@ static inline int exynos_acpm_set_rate(unsigned int id, unsigned long rate)
 	return 0;
 }
 
+static inline int exynos_acpm_set_rate_async(unsigned int id, unsigned long rate)
+{
+	return 0;
+}
+
+static inline int exynos_acpm_set_rate_batch(unsigned int *id,
+					     unsigned long *rate, int count)
+{
+	return 0;
+}
+
 static inline unsigned long exynos_acpm_get_rate(unsigned int id)
 {
 	return 0UL;
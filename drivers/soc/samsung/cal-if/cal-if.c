@@ -60,6 +60,66 @@ int cal_dfs_set_rate(unsigned int id, unsigned long rate)
 	return ret;
 }
 
+int cal_dfs_set_rate_async(unsigned int id, unsigned long rate)
+{
+	struct vclk *vclk;
+	int ret;
+
+	if (!IS_ACPM_VCLK(id))
+		return -EINVAL;
+
+	ret = exynos_acpm_set_rate_async(GET_IDX(id), rate);
+	if (!ret) {
+		vclk = cmucal_get_node(id);
+		if (vclk)
+			vclk->vrate = rate;
+	}
+
+	return ret;
+}
+
+int cal_dfs_set_rate_batch(unsigned int *id, unsigned long *rate, int count)
+{
+	unsigned int idx[CAL_DFS_BATCH_MAX], local_id[CAL_DFS_BATCH_MAX];
+	unsigned long acpm_rate[CAL_DFS_BATCH_MAX];
+	unsigned long local_rate[CAL_DFS_BATCH_MAX];
+	struct vclk *vclk;
+	int i, nr_acpm = 0, nr_local = 0, ret;
+
+	if (count > CAL_DFS_BATCH_MAX)
+		return -EINVAL;
+
+	for (i = 0; i < count; i++) {
+		if (IS_ACPM_VCLK(id[i])) {
+			idx[nr_acpm] = GET_IDX(id[i]);
+			acpm_rate[nr_acpm++] = rate[i];
+		} else {
+			local_id[nr_local] = id[i];
+			local_rate[nr_local++] = rate[i];
+		}
+	}
+
+	if (nr_acpm) {
+		ret = exynos_acpm_set_rate_batch(idx, acpm_rate, nr_acpm);
+		if (ret)
+			return ret;
+
+		for (i = 0; i < count; i++) {
+			if (!IS_ACPM_VCLK(id[i]))
+				continue;
+			vclk = cmucal_get_node(id[i]);
+			if (vclk)
+				vclk->vrate = rate[i];
+		}
+	}
+
+	/* The local CMU domains change together so their PLL locks overlap */
+	if (nr_local)
+		return vclk_set_rate_multi(local_id, local_rate, nr_local);
+
+	return 0;
+}
+
 int cal_dfs_set_rate_switch(unsigned int id, unsigned long switch_rate)
 {
 	int ret = 0;
@@ -96,6 +156,15 @@ unsigned long cal_dfs_get_rate(unsigned int id)
 	return ret;
 }
 
+/* Ask ACPM for the rate, a full IPC round trip without side effects */
+unsigned long cal_dfs_get_rate_acpm(unsigned int id)
+{
+	if (!IS_ACPM_VCLK(id))
+		return 0;
+
+	return exynos_acpm_get_rate(GET_IDX(id));
+}
+
 int cal_dfs_get_rate_table(unsigned int id, unsigned long *table)
 {
 	int ret;
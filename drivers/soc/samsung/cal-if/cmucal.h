@@ -138,6 +138,7 @@ struct vclk {
 	struct vclk_seq		*seq;
 	unsigned int		num_rates;
 	unsigned int		num_list;
+	unsigned int		lut_idx;
 	unsigned int		max_freq;
 	unsigned int		min_freq;
 	unsigned int		boot_freq;
@@ -2,6 +2,7 @@
 #include <linux/kernel.h>
 #include <linux/io.h>
 #include <linux/delay.h>
+#include <linux/sched.h>
 #include <soc/samsung/ect_parser.h>
 #include <soc/samsung/exynos-pmu.h>
 
@@ -60,6 +61,21 @@ static unsigned int ra_get_fixed_factor(struct cmucal_clk *clk)
 	return ffacor->ratio;
 }
 
+/*
+ * While a multi-domain change runs, the PLLs it programs are not waited
+ * on one by one but collected here and waited on together.
+ */
+#define RA_PLL_DEFER_MAX	16
+static struct cmucal_clk *ra_pll_deferred[RA_PLL_DEFER_MAX];
+static int ra_pll_num_deferred;
+static struct task_struct *ra_pll_defer_owner;
+
+static bool ra_pll_can_defer(void)
+{
+	return ra_pll_defer_owner == current &&
+		ra_pll_num_deferred < RA_PLL_DEFER_MAX;
+}
+
 static struct cmucal_pll_table *get_pll_table(struct cmucal_pll *pll_clk,
 					      unsigned long rate)
 {
@@ -111,7 +127,8 @@ static int ra_enable_pll(struct cmucal_clk *clk, int enable)
 }
 
 static int ra_pll_set_pmsk(struct cmucal_clk *clk,
-			       struct cmucal_pll_table *rate_table)
+			       struct cmucal_pll_table *rate_table,
+			       bool wait)
 {
 	struct cmucal_pll *pll = to_clk_pll(clk);
 	unsigned int mdiv, pdiv, sdiv, pll_con0, pll_con1;
@@ -154,6 +171,9 @@ static int ra_pll_set_pmsk(struct cmucal_clk *clk,
 
 	writel(pll_con0, clk->pll_con0);
 
+	if (!wait)
+		return 0;
+
 	ret = ra_wait_done(clk->pll_con0, clk->s_shift, 1, 100);
 	if (ret)
 		pr_err("time out, \'%s\'", clk->name);
@@ -257,23 +277,29 @@ static int ra_set_div_rate(struct cmucal_clk *clk, unsigned int rate)
 	return ret;
 }
 
+static void ra_set_pll_umux(struct cmucal_pll *pll, unsigned int params)
+{
+	struct cmucal_clk *umux;
+
+	if (pll->umux != EMPTY_CLK_ID) {
+		umux = cmucal_get_node(pll->umux);
+		if (umux)
+			ra_set_div_mux(umux, params);
+	}
+}
+
 static int ra_set_pll(struct cmucal_clk *clk, unsigned int rate)
 {
 	struct cmucal_pll *pll;
 	struct cmucal_pll_table *rate_table;
 	struct cmucal_pll_table table;
-	struct cmucal_clk *umux;
 	unsigned int fin;
 	int ret = 0;
 
 	pll = to_clk_pll(clk);
 
 	if (rate == 0) {
-		if (pll->umux != EMPTY_CLK_ID) {
-			umux = cmucal_get_node(pll->umux);
-			if (umux)
-				ra_set_div_mux(umux, 0);
-		}
+		ra_set_pll_umux(pll, 0);
 		ra_enable_pll(clk, 0);
 	} else {
 		rate_table = get_pll_table(pll, rate);
@@ -291,14 +317,54 @@ static int ra_set_pll(struct cmucal_clk *clk, unsigned int rate)
 			rate_table = &table;
 		}
 		ra_enable_pll(clk, 0);
-		ret = ra_pll_set_pmsk(clk, rate_table);
 
-		if (pll->umux != EMPTY_CLK_ID) {
-			umux = cmucal_get_node(pll->umux);
-			if (umux)
-				ra_set_div_mux(umux, 1);
+		/* the user mux follows in ra_pll_defer_wait() */
+		if (ra_pll_can_defer()) {
+			ret = ra_pll_set_pmsk(clk, rate_table, false);
+			if (!ret)
+				ra_pll_deferred[ra_pll_num_deferred++] = clk;
+			return ret;
+		}
+
+		ret = ra_pll_set_pmsk(clk, rate_table, true);
+		ra_set_pll_umux(pll, 1);
+	}
+
+	return ret;
+}
+
+/* Start collecting the PLLs the current task programs */
+void ra_pll_defer_begin(void)
+{
+	ra_pll_num_deferred = 0;
+	ra_pll_defer_owner = current;
+}
+
+/* Wait for every collected PLL to lock, then switch their user muxes */
+int ra_pll_defer_wait(void)
+{
+	struct cmucal_clk *clk;
+	int i, ret = 0;
+
+	for (i = 0; i < ra_pll_num_deferred; i++) {
+		clk = ra_pll_deferred[i];
+		if (ra_wait_done(clk->pll_con0, clk->s_shift, 1, 100)) {
+			pr_err("time out, \'%s\'", clk->name);
+			ret = -EVCLKTIMEOUT;
 		}
+		ra_set_pll_umux(to_clk_pll(clk), 1);
 	}
+	ra_pll_num_deferred = 0;
+
+	return ret;
+}
+
+int ra_pll_defer_end(void)
+{
+	int ret;
+
+	ret = ra_pll_defer_wait();
+	ra_pll_defer_owner = NULL;
 
 	return ret;
 }
@@ -92,6 +92,9 @@ extern void ra_set_pll_ops(unsigned int *list,
 extern unsigned int ra_set_rate_switch(struct vclk_switch *info,
 				       unsigned int max);
 extern void ra_select_switch_pll(struct vclk_switch *info, unsigned int value);
+extern void ra_pll_defer_begin(void);
+extern int ra_pll_defer_wait(void);
+extern int ra_pll_defer_end(void);
 extern int ra_set_list_enable(unsigned int *list, unsigned int num_list);
 extern int ra_set_list_disable(unsigned int *list, unsigned int num_list);
 extern struct cmucal_clk *ra_get_parent(unsigned int id);
@@ -1,6 +1,7 @@
 #include <linux/types.h>
 #include <linux/kernel.h>
 #include <linux/io.h>
+#include <linux/spinlock.h>
 #include <soc/samsung/ect_parser.h>
 
 #include "cmucal.h"
@@ -12,18 +13,44 @@
 #define ECT_DUMMY_SFR	(0xFFFFFFFF)
 unsigned int asv_table_ver = 0;
 
-static struct vclk_lut *get_lut(struct vclk *vclk, unsigned int rate)
+/*
+ * The lut goes from the highest rate down, find the first level at or
+ * below the rate. The level of the previous lookup is tried first since
+ * DVFS mostly asks for the same rate again.
+ */
+static int get_lut_idx(struct vclk *vclk, unsigned int rate)
 {
-	int i;
+	unsigned int idx = vclk->lut_idx;
+	unsigned int lo = 0, hi = vclk->num_rates, mid;
+
+	if (idx < vclk->num_rates && rate >= vclk->lut[idx].rate &&
+	    (idx == 0 || rate < vclk->lut[idx - 1].rate))
+		return idx;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (rate >= vclk->lut[mid].rate)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
 
-	for (i = 0; i < vclk->num_rates; i++)
-		if (rate >= vclk->lut[i].rate)
-			break;
+	if (lo == vclk->num_rates)
+		return -1;
+
+	vclk->lut_idx = lo;
+
+	return lo;
+}
+
+static struct vclk_lut *get_lut(struct vclk *vclk, unsigned int rate)
+{
+	int idx = get_lut_idx(vclk, rate);
 
-	if (i == vclk->num_rates)
+	if (idx < 0)
 		return NULL;
 
-	return &vclk->lut[i];
+	return &vclk->lut[idx];
 }
 
 static unsigned int get_max_rate(unsigned int from, unsigned int to)
@@ -190,6 +217,83 @@ int vclk_set_rate(unsigned int id, unsigned long rate)
 	return ret;
 }
 
+/*
+ * Change several domains in one go. The PLL writes of all the domains go
+ * out before any lock is waited on, so the lock times overlap instead of
+ * adding up. Domains that change through a switching PLL or a sequence
+ * keep their own ordering and are set one by one afterwards.
+ */
+int vclk_set_rate_multi(unsigned int *id, unsigned long *rate, int count)
+{
+	static DEFINE_SPINLOCK(multi_lock);
+	struct vclk *vclk[VCLK_MULTI_MAX];
+	struct vclk_lut *lut[VCLK_MULTI_MAX];
+	struct vclk *v;
+	int i, ret;
+
+	if (count > VCLK_MULTI_MAX)
+		return -EVCLKINVAL;
+
+	for (i = 0; i < count; i++) {
+		vclk[i] = NULL;
+		if (!IS_DFS_VCLK(id[i]) && !IS_COMMON_VCLK(id[i]))
+			continue;
+
+		v = cmucal_get_node(id[i]);
+		if (!v || !v->lut || v->switch_info || v->seq)
+			continue;
+
+		lut[i] = get_lut(v, rate[i]);
+		if (!lut[i])
+			return -EVCLKINVAL;
+		vclk[i] = v;
+	}
+
+	spin_lock(&multi_lock);
+	ra_pll_defer_begin();
+
+	for (i = 0; i < count; i++) {
+		if (!vclk[i])
+			continue;
+		ra_set_clk_by_type(vclk[i]->list, lut[i], vclk[i]->num_list,
+				   DIV_TYPE, TRANS_HIGH);
+		ra_set_clk_by_type(vclk[i]->list, lut[i], vclk[i]->num_list,
+				   PLL_TYPE, TRANS_LOW);
+	}
+	ra_pll_defer_wait();
+
+	for (i = 0; i < count; i++) {
+		if (!vclk[i])
+			continue;
+		ra_set_clk_by_type(vclk[i]->list, lut[i], vclk[i]->num_list,
+				   MUX_TYPE, TRANS_FORCE);
+		ra_set_clk_by_type(vclk[i]->list, lut[i], vclk[i]->num_list,
+				   PLL_TYPE, TRANS_HIGH);
+	}
+	ra_pll_defer_wait();
+
+	for (i = 0; i < count; i++) {
+		if (!vclk[i])
+			continue;
+		ra_set_clk_by_type(vclk[i]->list, lut[i], vclk[i]->num_list,
+				   DIV_TYPE, TRANS_LOW);
+		vclk[i]->vrate = rate[i];
+	}
+
+	ra_pll_defer_end();
+	spin_unlock(&multi_lock);
+
+	for (i = 0; i < count; i++) {
+		if (vclk[i])
+			continue;
+		ret = __vclk_set_rate(id[i], rate[i], ONESHOT_TRANS);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
 int vclk_set_rate_switch(unsigned int id, unsigned long rate)
 {
 	int ret;
@@ -307,6 +411,18 @@ unsigned int vclk_get_lv_num(unsigned int id)
 
 }
 
+/* Level of the rate in the domain's table, -1 if it has none */
+int vclk_get_lv_idx(unsigned int id, unsigned long rate)
+{
+	struct vclk *vclk;
+
+	vclk = cmucal_get_node(id);
+	if (!vclk || !vclk->lut)
+		return -1;
+
+	return get_lut_idx(vclk, rate);
+}
+
 unsigned int vclk_get_max_freq(unsigned int id)
 {
 	struct vclk *vclk;
@@ -12,11 +12,15 @@ struct vclk_trans_ops {
 	unsigned int (*get_pll)(unsigned int id);
 };
 
+#define VCLK_MULTI_MAX		8
+
 #ifdef CONFIG_CMUCAL
 #define get_vclk(_id)		cmucal_get_node(_id | VCLK_TYPE)
 #define get_clk_id(_name)	cmucal_get_id(_name)
 
 extern int vclk_set_rate(unsigned int id, unsigned long rate);
+extern int vclk_set_rate_multi(unsigned int *id, unsigned long *rate,
+			       int count);
 extern int vclk_set_rate_switch(unsigned int id, unsigned long rate);
 extern int vclk_set_rate_restore(unsigned int id, unsigned long rate);
 extern unsigned long vclk_recalc_rate(unsigned int id);
@@ -29,6 +33,7 @@ extern unsigned int vclk_get_min_freq(unsigned int id);
 extern unsigned int vclk_get_boot_freq(unsigned int id);
 extern unsigned int vclk_get_resume_freq(unsigned int id);
 extern unsigned int vclk_get_lv_num(unsigned int id);
+extern int vclk_get_lv_idx(unsigned int id, unsigned long rate);
 extern int vclk_get_rate_table(unsigned int id, unsigned long *table);
 extern int vclk_register_ops(unsigned int id, struct vclk_trans_ops *ops);
 extern int vclk_get_bigturbo_table(unsigned int *table);
@@ -48,6 +53,12 @@ static inline int vclk_set_rate(unsigned int id, unsigned long rate)
 	return 0;
 }
 
+static inline int vclk_set_rate_multi(unsigned int *id, unsigned long *rate,
+				      int count)
+{
+	return 0;
+}
+
 static inline int vclk_set_rate_switch(unsigned int id, unsigned long rate)
 {
 	return 0;
@@ -103,6 +114,11 @@ static inline unsigned int vclk_get_lv_num(unsigned int id)
 	return 0;
 }
 
+static inline int vclk_get_lv_idx(unsigned int id, unsigned long rate)
+{
+	return -1;
+}
+
 static inline int vclk_initialize(void)
 {
 	return 0;
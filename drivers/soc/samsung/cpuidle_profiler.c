@@ -22,6 +22,13 @@
 
 static bool profile_started;
 
+/*
+ * "hist_enabled" keeps per cpu residency and wakeup latency histograms
+ * updated outside of explicit profiling. Each cpu only writes its own
+ * histogram, so no lock is taken.
+ */
+static bool hist_enabled = true;
+
 /*
  * "profile_info" contains profiling data for per cpu idle state which
  * declared in cpuidle driver.
@@ -40,6 +47,13 @@ static struct cpuidle_profile_info cpd_info[MAX_CLUSTER];
  */
 static struct cpuidle_profile_info sys_info;
 
+/*
+ * "state_exit_latency" contains exit latency(us) of each idle state
+ * declared in cpuidle driver.
+ */
+static unsigned int state_exit_latency[CPUIDLE_STATE_MAX];
+static int state_exit_count;
+
 /*
  * "idle_ip_pending" contains which blocks to enter system power mode
  */
@@ -59,6 +73,11 @@ char *idle_ip_list[NUM_IDLE_IP][IDLE_IP_REG_SIZE];
  */
 #define state_entered(state)	(((int)state < (int)0) ? 0 : 1)
 
+static inline int hist_bucket(u64 val)
+{
+	return min_t(int, fls64(val), PROFILE_HIST_BUCKETS - 1);
+}
+
 static void enter_idle_state(struct cpuidle_profile_info *info,
 					int state, ktime_t now)
 {
@@ -82,6 +101,11 @@ static void exit_idle_state(struct cpuidle_profile_info *info,
 
 	info->cur_state = -EINVAL;
 
+	if (info->hist) {
+		info->last_state = state;
+		info->last_exit_time = now;
+	}
+
 	if (earlywakeup) {
 		/*
 		 * If cpu cannot enter power mode, residency time
@@ -93,6 +117,10 @@ static void exit_idle_state(struct cpuidle_profile_info *info,
 
 	diff = ktime_to_us(ktime_sub(now, info->last_entry_time));
 	info->usage[state].time += diff;
+
+	if (info->hist)
+		info->hist[state].residency[hist_bucket(diff >>
+					PROFILE_HIST_RES_SHIFT)]++;
 }
 
 /*
@@ -144,10 +172,16 @@ void __cpuidle_profile_start(int cpu, int state, int substate)
 void cpuidle_profile_start(int cpu, int state, int substate)
 {
 	/*
-	 * Return if profile is not started
+	 * Without profiling, only this cpu's own state is tracked for
+	 * the histograms. Subordinate states need substate_lock.
 	 */
-	if (!profile_started)
+	if (!profile_started) {
+		struct cpuidle_profile_info *info = &per_cpu(profile_info, cpu);
+
+		if (hist_enabled && info->hist)
+			enter_idle_state(info, state, ktime_get());
 		return;
+	}
 
 	__cpuidle_profile_start(cpu, state, substate);
 }
@@ -181,15 +215,44 @@ void __cpuidle_profile_finish(int cpu, int earlywakeup)
 
 void cpuidle_profile_finish(int cpu, int earlywakeup)
 {
-	/*
-	 * Return if profile is not started
-	 */
-	if (!profile_started)
+	struct cpuidle_profile_info *info;
+
+	if (!profile_started) {
+		info = &per_cpu(profile_info, cpu);
+		if (hist_enabled && info->hist) {
+			exit_idle_state(info, info->cur_state, ktime_get(),
+								earlywakeup);
+		}
 		return;
+	}
 
 	__cpuidle_profile_finish(cpu, earlywakeup);
 }
 
+/*
+ * Called when cpu has finished restoring from idle state. The time since
+ * cpuidle_profile_finish() is the wakeup latency of the state left.
+ */
+void cpuidle_profile_exit_done(int cpu)
+{
+	struct cpuidle_profile_info *info = &per_cpu(profile_info, cpu);
+	struct cpuidle_profile_hist *hist;
+	s64 diff;
+
+	if (!info->hist || !info->last_exit_time.tv64)
+		return;
+
+	diff = ktime_to_us(ktime_sub(ktime_get(), info->last_exit_time));
+	info->last_exit_time.tv64 = 0;
+	if (diff < 0)
+		return;
+
+	hist = &info->hist[info->last_state];
+	hist->latency[hist_bucket(diff)]++;
+	hist->latency_sum += diff;
+	hist->latency_count++;
+}
+
 /*
  * Before system enters system power mode, it checks idle-ip status. Its
  * status is conveyed to cpuidle_profile_collect_idle_ip().
@@ -215,6 +278,35 @@ void cpuidle_profile_collect_idle_ip(int mode, int index,
 	}
 }
 
+/*
+ * Return exit latency(us) of the deepest idle state which cpu can enter.
+ * Measured wakeup latency is used once histograms have samples, declared
+ * latency of cpuidle driver otherwise.
+ */
+unsigned int cpuidle_profile_exit_latency(int cpu)
+{
+	struct cpuidle_profile_info *info = &per_cpu(profile_info, cpu);
+	struct cpuidle_profile_hist *hist;
+	unsigned long long sum;
+	unsigned int count;
+
+	if (!state_exit_count)
+		return 0;
+
+	if (info->hist) {
+		hist = &info->hist[state_exit_count - 1];
+		count = READ_ONCE(hist->latency_count);
+		sum = READ_ONCE(hist->latency_sum);
+		if (count) {
+			do_div(sum, count);
+			return max_t(unsigned int, sum,
+				state_exit_latency[state_exit_count - 1]);
+		}
+	}
+
+	return state_exit_latency[state_exit_count - 1];
+}
+
 /************************************************************************
  *                              Show result                             *
  ************************************************************************/
@@ -573,11 +665,90 @@ static ssize_t store_cpuidle_profile(struct kobject *kobj,
 	return count;
 }
 
+static int show_hist(char *buf, int ret, const char *name, int state,
+				bool residency)
+{
+	struct cpuidle_profile_info *info;
+	unsigned int *bucket;
+	int cpu, i;
+
+	ret += scnprintf(buf + ret, PAGE_SIZE - ret, "[state%d %s]\n",
+			state, name);
+	ret += scnprintf(buf + ret, PAGE_SIZE - ret, "#cpu");
+	for (i = 0; i < PROFILE_HIST_BUCKETS; i++)
+		ret += scnprintf(buf + ret, PAGE_SIZE - ret, " <%lu",
+			(residency ? 1UL << PROFILE_HIST_RES_SHIFT : 1UL) << i);
+	ret += scnprintf(buf + ret, PAGE_SIZE - ret, "us\n");
+
+	for_each_possible_cpu(cpu) {
+		info = &per_cpu(profile_info, cpu);
+		if (!info->hist)
+			continue;
+
+		bucket = residency ? info->hist[state].residency :
+				     info->hist[state].latency;
+		ret += scnprintf(buf + ret, PAGE_SIZE - ret, "cpu%d", cpu);
+		for (i = 0; i < PROFILE_HIST_BUCKETS; i++)
+			ret += scnprintf(buf + ret, PAGE_SIZE - ret, " %u",
+					bucket[i]);
+		ret += scnprintf(buf + ret, PAGE_SIZE - ret, "\n");
+	}
+
+	return ret;
+}
+
+static ssize_t show_cpuidle_hist(struct kobject *kobj,
+				     struct kobj_attribute *attr,
+				     char *buf)
+{
+	int ret = 0;
+	int i, state_count = per_cpu(profile_info, 0).state_count;
+
+	for (i = 0; i < state_count; i++)
+		ret = show_hist(buf, ret, "residency", i, true);
+
+	/* State 0 is WFI, there is nothing to restore when leaving it */
+	for (i = 1; i < state_count; i++)
+		ret = show_hist(buf, ret, "wakeup latency", i, false);
+
+	return ret;
+}
+
+static ssize_t store_cpuidle_hist(struct kobject *kobj,
+				      struct kobj_attribute *attr,
+				      const char *buf, size_t count)
+{
+	struct cpuidle_profile_info *info;
+	int input, cpu;
+
+	if (!sscanf(buf, "%1d", &input))
+		return -EINVAL;
+
+	hist_enabled = !!input;
+
+	/* Enabling again starts the histograms over */
+	if (hist_enabled) {
+		for_each_possible_cpu(cpu) {
+			info = &per_cpu(profile_info, cpu);
+			if (info->hist)
+				memset(info->hist, 0,
+					sizeof(struct cpuidle_profile_hist) *
+					info->state_count);
+		}
+	}
+
+	return count;
+}
+
 static struct kobj_attribute cpuidle_profile_attr =
 	__ATTR(profile, 0644, show_cpuidle_profile, store_cpuidle_profile);
 
+static struct kobj_attribute cpuidle_hist_attr =
+	__ATTR(histogram, 0644, show_cpuidle_hist, store_cpuidle_hist);
+
 static struct attribute *cpuidle_profile_attrs[] = {
 	&cpuidle_profile_attr.attr,
+	&cpuidle_hist_attr.attr,
 	NULL,
 };
 
@@ -595,7 +766,7 @@ static void __init cpuidle_profile_info_init(struct cpuidle_profile_info *info,
 	int size = sizeof(struct cpuidle_profile_state_usage) * state_count;
 
 	info->state_count = state_count;
-	info->usage = kmalloc(size, GFP_KERNEL);
+	info->usage = kzalloc(size, GFP_KERNEL);
 	if (!info->usage) {
 		pr_err("%s:%d: Memory allocation failed\n", __func__, __LINE__);
 		return;
@@ -607,10 +778,25 @@ void __init cpuidle_profile_register(struct cpuidle_driver *drv)
 	int idle_state_count = drv->state_count;
 	int i;
 
+	for (i = 0; i < idle_state_count; i++)
+		state_exit_latency[i] = drv->states[i].exit_latency;
+	state_exit_count = idle_state_count;
+
 	/* Initialize each cpuidle state information */
-	for_each_possible_cpu(i)
-		cpuidle_profile_info_init(&per_cpu(profile_info, i),
-						idle_state_count);
+	for_each_possible_cpu(i) {
+		struct cpuidle_profile_info *info = &per_cpu(profile_info, i);
+
+		cpuidle_profile_info_init(info, idle_state_count);
+		info->cur_state = -EINVAL;
+		if (!info->usage)
+			continue;
+
+		info->hist = kzalloc(sizeof(struct cpuidle_profile_hist) *
+					idle_state_count, GFP_KERNEL);
+		if (!info->hist)
+			pr_err("%s:%d: Memory allocation failed\n",
+						__func__, __LINE__);
+	}
 
 	/* Initiailize CPD(Cluster Power Down) information */
 	for_each_cluster(i)
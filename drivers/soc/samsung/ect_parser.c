@@ -10,6 +10,7 @@
 #include <linux/file.h>
 #include <linux/module.h>
 #include <linux/vmalloc.h>
+#include <linux/dcache.h>
 
 #define ALIGNMENT_SIZE	 4
 
@@ -30,6 +31,15 @@ static struct vm_struct ect_early_vm;
 
 /* API for internal */
 
+/*
+ * Names of the most looked up entries are hashed once at parse time, so
+ * that the get functions only run ect_strcmp() on a hash match.
+ */
+static unsigned int ect_name_hash(char *name)
+{
+	return full_name_hash((unsigned char *)name, strlen(name));
+}
+
 static void ect_parse_integer(void **address, void *value)
 {
 	*((unsigned int *)value) = __raw_readl(*address);
@@ -164,6 +174,7 @@ static int ect_parse_dvfs_header(void *address, struct ect_info *info)
 
 		ect_dvfs_domain = &ect_dvfs_header->domain_list[i];
 		ect_dvfs_domain->domain_name = domain_name;
+		ect_dvfs_domain->name_hash = ect_name_hash(domain_name);
 		ect_dvfs_domain->domain_offset = offset;
 	}
 
@@ -375,6 +386,7 @@ static int ect_parse_voltage_header(void *address, struct ect_info *info)
 
 		ect_voltage_domain = &ect_voltage_header->domain_list[i];
 		ect_voltage_domain->domain_name = domain_name;
+		ect_voltage_domain->name_hash = ect_name_hash(domain_name);
 		ect_voltage_domain->domain_offset = offset;
 	}
 
@@ -682,6 +694,7 @@ static int ect_parse_margin_header(void *address, struct ect_info *info)
 
 		ect_margin_domain = &ect_margin_header->domain_list[i];
 		ect_margin_domain->domain_name = domain_name;
+		ect_margin_domain->name_hash = ect_name_hash(domain_name);
 		ect_margin_domain->domain_offset = offset;
 	}
 
@@ -901,6 +914,7 @@ static int ect_parse_gen_param_header(void *address, struct ect_info *info)
 
 		ect_gen_param_table = &ect_gen_param_header->table_list[i];
 		ect_gen_param_table->table_name = table_name;
+		ect_gen_param_table->name_hash = ect_name_hash(table_name);
 		ect_gen_param_table->offset = offset;
 	}
 
@@ -2080,6 +2094,7 @@ void *ect_get_block(char *block_name)
 struct ect_dvfs_domain *ect_dvfs_get_domain(void *block, char *domain_name)
 {
 	int i;
+	unsigned int hash;
 	struct ect_dvfs_header *header;
 	struct ect_dvfs_domain *domain;
 
@@ -2089,10 +2104,13 @@ struct ect_dvfs_domain *ect_dvfs_get_domain(void *block, char *domain_name)
 
 	header = (struct ect_dvfs_header *)block;
 
+	hash = ect_name_hash(domain_name);
+
 	for (i = 0; i < header->num_of_domain; ++i) {
 		domain = &header->domain_list[i];
 
-		if (ect_strcmp(domain_name, domain->domain_name) == 0)
+		if (domain->name_hash == hash &&
+			ect_strcmp(domain_name, domain->domain_name) == 0)
 			return domain;
 	}
 
@@ -2124,6 +2142,7 @@ struct ect_pll *ect_pll_get_pll(void *block, char *pll_name)
 struct ect_voltage_domain *ect_asv_get_domain(void *block, char *domain_name)
 {
 	int i;
+	unsigned int hash;
 	struct ect_voltage_header *header;
 	struct ect_voltage_domain *domain;
 
@@ -2133,10 +2152,13 @@ struct ect_voltage_domain *ect_asv_get_domain(void *block, char *domain_name)
 
 	header = (struct ect_voltage_header *)block;
 
+	hash = ect_name_hash(domain_name);
+
 	for (i = 0; i < header->num_of_domain; ++i) {
 		domain = &header->domain_list[i];
 
-		if (ect_strcmp(domain_name, domain->domain_name) == 0)
+		if (domain->name_hash == hash &&
+			ect_strcmp(domain_name, domain->domain_name) == 0)
 			return domain;
 	}
 
@@ -2211,6 +2233,7 @@ struct ect_ap_thermal_function *ect_ap_thermal_get_function(void *block, char *f
 struct ect_margin_domain *ect_margin_get_domain(void *block, char *domain_name)
 {
 	int i;
+	unsigned int hash;
 	struct ect_margin_header *header;
 	struct ect_margin_domain *domain;
 
@@ -2220,10 +2243,13 @@ struct ect_margin_domain *ect_margin_get_domain(void *block, char *domain_name)
 
 	header = (struct ect_margin_header *)block;
 
+	hash = ect_name_hash(domain_name);
+
 	for (i = 0; i < header->num_of_domain; ++i) {
 		domain = &header->domain_list[i];
 
-		if (ect_strcmp(domain_name, domain->domain_name) == 0)
+		if (domain->name_hash == hash &&
+			ect_strcmp(domain_name, domain->domain_name) == 0)
 			return domain;
 	}
 
@@ -2297,6 +2323,7 @@ struct ect_minlock_domain *ect_minlock_get_domain(void *block, char *domain_name
 struct ect_gen_param_table *ect_gen_param_get_table(void *block, char *table_name)
 {
 	int i;
+	unsigned int hash;
 	struct ect_gen_param_header *header;
 	struct ect_gen_param_table *table;
 
@@ -2305,10 +2332,13 @@ struct ect_gen_param_table *ect_gen_param_get_table(void *block, char *table_nam
 
 	header = (struct ect_gen_param_header *)block;
 
+	hash = ect_name_hash(table_name);
+
 	for (i = 0; i < header->num_of_table; ++i) {
 		table = &header->table_list[i];
 
-		if (ect_strcmp(table->table_name, table_name) == 0)
+		if (table->name_hash == hash &&
+			ect_strcmp(table->table_name, table_name) == 0)
 			return table;
 		}
 
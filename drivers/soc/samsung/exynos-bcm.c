@@ -20,6 +20,7 @@
 #include <soc/samsung/exynos-pd.h>
 #include <linux/suspend.h>
 #include <linux/vmalloc.h>
+#include <linux/mm.h>
 
 #include <soc/samsung/cal-if.h>
 #include <soc/samsung/bcm.h>
@@ -80,6 +81,13 @@ static struct os_system_func {
 
 static struct vm_struct bcm_early_vm;
 static DEFINE_SPINLOCK(bcm_lock);
+/*
+ * The result ring is kept while mapped, a new binary load reuses it.
+ * bcm_data_lock orders the mapping of the ring against its allocation
+ * and free by a binary load.
+ */
+static DEFINE_MUTEX(bcm_data_lock);
+static atomic_t bcm_data_mapped = ATOMIC_INIT(0);
 static char input_file[FILE_STR] = "/data/bcm.bin";
 
 static struct hrtimer bcm_hrtimer;
@@ -483,6 +491,7 @@ static ssize_t store_load_bcm_fw(struct device *dev,
 		spin_unlock_irqrestore(&bcm_lock, flags);
 	}
 	if (value) {
+		mutex_lock(&bcm_data_lock);
 		if (!os_func.fdata) {
 			os_func.fdata = kzalloc(sizeof(struct output_data) *
 						BCM_MAX_DATA, GFP_KERNEL);
@@ -491,6 +500,7 @@ static ssize_t store_load_bcm_fw(struct device *dev,
 			memset((char *)os_func.fdata, 0x0,
 			       sizeof(struct output_data) * BCM_MAX_DATA);
 		}
+		mutex_unlock(&bcm_data_lock);
 
 		bcm_change_memory_common((unsigned long)bcm_early_vm.addr,
 					 BCM_SIZE,
@@ -502,9 +512,18 @@ static ssize_t store_load_bcm_fw(struct device *dev,
 			return count;
 	}
 
-	kfree(os_func.fdata);
-	os_func.fdata = NULL;
-	os_func.ldata = NULL;
+	mutex_lock(&bcm_data_lock);
+	if (!atomic_read(&bcm_data_mapped)) {
+		struct output_data *fdata;
+
+		spin_lock_irqsave(&bcm_lock, flags);
+		fdata = os_func.fdata;
+		os_func.fdata = NULL;
+		os_func.ldata = NULL;
+		spin_unlock_irqrestore(&bcm_lock, flags);
+		kfree(fdata);
+	}
+	mutex_unlock(&bcm_data_lock);
 	return count;
 }
 
@@ -610,14 +629,103 @@ static ssize_t show_cmd_bcm_fw(struct device *dev,
 static DEVICE_ATTR(load_bin, 0640, show_load_bcm_fw, store_load_bcm_fw);
 static DEVICE_ATTR(command, 0640, show_cmd_bcm_fw, store_cmd_bcm_fw);
 
+/*
+ * The result ring the firmware fills with one output_data per BCM IP and
+ * sampling period. Reading or mapping it gives the raw per-IP counters
+ * without the text formatting of the command/file outputs; the IP of each
+ * index is listed by load_bin.
+ */
+static ssize_t read_bcm_data(struct file *filp, struct kobject *kobj,
+				struct bin_attribute *attr, char *buf,
+				loff_t off, size_t count)
+{
+	size_t size = sizeof(struct output_data) * BCM_MAX_DATA;
+	unsigned long flags;
+
+	if (off >= size)
+		return 0;
+	count = min_t(size_t, count, size - off);
+
+	spin_lock_irqsave(&bcm_lock, flags);
+	if (!os_func.fdata) {
+		spin_unlock_irqrestore(&bcm_lock, flags);
+		return -ENODATA;
+	}
+	memcpy(buf, (char *)os_func.fdata + off, count);
+	spin_unlock_irqrestore(&bcm_lock, flags);
+
+	return count;
+}
+
+static void bcm_data_vm_open(struct vm_area_struct *vma)
+{
+	atomic_inc(&bcm_data_mapped);
+}
+
+static void bcm_data_vm_close(struct vm_area_struct *vma)
+{
+	atomic_dec(&bcm_data_mapped);
+}
+
+static const struct vm_operations_struct bcm_data_vm_ops = {
+	.open	= bcm_data_vm_open,
+	.close	= bcm_data_vm_close,
+};
+
+static int mmap_bcm_data(struct file *filp, struct kobject *kobj,
+				struct bin_attribute *attr,
+				struct vm_area_struct *vma)
+{
+	size_t size = PAGE_ALIGN(sizeof(struct output_data) * BCM_MAX_DATA);
+	unsigned long len = vma->vm_end - vma->vm_start;
+	int ret = -EINVAL;
+
+	if (vma->vm_pgoff || len > size || (vma->vm_flags & VM_WRITE))
+		return ret;
+
+	mutex_lock(&bcm_data_lock);
+	if (!os_func.fdata) {
+		ret = -ENODATA;
+		goto out;
+	}
+
+	ret = remap_pfn_range(vma, vma->vm_start,
+			      virt_to_phys(os_func.fdata) >> PAGE_SHIFT,
+			      len, vma->vm_page_prot);
+	if (ret)
+		goto out;
+
+	/* and no mprotect() to writable later */
+	vma->vm_flags &= ~VM_MAYWRITE;
+	vma->vm_ops = &bcm_data_vm_ops;
+	bcm_data_vm_open(vma);
+out:
+	mutex_unlock(&bcm_data_lock);
+
+	return ret;
+}
+
+static struct bin_attribute bin_attr_data = {
+	.attr	= { .name = "data", .mode = 0440 },
+	.size	= sizeof(struct output_data) * BCM_MAX_DATA,
+	.read	= read_bcm_data,
+	.mmap	= mmap_bcm_data,
+};
+
 static struct attribute *bcm_sysfs_entries[] = {
 	&dev_attr_load_bin.attr,
 	&dev_attr_command.attr,
 	NULL,
 };
 
+static struct bin_attribute *bcm_bin_entries[] = {
+	&bin_attr_data,
+	NULL,
+};
+
 static struct attribute_group bcm_attr_group = {
-	.attrs	= bcm_sysfs_entries,
+	.attrs		= bcm_sysfs_entries,
+	.bin_attrs	= bcm_bin_entries,
 };
 
 static int exynos_bcm_notifier_event(struct notifier_block *this,
@@ -445,11 +445,17 @@ int register_exynos_dm_constraint_table(enum exynos_dm_type dm_type,
 			EXYNOS_DM_TYPE_NAME_LEN);
 	constraint->min_freq = 0;
 	constraint->max_freq = UINT_MAX;
+	constraint->master_dm_type = dm_type;
 
-	if (constraint->constraint_type == CONSTRAINT_MIN)
+	if (constraint->constraint_type == CONSTRAINT_MIN) {
 		list_add(&constraint->node, &exynos_dm->dm_data[dm_type].min_clist);
-	else if (constraint->constraint_type == CONSTRAINT_MAX)
+		list_add(&constraint->in_node,
+			&exynos_dm->dm_data[constraint->constraint_dm_type].min_in_list);
+	} else if (constraint->constraint_type == CONSTRAINT_MAX) {
 		list_add(&constraint->node, &exynos_dm->dm_data[dm_type].max_clist);
+		list_add(&constraint->in_node,
+			&exynos_dm->dm_data[constraint->constraint_dm_type].max_in_list);
+	}
 
 	/* check guidance and sub constraint table generations */
 	if (constraint->guidance && (constraint->constraint_type == CONSTRAINT_MIN)) {
@@ -464,6 +470,7 @@ int register_exynos_dm_constraint_table(enum exynos_dm_type dm_type,
 		sub_constraint->table_length = constraint->table_length;
 		sub_constraint->constraint_type = CONSTRAINT_MAX;
 		sub_constraint->constraint_dm_type = dm_type;
+		sub_constraint->master_dm_type = constraint->constraint_dm_type;
 		strncpy(sub_constraint->dm_type_name,
 				dm_type_name[sub_constraint->constraint_dm_type],
 				EXYNOS_DM_TYPE_NAME_LEN);
@@ -488,6 +495,8 @@ int register_exynos_dm_constraint_table(enum exynos_dm_type dm_type,
 
 		list_add(&sub_constraint->node,
 			&exynos_dm->dm_data[constraint->constraint_dm_type].max_clist);
+		list_add(&sub_constraint->in_node,
+			&exynos_dm->dm_data[dm_type].max_in_list);
 
 		/* linked sub constraint */
 		constraint->sub_constraint = sub_constraint;
@@ -501,6 +510,7 @@ err_freq_table:
 	kfree(sub_constraint);
 err_sub_const:
 	list_del(&constraint->node);
+	list_del(&constraint->in_node);
 
 	mutex_unlock(&exynos_dm->lock);
 
@@ -527,11 +537,13 @@ int unregister_exynos_dm_constraint_table(enum exynos_dm_type dm_type,
 	if (constraint->sub_constraint) {
 		sub_constraint = constraint->sub_constraint;
 		list_del(&sub_constraint->node);
+		list_del(&sub_constraint->in_node);
 		kfree(sub_constraint->freq_table);
 		kfree(sub_constraint);
 	}
 
 	list_del(&constraint->node);
+	list_del(&constraint->in_node);
 
 	mutex_unlock(&exynos_dm->lock);
 
@@ -700,12 +712,19 @@ static int constraint_checker_min(struct list_head *head, u32 freq)
 
 	if (!list_empty(head)) {
 		list_for_each_entry(constraint, head, node) {
+			u32 old_freq = constraint->min_freq;
+
 			for (i = constraint->table_length - 1; i >= 0; i--) {
 				if (freq <= constraint->freq_table[i].master_freq) {
 					constraint->min_freq = constraint->freq_table[i].constraint_freq;
 					break;
 				}
 			}
+
+			/* Nothing below this constraint can move if it did not */
+			if (constraint->min_freq == old_freq)
+				continue;
+
 			dm_data_updater(constraint->constraint_dm_type);
 			dm = &exynos_dm->dm_data[constraint->constraint_dm_type];
 			constraint_checker_min(get_min_constraint_list(dm), dm->min_freq);
@@ -723,12 +742,19 @@ static int constraint_checker_max(struct list_head *head, u32 freq)
 
 	if (!list_empty(head)) {
 		list_for_each_entry(constraint, head, node) {
+			u32 old_freq = constraint->max_freq;
+
 			for (i = 0; i < constraint->table_length; i++) {
 				if (freq >= constraint->freq_table[i].master_freq) {
 					constraint->max_freq = constraint->freq_table[i].constraint_freq;
 					break;
 				}
 			}
+
+			/* Nothing below this constraint can move if it did not */
+			if (constraint->max_freq == old_freq)
+				continue;
+
 			dm_data_updater(constraint->constraint_dm_type);
 			dm = &exynos_dm->dm_data[constraint->constraint_dm_type];
 			constraint_checker_max(get_max_constraint_list(dm), dm->max_freq);
@@ -827,8 +853,6 @@ static int dm_data_updater(enum exynos_dm_type dm_type)
 {
 	struct exynos_dm_data *dm;
 	struct exynos_dm_constraint *constraint;
-	struct list_head *constraint_list;
-	int i;
 	/* Initial min/max frequency is set to policy min/max frequency */
 	u32 min_freq;
 	u32 max_freq;
@@ -837,30 +861,18 @@ static int dm_data_updater(enum exynos_dm_type dm_type)
 	min_freq = dm->policy_min_freq;
 	max_freq = dm->policy_max_freq;
 
-	/* Check min/max constraint conditions */
-	for (i = 0; i < DM_TYPE_END; i++) {
-		if (!exynos_dm->dm_data[i].available)
-			continue;
-
-		constraint_list = get_min_constraint_list(&exynos_dm->dm_data[i]);
-		if (list_empty(constraint_list))
-			continue;
-		list_for_each_entry(constraint, constraint_list, node) {
-			if (constraint->constraint_dm_type == dm_type)
-				min_freq = max(min_freq, constraint->min_freq);
-		}
+	/*
+	 * Check min/max constraint conditions. Only the constraints that
+	 * target this domain are walked, through its in lists, instead of
+	 * every constraint table of every domain.
+	 */
+	list_for_each_entry(constraint, &dm->min_in_list, in_node) {
+		if (exynos_dm->dm_data[constraint->master_dm_type].available)
+			min_freq = max(min_freq, constraint->min_freq);
 	}
-	for (i = 0; i < DM_TYPE_END; i++) {
-		if (!exynos_dm->dm_data[i].available)
-			continue;
-
-		constraint_list = get_max_constraint_list(&exynos_dm->dm_data[i]);
-		if (list_empty(constraint_list))
-			continue;
-		list_for_each_entry(constraint, constraint_list, node) {
-			if (constraint->constraint_dm_type == dm_type)
-				max_freq = min(max_freq, constraint->max_freq);
-		}
+	list_for_each_entry(constraint, &dm->max_in_list, in_node) {
+		if (exynos_dm->dm_data[constraint->master_dm_type].available)
+			max_freq = min(max_freq, constraint->max_freq);
 	}
 
 	min_freq = max(min_freq, dm->gov_min_freq); //MIN freq should be checked with gov_min_freq
@@ -1091,7 +1103,7 @@ static int exynos_dm_resume(struct device *dev)
 
 static int exynos_dm_probe(struct platform_device *pdev)
 {
-	int ret = 0;
+	int i, ret = 0;
 	struct exynos_dm_device *dm;
 
 	dm = kzalloc(sizeof(struct exynos_dm_device), GFP_KERNEL);
@@ -1105,6 +1117,11 @@ static int exynos_dm_probe(struct platform_device *pdev)
 
 	mutex_init(&dm->lock);
 
+	for (i = 0; i < DM_TYPE_END; i++) {
+		INIT_LIST_HEAD(&dm->dm_data[i].min_in_list);
+		INIT_LIST_HEAD(&dm->dm_data[i].max_in_list);
+	}
+
 	/* parsing devfreq dts data for exynos-dvfs-manager */
 	ret = exynos_dm_parse_dt(dm->dev->of_node, dm);
 	if (ret) {
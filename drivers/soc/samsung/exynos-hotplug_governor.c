@@ -13,6 +13,8 @@
 #include <linux/slab.h>
 #include <linux/pm_qos.h>
 #include <linux/sched.h>
+#include <linux/cpufreq.h>
+#include <linux/cpuidle_profiler.h>
 
 #include <soc/samsung/exynos-cpu_hotplug.h>
 
@@ -22,6 +24,8 @@
 #define DEFAULT_DUAL_CHANGE_MS (15)		/* 15 ms */
 #define DEFAULT_BOOT_ENABLE_MS (0)		/* boot delay is not applied */
 #define RETRY_BOOT_ENABLE_MS (100)		/* 100 ms */
+#define DEFAULT_REWAKE_US (2000)		/* 2 ms until measured */
+#define HPGOV_DECISION_HISTORY (100)
 
 enum hpgov_event {
 	HPGOV_SLACK_TIMER_EXPIRED = 1,	/* slack timer expired */
@@ -31,6 +35,8 @@ enum hpgov_event {
 struct hpgov_attrib {
 	struct kobj_attribute	enabled;
 	struct kobj_attribute	dual_change_ms;
+	struct kobj_attribute	cost_model;
+	struct kobj_attribute	decision_cost;
 
 	struct attribute_group	attrib_group;
 };
@@ -41,6 +47,16 @@ struct hpgov_data {
 	int req_cpu_min;
 };
 
+/*
+ * Park decision taken at slack timer expiry. cost_us is the estimated
+ * cost of the chosen option; unparking right after staying parked adds
+ * the measured re-wake latency to it.
+ */
+struct hpgov_decision {
+	bool				parked;
+	unsigned int			cost_us;
+};
+
 struct {
 	int				enabled;
 	int				cur_cpu_max;
@@ -62,8 +78,19 @@ struct {
 	wait_queue_head_t		wait_hpq;
 
 	int				boost_cnt;
+
+	int				cost_model;
+	unsigned int			pred_load;
+	unsigned int			rewake_us;
+	bool				last_parked;
+	struct hpgov_decision		decision[HPGOV_DECISION_HISTORY];
+	unsigned int			decision_idx;
+	unsigned int			decision_cnt;
 } exynos_hpgov;
 
+static DEFINE_PER_CPU(u64, hpgov_prev_idle);
+static DEFINE_PER_CPU(u64, hpgov_prev_wall);
+
 static struct pm_qos_request hpgov_max_pm_qos;
 static struct pm_qos_request hpgov_min_pm_qos;
 
@@ -87,9 +114,11 @@ static void start_slack_timer(void)
 		return;
 
 	hrtimer_cancel(&exynos_hpgov.slack_timer);
-	hrtimer_start(&exynos_hpgov.slack_timer,
+	/* A tenth of the period late is harmless, share a wakeup if we can */
+	hrtimer_start_range_ns(&exynos_hpgov.slack_timer,
 		ktime_add(exynos_hpgov.slack_start_time, ktime_set(0,
 			exynos_hpgov.dual_change_ms * NSEC_PER_MSEC)),
+			exynos_hpgov.dual_change_ms * (NSEC_PER_MSEC / 10),
 			HRTIMER_MODE_PINNED);
 }
 
@@ -98,6 +127,85 @@ static inline int slack_timer_is_queued(void)
 	return hrtimer_is_queued(&exynos_hpgov.slack_timer);
 }
 
+/*
+ * Sum of busy percent of online cpus since the last sample, folded into
+ * an average so one noisy window does not flip the park decision.
+ */
+static unsigned int hpgov_predict_load(void)
+{
+	unsigned int cpu, load = 0;
+	u64 idle, wall, d_idle, d_wall;
+
+	for_each_online_cpu(cpu) {
+		idle = get_cpu_idle_time(cpu, &wall, 0);
+		d_idle = idle - per_cpu(hpgov_prev_idle, cpu);
+		d_wall = wall - per_cpu(hpgov_prev_wall, cpu);
+		per_cpu(hpgov_prev_idle, cpu) = idle;
+		per_cpu(hpgov_prev_wall, cpu) = wall;
+
+		if (d_wall && d_wall >= d_idle)
+			load += div64_u64(100 * (d_wall - d_idle), d_wall);
+	}
+
+	exynos_hpgov.pred_load = (exynos_hpgov.pred_load * 3 + load) >> 2;
+
+	return exynos_hpgov.pred_load;
+}
+
+static void hpgov_record_decision(bool parked, unsigned int cost_us)
+{
+	struct hpgov_decision *d;
+	unsigned long flags;
+
+	spin_lock_irqsave(&hpgov_lock, flags);
+	d = &exynos_hpgov.decision[exynos_hpgov.decision_idx];
+	d->parked = parked;
+	d->cost_us = cost_us;
+
+	exynos_hpgov.decision_idx = (exynos_hpgov.decision_idx + 1) %
+						HPGOV_DECISION_HISTORY;
+	if (exynos_hpgov.decision_cnt < HPGOV_DECISION_HISTORY)
+		exynos_hpgov.decision_cnt++;
+	exynos_hpgov.last_parked = parked;
+	spin_unlock_irqrestore(&hpgov_lock, flags);
+}
+
+/*
+ * Decide whether the parked big cores stay down for another slack period.
+ * Staying parked costs a re-wake of the cores, in proportion to how busy
+ * the online cpus are predicted to be. Bringing them back costs an idle
+ * exit of the deepest state for every parked core on each tick they are
+ * predicted to spend idle. The cheaper option wins.
+ */
+static bool hpgov_stay_parked(int cur_cpu_min)
+{
+	unsigned int online = num_online_cpus();
+	unsigned int parked = cur_cpu_min < nr_cpu_ids ?
+				nr_cpu_ids - cur_cpu_min : 0;
+	unsigned int util, cost_stay, cost_wake, ticks;
+
+	if (!parked || !online)
+		return false;
+
+	util = min(hpgov_predict_load() / online, 100U);
+	ticks = max_t(unsigned int,
+			exynos_hpgov.dual_change_ms * HZ / MSEC_PER_SEC, 1);
+
+	cost_stay = exynos_hpgov.rewake_us * util / 100;
+	cost_wake = cpuidle_profile_exit_latency(cur_cpu_min) * parked *
+				ticks * (100 - util) / 100;
+
+	trace_exynos_hpgov_cost_model(util, cost_stay, cost_wake);
+
+	if (cost_stay < cost_wake) {
+		hpgov_record_decision(true, cost_stay);
+		return true;
+	}
+
+	hpgov_record_decision(false, cost_wake);
+	return false;
+}
+
 static enum hrtimer_restart exynos_hpgov_slack_timer(struct hrtimer *timer)
 {
 	unsigned long flags;
@@ -105,6 +213,12 @@ static enum hrtimer_restart exynos_hpgov_slack_timer(struct hrtimer *timer)
 	if (exynos_hpgov.boost_cnt)
 		goto out;
 
+	if (exynos_hpgov.cost_model &&
+	    hpgov_stay_parked(READ_ONCE(exynos_hpgov.cur_cpu_min))) {
+		hrtimer_forward_now(timer, ms_to_ktime(exynos_hpgov.dual_change_ms));
+		return HRTIMER_RESTART;
+	}
+
 	spin_lock_irqsave(&hpgov_lock, flags);
 	exynos_hpgov.data.event = HPGOV_SLACK_TIMER_EXPIRED;
 	exynos_hpgov.data.req_cpu_min = 8;
@@ -255,6 +369,30 @@ static int exynos_hpgov_do_update_governor(void *data)
 	return 0;
 }
 
+/*
+ * Track how long bringing the big cores back takes. If the last park
+ * decision kept them down, this is what that decision ended up costing.
+ */
+static void hpgov_update_rewake(s64 delta_us)
+{
+	unsigned long flags;
+	unsigned int idx;
+
+	if (delta_us <= 0)
+		return;
+
+	spin_lock_irqsave(&hpgov_lock, flags);
+	exynos_hpgov.rewake_us = (exynos_hpgov.rewake_us * 7 + delta_us) >> 3;
+
+	if (exynos_hpgov.decision_cnt && exynos_hpgov.last_parked) {
+		idx = (exynos_hpgov.decision_idx + HPGOV_DECISION_HISTORY - 1) %
+						HPGOV_DECISION_HISTORY;
+		exynos_hpgov.decision[idx].cost_us += delta_us;
+		exynos_hpgov.last_parked = false;
+	}
+	spin_unlock_irqrestore(&hpgov_lock, flags);
+}
+
 static int exynos_hpgov_do_hotplug(void *data)
 {
 	int *event = (int *)data;
@@ -287,9 +425,16 @@ restart:
 		}
 
 		if (cpu_min != last_min) {
+			ktime_t start = ktime_get();
+			bool rewake = cpu_min > last_min;
+
 			pm_qos_update_request_param(&hpgov_min_pm_qos,
 						cpu_min, (void *)&use_fast_hp);
 			last_min = cpu_min;
+
+			if (rewake)
+				hpgov_update_rewake(ktime_us_delta(ktime_get(),
+								start));
 		}
 
 		exynos_hpgov.hp_state = HP_STATE_WAITING;
@@ -368,6 +513,33 @@ static int exynos_hpgov_set_dual_change_ms(int val)
 	return 0;
 }
 
+static int exynos_hpgov_set_cost_model(int val)
+{
+	exynos_hpgov.cost_model = !!val;
+	return 0;
+}
+
+static ssize_t exynos_hpgov_attr_decision_cost_show(struct kobject *kobj,
+			struct kobj_attribute *attr, char *buf)
+{
+	unsigned long flags;
+	unsigned int i, cnt, parked = 0;
+	u64 total = 0;
+
+	spin_lock_irqsave(&hpgov_lock, flags);
+	cnt = exynos_hpgov.decision_cnt;
+	for (i = 0; i < cnt; i++) {
+		total += exynos_hpgov.decision[i].cost_us;
+		parked += exynos_hpgov.decision[i].parked;
+	}
+	spin_unlock_irqrestore(&hpgov_lock, flags);
+
+	return snprintf(buf, PAGE_SIZE,
+			"decisions: %u parked: %u total: %lluus avg: %lluus rewake: %uus\n",
+			cnt, parked, total, cnt ? div_u64(total, cnt) : 0,
+			exynos_hpgov.rewake_us);
+}
+
 #define HPGOV_PARAM(_name, _param) \
 static ssize_t exynos_hpgov_attr_##_name##_show(struct kobject *kobj, \
 			struct kobj_attribute *attr, char *buf) \
@@ -407,6 +579,7 @@ static ssize_t exynos_hpgov_attr_##_name##_store(struct kobject *kobj, \
 
 HPGOV_PARAM(enabled, exynos_hpgov.enabled);
 HPGOV_PARAM(dual_change_ms, exynos_hpgov.dual_change_ms);
+HPGOV_PARAM(cost_model, exynos_hpgov.cost_model);
 
 static void hpgov_boot_enable(struct work_struct *work);
 static DECLARE_DELAYED_WORK(hpgov_boot_work, hpgov_boot_enable);
@@ -442,6 +615,14 @@ static int __init exynos_hpgov_init(void)
 
 	HPGOV_RW_ATTRIB(attr_count - (i_attr--), enabled);
 	HPGOV_RW_ATTRIB(attr_count - (i_attr--), dual_change_ms);
+	HPGOV_RW_ATTRIB(attr_count - (i_attr--), cost_model);
+
+	exynos_hpgov.attrib.decision_cost.attr.name = "decision_cost";
+	exynos_hpgov.attrib.decision_cost.attr.mode = S_IRUGO;
+	exynos_hpgov.attrib.decision_cost.show =
+				exynos_hpgov_attr_decision_cost_show;
+	exynos_hpgov.attrib.attrib_group.attrs[attr_count - (i_attr--)] =
+				&exynos_hpgov.attrib.decision_cost.attr;
 
 	exynos_hpgov.attrib.attrib_group.name = "governor";
 	ret = sysfs_create_group(exynos_cpu_hotplug_kobj(), &exynos_hpgov.attrib.attrib_group);
@@ -449,6 +630,7 @@ static int __init exynos_hpgov_init(void)
 		pr_err("Unable to create sysfs objects :%d\n", ret);
 
 	exynos_hpgov.dual_change_ms = DEFAULT_DUAL_CHANGE_MS;
+	exynos_hpgov.rewake_us = DEFAULT_REWAKE_US;
 	exynos_hpgov.cur_cpu_max = PM_QOS_CPU_ONLINE_MAX_DEFAULT_VALUE;
 	exynos_hpgov.cur_cpu_min = PM_QOS_CPU_ONLINE_MIN_DEFAULT_VALUE;
 
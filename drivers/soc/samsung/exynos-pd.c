@@ -16,6 +16,22 @@
 #include <soc/samsung/bts.h>
 #include <soc/samsung/cal-if.h>
 #include <linux/apm-exynos.h>
+#include <linux/moduleparam.h>
+#include <linux/seq_file.h>
+
+/*
+ * Powering a domain off only pays when it stays off longer than its
+ * break-even time, either "break-even-us" from DT or PD_BREAK_EVEN_RATIO
+ * times the measured on + off latency. When keepalive is set and the
+ * recent idle intervals of a domain are shorter than that, its power off
+ * is deferred by up to the break-even time: a user coming back within it
+ * finds the domain still on, otherwise it goes off when the time is up.
+ */
+#define PD_BREAK_EVEN_RATIO	4
+
+static bool keepalive;
+module_param(keepalive, bool, 0644);
+
 struct exynos_pm_domain *exynos_pd_lookup_name(const char *domain_name)
 {
 	struct exynos_pm_domain *exypd = NULL;
@@ -103,9 +119,121 @@ static void exynos_pd_prepare_forced_off(struct exynos_pm_domain *pd)
 {
 }
 
+static void exynos_pd_hist_add(unsigned int *hist, int nr, u64 val)
+{
+	hist[min(fls64(val), nr - 1)]++;
+}
+
+/* moving average with a weight of 1/4 for the new sample */
+static u64 exynos_pd_ewma(u64 avg, u64 val)
+{
+	return avg ? (avg * 3 + val) >> 2 : val;
+}
+
+static void exynos_pd_record_latency(struct exynos_pm_domain *pd, int on,
+				     u64 start)
+{
+	struct exynos_pd_stat *st = &pd->stat;
+	u64 lat = ktime_get_ns() - start;
+
+	if (on) {
+		st->on_avg_ns = exynos_pd_ewma(st->on_avg_ns, lat);
+		st->on_max_ns = max(st->on_max_ns, lat);
+		exynos_pd_hist_add(st->on_hist, PD_LAT_BUCKETS,
+				div_u64(lat, NSEC_PER_USEC));
+	} else {
+		st->off_avg_ns = exynos_pd_ewma(st->off_avg_ns, lat);
+		st->off_max_ns = max(st->off_max_ns, lat);
+		exynos_pd_hist_add(st->off_hist, PD_LAT_BUCKETS,
+				div_u64(lat, NSEC_PER_USEC));
+	}
+}
+
+/* the idle interval that began at idle_start ends now */
+static void exynos_pd_idle_end(struct exynos_pm_domain *pd, u64 now)
+{
+	struct exynos_pd_stat *st = &pd->stat;
+	u64 idle;
+
+	if (!st->idle_start)
+		return;
+
+	idle = now - st->idle_start;
+	st->idle_start = 0;
+	st->idle_avg_ns = exynos_pd_ewma(st->idle_avg_ns, idle);
+	exynos_pd_hist_add(st->idle_hist, PD_IDLE_BUCKETS,
+			div_u64(idle, NSEC_PER_MSEC));
+}
+
+static u64 exynos_pd_break_even_ns(struct exynos_pm_domain *pd)
+{
+	if (pd->break_even_us)
+		return (u64)pd->break_even_us * NSEC_PER_USEC;
+
+	return PD_BREAK_EVEN_RATIO * (pd->stat.on_avg_ns + pd->stat.off_avg_ns);
+}
+
+/* called by genpd with genpd->lock held, before any power off */
+static bool exynos_pd_power_down_ok_gov(struct dev_pm_domain *domain)
+{
+	struct generic_pm_domain *genpd = pd_to_genpd(domain);
+	struct exynos_pm_domain *pd = container_of(genpd, struct exynos_pm_domain, genpd);
+	struct exynos_pd_stat *st = &pd->stat;
+	bool expired = st->keepalive_expired;
+	u64 now, idle, break_even;
+
+	if (!pd->pd_control)
+		return true;
+
+	now = ktime_get_ns();
+	st->keepalive_expired = false;
+
+	/*
+	 * Asked again while kept on and not by the keep-alive work: the
+	 * domain has been in use meanwhile, so the idle interval is over.
+	 */
+	if (st->idle_start && !expired)
+		exynos_pd_idle_end(pd, now);
+	if (!st->idle_start)
+		st->idle_start = now;
+
+	if (!keepalive || expired)
+		return true;
+
+	break_even = exynos_pd_break_even_ns(pd);
+	idle = now - st->idle_start;
+	if (!st->idle_avg_ns || st->idle_avg_ns >= break_even ||
+	    idle >= break_even)
+		return true;
+
+	st->kept_on++;
+	mod_delayed_work(system_wq, &st->keepalive_work,
+			nsecs_to_jiffies(break_even - idle) + 1);
+
+	return false;
+}
+
+static struct dev_power_governor exynos_pd_gov = {
+	.power_down_ok = exynos_pd_power_down_ok_gov,
+};
+
+static void exynos_pd_keepalive_work(struct work_struct *work)
+{
+	struct exynos_pd_stat *st = container_of(to_delayed_work(work),
+					struct exynos_pd_stat, keepalive_work);
+	struct exynos_pm_domain *pd = container_of(st, struct exynos_pm_domain, stat);
+
+	mutex_lock(&pd->genpd.lock);
+	st->keepalive_expired = true;
+	mutex_unlock(&pd->genpd.lock);
+
+	queue_work(pm_wq, &pd->genpd.power_off_work);
+}
+
 static int exynos_pd_power_on(struct generic_pm_domain *genpd)
 {
 	struct exynos_pm_domain *pd = container_of(genpd, struct exynos_pm_domain, genpd);
+	u64 start;
 	int ret = 0;
 
 	mutex_lock(&pd->access_lock);
@@ -124,6 +252,7 @@ static int exynos_pd_power_on(struct generic_pm_domain *genpd)
 
 	exynos_pd_power_on_pre(pd);
 
+	start = ktime_get_ns();
 	ret = pd->pd_control(pd->cal_pdid, 1);
 	if (ret) {
 		pr_err(EXYNOS_PD_PREFIX "%s cannot be powered on\n", pd->name);
@@ -131,6 +260,8 @@ static int exynos_pd_power_on(struct generic_pm_domain *genpd)
 		ret = -EAGAIN;
 		goto acc_unlock;
 	}
+	exynos_pd_record_latency(pd, 1, start);
+	exynos_pd_idle_end(pd, start);
 
 	exynos_pd_power_on_post(pd);
 
@@ -144,6 +275,7 @@ acc_unlock:
 static int exynos_pd_power_off(struct generic_pm_domain *genpd)
 {
 	struct exynos_pm_domain *pd = container_of(genpd, struct exynos_pm_domain, genpd);
+	u64 start;
 	int ret = 0;
 
 	mutex_lock(&pd->access_lock);
@@ -163,6 +295,7 @@ static int exynos_pd_power_off(struct generic_pm_domain *genpd)
 
 	exynos_pd_power_off_pre(pd);
 
+	start = ktime_get_ns();
 	ret = pd->pd_control(pd->cal_pdid, 0);
 	if (unlikely(ret)) {
 		if (ret == -4) {
@@ -179,6 +312,8 @@ static int exynos_pd_power_off(struct generic_pm_domain *genpd)
 		}
 	}
 
+	exynos_pd_record_latency(pd, 0, start);
+
 	exynos_pd_power_off_post(pd);
 	pd->power_down_skipped = false;
 
@@ -263,7 +398,9 @@ static void exynos_pd_genpd_init(struct exynos_pm_domain *pd, int state)
 	pd->genpd.power_on_latency_ns = 1000000;
 	pd->genpd.power_off_latency_ns = 1000000;
 
-	pm_genpd_init(&pd->genpd, NULL, state ? false : true);
+	INIT_DELAYED_WORK(&pd->stat.keepalive_work, exynos_pd_keepalive_work);
+
+	pm_genpd_init(&pd->genpd, &exynos_pd_gov, state ? false : true);
 }
 
 /* exynos_pd_show_power_domain - show current power domain status.
@@ -328,6 +465,7 @@ static __init int exynos_pd_dt_parse(void)
 		pd->check_status = exynos_pd_status;
 		pd->devfreq_index = of_get_devfreq_sync_volt_idx(pd->of_node);
 		of_get_power_down_ok(pd);
+		of_property_read_u32(np, "break-even-us", &pd->break_even_us);
 		pd->power_down_skipped = false;
 		initial_state = cal_pd_status(pd->cal_pdid);
 		if (initial_state == -1) {
@@ -459,3 +597,75 @@ static int __init exynos_pd_init(void)
 	return -EPERM;
 }
 subsys_initcall(exynos_pd_init);
+
+#if defined(CONFIG_OF) && defined(CONFIG_DEBUG_FS)
+static void exynos_pd_stat_hist(struct seq_file *s, const char *name,
+				unsigned int *hist, int nr)
+{
+	int i;
+
+	seq_printf(s, "  %-4s", name);
+	for (i = 0; i < nr; i++)
+		seq_printf(s, " %u", hist[i]);
+	seq_putc(s, '\n');
+}
+
+static int exynos_pd_stat_show(struct seq_file *s, void *unused)
+{
+	struct device_node *np;
+
+	seq_printf(s, "keepalive: %s (latency buckets: log2 us, idle buckets: log2 ms)\n",
+			keepalive ? "on" : "off");
+
+	for_each_compatible_node(np, NULL, "samsung,exynos-pd") {
+		struct platform_device *pdev;
+		struct exynos_pm_domain *pd;
+		struct exynos_pd_stat *st;
+
+		if (!of_device_is_available(np))
+			continue;
+		pdev = of_find_device_by_node(np);
+		if (!pdev)
+			continue;
+		pd = platform_get_drvdata(pdev);
+		if (!pd)
+			continue;
+		st = &pd->stat;
+
+		seq_printf(s, "%s: on %llu us (max %llu) off %llu us (max %llu) break-even %llu us idle %llu us kept_on %u\n",
+				pd->name,
+				div_u64(st->on_avg_ns, NSEC_PER_USEC),
+				div_u64(st->on_max_ns, NSEC_PER_USEC),
+				div_u64(st->off_avg_ns, NSEC_PER_USEC),
+				div_u64(st->off_max_ns, NSEC_PER_USEC),
+				div_u64(exynos_pd_break_even_ns(pd), NSEC_PER_USEC),
+				div_u64(st->idle_avg_ns, NSEC_PER_USEC),
+				st->kept_on);
+		exynos_pd_stat_hist(s, "on", st->on_hist, PD_LAT_BUCKETS);
+		exynos_pd_stat_hist(s, "off", st->off_hist, PD_LAT_BUCKETS);
+		exynos_pd_stat_hist(s, "idle", st->idle_hist, PD_IDLE_BUCKETS);
+	}
+
+	return 0;
+}
+
+static int exynos_pd_stat_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, exynos_pd_stat_show, inode->i_private);
+}
+
+static const struct file_operations exynos_pd_stat_fops = {
+	.open		= exynos_pd_stat_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init exynos_pd_stat_init(void)
+{
+	debugfs_create_file("exynos-pd-stat", 0444, NULL, NULL,
+			&exynos_pd_stat_fops);
+	return 0;
+}
+late_initcall(exynos_pd_stat_init);
+#endif
@@ -0,0 +1,388 @@
+/*
+ * Exynos hot path microbenchmarks
+ *
+ * Each benchmark runs a fixed number of iterations with fixed parameters
+ * so results can be compared between kernel builds. Writing a benchmark
+ * name, or "all", to exynos-bench/run runs it; exynos-bench/results has
+ * one line per benchmark:
+ *
+ *	<name> <iters> <min_ns> <avg_ns> <max_ns> <status>
+ *
+ * status is 0 or a negative errno, -ENODEV when the benchmark is not
+ * configured on this device.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/uaccess.h>
+#include <linux/mutex.h>
+#include <linux/ktime.h>
+#include <linux/sizes.h>
+#include <linux/slab.h>
+#include <linux/crypto.h>
+#include <linux/random.h>
+#include <linux/iommu.h>
+#include <linux/platform_device.h>
+#include <linux/exynos_ion.h>
+
+#include <soc/samsung/cal-if.h>
+
+#define BENCH_ZRAM_ITERS	1000
+#define BENCH_ION_ITERS		200
+#define BENCH_ION_SIZE		SZ_1M
+#define BENCH_IOMMU_ITERS	1000
+#define BENCH_IOMMU_SIZE	SZ_64K
+#define BENCH_IOMMU_IOVA	0x10000000UL
+#define BENCH_ACPM_ITERS	1000
+#define BENCH_DVFS_ITERS	100
+
+static char *zram_alg = "lz4";
+module_param(zram_alg, charp, 0644);
+MODULE_PARM_DESC(zram_alg, "compressor the zram benchmarks use");
+
+static unsigned int acpm_id;
+module_param(acpm_id, uint, 0644);
+MODULE_PARM_DESC(acpm_id, "ACPM DVFS domain asked for its rate, 0 to skip");
+
+static unsigned int dvfs_id;
+module_param(dvfs_id, uint, 0644);
+MODULE_PARM_DESC(dvfs_id, "DVFS domain switched between two rates, 0 to skip");
+
+static unsigned int dvfs_lo;
+module_param(dvfs_lo, uint, 0644);
+MODULE_PARM_DESC(dvfs_lo, "lower DVFS benchmark rate in kHz");
+
+static unsigned int dvfs_hi;
+module_param(dvfs_hi, uint, 0644);
+MODULE_PARM_DESC(dvfs_hi, "higher DVFS benchmark rate in kHz");
+
+struct bench_result {
+	unsigned int iters;
+	u64 min_ns;
+	u64 max_ns;
+	u64 total_ns;
+	int status;
+	bool done;
+};
+
+struct bench {
+	const char *name;
+	int (*run)(struct bench_result *res);
+	struct bench_result res;
+};
+
+static DEFINE_MUTEX(bench_lock);
+
+static void bench_record(struct bench_result *res, u64 start)
+{
+	u64 ns = ktime_get_ns() - start;
+
+	if (!res->iters || ns < res->min_ns)
+		res->min_ns = ns;
+	if (ns > res->max_ns)
+		res->max_ns = ns;
+	res->total_ns += ns;
+	res->iters++;
+}
+
+/* Half random, half repeated text, about what zram sees from apps */
+static void bench_fill_page(void *buf)
+{
+	struct rnd_state state;
+	static const char text[] = "exynos-bench ";
+	char *p = buf;
+	int i;
+
+	prandom_seed_state(&state, 0x8895);
+	prandom_bytes_state(&state, p, PAGE_SIZE / 2);
+	for (i = PAGE_SIZE / 2; i < PAGE_SIZE; i++)
+		p[i] = text[i % (sizeof(text) - 1)];
+}
+
+static int bench_zram(struct bench_result *res, bool decomp)
+{
+	struct crypto_comp *tfm;
+	void *src, *dst, *out;
+	unsigned int len, out_len;
+	u64 start;
+	int i, ret;
+
+	tfm = crypto_alloc_comp(zram_alg, 0, 0);
+	if (IS_ERR(tfm))
+		return PTR_ERR(tfm);
+
+	/* as in zcomp, the output may be larger than the page */
+	src = kmalloc(PAGE_SIZE, GFP_KERNEL);
+	dst = kmalloc(PAGE_SIZE * 2, GFP_KERNEL);
+	out = kmalloc(PAGE_SIZE, GFP_KERNEL);
+	if (!src || !dst || !out) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	bench_fill_page(src);
+	len = PAGE_SIZE * 2;
+	ret = crypto_comp_compress(tfm, src, PAGE_SIZE, dst, &len);
+	if (ret)
+		goto out;
+
+	for (i = 0; i < BENCH_ZRAM_ITERS; i++) {
+		start = ktime_get_ns();
+		if (decomp) {
+			out_len = PAGE_SIZE;
+			ret = crypto_comp_decompress(tfm, dst, len, out,
+						     &out_len);
+		} else {
+			out_len = PAGE_SIZE * 2;
+			ret = crypto_comp_compress(tfm, src, PAGE_SIZE, dst,
+						   &out_len);
+		}
+		bench_record(res, start);
+		if (ret)
+			break;
+	}
+out:
+	kfree(out);
+	kfree(dst);
+	kfree(src);
+	crypto_free_comp(tfm);
+
+	return ret;
+}
+
+static int bench_zram_comp(struct bench_result *res)
+{
+	return bench_zram(res, false);
+}
+
+static int bench_zram_decomp(struct bench_result *res)
+{
+	return bench_zram(res, true);
+}
+
+static int bench_ion_alloc(struct bench_result *res)
+{
+	struct ion_client *client;
+	struct ion_handle *handle;
+	u64 start;
+	int i, ret = 0;
+
+	client = exynos_ion_client_create("exynos-bench");
+	if (IS_ERR_OR_NULL(client))
+		return client ? PTR_ERR(client) : -ENODEV;
+
+	for (i = 0; i < BENCH_ION_ITERS; i++) {
+		start = ktime_get_ns();
+		handle = ion_alloc(client, BENCH_ION_SIZE, 0,
+				   EXYNOS_ION_HEAP_SYSTEM_MASK, 0);
+		if (IS_ERR(handle)) {
+			ret = PTR_ERR(handle);
+			break;
+		}
+		ion_free(client, handle);
+		bench_record(res, start);
+	}
+
+	ion_client_destroy(client);
+
+	return ret;
+}
+
+static int bench_iommu(struct bench_result *res, bool unmap)
+{
+	struct iommu_domain *domain;
+	struct page *page;
+	u64 start;
+	int i, ret = 0;
+
+	domain = iommu_domain_alloc(&platform_bus_type);
+	if (!domain)
+		return -ENODEV;
+
+	page = alloc_pages(GFP_KERNEL, get_order(BENCH_IOMMU_SIZE));
+	if (!page) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	for (i = 0; i < BENCH_IOMMU_ITERS; i++) {
+		start = ktime_get_ns();
+		ret = iommu_map(domain, BENCH_IOMMU_IOVA, page_to_phys(page),
+				BENCH_IOMMU_SIZE, IOMMU_READ | IOMMU_WRITE);
+		if (ret)
+			break;
+		if (!unmap) {
+			bench_record(res, start);
+			start = ktime_get_ns();
+		}
+		iommu_unmap(domain, BENCH_IOMMU_IOVA, BENCH_IOMMU_SIZE);
+		if (unmap)
+			bench_record(res, start);
+	}
+
+	__free_pages(page, get_order(BENCH_IOMMU_SIZE));
+out:
+	iommu_domain_free(domain);
+
+	return ret;
+}
+
+static int bench_iommu_map(struct bench_result *res)
+{
+	return bench_iommu(res, false);
+}
+
+static int bench_iommu_unmap(struct bench_result *res)
+{
+	return bench_iommu(res, true);
+}
+
+static int bench_acpm_rtt(struct bench_result *res)
+{
+	u64 start;
+	int i;
+
+	if (!acpm_id)
+		return -ENODEV;
+
+	for (i = 0; i < BENCH_ACPM_ITERS; i++) {
+		start = ktime_get_ns();
+		if (!cal_dfs_get_rate_acpm(acpm_id))
+			return -EIO;
+		bench_record(res, start);
+	}
+
+	return 0;
+}
+
+static int bench_dvfs(struct bench_result *res)
+{
+	unsigned long orig;
+	u64 start;
+	int i, ret = 0;
+
+	if (!dvfs_id || !dvfs_lo || !dvfs_hi)
+		return -ENODEV;
+
+	orig = cal_dfs_cached_get_rate(dvfs_id);
+
+	for (i = 0; i < BENCH_DVFS_ITERS; i++) {
+		start = ktime_get_ns();
+		ret = cal_dfs_set_rate(dvfs_id, (i & 1) ? dvfs_lo : dvfs_hi);
+		if (ret)
+			break;
+		bench_record(res, start);
+	}
+
+	if (orig)
+		cal_dfs_set_rate(dvfs_id, orig);
+
+	return ret;
+}
+
+static struct bench benches[] = {
+	{ .name = "zram_comp",		.run = bench_zram_comp },
+	{ .name = "zram_decomp",	.run = bench_zram_decomp },
+	{ .name = "ion_alloc",		.run = bench_ion_alloc },
+	{ .name = "iommu_map",		.run = bench_iommu_map },
+	{ .name = "iommu_unmap",	.run = bench_iommu_unmap },
+	{ .name = "acpm_rtt",		.run = bench_acpm_rtt },
+	{ .name = "dvfs",		.run = bench_dvfs },
+};
+
+static void bench_run(struct bench *b)
+{
+	memset(&b->res, 0, sizeof(b->res));
+	b->res.status = b->run(&b->res);
+	b->res.done = true;
+}
+
+static ssize_t bench_run_write(struct file *file, const char __user *ubuf,
+			       size_t count, loff_t *ppos)
+{
+	char buf[32];
+	bool all;
+	int i, found = 0;
+
+	if (count >= sizeof(buf))
+		return -EINVAL;
+	if (copy_from_user(buf, ubuf, count))
+		return -EFAULT;
+	buf[count] = '\0';
+	strim(buf);
+
+	all = !strcmp(buf, "all");
+
+	mutex_lock(&bench_lock);
+	for (i = 0; i < ARRAY_SIZE(benches); i++) {
+		if (!all && strcmp(buf, benches[i].name))
+			continue;
+		bench_run(&benches[i]);
+		found++;
+	}
+	mutex_unlock(&bench_lock);
+
+	return found ? count : -EINVAL;
+}
+
+static const struct file_operations bench_run_fops = {
+	.open = simple_open,
+	.write = bench_run_write,
+	.llseek = no_llseek,
+};
+
+static int bench_results_show(struct seq_file *s, void *unused)
+{
+	struct bench_result *res;
+	int i;
+
+	seq_puts(s, "# name iters min_ns avg_ns max_ns status\n");
+
+	mutex_lock(&bench_lock);
+	for (i = 0; i < ARRAY_SIZE(benches); i++) {
+		res = &benches[i].res;
+		if (!res->done)
+			continue;
+		seq_printf(s, "%s %u %llu %llu %llu %d\n", benches[i].name,
+			   res->iters, res->min_ns,
+			   res->iters ? div_u64(res->total_ns, res->iters) : 0,
+			   res->max_ns, res->status);
+	}
+	mutex_unlock(&bench_lock);
+
+	return 0;
+}
+
+static int bench_results_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, bench_results_show, inode->i_private);
+}
+
+static const struct file_operations bench_results_fops = {
+	.open = bench_results_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static struct dentry *bench_root;
+
+static int __init exynos_perf_bench_init(void)
+{
+	bench_root = debugfs_create_dir("exynos-bench", NULL);
+	if (!bench_root)
+		return -ENOMEM;
+
+	debugfs_create_file("run", 0200, bench_root, NULL, &bench_run_fops);
+	debugfs_create_file("results", 0444, bench_root, NULL,
+			    &bench_results_fops);
+
+	return 0;
+}
+late_initcall(exynos_perf_bench_init);
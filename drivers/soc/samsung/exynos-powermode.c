@@ -381,8 +381,33 @@ static void update_c2_state(bool down, unsigned int cpu)
 		cpumask_clear_cpu(cpu, &pm_info->c2_mask);
 }
 
+/*
+ * "predicted_idle_end" is when the cpuidle governor expects idle of each
+ * cpu to end. Unlike the sleep length of the next timer, it is valid for
+ * the other cpus in the cluster as well.
+ */
+static DEFINE_PER_CPU(ktime_t, predicted_idle_end);
+
+/*
+ * Set the idle length predicted for cpu which is entering idle. Zero drops
+ * the prediction, then next timer event is used.
+ */
+void exynos_cpu_idle_predict(unsigned int cpu, unsigned int predicted_us)
+{
+	if (predicted_us)
+		per_cpu(predicted_idle_end, cpu) =
+			ktime_add_us(ktime_get(), predicted_us);
+	else
+		per_cpu(predicted_idle_end, cpu).tv64 = 0;
+}
+
 static s64 get_next_event_time_us(unsigned int cpu)
 {
+	ktime_t end = per_cpu(predicted_idle_end, cpu);
+
+	if (end.tv64)
+		return max_t(s64, ktime_us_delta(end, ktime_get()), 0);
+
 	return ktime_to_us(tick_nohz_get_sleep_length());
 }
 
@@ -17,6 +17,9 @@
 #include <net/sock.h>
 #include <linux/hrtimer.h>
 #include <linux/proc_fs.h>
+#include <linux/workqueue.h>
+#include <linux/fs.h>
+#include <linux/slab.h>
 
 
 #define RET_OK   0
@@ -53,7 +56,8 @@ static char* mod_name[MOD_END] =
 	"MOD_BINDER",
 	"MOD_SIG",
 	"MOD_PKG",
-	"MOD_CFB"
+	"MOD_CFB",
+	"MOD_FREEZE"
 };
 
 struct priv_data
@@ -152,6 +156,140 @@ int mod_sendmsg(int type, int mod, struct priv_data* data)
 	return RET_OK;
 }
 
+/*
+ * With batch_window_ms set, MOD_SIG and MOD_BINDER reports are queued
+ * per mod, one per target uid, and sent as one MSG_TO_USER_BATCH
+ * message when the window expires or the batch is full.
+ */
+static unsigned int batch_window_ms;
+module_param(batch_window_ms, uint, 0644);
+
+struct report_batch_s
+{
+	spinlock_t lock;
+	int mod;
+	int count;
+	struct kfreecess_event events[KFREECESS_BATCH_MAX];
+	struct delayed_work work;
+};
+
+static struct report_batch_s report_batch[MOD_END];
+
+static int mod_send_batch(int mod, struct kfreecess_event *events, int count)
+{
+	int ret;
+	struct sk_buff *skb = NULL;
+	struct nlmsghdr *nlh = NULL;
+	struct kfreecess_batch_msg *payload = NULL;
+
+	if (!atomic_read(&kfreecess_init_suc))
+		return RET_ERR;
+
+	skb = nlmsg_new(sizeof(struct kfreecess_batch_msg), GFP_KERNEL);
+	if (!skb) {
+		pr_err("%s alloc_skb failed! %d\n", __func__, mod);
+		return RET_ERR;
+	}
+
+	nlh = nlmsg_put(skb, 0, 0, 0, sizeof(struct kfreecess_batch_msg), 0);
+	if (!nlh) {
+		kfree_skb(skb);
+		return RET_ERR;
+	}
+
+	payload = nlmsg_data(nlh);
+	memset(payload, 0, sizeof(struct kfreecess_batch_msg));
+	payload->type = MSG_TO_USER_BATCH;
+	payload->mod = mod;
+	payload->src_portid = KERNEL_ID_NETLINK;
+	payload->dst_portid = atomic_read(&bind_port[mod]);
+	payload->count = count;
+	memcpy(payload->events, events, count * sizeof(struct kfreecess_event));
+
+	if ((ret = nlmsg_unicast(kfreecess_mod_sock, skb, payload->dst_portid)) < 0) {
+		pr_err("nlmsg_unicast failed! %s errno %d\n", __func__ , ret);
+		return RET_ERR;
+	}
+
+	return RET_OK;
+}
+
+static void report_batch_work(struct work_struct *work)
+{
+	struct report_batch_s *batch = container_of(to_delayed_work(work),
+					struct report_batch_s, work);
+	struct kfreecess_event events[KFREECESS_BATCH_MAX];
+	struct report_stat_s *stat = &freecess_info.mod_reportstat[batch->mod];
+	unsigned long flags;
+	int count;
+
+	spin_lock_irqsave(&batch->lock, flags);
+	count = batch->count;
+	memcpy(events, batch->events, count * sizeof(struct kfreecess_event));
+	batch->count = 0;
+	spin_unlock_irqrestore(&batch->lock, flags);
+
+	if (!count)
+		return;
+
+	if (mod_send_batch(batch->mod, events, count) != RET_OK) {
+		spin_lock_irqsave(&stat->lock, flags);
+		stat->data.report_fail_count += count;
+		stat->data.report_fail_from_windowstart += count;
+		spin_unlock_irqrestore(&stat->lock, flags);
+	}
+}
+
+static int report_event(int mod, struct priv_data *data)
+{
+	struct report_batch_s *batch = &report_batch[mod];
+	unsigned int window = READ_ONCE(batch_window_ms);
+	struct kfreecess_event *event;
+	unsigned long flags;
+	int i, count;
+
+	if (!window)
+		return mod_sendmsg(MSG_TO_USER, mod, data);
+
+	spin_lock_irqsave(&batch->lock, flags);
+	for (i = 0; i < batch->count; i++) {
+		if (batch->events[i].target_uid == data->target_uid) {
+			spin_unlock_irqrestore(&batch->lock, flags);
+			return RET_OK;
+		}
+	}
+	/* full until the flush runs, send this one on its own */
+	if (batch->count >= KFREECESS_BATCH_MAX) {
+		spin_unlock_irqrestore(&batch->lock, flags);
+		return mod_sendmsg(MSG_TO_USER, mod, data);
+	}
+	event = &batch->events[batch->count];
+	event->caller_pid = data->caller_pid;
+	event->target_uid = data->target_uid;
+	event->flag = data->flag;
+	count = ++batch->count;
+	spin_unlock_irqrestore(&batch->lock, flags);
+
+	if (count == KFREECESS_BATCH_MAX)
+		mod_delayed_work(system_wq, &batch->work, 0);
+	else if (count == 1)
+		schedule_delayed_work(&batch->work, msecs_to_jiffies(window));
+
+	return RET_OK;
+}
+
+static void report_batch_init(void)
+{
+	int i;
+
+	for (i = 1; i < MOD_END; i++) {
+		spin_lock_init(&report_batch[i].lock);
+		report_batch[i].mod = i;
+		report_batch[i].count = 0;
+		INIT_DELAYED_WORK(&report_batch[i].work, report_batch_work);
+	}
+}
+
 int sig_report(struct task_struct *caller, struct task_struct *p)
 {
 	int ret = RET_OK;
@@ -170,7 +308,7 @@ int sig_report(struct task_struct *caller, struct task_struct *p)
 	if (thread_group_is_frozen(p) && (target_pid != last_kill_pid)) {
 		last_kill_pid = target_pid;
 		stat = &freecess_info.mod_reportstat[MOD_SIG];
-		ret = mod_sendmsg(MSG_TO_USER, MOD_SIG, &data);
+		ret = report_event(MOD_SIG, &data);
 
 		spin_lock_irqsave(&stat->lock, flags);
 		if (ret < 0) {
@@ -211,7 +349,7 @@ int binder_report(struct task_struct *caller, struct task_struct *p, int flag)
 
 	walltime = ktime_to_us(ktime_get());
 	if (p && thread_group_is_frozen(p)) {
-		ret = mod_sendmsg(MSG_TO_USER, MOD_BINDER, &data);
+		ret = report_event(MOD_BINDER, &data);
 		stat = &freecess_info.mod_reportstat[MOD_BINDER];
 		spin_lock_irqsave(&stat->lock, flags);
 		if (ret < 0) {
@@ -276,6 +414,77 @@ int cfb_report(int target_uid, const char *reason)
 	return ret;
 }
 
+/*
+ * A uid is frozen by moving all its thread groups into the freezer
+ * cgroup of freeze_procs, which userspace keeps FROZEN, and thawed by
+ * moving them back to thaw_procs. Both writes go through cgroup.procs
+ * with the credentials of the caller.
+ */
+#define FREEZE_MAX_PIDS 256
+static char freeze_procs[128] = "/sys/fs/cgroup/freezer/frozen/cgroup.procs";
+static char thaw_procs[128] = "/sys/fs/cgroup/freezer/cgroup.procs";
+module_param_string(freeze_procs, freeze_procs, sizeof(freeze_procs), 0644);
+module_param_string(thaw_procs, thaw_procs, sizeof(thaw_procs), 0644);
+
+int freecess_freeze_uid(uid_t uid, bool freeze)
+{
+	struct task_struct *p;
+	struct file *filp;
+	pid_t *pids;
+	char buf[16];
+	int i, len, count = 0, moved = 0;
+
+	pids = kmalloc_array(FREEZE_MAX_PIDS, sizeof(pid_t), GFP_KERNEL);
+	if (!pids)
+		return -ENOMEM;
+
+	rcu_read_lock();
+	for_each_process(p) {
+		if (p->flags & PF_KTHREAD)
+			continue;
+		if (task_uid(p).val != uid)
+			continue;
+		if (count == FREEZE_MAX_PIDS) {
+			pr_err("%s: uid %d has more than %d processes\n",
+			       __func__, uid, FREEZE_MAX_PIDS);
+			break;
+		}
+		pids[count++] = task_tgid_nr(p);
+	}
+	rcu_read_unlock();
+
+	filp = filp_open(freeze ? freeze_procs : thaw_procs, O_WRONLY, 0);
+	if (IS_ERR(filp)) {
+		kfree(pids);
+		return PTR_ERR(filp);
+	}
+
+	for (i = 0; i < count; i++) {
+		len = snprintf(buf, sizeof(buf), "%d", pids[i]);
+		/* processes that exited meanwhile just fail */
+		if (kernel_write(filp, buf, len, 0) == len)
+			moved++;
+	}
+	filp_close(filp, NULL);
+	kfree(pids);
+
+	pr_info("%s: uid %d %s %d/%d processes\n", __func__, uid,
+		freeze ? "froze" : "thawed", moved, count);
+	return moved;
+}
+
+/* MSG_TO_KERN MOD_FREEZE: flag 1 freezes target_uid, 0 thaws it */
+static void freeze_recv_handler(void *data, unsigned int len)
+{
+	struct kfreecess_msg_data *payload = data;
+	struct priv_data reply;
+
+	memset(&reply, 0, sizeof(struct priv_data));
+	reply.target_uid = payload->target_uid;
+	reply.flag = freecess_freeze_uid(payload->target_uid, payload->flag);
+	mod_sendmsg(MSG_TO_USER, MOD_FREEZE, &reply);
+}
+
 static void recv_handler(struct sk_buff *skb)
 {
 	struct kfreecess_msg_data *payload = NULL;
@@ -584,6 +793,8 @@ static int __init kfreecess_init(void)
 	}
 
 	freecess_runinfo_init(&freecess_info);
+	report_batch_init();
+	register_kfreecess_hook(MOD_FREEZE, freeze_recv_handler);
 	atomic_set(&kfreecess_init_suc, 1);
 	return RET_OK;
 }
@@ -1978,6 +1978,7 @@ static long ion_ioctl(struct file *filp, unsigned int cmd, unsigned long arg)
 		struct ion_allocation_data allocation;
 		struct ion_handle_data handle;
 		struct ion_custom_data custom;
+		struct ion_prereclaim_data prereclaim;
 	} data;
 
 	dir = ion_ioctl_dir(cmd);
@@ -2072,6 +2073,14 @@ static long ion_ioctl(struct file *filp, unsigned int cmd, unsigned long arg)
 			data.fd_partial.offset, data.fd_partial.len);
 		break;
 	}
+	case ION_IOC_PRERECLAIM:
+	{
+		data.prereclaim.fd = ion_rbin_heap_prereclaim_hint(
+				data.prereclaim.len, data.prereclaim.timeout_ms);
+		if (data.prereclaim.fd < 0)
+			return data.prereclaim.fd;
+		break;
+	}
 	case ION_IOC_CUSTOM:
 	{
 		if (!dev->custom_ioctl)
@@ -2794,8 +2803,15 @@ void ion_iovmm_unmap(struct dma_buf_attachment *attachment, dma_addr_t iova)
 
 	mutex_lock(&buffer->lock);
 	list_for_each_entry(iovm_map, &buffer->iovas, list) {
-		if ((domain == iovm_map->domain) && (iova == iovm_map->iova)) {
-			if (--iovm_map->map_cnt == 0) {
+		if ((domain == iovm_map->domain) && (iova == iovm_map->iova) &&
+				iovm_map->map_cnt) {
+			/*
+			 * With ION_IOVA_CACHE an idle mapping stays on the list
+			 * for the next ion_iovmm_map() of the same domain and is
+			 * only torn down by ion_buffer_destroy().
+			 */
+			if (--iovm_map->map_cnt == 0 &&
+					!IS_ENABLED(CONFIG_ION_IOVA_CACHE)) {
 				list_del(&iovm_map->list);
 				pr_debug("%s: unmap previous %pa for dev %s\n",
 					 __func__, &iovm_map->iova,
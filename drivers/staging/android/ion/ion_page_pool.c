@@ -20,7 +20,9 @@
 #include <linux/fs.h>
 #include <linux/list.h>
 #include <linux/init.h>
+#include <linux/percpu.h>
 #include <linux/slab.h>
+#include <linux/smp.h>
 #include <linux/swap.h>
 #include "ion_priv.h"
 
@@ -47,8 +49,23 @@ static void ion_page_pool_free_pages(struct ion_page_pool *pool,
 	__free_pages(page, pool->order);
 }
 
+/* pool->lock must be held */
+static void __ion_page_pool_add(struct ion_page_pool *pool, struct page *page)
+{
+	if (PageHighMem(page)) {
+		list_add_tail(&page->lru, &pool->high_items);
+		pool->high_count++;
+	} else {
+		list_add_tail(&page->lru, &pool->low_items);
+		pool->low_count++;
+	}
+}
+
 static int ion_page_pool_add(struct ion_page_pool *pool, struct page *page)
 {
+	struct ion_page_pool_pcp *pcp;
+	unsigned long flags;
+
 #ifdef CONFIG_DEBUG_LIST
 #ifdef CONFIG_RBIN
 	if (!is_ion_rbin_page(page))
@@ -59,18 +76,42 @@ static int ion_page_pool_add(struct ion_page_pool *pool, struct page *page)
 	if (pool->cached)
 		ion_clear_page_clean(page);
 
-	spin_lock(&pool->lock);
-	if (PageHighMem(page)) {
-		list_add_tail(&page->lru, &pool->high_items);
-		pool->high_count++;
-	} else {
-		list_add_tail(&page->lru, &pool->low_items);
-		pool->low_count++;
+	local_irq_save(flags);
+	pcp = this_cpu_ptr(pool->pcp);
+	if (pcp->count == ION_POOL_PCP_SIZE) {
+		spin_lock(&pool->lock);
+		while (pcp->count > ION_POOL_PCP_SIZE - ION_POOL_PCP_BATCH)
+			__ion_page_pool_add(pool, pcp->pages[--pcp->count]);
+		spin_unlock(&pool->lock);
 	}
-	spin_unlock(&pool->lock);
+	pcp->pages[pcp->count++] = page;
+	local_irq_restore(flags);
 	return 0;
 }
 
+static void ion_page_pool_drain_local(void *data)
+{
+	struct ion_page_pool *pool = data;
+	struct ion_page_pool_pcp *pcp = this_cpu_ptr(pool->pcp);
+
+	if (!pcp->count)
+		return;
+
+	spin_lock(&pool->lock);
+	while (pcp->count)
+		__ion_page_pool_add(pool, pcp->pages[--pcp->count]);
+	spin_unlock(&pool->lock);
+}
+
+/*
+ * Move the pages cached on every cpu back to the pool lists, where the
+ * shrinkers can find them. Must not be called with interrupts disabled.
+ */
+void ion_page_pool_drain_pcp(struct ion_page_pool *pool)
+{
+	on_each_cpu(ion_page_pool_drain_local, pool, 1);
+}
+
 struct page *ion_page_pool_remove(struct ion_page_pool *pool, bool high)
 {
 	struct page *page;
@@ -89,23 +130,119 @@ struct page *ion_page_pool_remove(struct ion_page_pool *pool, bool high)
 	return page;
 }
 
+/*
+ * Freed pages that were not zeroed go to a separate list. They only
+ * become allocatable through ion_page_pool_zero_dirty(), normally called
+ * from an idle priority thread, or ion_page_pool_alloc_dirty().
+ */
+void ion_page_pool_free_dirty(struct ion_page_pool *pool, struct page *page)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&pool->lock, flags);
+	list_add_tail(&page->lru, &pool->dirty_items);
+	pool->dirty_count++;
+	spin_unlock_irqrestore(&pool->lock, flags);
+}
+
+static struct page *ion_page_pool_remove_dirty(struct ion_page_pool *pool)
+{
+	struct page *page = NULL;
+	unsigned long flags;
+
+	if (!pool->dirty_count)
+		return NULL;
+
+	spin_lock_irqsave(&pool->lock, flags);
+	if (pool->dirty_count) {
+		page = list_first_entry(&pool->dirty_items, struct page, lru);
+		list_del(&page->lru);
+		pool->dirty_count--;
+	}
+	spin_unlock_irqrestore(&pool->lock, flags);
+
+	return page;
+}
+
+static int ion_page_pool_zero_page(struct ion_page_pool *pool,
+				   struct page *page)
+{
+	pgprot_t pgprot = pool->cached ? PAGE_KERNEL :
+					 pgprot_writecombine(PAGE_KERNEL);
+
+	return ion_heap_pages_zero(page, PAGE_SIZE << pool->order, pgprot);
+}
+
+/* zero a dirty page on the caller, for when no zeroed page is left */
+struct page *ion_page_pool_alloc_dirty(struct ion_page_pool *pool)
+{
+	struct page *page = ion_page_pool_remove_dirty(pool);
+
+	if (page && ion_page_pool_zero_page(pool, page)) {
+		ion_page_pool_free_pages(pool, page);
+		page = NULL;
+	}
+
+	return page;
+}
+
+/* returns the number of dirty pages moved to the allocatable lists */
+int ion_page_pool_zero_dirty(struct ion_page_pool *pool, int nr)
+{
+	unsigned long flags;
+	struct page *page;
+	int zeroed = 0;
+
+	while (zeroed < nr) {
+		page = ion_page_pool_remove_dirty(pool);
+		if (!page)
+			break;
+		if (ion_page_pool_zero_page(pool, page)) {
+			ion_page_pool_free_pages(pool, page);
+			continue;
+		}
+		if (pool->cached)
+			ion_clear_page_clean(page);
+
+		/* bypass the local cache, any cpu may want these pages */
+		spin_lock_irqsave(&pool->lock, flags);
+		__ion_page_pool_add(pool, page);
+		spin_unlock_irqrestore(&pool->lock, flags);
+		zeroed++;
+	}
+
+	return zeroed;
+}
+
 struct page *ion_page_pool_alloc(struct ion_page_pool *pool)
 {
+	struct ion_page_pool_pcp *pcp;
 	struct page *page = NULL;
+	unsigned long flags;
 
 	BUG_ON(!pool);
 
-	if (!pool->high_count && !pool->low_count)
-		goto done;
+	local_irq_save(flags);
+	pcp = this_cpu_ptr(pool->pcp);
+	if (!pcp->count && (pool->high_count || pool->low_count)) {
+		spin_lock(&pool->lock);
+		while (pcp->count < ION_POOL_PCP_BATCH) {
+			if (pool->high_count)
+				page = ion_page_pool_remove(pool, true);
+			else if (pool->low_count)
+				page = ion_page_pool_remove(pool, false);
+			else
+				break;
+			pcp->pages[pcp->count++] = page;
+		}
+		spin_unlock(&pool->lock);
+	}
 
-	spin_lock(&pool->lock);
-	if (pool->high_count)
-		page = ion_page_pool_remove(pool, true);
-	else if (pool->low_count)
-		page = ion_page_pool_remove(pool, false);
-	spin_unlock(&pool->lock);
+	page = NULL;
+	if (pcp->count)
+		page = pcp->pages[--pcp->count];
+	local_irq_restore(flags);
 
-done:
 	return page;
 }
 
@@ -132,11 +269,16 @@ void ion_page_pool_free_immediate(struct ion_page_pool *pool, struct page *page)
 
 int ion_page_pool_total(struct ion_page_pool *pool, bool high)
 {
-	int count = pool->low_count;
+	int count = pool->low_count + pool->dirty_count;
+	int cpu;
 
 	if (high)
 		count += pool->high_count;
 
+	/* cached pages are counted as lowmem, the shrinkers drain them */
+	for_each_possible_cpu(cpu)
+		count += per_cpu_ptr(pool->pcp, cpu)->count;
+
 	return count << pool->order;
 }
 
@@ -144,6 +286,7 @@ int ion_page_pool_shrink(struct ion_page_pool *pool, gfp_t gfp_mask,
 				int nr_to_scan)
 {
 	int freed = 0;
+	bool drained = false;
 	bool high;
 
 	if (current_is_kswapd())
@@ -156,17 +299,28 @@ int ion_page_pool_shrink(struct ion_page_pool *pool, gfp_t gfp_mask,
 
 	while (freed < nr_to_scan) {
 		struct page *page;
-
-		spin_lock(&pool->lock);
-		if (pool->low_count) {
+		unsigned long flags;
+
+		spin_lock_irqsave(&pool->lock, flags);
+		if (pool->dirty_count) {
+			/* not usable before zeroing anyway, drop them first */
+			page = list_first_entry(&pool->dirty_items,
+						struct page, lru);
+			list_del(&page->lru);
+			pool->dirty_count--;
+		} else if (pool->low_count) {
 			page = ion_page_pool_remove(pool, false);
 		} else if (high && pool->high_count) {
 			page = ion_page_pool_remove(pool, true);
 		} else {
-			spin_unlock(&pool->lock);
-			break;
+			spin_unlock_irqrestore(&pool->lock, flags);
+			if (drained)
+				break;
+			ion_page_pool_drain_pcp(pool);
+			drained = true;
+			continue;
 		}
-		spin_unlock(&pool->lock);
+		spin_unlock_irqrestore(&pool->lock, flags);
 		ion_page_pool_free_pages(pool, page);
 		freed += (1 << pool->order);
 	}
@@ -180,10 +334,17 @@ struct ion_page_pool *ion_page_pool_create(gfp_t gfp_mask, unsigned int order)
 					     GFP_KERNEL);
 	if (!pool)
 		return NULL;
+	pool->pcp = alloc_percpu(struct ion_page_pool_pcp);
+	if (!pool->pcp) {
+		kfree(pool);
+		return NULL;
+	}
 	pool->high_count = 0;
 	pool->low_count = 0;
 	INIT_LIST_HEAD(&pool->low_items);
 	INIT_LIST_HEAD(&pool->high_items);
+	pool->dirty_count = 0;
+	INIT_LIST_HEAD(&pool->dirty_items);
 	pool->gfp_mask = gfp_mask | __GFP_COMP;
 	pool->order = order;
 	spin_lock_init(&pool->lock);
@@ -194,6 +355,7 @@ struct ion_page_pool *ion_page_pool_create(gfp_t gfp_mask, unsigned int order)
 
 void ion_page_pool_destroy(struct ion_page_pool *pool)
 {
+	free_percpu(pool->pcp);
 	kfree(pool);
 }
 
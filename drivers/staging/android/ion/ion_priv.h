@@ -416,6 +416,13 @@ void ion_system_contig_heap_destroy(struct ion_heap *);
 struct ion_heap *ion_rbin_heap_create(struct ion_platform_heap *);
 void ion_rbin_heap_destroy(struct ion_heap *);
 bool is_ion_rbin_page(struct page *);
+int ion_rbin_heap_prereclaim_hint(u64 len, unsigned int timeout_ms);
+#else
+static inline int ion_rbin_heap_prereclaim_hint(u64 len,
+						unsigned int timeout_ms)
+{
+	return -ENODEV;
+}
 #endif
 
 struct ion_heap *ion_carveout_heap_create(struct ion_platform_heap *);
@@ -468,6 +475,24 @@ void ion_carveout_free(struct ion_heap *heap, ion_phys_addr_t addr,
 #define ion_get_page_clean(page)	test_bit(PG_dcache_clean, &(page)->flags)
 #define ion_clear_page_clean(page)	clear_bit(PG_dcache_clean, &(page)->flags)
 
+#define ION_POOL_PCP_SIZE	16
+#define ION_POOL_PCP_BATCH	(ION_POOL_PCP_SIZE / 2)
+/* dirty pages zeroed per ion_page_pool_zero_dirty() call */
+#define ION_POOL_ZERO_BATCH	8
+
+/**
+ * struct ion_page_pool_pcp - per-cpu page cache in front of a pool
+ * @count:		number of pages in @pages
+ * @pages:		cached pages, used as a stack
+ *
+ * Only touched by the owning cpu with interrupts disabled, so that
+ * ion_page_pool_drain_pcp() can empty it from an IPI.
+ */
+struct ion_page_pool_pcp {
+	int count;
+	struct page *pages[ION_POOL_PCP_SIZE];
+};
+
 /**
  * struct ion_page_pool - pagepool struct
  * @high_count:		number of highmem items in the pool
@@ -479,6 +504,10 @@ void ion_carveout_free(struct ion_heap *heap, ion_phys_addr_t addr,
  * @gfp_mask:		gfp_mask to use from alloc
  * @order:		order of pages in the pool
  * @list:		plist node for list of pools
+ * @pcp:		per-cpu caches, refilled from and drained to the
+ *			lists ION_POOL_PCP_BATCH pages at a time
+ * @dirty_count:	number of items waiting to be zeroed
+ * @dirty_items:	freed pages not zeroed yet, never handed out as is
  *
  * Allows you to keep a pool of pre allocated pages to use from your heap.
  * Keeping a pool of pages that is ready for dma, ie any cached mapping have
@@ -495,6 +524,9 @@ struct ion_page_pool {
 	unsigned int order;
 	bool cached;
 	struct plist_node list;
+	struct ion_page_pool_pcp __percpu *pcp;
+	int dirty_count;
+	struct list_head dirty_items;
 };
 
 struct ion_page_pool *ion_page_pool_create(gfp_t gfp_mask, unsigned int order);
@@ -505,6 +537,10 @@ struct page *ion_page_pool_alloc(struct ion_page_pool *);
 void ion_page_pool_free(struct ion_page_pool *, struct page *);
 void ion_page_pool_free_immediate(struct ion_page_pool *, struct page *);
 int ion_page_pool_total(struct ion_page_pool *pool, bool high);
+void ion_page_pool_drain_pcp(struct ion_page_pool *pool);
+void ion_page_pool_free_dirty(struct ion_page_pool *pool, struct page *page);
+struct page *ion_page_pool_alloc_dirty(struct ion_page_pool *pool);
+int ion_page_pool_zero_dirty(struct ion_page_pool *pool, int nr);
 
 #ifdef CONFIG_ION_POOL_CACHE_POLICY
 static inline void ion_page_pool_alloc_set_cache_policy
@@ -28,11 +28,19 @@
 #include <linux/cpu.h>
 #include <linux/cma.h>
 #include <linux/freezer.h>
+#include <linux/anon_inodes.h>
+#include <linux/file.h>
+#include <linux/poll.h>
+#include <linux/sizes.h>
+#include <linux/uaccess.h>
 #include "ion.h"
 #include "ion_priv.h"
 
 #define NUM_ORDERS ARRAY_SIZE(orders)
 
+/* pfns reclaimed per step when working towards a hinted target */
+#define PRERECLAIM_CHUNK_PAGES	(SZ_8M >> PAGE_SHIFT)
+
 static const unsigned int orders[] = {10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0};
 
 static int order_to_index(unsigned int order)
@@ -56,6 +64,23 @@ struct ion_rbin_heap {
 	struct task_struct *task_shrink;
 	bool shrink_run;
 	struct ion_page_pool *pools[NUM_ORDERS];
+	/* pending prereclaim request, protected by hint_lock */
+	spinlock_t hint_lock;
+	bool prereclaim_full;
+	unsigned long prereclaim_target;	/* bytes */
+	unsigned long prereclaim_deadline;	/* jiffies */
+	unsigned long hint_seq;			/* last request queued */
+	unsigned long hint_done_seq;		/* last request finished */
+	atomic_long_t prereclaimed;		/* bytes moved to the pools */
+	wait_queue_head_t hint_wait;
+};
+
+/* state of one ION_IOC_PRERECLAIM fd */
+struct ion_rbin_hint {
+	struct ion_rbin_heap *heap;
+	unsigned long seq;
+	long base;				/* prereclaimed at issue time */
+	unsigned long target;
 };
 
 static struct page *alloc_rbin_page(struct ion_rbin_heap *heap,
@@ -365,11 +390,106 @@ bool is_ion_rbin_page(struct page *page)
 void wake_ion_rbin_heap_prereclaim(void)
 {
 	if (rbin_heap) {
+		spin_lock(&rbin_heap->hint_lock);
+		rbin_heap->prereclaim_full = true;
+		rbin_heap->hint_seq++;
+		spin_unlock(&rbin_heap->hint_lock);
 		rbin_heap->prereclaim_run = 1;
 		wake_up(&rbin_heap->waitqueue);
 	}
 }
 
+static bool ion_rbin_hint_done(struct ion_rbin_hint *hint)
+{
+	return (long)(READ_ONCE(hint->heap->hint_done_seq) - hint->seq) >= 0;
+}
+
+static unsigned int ion_rbin_hint_poll(struct file *file, poll_table *wait)
+{
+	struct ion_rbin_hint *hint = file->private_data;
+
+	poll_wait(file, &hint->heap->hint_wait, wait);
+	return ion_rbin_hint_done(hint) ? POLLIN | POLLRDNORM : 0;
+}
+
+static ssize_t ion_rbin_hint_read(struct file *file, char __user *buf,
+				  size_t count, loff_t *ppos)
+{
+	struct ion_rbin_hint *hint = file->private_data;
+	long done = atomic_long_read(&hint->heap->prereclaimed) - hint->base;
+	__u64 progress = min_t(unsigned long, max(done, 0L), hint->target);
+
+	if (count < sizeof(progress))
+		return -EINVAL;
+	if (copy_to_user(buf, &progress, sizeof(progress)))
+		return -EFAULT;
+
+	return sizeof(progress);
+}
+
+static int ion_rbin_hint_release(struct inode *inode, struct file *file)
+{
+	kfree(file->private_data);
+	return 0;
+}
+
+static const struct file_operations ion_rbin_hint_fops = {
+	.poll = ion_rbin_hint_poll,
+	.read = ion_rbin_hint_read,
+	.release = ion_rbin_hint_release,
+	.llseek = noop_llseek,
+};
+
+/*
+ * Queue a request for @len bytes of rbin memory to be reclaimed into the
+ * pools within @timeout_ms and return an fd to follow its progress.
+ * Requests issued while one is running are merged into the next pass.
+ */
+int ion_rbin_heap_prereclaim_hint(u64 len, unsigned int timeout_ms)
+{
+	struct ion_rbin_hint *hint;
+	unsigned long deadline;
+	int fd;
+
+	if (!rbin_heap || !rbin_heap->cma)
+		return -ENODEV;
+	if (!len)
+		return -EINVAL;
+
+	hint = kzalloc(sizeof(*hint), GFP_KERNEL);
+	if (!hint)
+		return -ENOMEM;
+
+	len = min_t(u64, PAGE_ALIGN(len), rbin_heap->count << PAGE_SHIFT);
+	deadline = jiffies + (timeout_ms ? msecs_to_jiffies(timeout_ms) :
+					     MAX_JIFFY_OFFSET);
+
+	hint->heap = rbin_heap;
+	hint->target = len;
+	hint->base = atomic_long_read(&rbin_heap->prereclaimed);
+
+	spin_lock(&rbin_heap->hint_lock);
+	if (rbin_heap->prereclaim_target < len)
+		rbin_heap->prereclaim_target = len;
+	if (!rbin_heap->prereclaim_deadline ||
+	    time_after(deadline, rbin_heap->prereclaim_deadline))
+		rbin_heap->prereclaim_deadline = deadline;
+	hint->seq = ++rbin_heap->hint_seq;
+	spin_unlock(&rbin_heap->hint_lock);
+
+	fd = anon_inode_getfd("ion_rbin_prereclaim", &ion_rbin_hint_fops,
+			      hint, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		kfree(hint);
+		return fd;
+	}
+
+	rbin_heap->prereclaim_run = 1;
+	wake_up(&rbin_heap->waitqueue);
+
+	return fd;
+}
+
 void wake_ion_rbin_heap_shrink(void)
 {
 	if (rbin_heap) {
@@ -378,15 +498,67 @@ void wake_ion_rbin_heap_shrink(void)
 	}
 }
 
+/* move free rbin memory into the pools until @limit bytes were added */
+static unsigned long ion_rbin_heap_fill_pools(struct ion_rbin_heap *heap,
+					      unsigned long limit)
+{
+	unsigned int max_pool_order = orders[0];
+	struct ion_page_pool *pool;
+	unsigned long totalsize = 0;
+	unsigned long pagesize;
+	unsigned int order;
+	struct page *page;
+
+	while (totalsize < limit) {
+		page = alloc_rbin_page(heap, NULL,
+				       PAGE_SIZE << max_pool_order);
+		if (!page)
+			break;
+		pagesize = page_private(page);
+		totalsize += pagesize;
+		order = get_order(pagesize);
+		pool = heap->pools[order_to_index(order)];
+		ion_page_pool_free(pool, page);
+		atomic_add(1 << order, &rbin_pool_pages);
+		atomic_long_add(pagesize, &heap->prereclaimed);
+	}
+
+	return totalsize;
+}
+
+/*
+ * Reclaim the region a chunk at a time, so that a hinted request stops
+ * as soon as its target is in the pools or its deadline has passed.
+ */
+static unsigned long ion_rbin_heap_prereclaim_target(struct ion_rbin_heap *heap,
+						     unsigned long target,
+						     unsigned long deadline)
+{
+	unsigned long pfn = heap->base_pfn;
+	unsigned long end = heap->base_pfn + heap->count;
+	unsigned long totalsize;
+
+	/* whatever is already free comes first */
+	totalsize = ion_rbin_heap_fill_pools(heap, target);
+	while (totalsize < target && pfn < end &&
+	       time_before(jiffies, deadline)) {
+		unsigned long next = min(pfn + PRERECLAIM_CHUNK_PAGES, end);
+
+		reclaim_contig_migrate_range(pfn, next, 0);
+		pfn = next;
+		totalsize += ion_rbin_heap_fill_pools(heap, target - totalsize);
+		wake_up_interruptible_all(&heap->hint_wait);
+	}
+
+	return totalsize;
+}
+
 static int ion_rbin_heap_prereclaim(void *data)
 {
 	struct ion_rbin_heap *heap = data;
-	struct page *page;
 	unsigned long totalsize;
-	unsigned long pagesize;
-	unsigned int max_pool_order = orders[0];
-	unsigned int order;
-	struct ion_page_pool *pool;
+	unsigned long target, deadline, seq;
+	bool full;
 
 	if (!heap || !heap->cma)
 		return -EINVAL;
@@ -395,24 +567,36 @@ static int ion_rbin_heap_prereclaim(void *data)
 		wait_event_freezable(heap->waitqueue,
 				     heap->prereclaim_run);
 
+		/* requests arriving from now on get another pass */
+		heap->prereclaim_run = 0;
+		spin_lock(&heap->hint_lock);
+		full = heap->prereclaim_full;
+		target = heap->prereclaim_target;
+		deadline = heap->prereclaim_deadline;
+		seq = heap->hint_seq;
+		heap->prereclaim_full = false;
+		heap->prereclaim_target = 0;
+		heap->prereclaim_deadline = 0;
+		spin_unlock(&heap->hint_lock);
+
+		/* nothing left if a request was taken by the previous pass */
+		if (!full && !target)
+			goto done;
+
 		trace_printk("start\n");
-		reclaim_contig_migrate_range(heap->base_pfn,
-				heap->base_pfn + heap->count, 0);
-		totalsize = 0;
-		while (true) {
-			page = alloc_rbin_page(heap, NULL,
-					       PAGE_SIZE << max_pool_order);
-			if (!page)
-				break;
-			pagesize = page_private(page);
-			totalsize += pagesize;
-			order = get_order(pagesize);
-			pool = heap->pools[order_to_index(order)];
-			ion_page_pool_free(pool, page);
-			atomic_add(1 << order, &rbin_pool_pages);
+		if (full) {
+			reclaim_contig_migrate_range(heap->base_pfn,
+					heap->base_pfn + heap->count, 0);
+			totalsize = ion_rbin_heap_fill_pools(heap, ULONG_MAX);
+		} else {
+			totalsize = ion_rbin_heap_prereclaim_target(heap,
+							target, deadline);
 		}
 		trace_printk("end %lu\n", totalsize);
-		heap->prereclaim_run = 0;
+done:
+
+		WRITE_ONCE(heap->hint_done_seq, seq);
+		wake_up_interruptible_all(&heap->hint_wait);
 	}
 
 	return 0;
@@ -426,20 +610,22 @@ static int ion_page_pool_shrink_cma(struct cma *cma, struct ion_page_pool *pool,
 	if (nr_to_scan == 0)
 		return ion_page_pool_total(pool, 1);
 
+	ion_page_pool_drain_pcp(pool);
 	while (freed < nr_to_scan) {
 		struct page *page;
 		int page_count = 1 << pool->order;
+		unsigned long flags;
 
-		spin_lock(&pool->lock);
+		spin_lock_irqsave(&pool->lock, flags);
 		if (pool->low_count) {
 			page = ion_page_pool_remove(pool, false);
 		} else if (pool->high_count) {
 			page = ion_page_pool_remove(pool, true);
 		} else {
-			spin_unlock(&pool->lock);
+			spin_unlock_irqrestore(&pool->lock, flags);
 			break;
 		}
-		spin_unlock(&pool->lock);
+		spin_unlock_irqrestore(&pool->lock, flags);
 		cma_release(cma, page, page_count);
 		freed += page_count;
 	}
@@ -563,6 +749,9 @@ struct ion_heap *ion_rbin_heap_create(struct ion_platform_heap *data)
 	heap->heap.debug_show = ion_rbin_heap_debug_show;
 
 	init_waitqueue_head(&heap->waitqueue);
+	spin_lock_init(&heap->hint_lock);
+	atomic_long_set(&heap->prereclaimed, 0);
+	init_waitqueue_head(&heap->hint_wait);
 	heap->task = kthread_run(ion_rbin_heap_prereclaim, heap,
 				 "%s", "rbin");
 	heap->task_shrink = kthread_run(ion_rbin_heap_shrink_all, heap,
@@ -25,6 +25,9 @@
 #include <linux/slab.h>
 #include <linux/vmalloc.h>
 #include <linux/kthread.h>
+#include <linux/compaction.h>
+#include <linux/freezer.h>
+#include <linux/wait.h>
 #include <asm/tlbflush.h>
 #include "ion.h"
 #include "ion_priv.h"
@@ -35,6 +38,13 @@ static gfp_t low_order_gfp_flags  = (GFP_HIGHUSER | __GFP_ZERO | __GFP_NOWARN);
 static const unsigned int orders[] = {8, 4, 0};
 static const int num_orders = ARRAY_SIZE(orders);
 static unsigned int fixed_max_order;
+/*
+ * Percentage of failed attempts at an order, over the last
+ * ION_COMPACT_WINDOW attempts, that wakes kcompactd for it. 0 = never.
+ */
+static unsigned int compact_threshold;
+
+#define ION_COMPACT_WINDOW	64
 
 static int order_to_index(unsigned int order)
 {
@@ -52,9 +62,21 @@ static inline unsigned int order_to_size(int order)
 	return PAGE_SIZE << order;
 }
 
+struct ion_system_heap_order_stat {
+	atomic_long_t success;		/* pages obtained at this order */
+	atomic_long_t fallback;		/* failed attempts, went lower */
+	atomic_long_t compact_hints;	/* kcompactd wakeups */
+	atomic_t window;		/* attempts in the current window */
+	atomic_t window_fallback;	/* failures in the current window */
+};
+
 struct ion_system_heap {
 	struct ion_heap heap;
 	struct ion_page_pool **pools;
+	struct ion_system_heap_order_stat order_stat[ARRAY_SIZE(orders)];
+	/* zeroes freed pages at idle priority, NULL to zero on free */
+	struct task_struct *zero_task;
+	wait_queue_head_t zero_wait;
 };
 
 static struct page *alloc_buffer_page(struct ion_system_heap *heap,
@@ -81,6 +103,10 @@ static struct page *alloc_buffer_page(struct ion_system_heap *heap,
 		page = ion_page_pool_alloc(pool);
 	}
 
+	/* the zeroing thread is behind, still cheaper than the buddy */
+	if (!page)
+		page = ion_page_pool_alloc_dirty(heap->pools[idx]);
+
 	if (!page)
 		page = ion_page_pool_alloc_pages(pool);
 
@@ -88,7 +114,8 @@ static struct page *alloc_buffer_page(struct ion_system_heap *heap,
 }
 
 static void free_buffer_page(struct ion_system_heap *heap,
-			     struct ion_buffer *buffer, struct page *page)
+			     struct ion_buffer *buffer, struct page *page,
+			     bool dirty)
 {
 	unsigned int order = compound_order(page);
 
@@ -100,11 +127,43 @@ static void free_buffer_page(struct ion_system_heap *heap,
 		int idx = order_to_index(order) + (num_orders * uncached);
 		struct ion_page_pool *pool = heap->pools[idx];
 
-		ion_page_pool_free(pool, page);
+		if (dirty)
+			ion_page_pool_free_dirty(pool, page);
+		else
+			ion_page_pool_free(pool, page);
 	}
 }
 
 
+static void ion_system_heap_account(struct ion_system_heap *heap, int idx,
+				    bool fallback)
+{
+	struct ion_system_heap_order_stat *stat = &heap->order_stat[idx];
+	unsigned int threshold = READ_ONCE(compact_threshold);
+	int attempts, failed;
+
+	atomic_long_inc(fallback ? &stat->fallback : &stat->success);
+
+	/* order-0 never falls back and compaction does not help it */
+	if (!threshold || !orders[idx])
+		return;
+
+	if (fallback)
+		atomic_inc(&stat->window_fallback);
+	attempts = atomic_inc_return(&stat->window);
+	if (attempts < ION_COMPACT_WINDOW ||
+	    atomic_cmpxchg(&stat->window, attempts, 0) != attempts)
+		return;
+
+	failed = atomic_xchg(&stat->window_fallback, 0);
+	if (failed * 100 < threshold * attempts)
+		return;
+
+	atomic_long_inc(&stat->compact_hints);
+	wakeup_kcompactd(NODE_DATA(numa_node_id()), orders[idx],
+			 gfp_zone(high_order_gfp_flags));
+}
+
 static struct page *alloc_largest_available(struct ion_system_heap *heap,
 					    struct ion_buffer *buffer,
 					    unsigned long size,
@@ -120,6 +179,7 @@ static struct page *alloc_largest_available(struct ion_system_heap *heap,
 			continue;
 
 		page = alloc_buffer_page(heap, buffer, orders[i]);
+		ion_system_heap_account(heap, i, !page);
 		if (!page)
 			continue;
 
@@ -194,7 +254,7 @@ free_pages:
 	list_for_each_entry_safe(page, tmp_page, &pages, lru) {
 		list_del(&page->lru);
 		buffer->private_flags |= ION_PRIV_FLAG_SHRINKER_FREE;
-		free_buffer_page(sys_heap, buffer, page);
+		free_buffer_page(sys_heap, buffer, page, false);
 	}
 
 	return -ENOMEM;
@@ -207,20 +267,64 @@ static void ion_system_heap_free(struct ion_buffer *buffer)
 							heap);
 	struct sg_table *table = buffer->sg_table;
 	struct scatterlist *sg;
+	bool dirty = false;
 	int i;
 
 	/*
 	 *  pages come from the page pools, zero them before returning
 	 *  for security purposes (other allocations are zerod at
-	 *  alloc time
+	 *  alloc time. With the zeroing thread running they are
+	 *  parked on the dirty lists and zeroed later instead.
 	 */
-	if (!(buffer->private_flags & ION_PRIV_FLAG_SHRINKER_FREE))
-		ion_heap_buffer_zero(buffer);
+	if (!(buffer->private_flags & ION_PRIV_FLAG_SHRINKER_FREE)) {
+		if (sys_heap->zero_task)
+			dirty = true;
+		else
+			ion_heap_buffer_zero(buffer);
+	}
 
 	for_each_sg(table->sgl, sg, table->nents, i)
-		free_buffer_page(sys_heap, buffer, sg_page(sg));
+		free_buffer_page(sys_heap, buffer, sg_page(sg), dirty);
 	sg_free_table(table);
 	kfree(table);
+
+	if (dirty)
+		wake_up(&sys_heap->zero_wait);
+}
+
+static bool ion_system_heap_has_dirty(struct ion_system_heap *sys_heap)
+{
+	int i;
+
+	for (i = 0; i < num_orders * 2; i++)
+		if (sys_heap->pools[i]->dirty_count)
+			return true;
+
+	return false;
+}
+
+static int ion_system_heap_zero_thread(void *data)
+{
+	struct ion_system_heap *sys_heap = data;
+	int i;
+
+	set_freezable();
+	while (!kthread_should_stop()) {
+		wait_event_freezable(sys_heap->zero_wait,
+				     ion_system_heap_has_dirty(sys_heap) ||
+				     kthread_should_stop());
+
+		/* largest orders first, they are the most wanted */
+		for (i = 0; i < num_orders * 2; i++) {
+			struct ion_page_pool *pool = sys_heap->pools[i];
+
+			while (ion_page_pool_zero_dirty(pool,
+							ION_POOL_ZERO_BATCH))
+				cond_resched();
+		}
+	}
+
+	return 0;
 }
 
 static struct sg_table *ion_system_heap_map_dma(struct ion_heap *heap,
@@ -308,6 +412,28 @@ static int ion_system_heap_debug_show(struct ion_heap *heap, struct seq_file *s,
 			   (PAGE_SIZE << pool->order) * pool->low_count);
 	}
 
+	for (i = 0; i < (num_orders * 2); i++) {
+		struct ion_page_pool *pool = sys_heap->pools[i];
+
+		seq_printf(s, "%d order %u pages waiting for zeroing in %s pool = %lu total\n",
+			   pool->dirty_count, pool->order,
+			   pool->cached ? "cached" : "uncached",
+			   (PAGE_SIZE << pool->order) * pool->dirty_count);
+	}
+
+	for (i = 0; i < num_orders; i++) {
+		struct ion_system_heap_order_stat *stat =
+						&sys_heap->order_stat[i];
+		long success = atomic_long_read(&stat->success);
+		long fallback = atomic_long_read(&stat->fallback);
+		long attempts = success + fallback;
+
+		seq_printf(s, "order %u: %ld allocated %ld fallback (%ld%%) %ld compaction hints\n",
+			   orders[i], success, fallback,
+			   attempts ? fallback * 100 / attempts : 0,
+			   atomic_long_read(&stat->compact_hints));
+	}
+
 	return 0;
 }
 
@@ -339,6 +465,29 @@ static struct kobj_attribute ion_system_heap_orders_attr =
 	__ATTR(ion_system_heap_orders, 0644,
 		ion_system_heap_orders_show, ion_system_heap_orders_store);
 
+static ssize_t ion_system_heap_compact_show(struct kobject *kobj,
+				 struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%u\n", compact_threshold);
+}
+
+static ssize_t ion_system_heap_compact_store(struct kobject *kobj,
+				  struct kobj_attribute *attr,
+				  const char *buf, size_t n)
+{
+	unsigned int threshold;
+
+	if (kstrtouint(buf, 10, &threshold) || threshold > 100)
+		return -EINVAL;
+
+	compact_threshold = threshold;
+	return n;
+}
+
+static struct kobj_attribute ion_system_heap_compact_attr =
+	__ATTR(ion_system_heap_compact_threshold, 0644,
+		ion_system_heap_compact_show, ion_system_heap_compact_store);
+
 struct ion_heap *ion_system_heap_create(struct ion_platform_heap *unused)
 {
 	struct ion_system_heap *heap;
@@ -370,8 +519,22 @@ struct ion_heap *ion_system_heap_create(struct ion_platform_heap *unused)
 	heap->heap.debug_show = ion_system_heap_debug_show;
 	fixed_max_order = orders[0];
 
+	init_waitqueue_head(&heap->zero_wait);
+	heap->zero_task = kthread_run(ion_system_heap_zero_thread, heap,
+				      "ion_sys_zero");
+	if (IS_ERR(heap->zero_task)) {
+		pr_err("%s: creating thread for zeroing failed\n", __func__);
+		heap->zero_task = NULL;
+	} else {
+		struct sched_param param = { .sched_priority = 0 };
+
+		sched_setscheduler(heap->zero_task, SCHED_IDLE, &param);
+	}
+
 	if (sysfs_create_file(kernel_kobj, &ion_system_heap_orders_attr.attr))
 		pr_err("%s: Failed to create sysfs on ION system heap", __func__);
+	if (sysfs_create_file(kernel_kobj, &ion_system_heap_compact_attr.attr))
+		pr_err("%s: Failed to create sysfs on ION system heap", __func__);
 
 	return &heap->heap;
 
@@ -391,6 +554,8 @@ void ion_system_heap_destroy(struct ion_heap *heap)
 							heap);
 	int i;
 
+	if (sys_heap->zero_task)
+		kthread_stop(sys_heap->zero_task);
 	for (i = 0; i < num_orders * 2; i++)
 		ion_page_pool_destroy(sys_heap->pools[i]);
 	kfree(sys_heap->pools);
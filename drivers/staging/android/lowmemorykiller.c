@@ -46,6 +46,11 @@
 #include <linux/proc_fs.h>
 #include <linux/slab.h>
 #include <linux/poll.h>
+#include <linux/delayacct.h>
+#include <linux/ktime.h>
+#include <linux/bitmap.h>
+#include <linux/hashtable.h>
+#include <trace/events/oom.h>
 
 #define CREATE_TRACE_POINTS
 #include "trace/lowmemorykiller.h"
@@ -139,6 +144,134 @@ void handle_lmk_event(struct task_struct *selected, int selected_tasksize,
 	wake_up_interruptible(&event_wait);
 }
 
+#ifdef CONFIG_ANDROID_LOW_MEMORY_KILLER_STALL
+static uint lowmem_stall_window_ms = 1000;
+static uint lowmem_stall_threshold_ms;
+
+/*
+ * Stall is the union of the direct reclaim intervals seen by
+ * lowmem_scan(), in usecs, summed per window. The estimate for the
+ * last window_ms adds the part of the previous window that is still
+ * inside it.
+ */
+static DEFINE_SPINLOCK(lowmem_stall_lock);
+static u64 lowmem_stall_last;
+static u64 lowmem_stall_window_start;
+static u64 lowmem_stall_cur;
+static u64 lowmem_stall_prev;
+static u64 lowmem_stall_fired = -1ULL;
+static u64 lowmem_stall_report;
+static bool lowmem_stall_pending;
+
+static u64 lowmem_stall_update(void)
+{
+	u64 window = (u64)max(lowmem_stall_window_ms, 1U) * USEC_PER_MSEC;
+	u64 threshold = (u64)lowmem_stall_threshold_ms * USEC_PER_MSEC;
+	u64 now = ktime_to_us(ktime_get());
+	u64 elapsed, start, stall;
+	bool fire = false;
+
+	spin_lock(&lowmem_stall_lock);
+	elapsed = now - lowmem_stall_window_start;
+	if (elapsed >= window) {
+		if (elapsed < 2 * window) {
+			lowmem_stall_prev = lowmem_stall_cur;
+			lowmem_stall_window_start += window;
+		} else {
+			lowmem_stall_prev = 0;
+			lowmem_stall_window_start = now;
+		}
+		lowmem_stall_cur = 0;
+		elapsed = now - lowmem_stall_window_start;
+	}
+
+	/* PF_MEMALLOC without kswapd: inside __perform_reclaim() */
+	if ((current->flags & PF_MEMALLOC) && !current_is_kswapd() &&
+	    current->delays) {
+		start = div_u64(current->delays->freepages_start,
+				NSEC_PER_USEC);
+		start = max(start, lowmem_stall_last);
+		if (now > start)
+			lowmem_stall_cur += now - start;
+		lowmem_stall_last = now;
+	}
+
+	stall = lowmem_stall_cur +
+		div64_u64(lowmem_stall_prev * (window - elapsed), window);
+	if (threshold && stall >= threshold &&
+	    lowmem_stall_fired != lowmem_stall_window_start) {
+		lowmem_stall_fired = lowmem_stall_window_start;
+		lowmem_stall_report = stall;
+		lowmem_stall_pending = true;
+		fire = true;
+	}
+	spin_unlock(&lowmem_stall_lock);
+
+	if (fire)
+		wake_up_interruptible(&event_wait);
+	return stall;
+}
+
+/*
+ * With a stall threshold set, kill only once it is reached, and then
+ * even above every minfree level.
+ */
+static short lowmem_stall_adj(short min_score_adj, int array_size)
+{
+	u64 stall = lowmem_stall_update();
+
+	if (!lowmem_stall_threshold_ms)
+		return min_score_adj;
+
+	if (stall < (u64)lowmem_stall_threshold_ms * USEC_PER_MSEC) {
+		lowmem_print(4, "stall %lluus below threshold\n", stall);
+		return OOM_SCORE_ADJ_MAX + 1;
+	}
+	if (min_score_adj == OOM_SCORE_ADJ_MAX + 1 && array_size)
+		min_score_adj = lowmem_adj[array_size - 1];
+	lowmem_print(3, "stall %lluus, ma %hd\n", stall, min_score_adj);
+	return min_score_adj;
+}
+
+/* Called with lmk_event_lock held */
+static bool lowmem_stall_show(struct seq_file *s)
+{
+	u64 stall;
+
+	spin_lock(&lowmem_stall_lock);
+	stall = lowmem_stall_report;
+	if (!lowmem_stall_pending) {
+		spin_unlock(&lowmem_stall_lock);
+		return false;
+	}
+	lowmem_stall_pending = false;
+	spin_unlock(&lowmem_stall_lock);
+
+	seq_printf(s, "stall %llu %u\n", stall, lowmem_stall_window_ms);
+	return true;
+}
+
+static bool lowmem_stall_polled(void)
+{
+	return READ_ONCE(lowmem_stall_pending);
+}
+#else
+static inline short lowmem_stall_adj(short min_score_adj, int array_size)
+{
+	return min_score_adj;
+}
+
+static inline bool lowmem_stall_show(struct seq_file *s)
+{
+	return false;
+}
+
+static inline bool lowmem_stall_polled(void)
+{
+	return false;
+}
+#endif
+
 static int lmk_event_show(struct seq_file *s, void *unused)
 {
 	struct lmk_event *events = (struct lmk_event *) event_buffer.buf;
@@ -148,6 +281,11 @@ static int lmk_event_show(struct seq_file *s, void *unused)
 
 	spin_lock(&lmk_event_lock);
 
+	if (lowmem_stall_show(s)) {
+		spin_unlock(&lmk_event_lock);
+		return 0;
+	}
+
 	head = event_buffer.head;
 	tail = event_buffer.tail;
 
@@ -178,6 +316,8 @@ static unsigned int lmk_event_poll(struct file *file, poll_table *wait)
 	spin_lock(&lmk_event_lock);
 	if (event_buffer.head != event_buffer.tail)
 		ret = POLLIN;
+	if (lowmem_stall_polled())
+		ret |= POLLIN | POLLPRI;
 	spin_unlock(&lmk_event_lock);
 	return ret;
 }
@@ -217,6 +357,214 @@ static unsigned long lowmem_count(struct shrinker *s,
 		global_page_state(NR_INACTIVE_FILE);
 }
 
+#ifdef CONFIG_ANDROID_LOW_MEMORY_KILLER_ADJ_BUCKETS
+#define LOWMEM_ADJ_BUCKETS	(OOM_SCORE_ADJ_MAX + 1)
+
+/**
+ * struct lowmem_task - a process in its oom_score_adj bucket
+ * @tsk:    thread group leader, referenced
+ * @node:   entry in lowmem_task_hash
+ * @bucket: entry in lowmem_buckets[@adj]
+ * @rss:    rss in pages when @adj was last set
+ * @adj:    oom_score_adj when it was last set
+ */
+struct lowmem_task {
+	struct task_struct *tsk;
+	struct hlist_node node;
+	struct list_head bucket;
+	unsigned long rss;
+	short adj;
+};
+
+/* Taken under task_lock and siglock from the adj update tracepoint */
+static DEFINE_SPINLOCK(lowmem_task_lock);
+static DEFINE_HASHTABLE(lowmem_task_hash, 8);
+static struct list_head lowmem_buckets[LOWMEM_ADJ_BUCKETS];
+static DECLARE_BITMAP(lowmem_bucket_map, LOWMEM_ADJ_BUCKETS);
+
+static struct lowmem_task *lowmem_task_find(struct task_struct *tsk)
+{
+	struct lowmem_task *lt;
+
+	hash_for_each_possible(lowmem_task_hash, lt, node, (unsigned long)tsk)
+		if (lt->tsk == tsk)
+			return lt;
+	return NULL;
+}
+
+static void lowmem_bucket_del(struct lowmem_task *lt)
+{
+	list_del(&lt->bucket);
+	if (list_empty(&lowmem_buckets[lt->adj]))
+		clear_bit(lt->adj, lowmem_bucket_map);
+}
+
+static void lowmem_task_remove(struct lowmem_task *lt)
+{
+	lowmem_bucket_del(lt);
+	hash_del(&lt->node);
+	put_task_struct(lt->tsk);
+	kfree(lt);
+}
+
+static void lowmem_adj_update(void *data, struct task_struct *task)
+{
+	struct task_struct *tsk = task->group_leader;
+	short adj = task->signal->oom_score_adj;
+	struct lowmem_task *lt;
+	unsigned long flags;
+
+	spin_lock_irqsave(&lowmem_task_lock, flags);
+	lt = lowmem_task_find(tsk);
+	if (adj < 0 || (tsk->flags & PF_EXITING)) {
+		if (lt)
+			lowmem_task_remove(lt);
+		goto out;
+	}
+
+	if (lt) {
+		lowmem_bucket_del(lt);
+	} else {
+		lt = kmalloc(sizeof(*lt), GFP_ATOMIC);
+		if (!lt)
+			goto out;
+		get_task_struct(tsk);
+		lt->tsk = tsk;
+		hash_add(lowmem_task_hash, &lt->node, (unsigned long)tsk);
+	}
+	/* the writer holds task_lock with task->mm checked */
+	lt->rss = task->mm ? get_mm_rss(task->mm) : 0;
+	lt->adj = adj;
+	list_add(&lt->bucket, &lowmem_buckets[adj]);
+	set_bit(adj, lowmem_bucket_map);
+out:
+	spin_unlock_irqrestore(&lowmem_task_lock, flags);
+}
+
+static int lowmem_task_exit(struct notifier_block *nb, unsigned long val,
+			    void *data)
+{
+	struct task_struct *task = data;
+	struct lowmem_task *lt;
+	unsigned long flags;
+
+	if (!thread_group_leader(task))
+		return NOTIFY_OK;
+
+	spin_lock_irqsave(&lowmem_task_lock, flags);
+	lt = lowmem_task_find(task);
+	if (lt)
+		lowmem_task_remove(lt);
+	spin_unlock_irqrestore(&lowmem_task_lock, flags);
+	return NOTIFY_OK;
+}
+
+static struct notifier_block lowmem_task_exit_nb = {
+	.notifier_call = lowmem_task_exit,
+};
+
+/* Referenced leader with the largest cached rss in the top bucket */
+static struct task_struct *lowmem_bucket_select(short min_score_adj)
+{
+	struct task_struct *tsk = NULL;
+	struct lowmem_task *lt, *tmp, *best;
+	unsigned long flags;
+	unsigned long adj;
+
+	spin_lock_irqsave(&lowmem_task_lock, flags);
+	while ((adj = find_last_bit(lowmem_bucket_map, LOWMEM_ADJ_BUCKETS)) <
+	       LOWMEM_ADJ_BUCKETS && adj >= min_score_adj) {
+		best = NULL;
+		list_for_each_entry_safe(lt, tmp, &lowmem_buckets[adj],
+					 bucket) {
+			if (lt->tsk->flags & PF_EXITING) {
+				lowmem_task_remove(lt);
+				continue;
+			}
+			if (!best || lt->rss > best->rss)
+				best = lt;
+		}
+		if (best) {
+			tsk = best->tsk;
+			get_task_struct(tsk);
+			break;
+		}
+	}
+	spin_unlock_irqrestore(&lowmem_task_lock, flags);
+	return tsk;
+}
+
+/**
+ * lowmem_bucket_pick() - select a victim from the adj buckets
+ * @min_score_adj: lowest oom_score_adj that may be killed
+ * @tasksize:      returns the rss of the victim
+ * @oom_score_adj: returns the oom_score_adj of the victim
+ * @dying:         set if the pick is still dying from the last kill
+ *
+ * Called under rcu_read_lock(). Returns NULL when the caller has to
+ * walk every process instead.
+ */
+static struct task_struct *lowmem_bucket_pick(short min_score_adj,
+					      int *tasksize,
+					      short *oom_score_adj,
+					      bool *dying)
+{
+	struct task_struct *tsk, *p;
+	struct task_struct *selected = NULL;
+
+	if (min_score_adj < 0)
+		return NULL;
+
+	tsk = lowmem_bucket_select(min_score_adj);
+	if (!tsk)
+		return NULL;
+
+	p = find_lock_task_mm(tsk);
+	if (!p)
+		goto out;
+
+	if (test_tsk_thread_flag(p, TIF_MEMDIE) &&
+	    time_before_eq(jiffies, lowmem_deathpending_timeout)) {
+		*dying = true;
+	} else if (p->signal->oom_score_adj >= min_score_adj) {
+		*oom_score_adj = p->signal->oom_score_adj;
+		*tasksize = get_mm_rss(p->mm);
+		if (*tasksize > 0)
+			selected = p;
+	}
+	task_unlock(p);
+	if (selected)
+		lowmem_print(2, "select '%s' (%d), adj %hd, size %d, to kill\n",
+			     p->comm, p->pid, *oom_score_adj, *tasksize);
+out:
+	put_task_struct(tsk);
+	return selected;
+}
+
+static void lowmem_buckets_init(void)
+{
+	int i;
+
+	for (i = 0; i < LOWMEM_ADJ_BUCKETS; i++)
+		INIT_LIST_HEAD(&lowmem_buckets[i]);
+	if (register_trace_oom_score_adj_update(lowmem_adj_update, NULL))
+		pr_err("failed to register adj update probe\n");
+	profile_event_register(PROFILE_TASK_EXIT, &lowmem_task_exit_nb);
+}
+#else
+static inline struct task_struct *lowmem_bucket_pick(short min_score_adj,
+						     int *tasksize,
+						     short *oom_score_adj,
+						     bool *dying)
+{
+	return NULL;
+}
+
+static inline void lowmem_buckets_init(void)
+{
+}
+#endif
+
 static unsigned long lowmem_scan(struct shrinker *s, struct shrink_control *sc)
 {
 	struct task_struct *tsk;
@@ -228,6 +576,7 @@ static unsigned long lowmem_scan(struct shrinker *s, struct shrink_control *sc)
 	int minfree = 0;
 	int selected_tasksize = 0;
 	short selected_oom_score_adj;
+	bool dying = false;
 	int array_size = ARRAY_SIZE(lowmem_adj);
 	int other_free = global_page_state(NR_FREE_PAGES) - totalreserve_pages;
 	int other_file = global_page_state(NR_FILE_PAGES) -
@@ -246,6 +595,7 @@ static unsigned long lowmem_scan(struct shrinker *s, struct shrink_control *sc)
 			break;
 		}
 	}
+	min_score_adj = lowmem_stall_adj(min_score_adj, array_size);
 
 	lowmem_print(3, "lowmem_scan %lu, %x, ofree %d %d, ma %hd\n",
 			sc->nr_to_scan, sc->gfp_mask, other_free,
@@ -260,6 +610,15 @@ static unsigned long lowmem_scan(struct shrinker *s, struct shrink_control *sc)
 	selected_oom_score_adj = min_score_adj;
 
 	rcu_read_lock();
+	selected = lowmem_bucket_pick(min_score_adj, &selected_tasksize,
+				      &selected_oom_score_adj, &dying);
+	if (dying) {
+		rcu_read_unlock();
+		return 0;
+	}
+	if (selected)
+		goto kill;
+
 	for_each_process(tsk) {
 		struct task_struct *p;
 		short oom_score_adj;
@@ -299,6 +658,7 @@ static unsigned long lowmem_scan(struct shrinker *s, struct shrink_control *sc)
 		lowmem_print(2, "select '%s' (%d), adj %hd, size %d, to kill\n",
 			     p->comm, p->pid, oom_score_adj, tasksize);
 	}
+kill:
 	if (selected) {
 		long cache_size = other_file * (long)(PAGE_SIZE / 1024);
 		long cache_limit = minfree * (long)(PAGE_SIZE / 1024);
@@ -350,6 +710,7 @@ static struct shrinker lowmem_shrinker = {
 
 static int __init lowmem_init(void)
 {
+	lowmem_buckets_init();
 	register_shrinker(&lowmem_shrinker);
 	lmk_event_init();
 	return 0;
@@ -450,4 +811,10 @@ module_param_array_named(adj, lowmem_adj, short, &lowmem_adj_size,
 module_param_array_named(minfree, lowmem_minfree, uint, &lowmem_minfree_size,
 			 S_IRUGO | S_IWUSR);
 module_param_named(debug_level, lowmem_debug_level, uint, S_IRUGO | S_IWUSR);
+#ifdef CONFIG_ANDROID_LOW_MEMORY_KILLER_STALL
+module_param_named(stall_window_ms, lowmem_stall_window_ms, uint,
+		   S_IRUGO | S_IWUSR);
+module_param_named(stall_threshold_ms, lowmem_stall_threshold_ms, uint,
+		   S_IRUGO | S_IWUSR);
+#endif
 
@@ -174,6 +174,23 @@ struct ion_preload_data {
 	struct ion_preload_object *obj;
 };
 
+/**
+ * struct ion_prereclaim_data - hint for the rbin heap pre-reclaimer
+ * @len:		bytes that will be allocated from the rbin heap soon
+ * @timeout_ms:		give up reclaiming after this long, 0 for no limit
+ * @fd:			returned file descriptor reporting the progress
+ *
+ * The returned fd becomes readable (POLLIN) once the request is done,
+ * because @len bytes are in the heap pools, the deadline passed or the
+ * region ran out of memory. read() returns the bytes reclaimed so far
+ * for this request as a __u64.
+ */
+struct ion_prereclaim_data {
+	__u64 len;
+	__u32 timeout_ms;
+	__s32 fd;
+};
+
 #define ION_IOC_MAGIC		'I'
 
 /**
@@ -238,6 +255,16 @@ struct ion_preload_data {
  */
 #define ION_IOC_PRELOAD_ALLOC	_IOW(ION_IOC_MAGIC, 8, struct ion_preload_data)
 
+/**
+ * DOC: ION_IOC_PRERECLAIM - start reclaiming the rbin region ahead of use
+ *
+ * Takes an ion_prereclaim_data struct and returns it with the fd field
+ * set. Used e.g. when the camera is opening to overlap the reclaim of
+ * its buffers with HAL initialisation.
+ */
+#define ION_IOC_PRERECLAIM	_IOWR(ION_IOC_MAGIC, 10, \
+				      struct ion_prereclaim_data)
+
 /**
  * DOC: ION_IOC_CUSTOM - call architecture specific ion ioctl
  *
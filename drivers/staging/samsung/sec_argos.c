@@ -25,12 +25,19 @@
 #include <linux/list.h>
 #include <linux/cpumask.h>
 #include <linux/interrupt.h>
+#include <linux/average.h>
 #include <linux/sec_argos.h>
 
 #define ARGOS_NAME "argos"
 #define TYPE_SHIFT 4
 #define TYPE_MASK_BIT ((1 << TYPE_SHIFT) - 1)
 
+/* default margin, in percent of a level's threshold, to step down from it */
+#define ARGOS_DEFAULT_HYSTERESIS 10
+
+/* throughput estimate, each update weighs 1/4 */
+DECLARE_EWMA(argos_rate, 16, 4)
+
 static DEFINE_SPINLOCK(argos_irq_lock);
 static DEFINE_SPINLOCK(argos_task_lock);
 
@@ -82,6 +89,8 @@ struct argos {
 	struct boost_table *tables;
 	int ntables;
 	int prev_level;
+	/* percent below a level's threshold needed to leave that level */
+	unsigned int hysteresis;
 	struct argos_pm_qos *qos;
 	struct list_head task_affinity_list;
 	bool task_hotplug_disable;
@@ -90,6 +99,9 @@ struct argos {
 	bool hmpboost_enable;
 	bool argos_block;
 	struct blocking_notifier_head argos_notifier;
+	/* smoothed speed in Mbps, and who wants to hear every update of it */
+	struct ewma_argos_rate rate;
+	struct blocking_notifier_head rate_notifier;
 	/* protect prev_level, qos, task/irq_hotplug_disable, hmpboost_enable */
 	struct mutex level_mutex;
 };
@@ -184,6 +196,61 @@ int sec_argos_unregister_notifier(struct notifier_block *n, char *label)
 }
 EXPORT_SYMBOL(sec_argos_unregister_notifier);
 
+/*
+ * Rate notifiers are called on every speed update of the device, with the
+ * smoothed speed in Mbps as the action and the raw speed (unsigned long *)
+ * as the data, so that consumers can scale their own batching gradually
+ * instead of waiting for a boost level change.
+ */
+int sec_argos_register_rate_notifier(struct notifier_block *n, char *label)
+{
+	int dev_num;
+
+	dev_num = argos_find_index(label);
+
+	if (dev_num < 0) {
+		pr_err("%s: No match found for label: %d", __func__, dev_num);
+		return -ENODEV;
+	}
+
+	pr_info("%s: %pf(dev_num:%d)\n", __func__, n->notifier_call, dev_num);
+
+	return blocking_notifier_chain_register(
+			&argos_pdata->devices[dev_num].rate_notifier, n);
+}
+EXPORT_SYMBOL(sec_argos_register_rate_notifier);
+
+int sec_argos_unregister_rate_notifier(struct notifier_block *n, char *label)
+{
+	int dev_num;
+
+	dev_num = argos_find_index(label);
+
+	if (dev_num < 0) {
+		pr_err("%s: No match found for label: %d", __func__, dev_num);
+		return -ENODEV;
+	}
+
+	pr_info("%s: %pf(dev_num:%d)\n", __func__, n->notifier_call, dev_num);
+
+	return blocking_notifier_chain_unregister(
+			&argos_pdata->devices[dev_num].rate_notifier, n);
+}
+EXPORT_SYMBOL(sec_argos_unregister_rate_notifier);
+
+/* Smoothed speed of the device in Mbps, or 0 if there is no such device */
+unsigned long sec_argos_get_rate(char *label)
+{
+	int dev_num;
+
+	dev_num = argos_find_index(label);
+	if (dev_num < 0)
+		return 0;
+
+	return ewma_argos_rate_read(&argos_pdata->devices[dev_num].rate);
+}
+EXPORT_SYMBOL(sec_argos_get_rate);
+
 static int argos_task_affinity_setup(struct task_struct *p, int dev_num,
 		struct cpumask *affinity_cpu_mask,
 		struct cpumask *default_cpu_mask)
@@ -540,6 +607,11 @@ static int argos_pm_qos_notify(struct notifier_block *nfb,
 
 	pr_debug("%s name:%s, speed:%ldMbps\n", __func__, cnode->desc, speed);
 
+	ewma_argos_rate_add(&cnode->rate, speed);
+	if (cnode->rate_notifier.head)
+		blocking_notifier_call_chain(&cnode->rate_notifier,
+				ewma_argos_rate_read(&cnode->rate), &speed);
+
 	argos_blocked = cnode->argos_block;
 
 	/* Find proper level */
@@ -556,6 +628,17 @@ static int argos_pm_qos_notify(struct notifier_block *nfb,
 
 	/* decrease 1 level to match proper table */
 	level--;
+
+	/*
+	 * Only step down once the speed is clearly below the threshold of
+	 * the level being left, so that traffic hovering around a boundary
+	 * does not flip the locks and affinities on every update.
+	 */
+	while (level < prev_level &&
+	       speed * 100 >= (unsigned long)cnode->tables[level + 1].items[THRESHOLD] *
+				(100 - cnode->hysteresis))
+		level++;
+
 	if (!argos_blocked) {
 		if (level != prev_level) {
 			if (mutex_trylock(&cnode->level_mutex) == 0) {
@@ -643,6 +726,11 @@ static int argos_parse_dt(struct device *dev)
 		}
 		cnode->ntables = num_level;
 
+		if (of_property_read_u32(cnp, "net_boost,hysteresis",
+					&cnode->hysteresis) ||
+				cnode->hysteresis > 100)
+			cnode->hysteresis = ARGOS_DEFAULT_HYSTERESIS;
+
 		/* Allocation for freq and time table */
 		if (!cnode->tables) {
 			cnode->tables = devm_kzalloc(dev, sizeof(struct boost_table) * cnode->ntables,
@@ -683,6 +771,8 @@ static int argos_parse_dt(struct device *dev)
 			goto err_out;
 		}
 		BLOCKING_INIT_NOTIFIER_HEAD(&cnode->argos_notifier);
+		BLOCKING_INIT_NOTIFIER_HEAD(&cnode->rate_notifier);
+		ewma_argos_rate_init(&cnode->rate);
 
 		device_count++;
 	}
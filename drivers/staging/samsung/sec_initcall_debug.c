@@ -25,6 +25,10 @@
 #include <linux/list.h>
 #include <linux/module.h>
 #include <linux/slab.h>
+#include <linux/device.h>
+#include <linux/async.h>
+#include <linux/list_sort.h>
+#include <linux/mutex.h>
 
 struct sec_initcall_debug_data {
 	struct list_head list;
@@ -33,9 +37,22 @@ struct sec_initcall_debug_data {
 	bool is_pm;
 };
 
+struct sec_probe_debug_data {
+	struct list_head list;
+	const char *name;
+	unsigned long long duration;
+	unsigned int probes;
+	unsigned int deferrals;
+	bool is_async;
+};
+
 static LIST_HEAD(initcall_list);
 static LIST_HEAD(initcall_sorted_list);
 
+/* probes can run concurrently from async threads */
+static LIST_HEAD(probe_list);
+static DEFINE_MUTEX(probe_lock);
+
 static int time_ms;
 static bool is_sorted;
 
@@ -117,10 +134,123 @@ void sec_initcall_debug_add(initcall_t fn,
 	}
 }
 
+/*
+ * Each device keeps one entry with the total time of all its probe
+ * attempts. Probes that were deferred are kept even if they were quick,
+ * since every retry pushes out the devices that depend on them. Once a
+ * device has an entry, every later attempt is added to it, quick or not.
+ */
+void sec_initcall_debug_add_probe(struct device *dev,
+	struct device_driver *drv, unsigned long long duration, bool deferred)
+{
+	struct sec_probe_debug_data *pdata;
+	const char *name = dev_name(dev);
+	size_t len = strlen(drv->name);
+
+	mutex_lock(&probe_lock);
+	list_for_each_entry(pdata, &probe_list, list) {
+		if (!strncmp(pdata->name, drv->name, len) &&
+				pdata->name[len] == '/' &&
+				!strcmp(pdata->name + len + 1, name))
+			goto found;
+	}
+
+	if (duration < SEC_INITCALL_DEBUG_MIN_TIME && !deferred)
+		goto out;
+
+	pdata = kzalloc(sizeof(struct sec_probe_debug_data), GFP_KERNEL);
+	if (!pdata) {
+		printk(KERN_ERR "probe : failed to allocate\n");
+		goto out;
+	}
+	pdata->name = kasprintf(GFP_KERNEL, "%s/%s", drv->name, name);
+	if (!pdata->name) {
+		kfree(pdata);
+		goto out;
+	}
+	list_add_tail(&pdata->list, &probe_list);
+found:
+	pdata->duration += duration;
+	pdata->probes++;
+	if (deferred)
+		pdata->deferrals++;
+	if (current_is_async())
+		pdata->is_async = true;
+out:
+	mutex_unlock(&probe_lock);
+}
+
+static int sec_probe_debug_cmp(void *priv, struct list_head *a,
+	struct list_head *b)
+{
+	struct sec_probe_debug_data *pa =
+		list_entry(a, struct sec_probe_debug_data, list);
+	struct sec_probe_debug_data *pb =
+		list_entry(b, struct sec_probe_debug_data, list);
+
+	if (pa->duration == pb->duration)
+		return 0;
+	return pa->duration < pb->duration ? 1 : -1;
+}
+
+static int sec_probe_debug_seq_show(struct seq_file *f, void *v)
+{
+	struct sec_probe_debug_data *pdata;
+	unsigned long long sync_total = 0, async_max = 0;
+	unsigned int deferrals = 0;
+
+	mutex_lock(&probe_lock);
+	list_sort(NULL, &probe_list, sec_probe_debug_cmp);
+
+	list_for_each_entry(pdata, &probe_list, list) {
+		if (pdata->is_async)
+			async_max = max(async_max, pdata->duration);
+		else
+			sync_total += pdata->duration;
+		deferrals += pdata->deferrals;
+	}
+
+	/*
+	 * Sync probes run one after another on the init path, async ones
+	 * overlap with it, so the path is at least the sum of the former and
+	 * the longest of the latter.
+	 */
+	seq_printf(f, "sync probe total : %llu, longest async probe : %llu, deferrals : %u\n\n",
+		sync_total, async_max, deferrals);
+	seq_puts(f, "driver/device\t\t\t\t\t\t    time probes defer\n");
+	seq_puts(f, "-------------------------------------------------------------------------\n");
+
+	list_for_each_entry(pdata, &probe_list, list) {
+		if (pdata->duration < time_ms)
+			break;
+		seq_printf(f, "%-50s : %8llu %6u %5u%s\n", pdata->name,
+			pdata->duration, pdata->probes, pdata->deferrals,
+			pdata->is_async ? " async" : "");
+	}
+	mutex_unlock(&probe_lock);
+
+	return 0;
+}
+
+static int sec_probe_debug_open(struct inode *inode, struct file *filp)
+{
+	return single_open(filp, sec_probe_debug_seq_show, NULL);
+}
+
+static const struct file_operations sec_probe_debug_proc_fops = {
+	.open	= sec_probe_debug_open,
+	.read	= seq_read,
+	.llseek	= seq_lseek,
+	.release	= single_release,
+	.write	= sec_initcall_debug_write,
+};
+
 static int __init sec_initcall_debug_init(void)
 {
 	proc_create("initcall_debug", 0, NULL,
 		&sec_initcall_debug_proc_fops);
+	proc_create("probe_debug", 0, NULL,
+		&sec_probe_debug_proc_fops);
 	return 0;
 }
 
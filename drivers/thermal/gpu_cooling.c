@@ -52,6 +52,30 @@ struct power_table {
 	u32 power;
 };
 
+/**
+ * struct power_fit - running least squares fit of power against load
+ * @n:		number of samples
+ * @sx:		sum of the loads, in %
+ * @sy:		sum of the measured powers, in mW
+ * @sxx:	sum of the squared loads
+ * @sxy:	sum of load times power
+ *
+ * One per frequency of the dynamic power table. The slope of the fit,
+ * taken to 100% load, replaces the dynamic power computed from the
+ * capacitance once there are enough samples spread over the load.
+ */
+struct power_fit {
+	u32 n;
+	u64 sx;
+	u64 sy;
+	u64 sxx;
+	u64 sxy;
+};
+
+#define GPU_POWER_FIT_MIN	16	/* samples before the fit is used */
+#define GPU_POWER_FIT_MAX	256	/* the sums are halved past this */
+#define GPU_POWER_FIT_VAR	100	/* minimum load variance, in %^2 */
+
 /**
  * struct gpufreq_cooling_device - data for cooling device with gpufreq
  * @id: unique integer value corresponding to each gpufreq_cooling_device
@@ -75,6 +99,7 @@ struct gpufreq_cooling_device {
 	unsigned int gpufreq_val;
 	u32 last_load;
 	struct power_table *dyn_power_table;
+	struct power_fit *dyn_power_fit;
 	int dyn_power_table_entries;
 	get_static_t plat_get_static_power;
 	int *var_table;
@@ -276,6 +301,13 @@ static int build_dyn_power_table(struct gpufreq_cooling_device *gpufreq_device,
 	if (!power_table)
 		return -ENOMEM;
 
+	gpufreq_device->dyn_power_fit = kcalloc(num_opps,
+			sizeof(*gpufreq_device->dyn_power_fit), GFP_KERNEL);
+	if (!gpufreq_device->dyn_power_fit) {
+		kfree(power_table);
+		return -ENOMEM;
+	}
+
 	for (freq = 0, i = 0; i < num_opps; i++) {
 		u32 voltage_mv;
 		u64 power;
@@ -458,6 +490,121 @@ static u32 gpu_power_to_freq(struct gpufreq_cooling_device *gpufreq_device,
 	return pt[i - 1].frequency;
 }
 
+/**
+ * gpu_power_fit_add() - learn the dynamic power of a frequency from a sample
+ * @gpufreq_device:	struct &gpufreq_cooling_device for this gpu cdev
+ * @freq:	frequency, in the unit of the dynamic power table
+ * @load:	gpu load in %
+ * @power:	measured gpu power in mW
+ *
+ * The capacitance from DT is the same for all silicon, so the power table
+ * built from it can be far off for a given chip. Samples of the measured
+ * power, e.g. from the fuel gauge while only the gpu load changes, are
+ * fitted against the load per frequency. The slope extrapolated to 100%
+ * load becomes the dynamic power of that frequency; the intercept holds
+ * the static and idle part, which keeps coming from the ECT tables. The
+ * learned value is kept between its neighbours so that the table stays
+ * in ascending order for gpu_power_to_freq().
+ *
+ * Must be called with cooling_gpu_lock held.
+ *
+ * Return: 0 on success, -EINVAL if @freq is not in the table.
+ */
+static int gpu_power_fit_add(struct gpufreq_cooling_device *gpufreq_device,
+			     u32 freq, u32 load, u32 power)
+{
+	struct power_table *pt = gpufreq_device->dyn_power_table;
+	int entries = gpufreq_device->dyn_power_table_entries;
+	struct power_fit *fit;
+	s64 n, var, cov, dyn, lo, hi;
+	int i;
+
+	for (i = 0; i < entries; i++)
+		if (pt[i].frequency == freq)
+			break;
+
+	if (i == entries)
+		return -EINVAL;
+
+	fit = &gpufreq_device->dyn_power_fit[i];
+
+	/* age the old samples so that the fit follows temperature and aging */
+	if (fit->n >= GPU_POWER_FIT_MAX) {
+		fit->n >>= 1;
+		fit->sx >>= 1;
+		fit->sy >>= 1;
+		fit->sxx >>= 1;
+		fit->sxy >>= 1;
+	}
+
+	fit->n++;
+	fit->sx += load;
+	fit->sy += power;
+	fit->sxx += load * load;
+	fit->sxy += (u64)load * power;
+
+	if (fit->n < GPU_POWER_FIT_MIN)
+		return 0;
+
+	/* n^2 times the variance of the load, and of the covariance */
+	n = fit->n;
+	var = n * fit->sxx - fit->sx * fit->sx;
+	if (var < n * n * GPU_POWER_FIT_VAR)
+		return 0;
+
+	cov = n * fit->sxy - fit->sx * fit->sy;
+	dyn = div64_s64(cov * 100, var);
+
+	lo = i ? pt[i - 1].power : 0;
+	hi = i + 1 < entries ? pt[i + 1].power : U32_MAX;
+	pt[i].power = (u32)clamp(dyn, lo, max(lo, hi));
+
+	return 0;
+}
+
+static ssize_t power_sample_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count)
+{
+	struct thermal_cooling_device *cdev =
+		container_of(dev, struct thermal_cooling_device, device);
+	struct gpufreq_cooling_device *gpufreq_device = cdev->devdata;
+	u32 freq, load, power;
+	int ret;
+
+	if (sscanf(buf, "%u %u %u", &freq, &load, &power) != 3 || load > 100)
+		return -EINVAL;
+
+	mutex_lock(&cooling_gpu_lock);
+	ret = gpu_power_fit_add(gpufreq_device, freq, load, power);
+	mutex_unlock(&cooling_gpu_lock);
+
+	return ret ? ret : count;
+}
+
+static ssize_t power_model_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct thermal_cooling_device *cdev =
+		container_of(dev, struct thermal_cooling_device, device);
+	struct gpufreq_cooling_device *gpufreq_device = cdev->devdata;
+	struct power_table *pt = gpufreq_device->dyn_power_table;
+	ssize_t len = 0;
+	int i;
+
+	mutex_lock(&cooling_gpu_lock);
+	for (i = 0; i < gpufreq_device->dyn_power_table_entries; i++)
+		len += scnprintf(buf + len, PAGE_SIZE - len, "%u %u %u\n",
+				pt[i].frequency, pt[i].power,
+				gpufreq_device->dyn_power_fit[i].n);
+	mutex_unlock(&cooling_gpu_lock);
+
+	return len;
+}
+
+/* "<freq> <load %> <power mW>" samples in; "<freq> <power mW> <samples>" out */
+static DEVICE_ATTR(power_sample, S_IWUSR, NULL, power_sample_store);
+static DEVICE_ATTR(power_model, S_IRUGO, power_model_show, NULL);
+
 /**
  * get_static_power() - calculate the static power consumed by the gpus
  * @gpufreq_device:	struct &gpufreq_cooling_device for this gpu cdev
@@ -870,6 +1017,13 @@ __gpufreq_cooling_register(struct device_node *np,
 	}
 	gpufreq_dev->cool_dev = cool_dev;
 	gpufreq_dev->gpufreq_state = 0;
+
+	if (capacitance) {
+		if (device_create_file(&cool_dev->device, &dev_attr_power_sample) ||
+		    device_create_file(&cool_dev->device, &dev_attr_power_model))
+			pr_warn("%s: failed to create power model files\n", __func__);
+	}
+
 	mutex_lock(&cooling_gpu_lock);
 
 	gpufreq_dev_count++;
@@ -1007,8 +1161,15 @@ void gpufreq_cooling_unregister(struct thermal_cooling_device *cdev)
 	gpufreq_dev_count--;
 	mutex_unlock(&cooling_gpu_lock);
 
+	if (gpufreq_dev->dyn_power_table) {
+		device_remove_file(&cdev->device, &dev_attr_power_sample);
+		device_remove_file(&cdev->device, &dev_attr_power_model);
+	}
+
 	thermal_cooling_device_unregister(gpufreq_dev->cool_dev);
 	release_idr(&gpufreq_idr, gpufreq_dev->id);
+	kfree(gpufreq_dev->dyn_power_fit);
+	kfree(gpufreq_dev->dyn_power_table);
 	kfree(gpufreq_dev);
 }
 EXPORT_SYMBOL_GPL(gpufreq_cooling_unregister);
@@ -216,7 +216,7 @@ static u32 pid_controller(struct thermal_zone_device *tz,
 				       true);
 	}
 
-	err = (control_temp - tz->temperature) / 1000;
+	err = (control_temp - tz->temperature - tz->temp_lookahead) / 1000;
 	err = int_to_frac(err);
 
 	/* Calculate the proportional term */
@@ -639,7 +639,7 @@ static int power_allocator_throttle(struct thermal_zone_device *tz, int trip)
 
 	ret = tz->ops->get_trip_temp(tz, params->trip_switch_on,
 				     &switch_on_temp);
-	if (!ret && (tz->temperature < switch_on_temp)) {
+	if (!ret && (tz->temperature + tz->temp_lookahead < switch_on_temp)) {
 		tz->passive = 0;
 		reset_pid_controller(params);
 		allow_maximum_power(tz);
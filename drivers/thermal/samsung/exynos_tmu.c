@@ -45,6 +45,7 @@
 #include <linux/cpu.h>
 #include <linux/exynos-cpufreq.h>
 #include <soc/samsung/tmu.h>
+#include <soc/samsung/acpm_ipc_ctrl.h>
 #include <soc/samsung/ect_parser.h>
 #include <soc/samsung/exynos-mcinfo.h>
 #include <dt-bindings/thermal/thermal_exynos.h>
@@ -149,6 +150,17 @@
 #define TOTAL_SENSORS	8
 #define DEFAULT_BALANCE_OFFSET	20
 
+/*
+ * Snapshot of the CURRENT_TEMP registers kept by ACPM in APM SRAM.
+ * seq is bumped after every sample, the words follow in register order.
+ * A plugin that supports it echoes TMU_IPC_SNAPSHOT in its response.
+ */
+#define TMU_SNAPSHOT_SEQ		(0x0)
+#define TMU_SNAPSHOT_TEMP		(0x4)
+#define TMU_SNAPSHOT_SIZE		(TMU_SNAPSHOT_TEMP + 3 * 4)
+#define TMU_SNAPSHOT_DEFAULT_PERIOD	(100)
+#define TMU_IPC_SNAPSHOT		(0x10)
+
 static bool suspended;
 static bool is_cpu_hotplugged_out;
 static DEFINE_MUTEX (thermal_suspend_lock);
@@ -717,6 +729,56 @@ static void exynos8895_tmu_control(struct platform_device *pdev, bool on)
 
 #define MCINFO_LOG_THRESHOLD	(4)
 
+/*
+ * Fit a line through the last readings and project it predict_horizon_ms
+ * ahead. The power allocator then starts capping while the zone is still
+ * below its control temperature, in proportion to how fast it is heating,
+ * instead of reacting once the trip is crossed. Only a rise is projected,
+ * cooling is left to the normal control loop.
+ */
+static void exynos_tmu_predict(struct exynos_tmu_data *data, int temp)
+{
+	s64 now = ktime_to_ms(ktime_get());
+	s64 t_mean = 0, t_dev, num = 0, den = 0;
+	int temp_mean = 0, lead = 0;
+	int i, n;
+
+	data->slope_temp[data->slope_head] = temp;
+	data->slope_time[data->slope_head] = now;
+	data->slope_head = (data->slope_head + 1) % TMU_SLOPE_SAMPLES;
+	if (data->slope_count < TMU_SLOPE_SAMPLES)
+		data->slope_count++;
+
+	n = data->slope_count;
+	if (n < 3)
+		goto out;
+
+	for (i = 0; i < n; i++) {
+		t_mean += data->slope_time[i] - now;
+		temp_mean += data->slope_temp[i];
+	}
+	t_mean = div_s64(t_mean, n);
+	temp_mean /= n;
+
+	for (i = 0; i < n; i++) {
+		t_dev = data->slope_time[i] - now - t_mean;
+		num += t_dev * (data->slope_temp[i] - temp_mean);
+		den += t_dev * t_dev;
+	}
+	if (!den)
+		goto out;
+
+	data->slope = (int)div64_s64(num * MSEC_PER_SEC, den);
+
+	if (data->predict_horizon_ms && data->slope > 0)
+		lead = min_t(s64, div_s64((s64)data->slope *
+				data->predict_horizon_ms, MSEC_PER_SEC),
+				data->predict_max_lead);
+out:
+	if (data->tzd)
+		data->tzd->temp_lookahead = lead;
+}
+
 static int exynos_get_temp(void *p, int *temp)
 {
 	struct exynos_tmu_data *data = p;
@@ -737,6 +799,8 @@ static int exynos_get_temp(void *p, int *temp)
 	else
 		*temp = code_to_temp(data, data->tmu_read(data)) * MCELSIUS;
 
+	exynos_tmu_predict(data, *temp);
+
 	mutex_unlock(&data->lock);
 
 	cdev = data->cool_dev;
@@ -933,6 +997,30 @@ static int exynos8890_tmu_read(struct exynos_tmu_data *data)
 		EXYNOS_TMU_TEMP_MASK;
 }
 
+/*
+ * Read a CURRENT_TEMP word, from the ACPM snapshot while ACPM keeps it
+ * fresh, from the TMU otherwise.
+ */
+static u32 exynos_tmu_read_temp_reg(struct exynos_tmu_data *data, u32 reg_offset)
+{
+	u32 seq;
+
+	if (data->snapshot) {
+		seq = __raw_readl(data->snapshot + TMU_SNAPSHOT_SEQ);
+		if (seq != data->snapshot_seq) {
+			data->snapshot_seq = seq;
+			data->snapshot_stamp = jiffies;
+		}
+
+		if (seq && time_before(jiffies, data->snapshot_stamp +
+				msecs_to_jiffies(3 * data->snapshot_period_ms)))
+			return __raw_readl(data->snapshot + TMU_SNAPSHOT_TEMP +
+					reg_offset);
+	}
+
+	return readl(data->base + EXYNOS_TMU_REG_CURRENT_TEMP1_0 + reg_offset);
+}
+
 static int exynos8895_tmu_read(struct exynos_tmu_data *data)
 {
 	u8 i;
@@ -949,7 +1037,7 @@ static int exynos8895_tmu_read(struct exynos_tmu_data *data)
 			bit_offset = EXYNOS_TMU_TEMP_SHIFT * ((data->sensor_info[i].sensor_num - 2) % 3);
 		}
 
-		temp_code = (readl(data->base + EXYNOS_TMU_REG_CURRENT_TEMP1_0 + reg_offset)
+		temp_code = (exynos_tmu_read_temp_reg(data, reg_offset)
 				>> bit_offset) & EXYNOS_TMU_TEMP_MASK;
 		temp_cel = code_to_temp_with_sensorinfo(data, temp_code, &data->sensor_info[i]);
 
@@ -1194,6 +1282,12 @@ static int exynos_map_dt_data(struct platform_device *pdev)
 
 	data->balance_offset = DEFAULT_BALANCE_OFFSET;
 
+	of_property_read_u32(pdev->dev.of_node, "predict_horizon_ms",
+				&data->predict_horizon_ms);
+	data->predict_max_lead = TMU_DEFAULT_MAX_LEAD;
+	of_property_read_u32(pdev->dev.of_node, "predict_max_lead",
+				&data->predict_max_lead);
+
 	data->hotplug_enable = of_property_read_bool(pdev->dev.of_node, "hotplug_enable");
 	if (data->hotplug_enable) {
 		dev_info(&pdev->dev, "thermal zone use hotplug function \n");
@@ -1681,6 +1775,49 @@ hotplug_in_temp_store(struct device *dev, struct device_attribute *devattr,
 	return count;
 }
 
+static ssize_t
+temp_slope_show(struct device *dev, struct device_attribute *devattr,
+		       char *buf)
+{
+	struct platform_device *pdev = to_platform_device(dev);
+	struct exynos_tmu_data *data = platform_get_drvdata(pdev);
+
+	return snprintf(buf, PAGE_SIZE, "%d %d\n", data->slope,
+			data->tzd ? data->tzd->temp_lookahead : 0);
+}
+
+static ssize_t
+predict_horizon_ms_show(struct device *dev, struct device_attribute *devattr,
+		       char *buf)
+{
+	struct platform_device *pdev = to_platform_device(dev);
+	struct exynos_tmu_data *data = platform_get_drvdata(pdev);
+
+	return snprintf(buf, PAGE_SIZE, "%u\n", data->predict_horizon_ms);
+}
+
+static ssize_t
+predict_horizon_ms_store(struct device *dev, struct device_attribute *devattr,
+			const char *buf, size_t count)
+{
+	struct platform_device *pdev = to_platform_device(dev);
+	struct exynos_tmu_data *data = platform_get_drvdata(pdev);
+	u32 horizon = 0;
+
+	mutex_lock(&data->lock);
+
+	if (kstrtou32(buf, 10, &horizon)) {
+		mutex_unlock(&data->lock);
+		return -EINVAL;
+	}
+
+	data->predict_horizon_ms = horizon;
+
+	mutex_unlock(&data->lock);
+
+	return count;
+}
+
 static DEVICE_ATTR(balance_offset, S_IWUSR | S_IRUGO, balance_offset_show,
 		balance_offset_store);
 
@@ -1692,11 +1829,18 @@ static DEVICE_ATTR(hotplug_out_temp, S_IWUSR | S_IRUGO, hotplug_out_temp_show,
 static DEVICE_ATTR(hotplug_in_temp, S_IWUSR | S_IRUGO, hotplug_in_temp_show,
 		hotplug_in_temp_store);
 
+static DEVICE_ATTR(temp_slope, S_IRUGO, temp_slope_show, NULL);
+
+static DEVICE_ATTR(predict_horizon_ms, S_IWUSR | S_IRUGO,
+		predict_horizon_ms_show, predict_horizon_ms_store);
+
 static struct attribute *exynos_tmu_attrs[] = {
 	&dev_attr_balance_offset.attr,
 	&dev_attr_all_temp.attr,
 	&dev_attr_hotplug_out_temp.attr,
 	&dev_attr_hotplug_in_temp.attr,
+	&dev_attr_temp_slope.attr,
+	&dev_attr_predict_horizon_ms.attr,
 	NULL,
 };
 
@@ -1704,6 +1848,68 @@ static const struct attribute_group exynos_tmu_attr_group = {
 	.attrs = exynos_tmu_attrs,
 };
 
+/*
+ * Ask ACPM to sample all probes of this TMU in its periodic job and keep
+ * the result at acpm_snapshot_base, so that reading the temperature does
+ * not have to touch the TMU. Firmware without the snapshot job does not
+ * echo the request, and the TMU is then read directly as before.
+ */
+static void exynos_tmu_snapshot_init(struct platform_device *pdev)
+{
+	struct exynos_tmu_data *data = platform_get_drvdata(pdev);
+	struct device_node *np = pdev->dev.of_node;
+	struct ipc_config config;
+	unsigned int cmd[4] = {0, };
+	unsigned int ch_num, size;
+	u32 base;
+	int ret;
+
+	if (!IS_ENABLED(CONFIG_EXYNOS_ACPM) ||
+			of_property_read_u32(np, "acpm_snapshot_base", &base))
+		return;
+
+	data->snapshot_period_ms = TMU_SNAPSHOT_DEFAULT_PERIOD;
+	of_property_read_u32(np, "acpm_snapshot_period_ms",
+				&data->snapshot_period_ms);
+
+	ret = acpm_ipc_request_channel(np, NULL, &ch_num, &size);
+	if (ret) {
+		dev_err(&pdev->dev, "No acpm channel for snapshot: %d\n", ret);
+		return;
+	}
+
+	data->snapshot = devm_ioremap(&pdev->dev, base, TMU_SNAPSHOT_SIZE);
+	if (!data->snapshot)
+		return;
+
+	config.cmd = cmd;
+	config.response = true;
+	config.indirection = false;
+	config.cmd[0] = data->id;
+	config.cmd[1] = data->snapshot_period_ms;
+	config.cmd[2] = TMU_IPC_SNAPSHOT;
+	config.cmd[3] = base;
+
+	ret = acpm_ipc_send_data(ch_num, &config);
+	if (ret) {
+		dev_err(&pdev->dev, "Failed to start acpm snapshot: %d\n", ret);
+		goto err_unmap;
+	}
+
+	if (config.cmd[2] != TMU_IPC_SNAPSHOT) {
+		dev_info(&pdev->dev, "acpm snapshot not supported by firmware\n");
+		goto err_unmap;
+	}
+
+	dev_info(&pdev->dev, "acpm snapshot every %ums\n",
+			data->snapshot_period_ms);
+	return;
+
+err_unmap:
+	devm_iounmap(&pdev->dev, data->snapshot);
+	data->snapshot = NULL;
+}
+
 static int exynos_tmu_probe(struct platform_device *pdev)
 {
 	struct exynos_tmu_data *data;
@@ -1792,6 +1998,8 @@ static int exynos_tmu_probe(struct platform_device *pdev)
 
 	exynos_tmu_control(pdev, true);
 
+	exynos_tmu_snapshot_init(pdev);
+
 	ret = sysfs_create_group(&pdev->dev.kobj, &exynos_tmu_attr_group);
 	if (ret)
 		dev_err(&pdev->dev, "cannot create exynos tmu attr group");
@@ -31,6 +31,8 @@
 #define MCELSIUS        1000
 #define DUAL_CPU		(2)
 #define QUAD_CPU		(4)
+#define TMU_SLOPE_SAMPLES	(8)
+#define TMU_DEFAULT_MAX_LEAD	(5 * MCELSIUS)
 
 enum soc_type {
 	SOC_ARCH_EXYNOS8890 = 1,
@@ -128,6 +130,14 @@ struct sensor_info {
  * @num_probe: number of probe for TMU_CONTROL1 SFR setting.
  * @regulator: pointer to the TMU regulator structure.
  * @reg_conf: pointer to structure to register with core thermal.
+ * @slope_temp, @slope_time: last TMU_SLOPE_SAMPLES readings and their time
+ * @slope: least-squares temperature slope in millicelsius per second
+ * @predict_horizon_ms: how far ahead the slope is projected for IPA,
+ *	0 disables prediction
+ * @predict_max_lead: bound of the projected rise in millicelsius
+ * @snapshot: ACPM copy of the CURRENT_TEMP registers, NULL if not used
+ * @snapshot_seq, @snapshot_stamp: last seq seen and when it changed
+ * @snapshot_period_ms: sampling period requested from ACPM
  * @tmu_initialize: SoC specific TMU initialization method
  * @tmu_control: SoC specific TMU control method
  * @tmu_read: SoC specific TMU temperature read method
@@ -160,6 +170,19 @@ struct exynos_tmu_data {
 	struct device_node *np;
 	int balance_offset;
 
+	int slope_temp[TMU_SLOPE_SAMPLES];
+	s64 slope_time[TMU_SLOPE_SAMPLES];
+	int slope_head;
+	int slope_count;
+	int slope;
+	u32 predict_horizon_ms;
+	u32 predict_max_lead;
+
+	void __iomem *snapshot;
+	u32 snapshot_seq;
+	unsigned long snapshot_stamp;
+	u32 snapshot_period_ms;
+
 	int (*tmu_initialize)(struct platform_device *pdev);
 	void (*tmu_control)(struct platform_device *pdev, bool on);
 	int (*tmu_read)(struct exynos_tmu_data *data);
@@ -53,6 +53,8 @@
 #include <linux/kernel.h>
 #include <linux/file.h>
 #include <linux/configfs.h>
+#include <linux/backing-dev.h>
+#include <linux/ktime.h>
 #include "f_mtp.h"
 #include "configfs.h"
 
@@ -100,8 +102,25 @@
 /* number of rx and tx requests to allocate */
 #define MTPG_RX_REQ_MAX				8
 #define MTPG_MTPG_TX_REQ_MAX		8
+#define MTPG_TX_REQS_LIMIT	64
 #define MTPG_INTR_REQ_MAX	5
 
+/* file sends at least this large get a throughput line in the log */
+#define MTPG_XFER_REPORT_MIN	(1 << 20)
+
+/* Bulk-in requests are sized separately so that file sends can keep a
+ * SuperSpeed link busy. A request is one physically contiguous buffer,
+ * which dwc3 maps to a single TRB. Falls back to MTPG_BULK_BUFFER_SIZE
+ * requests if the large buffers cannot be allocated at bind time.
+ */
+static unsigned int mtp_tx_req_len = 262144;
+module_param(mtp_tx_req_len, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(mtp_tx_req_len, "size of each bulk-in request");
+
+static unsigned int mtp_tx_reqs = MTPG_MTPG_TX_REQ_MAX;
+module_param(mtp_tx_reqs, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(mtp_tx_reqs, "number of bulk-in requests, 1 to 64");
+
 /* ID for Microsoft MTP OS String */
 #define MTPG_OS_STRING_ID   0xEE
 
@@ -137,6 +156,8 @@ struct mtpg_dev {
 	int			error;
 	int			read_ready;
 	struct list_head	tx_idle;
+	unsigned int		tx_req_len;
+	unsigned int		tx_reqs;
 	struct list_head	rx_idle;
 	struct list_head	rx_done;
 	struct list_head	intr_idle;
@@ -808,8 +829,8 @@ static ssize_t mtpg_write(struct file *fp, const char __user *buf,
 		}
 
 		if (req != 0) {
-			if (count > MTPG_BULK_BUFFER_SIZE)
-				xfer = MTPG_BULK_BUFFER_SIZE;
+			if (count > dev->tx_req_len)
+				xfer = dev->tx_req_len;
 			else
 				xfer = count;
 
@@ -905,6 +926,39 @@ static void mtp_complete_ep0_transection(struct usb_ep *ep, struct usb_request *
 	}
 }
 
+/*
+ * Open up readahead on the file being sent, as POSIX_FADV_SEQUENTIAL
+ * does, so that the page cache is filled while the queued bulk-in
+ * requests drain and vfs_read() rarely has to wait on the disk.
+ */
+static void mtpg_file_readahead(struct file *file)
+{
+	struct address_space *mapping = file->f_mapping;
+
+	if (!mapping || !mapping->a_ops)
+		return;
+
+	file->f_ra.ra_pages = inode_to_bdi(mapping->host)->ra_pages * 2;
+	spin_lock(&file->f_lock);
+	file->f_mode &= ~FMODE_RANDOM;
+	spin_unlock(&file->f_lock);
+}
+
+/* true once every bulk-in request is back on tx_idle */
+static bool mtpg_tx_drained(struct mtpg_dev *dev)
+{
+	struct list_head *pos;
+	unsigned long flags;
+	unsigned int n = 0;
+
+	spin_lock_irqsave(&dev->lock, flags);
+	list_for_each(pos, &dev->tx_idle)
+		n++;
+	spin_unlock_irqrestore(&dev->lock, flags);
+
+	return n == dev->tx_reqs;
+}
+
 static void read_send_work(struct work_struct *work)
 {
 	struct mtpg_dev	*dev = container_of(work, struct mtpg_dev,
@@ -920,6 +974,9 @@ static void read_send_work(struct work_struct *work)
 	int64_t hdr_length = 0;
 	int r = 0;
 	int ZLP_flag = 0;
+	int64_t sent = 0;
+	ktime_t start;
+	s64 elapsed_us;
 
 	/* read our parameters */
 	smp_rmb();
@@ -928,6 +985,9 @@ static void read_send_work(struct work_struct *work)
 	hdr_length = sizeof(struct usb_container_header);
 	count += hdr_length;
 
+	mtpg_file_readahead(file);
+	start = ktime_get();
+
 	printk(KERN_DEBUG "[%s:%d] offset=[%lld]\t leth+hder=[%lld]\n",
 					 __func__, __LINE__, file_pos, count);
 
@@ -967,8 +1027,8 @@ static void read_send_work(struct work_struct *work)
 			break;
 		}
 
-		if (count > MTPG_BULK_BUFFER_SIZE)
-			xfer = MTPG_BULK_BUFFER_SIZE;
+		if (count > dev->tx_req_len)
+			xfer = dev->tx_req_len;
 		else
 			xfer = count;
 
@@ -1002,6 +1062,7 @@ static void read_send_work(struct work_struct *work)
 		}
 
 		count -= xfer;
+		sent += xfer;
 
 		req = 0;
 	}
@@ -1009,6 +1070,17 @@ static void read_send_work(struct work_struct *work)
 	if (req)
 		mtpg_req_put(dev, &dev->tx_idle, req);
 
+	/* the last requests are still on the wire, time until they are done */
+	if (!r && sent >= MTPG_XFER_REPORT_MIN &&
+	    wait_event_interruptible_timeout(dev->write_wq,
+			mtpg_tx_drained(dev) || dev->error, HZ) > 0 &&
+	    !dev->error) {
+		elapsed_us = max_t(s64, ktime_us_delta(ktime_get(), start), 1);
+		printk(KERN_DEBUG "mtp: sent %lld bytes in %lld ms, %lld KB/s\n",
+				sent, div_s64(elapsed_us, 1000),
+				div64_s64(sent * USEC_PER_SEC, elapsed_us) >> 10);
+	}
+
 	DEBUG_MTPB("[%s] \tline = [%d] \t r = [%d]\n", __func__, __LINE__, r);
 
 	dev->read_send_result = r;
@@ -1319,8 +1391,9 @@ static struct usb_request *mtpg_request_new(struct usb_ep *ep, int buffer_size)
 		return NULL;
 	}
 
-	/* now allocate buffers for the requests */
-	req->buf = kmalloc(buffer_size, GFP_KERNEL);
+	/* now allocate buffers for the requests, large tx buffers fall back */
+	req->buf = kmalloc(buffer_size, GFP_KERNEL |
+			   (buffer_size > MTPG_BULK_BUFFER_SIZE ? __GFP_NOWARN : 0));
 	if (!req->buf) {
 		usb_ep_free_request(ep, req);
 		return NULL;
@@ -1403,6 +1476,7 @@ mtpg_function_bind(struct usb_configuration *c, struct usb_function *f)
 	struct mtpg_dev	*mtpg	= mtpg_func_to_dev(f);  
 	struct usb_request	*req;
 	struct usb_ep		*ep;
+	unsigned int		tx_reqs;
 	int			i, id;
 	int			status = 0;
 	
@@ -1470,13 +1544,27 @@ mtpg_function_bind(struct usb_configuration *c, struct usb_function *f)
 		mtpg_req_put(mtpg, &mtpg->rx_idle, req);
 	}
 
-	for (i = 0; i < MTPG_MTPG_TX_REQ_MAX; i++) {
-		req = mtpg_request_new(mtpg->bulk_in, MTPG_BULK_BUFFER_SIZE);
-		if (!req)
-			goto out;
+	mtpg->tx_req_len = max_t(unsigned int, mtp_tx_req_len,
+				 MTPG_BULK_BUFFER_SIZE);
+	tx_reqs = clamp_t(unsigned int, mtp_tx_reqs, 1, MTPG_TX_REQS_LIMIT);
+retry_tx_alloc:
+	for (i = 0; i < tx_reqs; i++) {
+		req = mtpg_request_new(mtpg->bulk_in, mtpg->tx_req_len);
+		if (!req) {
+			if (mtpg->tx_req_len <= MTPG_BULK_BUFFER_SIZE)
+				goto out;
+			printk(KERN_INFO "[%s] %u byte tx requests failed, retry with %d\n",
+				__func__, mtpg->tx_req_len, MTPG_BULK_BUFFER_SIZE);
+			while ((req = mtpg_req_get(mtpg, &mtpg->tx_idle)))
+				mtpg_request_free(req, mtpg->bulk_in);
+			mtpg->tx_req_len = MTPG_BULK_BUFFER_SIZE;
+			tx_reqs = MTPG_MTPG_TX_REQ_MAX;
+			goto retry_tx_alloc;
+		}
 		req->complete = mtpg_complete_in;
 		mtpg_req_put(mtpg, &mtpg->tx_idle, req);
 	}
+	mtpg->tx_reqs = tx_reqs;
 
 	if (gadget_is_dualspeed(cdev->gadget)) {
 
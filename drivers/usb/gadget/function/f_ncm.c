@@ -19,6 +19,8 @@
 #include <linux/device.h>
 #include <linux/etherdevice.h>
 #include <linux/crc32.h>
+#include <linux/hrtimer.h>
+#include <linux/interrupt.h>
 
 #include <linux/usb/cdc.h>
 #ifdef CONFIG_USB_ANDROID_SAMSUNG_COMPOSITE
@@ -66,8 +68,18 @@ struct f_ncm {
 	u32				ndp_sign;
 #ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
 	uint16_t	dgramsize;
-	struct net_device *net;
 #endif
+	struct net_device		*net;
+
+	/* For multi-frame NDP TX */
+	struct sk_buff			*skb_tx_data;
+	struct sk_buff			*skb_tx_ndp;
+	u16				ndp_dgram_count;
+	bool				timer_force_tx;
+	struct tasklet_struct		tx_tasklet;
+	struct hrtimer			task_timer;
+	bool				timer_stopping;
+
 	/*
 	 * for notification, it is accessed from both
 	 * callback and ethernet open/close
@@ -94,13 +106,19 @@ static inline unsigned ncm_bitrate(struct usb_gadget *g)
 /*-------------------------------------------------------------------------*/
 
 /*
- * We cannot group frames so use just the minimal size which ok to put
- * one max-size ethernet frame.
- * If the host can group frames, allow it to do that, 16K is selected,
- * because it's used by default by the current linux host driver
+ * Frames are grouped in both directions, 16K is selected because it's
+ * used by default by the current linux host driver
  */
-#ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
 #define NTB_DEFAULT_IN_SIZE	16384
+#define NTB_OUT_SIZE		16384
+
+/* Allocation for storing the NDP, 32 should suffice for a 16k NTB */
+#define TX_MAX_NUM_DPE		32
+
+/* Delay for the transmit to wait before sending an unfilled NTB frame */
+#define TX_TIMEOUT_NSECS	300000
+
+#ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
 #define NCM_MAX_DGRAM_SIZE	9014
 #define MAX_NDP_DATAGRAMS	1
 #define NTH_NDP_OUT_TOTAL_SIZE	\
@@ -108,17 +126,7 @@ static inline unsigned ncm_bitrate(struct usb_gadget *g)
 		ntb_parameters.wNdpOutAlignment) +	\
 		sizeof(struct usb_cdc_ncm_ndp16) +	\
 		((MAX_NDP_DATAGRAMS)*sizeof(struct usb_cdc_ncm_dpe16)))
-#else
-#define NTB_DEFAULT_IN_SIZE	USB_CDC_NCM_NTB_MIN_IN_SIZE
 #endif
-#define NTB_OUT_SIZE		16384
-
-/*
- * skbs of size less than that will not be aligned
- * to NCM's dwNtbInMaxSize to save bus bandwidth
- */
-
-#define	MAX_TX_NONFIXED		(512 * 3)
 
 #define FORMATS_SUPPORTED	(USB_CDC_NCM_NTB16_SUPPORTED |	\
 				 USB_CDC_NCM_NTB32_SUPPORTED)
@@ -563,8 +571,9 @@ static inline void ncm_reset_values(struct f_ncm *ncm)
 #ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
 	/* Revisit issue for the case of Toyota Head Unit */
 	ncm->dgramsize = NCM_MAX_DGRAM_SIZE;	//ETH_FRAME_LEN
-	ncm->net = NULL;
 #endif
+	ncm->net = NULL;
+	ncm->timer_force_tx = false;
 }
 
 /*
@@ -963,6 +972,26 @@ invalid:
 }
 
 
+/*
+ * Drop a partially built NTB.
+ *
+ * Context: the port is disconnected, nothing can wrap concurrently
+ */
+static void ncm_free_tx_data(struct f_ncm *ncm)
+{
+	hrtimer_try_to_cancel(&ncm->task_timer);
+
+	if (ncm->skb_tx_data) {
+		dev_kfree_skb_any(ncm->skb_tx_data);
+		ncm->skb_tx_data = NULL;
+	}
+	if (ncm->skb_tx_ndp) {
+		dev_kfree_skb_any(ncm->skb_tx_ndp);
+		ncm->skb_tx_ndp = NULL;
+	}
+	ncm->ndp_dgram_count = 0;
+}
+
 static int ncm_set_alt(struct usb_function *f, unsigned intf, unsigned alt)
 {
 	struct f_ncm		*ncm = func_to_ncm(f);
@@ -996,6 +1025,7 @@ static int ncm_set_alt(struct usb_function *f, unsigned intf, unsigned alt)
 		if (ncm->port.in_ep->driver_data) {
 			DBG(cdev, "reset ncm\n");
 			gether_disconnect(&ncm->port);
+			ncm_free_tx_data(ncm);
 			ncm_reset_values(ncm);
 		}
 #ifdef CONFIG_USB_ANDROID_SAMSUNG_COMPOSITE
@@ -1032,8 +1062,8 @@ static int ncm_set_alt(struct usb_function *f, unsigned intf, unsigned alt)
 			net = gether_connect(&ncm->port);
 			if (IS_ERR(net))
 				return PTR_ERR(net);
-#ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
 			ncm->net = net;
+#ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
 			ncm->net->mtu = ncm->dgramsize - ETH_HLEN;
 			printk(KERN_DEBUG "activate ncm setting MTU size (%d)\n", ncm->net->mtu);
 #endif
@@ -1069,131 +1099,212 @@ static int ncm_get_alt(struct usb_function *f, unsigned intf)
 		return 0;
 	return ncm->port.in_ep->driver_data ? 1 : 0;
 }
-static struct sk_buff *ncm_wrap_ntb(struct gether *port,
-				    struct sk_buff *skb)
+
+/*
+ * Close the NTB being built: append the NDP after the datagrams and
+ * fill in the block length and NDP index in the NTH.
+ *
+ * Context: the u_ether port lock is held
+ */
+static struct sk_buff *package_for_tx(struct f_ncm *ncm)
 {
-	struct f_ncm	*ncm = func_to_ncm(&port->func);
-	struct sk_buff	*skb2;
-	int		ncb_len = 0;
-	__le16		*tmp;
-	int		div;
-	int		rem;
-	int		pad;
-	int		ndp_align;
-	int		ndp_pad;
-	unsigned	max_size = ncm->port.fixed_in_len;
 	const struct ndp_parser_opts *opts = ncm->parser_opts;
-	unsigned	crc_len = ncm->is_crc ? sizeof(uint32_t) : 0;
+	const int	ndp_align = le16_to_cpu(ntb_parameters.wNdpInAlignment);
+	const int	dgram_idx_len = 2 * 2 * opts->dgram_item_len;
+	struct sk_buff	*skb = ncm->skb_tx_data;
+	__le16		*tmp;
+	unsigned	ndp_pad;
+	unsigned	ndp_index;
 #ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
+	unsigned	maxpacket;
 	int		force_shortpkt = 0;
 #endif
-	div = le16_to_cpu(ntb_parameters.wNdpInDivisor);
-	rem = le16_to_cpu(ntb_parameters.wNdpInPayloadRemainder);
-	ndp_align = le16_to_cpu(ntb_parameters.wNdpInAlignment);
-
-	ncb_len += opts->nth_size;
-	ndp_pad = ALIGN(ncb_len, ndp_align) - ncb_len;
-	ncb_len += ndp_pad;
-	ncb_len += opts->ndp_size;
-	ncb_len += 2 * 2 * opts->dgram_item_len; /* Datagram entry */
-	ncb_len += 2 * 2 * opts->dgram_item_len; /* Zero datagram entry */
-	pad = ALIGN(ncb_len, div) + rem - ncb_len;
-	ncb_len += pad;
-
-	if (ncb_len + skb->len + crc_len > max_size) {
-		printk(KERN_ERR"usb: %s Dropped skb skblen (%d) \n", __func__, skb->len);
-		dev_kfree_skb_any(skb);
-		return NULL;
-	}
+
+	hrtimer_try_to_cancel(&ncm->task_timer);
+
+	ndp_pad = ALIGN(skb->len, ndp_align) - skb->len;
+	ndp_index = skb->len + ndp_pad;
+
+	/* NDP: header, datagram entries, zero datagram entry */
+	memset(skb_put(skb, ndp_pad), 0, ndp_pad);
+	tmp = (void *)skb_put(skb, ncm->skb_tx_ndp->len);
+	memcpy(tmp, ncm->skb_tx_ndp->data, ncm->skb_tx_ndp->len);
+	tmp += 2;
+	/* wLength */
+	put_unaligned_le16(ncm->skb_tx_ndp->len + dgram_idx_len, tmp);
+	memset(skb_put(skb, dgram_idx_len), 0, dgram_idx_len);
+
 #ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
-	if ((ncb_len + skb->len + crc_len < max_size) && (((ncb_len + skb->len + crc_len) %
-		le16_to_cpu(ncm->port.in_ep->desc->wMaxPacketSize)) == 0)) {
+	maxpacket = le16_to_cpu(ncm->port.in_ep->desc->wMaxPacketSize);
+	if (skb->len < ncm->port.fixed_in_len && (skb->len % maxpacket) == 0) {
 		/* force short packet */
-		printk(KERN_ERR "usb: force short packet %d  \n", ncm->port.in_ep->desc->wMaxPacketSize);
+		memset(skb_put(skb, 1), 0, 1);
 		force_shortpkt = 1;
 	}
 #endif
-	skb2 = skb_copy_expand(skb, ncb_len,
-#ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
-			       force_shortpkt,
-#else
-			       max_size - skb->len - ncb_len - crc_len,
-#endif
-			       GFP_ATOMIC);
-	dev_kfree_skb_any(skb);
-#ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
-	if (!skb2) {
-		printk(KERN_ERR"usb: %s Dropped skb skblen realloc failed (%d) \n", __func__, skb->len);
-		return NULL;
+
+	/* NTH: skip dwSignature, wHeaderLength and wSequence */
+	tmp = (void *)skb->data;
+	tmp += 2 + 1 + 1;
+	put_ncm(&tmp, opts->block_length, skb->len); /* (d)wBlockLength */
+	put_ncm(&tmp, opts->fp_index, ndp_index); /* (d)wFpIndex */
+
+	dev_kfree_skb_any(ncm->skb_tx_ndp);
+	ncm->skb_tx_ndp = NULL;
+	ncm->skb_tx_data = NULL;
+	ncm->ndp_dgram_count = 0;
+
+	return skb;
+}
+
+/*
+ * Frames are gathered into one NTB until it is full, TX_MAX_NUM_DPE
+ * datagrams are queued or TX_TIMEOUT_NSECS passed since the first one,
+ * so the host sees one bulk transfer for a burst of frames.  NULL is
+ * returned while the NTB is still open; the timer flushes it by calling
+ * ndo_start_xmit() with a NULL skb.
+ */
+static struct sk_buff *ncm_wrap_ntb(struct gether *port,
+				    struct sk_buff *skb)
+{
+	struct f_ncm	*ncm = func_to_ncm(&port->func);
+	struct sk_buff	*skb2 = NULL;
+	__le16		*tmp;
+	unsigned	ncb_len;
+	unsigned	dgram_pad;
+	unsigned	dgram_len;
+	unsigned	max_size = ncm->port.fixed_in_len;
+	const struct ndp_parser_opts *opts = ncm->parser_opts;
+	const int	ndp_align = le16_to_cpu(ntb_parameters.wNdpInAlignment);
+	const int	div = le16_to_cpu(ntb_parameters.wNdpInDivisor);
+	const int	rem = le16_to_cpu(ntb_parameters.wNdpInPayloadRemainder);
+	const int	dgram_idx_len = 2 * 2 * opts->dgram_item_len;
+	unsigned	crc_len = ncm->is_crc ? sizeof(uint32_t) : 0;
+
+	if (!skb) {
+		/* Flush requested by the timer */
+		if (ncm->skb_tx_data && ncm->timer_force_tx)
+			skb2 = package_for_tx(ncm);
+		return skb2;
 	}
-#else
-	if (!skb2)
-		return NULL;
-#endif
-	skb = skb2;
 
-	tmp = (void *) skb_push(skb, ncb_len);
-	memset(tmp, 0, ncb_len);
+	dgram_len = skb->len + crc_len;
+
+	/* Close the current NTB if this datagram does not fit any more */
+	if (ncm->skb_tx_data) {
+		ncb_len = ncm->skb_tx_data->len;
+		ncb_len = ALIGN(ncb_len, div) + rem + dgram_len;
+		ncb_len = ALIGN(ncb_len, ndp_align) + ncm->skb_tx_ndp->len +
+			  2 * dgram_idx_len;
+		if (ncm->ndp_dgram_count >= TX_MAX_NUM_DPE ||
+		    ncb_len > max_size)
+			skb2 = package_for_tx(ncm);
+	}
 
-	put_unaligned_le32(opts->nth_sign, tmp); /* dwSignature */
-	tmp += 2;
-	/* wHeaderLength */
-	put_unaligned_le16(opts->nth_size, tmp++);
-	tmp++; /* skip wSequence */
-#ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
-	put_ncm(&tmp, opts->block_length, skb->len + force_shortpkt); /* (d)wBlockLength */
-#else
-	put_ncm(&tmp, opts->block_length, skb->len); /* (d)wBlockLength */
-#endif
-	/* (d)wFpIndex */
-	/* the first pointer is right after the NTH + align */
-	put_ncm(&tmp, opts->fp_index, opts->nth_size + ndp_pad);
+	if (!ncm->skb_tx_data) {
+		ncb_len = ALIGN(opts->nth_size, div) + rem + dgram_len;
+		ncb_len = ALIGN(ncb_len, ndp_align) + opts->ndp_size +
+			  2 * dgram_idx_len;
+		if (ncb_len > max_size) {
+			printk(KERN_ERR"usb: %s Dropped skb skblen (%d) \n",
+			       __func__, skb->len);
+			goto err;
+		}
 
-	tmp = (void *)tmp + ndp_pad;
+		ncm->skb_tx_data = alloc_skb(max_size, GFP_ATOMIC);
+		if (!ncm->skb_tx_data)
+			goto err;
+		ncm->skb_tx_ndp = alloc_skb(opts->ndp_size +
+					    TX_MAX_NUM_DPE * dgram_idx_len,
+					    GFP_ATOMIC);
+		if (!ncm->skb_tx_ndp) {
+			dev_kfree_skb_any(ncm->skb_tx_data);
+			ncm->skb_tx_data = NULL;
+			goto err;
+		}
 
-	/* NDP */
-	put_unaligned_le32(ncm->ndp_sign, tmp); /* dwSignature */
-	tmp += 2;
-	/* wLength */
-	put_unaligned_le16(ncb_len - opts->nth_size - pad, tmp++);
+		/* NTH */
+		tmp = (void *)skb_put(ncm->skb_tx_data, opts->nth_size);
+		memset(tmp, 0, opts->nth_size);
+		put_unaligned_le32(opts->nth_sign, tmp); /* dwSignature */
+		tmp += 2;
+		/* wHeaderLength */
+		put_unaligned_le16(opts->nth_size, tmp);
+
+		/* NDP header, (d)wNextFpIndex stays zero */
+		tmp = (void *)skb_put(ncm->skb_tx_ndp, opts->ndp_size);
+		memset(tmp, 0, opts->ndp_size);
+		put_unaligned_le32(ncm->ndp_sign, tmp); /* dwSignature */
+
+		/* Bound the latency of the first datagram */
+		hrtimer_start(&ncm->task_timer, ktime_set(0, TX_TIMEOUT_NSECS),
+			      HRTIMER_MODE_REL);
+	}
 
-	tmp += opts->reserved1;
-	tmp += opts->next_fp_index; /* skip reserved (d)wNextFpIndex */
-	tmp += opts->reserved2;
+	ncb_len = ncm->skb_tx_data->len;
+	dgram_pad = ALIGN(ncb_len, div) + rem - ncb_len;
+	ncb_len += dgram_pad;
+
+	/* (d)wDatagramIndex[n] and (d)wDatagramLength[n] */
+	tmp = (void *)skb_put(ncm->skb_tx_ndp, dgram_idx_len);
+	put_ncm(&tmp, opts->dgram_item_len, ncb_len);
+	put_ncm(&tmp, opts->dgram_item_len, dgram_len);
+	ncm->ndp_dgram_count++;
+
+	memset(skb_put(ncm->skb_tx_data, dgram_pad), 0, dgram_pad);
+	tmp = (void *)skb_put(ncm->skb_tx_data, skb->len);
+	memcpy(tmp, skb->data, skb->len);
 
 	if (ncm->is_crc) {
 		uint32_t crc;
 
-		crc = ~crc32_le(~0,
-				skb->data + ncb_len,
-				skb->len - ncb_len);
-		put_unaligned_le32(crc, skb->data + skb->len);
-		skb_put(skb, crc_len);
+		crc = ~crc32_le(~0, skb->data, skb->len);
+		put_unaligned_le32(crc, skb_put(ncm->skb_tx_data, crc_len));
 	}
+	dev_kfree_skb_any(skb);
 
-	/* (d)wDatagramIndex[0] */
-	put_ncm(&tmp, opts->dgram_item_len, ncb_len);
-	/* (d)wDatagramLength[0] */
-	put_ncm(&tmp, opts->dgram_item_len, skb->len - ncb_len);
-	/* (d)wDatagramIndex[1] and  (d)wDatagramLength[1] already zeroed */
-
-	/* Incase of Higher MTU size we do not need to expand and zero off the remaining
-	   In packet size to max_size . This saves bandwidth . e.g for 16K In size max mtu is 9k
-	*/
-#ifndef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
-	if (skb->len > MAX_TX_NONFIXED) {
-		memset(skb_put(skb, max_size - skb->len),
-		       0, max_size - skb->len);
-		printk(KERN_DEBUG"usb:%s Expanding the buffer %d \n", __func__, skb->len);
-	}
-#else
-	if (force_shortpkt) {
-		memset(skb_put(skb, force_shortpkt),
-		       0, force_shortpkt);
-		printk(KERN_ERR"usb:%s final Expanding the buffer %d \n", __func__, skb->len);
+	return skb2;
+
+err:
+	if (ncm->net)
+		ncm->net->stats.tx_dropped++;
+	dev_kfree_skb_any(skb);
+	return skb2;
+}
+
+/*
+ * Send the NTB that is still open when the TX timer expires.
+ */
+static void ncm_tx_tasklet(unsigned long data)
+{
+	struct f_ncm		*ncm = (void *)data;
+	struct net_device	*net = ncm->net;
+	struct netdev_queue	*txq;
+
+	if (ncm->timer_stopping || !net || !ncm->skb_tx_data)
+		return;
+
+	txq = netdev_get_tx_queue(net, 0);
+	__netif_tx_lock_bh(txq);
+	if (ncm->skb_tx_data) {
+		ncm->timer_force_tx = true;
+		/* No free request; retry, the NTB must not wait for traffic */
+		if (net->netdev_ops->ndo_start_xmit(NULL, net) ==
+		    NETDEV_TX_BUSY)
+			hrtimer_start(&ncm->task_timer,
+				      ktime_set(0, TX_TIMEOUT_NSECS),
+				      HRTIMER_MODE_REL);
+		ncm->timer_force_tx = false;
 	}
-#endif
-	return skb;
+	__netif_tx_unlock_bh(txq);
+}
+
+static enum hrtimer_restart ncm_tx_timeout(struct hrtimer *data)
+{
+	struct f_ncm *ncm = container_of(data, struct f_ncm, task_timer);
+
+	tasklet_schedule(&ncm->tx_tasklet);
+	return HRTIMER_NORESTART;
 }
 
 static int ncm_unwrap_ntb(struct gether *port,
@@ -1340,6 +1451,7 @@ static void ncm_disable(struct usb_function *f)
 
 	if (ncm->port.in_ep->driver_data)
 		gether_disconnect(&ncm->port);
+	ncm_free_tx_data(ncm);
 
 	if (ncm->notify->driver_data) {
 		usb_ep_disable(ncm->notify);
@@ -1441,6 +1553,7 @@ ncm_bind(struct usb_configuration *c, struct usb_function *f)
 	}
 	/* need to clear local value */
 	ncm_reset_values(ncm);
+	ncm->timer_stopping = false;
 
 	/* export host's Ethernet address in CDC format */
 	status = gether_get_host_addr_cdc(ncm_opts->net, ncm->ethaddr,
@@ -1818,6 +1931,11 @@ static void ncm_unbind(struct usb_configuration *c, struct usb_function *f)
 #endif
 	DBG(c->cdev, "ncm unbind\n");
 
+	ncm->timer_stopping = true;
+	hrtimer_cancel(&ncm->task_timer);
+	tasklet_kill(&ncm->tx_tasklet);
+	ncm_free_tx_data(ncm);
+
 	ncm_string_defs[0].id = 0;
 	usb_free_all_descriptors(f);
 
@@ -1853,6 +1971,9 @@ static struct usb_function *ncm_alloc(struct usb_function_instance *fi)
 	ncm_string_defs[STRING_MAC_IDX].s = ncm->ethaddr;
 
 	spin_lock_init(&ncm->lock);
+	hrtimer_init(&ncm->task_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	ncm->task_timer.function = ncm_tx_timeout;
+	tasklet_init(&ncm->tx_tasklet, ncm_tx_tasklet, (unsigned long)ncm);
 	ncm_reset_values(ncm);
 	mutex_unlock(&opts->lock);
 	ncm->port.is_fixed = true;
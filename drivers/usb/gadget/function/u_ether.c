@@ -115,11 +115,15 @@ struct eth_dev {
 
 #define DEFAULT_QLEN	2	/* double buffering by default */
 
-/* for dual-speed hardware, use deeper queues at high/super speed */
+/* for dual-speed hardware, use deeper queues at high/super speed;
+ * super speed drains a high speed sized queue in well under a jiffy,
+ * so give it twice the depth to keep the UDC busy between completions
+ */
 static inline int qlen(struct usb_gadget *gadget, unsigned qmult)
 {
-	if (gadget_is_dualspeed(gadget) && (gadget->speed == USB_SPEED_HIGH ||
-					    gadget->speed >= USB_SPEED_SUPER))
+	if (gadget_is_dualspeed(gadget) && gadget->speed >= USB_SPEED_SUPER)
+		return qmult * DEFAULT_QLEN * 2;
+	else if (gadget_is_dualspeed(gadget) && gadget->speed == USB_SPEED_HIGH)
 		return qmult * DEFAULT_QLEN;
 	else
 		return DEFAULT_QLEN;
@@ -221,7 +221,8 @@ static void dpu_bts_share_bw_info(int id)
 	}
 }
 
-void dpu_bts_calc_bw(struct decon_device *decon, struct decon_reg_data *regs)
+static void dpu_bts_fill_info(struct decon_device *decon,
+		struct decon_reg_data *regs, struct bts_decon_info *info)
 {
 	struct decon_win_config *config = regs->dpp_config;
 	struct bts_decon_info bts_info;
@@ -256,6 +257,16 @@ void dpu_bts_calc_bw(struct decon_device *decon, struct decon_reg_data *regs)
 	bts_info.vclk = decon->bts.resol_clk;
 	bts_info.lcd_w = decon->lcd_info->xres;
 	bts_info.lcd_h = decon->lcd_info->yres;
+
+	*info = bts_info;
+}
+
+void dpu_bts_calc_bw(struct decon_device *decon, struct decon_reg_data *regs)
+{
+	struct bts_decon_info bts_info;
+	int i;
+
+	dpu_bts_fill_info(decon, regs, &bts_info);
 	decon->bts.total_bw = bts_calc_bw(decon->bts.type, &bts_info);
 
 	for (i = 0; i < BTS_DPP_MAX; ++i) {
@@ -272,6 +283,23 @@ void dpu_bts_calc_bw(struct decon_device *decon, struct decon_reg_data *regs)
 	dpu_bts_share_bw_info(decon->id);
 }
 
+/*
+ * Announce the bandwidth of a frame accepted from user space. The frame is
+ * applied later by the update worker, when bts_update_bw() realizes it.
+ */
+void dpu_bts_plan_bw(struct decon_device *decon, struct decon_reg_data *regs)
+{
+	struct bts_decon_info bts_info;
+	struct bts_bw bw = { 0, };
+
+	dpu_bts_fill_info(decon, regs, &bts_info);
+	bw.read = bts_calc_bw(decon->bts.type, &bts_info);
+
+	DPU_DEBUG_BTS("DECON%d planned bandwidth = %d\n", decon->id, bw.read);
+
+	bts_plan_bw(decon->bts.type, bw);
+}
+
 void dpu_bts_update_bw(struct decon_device *decon, struct decon_reg_data *regs,
 		u32 is_after)
 {
@@ -441,6 +469,7 @@ void dpu_bts_deinit(struct decon_device *decon)
 struct decon_bts_ops decon_bts_control = {
 	.bts_init		= dpu_bts_init,
 	.bts_calc_bw		= dpu_bts_calc_bw,
+	.bts_plan_bw		= dpu_bts_plan_bw,
 	.bts_update_bw		= dpu_bts_update_bw,
 	.bts_release_bw		= dpu_bts_release_bw,
 	.bts_update_qos_mif	= dpu_bts_update_qos_mif,
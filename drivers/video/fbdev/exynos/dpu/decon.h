@@ -656,6 +656,7 @@ struct decon_dma_buf_data {
 	struct sg_table			*sg_table;
 	dma_addr_t			dma_addr;
 	struct sync_fence		*fence;
+	enum dma_data_direction		dir;
 };
 
 struct decon_win_rect {
@@ -1059,6 +1060,9 @@ struct decon_hiber {
 	void __iomem *cam_status;
 };
 
+/* number of frames of damage the partial update decision looks back on */
+#define WIN_UP_HISTORY		8
+
 struct decon_win_update {
 	bool enabled;
 	u32 rect_w;
@@ -1067,11 +1071,21 @@ struct decon_win_update {
 	u32 verti_cnt;
 	/* previous update region */
 	struct decon_rect prev_up_region;
+	/* damage regions of the recent frames */
+	struct decon_rect hist[WIN_UP_HISTORY];
+	u32 hist_idx;
+	u32 hist_cnt;
+	/* statistics of the decision */
+	u64 partial_frames;
+	u64 full_frames;
+	u64 reconfig_cnt;
+	u64 saved_bytes;
 };
 
 struct decon_bts_ops {
 	void (*bts_init)(struct decon_device *decon);
 	void (*bts_calc_bw)(struct decon_device *decon, struct decon_reg_data *regs);
+	void (*bts_plan_bw)(struct decon_device *decon, struct decon_reg_data *regs);
 	void (*bts_update_bw)(struct decon_device *decon, struct decon_reg_data *regs,
 			u32 is_after);
 	void (*bts_release_bw)(struct decon_device *decon);
@@ -1407,6 +1421,8 @@ void dpu_set_win_update_config(struct decon_device *decon,
 		struct decon_reg_data *regs);
 void dpu_set_win_update_partial_size(struct decon_device *decon,
 		struct decon_rect *up_region);
+int dpu_create_win_update_stat(struct decon_device *decon);
+void dpu_destroy_win_update_stat(struct decon_device *decon);
 
 /* internal only function API */
 int decon_check_var(struct fb_var_screeninfo *var, struct fb_info *info);
@@ -1609,6 +1625,8 @@ int decon_create_fence(struct decon_device *decon,
 		struct sync_fence **fence, struct decon_reg_data *regs);
 void decon_install_fence(struct sync_fence *fence, int fd);
 int decon_wait_fence(struct sync_fence *fence);
+unsigned long decon_wait_fences(struct decon_device *decon,
+		struct decon_reg_data *regs);
 void decon_fence_err_log(struct decon_device *decon, int idx, struct sync_fence *fence);
 int decon_print_fence_err(struct decon_device *decon, struct seq_file *s);
 void decon_signal_fence(struct decon_device *decon);
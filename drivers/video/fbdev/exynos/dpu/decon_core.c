@@ -31,6 +31,7 @@
 #include <linux/debugfs.h>
 #include <linux/pinctrl/consumer.h>
 #include <linux/reboot.h>
+#include <linux/videodev2_exynos_media.h>
 #include <video/mipi_display.h>
 #include <media/v4l2-subdev.h>
 #include <soc/samsung/cal-if.h>
@@ -458,8 +459,7 @@ static void decon_free_dma_buf(struct decon_device *decon,
 
 	ion_iovmm_unmap(dma->attachment, dma->dma_addr);
 
-	dma_buf_unmap_attachment(dma->attachment, dma->sg_table,
-			DMA_TO_DEVICE);
+	dma_buf_unmap_attachment(dma->attachment, dma->sg_table, dma->dir);
 
 	dma_buf_detach(dma->dma_buf, dma->attachment);
 	dma_buf_put(dma->dma_buf);
@@ -1204,10 +1204,12 @@ int decon_set_vsync_int(struct fb_info *info, bool active)
 
 static unsigned int decon_map_ion_handle(struct decon_device *decon,
 		struct device *dev, struct decon_dma_buf_data *dma,
-		struct ion_handle *ion_handle, struct dma_buf *buf, int win_no)
+		struct ion_handle *ion_handle, struct dma_buf *buf, int win_no,
+		enum dma_data_direction dir)
 {
 	dma->fence = NULL;
 	dma->dma_buf = buf;
+	dma->dir = dir;
 
 	dma->attachment = dma_buf_attach(dma->dma_buf, dev);
 	if (IS_ERR_OR_NULL(dma->attachment)) {
@@ -1216,8 +1218,7 @@ static unsigned int decon_map_ion_handle(struct decon_device *decon,
 		goto err_buf_map_attach;
 	}
 
-	dma->sg_table = dma_buf_map_attachment(dma->attachment,
-			DMA_TO_DEVICE);
+	dma->sg_table = dma_buf_map_attachment(dma->attachment, dir);
 	if (IS_ERR_OR_NULL(dma->sg_table)) {
 		decon_err("dma_buf_map_attachment() failed: %ld\n",
 				PTR_ERR(dma->sg_table));
@@ -1226,22 +1227,21 @@ static unsigned int decon_map_ion_handle(struct decon_device *decon,
 
 	/* This is DVA(Device Virtual Address) for setting base address SFR */
 	dma->dma_addr = ion_iovmm_map(dma->attachment, 0,
-			dma->dma_buf->size, DMA_TO_DEVICE, 0);
+			dma->dma_buf->size, dir, 0);
 	if (!dma->dma_addr || IS_ERR_VALUE(dma->dma_addr)) {
 		decon_err("iovmm_map() failed: %pa\n", &dma->dma_addr);
 		goto err_iovmm_map;
 	}
 
 	exynos_ion_sync_dmabuf_for_device(dev, dma->dma_buf,
-		dma->dma_buf->size, DMA_TO_DEVICE);
+		dma->dma_buf->size, dir);
 
 	dma->ion_handle = ion_handle;
 
 	return dma->dma_buf->size;
 
 err_iovmm_map:
-	dma_buf_unmap_attachment(dma->attachment,
-		dma->sg_table, DMA_TO_DEVICE);
+	dma_buf_unmap_attachment(dma->attachment, dma->sg_table, dir);
 err_buf_map_attachment:
 	dma_buf_detach(dma->dma_buf, dma->attachment);
 err_buf_map_attach:
@@ -1256,6 +1256,7 @@ static int decon_import_buffer(struct decon_device *decon, int idx,
 	struct dma_buf *buf;
 	struct decon_dma_buf_data dma_buf_data[MAX_PLANE_CNT];
 	struct dpp_device *dpp;
+	enum dma_data_direction dir;
 	int ret = 0, i;
 	size_t buf_size = 0;
 
@@ -1263,6 +1264,9 @@ static int decon_import_buffer(struct decon_device *decon, int idx,
 
 	DPU_EVENT_LOG(DPU_EVT_WB_SET_BUFFER, &decon->sd, ktime_set(0, 0));
 
+	/* the writeback target is written by the device, e.g. an encoder input */
+	dir = (idx == MAX_DECON_WIN) ? DMA_FROM_DEVICE : DMA_TO_DEVICE;
+
 	regs->plane_cnt[idx] = dpu_get_plane_cnt(config->format);
 	for (i = 0; i < regs->plane_cnt[idx]; ++i) {
 		handle = ion_import_dma_buf(decon->ion_client, config->fd_idma[i]);
@@ -1282,7 +1286,7 @@ static int decon_import_buffer(struct decon_device *decon, int idx,
 		/* idma_type Should be ODMA_WB */
 		dpp = v4l2_get_subdevdata(decon->dpp_sd[config->idma_type]);
 		buf_size = decon_map_ion_handle(decon, dpp->dev,
-				&dma_buf_data[i], handle, buf, idx);
+				&dma_buf_data[i], handle, buf, idx, dir);
 		if (!buf_size) {
 			decon_err("failed to map buffer\n");
 			ret = -ENOMEM;
@@ -1306,6 +1310,80 @@ fail:
 	return ret;
 }
 
+/* Bytes the writeback DMA writes to @plane of a @w x @h frame */
+static size_t decon_wb_plane_size(enum decon_pixel_format format,
+		u32 w, u32 h, int plane)
+{
+	int plane_cnt = dpu_get_plane_cnt(format);
+	size_t luma = (size_t)w * h;
+
+	switch (format) {
+	case DECON_PIXEL_FORMAT_NV12N:
+		return NV12N_Y_SIZE(w, h) + NV12N_CBCR_SIZE(w, h);
+	case DECON_PIXEL_FORMAT_NV12N_10B:
+		return NV12N_Y_SIZE(w, h) + NV12N_10B_Y_2B_SIZE(w, h) +
+			NV12N_CBCR_SIZE(w, h) + NV12N_10B_CBCR_2B_SIZE(w, h);
+	default:
+		break;
+	}
+
+	if (plane_cnt == 1)
+		return luma * dpu_get_bpp(format) / 8;
+
+	/* Y plane first, then the chroma split evenly over the other planes */
+	if (plane == 0)
+		return luma;
+
+	return luma * (dpu_get_bpp(format) - 8) / 8 / (plane_cnt - 1);
+}
+
+/*
+ * Imports the writeback target. It is usually an encoder input buffer
+ * (NV12/NV12N from MFC) shared through ION, so the frame goes to the
+ * encoder without a GPU copy. fence_fd is the release fence of the
+ * encoder: the writeback must not start while it still reads the buffer.
+ */
+static int decon_import_wb_buffer(struct decon_device *decon,
+		struct decon_win_config *config, struct decon_reg_data *regs)
+{
+	struct decon_dma_buf_data *dma = regs->dma_buf_data[MAX_DECON_WIN];
+	size_t size;
+	int ret, i;
+
+	regs->protection[MAX_DECON_WIN] = config->protection;
+	ret = decon_import_buffer(decon, MAX_DECON_WIN, config, regs);
+	if (ret)
+		return ret;
+
+	/* a too small target would fault the SysMMU of the writeback DMA */
+	for (i = 0; i < regs->plane_cnt[MAX_DECON_WIN]; ++i) {
+		size = decon_wb_plane_size(config->format, config->src.f_w,
+				config->src.f_h, i);
+		if (size > dma[i].dma_buf->size) {
+			decon_err("WB buffer%d too small (alloc=%zx : cfg=%zx)\n",
+					i, dma[i].dma_buf->size, size);
+			ret = -EINVAL;
+			goto err;
+		}
+	}
+
+	if (config->fence_fd >= 0) {
+		dma[0].fence = sync_fence_fdget(config->fence_fd);
+		if (!dma[0].fence) {
+			decon_err("failed to import WB fence fd\n");
+			ret = -EINVAL;
+			goto err;
+		}
+	}
+
+	return 0;
+
+err:
+	for (i = 0; i < regs->plane_cnt[MAX_DECON_WIN]; ++i)
+		decon_free_dma_buf(decon, &dma[i]);
+	return ret;
+}
+
 static int decon_check_limitation(struct decon_device *decon, int idx,
 		struct decon_win_config *config)
 {
@@ -2177,6 +2255,7 @@ static void decon_update_regs(struct decon_device *decon,
 	struct panel_state *state = decon->panel_state;
 	int disp_on, video_emul = 0;
 	int i, chk_err;
+	unsigned long fence_err;
 #ifdef CONFIG_LOGGING_BIGDATA_BUG
 	unsigned int bug_err_num;
 #endif
@@ -2190,25 +2269,11 @@ static void decon_update_regs(struct decon_device *decon,
 
 	DPU_EVENT_LOG_FENCE(&decon->sd, regs, DPU_EVT_ACQUIRE_FENCE);
 
-	decon->tracing_mark_write( decon->systrace_pid, 'B', "decon_fence_wait", 0 );
-	for (i = 0; i < decon->dt.max_win; i++) {
-		if (regs->dma_buf_data[i][0].fence) {
-			ret = decon_wait_fence(regs->dma_buf_data[i][0].fence);
-			if (ret < 0) {
-				decon_fence_err_log(decon, i, regs->dma_buf_data[i][0].fence);
-
-				if (regs->dpp_config[i].compression == true) {
-					regs->dpp_config[i].state = DECON_WIN_STATE_DISABLED;
-					regs->num_of_window--;
-					decon_err("[decon%d:w%d:dma%d] disabled (T_win cnt: %d)\n",
-						decon->id, i, regs->dpp_config[i].idma_type,
-						regs->num_of_window);
-				}
-			}
-		}
-	}
-	decon->tracing_mark_write( decon->systrace_pid, 'E', "decon_fence_wait", 0 );
-
+	/*
+	 * The DPP usage and the bandwidth do not depend on the buffer contents,
+	 * so they are prepared while the producers are still rendering and the
+	 * MIF/INT ramp overlaps the fence wait.
+	 */
 	decon_check_used_dpp(decon, regs);
 
 	SYSTRACE_C_BEGIN("decon_bts");
@@ -2217,6 +2282,49 @@ static void decon_update_regs(struct decon_device *decon,
 	decon->bts.ops->bts_update_bw(decon, regs, 0);
 	SYSTRACE_C_FINISH("decon_bts");
 
+	decon->tracing_mark_write( decon->systrace_pid, 'B', "decon_fence_wait", 0 );
+	fence_err = decon_wait_fences(decon, regs);
+	ret = 0;
+	for_each_set_bit(i, &fence_err, decon->dt.max_win) {
+		decon_fence_err_log(decon, i, regs->dma_buf_data[i][0].fence);
+
+		if (regs->dpp_config[i].compression == true) {
+			regs->dpp_config[i].state = DECON_WIN_STATE_DISABLED;
+			regs->num_of_window--;
+			ret = -EINVAL;
+			decon_err("[decon%d:w%d:dma%d] disabled (T_win cnt: %d)\n",
+				decon->id, i, regs->dpp_config[i].idma_type,
+				regs->num_of_window);
+		}
+	}
+	decon->tracing_mark_write( decon->systrace_pid, 'E', "decon_fence_wait", 0 );
+
+	/*
+	 * The encoder may still be reading the WB target, so the frame is not
+	 * written. Its release fence is signaled with an error so that the
+	 * consumer does not take the old contents for a new frame.
+	 */
+	if (decon->dt.out_type == DECON_OUT_WB &&
+			test_bit(MAX_DECON_WIN, &fence_err)) {
+		struct sync_fence *wb_fence =
+			regs->dma_buf_data[MAX_DECON_WIN][0].fence;
+		int status = atomic_read(&wb_fence->status);
+
+		decon_fence_err_log(decon, MAX_DECON_WIN, wb_fence);
+		decon_err("[WB] target fence not signaled, frame skipped\n");
+		if (regs->pt)
+			regs->pt->base.status = status < 0 ? status : -ETIMEDOUT;
+		goto end;
+	}
+
+	/* a window was dropped, the prepared bandwidth is calculated again */
+	if (ret) {
+		SYSTRACE_C_BEGIN("decon_bts");
+		decon->bts.ops->bts_calc_bw(decon, regs);
+		decon->bts.ops->bts_update_bw(decon, regs, 0);
+		SYSTRACE_C_FINISH("decon_bts");
+	}
+
 	DPU_EVENT_LOG_WINCON(&decon->sd, regs);
 
 	decon_to_psr_info(decon, &psr);
@@ -2607,11 +2715,9 @@ static int decon_prepare_win_config(struct decon_device *decon,
 		regs->clear_for_doze = true;
 	}
 
-	if (decon->dt.out_type == DECON_OUT_WB) {
-		regs->protection[MAX_DECON_WIN] = win_config[MAX_DECON_WIN].protection;
-		ret = decon_import_buffer(decon, MAX_DECON_WIN,
-				&win_config[MAX_DECON_WIN], regs);
-	}
+	if (decon->dt.out_type == DECON_OUT_WB)
+		ret = decon_import_wb_buffer(decon, &win_config[MAX_DECON_WIN],
+				regs);
 
 	for (i = 0; i < MAX_DPP_SUBDEV; i++) {
 		memcpy(&regs->dpp_config[i], &win_config[i],
@@ -2745,6 +2851,9 @@ static int decon_set_win_config(struct decon_device *decon,
 	if (ret)
 		goto err_prepare;
 
+	/* let the bus governors scale up before the frame is applied */
+	decon->bts.ops->bts_plan_bw(decon, regs);
+
 	if (win_data->fence >= 0)
 		decon_install_fence(fence, win_data->fence);
 
@@ -3675,7 +3784,7 @@ static int decon_fb_alloc_memory(struct decon_device *decon, struct decon_win *w
 
 	dpp = v4l2_get_subdevdata(decon->dpp_sd[decon->dt.dft_idma]);
 	ret = decon_map_ion_handle(decon, dpp->dev, &win->dma_buf_data[0],
-			handle, buf, win->idx);
+			handle, buf, win->idx, DMA_TO_DEVICE);
 	if (!ret)
 		goto err_map;
 	map_dma = win->dma_buf_data[0].dma_addr;
@@ -699,12 +699,19 @@ int decon_create_psr_info(struct decon_device *decon)
 		return ret;
 	}
 
+	ret = dpu_create_win_update_stat(decon);
+	if (ret) {
+		device_remove_file(decon->dev, &dev_attr_psr_info);
+		return ret;
+	}
+
 	return ret;
 }
 
 void decon_destroy_psr_info(struct decon_device *decon)
 {
 	device_remove_file(decon->dev, &dev_attr_psr_info);
+	dpu_destroy_win_update_stat(decon);
 }
 
 
@@ -556,6 +556,23 @@ enum dex_support_type {
 	DEX_UHD_SUPPORT
 };
 
+#define DP_LINK_CACHE_SIZE	4
+
+/* link settings that trained for a sink, keyed by its EDID identity */
+struct displayport_link_cache {
+	u8 manufacturer[4];
+	u32 product;
+	u32 serial;
+	u8 link_rate;
+	u8 lane_cnt;
+	u8 enhanced_frame;
+	u8 tps3;
+	u8 drive_current[MAX_LANE_CNT];
+	u8 pre_emphasis[MAX_LANE_CNT];
+	unsigned long last_used;
+	bool valid;
+};
+
 struct displayport_device {
 	enum displayport_state state;
 	struct device *dev;
@@ -624,6 +641,14 @@ struct displayport_device {
 	u8  edid_manufacturer[4];
 	u32 edid_product;
 	u32 edid_serial;
+
+	struct displayport_link_cache link_cache[DP_LINK_CACHE_SIZE];
+	bool link_cache_key;	/* EDID identity is valid for the cache */
+	u32 link_cache_hits;
+	u32 link_cache_misses;
+	u32 link_train_ms;	/* last link training */
+	u32 link_up_ms;		/* last hotplug to enabled output */
+	u32 link_up_max_ms;
 };
 
 struct displayport_debug_param {
@@ -20,6 +20,7 @@
 #include <linux/io.h>
 #include <linux/irq.h>
 #include <linux/delay.h>
+#include <linux/ktime.h>
 #include <linux/interrupt.h>
 #include <linux/kthread.h>
 #include <linux/pm_runtime.h>
@@ -161,6 +162,183 @@ void displayport_get_voltage_and_pre_emphasis_max_reach(u8 *drive_current, u8 *p
 	}
 }
 
+static struct displayport_link_cache *displayport_link_cache_find(
+		struct displayport_device *displayport)
+{
+	struct displayport_link_cache *c;
+	int i;
+
+	for (i = 0; i < DP_LINK_CACHE_SIZE; i++) {
+		c = &displayport->link_cache[i];
+		if (c->valid && c->product == displayport->edid_product &&
+				c->serial == displayport->edid_serial &&
+				!memcmp(c->manufacturer, displayport->edid_manufacturer,
+					sizeof(c->manufacturer)))
+			return c;
+	}
+
+	return NULL;
+}
+
+/*
+ * Remembers the settings a full link training ended with, so that the next
+ * plug of the same sink (e.g. a DeX dock) is tried with them first.
+ */
+static void displayport_link_cache_store(u8 link_rate, u8 lane_cnt,
+		u8 enhanced_frame, u8 tps3, u8 *drive_current, u8 *pre_emphasis)
+{
+	struct displayport_device *displayport = get_displayport_drvdata();
+	struct displayport_link_cache *c;
+	int i;
+
+	if (!displayport->link_cache_key)
+		return;
+
+	c = displayport_link_cache_find(displayport);
+	if (!c) {
+		/* take a free entry, or the least recently used one */
+		c = &displayport->link_cache[0];
+		for (i = 0; i < DP_LINK_CACHE_SIZE && c->valid; i++)
+			if (!displayport->link_cache[i].valid ||
+					time_before(displayport->link_cache[i].last_used,
+						c->last_used))
+				c = &displayport->link_cache[i];
+	}
+
+	memcpy(c->manufacturer, displayport->edid_manufacturer,
+			sizeof(c->manufacturer));
+	c->product = displayport->edid_product;
+	c->serial = displayport->edid_serial;
+	c->link_rate = link_rate;
+	c->lane_cnt = lane_cnt;
+	c->enhanced_frame = enhanced_frame;
+	c->tps3 = tps3;
+	memcpy(c->drive_current, drive_current, sizeof(c->drive_current));
+	memcpy(c->pre_emphasis, pre_emphasis, sizeof(c->pre_emphasis));
+	c->last_used = jiffies;
+	c->valid = true;
+}
+
+static void displayport_read_lane_status(u8 *cr, u8 *eq, u8 *sl, u8 *align)
+{
+	u8 val[3] = {0, };
+
+	displayport_reg_dpcd_read_burst(DPCD_ADD_LANE0_1_STATUS, 3, val);
+
+	*cr = ((val[0] & LANE0_CR_DONE) >> 0) | ((val[0] & LANE1_CR_DONE) >> 3) |
+		((val[1] & LANE2_CR_DONE) << 2) | ((val[1] & LANE3_CR_DONE) >> 1);
+	*eq = ((val[0] & LANE0_CHANNEL_EQ_DONE) >> 1) |
+		((val[0] & LANE1_CHANNEL_EQ_DONE) >> 4) |
+		((val[1] & LANE2_CHANNEL_EQ_DONE) << 1) |
+		((val[1] & LANE3_CHANNEL_EQ_DONE) >> 2);
+	*sl = ((val[0] & LANE0_SYMBOL_LOCKED) >> 2) |
+		((val[0] & LANE1_SYMBOL_LOCKED) >> 5) |
+		((val[1] & LANE2_SYMBOL_LOCKED) >> 0) |
+		((val[1] & LANE3_SYMBOL_LOCKED) >> 3);
+	*align = val[2] & INTERLANE_ALIGN_DONE;
+}
+
+/*
+ * One CR and one EQ round with the settings that trained last time for this
+ * sink. Any lane not done falls back to the full training.
+ */
+static int displayport_cached_link_training(struct displayport_link_cache *c)
+{
+	u8 drive_current[MAX_LANE_CNT];
+	u8 pre_emphasis[MAX_LANE_CNT];
+	u8 max_reach_value[MAX_LANE_CNT];
+	u8 lane_mask = (1 << c->lane_cnt) - 1;
+	u8 val[DPCD_BUF_SIZE] = {0,};
+	u8 cr, eq, sl, align;
+	long wait_us;
+	int i;
+
+	displayport_info("Cached Link Training start + : %02x %02x\n",
+			c->link_rate, c->lane_cnt);
+
+	memcpy(drive_current, c->drive_current, sizeof(drive_current));
+	memcpy(pre_emphasis, c->pre_emphasis, sizeof(pre_emphasis));
+
+	displayport_reg_dpcd_read(DPCD_ADD_MAX_LANE_COUNT, 1, val);
+	max_lane_cnt = val[0] & MAX_LANE_COUNT;
+
+	displayport_reg_dpcd_read(DPCD_ADD_TRAINING_AUX_RD_INTERVAL, 1, val);
+	wait_us = (val[0] * 4000) + 400;
+
+	if (c->enhanced_frame)
+		displayport_write_mask(DP_System_Control_4, 1, Enhanced_Framing_Mode);
+
+	displayport_reg_phy_reset(1);
+	displayport_reg_set_link_bw(c->link_rate);
+	if (displayport_reg_get_cmn_ctl_sfr_ctl_mode())
+		displayport_reg_set_phy_clk_bw(c->link_rate);
+	displayport_reg_set_lane_count(c->lane_cnt);
+	displayport_reg_phy_reset(0);
+
+	val[0] = c->link_rate;
+	val[1] = c->lane_cnt;
+	if (c->enhanced_frame)
+		val[1] |= ENHANCED_FRAME_CAP;
+	displayport_reg_dpcd_write_burst(DPCD_ADD_LINK_BW_SET, 2, val);
+
+	displayport_reg_wait_phy_pll_lock();
+
+	displayport_reg_set_training_pattern(TRAINING_PATTERN_1);
+	val[0] = 0x21;	/* SCRAMBLING_DISABLE, TRAINING_PATTERN_1 */
+	displayport_reg_dpcd_write(DPCD_ADD_TRANING_PATTERN_SET, 1, val);
+
+	displayport_reg_set_voltage_and_pre_emphasis(drive_current, pre_emphasis);
+	displayport_get_voltage_and_pre_emphasis_max_reach(drive_current,
+			pre_emphasis, max_reach_value);
+	for (i = 0; i < MAX_LANE_CNT; i++)
+		val[i] = (pre_emphasis[i] << 3) | drive_current[i] | max_reach_value[i];
+	displayport_reg_dpcd_write_burst(DPCD_ADD_TRANING_LANE0_SET, 4, val);
+
+	usleep_range(wait_us, wait_us + 100);
+
+	displayport_read_lane_status(&cr, &eq, &sl, &align);
+	if ((cr & lane_mask) != lane_mask)
+		goto fail;
+
+	if (c->tps3) {
+		displayport_reg_set_training_pattern(TRAINING_PATTERN_3);
+		val[0] = 0x23;	/* SCRAMBLING_DISABLE, TRAINING_PATTERN_3 */
+	} else {
+		displayport_reg_set_training_pattern(TRAINING_PATTERN_2);
+		val[0] = 0x22;	/* SCRAMBLING_DISABLE, TRAINING_PATTERN_2 */
+	}
+	displayport_reg_dpcd_write(DPCD_ADD_TRANING_PATTERN_SET, 1, val);
+
+	usleep_range(wait_us, wait_us + 100);
+
+	displayport_read_lane_status(&cr, &eq, &sl, &align);
+	if ((cr & lane_mask) != lane_mask || (eq & lane_mask) != lane_mask ||
+			(sl & lane_mask) != lane_mask || !align)
+		goto fail;
+
+	displayport_reg_set_training_pattern(NORAMAL_DATA);
+	val[0] = 0x00;	/* SCRAMBLING_ENABLE, NORMAL_DATA */
+	displayport_reg_dpcd_write(DPCD_ADD_TRANING_PATTERN_SET, 1, val);
+
+	max_link_rate = c->link_rate;
+
+	displayport_info("Cached Link Training Finish -\n");
+#ifdef CONFIG_SEC_DISPLAYPORT_BIGDATA
+	secdp_bigdata_save_item(BD_CUR_LANE_COUNT, c->lane_cnt);
+	secdp_bigdata_save_item(BD_CUR_LINK_RATE, c->link_rate);
+#endif
+	return 0;
+
+fail:
+	displayport_reg_set_training_pattern(NORAMAL_DATA);
+	val[0] = 0x00;	/* SCRAMBLING_ENABLE, NORMAL_DATA */
+	displayport_reg_dpcd_write(DPCD_ADD_TRANING_PATTERN_SET, 1, val);
+
+	displayport_info("Cached Link Training Fail : cr %x eq %x sl %x align %x -\n",
+			cr, eq, sl, align);
+	return -EINVAL;
+}
+
 static int displayport_full_link_training(void)
 {
 	u8 link_rate;
@@ -479,6 +657,9 @@ EQ_Training_Retry:
 			displayport_reg_dpcd_write(DPCD_ADD_TRANING_PATTERN_SET, 1, val);
 
 			displayport_info("Full Link Training Finish - : %02x %02x\n", link_rate, lane_cnt);
+			displayport_link_cache_store(link_rate, lane_cnt,
+					enhanced_frame_cap, tps3_supported,
+					drive_current, pre_emphasis);
 			displayport_info("LANE_SET [%d] : %02x %02x %02x %02x\n",
 					eq_training_retry_no, eq_val[0], eq_val[1], eq_val[2], eq_val[3]);
 #ifdef CONFIG_SEC_DISPLAYPORT_BIGDATA
@@ -497,6 +678,9 @@ EQ_Training_Retry:
 			displayport_reg_dpcd_write(DPCD_ADD_TRANING_PATTERN_SET, 1, val);
 
 			displayport_info("Full Link Training Finish - : %02x %02x\n", link_rate, lane_cnt);
+			displayport_link_cache_store(link_rate, lane_cnt,
+					enhanced_frame_cap, tps3_supported,
+					drive_current, pre_emphasis);
 			displayport_info("LANE_SET [%d] : %02x %02x %02x %02x\n",
 					eq_training_retry_no, eq_val[0], eq_val[1], eq_val[2], eq_val[3]);
 #ifdef CONFIG_SEC_DISPLAYPORT_BIGDATA
@@ -515,6 +699,9 @@ EQ_Training_Retry:
 			displayport_reg_dpcd_write(DPCD_ADD_TRANING_PATTERN_SET, 1, val);
 
 			displayport_info("Full Link Training Finish - : %02x %02x\n", link_rate, lane_cnt);
+			displayport_link_cache_store(link_rate, lane_cnt,
+					enhanced_frame_cap, tps3_supported,
+					drive_current, pre_emphasis);
 			displayport_info("LANE_SET [%d] : %02x %02x %02x %02x\n",
 					eq_training_retry_no, eq_val[0], eq_val[1], eq_val[2], eq_val[3]);
 #ifdef CONFIG_SEC_DISPLAYPORT_BIGDATA
@@ -896,6 +1083,8 @@ static int displayport_link_training(void)
 {
 	u8 val;
 	struct displayport_device *displayport = get_displayport_drvdata();
+	struct displayport_link_cache *cached = NULL;
+	ktime_t start = ktime_get();
 	int ret = 0;
 
 	mutex_lock(&displayport->training_lock);
@@ -908,6 +1097,24 @@ static int displayport_link_training(void)
 #endif
 	}
 
+	/* the cache is keyed by the EDID, and is not used for tests */
+	displayport->link_cache_key = ret >= 0 &&
+		!g_displayport_debug_param.param_used &&
+		!displayport->auto_test_mode;
+	if (displayport->link_cache_key)
+		cached = displayport_link_cache_find(displayport);
+
+	if (cached) {
+		ret = displayport_cached_link_training(cached);
+		if (!ret) {
+			cached->last_used = jiffies;
+			displayport->link_cache_hits++;
+			goto out;
+		}
+		cached->valid = false;
+		displayport->link_cache_misses++;
+	}
+
 	displayport_reg_dpcd_read(DPCD_ADD_MAX_DOWNSPREAD, 1, &val);
 	displayport_dbg("DPCD_ADD_MAX_DOWNSPREAD = %x\n", val);
 
@@ -918,6 +1125,11 @@ static int displayport_link_training(void)
 	} else
 		ret = displayport_full_link_training();
 
+out:
+	displayport->link_train_ms = ktime_to_ms(ktime_sub(ktime_get(), start));
+	displayport_info("link training %s in %u ms\n", cached && !ret ?
+			"from cache" : "done", displayport->link_train_ms);
+
 	mutex_unlock(&displayport->training_lock);
 
 	return ret;
@@ -939,6 +1151,7 @@ void displayport_hpd_changed(int state)
 {
 	int ret;
 	int timeout = 0;
+	ktime_t start = ktime_get();
 	struct displayport_device *displayport = get_displayport_drvdata();
 
 	mutex_lock(&displayport->hpd_lock);
@@ -1002,6 +1215,11 @@ void displayport_hpd_changed(int state)
 			(displayport->state == DISPLAYPORT_STATE_ON), msecs_to_jiffies(1000));
 		if (!timeout)
 			displayport_err("enable timeout\n");
+
+		displayport->link_up_ms = ktime_to_ms(ktime_sub(ktime_get(), start));
+		displayport->link_up_max_ms = max(displayport->link_up_max_ms,
+				displayport->link_up_ms);
+		displayport_info("link up in %u ms\n", displayport->link_up_ms);
 	} else {
 		if (displayport->hdcp_ver == HDCP_VERSION_2_2) {
 			hdcp_dplink_set_integrity_fail();
@@ -3177,6 +3395,20 @@ static ssize_t displayport_monitor_info_show(struct class *class,
 
 static CLASS_ATTR(monitor_info, 0444, displayport_monitor_info_show, NULL);
 
+static ssize_t displayport_link_stat_show(struct class *class,
+		struct class_attribute *attr, char *buf)
+{
+	struct displayport_device *displayport = get_displayport_drvdata();
+
+	return scnprintf(buf, PAGE_SIZE,
+			"train %u ms, up %u ms (max %u ms), cache hit %u miss %u\n",
+			displayport->link_train_ms, displayport->link_up_ms,
+			displayport->link_up_max_ms, displayport->link_cache_hits,
+			displayport->link_cache_misses);
+}
+
+static CLASS_ATTR(link_stat, 0444, displayport_link_stat_show, NULL);
+
 
 static ssize_t displayport_aux_sw_sel_store(struct class *dev,
 		struct class_attribute *attr, const char *buf, size_t size)
@@ -3404,6 +3636,9 @@ static int displayport_probe(struct platform_device *pdev)
 		ret = class_create_file(dp_class, &class_attr_monitor_info);
 		if (ret)
 			displayport_err("failed to create attr_dp_monitor_info\n");
+		ret = class_create_file(dp_class, &class_attr_link_stat);
+		if (ret)
+			displayport_err("failed to create attr_dp_link_stat\n");
 		ret = class_create_file(dp_class, &class_attr_dp_sbu_sw_sel);
 		if (ret)
 			displayport_err("failed to create class_attr_dp_sbu_sw_sel\n");
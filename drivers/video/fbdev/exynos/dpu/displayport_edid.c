@@ -148,6 +148,10 @@ static int edid_read_block(struct displayport_device *hdev, int block, u8 *buf,
 	return 0;
 }
 
+/* the last EDID read in full, to skip the extension blocks on a replug */
+static u8 *edid_cache;
+static int edid_cache_blocks;
+
 int edid_read(struct displayport_device *hdev, u8 **data)
 {
 	u8 block0[EDID_BLOCK_SIZE];
@@ -166,6 +170,17 @@ int edid_read(struct displayport_device *hdev, u8 **data)
 	block_cnt = block0[EDID_EXTENSION_FLAG] + 1;
 	displayport_info("block_cnt = %d\n", block_cnt);
 
+	/* the base block has the ID and serial number, so the sink is the same */
+	if (edid_cache && edid_cache_blocks == block_cnt &&
+			!memcmp(edid_cache, block0, sizeof(block0))) {
+		edid = kmemdup(edid_cache, block_cnt * EDID_BLOCK_SIZE, GFP_KERNEL);
+		if (edid) {
+			displayport_info("EDID extension blocks from cache\n");
+			*data = edid;
+			return block_cnt;
+		}
+	}
+
 	edid = kmalloc(block_cnt * EDID_BLOCK_SIZE, GFP_KERNEL);
 	if (!edid)
 		return -ENOMEM;
@@ -188,6 +203,10 @@ int edid_read(struct displayport_device *hdev, u8 **data)
 
 	*data = edid;
 
+	kfree(edid_cache);
+	edid_cache = kmemdup(edid, block_cnt * EDID_BLOCK_SIZE, GFP_KERNEL);
+	edid_cache_blocks = edid_cache ? block_cnt : 0;
+
 	return block_cnt;
 }
 
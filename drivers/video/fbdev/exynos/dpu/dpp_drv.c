@@ -1109,6 +1109,8 @@ static int dpp_probe(struct platform_device *pdev)
 	}
 
 	iovmm_set_fault_handler(dev, dpp_sysmmu_fault_handler, NULL);
+	/* old buffers are unmapped only after the frame that used them */
+	iovmm_set_deferred_unmap(dev, true);
 
 	dpp->state = DPP_STATE_OFF;
 	dpp_info("dpp%d is probed successfully\n", dpp->id);
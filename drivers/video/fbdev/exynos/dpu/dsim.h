@@ -278,6 +278,8 @@ struct dsim_device {
 };
 
 int dsim_write_data(struct dsim_device *dsim, u8 id, u8 *cmd, u32 size);
+int dsim_write_data_batch(struct dsim_device *dsim,
+		const struct mipi_tx_cmd *cmds, int count);
 int dsim_read_data(struct dsim_device *dsim, u8 id, u8 addr, u8 *buf, u16 size);
 int dsim_wait_for_cmd_done(struct dsim_device *dsim);
 
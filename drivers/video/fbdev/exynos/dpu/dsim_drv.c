@@ -187,31 +187,15 @@ static bool dsim_fifo_empty_needed(struct dsim_device *dsim, char data_id, char
 #endif
 }
 
-int dsim_write_data(struct dsim_device *dsim, u8 id, u8 *cmd, u32 size)
+/* queue one packet into the SFR FIFOs, cmd_lock must be held */
+static int dsim_tx_packet(struct dsim_device *dsim, u8 id, u8 *cmd, u32 size,
+		bool *must_wait)
 {
 	int i;
-	int ret = 0;
-	bool must_wait = true;
 	u8 tmp_buf[2] = {0, 0};
 
-	struct decon_device *decon = get_decon_drvdata(0);
-
-	decon_hiber_block_exit(decon);
-
-	mutex_lock(&dsim->cmd_lock);
-	if (dsim->state != DSIM_STATE_ON) {
-		dsim_err("DSIM is not ready. state(%d)\n", dsim->state);
-		ret = -EINVAL;
-		goto err_exit;
-	}
 	DPU_EVENT_LOG_CMD(&dsim->sd, id, cmd[0]);
 
-	reinit_completion(&dsim->ph_wr_comp);
-	dsim_reg_clear_int(dsim->id, DSIM_INTSRC_SFR_PH_FIFO_EMPTY);
-
-	/* Run write-fail dectector */
-	mod_timer(&dsim->cmd_timer, jiffies + MIPI_WR_TIMEOUT);
-
 	switch (id) {
 	/* short packet types of packet types for command. */
 	case MIPI_DSI_GENERIC_SHORT_WRITE_0_PARAM:
@@ -227,13 +211,12 @@ int dsim_write_data(struct dsim_device *dsim, u8 id, u8 *cmd, u32 size)
 	case MIPI_DSI_TURN_ON_PERIPHERAL:
 		if (size > 2) {
 			dsim_err("ERR:%s:wrong size : %d\n", __func__, size);
-			ret = -EINVAL;
-			goto err_exit;
+			return -EINVAL;
 		}
 		for (i = 0; i < size; i++)
 			tmp_buf[i] = cmd[i];
 		dsim_reg_wr_tx_header(dsim->id, id, tmp_buf[0], tmp_buf[1], false);
-		must_wait = dsim_fifo_empty_needed(dsim, id, tmp_buf[0]);
+		*must_wait = dsim_fifo_empty_needed(dsim, id, tmp_buf[0]);
 		break;
 
 	case MIPI_DSI_GENERIC_READ_REQUEST_0_PARAM:
@@ -242,13 +225,12 @@ int dsim_write_data(struct dsim_device *dsim, u8 id, u8 *cmd, u32 size)
 	case MIPI_DSI_DCS_READ:
 		if (size > 2) {
 			dsim_err("ERR:%s:wrong size : %d\n", __func__, size);
-			ret = -EINVAL;
-			goto err_exit;
+			return -EINVAL;
 		}
 		for (i = 0; i < size; i++)
 			tmp_buf[i] = cmd[i];
 		dsim_reg_wr_tx_header(dsim->id, id, tmp_buf[0], tmp_buf[1], true);
-		must_wait = dsim_fifo_empty_needed(dsim, id, tmp_buf[0]);
+		*must_wait = dsim_fifo_empty_needed(dsim, id, tmp_buf[0]);
 		break;
 
 	/* long packet types of packet types for command. */
@@ -257,12 +239,43 @@ int dsim_write_data(struct dsim_device *dsim, u8 id, u8 *cmd, u32 size)
 	case MIPI_DSI_DSC_PPS:
 		dsim_long_data_wr(dsim, cmd, size);
 		dsim_reg_wr_tx_header(dsim->id, id, (u8)(size & 0xff), (u8)((size & 0xff00) >> 8), false);
-		must_wait = dsim_fifo_empty_needed(dsim, id, cmd[0]);
+		*must_wait = dsim_fifo_empty_needed(dsim, id, cmd[0]);
 		break;
 
 	default:
 		dsim_info("data id %x is not supported.\n", id);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+int dsim_write_data(struct dsim_device *dsim, u8 id, u8 *cmd, u32 size)
+{
+	int ret = 0;
+	bool must_wait = true;
+
+	struct decon_device *decon = get_decon_drvdata(0);
+
+	decon_hiber_block_exit(decon);
+
+	mutex_lock(&dsim->cmd_lock);
+	if (dsim->state != DSIM_STATE_ON) {
+		dsim_err("DSIM is not ready. state(%d)\n", dsim->state);
 		ret = -EINVAL;
+		goto err_exit;
+	}
+
+	reinit_completion(&dsim->ph_wr_comp);
+	dsim_reg_clear_int(dsim->id, DSIM_INTSRC_SFR_PH_FIFO_EMPTY);
+
+	/* Run write-fail dectector */
+	mod_timer(&dsim->cmd_timer, jiffies + MIPI_WR_TIMEOUT);
+
+	ret = dsim_tx_packet(dsim, id, cmd, size, &must_wait);
+	if (ret < 0) {
+		del_timer(&dsim->cmd_timer);
+		goto err_exit;
 	}
 
 	ret = dsim_wait_for_cmd_fifo_empty(dsim, must_wait);
@@ -278,6 +291,111 @@ err_exit:
 	return ret;
 }
 
+static u8 dsim_get_dsi_write_type(const u8 *cmd, int size)
+{
+	if (size == 1)
+		return MIPI_DSI_DCS_SHORT_WRITE;
+	/*
+	   When send TE_ON(35h) command with 1 para type, DSI goes to BTA.
+	   To prevent unintended BTA in that case, tx TE_ON(35h) command with 1 para
+	   will be sent with long packet type.
+	 */
+	else if (size == 2 && cmd && cmd[0] != 0x35)
+		return MIPI_DSI_DCS_SHORT_WRITE_PARAM;
+
+	return MIPI_DSI_DCS_LONG_WRITE;
+}
+
+/*
+ * Write a series of commands, packing them into the SFR FIFOs and waiting
+ * for the header FIFO to drain only when the FIFOs are full and once at the
+ * end, instead of after every packet. Each command must fit in the payload
+ * FIFO; MIPI_DSI_WRITE ids are mapped to DCS short/long writes. Returns the
+ * number of commands sent or a negative error.
+ */
+int dsim_write_data_batch(struct dsim_device *dsim,
+		const struct mipi_tx_cmd *cmds, int count)
+{
+	int i, ret = 0;
+	u32 pl_bytes = 0, pl_size;
+	bool must_wait;
+	u8 id;
+	struct decon_device *decon = get_decon_drvdata(0);
+
+	decon_hiber_block_exit(decon);
+
+	mutex_lock(&dsim->cmd_lock);
+	if (dsim->state != DSIM_STATE_ON) {
+		dsim_err("DSIM is not ready. state(%d)\n", dsim->state);
+		ret = -EINVAL;
+		goto err_exit;
+	}
+
+	reinit_completion(&dsim->ph_wr_comp);
+	dsim_reg_clear_int(dsim->id, DSIM_INTSRC_SFR_PH_FIFO_EMPTY);
+	mod_timer(&dsim->cmd_timer, jiffies + MIPI_WR_TIMEOUT);
+
+	for (i = 0; i < count; i++) {
+		id = cmds[i].id;
+		if (id == MIPI_DSI_WRITE)
+			id = dsim_get_dsi_write_type(cmds[i].data, cmds[i].size);
+
+		if (id == MIPI_DSI_DCS_READ || cmds[i].size > DSIM_FIFO_SIZE) {
+			dsim_err("ERR:%s:cmd %d (id %x size %d) can't be batched\n",
+					__func__, i, id, cmds[i].size);
+			ret = -EINVAL;
+			break;
+		}
+
+		pl_size = (id == MIPI_DSI_DCS_LONG_WRITE ||
+				id == MIPI_DSI_GENERIC_LONG_WRITE ||
+				id == MIPI_DSI_DSC_PPS) ? ALIGN(cmds[i].size, 4) : 0;
+
+		/*
+		 * Drain the FIFOs before a packet that doesn't fit. EVT0 keeps
+		 * the single packet transmission.
+		 */
+		if (i && (dsim->version == 0 ||
+				pl_bytes + pl_size > DSIM_FIFO_SIZE ||
+				!dsim_reg_is_writable_fifo_state(dsim->id))) {
+			ret = dsim_wait_for_cmd_fifo_empty(dsim, true);
+			if (ret < 0)
+				break;
+			reinit_completion(&dsim->ph_wr_comp);
+			dsim_reg_clear_int(dsim->id, DSIM_INTSRC_SFR_PH_FIFO_EMPTY);
+			mod_timer(&dsim->cmd_timer, jiffies + MIPI_WR_TIMEOUT);
+			pl_bytes = 0;
+		}
+
+		ret = dsim_tx_packet(dsim, id, (u8 *)cmds[i].data, cmds[i].size,
+				&must_wait);
+		if (ret < 0)
+			break;
+		pl_bytes += pl_size;
+	}
+
+	if (i) {
+		/* wait for what is queued, even if a later command failed */
+		int err = dsim_wait_for_cmd_fifo_empty(dsim, true);
+
+		if (!ret)
+			ret = err;
+	} else {
+		del_timer(&dsim->cmd_timer);
+	}
+
+	if (ret < 0) {
+		dsim_err("DSIM batch cmd wr failed at %d/%d (%d)\n", i, count, ret);
+		goto err_exit;
+	}
+	ret = count;
+err_exit:
+	mutex_unlock(&dsim->cmd_lock);
+	decon_hiber_unblock(decon);
+
+	return ret;
+}
+
 int dsim_read_data(struct dsim_device *dsim, u8 id, u8 addr, u8 *buf, u16 size)
 {
 	int i, j;
@@ -399,21 +517,10 @@ static int __mipi_write_data(struct dsim_device *dsim, u8 cmd_id, const u8 *cmd,
 	int retry = 5;
 	unsigned char dsi_cmd = 0;
 
-	if (cmd_id == MIPI_DSI_WRITE) {
-		if (size == 1)
-			dsi_cmd = MIPI_DSI_DCS_SHORT_WRITE;
-		/*
-		   When send TE_ON(35h) command with 1 para type, DSI goes to BTA.
-		   To prevent unintended BTA in that case, tx TE_ON(35h) command with 1 para
-		   will be sent with long packet type.
-		 */
-		else if (size == 2 && cmd && cmd[0] != 0x35)
-			dsi_cmd = MIPI_DSI_DCS_SHORT_WRITE_PARAM;
-		else
-			dsi_cmd = MIPI_DSI_DCS_LONG_WRITE;
-	} else {
+	if (cmd_id == MIPI_DSI_WRITE)
+		dsi_cmd = dsim_get_dsi_write_type(cmd, size);
+	else
 		dsi_cmd = cmd_id;
-	}
 
 write_command:
 	ret = dsim_write_data(dsim, dsi_cmd, (u8 *)cmd, size);
@@ -777,6 +884,50 @@ err_write_cmd:
 	return ret;
 }
 
+/*
+ * Runs of plain writes that fit in the FIFO go out as one batch; anything
+ * else is sent by mipi_write_cmd(), which splits long commands.
+ */
+int mipi_write_cmd_batch(u32 id, const struct mipi_tx_cmd *cmds, int count)
+{
+	int i, start, ret;
+	struct dsim_device *dsim = NULL;
+
+	if (id >= MAX_DSIM_CNT) {
+		dsim_err("ERR:DSIM:%s:invalid id : %d\n", __func__, id);
+		return -EINVAL;
+	}
+
+	dsim = dsim_drvdata[id];
+	if (dsim == NULL) {
+		dsim_err("ERR:DSIM:%s:dsim is NULL\n", __func__);
+		return -ENODEV;
+	}
+
+	for (i = start = 0; i <= count; i++) {
+		if (i < count && cmds[i].id == MIPI_DSI_WRITE &&
+				cmds[i].size <= DSIM_FIFO_SIZE)
+			continue;
+
+		if (i > start) {
+			ret = dsim_write_data_batch(dsim, &cmds[start], i - start);
+			if (ret != i - start) {
+				dsim_err("DSIM:ERR:%s:failed to write batch\n", __func__);
+				return ret < 0 ? ret : -EIO;
+			}
+		}
+
+		if (i < count) {
+			ret = mipi_write_cmd(id, cmds[i].id, cmds[i].data, cmds[i].size);
+			if (ret != cmds[i].size)
+				return ret < 0 ? ret : -EIO;
+		}
+		start = i + 1;
+	}
+
+	return count;
+}
+
 int mipi_read_cmd(u32 id, u8 addr, u8 *buf, int size)
 {
 	int ret = 0;
@@ -1622,6 +1773,7 @@ static int dsim_panel_put_ops(struct dsim_device *dsim)
 
 	mipi_ops.read = mipi_read_cmd;
 	mipi_ops.write = mipi_write_cmd;
+	mipi_ops.write_batch = mipi_write_cmd_batch;
 	mipi_ops.get_state = get_dsim_state;
 
 	v4l2_set_subdev_hostdata(dsim->panel_sd, &mipi_ops);
@@ -510,6 +510,85 @@ int decon_wait_fence(struct sync_fence *fence)
 	return err;
 }
 
+struct decon_fence_waiter {
+	struct sync_fence_waiter waiter;
+	atomic_t *pending;
+	wait_queue_head_t *wq;
+};
+
+static void decon_fence_signaled(struct sync_fence *fence,
+		struct sync_fence_waiter *waiter)
+{
+	struct decon_fence_waiter *w =
+		container_of(waiter, struct decon_fence_waiter, waiter);
+
+	if (atomic_dec_and_test(w->pending))
+		wake_up(w->wq);
+}
+
+/*
+ * Waits for the acquire fences of all windows, and of the writeback target
+ * in the MAX_DECON_WIN slot, at once. Each fence used to be waited in turn
+ * with its own timeout, so one late producer held the others and a broken
+ * one could cost the timeout once per window. Here the waits share a single
+ * deadline. Returns the mask of windows whose fence failed or did not
+ * signal in time.
+ */
+unsigned long decon_wait_fences(struct decon_device *decon,
+		struct decon_reg_data *regs)
+{
+	struct decon_fence_waiter waiters[MAX_DECON_WIN + 1];
+	DECLARE_WAIT_QUEUE_HEAD_ONSTACK(wq);
+	atomic_t pending = ATOMIC_INIT(1);
+	unsigned long registered = 0, err_mask = 0;
+	struct sync_fence *fence;
+	int i, ret;
+
+	/* the slots between max_win and MAX_DECON_WIN have no fence */
+	for (i = 0; i <= MAX_DECON_WIN; i++) {
+		fence = regs->dma_buf_data[i][0].fence;
+		if (!fence)
+			continue;
+
+		waiters[i].pending = &pending;
+		waiters[i].wq = &wq;
+		sync_fence_waiter_init(&waiters[i].waiter, decon_fence_signaled);
+
+		atomic_inc(&pending);
+		ret = sync_fence_wait_async(fence, &waiters[i].waiter);
+		if (ret == 0) {
+			set_bit(i, &registered);
+			continue;
+		}
+
+		atomic_dec(&pending);
+		if (ret < 0)
+			set_bit(i, &err_mask);
+	}
+
+	/* drop the initial count, the last signaled fence wakes us up */
+	if (!atomic_dec_and_test(&pending))
+		wait_event_timeout(wq, !atomic_read(&pending),
+				msecs_to_jiffies(900));
+
+	for_each_set_bit(i, &registered, MAX_DECON_WIN + 1) {
+		fence = regs->dma_buf_data[i][0].fence;
+		sync_fence_cancel_async(fence, &waiters[i].waiter);
+		if (atomic_read(&fence->status) != 0)
+			set_bit(i, &err_mask);
+	}
+
+	for_each_set_bit(i, &err_mask, MAX_DECON_WIN + 1) {
+		fence = regs->dma_buf_data[i][0].fence;
+		snprintf(acquire_fence_log, ACQUIRE_FENCE_LEN, "%p:%s:%d",
+				fence, fence->name, atomic_read(&fence->status));
+		decon_warn("%s: error waiting on acquire fence\n",
+				acquire_fence_log);
+	}
+
+	return err_mask;
+}
+
 void decon_signal_fence(struct decon_device *decon)
 {
 	sw_sync_timeline_inc(decon->timeline, 1);
@@ -92,6 +92,108 @@ static void win_update_adjust_region(struct decon_device *decon,
 			regs->up_region.bottom - regs->up_region.top + 1);
 }
 
+/* a partial region taller than this percentage of the panel is sent full */
+#define WIN_UP_FULL_PERCENT	75
+/* bytes per pixel on the DSI link before compression */
+#define WIN_UP_BYTES_PER_PIXEL	3
+
+static u32 win_update_rect_h(struct decon_rect *r)
+{
+	return r->bottom - r->top + 1;
+}
+
+static bool win_update_too_tall(struct decon_device *decon, u32 h)
+{
+	return h * 100 > decon->lcd_info->yres * WIN_UP_FULL_PERCENT;
+}
+
+/*
+ * Decides the region to send from the damage of the recent frames instead
+ * of the current frame alone. Changing the region costs a partial command
+ * and an idle wait, so
+ *  - a damage inside the current partial region that is not much smaller
+ *    keeps that region as it is,
+ *  - a damage that keeps moving is covered by the union of the recent
+ *    damages, which stays the same from frame to frame,
+ *  - a region tall enough that partial update saves little is sent full.
+ */
+static void win_update_predict_region(struct decon_device *decon,
+		struct decon_reg_data *regs)
+{
+	struct decon_win_update *win_up = &decon->win_up;
+	struct decon_rect *prev = &win_up->prev_up_region;
+	struct decon_rect *cur = &regs->up_region;
+	struct decon_rect merged;
+	int i, changes = 0;
+
+	win_up->hist[win_up->hist_idx] = *cur;
+	win_up->hist_idx = (win_up->hist_idx + 1) % WIN_UP_HISTORY;
+	if (win_up->hist_cnt < WIN_UP_HISTORY)
+		win_up->hist_cnt++;
+
+	if (is_full(cur, decon->lcd_info))
+		return;
+
+	if (win_update_too_tall(decon, win_update_rect_h(cur)))
+		goto change_full;
+
+	if (!is_full(prev, decon->lcd_info) &&
+			(cur->top >= prev->top) && (cur->bottom <= prev->bottom) &&
+			(win_update_rect_h(cur) * 2 >= win_update_rect_h(prev))) {
+		*cur = *prev;
+		return;
+	}
+
+	merged = *cur;
+	for (i = 0; i < win_up->hist_cnt; i++) {
+		struct decon_rect *r = &win_up->hist[i];
+
+		if (is_decon_rect_differ(r, cur))
+			changes++;
+
+		merged.left = min(merged.left, r->left);
+		merged.top = min(merged.top, r->top);
+		merged.right = max(merged.right, r->right);
+		merged.bottom = max(merged.bottom, r->bottom);
+	}
+
+	if (changes * 2 < win_up->hist_cnt)
+		return;
+
+	if (win_update_too_tall(decon, win_update_rect_h(&merged)))
+		goto change_full;
+
+	DPU_DEBUG_WIN("merged update region[%d %d %d %d]\n",
+			merged.left, merged.top,
+			merged.right - merged.left + 1,
+			win_update_rect_h(&merged));
+	*cur = merged;
+	return;
+
+change_full:
+	DPU_FULL_RECT(cur, decon->lcd_info);
+}
+
+static void win_update_account(struct decon_device *decon,
+		struct decon_reg_data *regs)
+{
+	struct decon_win_update *win_up = &decon->win_up;
+	struct decon_lcd *lcd = decon->lcd_info;
+
+	if (regs->need_update)
+		win_up->reconfig_cnt++;
+
+	if (is_full(&regs->up_region, lcd)) {
+		win_up->full_frames++;
+		return;
+	}
+
+	win_up->partial_frames++;
+	win_up->saved_bytes += (u64)(lcd->yres -
+			win_update_rect_h(&regs->up_region)) *
+			lcd->xres * WIN_UP_BYTES_PER_PIXEL;
+}
+
 static void win_update_check_limitation(struct decon_device *decon,
 		struct decon_win_config *win_config,
 		struct decon_reg_data *regs)
@@ -269,6 +371,13 @@ void dpu_prepare_win_update_config(struct decon_device *decon,
 	/* check DPP hw limitation if violated, update region is changed to full */
 	win_update_check_limitation(decon, win_config, regs);
 
+	/*
+	 * stabilize the region with the damage history. A widened region
+	 * can cut other windows, so the limitation is checked once more.
+	 */
+	win_update_predict_region(decon, regs);
+	win_update_check_limitation(decon, win_config, regs);
+
 	/*
 	 * If update region is changed, need_update flag is set.
 	 * That means hw configuration is needed
@@ -294,6 +403,8 @@ void dpu_prepare_win_update_config(struct decon_device *decon,
 	if (reconfigure)
 		win_update_reconfig_coordinates(decon, win_config, regs);
 
+	win_update_account(decon, regs);
+
 	/* TODO: This will be moved after applied hw configuration. */
 	memcpy(&decon->win_up.prev_up_region, &regs->up_region,
 			sizeof(struct decon_rect));
@@ -481,6 +592,8 @@ void dpu_init_win_update(struct decon_device *decon)
 	}
 
 	DPU_FULL_RECT(&decon->win_up.prev_up_region, lcd);
+	decon->win_up.hist_idx = 0;
+	decon->win_up.hist_cnt = 0;
 
 	decon->win_up.hori_cnt = decon->lcd_info->xres / decon->win_up.rect_w;
 	if (decon->lcd_info->xres - decon->win_up.hori_cnt * decon->win_up.rect_w) {
@@ -505,3 +618,32 @@ void dpu_init_win_update(struct decon_device *decon)
 
 	decon->win_up.enabled = true;
 }
+
+static ssize_t win_update_show_stat(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct decon_device *decon = dev_get_drvdata(dev);
+	struct decon_win_update *win_up = &decon->win_up;
+
+	return scnprintf(buf, PAGE_SIZE,
+			"partial %llu full %llu reconfig %llu saved_bytes %llu\n",
+			win_up->partial_frames, win_up->full_frames,
+			win_up->reconfig_cnt, win_up->saved_bytes);
+}
+static DEVICE_ATTR(win_update_stat, S_IRUGO, win_update_show_stat, NULL);
+
+int dpu_create_win_update_stat(struct decon_device *decon)
+{
+	int ret;
+
+	ret = device_create_file(decon->dev, &dev_attr_win_update_stat);
+	if (ret)
+		decon_err("failed to create win update stat file\n");
+
+	return ret;
+}
+
+void dpu_destroy_win_update_stat(struct decon_device *decon)
+{
+	device_remove_file(decon->dev, &dev_attr_win_update_stat);
+}
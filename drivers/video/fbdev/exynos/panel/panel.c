@@ -715,7 +715,76 @@ static int panel_do_tx_packet(struct panel_device *panel, struct pktinfo *info)
 	return 0;
 }
 
-static int panel_do_setkey(struct panel_device *panel, struct keyinfo *info)
+#define PANEL_TX_BATCH_MAX	(16)
+
+/* consecutive write packets of a sequence, sent with one FIFO wait */
+struct panel_tx_batch {
+	struct mipi_tx_cmd cmds[PANEL_TX_BATCH_MAX];
+	struct pktinfo *info[PANEL_TX_BATCH_MAX];
+	int count;
+};
+
+static int panel_flush_tx_batch(struct panel_device *panel,
+		struct panel_tx_batch *batch)
+{
+	int ret;
+
+	if (!batch->count)
+		return 0;
+
+	ret = panel->mipi_drv.write_batch(panel->dsi_id,
+			batch->cmds, batch->count);
+	if (ret != batch->count) {
+		panel_err("%s, failed to send %d packets from %s (ret %d)\n",
+				__func__, batch->count, batch->info[0]->name, ret);
+		batch->count = 0;
+		return -EINVAL;
+	}
+	batch->count = 0;
+
+	return 0;
+}
+
+static int panel_queue_tx_packet(struct panel_device *panel,
+		struct panel_tx_batch *batch, struct pktinfo *info)
+{
+	int i, ret;
+
+	if (unlikely(!info))
+		return -EINVAL;
+
+	if (!panel->mipi_drv.write_batch || info->type != DSI_PKT_TYPE_WR) {
+		ret = panel_flush_tx_batch(panel, batch);
+		if (ret < 0)
+			return ret;
+		return panel_do_tx_packet(panel, info);
+	}
+
+	/* a packet updated again must not overwrite its queued data */
+	for (i = 0; i < batch->count; i++)
+		if (batch->info[i] == info)
+			break;
+
+	if (i < batch->count || batch->count == PANEL_TX_BATCH_MAX) {
+		ret = panel_flush_tx_batch(panel, batch);
+		if (ret < 0)
+			return ret;
+	}
+
+	if (info->pktui)
+		panel_update_packet_data(panel, info);
+
+	batch->cmds[batch->count].id = MIPI_DSI_WRITE;
+	batch->cmds[batch->count].data = info->data;
+	batch->cmds[batch->count].size = info->dlen;
+	batch->info[batch->count] = info;
+	batch->count++;
+
+	return 0;
+}
+
+static int panel_do_setkey(struct panel_device *panel,
+		struct panel_tx_batch *batch, struct keyinfo *info)
 {
 	struct panel_info *panel_data;
 	bool send_packet = false;
@@ -756,7 +825,7 @@ static int panel_do_setkey(struct panel_device *panel, struct keyinfo *info)
 	}
 
 	if (send_packet) {
-		ret = panel_do_tx_packet(panel, info->packet);
+		ret = panel_queue_tx_packet(panel, batch, info->packet);
 		if (ret < 0) {
 			panel_err("%s failed %s\n", __func__,
 					info->packet->name);
@@ -801,6 +870,7 @@ int panel_do_seqtbl(struct panel_device *panel, struct seqinfo *seqtbl)
 	int i, ret;
 	u32 type;
 	void **cmdtbl;
+	struct panel_tx_batch batch = { .count = 0 };
 
 	if (unlikely(!panel || !seqtbl)) {
 		pr_err("%s, invalid paramter (panel %p, seqtbl %p)\n",
@@ -831,9 +901,19 @@ int panel_do_seqtbl(struct panel_device *panel, struct seqinfo *seqtbl)
 				(((struct cmdinfo *)cmdtbl[i])->name ?
 				((struct cmdinfo *)cmdtbl[i])->name : "none"));
 #endif
+		/* delays, pins, reads and sub-sequences need the queued packets out */
+		if (type != CMD_TYPE_KEY &&
+				(type < CMD_TYPE_TX_PKT_START || type > CMD_TYPE_TX_PKT_END)) {
+			ret = panel_flush_tx_batch(panel, &batch);
+#ifdef CONFIG_SUPPORT_PANEL_SWAP
+			if (ret < 0)
+				return ret;
+#endif
+		}
+
 		switch (type) {
 			case CMD_TYPE_KEY:
-				ret = panel_do_setkey(panel, (struct keyinfo *)cmdtbl[i]);
+				ret = panel_do_setkey(panel, &batch, (struct keyinfo *)cmdtbl[i]);
 				break;
 			case CMD_TYPE_DELAY:
 				ret = panel_do_delay(panel , (struct delayinfo *)cmdtbl[i]);
@@ -845,7 +925,7 @@ int panel_do_seqtbl(struct panel_device *panel, struct seqinfo *seqtbl)
 				ret = panel_do_pinctl(panel, (struct pininfo *)cmdtbl[i]);
 				break;
 			case CMD_TYPE_TX_PKT_START ... CMD_TYPE_TX_PKT_END:
-				ret = panel_do_tx_packet(panel, (struct pktinfo *)cmdtbl[i]);
+				ret = panel_queue_tx_packet(panel, &batch, (struct pktinfo *)cmdtbl[i]);
 				break;
 			case CMD_TYPE_RES:
 				ret = panel_resource_update(panel, (struct resinfo *)cmdtbl[i]);
@@ -882,6 +962,12 @@ int panel_do_seqtbl(struct panel_device *panel, struct seqinfo *seqtbl)
 #endif
 	}
 
+	ret = panel_flush_tx_batch(panel, &batch);
+#ifdef CONFIG_SUPPORT_PANEL_SWAP
+	if (ret < 0)
+		return ret;
+#endif
+
 	return 0;
 }
 
@@ -1088,6 +1088,7 @@ static int panel_ioctl_dsim_ops(struct v4l2_subdev *sd)
 	}
 	panel->mipi_drv.read = mipi_ops->read;
 	panel->mipi_drv.write = mipi_ops->write;
+	panel->mipi_drv.write_batch = mipi_ops->write_batch;
 	panel->mipi_drv.get_state = mipi_ops->get_state;
 
 	return 0;
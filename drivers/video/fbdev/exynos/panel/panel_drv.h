@@ -101,9 +101,18 @@ struct panel_pad {
 	int pend_bit_disp_det;
 };
 
+/* one command of a batched write */
+struct mipi_tx_cmd {
+	u8 id;
+	const u8 *data;
+	u32 size;
+};
+
 struct mipi_drv_ops {
 	int (*read)(u32 id, u8 addr, u8 *buf, int size);
 	int (*write)(u32 id, u8 cmd_id, const u8 *cmd, int size);
+	/* optional, sends all the commands and waits once */
+	int (*write_batch)(u32 id, const struct mipi_tx_cmd *cmds, int count);
 	enum dsim_state(*get_state)(u32 id);
 };
 
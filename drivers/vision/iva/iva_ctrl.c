@@ -348,6 +348,8 @@ const char *iva_ctrl_get_ioctl_str(unsigned int cmd)
 		IOCTL_STR_ENTRY(_IOC_NR(IVA_ION_FREE),			"ION_FREE"),
 		IOCTL_STR_ENTRY(_IOC_NR(IVA_ION_SYNC_FOR_CPU),		"ION_SYNC_FOR_CPU"),
 		IOCTL_STR_ENTRY(_IOC_NR(IVA_ION_SYNC_FOR_DEVICE),	"ION_SYNC_FOR_DEVICE"),
+		IOCTL_STR_ENTRY(_IOC_NR(IVA_IPC_QUEUE_SEND_CMDS),	"IPCQ_SEND_BATCH"),
+		IOCTL_STR_ENTRY(_IOC_NR(IVA_IPC_QUEUE_RECEIVE_RSPS),	"IPCQ_RECEIVE_BATCH"),
 	};
 
 	unsigned int cmd_nr = _IOC_NR(cmd);
@@ -413,6 +415,14 @@ static long iva_ctrl_ioctl(struct file *filp, unsigned int cmd, unsigned long ar
 		ret = iva_ipcq_wait_res_usr(&iva->mcu_ipcq,
 				(struct ipc_res_param __user *) p);
 		break;
+	case IVA_IPC_QUEUE_SEND_CMDS:
+		ret = iva_ipcq_send_cmds_usr(&iva->mcu_ipcq,
+				(struct iva_ipcq_batch __user *) p);
+		break;
+	case IVA_IPC_QUEUE_RECEIVE_RSPS:
+		ret = iva_ipcq_wait_rsps_usr(&iva->mcu_ipcq,
+				(struct iva_ipcq_batch __user *) p);
+		break;
 #ifdef ENABLE_MBOX_SEND_IOCTL
 	case IVA_MBOX_SEND_MSG:
 		ret = iva_mbox_send_mail_to_mcu_usr(iva, (uint32_t __user *) p);
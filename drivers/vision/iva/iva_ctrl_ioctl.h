@@ -36,6 +36,11 @@
 #define IVA_ION_SYNC_FOR_CPU		_IOWR(IVA_CTRL_MAGIC, 11, struct iva_ion_param)
 #define IVA_ION_SYNC_FOR_DEVICE		_IOWR(IVA_CTRL_MAGIC, 12, struct iva_ion_param)
 
+#define IVA_IPC_QUEUE_SEND_CMDS		_IOWR(IVA_CTRL_MAGIC, 13, struct iva_ipcq_batch)
+#define IVA_IPC_QUEUE_RECEIVE_RSPS	_IOWR(IVA_CTRL_MAGIC, 14, struct iva_ipcq_batch)
+
+#define IVA_IPCQ_BATCH_MAX		(16)
+
 /* for iva_ion struct */
 struct iva_ion_param {
 	int 		ion_client_fd;
@@ -46,4 +51,15 @@ struct iva_ion_param {
 	unsigned int	cacheflag;
 };
 
+/*
+ * for ipcq batch: @params points to @num ipc_cmd_param (send) or
+ * ipc_res_param (receive). on receive, @num is updated with the number
+ * of responses actually copied.
+ */
+struct iva_ipcq_batch {
+	unsigned int	num;
+	unsigned int	reserved;
+	uint64_t	params;	/* fix to 64 bit */
+};
+
 #endif /* _IVA_CTRL_IOCRL_H_ */
@@ -897,6 +897,106 @@ int iva_ipcq_wait_res_usr(struct iva_ipcq *ipcq,
 	return ret;
 }
 
+static int iva_ipcq_get_batch_usr(struct iva_ipcq *ipcq,
+		struct iva_ipcq_batch __user *batch_usr,
+		struct iva_ipcq_batch *batch)
+{
+	struct device *dev = ipcq->iva_data->dev;
+
+	if (!batch_usr) {
+		dev_err(dev, "%s() null from user\n", __func__);
+		return -EINVAL;
+	}
+
+	if (copy_from_user(batch, batch_usr, sizeof(*batch)))
+		return -EFAULT;
+
+	if (!batch->num || batch->num > IVA_IPCQ_BATCH_MAX) {
+		dev_err(dev, "%s() invalid batch num(%u)\n",
+				__func__, batch->num);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* several commands in one ioctl, each still goes out as its own mail */
+int iva_ipcq_send_cmds_usr(struct iva_ipcq *ipcq,
+			struct iva_ipcq_batch __user *batch_usr)
+{
+	struct iva_ipcq_batch	batch;
+	struct ipc_cmd_param __user *c_params;
+	unsigned int		i;
+	int			ret;
+
+	ret = iva_ipcq_get_batch_usr(ipcq, batch_usr, &batch);
+	if (ret)
+		return ret;
+
+	c_params = (struct ipc_cmd_param __user *)
+			(uintptr_t) batch.params;
+	for (i = 0; i < batch.num; i++) {
+		ret = iva_ipcq_send_cmd_usr(ipcq, c_params + i);
+		if (ret) {
+			dev_err(ipcq->iva_data->dev,
+				"%s() fail to send cmd %u/%u, ret(%d)\n",
+				__func__, i, batch.num, ret);
+			break;
+		}
+	}
+
+	/* the first i commands are on their way, user must not resend them */
+	if (i != batch.num && put_user(i, &batch_usr->num))
+		return -EFAULT;
+
+	return ret;
+}
+
+static bool iva_ipcq_has_pending_rsp(struct iva_ipcq *ipcq)
+{
+	unsigned long	flags;
+	bool		pending;
+
+	spin_lock_irqsave(&ipcq->ipcq_slock, flags);
+	pending = !list_empty(&ipcq->ipcq_pend_list);
+	spin_unlock_irqrestore(&ipcq->ipcq_slock, flags);
+
+	return pending;
+}
+
+/*
+ * block for the first response like IVA_IPC_QUEUE_RECEIVE_RSP, then hand
+ * back whatever else is already pending without waiting again.
+ */
+int iva_ipcq_wait_rsps_usr(struct iva_ipcq *ipcq,
+			struct iva_ipcq_batch __user *batch_usr)
+{
+	struct iva_ipcq_batch	batch;
+	struct ipc_res_param __user *r_params;
+	unsigned int		i;
+	int			ret;
+
+	ret = iva_ipcq_get_batch_usr(ipcq, batch_usr, &batch);
+	if (ret)
+		return ret;
+
+	r_params = (struct ipc_res_param __user *)
+			(uintptr_t) batch.params;
+	for (i = 0; i < batch.num; i++) {
+		if (i && !iva_ipcq_has_pending_rsp(ipcq))
+			break;
+
+		ret = iva_ipcq_wait_res_usr(ipcq, r_params + i);
+		if (ret < 0)
+			break;
+	}
+
+	if (put_user(i, &batch_usr->num))
+		return -EFAULT;
+
+	return i ? 0 : ret;
+}
+
 int iva_ipcq_send_rsp_k(struct iva_ipcq *ipcq,
 		struct ipc_res_param *res_param, bool from_irq)
 {
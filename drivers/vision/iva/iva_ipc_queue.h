@@ -12,6 +12,7 @@
 
 #include "iva_ipc_param.h"
 #include "iva_ctrl.h"
+#include "iva_ctrl_ioctl.h"
 
 struct iva_ipcq_trans {
 	struct list_head	node;
@@ -29,6 +30,10 @@ extern int	iva_ipcq_send_cmd_usr(struct iva_ipcq *ipcq,
 
 extern int	iva_ipcq_wait_res_usr(struct iva_ipcq *ipcq,
 			struct ipc_res_param __user *r_param);
+extern int	iva_ipcq_send_cmds_usr(struct iva_ipcq *ipcq,
+			struct iva_ipcq_batch __user *batch);
+extern int	iva_ipcq_wait_rsps_usr(struct iva_ipcq *ipcq,
+			struct iva_ipcq_batch __user *batch);
 extern int	iva_ipcq_send_rsp_k(struct iva_ipcq *ipcq,
 			struct ipc_res_param *res_param, bool from_irq);
 
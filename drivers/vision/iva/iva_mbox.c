@@ -272,21 +272,33 @@ out:
 	return ret;
 }
 
+/*
+ * there is a single message register, so each pass takes the mail the
+ * mcu has posted again by the time the previous one was consumed, rather
+ * than returning and taking another interrupt for it. bounded so that a
+ * misbehaving mcu cannot keep us here.
+ */
+#define IVA_MBOX_MAX_MAILS_PER_IRQ	(4)
+
 static inline void __iva_mbox_handle_irq(struct iva_dev_data *iva)
 {
-	uint32_t msg;
+	uint32_t	msg;
+	int		i;
 
-	if (!iva_mbox_pending_mail_from_mcu(iva))
-		return;
+	for (i = 0; i < IVA_MBOX_MAX_MAILS_PER_IRQ; i++) {
+		if (!iva_mbox_pending_mail_from_mcu(iva))
+			return;
 
-	/* read msg and clear intr */
-	msg = iva_mbox_read_mail_from_mcu(iva);
-	iva_mbox_clear_pending_mail_from_mcu(iva);
+		/* read msg and clear intr */
+		msg = iva_mbox_read_mail_from_mcu(iva);
+		iva_mbox_clear_pending_mail_from_mcu(iva);
 
-	dev_dbg(iva->dev, "%s() iva(%p) cb->msg(0x%x)\n", __func__, iva, msg);
+		dev_dbg(iva->dev, "%s() iva(%p) cb->msg(0x%x)\n",
+				__func__, iva, msg);
 
-	/* transfer it to customer */
-	iva_mbox_call_cb_chain(msg);
+		/* transfer it to customer */
+		iva_mbox_call_cb_chain(msg);
+	}
 }
 
 
@@ -20,6 +20,8 @@
  */
 #define SCORE_MAX_VERTEX			(256)
 #define SCORE_MAX_FRAME				(128)
+/* requests a pipelined context may keep outstanding */
+#define SCORE_MAX_QUEUE_DEPTH			(8)
 
 #define SCORE_MAX_BUFFER			(16)
 #define SCORE_MAX_PLANE				(3)
@@ -17,5 +17,7 @@
 
 #define SCORE_CTRL_FWCHECK			(VISION_CTRL_SCORE_BASE + 1)
 #define SCORE_CTRL_FWCHANGE			(VISION_CTRL_SCORE_BASE + 2)
+#define SCORE_CTRL_QUEUE_DEPTH			(VISION_CTRL_SCORE_BASE + 3)
+#define SCORE_CTRL_SYNC_HINTS			(VISION_CTRL_SCORE_BASE + 4)
 
 #endif
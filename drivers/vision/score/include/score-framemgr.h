@@ -43,6 +43,8 @@ struct score_frame {
 	u32				state;
 	int				message;
 	struct vb_buffer		buffer;
+	/* VS4L_MEMORY_* of buffer, so it can be unprepared without a clist */
+	u32				memory;
 	u32				vid;
 	u32				fid;
 
@@ -54,6 +54,17 @@ enum score_memory_sync_type {
 	SCORE_MEMORY_SYNC_FOR_NONE
 };
 
+/*
+ * hints passed by user in sc_host_buffer.reserved, only read once user
+ * enabled them with SCORE_CTRL_SYNC_HINTS
+ */
+/* CPU has not written the buffer since its last DSP use */
+#define SCORE_MEMORY_FLAG_CPU_CLEAN		(1 << 0)
+/* DSP only reads the buffer */
+#define SCORE_MEMORY_FLAG_DSP_READONLY		(1 << 1)
+#define SCORE_MEMORY_FLAG_MASK			(SCORE_MEMORY_FLAG_CPU_CLEAN | \
+						SCORE_MEMORY_FLAG_DSP_READONLY)
+
 struct score_memory_buffer {
 	u32				fid;
 	struct list_head		list;
@@ -62,6 +73,9 @@ struct score_memory_buffer {
 		int			fd;
 	} m;
 	unsigned int			memory_type;
+	unsigned int			flags;
+	/* last sync, enum score_memory_sync_type */
+	unsigned int			owner;
 
 	dma_addr_t			dvaddr;
 	void				*kvaddr;
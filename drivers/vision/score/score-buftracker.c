@@ -240,6 +240,47 @@ int score_buftracker_remove_userptr_all(struct score_buftracker *buftracker)
 	return ret;
 }
 
+/*
+ * Is the same memory already synced for sync_for through another entry?
+ * For the device any outstanding task counts, as the CPU must not write a
+ * buffer the DSP owns; for the CPU only the same task does.
+ */
+static bool __score_buftracker_userptr_synced(struct score_buftracker *buftracker,
+		struct score_memory_buffer *buf, int sync_for)
+{
+	struct score_memory_buffer *target_buf;
+
+	list_for_each_entry(target_buf, &buftracker->userptr_list, list) {
+		if (target_buf == buf || target_buf->owner != sync_for)
+			continue;
+
+		if (sync_for == SCORE_MEMORY_SYNC_FOR_CPU &&
+				target_buf->fid != buf->fid)
+			continue;
+
+		if (target_buf->m.userptr == buf->m.userptr &&
+				target_buf->size >= buf->size)
+			return true;
+	}
+
+	return false;
+}
+
+void score_buftracker_sync_userptr_for_device(struct score_buftracker *buftracker,
+		struct score_memory_buffer *buf)
+{
+	bool skip;
+
+	skip = (buf->flags & SCORE_MEMORY_FLAG_CPU_CLEAN) ||
+		__score_buftracker_userptr_synced(buftracker, buf,
+				SCORE_MEMORY_SYNC_FOR_DEVICE);
+	buf->owner = SCORE_MEMORY_SYNC_FOR_DEVICE;
+
+	if (!skip)
+		score_memory_invalid_or_flush_userptr(buf,
+				SCORE_MEMORY_SYNC_FOR_DEVICE, DMA_TO_DEVICE);
+}
+
 void score_buftracker_invalid_or_flush_userptr_fid_all(struct score_buftracker *buftracker,
 		int fid, int sync_for, enum dma_data_direction dir)
 {
@@ -248,9 +289,20 @@ void score_buftracker_invalid_or_flush_userptr_fid_all(struct score_buftracker *
 
 	list_for_each_entry_safe(buf, temp_buf,
 			&buftracker->userptr_list, list) {
-		if (buf->fid == fid) {
-			score_memory_invalid_or_flush_userptr(buf, sync_for, dir);
+		if (buf->fid != fid)
+			continue;
+
+		/* nothing to invalidate if the DSP did not write it */
+		if (sync_for == SCORE_MEMORY_SYNC_FOR_CPU &&
+				((buf->flags & SCORE_MEMORY_FLAG_DSP_READONLY) ||
+				 __score_buftracker_userptr_synced(buftracker,
+					 buf, sync_for))) {
+			buf->owner = sync_for;
+			continue;
 		}
+
+		score_memory_invalid_or_flush_userptr(buf, sync_for, dir);
+		buf->owner = sync_for;
 	}
 }
 
@@ -48,6 +48,8 @@ int score_buftracker_remove_userptr(struct score_buftracker *buftracker,
 		struct score_memory_buffer *buffer);
 int score_buftracker_remove_userptr_all(struct score_buftracker *buftracker);
 
+void score_buftracker_sync_userptr_for_device(struct score_buftracker *buftracker,
+		struct score_memory_buffer *buf);
 void score_buftracker_invalid_or_flush_userptr_fid_all(struct score_buftracker *buftracker,
 		int fid, int sync_for, enum dma_data_direction dir);
 void score_buftracker_invalid_or_flush_userptr_all(struct score_buftracker *buftracker,
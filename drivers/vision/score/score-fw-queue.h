@@ -122,7 +122,7 @@ struct sc_host_buffer {
 		unsigned long	userptr;
 	} m;
 	int offset;
-	int reserved;
+	int reserved;	/* SCORE_MEMORY_FLAG_* with SCORE_CTRL_SYNC_HINTS */
 };
 
 struct sc_packet_buffer {
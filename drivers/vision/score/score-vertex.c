@@ -309,17 +309,13 @@ static int __score_buf_unprepare(struct score_vertex_ctx *vctx,
 {
 	int ret = 0;
 	struct score_memory *memory;
-	struct vs4l_container *container;
-	struct vs4l_buffer *userbuf;
 	struct vb_buffer *kbuf;
 	struct score_ipc_packet *packet;
 
 	memory = vctx->memory;
-	container = clist->containers;
-	userbuf = &container[0].buffers[0];
 	kbuf = &frame->buffer;
 
-	switch (container->memory) {
+	switch (frame->memory) {
 		case VS4L_MEMORY_DMABUF:
 			ret = __score_buf_unmap_dmabuf(memory, kbuf);
 			if (ret) {
@@ -431,6 +427,7 @@ static int score_vctx_queue(struct score_vertex_ctx *vctx,
 		iframe->vid = frame->vid;
 		iframe->fid = frame->fid;
 	}
+	frame->memory = clist->containers[0].memory;
 
 	ret = __score_buf_prepare(vctx, frame, clist);
 	if (ret)
@@ -592,6 +589,8 @@ static struct score_vertex_ctx *score_vctx_create(struct score_vertex *vertex,
 	vctx->vertex = vertex;
 	vctx->memory = memory;
 	vctx->vops = &score_vctx_ops;
+	vctx->depth = 1;
+	vctx->inflight = 0;
 	mutex_init(&vctx->lock);
 	atomic_set(&vctx->refcount, 0);
 
@@ -660,7 +659,24 @@ static int score_vertex_s_ctrl(struct file *file, struct vs4l_ctrl *ctrl)
 		return -ERESTARTSYS;
 	}
 
-	ret = score_system_runtime_update(system);
+	switch (ctrl->ctrl) {
+	case SCORE_CTRL_QUEUE_DEPTH:
+		if (!ctrl->value || ctrl->value > SCORE_MAX_QUEUE_DEPTH ||
+				ctrl->value < vctx->inflight) {
+			score_verr("invalid queue depth (%d, inflight:%d)\n",
+					vctx, ctrl->value, vctx->inflight);
+			ret = -EINVAL;
+			break;
+		}
+		vctx->depth = ctrl->value;
+		break;
+	case SCORE_CTRL_SYNC_HINTS:
+		vctx->sync_hints = !!ctrl->value;
+		break;
+	default:
+		ret = score_system_runtime_update(system);
+		break;
+	}
 
 	mutex_unlock(lock);
 	return ret;
@@ -680,6 +696,11 @@ static int score_vertex_qbuf(struct file *file, struct vs4l_container_list *clis
 		return -ERESTARTSYS;
 	}
 
+	if (vctx->depth > 1 && vctx->inflight >= vctx->depth) {
+		ret = -EBUSY;
+		goto p_err_start;
+	}
+
 	ret = score_device_start(device);
 	if (ret)
 		goto p_err_start;
@@ -692,6 +713,16 @@ static int score_vertex_qbuf(struct file *file, struct vs4l_container_list *clis
 		goto p_err_queue;
 	}
 
+	/*
+	 * Pipelined context: clist->index carries the request back to user,
+	 * the reference taken above is dropped when dqbuf collects it.
+	 */
+	if (vctx->depth > 1) {
+		vctx->inflight++;
+		mutex_unlock(lock);
+		return ret;
+	}
+
 	vctx->blocking = file->f_flags & O_NONBLOCK;
 	CALL_VOPS(vctx, deque, clist);
 	CALL_VOPS(vctx, put);
@@ -712,6 +743,43 @@ p_err_start:
 static int score_vertex_dqbuf(struct file *file, struct vs4l_container_list *clist)
 {
 	int ret = 0;
+	struct score_vertex_ctx *vctx = file->private_data;
+	struct score_vertex *vertex = vctx->vertex;
+	struct score_device *device = container_of(vertex, struct score_device, vertex);
+	struct score_framemgr *framemgr = &vctx->framemgr;
+	struct score_frame *frame;
+	struct mutex *lock = &vctx->lock;
+
+	if (mutex_lock_interruptible(lock)) {
+		score_verr("mutex_lock_interruptible is fail \n", vctx);
+		return -ERESTARTSYS;
+	}
+
+	if (!vctx->inflight) {
+		ret = -ENODATA;
+		goto p_err;
+	}
+
+	score_frame_g_entire(framemgr, vctx->id, clist->index, &frame);
+	if (!frame) {
+		score_verr("No frame matching with id (clist:%d)\n",
+				vctx, clist->index);
+		ret = -ENODATA;
+		goto p_err;
+	}
+
+	if ((file->f_flags & O_NONBLOCK) && !score_frame_done(frame)) {
+		ret = -EAGAIN;
+		goto p_err;
+	}
+
+	vctx->blocking = 0;
+	ret = CALL_VOPS(vctx, deque, clist);
+	vctx->inflight--;
+	CALL_VOPS(vctx, put);
+	score_device_stop(device);
+p_err:
+	mutex_unlock(lock);
 	return ret;
 }
 
@@ -788,12 +856,38 @@ static int score_vertex_close(struct file *file)
 	struct score_vertex *vertex = vctx->vertex;
 	struct score_device *device = container_of(vertex, struct score_device, vertex);
 	struct mutex *lock = &vertex->lock;
+	struct vs4l_container_list clist;
+	struct score_frame *frame;
+	unsigned long flags;
 
 	if (mutex_lock_interruptible(lock)) {
 		score_verr("mutex_lock_interruptible is fail \n", vctx);
 		return -ERESTARTSYS;
 	}
 
+	/*
+	 * Requests never collected by dqbuf are dequeued as dqbuf would, so
+	 * the firmware is done with their iframes before vctx goes away. The
+	 * wait in deque drops vctx->lock while it sleeps.
+	 */
+	mutex_lock(&vctx->lock);
+	vctx->blocking = 0;
+	for (; vctx->inflight; vctx->inflight--) {
+		spin_lock_irqsave(&vctx->framemgr.slock, flags);
+		frame = list_first_entry_or_null(&vctx->framemgr.entire_list,
+				struct score_frame, list);
+		spin_unlock_irqrestore(&vctx->framemgr.slock, flags);
+
+		if (frame) {
+			memset(&clist, 0, sizeof(clist));
+			clist.index = frame->fid;
+			CALL_VOPS(vctx, deque, &clist);
+		}
+		CALL_VOPS(vctx, put);
+		score_device_stop(device);
+	}
+	mutex_unlock(&vctx->lock);
+
 	score_vertexmgr_vctx_unregister(&device->vertexmgr, vctx);
 	score_vctx_destroy(vctx);
 	__vref_put(&vertex->open_cnt);
@@ -803,6 +897,24 @@ static int score_vertex_close(struct file *file)
 	return ret;
 }
 
+static bool __score_vctx_any_done(struct score_framemgr *framemgr)
+{
+	unsigned long flags;
+	struct score_frame *frame;
+	bool done = false;
+
+	spin_lock_irqsave(&framemgr->slock, flags);
+	list_for_each_entry(frame, &framemgr->entire_list, list) {
+		if (score_frame_done(frame)) {
+			done = true;
+			break;
+		}
+	}
+	spin_unlock_irqrestore(&framemgr->slock, flags);
+
+	return done;
+}
+
 static unsigned int score_vertex_poll(struct file *file,
 	poll_table *poll)
 {
@@ -820,6 +932,17 @@ static unsigned int score_vertex_poll(struct file *file,
 	poll_wait(file, &framemgr->done_wq, poll);
 
 	events = poll_requested_events(poll);
+	if (vctx->depth > 1) {
+		/* pipelined: readable once a request can be dequeued */
+		if ((events & POLLIN) && __score_vctx_any_done(framemgr))
+			ret |= (POLLIN | POLLRDNORM);
+
+		if ((events & POLLOUT) && vctx->inflight < vctx->depth)
+			ret |= (POLLOUT | POLLWRNORM);
+
+		goto p_err;
+	}
+
 	if (events & POLLIN) {
 		if (!score_bitmap_full(framemgr->fid_map, SCORE_MAX_FRAME)) {
 			ret |= (POLLIN | POLLRDNORM);
@@ -66,6 +66,11 @@ struct score_vertex_ctx {
 	struct score_framemgr		*iframemgr;
 	struct score_buftracker		buftracker;
 	s32				blocking;
+	/* pipelined mode when depth > 1, both under lock */
+	u32				depth;
+	u32				inflight;
+	/* host_buf.reserved carries SCORE_MEMORY_FLAG_* hints, under lock */
+	u32				sync_hints;
 };
 
 int score_vertex_probe(struct score_vertex *vertex, struct device *parent);
@@ -65,6 +65,11 @@ static int __score_vertexmgr_buf_convert(struct score_frame *frame)
 
 				fw_buf = (struct sc_packet_buffer *)(((int *)grp_data) + bitmap_site);
 				dev_buf->memory_type = fw_buf->host_buf.memory_type;
+				/* older users leave reserved uninitialized */
+				dev_buf->flags = vctx->sync_hints ?
+					(fw_buf->host_buf.reserved &
+					 SCORE_MEMORY_FLAG_MASK) : 0;
+				dev_buf->owner = SCORE_MEMORY_SYNC_FOR_NONE;
 
 				switch (dev_buf->memory_type) {
 				case VS4L_MEMORY_DMABUF:
@@ -93,9 +98,8 @@ static int __score_vertexmgr_buf_convert(struct score_frame *frame)
 					fw_buf->buf.addr = (unsigned int)dev_buf->dvaddr +
 						fw_buf->host_buf.offset;
 
-					score_memory_invalid_or_flush_userptr(dev_buf,
-							SCORE_MEMORY_SYNC_FOR_DEVICE,
-							DMA_TO_DEVICE);
+					score_buftracker_sync_userptr_for_device(buftracker,
+							dev_buf);
 					break;
 				default:
 					score_ferr("Invalid memory type (%d)\n", frame, ret);
@@ -310,6 +314,9 @@ static void score_interface_thread(struct kthread_work *work)
 	wake_up(&framemgr->done_wq);
 	CALL_VOPS(vctx, put);
 
+	/* a pipelined context may have requests parked on a full fw queue */
+	score_vertexmgr_queue_pending_frame(vctx->vertexmgr);
+
 p_err:
 	return;
 }
@@ -8,6 +8,9 @@
  * published by the Free Software Foundation.
  */
 
+#ifndef VPU_TIME_H_
+#define VPU_TIME_H_
+
 #include <linux/types.h>
 #include <linux/time.h>
 #include <linux/ktime.h>
@@ -26,6 +29,18 @@ struct vpu_time {
 	struct timeval		time;
 };
 
+struct vpu_time_stat {
+	u32			count;
+	u32			recent_us;
+	u32			max_us;
+	u64			total_us;
+};
+
 void vpu_get_timestamp(struct vpu_time *time);
+void vpu_time_stat_add(struct vpu_time_stat *stat,
+	struct vpu_time *start, struct vpu_time *end);
+u32 vpu_time_stat_avg(struct vpu_time_stat *stat);
+
+#define VPU_TIME_IN_US(v)	((v).time.tv_sec * 1000000 + (v).time.tv_usec)
 
-#define VPU_TIME_IN_US(v)	((v).time.tv_sec * 1000000 + (v).time.tv_usec)
\ No newline at end of file
+#endif
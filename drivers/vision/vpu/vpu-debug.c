@@ -386,8 +386,9 @@ static int vpu_debug_grp_show(struct seq_file *s, void *unused)
 	seq_printf(s, "------------------------------------------"
 			"----------------------------------------"
 			"--------------------------------------\n");
-	seq_printf(s, "%7.s %7.s %7.s %7.s %7.s %7.s %7.s\n",
-			"graph", "prio", "period", "input", "done", "cancel", "recent");
+	seq_printf(s, "%7.s %7.s %7.s %7.s %7.s %7.s %7.s %7.s %7.s\n",
+			"graph", "prio", "period", "input", "done", "cancel", "recent",
+			"lat_avg", "lat_max");
 	seq_printf(s, "------------------------------------------"
 			"----------------------------------------"
 			"--------------------------------------\n");
@@ -399,9 +400,10 @@ static int vpu_debug_grp_show(struct seq_file *s, void *unused)
 		if (!graph)
 			continue;
 
-		seq_printf(s, "%2d(%3d) %7d %7d %7d %7d %7d %7d\n",
+		seq_printf(s, "%2d(%3d) %7d %7d %7d %7d %7d %7d %7d %7d\n",
 			graph->id, graph->uid, graph->priority, graph->period_ticks,
-			graph->input_cnt, graph->done_cnt, graph->cancel_cnt, graph->recent);
+			graph->input_cnt, graph->done_cnt, graph->cancel_cnt, graph->recent,
+			vpu_time_stat_avg(&graph->latency), graph->latency.max_us);
 	}
 	mutex_unlock(&graphmgr->mlock);
 
@@ -1572,6 +1572,15 @@ int vpu_graph_config(struct vpu_graph *graph, struct vs4l_graph *info)
 
 	memcpy(graph->desc_mtask, graph->desc_utask, graph->size);
 
+	/*
+	 * The firmware switches tasks by task priority at vertex boundaries,
+	 * so only realtime class graphs may run at the top task priority.
+	 */
+	if (graph->priority >= VPU_GRAPH_RT_PRIORITY)
+		graph->desc_mtask->priority = VPUL_TASK_PRIORITY_MIN_VAL;
+	else if (graph->desc_mtask->priority <= VPUL_TASK_PRIORITY_MIN_VAL)
+		graph->desc_mtask->priority = VPUL_TASK_PRIORITY_MIN_VAL + 1;
+
 #ifdef DBG_PRINT_TASK
 	vpu_graph_task_print(graph);
 #endif
@@ -2023,12 +2032,11 @@ p_skip_primitive:
 	frame->param2 = 0;
 	frame->param3 = 0;
 	clear_bit(VS4L_CL_FLAG_TIMESTAMP, &frame->flags);
+	vpu_get_timestamp(&frame->time[VPU_TMP_QUEUE]);
 
 	if ((incl->flags & (1 << VS4L_CL_FLAG_TIMESTAMP)) ||
-		(otcl->flags & (1 << VS4L_CL_FLAG_TIMESTAMP))) {
+		(otcl->flags & (1 << VS4L_CL_FLAG_TIMESTAMP)))
 		set_bit(VS4L_CL_FLAG_TIMESTAMP, &frame->flags);
-		vpu_get_timestamp(&frame->time[VPU_TMP_QUEUE]);
-	}
 
 	vpu_graphmgr_queue(graph->cookie, frame);
 
@@ -2297,9 +2305,11 @@ static int vpu_graph_done(struct vpu_graph *graph, struct vpu_frame *frame)
 		BUG();
 	}
 
-	if (test_bit(VS4L_CL_FLAG_TIMESTAMP, &frame->flags)) {
-		vpu_get_timestamp(&frame->time[VPU_TMP_DONE]);
+	vpu_get_timestamp(&frame->time[VPU_TMP_DONE]);
+	vpu_time_stat_add(&graph->latency, &frame->time[VPU_TMP_QUEUE],
+		&frame->time[VPU_TMP_DONE]);
 
+	if (test_bit(VS4L_CL_FLAG_TIMESTAMP, &frame->flags)) {
 		if (incl->flags & (1 << VS4L_CL_FLAG_TIMESTAMP))
 			memcpy(incl->timestamp, frame->time, sizeof(frame->time));
 
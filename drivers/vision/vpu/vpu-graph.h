@@ -22,6 +22,8 @@
 
 #define VPU_GRAPH_MAX_VERTEX		20
 #define VPU_GRAPH_MAX_PRIORITY		20
+/* graphs at or above this priority are realtime class, e.g. camera preview */
+#define VPU_GRAPH_RT_PRIORITY		16
 #define VPU_GRAPH_MAX_INTERMEDIATE	64
 #define VPU_GRAPH_MAX_LEVEL		20
 #define VPU_GRAPH_STOP_TIMEOUT		(3 * HZ)
@@ -74,6 +76,8 @@ struct vpu_graph {
 	u32				done_cnt;
 	u32				recent;
 	u8				pu_map[VPU_PU_NUMBER];
+	/* queue to done */
+	struct vpu_time_stat		latency;
 
 	const struct vpu_graph_ops	*gops;
 
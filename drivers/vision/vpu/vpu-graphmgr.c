@@ -705,8 +705,12 @@ static void __vpu_graphmgr_sched(struct vpu_graphmgr *graphmgr)
 
 #ifdef VPU_DYNAMIC_RESOURCE
 		ret = CALL_GOPS(graph, get_resource, frame);
-		if (ret)
+		if (ret) {
+			/* keep lower graphs off the resource a realtime one waits for */
+			if (request->priority >= VPU_GRAPH_RT_PRIORITY)
+				break;
 			continue;
+		}
 #endif
 
 		__vpu_gframe_trans_req_to_pro(graphmgr, request);
@@ -755,6 +759,7 @@ static int vpu_time_thread(void *data)
 	struct vpu_gframe *request, *temp1, *temp2;
 	struct vpu_gframe *next, *prev;
 	struct vpu_graph *graph;
+	u32 prio;
 
 	BUG_ON(!graphmgr);
 
@@ -783,10 +788,14 @@ static int vpu_time_thread(void *data)
 				if (--request->ticks > 0)
 					continue;
 
+				/* aging never lifts a graph over the realtime class */
+				prio = (graph->priority >= VPU_GRAPH_RT_PRIORITY) ?
+					VPU_GRAPH_MAX_PRIORITY + 1 : VPU_GRAPH_RT_PRIORITY - 1;
+
 				TIMER_CHECK_POINT(3);
 				vpu_iinfo("priority changed(%d -> %d)\n", graph,
-					request->priority, VPU_GRAPH_MAX_PRIORITY + 1);
-				request->priority = VPU_GRAPH_MAX_PRIORITY + 1;
+					request->priority, prio);
+				request->priority = prio;
 				request->ticks = graph->period_ticks;
 
 				list_del(&request->list);
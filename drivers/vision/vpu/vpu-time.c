@@ -8,9 +8,35 @@
  * published by the Free Software Foundation.
  */
 
+#include <linux/math64.h>
+
 #include "vpu-time.h"
 
 void vpu_get_timestamp(struct vpu_time *time)
 {
 	do_gettimeofday(&time->time);
 }
+
+void vpu_time_stat_add(struct vpu_time_stat *stat,
+	struct vpu_time *start, struct vpu_time *end)
+{
+	long delta;
+
+	delta = VPU_TIME_IN_US(*end) - VPU_TIME_IN_US(*start);
+	if (delta < 0)
+		delta = 0;
+
+	stat->count++;
+	stat->recent_us = delta;
+	stat->total_us += delta;
+	if (delta > stat->max_us)
+		stat->max_us = delta;
+}
+
+u32 vpu_time_stat_avg(struct vpu_time_stat *stat)
+{
+	if (!stat->count)
+		return 0;
+
+	return div_u64(stat->total_us, stat->count);
+}
@@ -81,6 +81,9 @@ static int elf_core_dump(struct coredump_params *cprm);
 #define ELF_PAGEOFFSET(_v) ((_v) & (ELF_MIN_ALIGN-1))
 #define ELF_PAGEALIGN(_v) (((_v) + ELF_MIN_ALIGN - 1) & ~(ELF_MIN_ALIGN - 1))
 
+/* Upper bound on the text read ahead at exec time, per segment */
+#define ELF_EXEC_READAHEAD_MAX	(2UL << 20)
+
 static struct linux_binfmt elf_format = {
 	.module		= THIS_MODULE,
 	.load_binary	= load_elf_binary,
@@ -365,6 +368,17 @@ static unsigned long elf_map(struct file *filep, unsigned long addr,
 	} else
 		map_addr = vm_mmap(filep, addr, size, prot, type, off);
 
+	/*
+	 * The text of the binary and of its interpreter is about to be
+	 * faulted in piecemeal by the startup path; start reading it now so
+	 * that those faults find the pages in the page cache.
+	 */
+	if (!BAD_ADDR(map_addr) && (prot & PROT_EXEC))
+		force_page_cache_readahead(filep->f_mapping, filep,
+				off >> PAGE_SHIFT,
+				min_t(unsigned long, size,
+				      ELF_EXEC_READAHEAD_MAX) >> PAGE_SHIFT);
+
 	return(map_addr);
 }
 
@@ -25,15 +25,43 @@
 #include <linux/namei.h>
 #include "fscrypt_private.h"
 
+/*
+ * Every page of a read bio needs its own XTS tweak, so the pages cannot go
+ * out as a single cipher request. Reuse one request on the inode's tfm for
+ * the whole bio instead of allocating one per page.
+ */
+static int fscrypt_decrypt_bio_page(struct skcipher_request **req,
+				    struct page *page)
+{
+	struct inode *inode = page->mapping->host;
+	struct crypto_skcipher *tfm = inode->i_crypt_info->ci_ctfm;
+
+	if (*req && crypto_skcipher_reqtfm(*req) != tfm) {
+		skcipher_request_free(*req);
+		*req = NULL;
+	}
+	if (!*req)
+		*req = skcipher_request_alloc(tfm, GFP_NOFS);
+	if (!*req)
+		return fscrypt_decrypt_page(inode, page, PAGE_SIZE, 0,
+					    page->index);
+
+	if (!(inode->i_sb->s_cop->flags & FS_CFLG_OWN_PAGES))
+		BUG_ON(!PageLocked(page));
+
+	return fscrypt_do_page_crypto_req(inode, *req, FS_DECRYPT, page->index,
+					  page, page, PAGE_SIZE, 0);
+}
+
 static void __fscrypt_decrypt_bio(struct bio *bio, bool done)
 {
+	struct skcipher_request *req = NULL;
 	struct bio_vec *bv;
 	int i;
 
 	bio_for_each_segment_all(bv, bio, i) {
 		struct page *page = bv->bv_page;
-		int ret = fscrypt_decrypt_page(page->mapping->host, page,
-				PAGE_SIZE, 0, page->index);
+		int ret = fscrypt_decrypt_bio_page(&req, page);
 
 		if (ret) {
 			WARN_ON_ONCE(1);
@@ -44,6 +72,7 @@ static void __fscrypt_decrypt_bio(struct bio *bio, bool done)
 		if (done)
 			unlock_page(page);
 	}
+	skcipher_request_free(req);
 }
 
 void fscrypt_decrypt_bio(struct bio *bio)
@@ -113,6 +113,12 @@ extern int fscrypt_do_page_crypto(const struct inode *inode,
 				  struct page *dest_page,
 				  unsigned int len, unsigned int offs,
 				  gfp_t gfp_flags);
+extern int fscrypt_do_page_crypto_req(const struct inode *inode,
+				      struct skcipher_request *req,
+				      fscrypt_direction_t rw, u64 lblk_num,
+				      struct page *src_page,
+				      struct page *dest_page,
+				      unsigned int len, unsigned int offs);
 extern struct page *fscrypt_alloc_bounce_page(struct fscrypt_ctx *ctx,
 					      gfp_t gfp_flags);
 
@@ -39,6 +39,8 @@
 #include <linux/ratelimit.h>
 #include <linux/list_lru.h>
 #include <linux/kasan.h>
+#include <linux/proc_fs.h>
+#include <linux/seq_file.h>
 
 #include "internal.h"
 #include "mount.h"
@@ -3495,6 +3497,57 @@ static void __init dcache_init(void)
 		INIT_HLIST_BL_HEAD(dentry_hashtable + loop);
 }
 
+#ifdef CONFIG_DCACHE_LOOKUP_STATS
+static void dcache_lookup_show_sb(struct super_block *sb, void *arg)
+{
+	struct seq_file *m = arg;
+	unsigned long count[NR_DLOOKUP_STATS] = { 0 };
+	int cpu, i;
+
+	if (!sb->s_lookup_stats)
+		return;
+
+	for_each_possible_cpu(cpu) {
+		struct dcache_lookup_stats *st;
+
+		st = per_cpu_ptr(sb->s_lookup_stats, cpu);
+		for (i = 0; i < NR_DLOOKUP_STATS; i++)
+			count[i] += st->count[i];
+	}
+
+	seq_printf(m, "%-16s %-10s", sb->s_id, sb->s_type->name);
+	for (i = 0; i < NR_DLOOKUP_STATS; i++)
+		seq_printf(m, " %lu", count[i]);
+	seq_putc(m, '\n');
+}
+
+static int dcache_lookup_show(struct seq_file *m, void *v)
+{
+	seq_puts(m, "# dev fstype rcu_hit ref_hit negative miss unlazy restart\n");
+	iterate_supers(dcache_lookup_show_sb, m);
+	return 0;
+}
+
+static int dcache_lookup_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, dcache_lookup_show, NULL);
+}
+
+static const struct file_operations dcache_lookup_fops = {
+	.open		= dcache_lookup_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init dcache_lookup_stats_init(void)
+{
+	proc_create("fs/dcache_lookup", S_IRUGO, NULL, &dcache_lookup_fops);
+	return 0;
+}
+fs_initcall(dcache_lookup_stats_init);
+#endif
+
 /* SLAB cache for __getname() consumers */
 struct kmem_cache *names_cachep __read_mostly;
 EXPORT_SYMBOL(names_cachep);
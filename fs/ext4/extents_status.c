@@ -112,7 +112,10 @@
  *	next extent, adding a extent(a range of blocks) and removing a extent.
  *
  *   --	race on a extent status tree
- *	Extent status tree is protected by inode->i_es_lock.
+ *	Extent status tree is protected by inode->i_es_lock.  Writers also
+ *	bump inode->i_es_seq, so that ext4_es_lookup_extent() can walk the
+ *	tree under RCU and only falls back to the read lock when it raced
+ *	with a writer.
  *
  *   --	memory consumption
  *      Fragmented extent tree will make extent status tree cost too much
@@ -151,9 +154,11 @@ static int __es_shrink(struct ext4_sb_info *sbi, int nr_to_scan,
 
 int __init ext4_init_es(void)
 {
+	/* lockless lookups may still be reading a freed extent */
 	ext4_es_cachep = kmem_cache_create("ext4_extent_status",
 					   sizeof(struct extent_status),
-					   0, (SLAB_RECLAIM_ACCOUNT), NULL);
+					   0, (SLAB_RECLAIM_ACCOUNT |
+					       SLAB_DESTROY_BY_RCU), NULL);
 	if (ext4_es_cachep == NULL)
 		return -ENOMEM;
 	return 0;
@@ -194,6 +199,26 @@ static void ext4_es_print_tree(struct inode *inode)
 #define ext4_es_print_tree(inode)
 #endif
 
+static inline void es_write_lock(struct ext4_inode_info *ei)
+{
+	write_lock(&ei->i_es_lock);
+	write_seqcount_begin(&ei->i_es_seq);
+}
+
+static inline int es_write_trylock(struct ext4_inode_info *ei)
+{
+	if (!write_trylock(&ei->i_es_lock))
+		return 0;
+	write_seqcount_begin(&ei->i_es_seq);
+	return 1;
+}
+
+static inline void es_write_unlock(struct ext4_inode_info *ei)
+{
+	write_seqcount_end(&ei->i_es_seq);
+	write_unlock(&ei->i_es_lock);
+}
+
 static inline ext4_lblk_t ext4_es_end(struct extent_status *es)
 {
 	BUG_ON(es->es_lblk + es->es_len < es->es_lblk);
@@ -673,7 +698,7 @@ static int __es_insert_extent(struct inode *inode, struct extent_status *newes)
 				  newes->es_pblk);
 	if (!es)
 		return -ENOMEM;
-	rb_link_node(&es->rb_node, parent, p);
+	rb_link_node_rcu(&es->rb_node, parent, p);
 	rb_insert_color(&es->rb_node, &tree->root);
 
 out:
@@ -718,7 +743,7 @@ int ext4_es_insert_extent(struct inode *inode, ext4_lblk_t lblk,
 
 	ext4_es_insert_extent_check(inode, &newes);
 
-	write_lock(&EXT4_I(inode)->i_es_lock);
+	es_write_lock(EXT4_I(inode));
 	err = __es_remove_extent(inode, lblk, end);
 	if (err != 0)
 		goto error;
@@ -731,7 +756,7 @@ retry:
 		err = 0;
 
 error:
-	write_unlock(&EXT4_I(inode)->i_es_lock);
+	es_write_unlock(EXT4_I(inode));
 
 	ext4_es_print_tree(inode);
 
@@ -761,12 +786,45 @@ void ext4_es_cache_extent(struct inode *inode, ext4_lblk_t lblk,
 
 	BUG_ON(end < lblk);
 
-	write_lock(&EXT4_I(inode)->i_es_lock);
+	es_write_lock(EXT4_I(inode));
 
 	es = __es_tree_search(&EXT4_I(inode)->i_es_tree.root, lblk);
 	if (!es || es->es_lblk > end)
 		__es_insert_extent(inode, &newes);
-	write_unlock(&EXT4_I(inode)->i_es_lock);
+	es_write_unlock(EXT4_I(inode));
+}
+
+/*
+ * Walk the tree without i_es_lock. A walk that races with a rotation or
+ * a freed extent lands on extent_status objects only, thanks to
+ * SLAB_DESTROY_BY_RCU; the caller checks i_es_seq before trusting it.
+ */
+static struct extent_status *__es_lookup_rcu(struct ext4_es_tree *tree,
+					     ext4_lblk_t lblk)
+{
+	struct extent_status *es1 = READ_ONCE(tree->cache_es);
+	struct rb_node *node;
+	int depth = 0;
+
+	if (es1 && in_range(lblk, READ_ONCE(es1->es_lblk),
+			    READ_ONCE(es1->es_len)))
+		return es1;
+
+	node = READ_ONCE(tree->root.rb_node);
+	while (node && depth++ < 2 * BITS_PER_LONG) {
+		ext4_lblk_t es_lblk, es_len;
+
+		es1 = rb_entry(node, struct extent_status, rb_node);
+		es_lblk = READ_ONCE(es1->es_lblk);
+		es_len = READ_ONCE(es1->es_len);
+		if (lblk < es_lblk)
+			node = READ_ONCE(node->rb_left);
+		else if (lblk - es_lblk >= es_len)
+			node = READ_ONCE(node->rb_right);
+		else
+			return es1;
+	}
+	return NULL;
 }
 
 /*
@@ -779,17 +837,44 @@ void ext4_es_cache_extent(struct inode *inode, ext4_lblk_t lblk,
 int ext4_es_lookup_extent(struct inode *inode, ext4_lblk_t lblk,
 			  struct extent_status *es)
 {
+	struct ext4_inode_info *ei = EXT4_I(inode);
 	struct ext4_es_tree *tree;
 	struct ext4_es_stats *stats;
 	struct extent_status *es1 = NULL;
 	struct rb_node *node;
+	unsigned int seq;
 	int found = 0;
 
 	trace_ext4_es_lookup_extent_enter(inode, lblk);
 	es_debug("lookup extent in block %u\n", lblk);
 
-	tree = &EXT4_I(inode)->i_es_tree;
-	read_lock(&EXT4_I(inode)->i_es_lock);
+	tree = &ei->i_es_tree;
+	es->es_lblk = es->es_len = es->es_pblk = 0;
+
+	rcu_read_lock();
+	seq = read_seqcount_begin(&ei->i_es_seq);
+	es1 = __es_lookup_rcu(tree, lblk);
+	if (es1) {
+		es->es_lblk = READ_ONCE(es1->es_lblk);
+		es->es_len = READ_ONCE(es1->es_len);
+		es->es_pblk = READ_ONCE(es1->es_pblk);
+	}
+	/*
+	 * Setting the referenced bit is a read-modify-write of es_pblk,
+	 * which needs i_es_lock, so the first hit on an extent since the
+	 * shrinker aged it still goes the locked way.
+	 */
+	if (!read_seqcount_retry(&ei->i_es_seq, seq) &&
+	    (!es1 || ext4_es_is_referenced(es))) {
+		rcu_read_unlock();
+		found = es1 != NULL;
+		stats = &EXT4_SB(inode->i_sb)->s_es_stats;
+		goto out_stats;
+	}
+	rcu_read_unlock();
+
+	es1 = NULL;
+	read_lock(&ei->i_es_lock);
 
 	/* find extent in cache firstly */
 	es->es_lblk = es->es_len = es->es_pblk = 0;
@@ -823,15 +908,21 @@ out:
 		es->es_lblk = es1->es_lblk;
 		es->es_len = es1->es_len;
 		es->es_pblk = es1->es_pblk;
-		if (!ext4_es_is_referenced(es))
-			ext4_es_set_referenced(es);
+		if (!ext4_es_is_referenced(es1))
+			ext4_es_set_referenced(es1);
+	}
+
+	read_unlock(&ei->i_es_lock);
+
+out_stats:
+	if (found) {
+		if (ei->i_es_touch != jiffies)
+			WRITE_ONCE(ei->i_es_touch, jiffies);
 		stats->es_stats_cache_hits++;
 	} else {
 		stats->es_stats_cache_misses++;
 	}
 
-	read_unlock(&EXT4_I(inode)->i_es_lock);
-
 	trace_ext4_es_lookup_extent_exit(inode, es, found);
 	return found;
 }
@@ -962,9 +1053,9 @@ int ext4_es_remove_extent(struct inode *inode, ext4_lblk_t lblk,
 	 * so that we are sure __es_shrink() is done with the inode before it
 	 * is reclaimed.
 	 */
-	write_lock(&EXT4_I(inode)->i_es_lock);
+	es_write_lock(EXT4_I(inode));
 	err = __es_remove_extent(inode, lblk, end);
-	write_unlock(&EXT4_I(inode)->i_es_lock);
+	es_write_unlock(EXT4_I(inode));
 	ext4_es_print_tree(inode);
 	return err;
 }
@@ -997,8 +1088,8 @@ retry:
 		list_move_tail(&ei->i_es_list, &sbi->s_es_list);
 
 		/*
-		 * Normally we try hard to avoid shrinking precached inodes,
-		 * but we will as a last resort.
+		 * Normally we try hard to avoid shrinking precached and hot
+		 * inodes, but we will as a last resort.
 		 */
 		if (!retried && ext4_test_inode_state(&ei->vfs_inode,
 						EXT4_STATE_EXT_PRECACHED)) {
@@ -1006,7 +1097,14 @@ retry:
 			continue;
 		}
 
-		if (ei == locked_ei || !write_trylock(&ei->i_es_lock)) {
+		/* Keep extents of inodes that are being looked up */
+		if (!retried && time_before(jiffies,
+				READ_ONCE(ei->i_es_touch) + EXT4_ES_HOT_AGE)) {
+			nr_skipped++;
+			continue;
+		}
+
+		if (ei == locked_ei || !es_write_trylock(ei)) {
 			nr_skipped++;
 			continue;
 		}
@@ -1017,7 +1115,7 @@ retry:
 		spin_unlock(&sbi->s_es_lock);
 
 		nr_shrunk += es_reclaim_extents(ei, &nr_to_scan);
-		write_unlock(&ei->i_es_lock);
+		es_write_unlock(ei);
 
 		if (nr_to_scan <= 0)
 			goto out;
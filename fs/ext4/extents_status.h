@@ -67,6 +67,13 @@ struct ext4_es_tree {
 	struct extent_status *cache_es;	/* recently accessed extent */
 };
 
+/*
+ * Inodes with a lookup hit in the last EXT4_ES_HOT_AGE are skipped by the
+ * shrinker, the same way as precached inodes, unless nothing else can be
+ * reclaimed.
+ */
+#define EXT4_ES_HOT_AGE		(HZ)
+
 struct ext4_es_stats {
 	unsigned long es_stats_shrunk;
 	unsigned long es_stats_cache_hits;
@@ -2007,6 +2007,59 @@ void ext4_mb_complex_scan_group(struct ext4_allocation_context *ac,
 	ext4_mb_check_limits(ac, e4b, 1);
 }
 
+static inline int ext4_mb_large_request(struct ext4_allocation_context *ac)
+{
+	unsigned int large = EXT4_SB(ac->ac_sb)->s_mb_large_req;
+
+	return large && ac->ac_g_ex.fe_len >= large;
+}
+
+/*
+ * Order a group's largest free chunk must have to be worth scanning
+ * for a large request
+ */
+static inline int ext4_mb_large_order(struct ext4_allocation_context *ac)
+{
+	return min_t(int, fls(ac->ac_g_ex.fe_len) - 1,
+				ac->ac_sb->s_blocksize_bits + 1);
+}
+
+/*
+ * Best fit for large requests: a long enough extent can only start in
+ * one of the chunks of the largest order, so measure the extents from
+ * those and skip the small fragments complex_scan would walk through.
+ */
+static noinline_for_stack
+void ext4_mb_scan_large(struct ext4_allocation_context *ac,
+				struct ext4_buddy *e4b)
+{
+	int order = e4b->bd_info->bb_largest_free_order;
+	struct ext4_free_extent ex;
+	void *buddy;
+	int max, k;
+
+	buddy = order > 0 ? mb_find_buddy(e4b, order, &max) : NULL;
+	if (!buddy) {
+		ext4_mb_complex_scan_group(ac, e4b);
+		return;
+	}
+
+	k = mb_find_next_zero_bit(buddy, max, 0);
+	while (k < max && ac->ac_status == AC_STATUS_CONTINUE) {
+		mb_find_extent(e4b, k << order, ac->ac_g_ex.fe_len, &ex);
+		if (WARN_ON(ex.fe_len <= 0))
+			break;
+		ex.fe_logical = 0xDEADFA11; /* debug value */
+		ext4_mb_measure_extent(ac, &ex, e4b);
+
+		/* chunks merged into this extent are already measured */
+		k = mb_find_next_zero_bit(buddy, max,
+				(ex.fe_start + ex.fe_len + (1 << order) - 1) >> order);
+	}
+
+	ext4_mb_check_limits(ac, e4b, 1);
+}
+
 /*
  * This is a special case for storages like raid5
  * we try to find stripe-aligned chunks for stripe-size-multiple requests
@@ -2102,6 +2155,10 @@ static int ext4_mb_good_group(struct ext4_allocation_context *ac,
 
 		return 1;
 	case 1:
+		/* a large extent needs a large buddy chunk to start in */
+		if (ext4_mb_large_request(ac) &&
+		    grp->bb_largest_free_order < ext4_mb_large_order(ac))
+			return 0;
 		if ((free / fragments) >= ac->ac_g_ex.fe_len)
 			return 1;
 		break;
@@ -2118,6 +2175,42 @@ static int ext4_mb_good_group(struct ext4_allocation_context *ac,
 	return 0;
 }
 
+/*
+ * Start reading the block bitmaps of the @nr groups from @group that
+ * still have to be initialized, so that the scan does not wait for
+ * them one at a time. The buddies are built from them on demand by
+ * ext4_mb_good_group(). Returns the group to continue prefetch from.
+ */
+static ext4_group_t ext4_mb_prefetch(struct super_block *sb,
+		ext4_group_t group, ext4_group_t ngroups, unsigned int nr)
+{
+	struct blk_plug plug;
+
+	blk_start_plug(&plug);
+	while (nr-- > 0) {
+		struct ext4_group_desc *gdp = ext4_get_group_desc(sb, group,
+								  NULL);
+		struct ext4_group_info *grp = ext4_get_group_info(sb, group);
+
+		if (gdp && grp && EXT4_MB_GRP_NEED_INIT(grp) &&
+		    !EXT4_MB_GRP_BBITMAP_CORRUPT(grp) &&
+		    ext4_free_group_clusters(sb, gdp) > 0 &&
+		    !(ext4_has_group_desc_csum(sb) &&
+		      (gdp->bg_flags & cpu_to_le16(EXT4_BG_BLOCK_UNINIT)))) {
+			struct buffer_head *bh;
+
+			bh = ext4_read_block_bitmap_nowait(sb, group);
+			if (!IS_ERR_OR_NULL(bh))
+				brelse(bh);
+		}
+		if (++group >= ngroups)
+			group = 0;
+	}
+	blk_finish_plug(&plug);
+
+	return group;
+}
+
 static noinline_for_stack int
 ext4_mb_regular_allocator(struct ext4_allocation_context *ac)
 {
@@ -2185,12 +2278,15 @@ ext4_mb_regular_allocator(struct ext4_allocation_context *ac)
 	 */
 repeat:
 	for (; cr < 4 && ac->ac_status == AC_STATUS_CONTINUE; cr++) {
+		ext4_group_t prefetch_grp;
+
 		ac->ac_criteria = cr;
 		/*
 		 * searching for the right group start
 		 * from the goal value specified
 		 */
 		group = ac->ac_g_ex.fe_group;
+		prefetch_grp = group < ngroups ? group : 0;
 
 		for (i = 0; i < ngroups; group++, i++) {
 			int ret = 0;
@@ -2202,6 +2298,11 @@ repeat:
 			if (group >= ngroups)
 				group = 0;
 
+			/* keep the bitmap reads ahead of the scan */
+			if (sbi->s_mb_prefetch && group == prefetch_grp)
+				prefetch_grp = ext4_mb_prefetch(sb, group,
+						ngroups, sbi->s_mb_prefetch);
+
 			/* This now checks without needing the buddy page */
 			ret = ext4_mb_good_group(ac, group, cr);
 			if (ret <= 0) {
@@ -2235,6 +2336,8 @@ repeat:
 			else if (cr == 1 && sbi->s_stripe &&
 					!(ac->ac_g_ex.fe_len % sbi->s_stripe))
 				ext4_mb_scan_aligned(ac, &e4b);
+			else if (cr == 1 && ext4_mb_large_request(ac))
+				ext4_mb_scan_large(ac, &e4b);
 			else
 				ext4_mb_complex_scan_group(ac, &e4b);
 
@@ -2722,6 +2825,9 @@ int ext4_mb_init(struct super_block *sb)
 	sbi->s_mb_stats = MB_DEFAULT_STATS;
 	sbi->s_mb_stream_request = MB_DEFAULT_STREAM_THRESHOLD;
 	sbi->s_mb_order2_reqs = MB_DEFAULT_ORDER2_REQS;
+	sbi->s_mb_prefetch = MB_DEFAULT_PREFETCH;
+	sbi->s_mb_large_req = (MB_DEFAULT_LARGE_REQ_MB << 20) >>
+			(sb->s_blocksize_bits + sbi->s_cluster_bits);
 	/*
 	 * The default group preallocation is 512, which for 4k block
 	 * sizes translates to 2 megabytes.  However for bigalloc file
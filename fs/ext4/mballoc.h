@@ -89,6 +89,18 @@ extern ushort ext4_mballoc_debug;
  */
 #define MB_DEFAULT_GROUP_PREALLOC	512
 
+/*
+ * number of groups whose block bitmaps are read ahead while scanning,
+ * 0 disables it. Tunable via /sys/fs/ext4/<partition>/mb_prefetch
+ */
+#define MB_DEFAULT_PREFETCH		0
+
+/*
+ * requests of at least this size (in MB) only look at the largest
+ * free buddy chunks of a group, see ext4_mb_scan_large()
+ */
+#define MB_DEFAULT_LARGE_REQ_MB		64
+
 
 struct ext4_free_data {
 	/* this links the free block information from sb_info */
@@ -1173,6 +1173,7 @@ static int block_operations(struct f2fs_sb_info *sbi)
 
 retry_flush_quotas:
 	f2fs_lock_all(sbi);
+	sbi->cp_block_start = ktime_get();
 	if (__need_flush_quota(sbi)) {
 		int locked;
 
@@ -1247,10 +1248,55 @@ out:
 	return err;
 }
 
-static void unblock_operations(struct f2fs_sb_info *sbi)
+static void unblock_operations(struct f2fs_sb_info *sbi,
+						struct cp_control *cpc)
 {
+	unsigned int us;
+
 	up_write(&sbi->node_write);
 	f2fs_unlock_all(sbi);
+
+	us = min_t(s64, ktime_us_delta(ktime_get(), sbi->cp_block_start),
+								UINT_MAX);
+	sbi->cp_blocked_last = us;
+	if (us > sbi->cp_blocked_max)
+		sbi->cp_blocked_max = us;
+	trace_f2fs_cp_blocked(sbi->sb, cpc->reason, us);
+}
+
+/*
+ * Write back the bulk of dirty dentry, inode meta, node and meta pages
+ * while FS operations still run, so that block_operations() only has to
+ * catch up with what got dirtied in the meantime. Errors are left for
+ * block_operations() to hit again and report.
+ */
+static void preflush_operations(struct f2fs_sb_info *sbi)
+{
+	struct writeback_control wbc = {
+		.sync_mode = WB_SYNC_NONE,
+		.nr_to_write = LONG_MAX,
+		.for_reclaim = 0,
+	};
+	struct blk_plug plug;
+
+	if (!sbi->cp_preflush)
+		return;
+
+	blk_start_plug(&plug);
+
+	if (get_pages(sbi, F2FS_DIRTY_DENTS))
+		f2fs_sync_dirty_inodes(sbi, DIR_INODE);
+
+	if (get_pages(sbi, F2FS_DIRTY_IMETA))
+		f2fs_sync_inode_meta(sbi);
+
+	if (get_pages(sbi, F2FS_DIRTY_NODES))
+		f2fs_sync_node_pages(sbi, &wbc, false, FS_CP_NODE_IO);
+
+	if (get_pages(sbi, F2FS_DIRTY_META))
+		f2fs_sync_meta_pages(sbi, META, LONG_MAX, FS_CP_META_IO);
+
+	blk_finish_plug(&plug);
 }
 
 void f2fs_wait_on_all_pages_writeback(struct f2fs_sb_info *sbi)
@@ -1574,6 +1620,10 @@ int f2fs_write_checkpoint(struct f2fs_sb_info *sbi, struct cp_control *cpc)
 		goto out;
 	}
 
+	trace_f2fs_write_checkpoint(sbi->sb, cpc->reason, "start preflush");
+
+	preflush_operations(sbi);
+
 	trace_f2fs_write_checkpoint(sbi->sb, cpc->reason, "start block_ops");
 
 	err = block_operations(sbi);
@@ -1587,7 +1637,7 @@ int f2fs_write_checkpoint(struct f2fs_sb_info *sbi, struct cp_control *cpc)
 	/* this is the case of multiple fstrims without any changes */
 	if (cpc->reason & CP_DISCARD) {
 		if (!f2fs_exist_trim_candidates(sbi, cpc)) {
-			unblock_operations(sbi);
+			unblock_operations(sbi, cpc);
 			goto out;
 		}
 
@@ -1596,7 +1646,7 @@ int f2fs_write_checkpoint(struct f2fs_sb_info *sbi, struct cp_control *cpc)
 				prefree_segments(sbi) == 0) {
 			f2fs_flush_sit_entries(sbi, cpc);
 			f2fs_clear_prefree_segments(sbi, cpc);
-			unblock_operations(sbi);
+			unblock_operations(sbi, cpc);
 			goto out;
 		}
 	}
@@ -1623,7 +1673,7 @@ int f2fs_write_checkpoint(struct f2fs_sb_info *sbi, struct cp_control *cpc)
 	else
 		f2fs_clear_prefree_segments(sbi, cpc);
 stop:
-	unblock_operations(sbi);
+	unblock_operations(sbi, cpc);
 	stat_inc_cp_count(sbi->stat_info);
 
 	if (cpc->reason & CP_RECOVERY)
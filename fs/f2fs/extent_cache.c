@@ -190,6 +190,45 @@ bool f2fs_check_rb_tree_consistence(struct f2fs_sb_info *sbi,
 static struct kmem_cache *extent_tree_slab;
 static struct kmem_cache *extent_node_slab;
 
+/*
+ * Writers hold et->lock and bump et->seq, so that readers can walk the
+ * tree without the lock and retry when they raced. Extent nodes come
+ * from a SLAB_DESTROY_BY_RCU cache: a racing walk only ever lands on
+ * extent nodes, and seq tells whether what it read is usable.
+ */
+static void __drop_lookaside(struct extent_tree *et)
+{
+	int i;
+
+	spin_lock(&et->la_lock);
+	write_seqcount_begin(&et->la_seq);
+	for (i = 0; i < EXTENT_LOOKASIDE_NR; i++)
+		et->la[i].len = 0;
+	write_seqcount_end(&et->la_seq);
+	spin_unlock(&et->la_lock);
+}
+
+static inline void et_write_lock(struct extent_tree *et)
+{
+	write_lock(&et->lock);
+	write_seqcount_begin(&et->seq);
+}
+
+static inline bool et_write_trylock(struct extent_tree *et)
+{
+	if (!write_trylock(&et->lock))
+		return false;
+	write_seqcount_begin(&et->seq);
+	return true;
+}
+
+static inline void et_write_unlock(struct extent_tree *et)
+{
+	__drop_lookaside(et);
+	write_seqcount_end(&et->seq);
+	write_unlock(&et->lock);
+}
+
 static struct extent_node *__attach_extent_node(struct f2fs_sb_info *sbi,
 				struct extent_tree *et, struct extent_info *ei,
 				struct rb_node *parent, struct rb_node **p)
@@ -204,7 +243,7 @@ static struct extent_node *__attach_extent_node(struct f2fs_sb_info *sbi,
 	INIT_LIST_HEAD(&en->list);
 	en->et = et;
 
-	rb_link_node(&en->rb_node, parent, p);
+	rb_link_node_rcu(&en->rb_node, parent, p);
 	rb_insert_color(&en->rb_node, &et->root);
 	atomic_inc(&et->node_cnt);
 	atomic_inc(&sbi->total_ext_node);
@@ -256,6 +295,9 @@ static struct extent_tree *__grab_extent_tree(struct inode *inode)
 		et->root = RB_ROOT;
 		et->cached_en = NULL;
 		rwlock_init(&et->lock);
+		seqcount_init(&et->seq);
+		spin_lock_init(&et->la_lock);
+		seqcount_init(&et->la_seq);
 		INIT_LIST_HEAD(&et->list);
 		atomic_set(&et->node_cnt, 0);
 		atomic_inc(&sbi->total_ext_tree);
@@ -338,7 +380,7 @@ static bool __f2fs_init_extent_tree(struct inode *inode, struct f2fs_extent *i_e
 
 	get_extent_info(&ei, i_ext);
 
-	write_lock(&et->lock);
+	et_write_lock(et);
 	if (atomic_read(&et->node_cnt))
 		goto out;
 
@@ -349,7 +391,7 @@ static bool __f2fs_init_extent_tree(struct inode *inode, struct f2fs_extent *i_e
 		spin_unlock(&sbi->extent_lock);
 	}
 out:
-	write_unlock(&et->lock);
+	et_write_unlock(et);
 	return false;
 }
 
@@ -363,6 +405,127 @@ bool f2fs_init_extent_tree(struct inode *inode, struct f2fs_extent *i_ext)
 	return ret;
 }
 
+static inline bool __extent_covers(struct extent_info *ei, pgoff_t pgofs)
+{
+	return ei->len && ei->fofs <= pgofs && ei->fofs + ei->len > pgofs;
+}
+
+static struct extent_node *__lookup_extent_node_lockless(
+				struct extent_tree *et, unsigned int ofs)
+{
+	struct rb_node *node = READ_ONCE(et->root.rb_node);
+	int depth = 0;
+
+	/* a walk confused by a racing rotation gives up, seq catches it */
+	while (node && depth++ < 2 * BITS_PER_LONG) {
+		struct extent_node *en = rb_entry(node,
+					struct extent_node, rb_node);
+		unsigned int fofs = READ_ONCE(en->ei.fofs);
+		unsigned int len = READ_ONCE(en->ei.len);
+
+		if (ofs < fofs)
+			node = READ_ONCE(node->rb_left);
+		else if (ofs >= fofs + len)
+			node = READ_ONCE(node->rb_right);
+		else
+			return en;
+	}
+	return NULL;
+}
+
+static void __fill_lookaside(struct extent_tree *et,
+				struct extent_info *ei, unsigned int seq)
+{
+	if (!spin_trylock(&et->la_lock))
+		return;
+
+	/* a writer clears the lookaside after us if it started later */
+	if (!read_seqcount_retry(&et->seq, seq)) {
+		write_seqcount_begin(&et->la_seq);
+		et->la[et->la_next] = *ei;
+		et->la_next = (et->la_next + 1) % EXTENT_LOOKASIDE_NR;
+		write_seqcount_end(&et->la_seq);
+	}
+	spin_unlock(&et->la_lock);
+}
+
+/*
+ * Returns 1 on a hit, 0 on a miss and -EAGAIN when a writer raced with
+ * the lookup, in which case the caller retries under et->lock.
+ */
+static int __lookup_extent_tree_lockless(struct f2fs_sb_info *sbi,
+				struct extent_tree *et, pgoff_t pgofs,
+				struct extent_info *ei)
+{
+	struct extent_node *en = NULL;
+	struct extent_info tmp;
+	unsigned int seq;
+	int i, ret = 0;
+
+	seq = read_seqcount_begin(&et->la_seq);
+	for (i = 0; i < EXTENT_LOOKASIDE_NR; i++) {
+		tmp = et->la[i];
+		if (__extent_covers(&tmp, pgofs))
+			break;
+	}
+	if (!read_seqcount_retry(&et->la_seq, seq) &&
+					i < EXTENT_LOOKASIDE_NR) {
+		*ei = tmp;
+		stat_inc_cached_node_hit(sbi);
+		return 1;
+	}
+
+	rcu_read_lock();
+	seq = read_seqcount_begin(&et->seq);
+
+	tmp = et->largest;
+	if (!__extent_covers(&tmp, pgofs)) {
+		en = __lookup_extent_node_lockless(et, pgofs);
+		if (en)
+			tmp = en->ei;
+	}
+
+	if (read_seqcount_retry(&et->seq, seq)) {
+		ret = -EAGAIN;
+		goto out;
+	}
+
+	if (!en && !__extent_covers(&tmp, pgofs))
+		goto out;
+
+	*ei = tmp;
+	ret = 1;
+
+	if (!en) {
+		stat_inc_largest_node_hit(sbi);
+		goto out;
+	}
+
+	if (en == READ_ONCE(et->cached_en))
+		stat_inc_cached_node_hit(sbi);
+	else
+		stat_inc_rbtree_node_hit(sbi);
+
+	__fill_lookaside(et, &tmp, seq);
+
+	/*
+	 * Refreshing the LRU is best effort here. Nodes are only freed
+	 * after being unlinked under extent_lock, so en is still valid
+	 * if seq did not move before we got the lock.
+	 */
+	if (spin_trylock(&sbi->extent_lock)) {
+		if (!read_seqcount_retry(&et->seq, seq) &&
+					!list_empty(&en->list)) {
+			list_move_tail(&en->list, &sbi->extent_list);
+			et->cached_en = en;
+		}
+		spin_unlock(&sbi->extent_lock);
+	}
+out:
+	rcu_read_unlock();
+	return ret;
+}
+
 static bool f2fs_lookup_extent_tree(struct inode *inode, pgoff_t pgofs,
 							struct extent_info *ei)
 {
@@ -370,11 +533,20 @@ static bool f2fs_lookup_extent_tree(struct inode *inode, pgoff_t pgofs,
 	struct extent_tree *et = F2FS_I(inode)->extent_tree;
 	struct extent_node *en;
 	bool ret = false;
+	int err;
 
 	f2fs_bug_on(sbi, !et);
 
 	trace_f2fs_lookup_extent_tree_start(inode, pgofs);
 
+	err = __lookup_extent_tree_lockless(sbi, et, pgofs, ei);
+	if (err != -EAGAIN) {
+		ret = err;
+		stat_inc_total_hit(sbi);
+		trace_f2fs_lookup_extent_tree_end(inode, pgofs, ei);
+		return ret;
+	}
+
 	read_lock(&et->lock);
 
 	if (et->largest.fofs <= pgofs &&
@@ -497,10 +669,10 @@ static void f2fs_update_extent_tree_range(struct inode *inode,
 
 	trace_f2fs_update_extent_tree_range(inode, fofs, blkaddr, len);
 
-	write_lock(&et->lock);
+	et_write_lock(et);
 
 	if (is_inode_flag_set(inode, FI_NO_EXTENT)) {
-		write_unlock(&et->lock);
+		et_write_unlock(et);
 		return;
 	}
 
@@ -606,7 +778,7 @@ static void f2fs_update_extent_tree_range(struct inode *inode,
 		updated = true;
 	}
 
-	write_unlock(&et->lock);
+	et_write_unlock(et);
 
 	if (updated)
 		f2fs_mark_inode_dirty_sync(inode, true);
@@ -631,9 +803,9 @@ unsigned int f2fs_shrink_extent_tree(struct f2fs_sb_info *sbi, int nr_shrink)
 	/* 1. remove unreferenced extent tree */
 	list_for_each_entry_safe(et, next, &sbi->zombie_list, list) {
 		if (atomic_read(&et->node_cnt)) {
-			write_lock(&et->lock);
+			et_write_lock(et);
 			node_cnt += __free_extent_tree(sbi, et);
-			write_unlock(&et->lock);
+			et_write_unlock(et);
 		}
 		f2fs_bug_on(sbi, atomic_read(&et->node_cnt));
 		list_del_init(&et->list);
@@ -663,7 +835,7 @@ free_node:
 		en = list_first_entry(&sbi->extent_list,
 					struct extent_node, list);
 		et = en->et;
-		if (!write_trylock(&et->lock)) {
+		if (!et_write_trylock(et)) {
 			/* refresh this extent node's position in extent list */
 			list_move_tail(&en->list, &sbi->extent_list);
 			continue;
@@ -674,7 +846,7 @@ free_node:
 
 		__detach_extent_node(sbi, et, en);
 
-		write_unlock(&et->lock);
+		et_write_unlock(et);
 		node_cnt++;
 		spin_lock(&sbi->extent_lock);
 	}
@@ -697,9 +869,9 @@ unsigned int f2fs_destroy_extent_node(struct inode *inode)
 	if (!et || !atomic_read(&et->node_cnt))
 		return 0;
 
-	write_lock(&et->lock);
+	et_write_lock(et);
 	node_cnt = __free_extent_tree(sbi, et);
-	write_unlock(&et->lock);
+	et_write_unlock(et);
 
 	return node_cnt;
 }
@@ -715,13 +887,13 @@ void f2fs_drop_extent_tree(struct inode *inode)
 
 	set_inode_flag(inode, FI_NO_EXTENT);
 
-	write_lock(&et->lock);
+	et_write_lock(et);
 	__free_extent_tree(sbi, et);
 	if (et->largest.len) {
 		et->largest.len = 0;
 		updated = true;
 	}
-	write_unlock(&et->lock);
+	et_write_unlock(et);
 	if (updated)
 		f2fs_mark_inode_dirty_sync(inode, true);
 }
@@ -815,8 +987,10 @@ int __init f2fs_create_extent_cache(void)
 			sizeof(struct extent_tree));
 	if (!extent_tree_slab)
 		return -ENOMEM;
-	extent_node_slab = f2fs_kmem_cache_create("f2fs_extent_node",
-			sizeof(struct extent_node));
+	/* lockless readers may still be walking a freed node */
+	extent_node_slab = kmem_cache_create("f2fs_extent_node",
+			sizeof(struct extent_node), 0,
+			SLAB_RECLAIM_ACCOUNT | SLAB_DESTROY_BY_RCU, NULL);
 	if (!extent_node_slab) {
 		kmem_cache_destroy(extent_tree_slab);
 		return -ENOMEM;
@@ -257,6 +257,8 @@ enum {
 #define DEF_MID_DISCARD_ISSUE_TIME	500	/* 500 ms, if device busy */
 #define DEF_MAX_DISCARD_ISSUE_TIME	60000	/* 60 s, if no candidates */
 #define DEF_DISCARD_URGENT_UTIL		80	/* do more discard over 80% */
+#define DEF_DISCARD_DEV_IDLE_TIME	100	/* 100 ms, device idle in batch mode */
+#define DISCARD_LAT_BUCKETS		12	/* log2 ms buckets, up to 1s */
 #define DEF_CP_INTERVAL			60	/* 60 secs */
 #define DEF_IDLE_INTERVAL		5	/* 5 secs */
 #define DEF_DISABLE_INTERVAL		5	/* 5 secs */
@@ -367,6 +369,8 @@ struct discard_cmd {
 	int error;			/* bio error */
 	spinlock_t lock;		/* for state/bio_ref updating */
 	unsigned short bio_ref;		/* bio reference count */
+	u64 issue_time;			/* ns, first bio submitted */
+	u64 done_time;			/* ns, last bio completed */
 };
 
 enum {
@@ -387,6 +391,7 @@ struct discard_policy {
 	bool io_aware;			/* issue discard in idle time */
 	bool sync;			/* submit discard with REQ_SYNC flag */
 	bool ordered;			/* issue discard by lba order */
+	bool dev_idle;			/* wait for the device itself to idle */
 	unsigned int granularity;	/* discard granularity */
 	int timeout;			/* discard timeout for put_super */
 };
@@ -410,6 +415,12 @@ struct discard_cmd_control {
 	atomic_t discard_cmd_cnt;		/* # of cached cmd count */
 	struct rb_root root;			/* root of discard rb-tree */
 	bool rbtree_check;			/* config for consistence check */
+	unsigned int discard_batch;		/* merge, issue on device idle */
+	unsigned int discard_dev_idle;		/* device idle time in ms */
+	atomic64_t lat_total;			/* summed discard latency in us */
+	atomic64_t lat_count;			/* # of completed discards */
+	atomic_t lat_max;			/* worst discard latency in us */
+	atomic_t lat_hist[DISCARD_LAT_BUCKETS];	/* latency histogram */
 };
 
 /* for the list of fsync inodes, used only during recovery */
@@ -641,6 +652,9 @@ struct extent_node {
 	struct extent_tree *et;		/* extent tree pointer */
 };
 
+/* # of recently read extents kept aside of the rb-tree per inode */
+#define EXTENT_LOOKASIDE_NR	4
+
 struct extent_tree {
 	nid_t ino;			/* inode number */
 	struct rb_root root;		/* root of extent info rb-tree */
@@ -648,8 +662,13 @@ struct extent_tree {
 	struct extent_info largest;	/* largested extent info */
 	struct list_head list;		/* to be used by sbi->zombie_list */
 	rwlock_t lock;			/* protect extent info rb-tree */
+	seqcount_t seq;			/* for lockless readers of the tree */
 	atomic_t node_cnt;		/* # of extent node in rb-tree*/
 	bool largest_updated;		/* largest extent updated */
+	spinlock_t la_lock;		/* serializes lookaside updates */
+	seqcount_t la_seq;		/* for lockless readers of lookaside */
+	unsigned int la_next;		/* next lookaside slot to replace */
+	struct extent_info la[EXTENT_LOOKASIDE_NR];	/* recent extents */
 };
 
 /*
@@ -852,6 +871,14 @@ enum nid_state {
 	MAX_NID_STATE,
 };
 
+#define NAT_LRU_LISTS		8	/* shards of the clean nat entry list */
+#define NAT_LAT_BUCKETS		12	/* log2 us buckets, up to 2ms */
+
+struct nat_lru_list {
+	struct list_head entries;	/* cached nat entry list (clean) */
+	spinlock_t lock;		/* protect this list */
+} ____cacheline_aligned_in_smp;
+
 struct f2fs_nm_info {
 	block_t nat_blkaddr;		/* base disk address of NAT */
 	nid_t max_nid;			/* maximum possible node ids */
@@ -859,17 +886,26 @@ struct f2fs_nm_info {
 	nid_t next_scan_nid;		/* the next nid to be scanned */
 	unsigned int ram_thresh;	/* control the memory footprint */
 	unsigned int ra_nid_pages;	/* # of nid pages to be readaheaded */
+	unsigned int ra_nat_pages;	/* # of nat pages readaheaded on sequential misses */
 	unsigned int dirty_nats_ratio;	/* control dirty nats ratio threshold */
 
 	/* NAT cache management */
 	struct radix_tree_root nat_root;/* root of the nat entry cache */
 	struct radix_tree_root nat_set_root;/* root of the nat set cache */
 	struct rw_semaphore nat_tree_lock;	/* protect nat_tree_lock */
-	struct list_head nat_entries;	/* cached nat entry list (clean) */
-	spinlock_t nat_list_lock;	/* protect clean nat entry list */
+	struct nat_lru_list nat_lru[NAT_LRU_LISTS];	/* clean entries, by nid */
+	unsigned int nat_lru_next;	/* next lru list to be shrunk */
 	unsigned int nat_cnt;		/* the # of cached nat entries */
 	unsigned int dirty_nat_cnt;	/* total num of nat entries in set */
 	unsigned int nat_blocks;	/* # of nat blocks */
+	nid_t last_nat_miss;		/* nat block of the last cache miss */
+
+	/* nat lookup latency, collected while nat_lat_stat is set */
+	unsigned int nat_lat_stat;
+	atomic64_t nat_lat_total[2];	/* summed latency in ns, miss/hit */
+	atomic64_t nat_lat_count[2];	/* # of lookups, miss/hit */
+	atomic_t nat_lat_max;		/* worst lookup latency in us */
+	atomic_t nat_lat_hist[NAT_LAT_BUCKETS];	/* latency histogram */
 
 	/* free node ids management */
 	struct radix_tree_root free_nid_root;/* root of the free_nid cache */
@@ -956,13 +992,25 @@ struct flush_cmd {
 	int ret;
 };
 
+#define DEF_FLUSH_MERGE_WINDOW		200	/* us, group commit window */
+#define FLUSH_MERGE_WINDOW_STEP		20	/* us, polling step in a window */
+#define FLUSH_MERGE_BUCKETS		6	/* 1, 2, 3-4, 5-8, 9-16, 17+ */
+
 struct flush_cmd_control {
 	struct task_struct *f2fs_issue_flush;	/* flush thread */
 	wait_queue_head_t flush_wait_queue;	/* waiting queue for wake-up */
 	atomic_t issued_flush;			/* # of issued flushes */
 	atomic_t queued_flush;			/* # of queued flushes */
+	atomic_t active_fsync;			/* fsyncs which may flush soon */
 	struct llist_head issue_list;		/* list for command issue */
 	struct llist_node *dispatch_list;	/* list for command dispatch */
+	unsigned int merge_window;		/* group commit window in us */
+	/* per-window stats, only updated by the flush thread */
+	unsigned long long merge_windows;	/* # of merged flushes issued */
+	unsigned long long merge_waited;	/* # of windows that waited */
+	unsigned long long merge_cmds;		/* # of commands they served */
+	unsigned int merge_max;			/* most commands in a window */
+	unsigned long long merge_hist[FLUSH_MERGE_BUCKETS];
 };
 
 struct f2fs_sm_info {
@@ -1262,6 +1310,10 @@ struct f2fs_sb_info {
 	struct rw_semaphore node_write;		/* locking node writes */
 	struct rw_semaphore node_change;	/* locking node change */
 	wait_queue_head_t cp_wait;
+	unsigned int cp_preflush;		/* flush dirty pages before blocking */
+	ktime_t cp_block_start;			/* when FS operations got blocked */
+	unsigned int cp_blocked_last;		/* blocked time of the last CP in us */
+	unsigned int cp_blocked_max;		/* worst blocked time of a CP in us */
 	unsigned long last_time[MAX_TIME];	/* to store time in jiffies */
 	long interval_time[MAX_TIME];		/* to store thresholds */
 
@@ -3296,6 +3348,7 @@ block_t f2fs_start_bidx_of_node(unsigned int node_ofs, struct inode *inode);
 int f2fs_gc(struct f2fs_sb_info *sbi, bool sync, bool background,
 			unsigned int segno);
 void f2fs_build_gc_manager(struct f2fs_sb_info *sbi);
+void f2fs_update_victim_heap(struct f2fs_sb_info *sbi, unsigned int segno);
 int f2fs_resize_fs(struct f2fs_sb_info *sbi, __u64 block_count);
 
 /*
@@ -3339,6 +3392,7 @@ struct f2fs_stat_info {
 	int rsvd_segs, overp_segs;
 	int dirty_count, node_pages, meta_pages;
 	int prefree_count, call_count, cp_count, bg_cp_count;
+	unsigned int cp_blocked_last, cp_blocked_max;
 	int tot_segs, node_segs, data_segs, free_segs, free_secs;
 	int bg_node_segs, bg_data_segs;
 	int tot_blks, data_blks, node_blks;
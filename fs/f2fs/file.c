@@ -331,9 +331,20 @@ out:
 
 int f2fs_sync_file(struct file *file, loff_t start, loff_t end, int datasync)
 {
-	if (unlikely(f2fs_cp_error(F2FS_I_SB(file_inode(file)))))
+	struct f2fs_sb_info *sbi = F2FS_I_SB(file_inode(file));
+	struct flush_cmd_control *fcc = SM_I(sbi)->fcc_info;
+	int ret;
+
+	if (unlikely(f2fs_cp_error(sbi)))
 		return -EIO;
-	return f2fs_do_sync_file(file, start, end, datasync, false);
+
+	/* lets the flush thread know more flushes may be coming */
+	if (fcc)
+		atomic_inc(&fcc->active_fsync);
+	ret = f2fs_do_sync_file(file, start, end, datasync, false);
+	if (fcc)
+		atomic_dec(&fcc->active_fsync);
+	return ret;
 }
 
 static pgoff_t __get_first_dirty_index(struct address_space *mapping,
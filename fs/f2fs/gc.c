@@ -135,6 +135,17 @@ int f2fs_start_gc_thread(struct f2fs_sb_info *sbi)
 	gc_th->no_gc_sleep_time = DEF_GC_THREAD_NOGC_SLEEP_TIME;
 
 	gc_th->gc_wake= 0;
+	gc_th->gc_workers = DEF_GC_THREAD_WORKERS;
+
+	/* unbound, so its cpumask can be set to the little cores in sysfs */
+	gc_th->gc_wq = alloc_workqueue("f2fs_gc-%u:%u",
+				WQ_UNBOUND | WQ_FREEZABLE | WQ_SYSFS, 0,
+				MAJOR(dev), MINOR(dev));
+	if (!gc_th->gc_wq) {
+		kvfree(gc_th);
+		err = -ENOMEM;
+		goto out;
+	}
 
 	sbi->gc_thread = gc_th;
 	init_waitqueue_head(&sbi->gc_thread->gc_wait_queue_head);
@@ -142,6 +153,7 @@ int f2fs_start_gc_thread(struct f2fs_sb_info *sbi)
 			"f2fs_gc-%u:%u", MAJOR(dev), MINOR(dev));
 	if (IS_ERR(gc_th->f2fs_gc_task)) {
 		err = PTR_ERR(gc_th->f2fs_gc_task);
+		destroy_workqueue(gc_th->gc_wq);
 		kvfree(gc_th);
 		sbi->gc_thread = NULL;
 	}
@@ -155,6 +167,7 @@ void f2fs_stop_gc_thread(struct f2fs_sb_info *sbi)
 	if (!gc_th)
 		return;
 	kthread_stop(gc_th->f2fs_gc_task);
+	destroy_workqueue(gc_th->gc_wq);
 	kvfree(gc_th);
 	sbi->gc_thread = NULL;
 }
@@ -296,6 +309,146 @@ static unsigned int count_bits(const unsigned long *addr,
 	return sum;
 }
 
+/*
+ * Dirty sections are kept in a min-heap of their valid blocks, updated
+ * under seglist_lock whenever a segment enters or leaves the dirty list,
+ * so that greedy selection does not have to rescan the dirty segmap.
+ */
+static void victim_heap_swap(struct dirty_seglist_info *dirty_i,
+					unsigned int a, unsigned int b)
+{
+	swap(dirty_i->victim_heap[a], dirty_i->victim_heap[b]);
+	swap(dirty_i->victim_heap_key[a], dirty_i->victim_heap_key[b]);
+	dirty_i->victim_heap_pos[dirty_i->victim_heap[a]] = a + 1;
+	dirty_i->victim_heap_pos[dirty_i->victim_heap[b]] = b + 1;
+}
+
+static void victim_heap_sift(struct dirty_seglist_info *dirty_i,
+					unsigned int i)
+{
+	unsigned int *key = dirty_i->victim_heap_key;
+	unsigned int size = dirty_i->victim_heap_size;
+
+	while (i && key[i] < key[(i - 1) / 2]) {
+		victim_heap_swap(dirty_i, i, (i - 1) / 2);
+		i = (i - 1) / 2;
+	}
+
+	while (1) {
+		unsigned int min = i, l = 2 * i + 1, r = 2 * i + 2;
+
+		if (l < size && key[l] < key[min])
+			min = l;
+		if (r < size && key[r] < key[min])
+			min = r;
+		if (min == i)
+			break;
+		victim_heap_swap(dirty_i, i, min);
+		i = min;
+	}
+}
+
+void f2fs_update_victim_heap(struct f2fs_sb_info *sbi, unsigned int segno)
+{
+	struct dirty_seglist_info *dirty_i = DIRTY_I(sbi);
+	unsigned int secno = GET_SEC_FROM_SEG(sbi, segno);
+	unsigned int start = GET_SEG_FROM_SEC(sbi, secno);
+	unsigned int i;
+
+	if (!dirty_i->victim_heap || secno >= MAIN_SECS(sbi))
+		return;
+
+	i = dirty_i->victim_heap_pos[secno];
+
+	if (!count_bits(dirty_i->dirty_segmap[DIRTY], start,
+						sbi->segs_per_sec)) {
+		if (!i)
+			return;
+		dirty_i->victim_heap_pos[secno] = 0;
+		if (i != dirty_i->victim_heap_size) {
+			unsigned int last = --dirty_i->victim_heap_size;
+
+			dirty_i->victim_heap[i - 1] = dirty_i->victim_heap[last];
+			dirty_i->victim_heap_key[i - 1] =
+					dirty_i->victim_heap_key[last];
+			dirty_i->victim_heap_pos[dirty_i->victim_heap[i - 1]] = i;
+			victim_heap_sift(dirty_i, i - 1);
+		} else {
+			dirty_i->victim_heap_size--;
+		}
+		return;
+	}
+
+	if (!i) {
+		i = ++dirty_i->victim_heap_size;
+		dirty_i->victim_heap[i - 1] = secno;
+		dirty_i->victim_heap_pos[secno] = i;
+	}
+	dirty_i->victim_heap_key[i - 1] = get_valid_blocks(sbi, start, true);
+	victim_heap_sift(dirty_i, i - 1);
+}
+
+/*
+ * Walk the heap smallest key first, skipping sections that cannot be
+ * victims right now. Keys gone stale behind a current segment are
+ * refreshed once the walk is done.
+ */
+static unsigned int get_victim_from_heap(struct f2fs_sb_info *sbi,
+				int gc_type, struct victim_sel_policy *p)
+{
+	struct dirty_seglist_info *dirty_i = DIRTY_I(sbi);
+	unsigned int *key = dirty_i->victim_heap_key;
+	unsigned int front[VICTIM_HEAP_PROBE + 1];
+	unsigned int stale[VICTIM_HEAP_PROBE];
+	unsigned int nfront = 0, nstale = 0, probes, j;
+
+	if (!dirty_i->victim_heap_size)
+		return NULL_SEGNO;
+
+	front[nfront++] = 0;
+
+	for (probes = 0; probes < VICTIM_HEAP_PROBE && nfront; probes++) {
+		unsigned int best = 0, i, secno, segno, valid;
+
+		for (j = 1; j < nfront; j++)
+			if (key[front[j]] < key[front[best]])
+				best = j;
+		i = front[best];
+		front[best] = front[--nfront];
+
+		if (2 * i + 1 < dirty_i->victim_heap_size)
+			front[nfront++] = 2 * i + 1;
+		if (2 * i + 2 < dirty_i->victim_heap_size)
+			front[nfront++] = 2 * i + 2;
+
+		secno = dirty_i->victim_heap[i];
+		segno = GET_SEG_FROM_SEC(sbi, secno);
+		valid = get_valid_blocks(sbi, segno, true);
+		if (valid != key[i])
+			stale[nstale++] = segno;
+
+		if (sec_usage_check(sbi, secno))
+			continue;
+		if (unlikely(is_sbi_flag_set(sbi, SBI_CP_DISABLED) &&
+					get_ckpt_valid_blocks(sbi, segno)))
+			continue;
+		if (gc_type == BG_GC && test_bit(secno, dirty_i->victim_secmap))
+			continue;
+
+		if (p->min_cost > valid) {
+			p->min_segno = segno;
+			p->min_cost = valid;
+		}
+		if (valid == key[i])
+			break;
+	}
+
+	for (j = 0; j < nstale; j++)
+		f2fs_update_victim_heap(sbi, stale[j]);
+
+	return p->min_segno;
+}
+
 /*
  * This function is called from two paths.
  * One is garbage collection and the other is SSR segment selection.
@@ -356,6 +509,12 @@ static int get_victim_by_default(struct f2fs_sb_info *sbi,
 			goto got_it;
 	}
 
+	if (p.alloc_mode == LFS && p.gc_mode == GC_GREEDY) {
+		p.min_segno = get_victim_from_heap(sbi, gc_type, &p);
+		if (p.min_segno != NULL_SEGNO)
+			goto got_it;
+	}
+
 	while (1) {
 		unsigned long cost;
 		unsigned int segno;
@@ -1226,6 +1385,63 @@ skip:
 	return seg_freed;
 }
 
+struct gc_victim_work {
+	struct work_struct work;
+	struct f2fs_sb_info *sbi;
+	unsigned int segno;
+	int seg_freed;
+};
+
+static void gc_victim_work_func(struct work_struct *work)
+{
+	struct gc_victim_work *gw = container_of(work,
+					struct gc_victim_work, work);
+	struct gc_inode_list gc_list = {
+		.ilist = LIST_HEAD_INIT(gc_list.ilist),
+		.iroot = RADIX_TREE_INIT(GFP_NOFS),
+	};
+
+	gw->seg_freed = do_garbage_collect(gw->sbi, gw->segno,
+						&gc_list, BG_GC);
+	put_gc_inode(&gc_list);
+}
+
+/*
+ * Background GC picks up to gc_workers victims; the extra ones are
+ * migrated from gc_wq while the GC thread moves the first. Victims are
+ * distinct since each one is marked in victim_secmap when selected, and
+ * the caller keeps gc_mutex until all of them are done.
+ */
+static int do_garbage_collect_parallel(struct f2fs_sb_info *sbi,
+				unsigned int segno,
+				struct gc_inode_list *gc_list)
+{
+	struct f2fs_gc_kthread *gc_th = sbi->gc_thread;
+	struct gc_victim_work works[MAX_GC_THREAD_WORKERS - 1];
+	int seg_freed, nr, i;
+
+	for (nr = 0; nr < gc_th->gc_workers - 1; nr++) {
+		unsigned int next = NULL_SEGNO;
+
+		if (!__get_victim(sbi, &next, BG_GC))
+			break;
+
+		works[nr].sbi = sbi;
+		works[nr].segno = next;
+		INIT_WORK_ONSTACK(&works[nr].work, gc_victim_work_func);
+		queue_work(gc_th->gc_wq, &works[nr].work);
+	}
+
+	seg_freed = do_garbage_collect(sbi, segno, gc_list, BG_GC);
+
+	for (i = 0; i < nr; i++) {
+		flush_work(&works[i].work);
+		destroy_work_on_stack(&works[i].work);
+		seg_freed += works[i].seg_freed;
+	}
+	return seg_freed;
+}
+
 int f2fs_gc(struct f2fs_sb_info *sbi, bool sync,
 			bool background, unsigned int segno)
 {
@@ -1290,7 +1506,12 @@ gc_more:
 		goto stop;
 	}
 
-	seg_freed = do_garbage_collect(sbi, segno, &gc_list, gc_type);
+	if (gc_type == BG_GC && background && sbi->gc_thread &&
+			sbi->gc_thread->gc_workers > 1 &&
+			!__is_large_section(sbi))
+		seg_freed = do_garbage_collect_parallel(sbi, segno, &gc_list);
+	else
+		seg_freed = do_garbage_collect(sbi, segno, &gc_list, gc_type);
 	if (gc_type == FG_GC && seg_freed == sbi->segs_per_sec)
 		sec_freed++;
 	total_freed += seg_freed;
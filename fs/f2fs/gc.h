@@ -22,6 +22,13 @@
 /* Search max. number of dirty segments to select a victim segment */
 #define DEF_MAX_VICTIM_SEARCH 4096 /* covers 8GB */
 
+/* # of victim heap entries probed before falling back to the scan */
+#define VICTIM_HEAP_PROBE	16
+
+/* victims migrated in parallel by background GC */
+#define DEF_GC_THREAD_WORKERS	1
+#define MAX_GC_THREAD_WORKERS	8
+
 struct f2fs_gc_kthread {
 	struct task_struct *f2fs_gc_task;
 	wait_queue_head_t gc_wait_queue_head;
@@ -34,6 +41,10 @@ struct f2fs_gc_kthread {
 
 	/* for changing gc mode */
 	unsigned int gc_wake;
+
+	/* for parallel migration of background GC victims */
+	struct workqueue_struct *gc_wq;
+	unsigned int gc_workers;
 };
 
 struct gc_inode_list {
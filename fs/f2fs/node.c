@@ -161,10 +161,22 @@ static void __free_nat_entry(struct nat_entry *e)
 	kmem_cache_free(nat_entry_slab, e);
 }
 
+/*
+ * Hits only take nat_tree_lock shared, so the clean lru list is where
+ * concurrent lookups serialize; it is split by nid to spread that.
+ */
+static inline struct nat_lru_list *__nat_lru(struct f2fs_nm_info *nm_i,
+								nid_t nid)
+{
+	return &nm_i->nat_lru[nid & (NAT_LRU_LISTS - 1)];
+}
+
 /* must be locked by nat_tree_lock */
 static struct nat_entry *__init_nat_entry(struct f2fs_nm_info *nm_i,
 	struct nat_entry *ne, struct f2fs_nat_entry *raw_ne, bool no_fail)
 {
+	struct nat_lru_list *lru;
+
 	if (no_fail)
 		f2fs_radix_tree_insert(&nm_i->nat_root, nat_get_nid(ne), ne);
 	else if (radix_tree_insert(&nm_i->nat_root, nat_get_nid(ne), ne))
@@ -173,9 +185,10 @@ static struct nat_entry *__init_nat_entry(struct f2fs_nm_info *nm_i,
 	if (raw_ne)
 		node_info_from_raw_nat(&ne->ni, raw_ne);
 
-	spin_lock(&nm_i->nat_list_lock);
-	list_add_tail(&ne->list, &nm_i->nat_entries);
-	spin_unlock(&nm_i->nat_list_lock);
+	lru = __nat_lru(nm_i, nat_get_nid(ne));
+	spin_lock(&lru->lock);
+	list_add_tail(&ne->list, &lru->entries);
+	spin_unlock(&lru->lock);
 
 	nm_i->nat_cnt++;
 	return ne;
@@ -189,10 +202,12 @@ static struct nat_entry *__lookup_nat_cache(struct f2fs_nm_info *nm_i, nid_t n)
 
 	/* for recent accessed nat entry, move it to tail of lru list */
 	if (ne && !get_nat_flag(ne, IS_DIRTY)) {
-		spin_lock(&nm_i->nat_list_lock);
+		struct nat_lru_list *lru = __nat_lru(nm_i, n);
+
+		spin_lock(&lru->lock);
 		if (!list_empty(&ne->list))
-			list_move_tail(&ne->list, &nm_i->nat_entries);
-		spin_unlock(&nm_i->nat_list_lock);
+			list_move_tail(&ne->list, &lru->entries);
+		spin_unlock(&lru->lock);
 	}
 
 	return ne;
@@ -234,6 +249,7 @@ static void __set_nat_cache_dirty(struct f2fs_nm_info *nm_i,
 						struct nat_entry *ne)
 {
 	struct nat_entry_set *head;
+	struct nat_lru_list *lru;
 	bool new_ne = nat_get_blkaddr(ne) == NEW_ADDR;
 
 	if (!new_ne)
@@ -256,20 +272,23 @@ static void __set_nat_cache_dirty(struct f2fs_nm_info *nm_i,
 	nm_i->dirty_nat_cnt++;
 	set_nat_flag(ne, IS_DIRTY, true);
 refresh_list:
-	spin_lock(&nm_i->nat_list_lock);
+	lru = __nat_lru(nm_i, nat_get_nid(ne));
+	spin_lock(&lru->lock);
 	if (new_ne)
 		list_del_init(&ne->list);
 	else
 		list_move_tail(&ne->list, &head->entry_list);
-	spin_unlock(&nm_i->nat_list_lock);
+	spin_unlock(&lru->lock);
 }
 
 static void __clear_nat_cache_dirty(struct f2fs_nm_info *nm_i,
 		struct nat_entry_set *set, struct nat_entry *ne)
 {
-	spin_lock(&nm_i->nat_list_lock);
-	list_move_tail(&ne->list, &nm_i->nat_entries);
-	spin_unlock(&nm_i->nat_list_lock);
+	struct nat_lru_list *lru = __nat_lru(nm_i, nat_get_nid(ne));
+
+	spin_lock(&lru->lock);
+	list_move_tail(&ne->list, &lru->entries);
+	spin_unlock(&lru->lock);
 
 	set_nat_flag(ne, IS_DIRTY, false);
 	set->entry_cnt--;
@@ -482,34 +501,83 @@ static void set_node_addr(struct f2fs_sb_info *sbi, struct node_info *ni,
 int f2fs_try_to_free_nats(struct f2fs_sb_info *sbi, int nr_shrink)
 {
 	struct f2fs_nm_info *nm_i = NM_I(sbi);
-	int nr = nr_shrink;
+	int nr = nr_shrink, empty = 0;
 
 	if (!down_write_trylock(&nm_i->nat_tree_lock))
 		return 0;
 
-	spin_lock(&nm_i->nat_list_lock);
-	while (nr_shrink) {
+	/* take the oldest entry of each lru list in turn */
+	while (nr_shrink && empty < NAT_LRU_LISTS) {
+		struct nat_lru_list *lru;
 		struct nat_entry *ne;
 
-		if (list_empty(&nm_i->nat_entries))
-			break;
+		lru = &nm_i->nat_lru[nm_i->nat_lru_next++ % NAT_LRU_LISTS];
 
-		ne = list_first_entry(&nm_i->nat_entries,
-					struct nat_entry, list);
+		spin_lock(&lru->lock);
+		if (list_empty(&lru->entries)) {
+			spin_unlock(&lru->lock);
+			empty++;
+			continue;
+		}
+
+		ne = list_first_entry(&lru->entries, struct nat_entry, list);
 		list_del(&ne->list);
-		spin_unlock(&nm_i->nat_list_lock);
+		spin_unlock(&lru->lock);
 
 		__del_from_nat_cache(nm_i, ne);
 		nr_shrink--;
-
-		spin_lock(&nm_i->nat_list_lock);
+		empty = 0;
 	}
-	spin_unlock(&nm_i->nat_list_lock);
 
 	up_write(&nm_i->nat_tree_lock);
 	return nr - nr_shrink;
 }
 
+static void __record_nat_latency(struct f2fs_nm_info *nm_i, u64 start,
+								bool hit)
+{
+	u64 ns = ktime_get_ns() - start;
+	unsigned int us, max;
+	int bucket;
+
+	us = min_t(u64, div_u64(ns, NSEC_PER_USEC), UINT_MAX);
+	bucket = min(fls(us), NAT_LAT_BUCKETS - 1);
+
+	atomic64_add(ns, &nm_i->nat_lat_total[hit]);
+	atomic64_inc(&nm_i->nat_lat_count[hit]);
+	atomic_inc(&nm_i->nat_lat_hist[bucket]);
+
+	max = atomic_read(&nm_i->nat_lat_max);
+	while (us > max) {
+		unsigned int old = atomic_cmpxchg(&nm_i->nat_lat_max, max, us);
+
+		if (old == max)
+			break;
+		max = old;
+	}
+}
+
+/*
+ * When misses walk the NAT area block by block, as an app install or a
+ * gallery scan does, read the following NAT blocks along with this one.
+ */
+static void f2fs_ra_nat_pages(struct f2fs_sb_info *sbi, nid_t nid)
+{
+	struct f2fs_nm_info *nm_i = NM_I(sbi);
+	nid_t nat_ofs = NAT_BLOCK_OFFSET(nid);
+	nid_t last = READ_ONCE(nm_i->last_nat_miss);
+
+	if (nat_ofs == last)
+		return;
+	WRITE_ONCE(nm_i->last_nat_miss, nat_ofs);
+
+	if (!nm_i->ra_nat_pages || nat_ofs != last + 1)
+		return;
+
+	f2fs_ra_meta_pages(sbi, nat_ofs, nm_i->ra_nat_pages + 1,
+							META_NAT, false);
+}
+
 /*
  * This function always returns success
  */
@@ -526,10 +594,14 @@ int f2fs_get_node_info(struct f2fs_sb_info *sbi, nid_t nid,
 	struct nat_entry *e;
 	pgoff_t index;
 	block_t blkaddr;
+	u64 start = 0;
 	int i;
 
 	ni->nid = nid;
 
+	if (unlikely(nm_i->nat_lat_stat))
+		start = ktime_get_ns();
+
 	/* Check nat cache */
 	down_read(&nm_i->nat_tree_lock);
 	e = __lookup_nat_cache(nm_i, nid);
@@ -538,6 +610,8 @@ int f2fs_get_node_info(struct f2fs_sb_info *sbi, nid_t nid,
 		ni->blk_addr = nat_get_blkaddr(e);
 		ni->version = nat_get_version(e);
 		up_read(&nm_i->nat_tree_lock);
+		if (start)
+			__record_nat_latency(nm_i, start, true);
 		return 0;
 	}
 
@@ -560,6 +634,8 @@ int f2fs_get_node_info(struct f2fs_sb_info *sbi, nid_t nid,
 	index = current_nat_addr(sbi, nid);
 	up_read(&nm_i->nat_tree_lock);
 
+	f2fs_ra_nat_pages(sbi, nid);
+
 	page = f2fs_get_meta_page(sbi, index);
 	if (IS_ERR(page))
 		return PTR_ERR(page);
@@ -576,6 +652,8 @@ cache:
 
 	/* cache nat entry */
 	cache_nat_entry(sbi, nid, &ne);
+	if (start)
+		__record_nat_latency(nm_i, start, false);
 	return 0;
 }
 
@@ -2956,7 +3034,7 @@ static int init_node_manager(struct f2fs_sb_info *sbi)
 	struct f2fs_nm_info *nm_i = NM_I(sbi);
 	unsigned char *version_bitmap;
 	unsigned int nat_segs;
-	int err;
+	int err, i;
 
 	nm_i->nat_blkaddr = le32_to_cpu(sb_raw->nat_blkaddr);
 
@@ -2973,14 +3051,17 @@ static int init_node_manager(struct f2fs_sb_info *sbi)
 	nm_i->nat_cnt = 0;
 	nm_i->ram_thresh = DEF_RAM_THRESHOLD;
 	nm_i->ra_nid_pages = DEF_RA_NID_PAGES;
+	nm_i->ra_nat_pages = DEF_RA_NAT_PAGES;
 	nm_i->dirty_nats_ratio = DEF_DIRTY_NAT_RATIO_THRESHOLD;
 
 	INIT_RADIX_TREE(&nm_i->free_nid_root, GFP_ATOMIC);
 	INIT_LIST_HEAD(&nm_i->free_nid_list);
 	INIT_RADIX_TREE(&nm_i->nat_root, GFP_NOIO);
 	INIT_RADIX_TREE(&nm_i->nat_set_root, GFP_NOIO);
-	INIT_LIST_HEAD(&nm_i->nat_entries);
-	spin_lock_init(&nm_i->nat_list_lock);
+	for (i = 0; i < NAT_LRU_LISTS; i++) {
+		INIT_LIST_HEAD(&nm_i->nat_lru[i].entries);
+		spin_lock_init(&nm_i->nat_lru[i].lock);
+	}
 
 	mutex_init(&nm_i->build_lock);
 	spin_lock_init(&nm_i->nid_list_lock);
@@ -3100,9 +3181,12 @@ void f2fs_destroy_node_manager(struct f2fs_sb_info *sbi)
 
 		nid = nat_get_nid(natvec[found - 1]) + 1;
 		for (idx = 0; idx < found; idx++) {
-			spin_lock(&nm_i->nat_list_lock);
+			struct nat_lru_list *lru;
+
+			lru = __nat_lru(nm_i, nat_get_nid(natvec[idx]));
+			spin_lock(&lru->lock);
 			list_del(&natvec[idx]->list);
-			spin_unlock(&nm_i->nat_list_lock);
+			spin_unlock(&lru->lock);
 
 			__del_from_nat_cache(nm_i, natvec[idx]);
 		}
@@ -16,6 +16,7 @@
 #define MAX_FREE_NIDS	(NAT_ENTRY_PER_BLOCK * FREE_NID_PAGES)
 
 #define DEF_RA_NID_PAGES	0	/* # of nid pages to be readaheaded */
+#define DEF_RA_NAT_PAGES	4	/* # of nat pages readaheaded on sequential misses */
 
 /* maximum readahead size for node during getting data blocks */
 #define MAX_RA_NODE		128
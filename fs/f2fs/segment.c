@@ -597,6 +597,63 @@ static int submit_flush_wait(struct f2fs_sb_info *sbi, nid_t ino)
 	return ret;
 }
 
+static unsigned int __count_flush_cmds(struct llist_node *list)
+{
+	unsigned int nr = 0;
+
+	for (; list; list = list->next)
+		nr++;
+	return nr;
+}
+
+/*
+ * Group commit: while more fsyncs are running than have queued a
+ * flush, keep collecting commands for up to merge_window us, so that
+ * near-simultaneous fsyncs share one cache flush.
+ */
+static unsigned int __wait_flush_window(struct flush_cmd_control *fcc,
+							unsigned int nr)
+{
+	ktime_t end = ktime_add_us(ktime_get(), fcc->merge_window);
+	bool waited = false;
+
+	while (atomic_read(&fcc->active_fsync) > nr &&
+					ktime_before(ktime_get(), end)) {
+		struct llist_node *list, *tail;
+
+		usleep_range(FLUSH_MERGE_WINDOW_STEP,
+					2 * FLUSH_MERGE_WINDOW_STEP);
+		waited = true;
+
+		list = llist_del_all(&fcc->issue_list);
+		if (!list)
+			continue;
+
+		/* newer commands go in front, as llist_del_all returns them */
+		for (tail = list; tail->next; tail = tail->next)
+			nr++;
+		nr++;
+		tail->next = fcc->dispatch_list;
+		fcc->dispatch_list = list;
+	}
+
+	if (waited)
+		fcc->merge_waited++;
+	return nr;
+}
+
+static void __update_flush_merge_stat(struct flush_cmd_control *fcc,
+							unsigned int nr)
+{
+	int bucket = min(fls(nr - 1), FLUSH_MERGE_BUCKETS - 1);
+
+	fcc->merge_windows++;
+	fcc->merge_cmds += nr;
+	fcc->merge_hist[bucket]++;
+	if (nr > fcc->merge_max)
+		fcc->merge_max = nr;
+}
+
 static int issue_flush_thread(void *data)
 {
 	struct f2fs_sb_info *sbi = data;
@@ -610,10 +667,15 @@ repeat:
 
 	if (!llist_empty(&fcc->issue_list)) {
 		struct flush_cmd *cmd, *next;
+		unsigned int nr;
 		int ret;
 
 		fcc->dispatch_list = llist_del_all(&fcc->issue_list);
+		nr = __count_flush_cmds(fcc->dispatch_list);
+		if (fcc->merge_window)
+			nr = __wait_flush_window(fcc, nr);
 		fcc->dispatch_list = llist_reverse_order(fcc->dispatch_list);
+		__update_flush_merge_stat(fcc, nr);
 
 		cmd = llist_entry(fcc->dispatch_list, struct flush_cmd, llnode);
 
@@ -652,7 +714,10 @@ int f2fs_issue_flush(struct f2fs_sb_info *sbi, nid_t ino)
 		return ret;
 	}
 
-	if (atomic_inc_return(&fcc->queued_flush) == 1 ||
+	/* go through the thread if other fsyncs may join the window */
+	if ((atomic_inc_return(&fcc->queued_flush) == 1 &&
+	     !(fcc->merge_window && fcc->f2fs_issue_flush &&
+	       atomic_read(&fcc->active_fsync) > 1)) ||
 	    f2fs_is_multi_device(sbi)) {
 		ret = submit_flush_wait(sbi, ino);
 		atomic_dec(&fcc->queued_flush);
@@ -720,6 +785,8 @@ int f2fs_create_flush_cmd_control(struct f2fs_sb_info *sbi)
 		return -ENOMEM;
 	atomic_set(&fcc->issued_flush, 0);
 	atomic_set(&fcc->queued_flush, 0);
+	atomic_set(&fcc->active_fsync, 0);
+	fcc->merge_window = DEF_FLUSH_MERGE_WINDOW;
 	init_waitqueue_head(&fcc->flush_wait_queue);
 	init_llist_head(&fcc->issue_list);
 	SM_I(sbi)->fcc_info = fcc;
@@ -799,6 +866,7 @@ static void __locate_dirty_segment(struct f2fs_sb_info *sbi, unsigned int segno,
 		}
 		if (!test_and_set_bit(segno, dirty_i->dirty_segmap[t]))
 			dirty_i->nr_dirty[t]++;
+		f2fs_update_victim_heap(sbi, segno);
 	}
 }
 
@@ -820,6 +888,7 @@ static void __remove_dirty_segment(struct f2fs_sb_info *sbi, unsigned int segno,
 		if (get_valid_blocks(sbi, segno, true) == 0)
 			clear_bit(GET_SEC_FROM_SEG(sbi, segno),
 						dirty_i->victim_secmap);
+		f2fs_update_victim_heap(sbi, segno);
 	}
 }
 
@@ -957,6 +1026,8 @@ static struct discard_cmd *__create_discard_cmd(struct f2fs_sb_info *sbi,
 	list_add_tail(&dc->list, pend_list);
 	spin_lock_init(&dc->lock);
 	dc->bio_ref = 0;
+	dc->issue_time = 0;
+	dc->done_time = 0;
 	atomic_inc(&dcc->discard_cmd_cnt);
 	dcc->undiscard_blks += len;
 
@@ -994,6 +1065,33 @@ static void __detach_discard_cmd(struct discard_cmd_control *dcc,
 	atomic_dec(&dcc->discard_cmd_cnt);
 }
 
+static void __record_discard_latency(struct discard_cmd_control *dcc,
+							struct discard_cmd *dc)
+{
+	unsigned int us, max;
+	int bucket;
+
+	if (!dc->issue_time || dc->done_time < dc->issue_time)
+		return;
+
+	us = min_t(u64, div_u64(dc->done_time - dc->issue_time,
+					NSEC_PER_USEC), UINT_MAX);
+	bucket = min(fls(us / USEC_PER_MSEC), DISCARD_LAT_BUCKETS - 1);
+
+	atomic64_add(us, &dcc->lat_total);
+	atomic64_inc(&dcc->lat_count);
+	atomic_inc(&dcc->lat_hist[bucket]);
+
+	max = atomic_read(&dcc->lat_max);
+	while (us > max) {
+		unsigned int old = atomic_cmpxchg(&dcc->lat_max, max, us);
+
+		if (old == max)
+			break;
+		max = old;
+	}
+}
+
 static void __remove_discard_cmd(struct f2fs_sb_info *sbi,
 							struct discard_cmd *dc)
 {
@@ -1018,6 +1116,8 @@ static void __remove_discard_cmd(struct f2fs_sb_info *sbi,
 		printk_ratelimited(
 			"%sF2FS-fs: Issue discard(%u, %u, %u) failed, ret: %d",
 			KERN_INFO, dc->lstart, dc->start, dc->len, dc->error);
+	else if (dc->state == D_DONE)
+		__record_discard_latency(dcc, dc);
 	__detach_discard_cmd(dcc, dc);
 }
 
@@ -1031,6 +1131,7 @@ static void f2fs_submit_discard_endio(struct bio *bio)
 	spin_lock_irqsave(&dc->lock, flags);
 	dc->bio_ref--;
 	if (!dc->bio_ref && dc->state == D_SUBMIT) {
+		dc->done_time = ktime_get_ns();
 		dc->state = D_DONE;
 		complete_all(&dc->wait);
 	}
@@ -1159,6 +1260,7 @@ static void __init_discard_policy(struct f2fs_sb_info *sbi,
 	dpolicy->max_requests = DEF_MAX_DISCARD_REQUEST;
 	dpolicy->io_aware_gran = MAX_PLIST_NUM;
 	dpolicy->timeout = 0;
+	dpolicy->dev_idle = false;
 
 	if (discard_type == DPOLICY_BG) {
 		dpolicy->min_interval = DEF_MIN_DISCARD_ISSUE_TIME;
@@ -1171,6 +1273,8 @@ static void __init_discard_policy(struct f2fs_sb_info *sbi,
 			dpolicy->granularity = 1;
 			dpolicy->max_interval = DEF_MIN_DISCARD_ISSUE_TIME;
 		}
+		if (SM_I(sbi)->dcc_info->discard_batch)
+			dpolicy->dev_idle = true;
 	} else if (discard_type == DPOLICY_FORCE) {
 		dpolicy->min_interval = DEF_MIN_DISCARD_ISSUE_TIME;
 		dpolicy->mid_interval = DEF_MID_DISCARD_ISSUE_TIME;
@@ -1214,6 +1318,9 @@ static int __submit_discard_cmd(struct f2fs_sb_info *sbi,
 
 	trace_f2fs_issue_discard(bdev, dc->start, dc->len);
 
+	if (!dc->issue_time)
+		dc->issue_time = ktime_get_ns();
+
 	lstart = dc->lstart;
 	start = dc->start;
 	len = dc->len;
@@ -1477,6 +1584,64 @@ static int __queue_discard_cmd(struct f2fs_sb_info *sbi,
 	return 0;
 }
 
+/*
+ * In batch mode discards wait until the device itself has been idle for
+ * discard_dev_idle ms, on top of f2fs' own idle check. Devices whose
+ * driver does not track idle time only get the latter.
+ */
+static bool __discard_idle(struct f2fs_sb_info *sbi,
+		struct discard_policy *dpolicy, struct block_device *bdev)
+{
+	s64 idle_ms;
+
+	if (!is_idle(sbi, DISCARD_TIME))
+		return false;
+	if (!dpolicy->dev_idle)
+		return true;
+
+	idle_ms = blk_queue_idle_ms(bdev_get_queue(bdev));
+	return idle_ms < 0 ||
+		idle_ms >= SM_I(sbi)->dcc_info->discard_dev_idle;
+}
+
+/*
+ * Deferred commands may have become adjacent after they were queued,
+ * e.g. once a neighbour was punched or split. Fold them back together
+ * so that each idle window is spent on a few large discards.
+ */
+static void __merge_discard_cmd_tree(struct f2fs_sb_info *sbi)
+{
+	struct discard_cmd_control *dcc = SM_I(sbi)->dcc_info;
+	struct discard_cmd *dc, *next;
+	struct rb_node *node;
+
+	node = rb_first(&dcc->root);
+	dc = rb_entry_safe(node, struct discard_cmd, rb_node);
+
+	while (dc) {
+		struct request_queue *q = bdev_get_queue(dc->bdev);
+		unsigned int max_discard_blocks =
+			SECTOR_TO_BLOCK(q->limits.max_discard_sectors);
+
+		node = rb_next(&dc->rb_node);
+		next = rb_entry_safe(node, struct discard_cmd, rb_node);
+		if (!next)
+			break;
+
+		if (dc->state == D_PREP && next->state == D_PREP &&
+				!next->ref && dc->bdev == next->bdev &&
+				__is_discard_mergeable(&dc->di, &next->di,
+							max_discard_blocks)) {
+			dc->len += next->len;
+			dcc->undiscard_blks += next->len;
+			__remove_discard_cmd(sbi, next);
+			__relocate_discard_cmd(dcc, dc);
+			continue;
+		}
+		dc = next;
+	}
+}
+
 static unsigned int __issue_discard_cmd_orderly(struct f2fs_sb_info *sbi,
 					struct discard_policy *dpolicy)
 {
@@ -1507,7 +1672,7 @@ static unsigned int __issue_discard_cmd_orderly(struct f2fs_sb_info *sbi,
 		if (dc->state != D_PREP)
 			goto next;
 
-		if (dpolicy->io_aware && !is_idle(sbi, DISCARD_TIME)) {
+		if (dpolicy->io_aware && !__discard_idle(sbi, dpolicy, dc->bdev)) {
 			io_interrupted = true;
 			break;
 		}
@@ -1550,6 +1715,12 @@ static int __issue_discard_cmd(struct f2fs_sb_info *sbi,
 	if (dpolicy->timeout != 0)
 		f2fs_update_time(sbi, dpolicy->timeout);
 
+	if (dpolicy->dev_idle) {
+		mutex_lock(&dcc->cmd_lock);
+		__merge_discard_cmd_tree(sbi);
+		mutex_unlock(&dcc->cmd_lock);
+	}
+
 	for (i = MAX_PLIST_NUM - 1; i >= 0; i--) {
 		if (dpolicy->timeout != 0 &&
 				f2fs_time_over(sbi, dpolicy->timeout))
@@ -1578,7 +1749,7 @@ static int __issue_discard_cmd(struct f2fs_sb_info *sbi,
 				break;
 
 			if (dpolicy->io_aware && i < dpolicy->io_aware_gran &&
-						!is_idle(sbi, DISCARD_TIME)) {
+				!__discard_idle(sbi, dpolicy, dc->bdev)) {
 				io_interrupted = true;
 				break;
 			}
@@ -1814,7 +1985,9 @@ static int issue_discard_thread(void *data)
 		} else if (issued == -1){
 			wait_ms = f2fs_time_to_wait(sbi, DISCARD_TIME);
 			if (!wait_ms)
-				wait_ms = dpolicy.mid_interval;
+				wait_ms = dpolicy.dev_idle ?
+					dcc->discard_dev_idle :
+					dpolicy.mid_interval;
 		} else {
 			wait_ms = dpolicy.max_interval;
 		}
@@ -2135,6 +2308,8 @@ static int create_discard_cmd_control(struct f2fs_sb_info *sbi)
 	dcc->next_pos = 0;
 	dcc->root = RB_ROOT;
 	dcc->rbtree_check = false;
+	dcc->discard_batch = 0;
+	dcc->discard_dev_idle = DEF_DISCARD_DEV_IDLE_TIME;
 
 	init_waitqueue_head(&dcc->discard_wait_queue);
 	SM_I(sbi)->dcc_info = dcc;
@@ -4338,6 +4513,21 @@ static int init_victim_secmap(struct f2fs_sb_info *sbi)
 	return 0;
 }
 
+static int init_victim_heap(struct f2fs_sb_info *sbi)
+{
+	struct dirty_seglist_info *dirty_i = DIRTY_I(sbi);
+	unsigned int size = MAIN_SECS(sbi) * sizeof(unsigned int);
+
+	dirty_i->victim_heap = f2fs_kvmalloc(sbi, size, GFP_KERNEL);
+	dirty_i->victim_heap_key = f2fs_kvmalloc(sbi, size, GFP_KERNEL);
+	dirty_i->victim_heap_pos = f2fs_kvzalloc(sbi, size, GFP_KERNEL);
+	if (!dirty_i->victim_heap || !dirty_i->victim_heap_key ||
+					!dirty_i->victim_heap_pos)
+		return -ENOMEM;
+	dirty_i->victim_heap_size = 0;
+	return 0;
+}
+
 static int build_dirty_segmap(struct f2fs_sb_info *sbi)
 {
 	struct dirty_seglist_info *dirty_i;
@@ -4361,6 +4551,9 @@ static int build_dirty_segmap(struct f2fs_sb_info *sbi)
 			return -ENOMEM;
 	}
 
+	if (init_victim_heap(sbi))
+		return -ENOMEM;
+
 	init_dirty_segmap(sbi);
 	return init_victim_secmap(sbi);
 }
@@ -4518,6 +4711,15 @@ static void destroy_victim_secmap(struct f2fs_sb_info *sbi)
 	kvfree(dirty_i->victim_secmap);
 }
 
+static void destroy_victim_heap(struct f2fs_sb_info *sbi)
+{
+	struct dirty_seglist_info *dirty_i = DIRTY_I(sbi);
+
+	kvfree(dirty_i->victim_heap);
+	kvfree(dirty_i->victim_heap_key);
+	kvfree(dirty_i->victim_heap_pos);
+}
+
 static void destroy_dirty_segmap(struct f2fs_sb_info *sbi)
 {
 	struct dirty_seglist_info *dirty_i = DIRTY_I(sbi);
@@ -4531,6 +4733,7 @@ static void destroy_dirty_segmap(struct f2fs_sb_info *sbi)
 		discard_dirty_segmap(sbi, i);
 
 	destroy_victim_secmap(sbi);
+	destroy_victim_heap(sbi);
 	SM_I(sbi)->dirty_info = NULL;
 	kvfree(dirty_i);
 }
@@ -277,6 +277,10 @@ struct dirty_seglist_info {
 	struct mutex seglist_lock;		/* lock for segment bitmaps */
 	int nr_dirty[NR_DIRTY_TYPE];		/* # of dirty segments */
 	unsigned long *victim_secmap;		/* background GC victims */
+	unsigned int *victim_heap;		/* dirty sections, min-heap */
+	unsigned int *victim_heap_key;		/* valid blocks per heap slot */
+	unsigned int *victim_heap_pos;		/* heap slot + 1 per section */
+	unsigned int victim_heap_size;		/* # of sections in the heap */
 };
 
 /* victim selection function for cleaning and SSR */
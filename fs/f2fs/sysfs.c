@@ -22,6 +22,7 @@ enum {
 	GC_THREAD,	/* struct f2fs_gc_thread */
 	SM_INFO,	/* struct f2fs_sm_info */
 	DCC_INFO,	/* struct discard_cmd_control */
+	FCC_INFO,	/* struct flush_cmd_control */
 	NM_INFO,	/* struct f2fs_nm_info */
 	F2FS_SBI,	/* struct f2fs_sb_info */
 #ifdef CONFIG_F2FS_FAULT_INJECTION
@@ -49,6 +50,8 @@ static unsigned char *__struct_ptr(struct f2fs_sb_info *sbi, int struct_type)
 		return (unsigned char *)SM_I(sbi);
 	else if (struct_type == DCC_INFO)
 		return (unsigned char *)SM_I(sbi)->dcc_info;
+	else if (struct_type == FCC_INFO)
+		return (unsigned char *)SM_I(sbi)->fcc_info;
 	else if (struct_type == NM_INFO)
 		return (unsigned char *)NM_I(sbi);
 	else if (struct_type == F2FS_SBI || struct_type == RESERVED_BLOCKS)
@@ -262,6 +265,24 @@ out:
 		return count;
 	}
 
+	if (!strcmp(a->attr.name, "discard_batch")) {
+		if (t > 1)
+			return -EINVAL;
+		*ui = t;
+		wake_up_discard_thread(sbi, true);
+		return count;
+	}
+
+	if (!strcmp(a->attr.name, "flush_merge_window")) {
+		if (t > USEC_PER_MSEC * 10)
+			return -EINVAL;
+	}
+
+	if (!strcmp(a->attr.name, "gc_workers")) {
+		if (t == 0 || t > MAX_GC_THREAD_WORKERS)
+			return -EINVAL;
+	}
+
 	if (!strcmp(a->attr.name, "migration_granularity")) {
 		if (t == 0 || t > sbi->segs_per_sec)
 			return -EINVAL;
@@ -416,11 +437,15 @@ F2FS_RW_ATTR(GC_THREAD, f2fs_gc_kthread, gc_urgent_sleep_time,
 F2FS_RW_ATTR(GC_THREAD, f2fs_gc_kthread, gc_min_sleep_time, min_sleep_time);
 F2FS_RW_ATTR(GC_THREAD, f2fs_gc_kthread, gc_max_sleep_time, max_sleep_time);
 F2FS_RW_ATTR(GC_THREAD, f2fs_gc_kthread, gc_no_gc_sleep_time, no_gc_sleep_time);
+F2FS_RW_ATTR(GC_THREAD, f2fs_gc_kthread, gc_workers, gc_workers);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, gc_idle, gc_mode);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, gc_urgent, gc_mode);
 F2FS_RW_ATTR(SM_INFO, f2fs_sm_info, reclaim_segments, rec_prefree_segments);
 F2FS_RW_ATTR(DCC_INFO, discard_cmd_control, max_small_discards, max_discards);
 F2FS_RW_ATTR(DCC_INFO, discard_cmd_control, discard_granularity, discard_granularity);
+F2FS_RW_ATTR(DCC_INFO, discard_cmd_control, discard_batch, discard_batch);
+F2FS_RW_ATTR(DCC_INFO, discard_cmd_control, discard_dev_idle, discard_dev_idle);
+F2FS_RW_ATTR(FCC_INFO, flush_cmd_control, flush_merge_window, merge_window);
 F2FS_RW_ATTR(RESERVED_BLOCKS, f2fs_sb_info, reserved_blocks, reserved_blocks);
 F2FS_RW_ATTR(SM_INFO, f2fs_sm_info, batched_trim_sections, trim_sections);
 F2FS_RW_ATTR(SM_INFO, f2fs_sm_info, ipu_policy, ipu_policy);
@@ -431,6 +456,8 @@ F2FS_RW_ATTR(SM_INFO, f2fs_sm_info, min_hot_blocks, min_hot_blocks);
 F2FS_RW_ATTR(SM_INFO, f2fs_sm_info, min_ssr_sections, min_ssr_sections);
 F2FS_RW_ATTR(NM_INFO, f2fs_nm_info, ram_thresh, ram_thresh);
 F2FS_RW_ATTR(NM_INFO, f2fs_nm_info, ra_nid_pages, ra_nid_pages);
+F2FS_RW_ATTR(NM_INFO, f2fs_nm_info, ra_nat_pages, ra_nat_pages);
+F2FS_RW_ATTR(NM_INFO, f2fs_nm_info, nat_lat_stat, nat_lat_stat);
 F2FS_RW_ATTR(NM_INFO, f2fs_nm_info, dirty_nats_ratio, dirty_nats_ratio);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, max_victim_search, max_victim_search);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, migration_granularity, migration_granularity);
@@ -443,6 +470,7 @@ F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, gc_idle_interval, interval_time[GC_TIME]);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info,
 		umount_discard_timeout, interval_time[UMOUNT_DISCARD_TIMEOUT]);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, iostat_enable, iostat_enable);
+F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, cp_preflush, cp_preflush);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, readdir_ra, readdir_ra);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, gc_pin_file_thresh, gc_pin_file_threshold);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_super_block, extension_list, extension_list);
@@ -478,11 +506,15 @@ static struct attribute *f2fs_attrs[] = {
 	ATTR_LIST(gc_min_sleep_time),
 	ATTR_LIST(gc_max_sleep_time),
 	ATTR_LIST(gc_no_gc_sleep_time),
+	ATTR_LIST(gc_workers),
 	ATTR_LIST(gc_idle),
 	ATTR_LIST(gc_urgent),
 	ATTR_LIST(reclaim_segments),
 	ATTR_LIST(max_small_discards),
 	ATTR_LIST(discard_granularity),
+	ATTR_LIST(discard_batch),
+	ATTR_LIST(discard_dev_idle),
+	ATTR_LIST(flush_merge_window),
 	ATTR_LIST(batched_trim_sections),
 	ATTR_LIST(ipu_policy),
 	ATTR_LIST(min_ipu_util),
@@ -495,6 +527,8 @@ static struct attribute *f2fs_attrs[] = {
 	ATTR_LIST(dir_level),
 	ATTR_LIST(ram_thresh),
 	ATTR_LIST(ra_nid_pages),
+	ATTR_LIST(ra_nat_pages),
+	ATTR_LIST(nat_lat_stat),
 	ATTR_LIST(dirty_nats_ratio),
 	ATTR_LIST(cp_interval),
 	ATTR_LIST(idle_interval),
@@ -502,6 +536,7 @@ static struct attribute *f2fs_attrs[] = {
 	ATTR_LIST(gc_idle_interval),
 	ATTR_LIST(umount_discard_timeout),
 	ATTR_LIST(iostat_enable),
+	ATTR_LIST(cp_preflush),
 	ATTR_LIST(readdir_ra),
 	ATTR_LIST(gc_pin_file_thresh),
 	ATTR_LIST(extension_list),
@@ -659,6 +694,91 @@ static int __maybe_unused iostat_info_seq_show(struct seq_file *seq,
 	return 0;
 }
 
+static int __maybe_unused discard_latency_seq_show(struct seq_file *seq,
+						void *offset)
+{
+	struct super_block *sb = seq->private;
+	struct f2fs_sb_info *sbi = F2FS_SB(sb);
+	struct discard_cmd_control *dcc = SM_I(sbi)->dcc_info;
+	u64 count, total;
+	int i;
+
+	if (!dcc)
+		return 0;
+
+	count = atomic64_read(&dcc->lat_count);
+	total = atomic64_read(&dcc->lat_total);
+
+	seq_printf(seq, "discards:	%-16llu\n", count);
+	seq_printf(seq, "avg (us):	%-16llu\n",
+				count ? div64_u64(total, count) : 0);
+	seq_printf(seq, "max (us):	%-16u\n", atomic_read(&dcc->lat_max));
+
+	for (i = 0; i < DISCARD_LAT_BUCKETS - 1; i++)
+		seq_printf(seq, "< %5u ms:	%-16u\n", 1 << i,
+				atomic_read(&dcc->lat_hist[i]));
+	seq_printf(seq, ">= %4u ms:	%-16u\n", 1 << i,
+				atomic_read(&dcc->lat_hist[i]));
+	return 0;
+}
+
+static int __maybe_unused nat_lookup_latency_seq_show(struct seq_file *seq,
+						void *offset)
+{
+	static const char * const type_name[2] = { "miss", "hit" };
+	struct super_block *sb = seq->private;
+	struct f2fs_sb_info *sbi = F2FS_SB(sb);
+	struct f2fs_nm_info *nm_i = NM_I(sbi);
+	u64 count, total;
+	int i;
+
+	if (!nm_i)
+		return 0;
+
+	seq_printf(seq, "enabled:	%-16u\n", nm_i->nat_lat_stat);
+	for (i = 1; i >= 0; i--) {
+		count = atomic64_read(&nm_i->nat_lat_count[i]);
+		total = atomic64_read(&nm_i->nat_lat_total[i]);
+		seq_printf(seq, "%s:		%-16llu\n", type_name[i], count);
+		seq_printf(seq, "%s avg (ns):	%-16llu\n", type_name[i],
+				count ? div64_u64(total, count) : 0);
+	}
+	seq_printf(seq, "max (us):	%-16u\n", atomic_read(&nm_i->nat_lat_max));
+
+	for (i = 0; i < NAT_LAT_BUCKETS - 1; i++)
+		seq_printf(seq, "< %5u us:	%-16u\n", 1 << i,
+				atomic_read(&nm_i->nat_lat_hist[i]));
+	seq_printf(seq, ">= %4u us:	%-16u\n", 1 << (i - 1),
+				atomic_read(&nm_i->nat_lat_hist[i]));
+	return 0;
+}
+
+static int __maybe_unused flush_merge_info_seq_show(struct seq_file *seq,
+						void *offset)
+{
+	static const char * const bucket_name[FLUSH_MERGE_BUCKETS] = {
+		"1", "2", "3-4", "5-8", "9-16", "17+",
+	};
+	struct super_block *sb = seq->private;
+	struct f2fs_sb_info *sbi = F2FS_SB(sb);
+	struct flush_cmd_control *fcc = SM_I(sbi)->fcc_info;
+	int i;
+
+	if (!fcc)
+		return 0;
+
+	seq_printf(seq, "window (us):	%-16u\n", fcc->merge_window);
+	seq_printf(seq, "flushes:	%-16llu\n", fcc->merge_windows);
+	seq_printf(seq, "waited:		%-16llu\n", fcc->merge_waited);
+	seq_printf(seq, "commands:	%-16llu\n", fcc->merge_cmds);
+	seq_printf(seq, "max merged:	%-16u\n", fcc->merge_max);
+
+	for (i = 0; i < FLUSH_MERGE_BUCKETS; i++)
+		seq_printf(seq, "merged %-5s:	%-16llu\n", bucket_name[i],
+				fcc->merge_hist[i]);
+	return 0;
+}
+
 static int __maybe_unused victim_bits_seq_show(struct seq_file *seq,
 						void *offset)
 {
@@ -698,6 +818,9 @@ F2FS_PROC_FILE_DEF(segment_info);
 F2FS_PROC_FILE_DEF(segment_bits);
 F2FS_PROC_FILE_DEF(iostat_info);
 F2FS_PROC_FILE_DEF(victim_bits);
+F2FS_PROC_FILE_DEF(discard_latency);
+F2FS_PROC_FILE_DEF(flush_merge_info);
+F2FS_PROC_FILE_DEF(nat_lookup_latency);
 
 int __init f2fs_init_sysfs(void)
 {
@@ -750,6 +873,12 @@ int f2fs_register_sysfs(struct f2fs_sb_info *sbi)
 				&f2fs_seq_iostat_info_fops, sb);
 		proc_create_data("victim_bits", S_IRUGO, sbi->s_proc,
 				&f2fs_seq_victim_bits_fops, sb);
+		proc_create_data("discard_latency", S_IRUGO, sbi->s_proc,
+				&f2fs_seq_discard_latency_fops, sb);
+		proc_create_data("flush_merge_info", S_IRUGO, sbi->s_proc,
+				&f2fs_seq_flush_merge_info_fops, sb);
+		proc_create_data("nat_lookup_latency", S_IRUGO, sbi->s_proc,
+				&f2fs_seq_nat_lookup_latency_fops, sb);
 	}
 	return 0;
 }
@@ -761,6 +890,9 @@ void f2fs_unregister_sysfs(struct f2fs_sb_info *sbi)
 		remove_proc_entry("segment_info", sbi->s_proc);
 		remove_proc_entry("segment_bits", sbi->s_proc);
 		remove_proc_entry("victim_bits", sbi->s_proc);
+		remove_proc_entry("discard_latency", sbi->s_proc);
+		remove_proc_entry("flush_merge_info", sbi->s_proc);
+		remove_proc_entry("nat_lookup_latency", sbi->s_proc);
 		remove_proc_entry(sbi->sb->s_id, f2fs_proc_root);
 	}
 	kobject_del(&sbi->s_kobj);
@@ -28,6 +28,8 @@
 #include <linux/tracepoint.h>
 #include <linux/device.h>
 #include <linux/memcontrol.h>
+#include <linux/blk-cgroup.h>
+#include <linux/module.h>
 #include "internal.h"
 
 /*
@@ -35,6 +37,17 @@
  */
 #define MIN_WRITEBACK_PAGES	(4096UL >> (PAGE_CACHE_SHIFT - 10))
 
+/*
+ * Background and periodic writeback give way to data-integrity syncs of
+ * foreground tasks, i.e. tasks in the root blkio cgroup.  For
+ * fg_sync_window_ms after such a sync they only write minimal chunks and
+ * pause fg_sync_pause_ms between them.  A zero window disables this.
+ */
+static unsigned int fg_sync_window_ms;
+module_param(fg_sync_window_ms, uint, 0644);
+static unsigned int fg_sync_pause_ms = 10;
+module_param(fg_sync_pause_ms, uint, 0644);
+
 struct wb_completion {
 	atomic_t		cnt;
 };
@@ -1406,6 +1419,47 @@ __writeback_single_inode(struct inode *inode, struct writeback_control *wbc)
 	return ret;
 }
 
+static bool current_is_foreground(void)
+{
+#ifdef CONFIG_BLK_CGROUP
+	bool fg;
+
+	rcu_read_lock();
+	fg = task_blkcg(current) == &blkcg_root;
+	rcu_read_unlock();
+	return fg;
+#else
+	return true;
+#endif
+}
+
+/**
+ * bdi_note_sync - note a data-integrity sync against a bdi
+ * @bdi: the bdi being synced
+ *
+ * Called when a task starts waiting for its data to reach @bdi.  If the task
+ * is in the foreground, the flushers of @bdi back off for a while.
+ */
+void bdi_note_sync(struct backing_dev_info *bdi)
+{
+	unsigned long now = jiffies ?: 1;
+
+	if (!READ_ONCE(fg_sync_window_ms) || !current_is_foreground())
+		return;
+	if (READ_ONCE(bdi->fg_sync_stamp) != now)
+		WRITE_ONCE(bdi->fg_sync_stamp, now);
+}
+EXPORT_SYMBOL(bdi_note_sync);
+
+static bool wb_fg_sync_active(struct bdi_writeback *wb)
+{
+	unsigned int window = READ_ONCE(fg_sync_window_ms);
+	unsigned long stamp = READ_ONCE(wb->bdi->fg_sync_stamp);
+
+	return window && stamp &&
+		time_in_range(jiffies, stamp, stamp + msecs_to_jiffies(window));
+}
+
 /*
  * Write out an inode's dirty pages. Either the caller has an active reference
  * on the inode or the inode has I_WILL_FREE set.
@@ -1491,7 +1545,11 @@ static long writeback_chunk_size(struct bdi_writeback *wb,
 	 */
 	if (work->sync_mode == WB_SYNC_ALL || work->tagged_writepages)
 		pages = LONG_MAX;
-	else {
+	else if ((work->for_background || work->for_kupdate) &&
+		 wb_fg_sync_active(wb)) {
+		/* don't hold I_SYNC long on inodes a foreground sync wants */
+		pages = MIN_WRITEBACK_PAGES;
+	} else {
 		pages = min(wb->avg_write_bandwidth / 2,
 			    global_wb_domain.dirty_limit / DIRTY_SCOPE);
 		pages = min(pages, work->nr_pages);
@@ -1743,6 +1801,19 @@ static long wb_writeback(struct bdi_writeback *wb,
 		if (work->nr_pages <= 0)
 			break;
 
+		/*
+		 * Leave the device to a foreground sync for a moment.
+		 */
+		if ((work->for_background || work->for_kupdate) &&
+		    wb_fg_sync_active(wb)) {
+			spin_unlock(&wb->list_lock);
+			blk_finish_plug(&plug);
+			schedule_timeout_interruptible(
+				msecs_to_jiffies(READ_ONCE(fg_sync_pause_ms)));
+			blk_start_plug(&plug);
+			spin_lock(&wb->list_lock);
+		}
+
 		/*
 		 * Background writeout and kupdate-style writeback may
 		 * run forever. Stop them if there is other work to do
@@ -2372,6 +2443,8 @@ void sync_inodes_sb(struct super_block *sb)
 		return;
 	WARN_ON(!rwsem_is_locked(&sb->s_umount));
 
+	bdi_note_sync(bdi);
+
 	/* protect against inode wb switch, see inode_switch_wbs_work_fn() */
 	bdi_down_write_wb_switch_rwsem(bdi);
 	bdi_split_work_to_wbs(bdi, &work, false);
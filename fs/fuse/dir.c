@@ -7,6 +7,7 @@
 */
 
 #include "fuse_i.h"
+#include "fuse_passthrough.h"
 
 #include <linux/pagemap.h>
 #include <linux/file.h>
@@ -1375,12 +1376,17 @@ static int fuse_readdir(struct file *file, struct dir_context *ctx)
 	struct page *page;
 	struct inode *inode = file_inode(file);
 	struct fuse_conn *fc = get_fuse_conn(inode);
+	struct fuse_file *ff;
 	struct fuse_req *req;
 	u64 attr_version = 0;
 
 	if (is_bad_inode(inode))
 		return -EIO;
 
+	ff = file->private_data;
+	if (ff->passthrough_enabled && ff->passthrough_filp)
+		return fuse_passthrough_readdir(file, ctx);
+
 	req = fuse_get_req(fc, 1);
 	if (IS_ERR(req))
 		return PTR_ERR(req);
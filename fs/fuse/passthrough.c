@@ -15,6 +15,7 @@
 #include "fuse_passthrough.h"
 
 #include <linux/aio.h>
+#include <linux/cred.h>
 #include <linux/fs_stack.h>
 
 void fuse_setup_passthrough(struct fuse_conn *fc, struct fuse_req *req)
@@ -32,7 +33,8 @@ void fuse_setup_passthrough(struct fuse_conn *fc, struct fuse_req *req)
 		return;
 
 	if ((req->in.h.opcode != FUSE_OPEN) &&
-	    (req->in.h.opcode != FUSE_CREATE))
+	    (req->in.h.opcode != FUSE_CREATE) &&
+	    (req->in.h.opcode != FUSE_OPENDIR))
 		return;
 
 	open_out_index = req->in.numargs - 1;
@@ -51,6 +53,19 @@ void fuse_setup_passthrough(struct fuse_conn *fc, struct fuse_req *req)
 		return;
 
 	passthrough_inode = file_inode(passthrough_filp);
+
+	/*
+	 * Daemons that predate directory passthrough leave the field zeroed
+	 * in their OPENDIR reply, so only take a descriptor that really is a
+	 * directory we can iterate.
+	 */
+	if (req->in.h.opcode == FUSE_OPENDIR &&
+	    (!S_ISDIR(passthrough_inode->i_mode) ||
+	     !passthrough_filp->f_op->iterate)) {
+		fput(passthrough_filp);
+		return;
+	}
+
 	passthrough_sb = passthrough_inode->i_sb;
 	fs_stack_depth = passthrough_sb->s_stack_depth + 1;
 
@@ -117,6 +132,80 @@ ssize_t fuse_passthrough_write_iter(struct kiocb *iocb, struct iov_iter *from)
 	return fuse_passthrough_read_write_iter(iocb, from, 1);
 }
 
+ssize_t fuse_passthrough_splice_read(struct file *in, loff_t *ppos,
+				     struct pipe_inode_info *pipe, size_t len,
+				     unsigned int flags)
+{
+	ssize_t ret_val;
+	struct fuse_file *ff = in->private_data;
+	struct file *passthrough_filp = ff->passthrough_filp;
+
+	if (!passthrough_filp->f_op->splice_read)
+		return -EINVAL;
+
+	/* lock passthrough file to prevent it from being released */
+	get_file(passthrough_filp);
+	ret_val = passthrough_filp->f_op->splice_read(passthrough_filp, ppos,
+						      pipe, len, flags);
+	if (ret_val > 0)
+		fsstack_copy_attr_atime(file_inode(in),
+					file_inode(passthrough_filp));
+	fput(passthrough_filp);
+
+	return ret_val;
+}
+
+/*
+ * Map the lower file instead of the fuse one. Faults are then served from
+ * the lower page cache, which also keeps the mapping coherent with the
+ * passthrough read/write paths.
+ */
+int fuse_passthrough_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	int ret_val;
+	struct fuse_file *ff = file->private_data;
+	struct file *passthrough_filp = ff->passthrough_filp;
+
+	if (!passthrough_filp->f_op->mmap)
+		return -ENODEV;
+
+	if (WARN_ON(file != vma->vm_file))
+		return -EIO;
+
+	vma->vm_file = get_file(passthrough_filp);
+	ret_val = passthrough_filp->f_op->mmap(passthrough_filp, vma);
+	if (ret_val) {
+		/* mmap_region() drops the reference on the original file */
+		vma->vm_file = file;
+		fput(passthrough_filp);
+		return ret_val;
+	}
+
+	/* the vma now holds the lower file */
+	fput(file);
+	fsstack_copy_attr_atime(file_inode(file), file_inode(passthrough_filp));
+
+	return 0;
+}
+
+int fuse_passthrough_readdir(struct file *file, struct dir_context *ctx)
+{
+	int ret_val;
+	struct fuse_file *ff = file->private_data;
+	struct file *passthrough_filp = ff->passthrough_filp;
+	const struct cred *old_cred;
+
+	/* keep the lower position in step with seeks on the fuse dir */
+	passthrough_filp->f_pos = ctx->pos;
+	/* the lower dir is checked against the daemon that opened it */
+	old_cred = override_creds(passthrough_filp->f_cred);
+	ret_val = iterate_dir(passthrough_filp, ctx);
+	revert_creds(old_cred);
+	fsstack_copy_attr_atime(file_inode(file), file_inode(passthrough_filp));
+
+	return ret_val;
+}
+
 void fuse_passthrough_release(struct fuse_file *ff)
 {
 	if (!(ff->passthrough_filp))
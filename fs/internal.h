@@ -140,6 +140,34 @@ extern struct dentry *__d_alloc(struct super_block *, const struct qstr *);
 extern int d_set_mounted(struct dentry *dentry);
 extern long prune_dcache_sb(struct super_block *sb, struct shrink_control *sc);
 
+enum dcache_lookup_stat {
+	DLOOKUP_RCU_HIT,	/* found without leaving rcu-walk */
+	DLOOKUP_REF_HIT,	/* found in ref-walk */
+	DLOOKUP_NEGATIVE,	/* cached negative dentry */
+	DLOOKUP_MISS,		/* not cached, ->lookup() needed */
+	DLOOKUP_UNLAZY,		/* rcu-walk fell back to ref-walk */
+	DLOOKUP_RESTART,	/* rcu-walk raced, walk restarted */
+	NR_DLOOKUP_STATS,
+};
+
+#ifdef CONFIG_DCACHE_LOOKUP_STATS
+struct dcache_lookup_stats {
+	unsigned long count[NR_DLOOKUP_STATS];
+};
+
+static inline void dcache_lookup_stat(struct super_block *sb,
+				      enum dcache_lookup_stat item)
+{
+	if (sb->s_lookup_stats)
+		this_cpu_inc(sb->s_lookup_stats->count[item]);
+}
+#else
+static inline void dcache_lookup_stat(struct super_block *sb,
+				      enum dcache_lookup_stat item)
+{
+}
+#endif
+
 /*
  * read_write.c
  */
@@ -58,6 +58,11 @@ module_param_named(jbd2_debug, jbd2_journal_enable_debug, ushort, 0644);
 MODULE_PARM_DESC(jbd2_debug, "Debugging level for jbd2");
 #endif
 
+bool jbd2_adaptive_batch __read_mostly;
+module_param_named(adaptive_batch, jbd2_adaptive_batch, bool, 0644);
+MODULE_PARM_DESC(adaptive_batch,
+		 "Delay sync commits by the predicted gap to the next fsync");
+
 EXPORT_SYMBOL(jbd2_journal_extend);
 EXPORT_SYMBOL(jbd2_journal_stop);
 EXPORT_SYMBOL(jbd2_journal_lock_updates);
@@ -724,6 +729,7 @@ int jbd2_log_wait_commit(journal_t *journal, tid_t tid)
 int jbd2_complete_transaction(journal_t *journal, tid_t tid)
 {
 	int	need_to_wait = 1;
+	u64	delay = jbd2_sync_batch_delay(journal);
 
 	read_lock(&journal->j_state_lock);
 	if (journal->j_running_transaction &&
@@ -731,6 +737,8 @@ int jbd2_complete_transaction(journal_t *journal, tid_t tid)
 		if (journal->j_commit_request != tid) {
 			/* transaction not yet started, so request it */
 			read_unlock(&journal->j_state_lock);
+			if (delay)
+				jbd2_sync_batch_wait(journal, delay);
 			jbd2_log_start_commit(journal, tid);
 			goto wait_commit;
 		}
@@ -745,6 +753,65 @@ wait_commit:
 }
 EXPORT_SYMBOL(jbd2_complete_transaction);
 
+/*
+ * Adaptive batching of synchronous commits.  Every sync request updates
+ * the mean and mean deviation of the gap between sync requests, the way
+ * TCP estimates RTT.  A request is worth delaying only when the next one
+ * is predicted to arrive sooner than a commit (and its cache flush)
+ * takes, and within j_max_batch_time; the delay is that predicted gap.
+ * A single thread issuing fsyncs back to back sees gaps longer than a
+ * commit and never waits.
+ *
+ * Returns the delay in nanoseconds, 0 to commit right away.
+ */
+u64 jbd2_sync_batch_delay(journal_t *journal)
+{
+	u64 now, gap, avg, dev, commit_time;
+
+	if (!jbd2_adaptive_batch || !journal->j_max_batch_time)
+		return 0;
+
+	now = ktime_get_ns();
+	write_lock(&journal->j_state_lock);
+	/* an idle period says little about the next burst */
+	gap = min_t(u64, now - journal->j_last_sync_time, NSEC_PER_SEC);
+	journal->j_last_sync_time = now;
+
+	avg = journal->j_sync_gap_avg;
+	dev = journal->j_sync_gap_dev;
+	if (!avg) {
+		avg = gap;
+		dev = gap / 2;
+	} else if (gap > avg) {
+		dev = dev - dev / 4 + (gap - avg) / 4;
+		avg += (gap - avg) / 8;
+	} else {
+		dev = dev - dev / 4 + (avg - gap) / 4;
+		avg -= (avg - gap) / 8;
+	}
+	journal->j_sync_gap_avg = avg;
+	journal->j_sync_gap_dev = dev;
+	commit_time = journal->j_average_commit_time;
+	write_unlock(&journal->j_state_lock);
+
+	gap = avg + dev;
+	if (gap >= commit_time || gap > 1000ULL * journal->j_max_batch_time)
+		return 0;
+	return max_t(u64, gap, 1000ULL * journal->j_min_batch_time);
+}
+
+void jbd2_sync_batch_wait(journal_t *journal, u64 delay)
+{
+	ktime_t expires = ktime_add_ns(ktime_get(), delay);
+
+	write_lock(&journal->j_state_lock);
+	journal->j_sync_batch_waits++;
+	write_unlock(&journal->j_state_lock);
+
+	set_current_state(TASK_UNINTERRUPTIBLE);
+	schedule_hrtimeout(&expires, HRTIMER_MODE_ABS);
+}
+
 /*
  * Log buffer allocation routines:
  */
@@ -971,6 +1038,12 @@ static int jbd2_seq_info_show(struct seq_file *seq, void *v)
 	    jiffies_to_msecs(s->stats->run.rs_logging / s->stats->ts_tid));
 	seq_printf(seq, "  %lluus average transaction commit time\n",
 		   div_u64(s->journal->j_average_commit_time, 1000));
+	if (jbd2_adaptive_batch)
+		seq_printf(seq, "  %lluus (+/- %lluus) between sync requests, "
+			   "%lu waited\n",
+			   div_u64(s->journal->j_sync_gap_avg, 1000),
+			   div_u64(s->journal->j_sync_gap_dev, 1000),
+			   s->journal->j_sync_batch_waits);
 	seq_printf(seq, "  %lu handles per transaction\n",
 	    s->stats->run.rs_handle_count / s->stats->ts_tid);
 	seq_printf(seq, "  %lu blocks per transaction\n",
@@ -1706,9 +1706,17 @@ int jbd2_journal_stop(handle_t *handle)
 	 * writes.  No point in waiting for joiners in that case.
 	 *
 	 * Setting max_batch_time to 0 disables this completely.
+	 *
+	 * With jbd2.adaptive_batch set, the delay comes from the measured
+	 * gap between sync requests instead, see jbd2_sync_batch_delay().
 	 */
 	pid = current->pid;
-	if (handle->h_sync && journal->j_last_sync_writer != pid &&
+	if (handle->h_sync && jbd2_adaptive_batch) {
+		u64 delay = jbd2_sync_batch_delay(journal);
+
+		if (delay)
+			jbd2_sync_batch_wait(journal, delay);
+	} else if (handle->h_sync && journal->j_last_sync_writer != pid &&
 	    journal->j_max_batch_time) {
 		u64 commit_time, trans_time;
 
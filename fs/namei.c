@@ -1642,7 +1642,7 @@ static int lookup_fast(struct nameidata *nd,
 		*inode = d_backing_inode(dentry);
 		negative = d_is_negative(dentry);
 		if (read_seqcount_retry(&dentry->d_seq, seq))
-			return -ECHILD;
+			goto restart;
 
 		/*
 		 * This sequence count validates that the parent had no
@@ -1652,7 +1652,7 @@ static int lookup_fast(struct nameidata *nd,
 		 *  enough, we can use __read_seqcount_retry here.
 		 */
 		if (__read_seqcount_retry(&parent->d_seq, nd->seq))
-			return -ECHILD;
+			goto restart;
 
 		*seqp = seq;
 		if (unlikely(dentry->d_flags & DCACHE_OP_REVALIDATE)) {
@@ -1667,13 +1667,19 @@ static int lookup_fast(struct nameidata *nd,
 		 * Note: do negative dentry check after revalidation in
 		 * case that drops it.
 		 */
-		if (negative)
+		if (negative) {
+			dcache_lookup_stat(parent->d_sb, DLOOKUP_NEGATIVE);
 			return -ENOENT;
+		}
 		path->mnt = mnt;
 		path->dentry = dentry;
-		if (likely(__follow_mount_rcu(nd, path, inode, seqp)))
+		if (likely(__follow_mount_rcu(nd, path, inode, seqp))) {
+			dcache_lookup_stat(parent->d_sb, DLOOKUP_RCU_HIT);
 			return 0;
+		}
 unlazy:
+		/* counted first, parent may be gone once unlazy_walk fails */
+		dcache_lookup_stat(parent->d_sb, DLOOKUP_UNLAZY);
 		if (unlazy_walk(nd, dentry, seq))
 			return -ECHILD;
 	} else {
@@ -1696,9 +1702,11 @@ unlazy:
 	}
 
 	if (unlikely(d_is_negative(dentry))) {
+		dcache_lookup_stat(parent->d_sb, DLOOKUP_NEGATIVE);
 		dput(dentry);
 		return -ENOENT;
 	}
+	dcache_lookup_stat(parent->d_sb, DLOOKUP_REF_HIT);
 	path->mnt = mnt;
 	path->dentry = dentry;
 	err = follow_managed(path, nd);
@@ -1707,7 +1715,12 @@ unlazy:
 	return err;
 
 need_lookup:
+	dcache_lookup_stat(parent->d_sb, DLOOKUP_MISS);
 	return 1;
+
+restart:
+	dcache_lookup_stat(parent->d_sb, DLOOKUP_RESTART);
+	return -ECHILD;
 }
 
 /* Fast lookup failed, do it the slow way */
@@ -33,33 +33,70 @@
 
 #include "inotify.h"
 
+/*
+ * Check if 2 events are about the same object: the same inode and, for
+ * events on a watched directory's children, the same name.
+ */
+static bool event_same_object(struct fsnotify_event *old_fsn,
+			      struct fsnotify_event *new_fsn)
+{
+	struct inotify_event_info *old, *new;
+
+	old = INOTIFY_E(old_fsn);
+	new = INOTIFY_E(new_fsn);
+	return (old_fsn->inode == new_fsn->inode) &&
+	       (old->name_len == new->name_len) &&
+	       (!old->name_len || !strcmp(old->name, new->name));
+}
+
 /*
  * Check if 2 events contain the same information.
  */
 static bool event_compare(struct fsnotify_event *old_fsn,
 			  struct fsnotify_event *new_fsn)
 {
-	struct inotify_event_info *old, *new;
-
 	if (old_fsn->mask & FS_IN_IGNORED)
 		return false;
-	old = INOTIFY_E(old_fsn);
-	new = INOTIFY_E(new_fsn);
 	if ((old_fsn->mask == new_fsn->mask) &&
-	    (old_fsn->inode == new_fsn->inode) &&
-	    (old->name_len == new->name_len) &&
-	    (!old->name_len || !strcmp(old->name, new->name)))
+	    event_same_object(old_fsn, new_fsn))
 		return true;
 	return false;
 }
 
+/* How far back IN_COALESCE looks for an IN_MODIFY to merge with */
+#define INOTIFY_COALESCE_DEPTH	64
+
 static int inotify_merge(struct list_head *list,
 			  struct fsnotify_event *event)
 {
+	struct fsnotify_group *group;
 	struct fsnotify_event *last_event;
+	int depth = 0;
 
 	last_event = list_entry(list->prev, struct fsnotify_event, list);
-	return event_compare(last_event, event);
+	if (event_compare(last_event, event))
+		return 1;
+
+	group = container_of(list, struct fsnotify_group, notification_list);
+	if (!group->inotify_data.coalesce || !(event->mask & FS_MODIFY))
+		return 0;
+
+	/*
+	 * Writers to several files interleave their modify events, so look
+	 * further back than the tail.  Stop at any other event for the same
+	 * file so that e.g. MODIFY, CLOSE_WRITE, MODIFY keeps its order.
+	 */
+	list_for_each_entry_reverse(last_event, list, list) {
+		if (++depth > INOTIFY_COALESCE_DEPTH)
+			break;
+		if (last_event->mask & FS_IN_IGNORED)
+			break;
+		if (!event_same_object(last_event, event))
+			continue;
+		return last_event->mask == event->mask;
+	}
+
+	return 0;
 }
 
 int inotify_handle_event(struct fsnotify_group *group,
@@ -674,8 +674,10 @@ SYSCALL_DEFINE1(inotify_init1, int, flags)
 	/* Check the IN_* constants for consistency.  */
 	BUILD_BUG_ON(IN_CLOEXEC != O_CLOEXEC);
 	BUILD_BUG_ON(IN_NONBLOCK != O_NONBLOCK);
+	/* IN_COALESCE is stripped before the flags reach the file */
+	BUILD_BUG_ON(IN_COALESCE & (VALID_OPEN_FLAGS | __FMODE_NONOTIFY));
 
-	if (flags & ~(IN_CLOEXEC | IN_NONBLOCK))
+	if (flags & ~(IN_CLOEXEC | IN_NONBLOCK | IN_COALESCE))
 		return -EINVAL;
 
 	/* fsnotify_obtain_group took a reference to group, we put this when we kill the file in the end */
@@ -683,8 +685,10 @@ SYSCALL_DEFINE1(inotify_init1, int, flags)
 	if (IS_ERR(group))
 		return PTR_ERR(group);
 
+	group->inotify_data.coalesce = !!(flags & IN_COALESCE);
+
 	ret = anon_inode_getfd("inotify", &inotify_fops, group,
-				  O_RDONLY | flags);
+				  O_RDONLY | (flags & ~IN_COALESCE));
 	if (ret < 0)
 		fsnotify_destroy_group(group);
 
@@ -220,7 +220,8 @@ int ovl_set_attr(struct dentry *upperdentry, struct kstat *stat)
 
 static int ovl_copy_up_locked(struct dentry *workdir, struct dentry *upperdir,
 			      struct dentry *dentry, struct path *lowerpath,
-			      struct kstat *stat, const char *link)
+			      struct kstat *stat, const char *link,
+			      bool metacopy)
 {
 	struct inode *wdir = workdir->d_inode;
 	struct inode *udir = upperdir->d_inode;
@@ -247,7 +248,22 @@ static int ovl_copy_up_locked(struct dentry *workdir, struct dentry *upperdir,
 	if (err)
 		goto out2;
 
-	if (S_ISREG(stat->mode)) {
+	if (metacopy) {
+		struct iattr attr = {
+			.ia_valid = ATTR_SIZE,
+			.ia_size = stat->size,
+		};
+
+		/* Only the size for now, the data follows on first write */
+		mutex_lock(&newdentry->d_inode->i_mutex);
+		err = notify_change(newdentry, &attr, NULL);
+		mutex_unlock(&newdentry->d_inode->i_mutex);
+		if (!err)
+			err = ovl_do_setxattr(newdentry, OVL_XATTR_METACOPY,
+					      "y", 1, 0);
+		if (err)
+			goto out_cleanup;
+	} else if (S_ISREG(stat->mode)) {
 		struct path upperpath;
 		ovl_path_upper(dentry, &upperpath);
 		BUG_ON(upperpath.dentry != NULL);
@@ -280,6 +296,8 @@ static int ovl_copy_up_locked(struct dentry *workdir, struct dentry *upperdir,
 	 */
 	if (!S_ISDIR(stat->mode))
 		ovl_dentry_set_opaque(dentry, true);
+	if (metacopy)
+		ovl_dentry_set_metacopy(dentry, true);
 out2:
 	dput(upper);
 out1:
@@ -308,7 +326,7 @@ out_cleanup:
  * that point the file will have already been copied up anyway.
  */
 int ovl_copy_up_one(struct dentry *parent, struct dentry *dentry,
-		    struct path *lowerpath, struct kstat *stat)
+		    struct path *lowerpath, struct kstat *stat, bool metacopy)
 {
 	struct dentry *workdir = ovl_workdir(dentry);
 	int err;
@@ -350,7 +368,7 @@ int ovl_copy_up_one(struct dentry *parent, struct dentry *dentry,
 	}
 
 	err = ovl_copy_up_locked(workdir, upperdir, dentry, lowerpath,
-				 stat, link);
+				 stat, link, metacopy);
 	if (!err) {
 		/* Restore timestamps on parent (best effort) */
 		ovl_set_timestamps(upperdir, &pstat);
@@ -365,10 +383,71 @@ out_unlock:
 	return err;
 }
 
+/*
+ * Copy the data of a metacopy file from the lower layer into the upper
+ * file, which so far only has the metadata and the size.
+ */
+static int ovl_copy_up_meta_data(struct dentry *dentry)
+{
+	struct dentry *workdir = ovl_workdir(dentry);
+	struct dentry *parent, *upperdir;
+	struct path lowerpath, upperpath;
+	struct kstat stat, ustat;
+	const struct cred *old_cred;
+	int err;
+
+	if (WARN_ON(!workdir))
+		return -EROFS;
+
+	parent = dget_parent(dentry);
+	upperdir = ovl_dentry_upper(parent);
+	ovl_path_lower(dentry, &lowerpath);
+	ovl_path_upper(dentry, &upperpath);
+
+	err = vfs_getattr(&lowerpath, &stat);
+	if (!err)
+		err = vfs_getattr(&upperpath, &ustat);
+	if (err)
+		goto out_dput;
+
+	old_cred = ovl_override_creds(dentry->d_sb);
+
+	err = -EIO;
+	if (lock_rename(workdir, upperdir) != NULL) {
+		pr_err("overlayfs: failed to lock workdir+upperdir\n");
+		goto out_unlock;
+	}
+	/* Raced with another data copy-up? */
+	err = 0;
+	if (!ovl_dentry_is_metacopy(dentry))
+		goto out_unlock;
+
+	err = ovl_copy_up_data(&lowerpath, &upperpath,
+			       min(stat.size, ustat.size));
+	if (!err)
+		err = ovl_do_removexattr(upperpath.dentry, OVL_XATTR_METACOPY);
+	if (!err) {
+		ovl_dentry_set_metacopy(dentry, false);
+		/* The data copy is not a modification (best effort) */
+		mutex_lock(&upperpath.dentry->d_inode->i_mutex);
+		ovl_set_timestamps(upperpath.dentry, &ustat);
+		mutex_unlock(&upperpath.dentry->d_inode->i_mutex);
+	}
+out_unlock:
+	unlock_rename(workdir, upperdir);
+	revert_creds(old_cred);
+out_dput:
+	dput(parent);
+	return err;
+}
+
 int ovl_copy_up(struct dentry *dentry)
 {
 	int err;
 
+	if (ovl_dentry_is_metacopy(dentry))
+		return ovl_copy_up_meta_data(dentry);
+
 	err = 0;
 	while (!err) {
 		struct dentry *next;
@@ -396,7 +475,8 @@ int ovl_copy_up(struct dentry *dentry)
 		ovl_path_lower(next, &lowerpath);
 		err = vfs_getattr(&lowerpath, &stat);
 		if (!err)
-			err = ovl_copy_up_one(parent, next, &lowerpath, &stat);
+			err = ovl_copy_up_one(parent, next, &lowerpath, &stat,
+					      false);
 
 		dput(parent);
 		dput(next);
@@ -404,3 +484,39 @@ int ovl_copy_up(struct dentry *dentry)
 
 	return err;
 }
+
+/*
+ * Copy up only the metadata of a regular file, if the mount allows it.  The
+ * data stays on the lower layer until ovl_copy_up() is called on the file,
+ * i.e. until it is opened for write, truncated, linked or renamed.
+ */
+int ovl_copy_up_meta(struct dentry *dentry)
+{
+	int err;
+	struct dentry *parent;
+	struct kstat stat;
+	struct path lowerpath;
+
+	if (OVL_TYPE_UPPER(ovl_path_type(dentry)))
+		return 0;
+
+	if (!ovl_metacopy_enabled(dentry->d_sb) ||
+	    !d_is_reg(dentry))
+		return ovl_copy_up(dentry);
+
+	parent = dget_parent(dentry);
+	err = ovl_copy_up(parent);
+	if (err)
+		goto out_dput_parent;
+
+	ovl_path_lower(dentry, &lowerpath);
+	err = vfs_getattr(&lowerpath, &stat);
+	if (err)
+		goto out_dput_parent;
+
+	err = ovl_copy_up_one(parent, dentry, &lowerpath, &stat, true);
+
+out_dput_parent:
+	dput(parent);
+	return err;
+}
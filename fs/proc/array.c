@@ -84,6 +84,7 @@
 #include <linux/tracehook.h>
 #include <linux/string_helpers.h>
 #include <linux/user_namespace.h>
+#include <linux/proc_pid_stats.h>
 
 #include <asm/pgtable.h>
 #include <asm/processor.h>
@@ -653,6 +654,51 @@ int proc_pid_statlmkd(struct seq_file *m, struct pid_namespace *ns,
 
 	return 0;
 }
+
+/* Binary counterpart of the stat/statm fields, for /proc/pid_stats */
+void proc_pid_stats_fill(struct pid_namespace *ns, struct task_struct *task,
+			 struct proc_pid_stats *st)
+{
+	struct mm_struct *mm;
+	cputime_t utime = 0, stime = 0;
+	unsigned long min_flt = 0, maj_flt = 0;
+	unsigned long flags;
+
+	st->state = *get_task_state(task);
+	st->nice = task_nice(task);
+	st->oom_score_adj = task->signal->oom_score_adj;
+	st->start_time_ns = task->real_start_time;
+
+	if (lock_task_sighand(task, &flags)) {
+		struct signal_struct *sig = task->signal;
+		struct task_struct *t = task;
+
+		st->num_threads = get_nr_threads(task);
+		do {
+			min_flt += t->min_flt;
+			maj_flt += t->maj_flt;
+		} while_each_thread(task, t);
+		min_flt += sig->min_flt;
+		maj_flt += sig->maj_flt;
+		thread_group_cputime_adjusted(task, &utime, &stime);
+		st->ppid = task_tgid_nr_ns(task->real_parent, ns);
+
+		unlock_task_sighand(task, &flags);
+	}
+	st->min_flt = min_flt;
+	st->maj_flt = maj_flt;
+	st->utime_ns = cputime_to_nsecs(utime);
+	st->stime_ns = cputime_to_nsecs(stime);
+
+	mm = get_task_mm(task);
+	if (mm) {
+		st->vsize = task_vsize(mm);
+		st->rss_file = get_mm_counter(mm, MM_FILEPAGES);
+		st->rss_anon = get_mm_counter(mm, MM_ANONPAGES);
+		st->swap = get_mm_counter(mm, MM_SWAPENTS);
+		mmput(mm);
+	}
+}
 #ifdef CONFIG_PROC_CHILDREN
 static struct pid *
 get_children_pid(struct inode *inode, struct pid *pid_prev, loff_t pos)
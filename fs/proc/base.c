@@ -529,6 +529,33 @@ static int proc_pid_schedstat(struct seq_file *m, struct pid_namespace *ns,
 }
 #endif
 
+#ifdef CONFIG_MMAP_SEM_STAT
+/*
+ * Provides /proc/PID/mmap_sem_stat
+ */
+static int proc_pid_mmap_sem_stat(struct seq_file *m, struct pid_namespace *ns,
+				  struct pid *pid, struct task_struct *task)
+{
+	int i;
+
+	seq_puts(m, "below_us wait hold\n");
+	for (i = 0; i < MMAP_SEM_STAT_BUCKETS; i++) {
+		if (i < MMAP_SEM_STAT_BUCKETS - 1)
+			seq_printf(m, "%u", 16U << (2 * i));
+		else
+			seq_puts(m, "inf");
+		/* a child that never took its mmap_sem still shows the parent's */
+		if (task->mmap_sem_stat_pid == task->pid)
+			seq_printf(m, " %u %u\n", task->mmap_sem_wait_hist[i],
+				   task->mmap_sem_hold_hist[i]);
+		else
+			seq_puts(m, " 0 0\n");
+	}
+
+	return 0;
+}
+#endif
+
 #ifdef CONFIG_LATENCYTOP
 static int lstats_show_proc(struct seq_file *m, void *v)
 {
@@ -741,9 +768,9 @@ int proc_setattr(struct dentry *dentry, struct iattr *attr)
  * May current process learn task's sched/cmdline info (for hide_pid_min=1)
  * or euid/egid (for hide_pid_min=2)?
  */
-static bool has_pid_permissions(struct pid_namespace *pid,
-				 struct task_struct *task,
-				 int hide_pid_min)
+bool has_pid_permissions(struct pid_namespace *pid,
+			 struct task_struct *task,
+			 int hide_pid_min)
 {
 	if (pid->hide_pid < hide_pid_min)
 		return true;
@@ -2380,6 +2407,82 @@ static const struct file_operations proc_pid_set_timerslack_ns_operations = {
 	.release	= single_release,
 };
 
+#ifdef CONFIG_SCHED_FRAME_DEADLINE
+/*
+ * The deadline is written as nanoseconds from now, 0 clears it. Reading
+ * shows the nanoseconds left, 0 once it has passed.
+ */
+static ssize_t frame_deadline_write(struct file *file, const char __user *buf,
+					size_t count, loff_t *offset)
+{
+	struct inode *inode = file_inode(file);
+	struct task_struct *p;
+	u64 deadline_ns;
+	int err;
+
+	err = kstrtoull_from_user(buf, count, 10, &deadline_ns);
+	if (err < 0)
+		return err;
+
+	p = get_proc_task(inode);
+	if (!p)
+		return -ESRCH;
+
+	if (p != current) {
+		if (!capable(CAP_SYS_NICE)) {
+			count = -EPERM;
+			goto out;
+		}
+
+		err = security_task_setscheduler(p);
+		if (err) {
+			count = err;
+			goto out;
+		}
+	}
+
+	WRITE_ONCE(p->frame_deadline,
+			deadline_ns ? local_clock() + deadline_ns : 0);
+
+out:
+	put_task_struct(p);
+
+	return count;
+}
+
+static int frame_deadline_show(struct seq_file *m, void *v)
+{
+	struct inode *inode = m->private;
+	struct task_struct *p;
+	u64 deadline, now;
+
+	p = get_proc_task(inode);
+	if (!p)
+		return -ESRCH;
+
+	deadline = READ_ONCE(p->frame_deadline);
+	now = local_clock();
+	seq_printf(m, "%llu\n", deadline > now ? deadline - now : 0);
+
+	put_task_struct(p);
+
+	return 0;
+}
+
+static int frame_deadline_open(struct inode *inode, struct file *filp)
+{
+	return single_open(filp, frame_deadline_show, inode);
+}
+
+static const struct file_operations proc_frame_deadline_operations = {
+	.open		= frame_deadline_open,
+	.read		= seq_read,
+	.write		= frame_deadline_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+#endif /* CONFIG_SCHED_FRAME_DEADLINE */
+
 static int proc_pident_instantiate(struct inode *dir,
 	struct dentry *dentry, struct task_struct *task, const void *ptr)
 {
@@ -2935,6 +3038,9 @@ static const struct pid_entry tgid_base_stuff[] = {
 #ifdef CONFIG_SCHED_INFO
 	ONE("schedstat",  S_IRUGO, proc_pid_schedstat),
 #endif
+#ifdef CONFIG_MMAP_SEM_STAT
+	ONE("mmap_sem_stat", S_IRUGO, proc_pid_mmap_sem_stat),
+#endif
 #ifdef CONFIG_LATENCYTOP
 	REG("latency",  S_IRUGO, proc_lstats_operations),
 #endif
@@ -3295,6 +3401,9 @@ static const struct pid_entry tid_base_stuff[] = {
 	ONE("limits",	 S_IRUGO, proc_pid_limits),
 #ifdef CONFIG_SCHED_DEBUG
 	REG("sched",     S_IRUGO|S_IWUSR, proc_pid_sched_operations),
+#endif
+#ifdef CONFIG_SCHED_FRAME_DEADLINE
+	REG("frame_deadline", S_IRUGO|S_IWUGO, proc_frame_deadline_operations),
 #endif
 	NOD("comm",      S_IFREG|S_IRUGO|S_IWUSR,
 			 &proc_tid_comm_inode_operations,
@@ -3336,6 +3445,9 @@ static const struct pid_entry tid_base_stuff[] = {
 #ifdef CONFIG_SCHED_INFO
 	ONE("schedstat", S_IRUGO, proc_pid_schedstat),
 #endif
+#ifdef CONFIG_MMAP_SEM_STAT
+	ONE("mmap_sem_stat", S_IRUGO, proc_pid_mmap_sem_stat),
+#endif
 #ifdef CONFIG_LATENCYTOP
 	REG("latency",  S_IRUGO, proc_lstats_operations),
 #endif
@@ -17,6 +17,7 @@
 
 struct ctl_table_header;
 struct mempolicy;
+struct proc_pid_stats;
 
 /*
  * This is not completely implemented yet. The idea is to
@@ -155,6 +156,10 @@ extern int proc_pid_status(struct seq_file *, struct pid_namespace *,
 			   struct pid *, struct task_struct *);
 extern int proc_pid_statm(struct seq_file *, struct pid_namespace *,
 			  struct pid *, struct task_struct *);
+extern void proc_pid_stats_fill(struct pid_namespace *, struct task_struct *,
+				struct proc_pid_stats *);
+extern bool has_pid_permissions(struct pid_namespace *, struct task_struct *,
+				int);
 extern int proc_pid_statlmkd(struct seq_file *, struct pid_namespace *,
 			  struct pid *, struct task_struct *);
 /*
@@ -0,0 +1,136 @@
+/*
+ * /proc/pid_stats - fixed-layout stat/statm records for a list of pids
+ *
+ * Pollers such as ActivityManager sample hundreds of processes every few
+ * seconds. Reading /proc/<pid>/stat and statm for each one is an open,
+ * read, close and text parse per file; here one write() of the pid list
+ * and one read() per sample do the same.
+ */
+#include <linux/fs.h>
+#include <linux/init.h>
+#include <linux/pid_namespace.h>
+#include <linux/proc_fs.h>
+#include <linux/proc_pid_stats.h>
+#include <linux/sched.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+#include <linux/vmalloc.h>
+#include "internal.h"
+
+struct pid_stats_file {
+	struct mutex	lock;
+	unsigned int	nr;
+	pid_t		pids[PROC_PID_STATS_MAX];
+};
+
+static int pid_stats_open(struct inode *inode, struct file *file)
+{
+	struct pid_stats_file *psf;
+
+	psf = vzalloc(sizeof(*psf));
+	if (!psf)
+		return -ENOMEM;
+
+	mutex_init(&psf->lock);
+	file->private_data = psf;
+	return 0;
+}
+
+static int pid_stats_release(struct inode *inode, struct file *file)
+{
+	vfree(file->private_data);
+	return 0;
+}
+
+static ssize_t pid_stats_write(struct file *file, const char __user *buf,
+			       size_t count, loff_t *ppos)
+{
+	struct pid_stats_file *psf = file->private_data;
+
+	if (!count || count % sizeof(pid_t) ||
+	    count > sizeof(psf->pids))
+		return -EINVAL;
+
+	mutex_lock(&psf->lock);
+	if (copy_from_user(psf->pids, buf, count)) {
+		psf->nr = 0;
+		mutex_unlock(&psf->lock);
+		return -EFAULT;
+	}
+	psf->nr = count / sizeof(pid_t);
+	mutex_unlock(&psf->lock);
+
+	return count;
+}
+
+static void pid_stats_one(struct pid_namespace *ns, pid_t nr,
+			  struct proc_pid_stats *st)
+{
+	struct task_struct *task;
+
+	memset(st, 0, sizeof(*st));
+	st->pid = nr;
+
+	rcu_read_lock();
+	task = find_task_by_pid_ns(nr, ns);
+	if (task)
+		get_task_struct(task);
+	rcu_read_unlock();
+	if (!task)
+		return;
+
+	/* same visibility as /proc/<pid> under hidepid= */
+	if (pid_alive(task) && has_pid_permissions(ns, task, 1)) {
+		proc_pid_stats_fill(ns, task, st);
+		st->flags |= PROC_PID_STATS_VALID;
+	}
+	put_task_struct(task);
+}
+
+static ssize_t pid_stats_read(struct file *file, char __user *buf,
+			      size_t count, loff_t *ppos)
+{
+	struct pid_stats_file *psf = file->private_data;
+	struct pid_namespace *ns = file_inode(file)->i_sb->s_fs_info;
+	struct proc_pid_stats st;
+	unsigned int i;
+	ssize_t ret = 0;
+
+	if (*ppos % sizeof(st))
+		return -EINVAL;
+
+	mutex_lock(&psf->lock);
+	for (i = *ppos / sizeof(st); i < psf->nr; i++) {
+		if (count - ret < sizeof(st))
+			break;
+
+		pid_stats_one(ns, psf->pids[i], &st);
+		if (copy_to_user(buf + ret, &st, sizeof(st))) {
+			ret = ret ? ret : -EFAULT;
+			break;
+		}
+		ret += sizeof(st);
+		cond_resched();
+	}
+	mutex_unlock(&psf->lock);
+
+	if (ret > 0)
+		*ppos += ret;
+	return ret;
+}
+
+static const struct file_operations proc_pid_stats_operations = {
+	.open		= pid_stats_open,
+	.read		= pid_stats_read,
+	.write		= pid_stats_write,
+	.llseek		= default_llseek,
+	.release	= pid_stats_release,
+};
+
+static int __init proc_pid_stats_init(void)
+{
+	proc_create("pid_stats", S_IRUGO | S_IWUGO, NULL,
+		    &proc_pid_stats_operations);
+	return 0;
+}
+fs_initcall(proc_pid_stats_init);
@@ -28,7 +28,12 @@
 #include <linux/console.h>
 #include <linux/module.h>
 #include <linux/pstore.h>
+#ifdef CONFIG_PSTORE_ZLIB_COMPRESS
 #include <linux/zlib.h>
+#endif
+#ifdef CONFIG_PSTORE_LZ4_COMPRESS
+#include <linux/lz4.h>
+#endif
 #include <linux/string.h>
 #include <linux/timer.h>
 #include <linux/slab.h>
@@ -68,11 +73,17 @@ struct pstore_info *psinfo;
 
 static char *backend;
 
+#ifdef CONFIG_PSTORE_ZLIB_COMPRESS
 /* Compression parameters */
 #define COMPR_LEVEL 6
 #define WINDOW_BITS 12
 #define MEM_LEVEL 4
 static struct z_stream_s stream;
+#endif
+
+#ifdef CONFIG_PSTORE_LZ4_COMPRESS
+static void *lz4_workspace;
+#endif
 
 static char *big_oops_buf;
 static size_t big_oops_buf_sz;
@@ -129,6 +140,7 @@ bool pstore_cannot_block_path(enum kmsg_dump_reason reason)
 }
 EXPORT_SYMBOL_GPL(pstore_cannot_block_path);
 
+#ifdef CONFIG_PSTORE_ZLIB_COMPRESS
 /* Derived from logfs_compress() */
 static int pstore_compress(const void *in, void *out, size_t inlen,
 							size_t outlen)
@@ -244,6 +256,58 @@ static void free_buf_for_compression(void)
 	kfree(big_oops_buf);
 	big_oops_buf = NULL;
 }
+#endif
+
+#ifdef CONFIG_PSTORE_LZ4_COMPRESS
+static int pstore_compress(const void *in, void *out, size_t inlen,
+							size_t outlen)
+{
+	int ret;
+
+	ret = LZ4_compress_default(in, out, inlen, outlen, lz4_workspace);
+	if (ret <= 0 || ret >= inlen)
+		return -EIO;
+
+	return ret;
+}
+
+static int pstore_decompress(void *in, void *out, size_t inlen, size_t outlen)
+{
+	int ret;
+
+	ret = LZ4_decompress_safe(in, out, inlen, outlen);
+	if (ret < 0)
+		return -EIO;
+
+	return ret;
+}
+
+static void allocate_buf_for_compression(void)
+{
+	/* LZ4 gets about half the ratio of zlib on kernel logs */
+	big_oops_buf_sz = psinfo->bufsize * 2;
+	big_oops_buf = kmalloc(big_oops_buf_sz, GFP_KERNEL);
+	if (big_oops_buf) {
+		lz4_workspace = kmalloc(LZ4_MEM_COMPRESS, GFP_KERNEL);
+		if (!lz4_workspace) {
+			pr_err("No memory for compression workspace; skipping compression\n");
+			kfree(big_oops_buf);
+			big_oops_buf = NULL;
+		}
+	} else {
+		pr_err("No memory for uncompressed data; skipping compression\n");
+		lz4_workspace = NULL;
+	}
+}
+
+static void free_buf_for_compression(void)
+{
+	kfree(lz4_workspace);
+	lz4_workspace = NULL;
+	kfree(big_oops_buf);
+	big_oops_buf = NULL;
+}
+#endif
 
 /*
  * Called when compression fails, since the printk buffer
@@ -386,6 +450,18 @@ static void pstore_console_write(struct console *con, const char *s, unsigned c)
 		if (c > psinfo->bufsize)
 			c = psinfo->bufsize;
 
+		/*
+		 * Don't drop console lines in an oops just because a dump
+		 * holds buf_lock, the backend doesn't need it.
+		 */
+		if (psinfo->flags & PSTORE_FLAGS_CONSOLE_NOLOCK) {
+			psinfo->write_buf(PSTORE_TYPE_CONSOLE, 0, &id, 0,
+					  s, 0, c, psinfo);
+			s += c;
+			c = e - s;
+			continue;
+		}
+
 		if (oops_in_progress) {
 			if (!spin_trylock_irqsave(&psinfo->buf_lock, flags))
 				break;
@@ -49,6 +49,10 @@ static ulong ramoops_console_size = MIN_MEM_SIZE;
 module_param_named(console_size, ramoops_console_size, ulong, 0400);
 MODULE_PARM_DESC(console_size, "size of kernel console log");
 
+static bool ramoops_console_per_cpu;
+module_param_named(console_per_cpu, ramoops_console_per_cpu, bool, 0400);
+MODULE_PARM_DESC(console_per_cpu, "split the console log into per-CPU zones");
+
 static ulong ramoops_ftrace_size = MIN_MEM_SIZE;
 module_param_named(ftrace_size, ramoops_ftrace_size, ulong, 0400);
 MODULE_PARM_DESC(ftrace_size, "size of ftrace log");
@@ -86,7 +90,7 @@ MODULE_PARM_DESC(ramoops_ecc,
 
 struct ramoops_context {
 	struct persistent_ram_zone **przs;
-	struct persistent_ram_zone *cprz;
+	struct persistent_ram_zone **cprzs;
 	struct persistent_ram_zone *fprz;
 	struct persistent_ram_zone *mprz;
 	phys_addr_t phys_addr;
@@ -97,8 +101,10 @@ struct ramoops_context {
 	size_t ftrace_size;
 	size_t pmsg_size;
 	int dump_oops;
+	u32 flags;
 	struct persistent_ram_ecc_info ecc_info;
 	unsigned int max_dump_cnt;
+	unsigned int max_console_cnt;
 	unsigned int dump_write_cnt;
 	/* _read_cnt need clear on ramoops_pstore_open */
 	unsigned int dump_read_cnt;
@@ -216,9 +222,10 @@ static ssize_t ramoops_pstore_read(u64 *id, enum pstore_type_id *type,
 		}
 	}
 
-	if (!prz_ok(prz))
-		prz = ramoops_get_next_prz(&cxt->cprz, &cxt->console_read_cnt,
-					   1, id, type, PSTORE_TYPE_CONSOLE, 0);
+	while (cxt->console_read_cnt < cxt->max_console_cnt && !prz_ok(prz))
+		prz = ramoops_get_next_prz(cxt->cprzs, &cxt->console_read_cnt,
+					   cxt->max_console_cnt, id, type,
+					   PSTORE_TYPE_CONSOLE, 0);
 	if (!prz_ok(prz))
 		prz = ramoops_get_next_prz(&cxt->fprz, &cxt->ftrace_read_cnt,
 					   1, id, type, PSTORE_TYPE_FTRACE, 0);
@@ -266,6 +273,25 @@ static size_t ramoops_write_kmsg_hdr(struct persistent_ram_zone *prz,
 	return len;
 }
 
+/*
+ * With per-CPU console zones every CPU writes its own zone with interrupts
+ * off, so the zones need no lock.
+ */
+static void notrace ramoops_console_write(struct ramoops_context *cxt,
+					  const char *buf, size_t size)
+{
+	unsigned long flags;
+
+	if (cxt->max_console_cnt == 1) {
+		persistent_ram_write(cxt->cprzs[0], buf, size);
+		return;
+	}
+
+	local_irq_save(flags);
+	persistent_ram_write(cxt->cprzs[smp_processor_id()], buf, size);
+	local_irq_restore(flags);
+}
+
 static int notrace ramoops_pstore_write_buf(enum pstore_type_id type,
 					    enum kmsg_dump_reason reason,
 					    u64 *id, unsigned int part,
@@ -278,9 +304,9 @@ static int notrace ramoops_pstore_write_buf(enum pstore_type_id type,
 	size_t hlen;
 
 	if (type == PSTORE_TYPE_CONSOLE) {
-		if (!cxt->cprz)
+		if (!cxt->max_console_cnt)
 			return -ENOMEM;
-		persistent_ram_write(cxt->cprz, buf, size);
+		ramoops_console_write(cxt, buf, size);
 		return 0;
 	} else if (type == PSTORE_TYPE_FTRACE) {
 		if (!cxt->fprz)
@@ -373,7 +399,9 @@ static int ramoops_pstore_erase(enum pstore_type_id type, u64 id, int count,
 		prz = cxt->przs[id];
 		break;
 	case PSTORE_TYPE_CONSOLE:
-		prz = cxt->cprz;
+		if (id >= cxt->max_console_cnt)
+			return -EINVAL;
+		prz = cxt->cprzs[id];
 		break;
 	case PSTORE_TYPE_FTRACE:
 		prz = cxt->fprz;
@@ -470,7 +498,7 @@ fail_mem:
 
 static int ramoops_init_prz(struct device *dev, struct ramoops_context *cxt,
 			    struct persistent_ram_zone **prz,
-			    phys_addr_t *paddr, size_t sz, u32 sig)
+			    phys_addr_t *paddr, size_t sz, u32 sig, u32 flags)
 {
 	if (!sz)
 		return 0;
@@ -483,7 +511,7 @@ static int ramoops_init_prz(struct device *dev, struct ramoops_context *cxt,
 	}
 
 	*prz = persistent_ram_new(*paddr, sz, sig, &cxt->ecc_info,
-				  cxt->memtype, 0);
+				  cxt->memtype, flags);
 	if (IS_ERR(*prz)) {
 		int err = PTR_ERR(*prz);
 
@@ -499,10 +527,72 @@ static int ramoops_init_prz(struct device *dev, struct ramoops_context *cxt,
 	return 0;
 }
 
+static void ramoops_free_cprzs(struct ramoops_context *cxt)
+{
+	int i;
+
+	if (!cxt->cprzs)
+		return;
+
+	for (i = 0; i < cxt->max_console_cnt; i++)
+		persistent_ram_free(cxt->cprzs[i]);
+
+	kfree(cxt->cprzs);
+	cxt->cprzs = NULL;
+	cxt->max_console_cnt = 0;
+}
+
+static int ramoops_init_cprzs(struct device *dev, struct ramoops_context *cxt,
+			      phys_addr_t *paddr)
+{
+	phys_addr_t start = *paddr;
+	unsigned int cnt = 1;
+	size_t zone_sz = cxt->console_size;
+	u32 flags = 0;
+	int err;
+	int i;
+
+	if (!cxt->console_size)
+		return 0;
+
+	if (cxt->flags & RAMOOPS_FLAG_CONSOLE_PER_CPU) {
+		if (cxt->console_size / nr_cpu_ids >= MIN_MEM_SIZE) {
+			cnt = nr_cpu_ids;
+			zone_sz = rounddown_pow_of_two(cxt->console_size / cnt);
+			flags = PRZ_FLAG_NO_LOCK;
+		} else {
+			dev_warn(dev, "console too small for per-CPU zones\n");
+		}
+	}
+
+	cxt->cprzs = kcalloc(cnt, sizeof(*cxt->cprzs), GFP_KERNEL);
+	if (!cxt->cprzs) {
+		dev_err(dev, "failed to initialize a prz array for console\n");
+		return -ENOMEM;
+	}
+	cxt->max_console_cnt = cnt;
+
+	for (i = 0; i < cnt; i++) {
+		err = ramoops_init_prz(dev, cxt, &cxt->cprzs[i], paddr,
+				       zone_sz, 0, flags);
+		if (err) {
+			ramoops_free_cprzs(cxt);
+			return err;
+		}
+	}
+
+	/* Keep the layout behind the console area independent of the split */
+	*paddr = start + cxt->console_size;
+
+	return 0;
+}
+
 void notrace ramoops_console_write_buf(const char *buf, size_t size)
 {
 	struct ramoops_context *cxt = &oops_cxt;
-	persistent_ram_write(cxt->cprz, buf, size);
+
+	if (cxt->max_console_cnt)
+		ramoops_console_write(cxt, buf, size);
 }
 
 static int ramoops_parse_dt_size(struct platform_device *pdev,
@@ -559,6 +649,8 @@ static int ramoops_parse_dt(struct platform_device *pdev,
 	pdata->mem_address = res.start;
 	pdata->mem_type = of_property_read_bool(of_node, "unbuffered");
 	pdata->dump_oops = !of_property_read_bool(of_node, "no-dump-oops");
+	if (of_property_read_bool(of_node, "console-per-cpu"))
+		pdata->flags |= RAMOOPS_FLAG_CONSOLE_PER_CPU;
 
 	ret = ramoops_parse_dt_size(pdev, "record-size", &pdata->record_size);
 	if (ret < 0)
@@ -641,6 +733,7 @@ static int ramoops_probe(struct platform_device *pdev)
 	cxt->ftrace_size = pdata->ftrace_size;
 	cxt->pmsg_size = pdata->pmsg_size;
 	cxt->dump_oops = pdata->dump_oops;
+	cxt->flags = pdata->flags;
 	cxt->ecc_info = pdata->ecc_info;
 
 	paddr = cxt->phys_addr;
@@ -651,21 +744,23 @@ static int ramoops_probe(struct platform_device *pdev)
 	if (err)
 		goto fail_out;
 
-	err = ramoops_init_prz(dev, cxt, &cxt->cprz, &paddr,
-			       cxt->console_size, 0);
+	err = ramoops_init_cprzs(dev, cxt, &paddr);
 	if (err)
 		goto fail_init_cprz;
 
 	err = ramoops_init_prz(dev, cxt, &cxt->fprz, &paddr, cxt->ftrace_size,
-			       LINUX_VERSION_CODE);
+			       LINUX_VERSION_CODE, 0);
 	if (err)
 		goto fail_init_fprz;
 
-	err = ramoops_init_prz(dev, cxt, &cxt->mprz, &paddr, cxt->pmsg_size, 0);
+	err = ramoops_init_prz(dev, cxt, &cxt->mprz, &paddr, cxt->pmsg_size, 0,
+			       0);
 	if (err)
 		goto fail_init_mprz;
 
 	cxt->pstore.data = cxt;
+	if (cxt->max_console_cnt > 1)
+		cxt->pstore.flags |= PSTORE_FLAGS_CONSOLE_NOLOCK;
 	/*
 	 * Console can handle any buffer size, so prefer LOG_LINE_MAX. If we
 	 * have to handle dumps, we must have at least record_size buffer. And
@@ -698,6 +793,7 @@ static int ramoops_probe(struct platform_device *pdev)
 	record_size = pdata->record_size;
 	dump_oops = pdata->dump_oops;
 	ramoops_console_size = pdata->console_size;
+	ramoops_console_per_cpu = cxt->max_console_cnt > 1;
 	ramoops_pmsg_size = pdata->pmsg_size;
 	ramoops_ftrace_size = pdata->ftrace_size;
 
@@ -715,7 +811,7 @@ fail_clear:
 fail_init_mprz:
 	kfree(cxt->fprz);
 fail_init_fprz:
-	kfree(cxt->cprz);
+	ramoops_free_cprzs(cxt);
 fail_init_cprz:
 	ramoops_free_przs(cxt);
 fail_out:
@@ -733,7 +829,7 @@ static int ramoops_remove(struct platform_device *pdev)
 
 	persistent_ram_free(cxt->mprz);
 	persistent_ram_free(cxt->fprz);
-	persistent_ram_free(cxt->cprz);
+	ramoops_free_cprzs(cxt);
 	ramoops_free_przs(cxt);
 
 	return 0;
@@ -774,6 +870,8 @@ static void ramoops_register_dummy(void)
 	dummy_data->ftrace_size = ramoops_ftrace_size;
 	dummy_data->pmsg_size = ramoops_pmsg_size;
 	dummy_data->dump_oops = dump_oops;
+	if (ramoops_console_per_cpu)
+		dummy_data->flags |= RAMOOPS_FLAG_CONSOLE_PER_CPU;
 	/*
 	 * For backwards compatibility ramoops.ecc=1 means 16 bytes ECC
 	 * (using 1 byte for ECC isn't much of use anyway).
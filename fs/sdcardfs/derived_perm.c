@@ -20,6 +20,17 @@
 
 #include "sdcardfs.h"
 
+/* source of unique derivation stamps, 0 means never derived */
+static atomic64_t derive_stamp_seq = ATOMIC64_INIT(0);
+
+static inline void stamp_derived_state(struct sdcardfs_inode_data *data,
+		struct sdcardfs_inode_data *parent_data, unsigned int gen)
+{
+	data->derive_gen = gen;
+	data->parent_stamp = parent_data ? parent_data->derive_stamp : 0;
+	data->derive_stamp = atomic64_inc_return(&derive_stamp_seq);
+}
+
 /* copy derived state from parent inode */
 static void inherit_derived_state(struct inode *parent, struct inode *child)
 {
@@ -48,6 +59,7 @@ void setup_derived_state(struct inode *inode, perm_t perm, userid_t userid,
 	info->data->under_cache = false;
 	info->data->under_obb = false;
 	info->data->under_knox = false;
+	stamp_derived_state(info->data, NULL, packagelist_generation());
 }
 
 /* While renaming, there is a point where we want the path from dentry,
@@ -71,6 +83,8 @@ void get_derived_permission_new(struct dentry *parent, struct dentry *dentry,
 	/* refer to perm_t in sdcardfs.h */
 	struct qstr q_knox = QSTR_LITERAL("knox");
 	struct qstr q_shared = QSTR_LITERAL("shared");
+	/* before the package list is read, so a change forces a redo */
+	unsigned int gen = packagelist_generation();
 
 	/* By default, each inode inherits from its parent.
 	 * the properties are maintained on its private fields
@@ -81,6 +95,7 @@ void get_derived_permission_new(struct dentry *parent, struct dentry *dentry,
 	 */
 
 	inherit_derived_state(d_inode(parent), d_inode(dentry));
+	stamp_derived_state(info->data, parent_data, gen);
 
 	/* Files don't get special labels */
 	if (!S_ISDIR(d_inode(dentry)->i_mode)) {
@@ -191,8 +206,27 @@ void get_derived_permission_new(struct dentry *parent, struct dentry *dentry,
 	}
 }
 
+/*
+ * The derived state only depends on the parent's state, the name and
+ * the package list. Redo it only if the parent was derived again since,
+ * or the package list has changed; lookups of a media scan mostly hit.
+ * Renames call get_derived_permission_new() directly.
+ */
+static bool derived_state_valid(struct dentry *parent, struct dentry *dentry)
+{
+	struct sdcardfs_inode_data *data = SDCARDFS_I(d_inode(dentry))->data;
+	struct sdcardfs_inode_data *parent_data =
+				SDCARDFS_I(d_inode(parent))->data;
+
+	return data->derive_stamp &&
+		data->parent_stamp == parent_data->derive_stamp &&
+		data->derive_gen == packagelist_generation();
+}
+
 void get_derived_permission(struct dentry *parent, struct dentry *dentry)
 {
+	if (derived_state_valid(parent, dentry))
+		return;
 	get_derived_permission_new(parent, dentry, &dentry->d_name);
 }
 
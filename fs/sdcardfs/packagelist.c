@@ -45,6 +45,21 @@ static DEFINE_HASHTABLE(ext_to_groupid, 8);
 
 static struct kmem_cache *hashtable_entry_cachep;
 
+/* bumped whenever a lookup on the tables above could change its result */
+static atomic_t packagelist_gen = ATOMIC_INIT(0);
+
+unsigned int packagelist_generation(void)
+{
+	return atomic_read(&packagelist_gen);
+}
+
+static inline void packagelist_changed(void)
+{
+	atomic_inc(&packagelist_gen);
+	/* publish the new generation before redoing any derivation */
+	smp_mb__after_atomic();
+}
+
 static unsigned int full_name_case_hash(const unsigned char *name, unsigned int len)
 {
 	unsigned long hash = init_name_hash();
@@ -295,8 +310,10 @@ static int insert_packagelist_entry(const struct qstr *key, appid_t value)
 
 	mutex_lock(&sdcardfs_super_list_lock);
 	err = insert_packagelist_appid_entry_locked(key, value);
-	if (!err)
+	if (!err) {
+		packagelist_changed();
 		fixup_all_perms_name(key);
+	}
 	mutex_unlock(&sdcardfs_super_list_lock);
 
 	return err;
@@ -319,8 +336,10 @@ static int insert_userid_exclude_entry(const struct qstr *key, userid_t value)
 
 	mutex_lock(&sdcardfs_super_list_lock);
 	err = insert_userid_exclude_entry_locked(key, value);
-	if (!err)
+	if (!err) {
+		packagelist_changed();
 		fixup_all_perms_name_userid(key, value);
+	}
 	mutex_unlock(&sdcardfs_super_list_lock);
 
 	return err;
@@ -361,6 +380,7 @@ static void remove_packagelist_entry(const struct qstr *key)
 {
 	mutex_lock(&sdcardfs_super_list_lock);
 	remove_packagelist_entry_locked(key);
+	packagelist_changed();
 	fixup_all_perms_name(key);
 	mutex_unlock(&sdcardfs_super_list_lock);
 }
@@ -410,6 +430,7 @@ static void remove_userid_all_entry(userid_t userid)
 {
 	mutex_lock(&sdcardfs_super_list_lock);
 	remove_userid_all_entry_locked(userid);
+	packagelist_changed();
 	fixup_all_perms_userid(userid);
 	mutex_unlock(&sdcardfs_super_list_lock);
 }
@@ -434,6 +455,7 @@ static void remove_userid_exclude_entry(const struct qstr *key, userid_t userid)
 {
 	mutex_lock(&sdcardfs_super_list_lock);
 	remove_userid_exclude_entry_locked(key, userid);
+	packagelist_changed();
 	fixup_all_perms_name_userid(key, userid);
 	mutex_unlock(&sdcardfs_super_list_lock);
 }
@@ -457,6 +479,7 @@ static void packagelist_destroy(void)
 	synchronize_rcu();
 	hlist_for_each_entry_safe(hash_cur, h_t, &free_list, dlist)
 		free_hashtable_entry(hash_cur);
+	packagelist_changed();
 	mutex_unlock(&sdcardfs_super_list_lock);
 	pr_info("sdcardfs: destroyed packagelist pkgld\n");
 }
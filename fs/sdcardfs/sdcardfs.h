@@ -195,6 +195,11 @@ struct sdcardfs_inode_data {
 	bool under_obb;
 
 	bool under_knox;
+
+	/* derivation cache, see get_derived_permission() */
+	u64 derive_stamp;		/* unique per derivation */
+	u64 parent_stamp;		/* parent's stamp derived from */
+	unsigned int derive_gen;	/* package list generation used */
 };
 
 /* sdcardfs inode data in memory */
@@ -539,6 +544,7 @@ extern appid_t is_excluded(const char *app_name, userid_t userid);
 extern int check_caller_access_to_name(struct inode *parent_node, const struct qstr *name);
 extern int packagelist_init(void);
 extern void packagelist_exit(void);
+extern unsigned int packagelist_generation(void);
 
 /* for derived_perm.c */
 #define BY_NAME		(1 << 0)
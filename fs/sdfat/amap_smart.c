@@ -315,21 +315,21 @@ AU_INFO_T *amap_pop_cold_au_largest(AMAP_T *amap, uint16_t start_fclu)
  * ===============================================
  */
 
+static void amap_build_work(struct work_struct *work);
+
 /* Create AMAP related data structure (mount time) */
 int amap_create(struct super_block *sb, u32 pack_ratio, u32 sect_per_au, u32 hidden_sect)
 {
 	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
 	AMAP_T *amap;
-	int total_used_clusters;
 	int n_au_table = 0;
-	int i, i_clu, i_au;
-	int i_au_root = -1, i_au_hot_from = INT_MAX;
+	int i;
 	u32 misaligned_sect = hidden_sect;
 	u64 tmp;
 
 	BUG_ON(!fsi->bd_opened);
 
-	if (fsi->amap)
+	if (fsi->amap || fsi->amap_build)
 		return -EEXIST;
 
 	/* Check conditions */
@@ -461,12 +461,6 @@ int amap_create(struct super_block *sb, u32 pack_ratio, u32 sect_per_au, u32 hid
 	amap->n_need_packing = 0;
 
 
-	/* Build AMAP info */
-	total_used_clusters = 0;		// Count # of used clusters
-
-	i_au_root = i_AU_of_CLU(amap, fsi->root_dir);
-	i_au_hot_from = amap->n_au - (SMART_ALLOC_N_HOT_AU - 1);
-
 	for (i = 0; i < amap->clusters_per_au; i++)
 		INIT_LIST_HEAD(&amap->fclu_nodes[i].head);
 
@@ -477,24 +471,99 @@ int amap_create(struct super_block *sb, u32 pack_ratio, u32 sect_per_au, u32 hid
 	 * amap->entries[i_au].head.next = NULL;
 	 */
 
-	/* Parse FAT table */
-	for (i_clu = CLUS_BASE; i_clu < fsi->num_clusters; i_clu++) {
+	/*
+	 * FAT table is parsed by amap_build_start() after mount.
+	 * Until then used_clusters only counts the scanned part.
+	 */
+	INIT_WORK(&amap->build_work, amap_build_work);
+	amap->build_clu = CLUS_BASE;
+	fsi->used_clusters = 0;
+	fsi->amap_build = amap;
+
+	return 0;
+}
+
+static void __amap_free(AMAP_T *amap)
+{
+	int n_au_table;
+
+	n_au_table = (amap->n_au + N_AU_PER_TABLE - 1) / N_AU_PER_TABLE;
+
+	if (amap->au_table) {
+		int i;
+
+		for (i = 0; i < n_au_table; i++)
+			free_page((unsigned long)amap->au_table[i]);
+
+		kfree(amap->au_table);
+	}
+	if (amap->fclu_nodes) {
+		if (!amap->fclu_order)
+			free_page((unsigned long)amap->fclu_nodes);
+		else
+			vfree(amap->fclu_nodes);
+	}
+	kfree(amap);
+}
+
+
+/*
+ * ===============================================
+ * Background AMAP build
+ * ===============================================
+ *
+ * Parsing the whole FAT at mount takes seconds on large SD cards.
+ * Instead the FAT is scanned by a work in chunks of AMAP_BUILD_CHUNK
+ * entries, each under the volume lock. Until the scan is over
+ * - allocation uses the linear allocator (fat_fs_func),
+ * - smart allocation and defrag are turned off,
+ * - used_clusters and the AU counters only cover the scanned clusters,
+ *   and the allocator/free path keep them so with amap_build_account().
+ * All the functions below should be called with the volume lock held,
+ * except amap_build_start() and amap_build_stop().
+ */
+
+/* Scan up to @nr FAT entries. Returns 1 if more are left, 0 if done */
+static int __amap_build_scan(AMAP_T *amap, u32 nr)
+{
+	struct super_block *sb = amap->sb;
+	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
+	u32 end = min(amap->build_clu + nr, fsi->num_clusters);
+	u32 i_clu;
+
+	for (i_clu = amap->build_clu; i_clu < end; i_clu++) {
 		u32 clu_data;
 		AU_INFO_T *au;
 
 		if (fat_ent_get(sb, i_clu, &clu_data)) {
 			sdfat_msg(sb, KERN_ERR,
 				"failed to read fat entry(%u)\n", i_clu);
-			goto free_and_eio;
+			amap->build_clu = i_clu;
+			return -EIO;
 		}
 
 		if (IS_CLUS_FREE(clu_data)) {
 			au = GET_AU(amap, i_AU_of_CLU(amap, i_clu));
 			au->free_clusters++;
 		} else
-			total_used_clusters++;
+			fsi->used_clusters++;
 	}
 
+	amap->build_clu = end;
+	return (end < fsi->num_clusters) ? 1 : 0;
+}
+
+/* Build AU lists and enable smart allocation */
+static void __amap_build_done(AMAP_T *amap)
+{
+	struct super_block *sb = amap->sb;
+	struct sdfat_sb_info *sbi = SDFAT_SB(sb);
+	FS_INFO_T *fsi = &(sbi->fsi);
+	int i_au, i_au_root, i_au_hot_from;
+
+	i_au_root = i_AU_of_CLU(amap, fsi->root_dir);
+	i_au_hot_from = amap->n_au - (SMART_ALLOC_N_HOT_AU - 1);
+
 	/* Build AU list */
 	for (i_au = 0; i_au < amap->n_au; i_au++) {
 		AU_INFO_T *au = GET_AU(amap, i_au);
@@ -523,70 +592,163 @@ int amap_create(struct super_block *sb, u32 pack_ratio, u32 sect_per_au, u32 hid
 		amap->total_fclu_hot += GET_AU(amap, i_au_root)->free_clusters;
 	}
 
+	fsi->amap_build = NULL;
 	fsi->amap = amap;
-	fsi->used_clusters = total_used_clusters;
+	sbi->options.improved_allocation = amap->build_alloc;
+	sbi->options.defrag = amap->build_defrag;
+	fat_enable_smart_alloc(sb);
 
 	sdfat_msg(sb, KERN_INFO,
 			"AMAP: Smart allocation enabled (opt : %u / %u / %u)",
 			amap->option.au_size, amap->option.au_align_factor,
 			amap->option.packing_ratio);
+}
 
-	/* Debug purpose - check */
-	//{
-	//u32 used_clusters;
-	//fat_count_used_clusters(sb, &used_clusters)
-	//ASSERT(used_clusters == total_used_clusters);
-	//}
+/* Scan failed, stay with the linear allocator */
+static void __amap_build_fail(AMAP_T *amap)
+{
+	struct super_block *sb = amap->sb;
+	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
+	u32 used_clusters;
 
-	return 0;
+	sdfat_log_msg(sb, KERN_WARNING, "failed to build AMAP."
+			" disabling smart allocation.");
 
+	fsi->amap_build = NULL;
+	SDFAT_SB(sb)->options.improved_allocation =
+			amap->build_alloc & ~(SDFAT_ALLOC_SMART);
 
-free_and_eio:
-	if (amap) {
-		if (amap->au_table) {
-			for (i = 0; i < n_au_table; i++)
-				free_page((unsigned long)amap->au_table[i]);
-			kfree(amap->au_table);
-		}
-		if (amap->fclu_nodes) {
-			if (!amap->fclu_order)
-				free_page((unsigned long)amap->fclu_nodes);
-			else
-				vfree(amap->fclu_nodes);
-		}
-		kfree(amap);
-	}
-	return -EIO;
+	/* Keep the partial count if the FAT can not be read at all */
+	if (!fsi->fs_func->count_used_clusters(sb, &used_clusters))
+		fsi->used_clusters = used_clusters;
+
+	__amap_free(amap);
 }
 
+static int __amap_build_step(AMAP_T *amap, u32 nr)
+{
+	int ret = __amap_build_scan(amap, nr);
 
-/* Free AMAP related structure */
-void amap_destroy(struct super_block *sb)
+	if (ret < 0)
+		__amap_build_fail(amap);
+	else if (!ret)
+		__amap_build_done(amap);
+	return ret;
+}
+
+static void amap_build_work(struct work_struct *work)
 {
-	AMAP_T *amap = SDFAT_SB(sb)->fsi.amap;
-	int n_au_table;
+	AMAP_T *amap = container_of(work, AMAP_T, build_work);
+	struct sdfat_sb_info *sbi = SDFAT_SB(amap->sb);
+	int ret;
+
+	do {
+		mutex_lock(&sbi->s_vlock);
+		/* amap may be done (or freed) by amap_build_finish() */
+		if (sbi->fsi.amap_build != amap || amap->build_stop) {
+			mutex_unlock(&sbi->s_vlock);
+			return;
+		}
+		ret = __amap_build_step(amap, AMAP_BUILD_CHUNK);
+		mutex_unlock(&sbi->s_vlock);
+
+		cond_resched();
+	} while (ret > 0);
+}
+
+/* Called at the end of mount */
+void amap_build_start(struct super_block *sb)
+{
+	struct sdfat_sb_info *sbi = SDFAT_SB(sb);
+	AMAP_T *amap = sbi->fsi.amap_build;
 
 	if (!amap)
 		return;
 
-	DMSG("%s\n", __func__);
+	amap->build_alloc = sbi->options.improved_allocation;
+	amap->build_defrag = sbi->options.defrag;
+	sbi->options.improved_allocation &= ~(SDFAT_ALLOC_SMART);
+	sbi->options.defrag = 0;
 
-	n_au_table = (amap->n_au + N_AU_PER_TABLE - 1) / N_AU_PER_TABLE;
+	queue_work(system_long_wq, &amap->build_work);
+}
 
-	if (amap->au_table) {
-		int i;
+/* Called at umount, before taking the volume lock */
+void amap_build_stop(struct super_block *sb)
+{
+	struct sdfat_sb_info *sbi = SDFAT_SB(sb);
+	AMAP_T *amap;
 
-		for (i = 0; i < n_au_table; i++)
-			free_page((unsigned long)amap->au_table[i]);
+	mutex_lock(&sbi->s_vlock);
+	amap = sbi->fsi.amap_build;
+	if (amap)
+		amap->build_stop = 1;
+	mutex_unlock(&sbi->s_vlock);
 
-		kfree(amap->au_table);
-	}
-	if (!amap->fclu_order)
-		free_page((unsigned long)amap->fclu_nodes);
+	/* amap is freed only under umount, after this returns */
+	if (amap)
+		cancel_work_sync(&amap->build_work);
+}
+
+/* Finish the build in the caller's context */
+void amap_build_finish(struct super_block *sb)
+{
+	AMAP_T *amap = SDFAT_SB(sb)->fsi.amap_build;
+
+	while (amap && __amap_build_step(amap, AMAP_BUILD_CHUNK) > 0)
+		cond_resched();
+}
+
+/* Number of FAT entries the build has yet to scan */
+u32 amap_build_pending(struct super_block *sb)
+{
+	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
+	AMAP_T *amap = fsi->amap_build;
+
+	if (!amap)
+		return 0;
+	return fsi->num_clusters - amap->build_clu;
+}
+
+/*
+ * Account allocation (@alloc) or release of @clu while building.
+ * Returns 1 if the cluster is already scanned and the caller should
+ * update used_clusters, 0 if the scan will see it in its new state.
+ */
+s32 amap_build_account(struct super_block *sb, u32 clu, s32 alloc)
+{
+	AMAP_T *amap = SDFAT_SB(sb)->fsi.amap_build;
+	AU_INFO_T *au;
+
+	if (!amap)
+		return 1;
+
+	if (clu >= amap->build_clu)
+		return 0;
+
+	au = GET_AU(amap, i_AU_of_CLU(amap, clu));
+	if (alloc)
+		au->free_clusters--;
 	else
-		vfree(amap->fclu_nodes);
-	kfree(amap);
-	SDFAT_SB(sb)->fsi.amap = NULL;
+		au->free_clusters++;
+	return 1;
+}
+
+
+/* Free AMAP related structure */
+void amap_destroy(struct super_block *sb)
+{
+	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
+	AMAP_T *amap = fsi->amap ? fsi->amap : fsi->amap_build;
+
+	if (!amap)
+		return;
+
+	DMSG("%s\n", __func__);
+
+	__amap_free(amap);
+	fsi->amap = NULL;
+	fsi->amap_build = NULL;
 }
 
 
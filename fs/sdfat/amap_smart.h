@@ -21,6 +21,7 @@
 #include <linux/fs.h>
 #include <linux/list.h>
 #include <linux/rbtree.h>
+#include <linux/workqueue.h>
 
 /* AMAP Configuration Variable */
 #define SMART_ALLOC_N_HOT_AU    (5)
@@ -37,6 +38,9 @@
 /* Minimum sectors for support AMAP create */
 #define AMAP_MIN_SUPPORT_SECTORS	(1048576)
 
+/* FAT entries scanned per volume lock hold by the background build */
+#define AMAP_BUILD_CHUNK		(8192)
+
 #define amap_add_hot_au(amap, au) amap_insert_to_list(au, &amap->slist_hot)
 
 /* singly linked list */
@@ -104,6 +108,13 @@ typedef struct __AMAP_T {
 	TARGET_AU_T cur_cold;
 	TARGET_AU_T cur_hot;
 	int n_need_packing;
+
+	/* Background build at mount (see amap_build_start()) */
+	struct work_struct build_work;
+	unsigned int build_clu;		/* Next cluster to scan */
+	int build_stop;			/* Umount in progress */
+	unsigned char build_alloc;	/* Saved improved_allocation option */
+	unsigned char build_defrag;	/* Saved defrag option */
 } AMAP_T;
 
 
@@ -109,6 +109,9 @@ s32 fsapi_umount(struct super_block *sb)
 {
 	s32 err;
 
+	/* background AMAP build takes s_vlock by itself */
+	amap_build_stop(sb);
+
 	/* acquire the core lock for file system ccritical section */
 	mutex_lock(&_lock_core);
 
@@ -132,7 +135,11 @@ s32 fsapi_statfs(struct super_block *sb, VOL_INFO_T *info)
 	/* check the validity of pointer parameters */
 	ASSERT(info);
 
-	if (fsi->used_clusters == (u32) ~0) {
+	/*
+	 * While the AMAP build runs, fscore_statfs() also counts what it has
+	 * not scanned yet, and the build may end under s_vlock.
+	 */
+	if (fsi->used_clusters == (u32) ~0 || READ_ONCE(fsi->amap_build)) {
 		s32 err;
 
 		mutex_lock(&(SDFAT_SB(sb)->s_vlock));
@@ -566,6 +573,22 @@ s32 fsapi_dfr_map_clus(struct inode *inode, u32 clu_offset, u32 *clu)
 }
 EXPORT_SYMBOL(fsapi_dfr_map_clus);
 
+s32 fsapi_dfr_count_frags(struct inode *inode, u32 max_clus, u32 *nr_frags)
+{
+	s32 err;
+	struct super_block *sb = inode->i_sb;
+
+	/* check the validity of pointer parameters */
+	ASSERT(nr_frags);
+
+	mutex_lock(&(SDFAT_SB(sb)->s_vlock));
+	err = extent_count_frags(inode, max_clus, nr_frags);
+	mutex_unlock(&(SDFAT_SB(sb)->s_vlock));
+
+	return err;
+}
+EXPORT_SYMBOL(fsapi_dfr_count_frags);
+
 void fsapi_dfr_writepage_endio(struct page *page)
 {
 	/* volume lock is not required */
@@ -31,14 +31,18 @@ extern "C" {
 /*----------------------------------------------------------------------*/
 /* cache size (in number of sectors)                */
 /* (should be an exponential value of 2)            */
+/* Minimum sizes, grown with the volume at mount     */
 #define FAT_CACHE_SIZE          128
 #define FAT_CACHE_HASH_SIZE     64
 #define BUF_CACHE_SIZE          256
 #define BUF_CACHE_HASH_SIZE     64
+#define FAT_CACHE_MAX_SIZE      2048
+#define BUF_CACHE_MAX_SIZE      1024
 
 /* Read-ahead related                                */
 /* First config vars. should be pow of 2             */
 #define FCACHE_MAX_RA_SIZE	(PAGE_SIZE)
+#define FCACHE_SEQ_RA_SIZE	(128*1024)	// FAT-chain read-ahead
 #define DCACHE_MAX_RA_SIZE	(128*1024)
 
 /*----------------------------------------------------------------------*/
@@ -286,20 +290,28 @@ typedef struct __FS_INFO_T {
 
 	s32       reserved_clusters;  // # of reserved clusters (DA)
 	void        *amap;                  // AU Allocation Map
+	void        *amap_build;            // AMAP being built in background
 
 	/* fat cache */
 	struct {
-		cache_ent_t pool[FAT_CACHE_SIZE];
+		cache_ent_t *pool;
+		u32 size;                     // num of entries in pool
 		cache_ent_t lru_list;
-		cache_ent_t hash_list[FAT_CACHE_HASH_SIZE];
+		cache_ent_t *hash_list;
+		u32 hash_mask;                // num of hash lists - 1
+		u64 ra_last;                  // last missed sector
+		u64 ra_end;                   // end of read-ahead window
+		u32 ra_count;                 // window size in sectors
 	} fcache;
 
 	/* meta cache */
 	struct {
-		cache_ent_t pool[BUF_CACHE_SIZE];
+		cache_ent_t *pool;
+		u32 size;                     // num of entries in pool
 		cache_ent_t lru_list;
 		cache_ent_t keep_list;        // CACHEs in this list will not be kicked by normal lru operations
-		cache_ent_t hash_list[BUF_CACHE_HASH_SIZE];
+		cache_ent_t *hash_list;
+		u32 hash_mask;                // num of hash lists - 1
 	} dcache;
 } FS_INFO_T;
 
@@ -373,6 +385,7 @@ s32 fsapi_dfr_mark_ignore(struct super_block *sb, unsigned int clus);
 void fsapi_dfr_unmark_ignore_all(struct super_block *sb);
 
 s32 fsapi_dfr_map_clus(struct inode *inode, u32 clu_offset, u32 *clu);
+s32 fsapi_dfr_count_frags(struct inode *inode, u32 max_clus, u32 *nr_frags);
 void fsapi_dfr_writepage_endio(struct page *page);
 
 void fsapi_dfr_update_fat_prev(struct super_block *sb, int force);
@@ -29,6 +29,8 @@
 /************************************************************************/
 
 #include <linux/swap.h> /* for mark_page_accessed() */
+#include <linux/vmalloc.h>
+#include <linux/log2.h>
 #include <asm/unaligned.h>
 
 #include "sdfat.h"
@@ -187,11 +189,59 @@ static s32 __fcache_ent_discard(struct super_block *sb, cache_ent_t *bp)
 	return 0;
 }
 
+/*
+ * FAT read-ahead on fcache miss.
+ * A random miss only reads ahead the aligned page (naive read-ahead).
+ * Misses on consecutive sectors mean a cluster chain is being walked,
+ * so the window is doubled up to FCACHE_SEQ_RA_SIZE and the next one is
+ * issued when the walk reaches the middle of the current window.
+ */
+static void __fcache_readahead(struct super_block *sb, u64 sec)
+{
+	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
+	u32 page_ra_count = FCACHE_MAX_RA_SIZE >> sb->s_blocksize_bits;
+	u32 max_ra_count = FCACHE_SEQ_RA_SIZE >> sb->s_blocksize_bits;
+	u64 fat_end = fsi->FAT1_start_sector + fsi->num_FAT_sectors;
+	u64 ra_sec;
+	u32 ra_count;
+
+	if (sec != fsi->fcache.ra_last + 1 || sec >= fat_end) {
+		fsi->fcache.ra_last = sec;
+		fsi->fcache.ra_count = page_ra_count;
+		fsi->fcache.ra_end = sec + 1;
+
+		if ((sec & (page_ra_count - 1)) == 0) {
+			bdev_readahead(sb, sec, (u64)page_ra_count);
+			fsi->fcache.ra_end = sec + page_ra_count;
+		}
+		return;
+	}
+
+	fsi->fcache.ra_last = sec;
+
+	/* Still far enough from the end of the window */
+	if (sec + (fsi->fcache.ra_count >> 1) < fsi->fcache.ra_end)
+		return;
+
+	ra_sec = max(sec, fsi->fcache.ra_end);
+	ra_count = min(fsi->fcache.ra_count << 1, max_ra_count);
+	fsi->fcache.ra_count = ra_count;
+
+	if (ra_sec >= fat_end)
+		return;
+
+	if (ra_sec + ra_count > fat_end)
+		ra_count = (u32)(fat_end - ra_sec);
+
+	MMSG("BD: FAT chain read-ahead (sec:%llu, count:%u)\n", ra_sec, ra_count);
+	bdev_readahead(sb, ra_sec, (u64)ra_count);
+	fsi->fcache.ra_end = ra_sec + ra_count;
+}
+
 u8 *fcache_getblk(struct super_block *sb, u64 sec)
 {
 	cache_ent_t *bp;
 	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
-	u32 page_ra_count = FCACHE_MAX_RA_SIZE >> sb->s_blocksize_bits;
 
 	bp = __fcache_find(sb, sec);
 	if (bp) {
@@ -212,9 +262,7 @@ u8 *fcache_getblk(struct super_block *sb, u64 sec)
 	bp->flag = 0;
 	__fcache_insert_hash(sb, bp);
 
-	/* Naive FAT read-ahead (increase I/O unit to page_ra_count) */
-	if ((sec & (page_ra_count - 1)) == 0)
-		bdev_readahead(sb, sec, (u64)page_ra_count);
+	__fcache_readahead(sb, sec);
 
 	/*
 	 * patch 1.2.4 : buffer_head null pointer exception problem.
@@ -272,16 +320,60 @@ s32 fcache_modify(struct super_block *sb, u64 sec)
 /*======================================================================*/
 /*  Cache Initialization Functions                                      */
 /*======================================================================*/
-s32 meta_cache_init(struct super_block *sb)
+static void __meta_cache_free(FS_INFO_T *fsi)
+{
+	vfree(fsi->fcache.pool);
+	vfree(fsi->fcache.hash_list);
+	vfree(fsi->dcache.pool);
+	vfree(fsi->dcache.hash_list);
+
+	fsi->fcache.pool = NULL;
+	fsi->fcache.hash_list = NULL;
+	fsi->dcache.pool = NULL;
+	fsi->dcache.hash_list = NULL;
+}
+
+static s32 __meta_cache_alloc(struct super_block *sb, u32 fsize, u32 dsize)
 {
 	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
-	s32 i;
+	cache_ent_t *fpool, *fhash, *dpool, *dhash;
+	u32 fhash_size = max_t(u32, fsize >> 1, FAT_CACHE_HASH_SIZE);
+	u32 dhash_size = max_t(u32, dsize >> 2, BUF_CACHE_HASH_SIZE);
+	u32 i;
+
+	fpool = vzalloc(fsize * sizeof(cache_ent_t));
+	fhash = vzalloc(fhash_size * sizeof(cache_ent_t));
+	dpool = vzalloc(dsize * sizeof(cache_ent_t));
+	dhash = vzalloc(dhash_size * sizeof(cache_ent_t));
+	if (!fpool || !fhash || !dpool || !dhash) {
+		/* vfree(NULL) is safe */
+		vfree(fpool);
+		vfree(fhash);
+		vfree(dpool);
+		vfree(dhash);
+		return -ENOMEM;
+	}
+
+	__meta_cache_free(fsi);
+
+	fsi->fcache.pool = fpool;
+	fsi->fcache.size = fsize;
+	fsi->fcache.hash_list = fhash;
+	fsi->fcache.hash_mask = fhash_size - 1;
+	fsi->fcache.ra_last = ~0;
+	fsi->fcache.ra_end = 0;
+	fsi->fcache.ra_count = 0;
+
+	fsi->dcache.pool = dpool;
+	fsi->dcache.size = dsize;
+	fsi->dcache.hash_list = dhash;
+	fsi->dcache.hash_mask = dhash_size - 1;
 
 	/* LRU list */
 	fsi->fcache.lru_list.next = &fsi->fcache.lru_list;
 	fsi->fcache.lru_list.prev = fsi->fcache.lru_list.next;
 
-	for (i = 0; i < FAT_CACHE_SIZE; i++) {
+	for (i = 0; i < fsize; i++) {
 		fsi->fcache.pool[i].sec = ~0;
 		fsi->fcache.pool[i].flag = 0;
 		fsi->fcache.pool[i].bh = NULL;
@@ -296,7 +388,7 @@ s32 meta_cache_init(struct super_block *sb)
 	fsi->dcache.keep_list.prev = fsi->dcache.keep_list.next;
 
 	// Initially, all the BUF_CACHEs are in the LRU list
-	for (i = 0; i < BUF_CACHE_SIZE; i++) {
+	for (i = 0; i < dsize; i++) {
 		fsi->dcache.pool[i].sec = ~0;
 		fsi->dcache.pool[i].flag = 0;
 		fsi->dcache.pool[i].bh = NULL;
@@ -306,31 +398,72 @@ s32 meta_cache_init(struct super_block *sb)
 	}
 
 	/* HASH list */
-	for (i = 0; i < FAT_CACHE_HASH_SIZE; i++) {
+	for (i = 0; i < fhash_size; i++) {
 		fsi->fcache.hash_list[i].sec = ~0;
 		fsi->fcache.hash_list[i].hash.next = &(fsi->fcache.hash_list[i]);
-;
 		fsi->fcache.hash_list[i].hash.prev = fsi->fcache.hash_list[i].hash.next;
 	}
 
-	for (i = 0; i < FAT_CACHE_SIZE; i++)
+	for (i = 0; i < fsize; i++)
 		__fcache_insert_hash(sb, &(fsi->fcache.pool[i]));
 
-	for (i = 0; i < BUF_CACHE_HASH_SIZE; i++) {
+	for (i = 0; i < dhash_size; i++) {
 		fsi->dcache.hash_list[i].sec = ~0;
 		fsi->dcache.hash_list[i].hash.next = &(fsi->dcache.hash_list[i]);
-
 		fsi->dcache.hash_list[i].hash.prev = fsi->dcache.hash_list[i].hash.next;
 	}
 
-	for (i = 0; i < BUF_CACHE_SIZE; i++)
+	for (i = 0; i < dsize; i++)
 		__dcache_insert_hash(sb, &(fsi->dcache.pool[i]));
 
 	return 0;
 }
 
+s32 meta_cache_init(struct super_block *sb)
+{
+	return __meta_cache_alloc(sb, FAT_CACHE_SIZE, BUF_CACHE_SIZE);
+}
+
+/*
+ * Size the caches by the volume, once its geometry is known.
+ * The fcache keeps about 1/16 of FAT1 and the dcache grows with the
+ * number of clusters, both rounded to a power of 2 and clamped to
+ * [*_CACHE_SIZE, *_CACHE_MAX_SIZE]. Must be called while the caches
+ * hold nothing, i.e. right after the boot sector is parsed.
+ * On allocation failure the minimum sized caches are kept.
+ */
+s32 meta_cache_resize(struct super_block *sb)
+{
+	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
+	u32 fsize, dsize;
+
+	fsize = clamp_t(u32, fsi->num_FAT_sectors >> 4,
+			FAT_CACHE_SIZE, FAT_CACHE_MAX_SIZE);
+	dsize = clamp_t(u32, fsi->num_clusters >> 10,
+			BUF_CACHE_SIZE, BUF_CACHE_MAX_SIZE);
+	fsize = rounddown_pow_of_two(fsize);
+	dsize = rounddown_pow_of_two(dsize);
+
+	if (fsize == fsi->fcache.size && dsize == fsi->dcache.size)
+		return 0;
+
+	fcache_release_all(sb);
+	dcache_release_all(sb);
+
+	if (__meta_cache_alloc(sb, fsize, dsize)) {
+		sdfat_log_msg(sb, KERN_WARNING, "failed to resize meta cache "
+				"(fcache:%u, dcache:%u)", fsize, dsize);
+		return -ENOMEM;
+	}
+
+	sdfat_log_msg(sb, KERN_INFO, "meta cache size          : "
+			"fcache %u, dcache %u", fsize, dsize);
+	return 0;
+}
+
 s32 meta_cache_shutdown(struct super_block *sb)
 {
+	__meta_cache_free(&(SDFAT_SB(sb)->fsi));
 	return 0;
 }
 
@@ -396,7 +529,7 @@ static cache_ent_t *__fcache_find(struct super_block *sb, u64 sec)
 	cache_ent_t *bp, *hp;
 	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
 
-	off = (sec + (sec >> fsi->sect_per_clus_bits)) & (FAT_CACHE_HASH_SIZE - 1);
+	off = (sec + (sec >> fsi->sect_per_clus_bits)) & fsi->fcache.hash_mask;
 	hp = &(fsi->fcache.hash_list[off]);
 	for (bp = hp->hash.next; bp != hp; bp = bp->hash.next) {
 		if (bp->sec == sec) {
@@ -445,7 +578,7 @@ static void __fcache_insert_hash(struct super_block *sb, cache_ent_t *bp)
 	FS_INFO_T *fsi;
 
 	fsi = &(SDFAT_SB(sb)->fsi);
-	off = (bp->sec + (bp->sec >> fsi->sect_per_clus_bits)) & (FAT_CACHE_HASH_SIZE-1);
+	off = (bp->sec + (bp->sec >> fsi->sect_per_clus_bits)) & fsi->fcache.hash_mask;
 
 	hp = &(fsi->fcache.hash_list[off]);
 	bp->hash.next = hp->hash.next;
@@ -761,7 +894,7 @@ static cache_ent_t *__dcache_find(struct super_block *sb, u64 sec)
 	cache_ent_t *bp, *hp;
 	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
 
-	off = (sec + (sec >> fsi->sect_per_clus_bits)) & (BUF_CACHE_HASH_SIZE - 1);
+	off = (sec + (sec >> fsi->sect_per_clus_bits)) & fsi->dcache.hash_mask;
 
 	hp = &(fsi->dcache.hash_list[off]);
 	for (bp = hp->hash.next; bp != hp; bp = bp->hash.next) {
@@ -815,7 +948,7 @@ static void __dcache_insert_hash(struct super_block *sb, cache_ent_t *bp)
 	FS_INFO_T *fsi;
 
 	fsi = &(SDFAT_SB(sb)->fsi);
-	off = (bp->sec + (bp->sec >> fsi->sect_per_clus_bits)) & (BUF_CACHE_HASH_SIZE-1);
+	off = (bp->sec + (bp->sec >> fsi->sect_per_clus_bits)) & fsi->dcache.hash_mask;
 
 	hp = &(fsi->dcache.hash_list[off]);
 	bp->hash.next = hp->hash.next;
@@ -70,6 +70,24 @@ void set_sb_dirty(struct super_block *sb)
 	//TMSG("%s finished.\n", __func__);
 }
 
+/*
+ * While the AMAP is built in background, used_clusters only covers the
+ * scanned part of FAT. Finish the scan before deciding on ENOSPC if the
+ * unscanned clusters could make the difference.
+ */
+static void settle_used_clusters(struct super_block *sb)
+{
+	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
+	u32 pending = amap_build_pending(sb);
+
+	if (likely(!pending))
+		return;
+
+	if ((u64)fsi->used_clusters + fsi->reserved_clusters + pending >=
+					fsi->num_clusters - CLUS_BASE)
+		amap_build_finish(sb);
+}
+
 /*----------------------------------------------------------------------*/
 /*  Global Variable Definitions                                         */
 /*----------------------------------------------------------------------*/
@@ -844,6 +862,7 @@ static s32 find_empty_entry(struct inode *inode, CHAIN_T *p_dir, s32 num_entries
 		/* (0) check if there are reserved clusters
 		 * (create_dir 의 주석 참고)
 		 */
+		settle_used_clusters(sb);
 		if (!IS_CLUS_EOF(fsi->used_clusters) &&
 			((fsi->used_clusters + fsi->reserved_clusters) >= (fsi->num_clusters - 2)))
 			return -ENOSPC;
@@ -1253,6 +1272,7 @@ static s32 create_dir(struct inode *inode, CHAIN_T *p_dir, UNI_NAME_T *p_uniname
 	clu.flags = (fsi->vol_type == EXFAT) ? 0x03 : 0x01;
 
 	/* (0) Check if there are reserved clusters up to max. */
+	settle_used_clusters(sb);
 	if ((fsi->used_clusters + fsi->reserved_clusters) >= (fsi->num_clusters - CLUS_BASE))
 		return -ENOSPC;
 
@@ -1815,6 +1835,9 @@ free_bh:
 		disk ? (u64)((disk->part0.nr_sects) >> 1) : 0,
 		part ? (u64)((part->nr_sects) >> 1) : 0);
 
+	/* not fatal, the minimum sized caches still work */
+	meta_cache_resize(sb);
+
 	ret = load_upcase_table(sb);
 	if (ret) {
 		sdfat_log_msg(sb, KERN_ERR, "failed to load upcase table");
@@ -1840,6 +1863,9 @@ update_used_clus:
 		}
 	}
 
+	/* scan FAT for AMAP (and used_clusters) in background */
+	amap_build_start(sb);
+
 	return 0;
 free_alloc_bmp:
 	if (fsi->vol_type == EXFAT)
@@ -1897,6 +1923,8 @@ s32 fscore_statfs(struct super_block *sb, VOL_INFO_T *info)
 	info->ClusterSize = fsi->cluster_size;
 	info->NumClusters = fsi->num_clusters - 2; /* clu 0 & 1 */
 	info->UsedClusters = fsi->used_clusters + fsi->reserved_clusters;
+	/* not scanned yet, report them used rather than promise space */
+	info->UsedClusters += amap_build_pending(sb);
 	info->FreeClusters = info->NumClusters - info->UsedClusters;
 
 	return 0;
@@ -3346,6 +3374,7 @@ s32 fscore_reserve_clus(struct inode *inode)
 	struct super_block *sb = inode->i_sb;
 	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
 
+	settle_used_clusters(sb);
 	if ((fsi->used_clusters + fsi->reserved_clusters) >= (fsi->num_clusters - 2))
 		return -ENOSPC;
 
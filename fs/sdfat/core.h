@@ -122,6 +122,7 @@ s32 walk_fat_chain(struct super_block *sb, CHAIN_T *p_dir, u32 byte_offset, u32
 /* sdfat/cache.c */
 s32  meta_cache_init(struct super_block *sb);
 s32  meta_cache_shutdown(struct super_block *sb);
+s32  meta_cache_resize(struct super_block *sb);
 u8 *fcache_getblk(struct super_block *sb, u64 sec);
 s32  fcache_modify(struct super_block *sb, u64 sec);
 s32  fcache_release_all(struct super_block *sb);
@@ -147,6 +148,7 @@ s32 fat_ent_get_safe(struct super_block *sb, u32 loc, u32 *content);
 s32 fat_generate_dos_name_new(struct super_block *sb, CHAIN_T *p_dir, DOS_NAME_T *p_dosname, s32 n_entries);
 s32  mount_fat16(struct super_block *sb, pbr_t *p_pbr);
 s32  mount_fat32(struct super_block *sb, pbr_t *p_pbr);
+void fat_enable_smart_alloc(struct super_block *sb);
 
 /* core_exfat.c : core code for exfat */
 
@@ -164,6 +166,13 @@ s32  mount_exfat(struct super_block *sb, pbr_t *p_pbr);
 int amap_create(struct super_block *sb, u32 pack_ratio, u32 sect_per_au, u32 hidden_sect);
 void amap_destroy(struct super_block *sb);
 
+/* amap_smart.c : background build after mount */
+void amap_build_start(struct super_block *sb);
+void amap_build_stop(struct super_block *sb);
+void amap_build_finish(struct super_block *sb);
+u32 amap_build_pending(struct super_block *sb);
+s32 amap_build_account(struct super_block *sb, u32 clu, s32 alloc);
+
 /* amap_smart.c : (de)allocation functions */
 s32 amap_fat_alloc_cluster(struct super_block *sb, u32 num_alloc, CHAIN_T *p_chain, s32 dest);
 s32 amap_free_cluster(struct super_block *sb, CHAIN_T *p_chain, s32 do_relse);/* Not impelmented */
@@ -207,6 +216,7 @@ void extent_cache_init_inode(struct inode *inode);
 void extent_cache_inval_inode(struct inode *inode);
 s32 extent_get_clus(struct inode *inode, u32 cluster, u32 *fclus,
 		u32 *dclus, u32 *last_dclus, s32 allow_eof);
+s32 extent_count_frags(struct inode *inode, u32 max_clus, u32 *nr_frags);
 /*----------------------------------------------------------------------*/
 /*  Wrapper Function                                                    */
 /*----------------------------------------------------------------------*/
@@ -218,6 +218,10 @@ static s32 fat_free_cluster(struct super_block *sb, CHAIN_T *p_chain, s32 do_rel
 		if (fsi->amap) {
 			if (amap_release_cluster(sb, prev))
 				return -EIO;
+		} else if (unlikely(fsi->amap_build) &&
+				!amap_build_account(sb, prev, 0)) {
+			/* AMAP build will find it free */
+			continue;
 		}
 
 		num_clusters++;
@@ -234,7 +238,7 @@ out:
 static s32 fat_alloc_cluster(struct super_block *sb, u32 num_alloc, CHAIN_T *p_chain, s32 dest)
 {
 	s32 ret = -ENOSPC;
-	u32 i, num_clusters = 0, total_cnt;
+	u32 i, num_clusters = 0, num_accounted = 0, total_cnt;
 	u32 new_clu, last_clu = CLUS_EOF, read_clu;
 	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
 
@@ -273,6 +277,11 @@ static s32 fat_alloc_cluster(struct super_block *sb, u32 num_alloc, CHAIN_T *p_c
 			}
 			num_clusters++;
 
+			/* AMAP build still has to scan it */
+			if (likely(!fsi->amap_build) ||
+				amap_build_account(sb, new_clu, 1))
+				num_accounted++;
+
 			if (IS_CLUS_EOF(p_chain->dir)) {
 				p_chain->dir = new_clu;
 			} else {
@@ -286,7 +295,7 @@ static s32 fat_alloc_cluster(struct super_block *sb, u32 num_alloc, CHAIN_T *p_c
 
 			if ((--num_alloc) == 0) {
 				fsi->clu_srch_ptr = new_clu;
-				fsi->used_clusters += num_clusters;
+				fsi->used_clusters += num_accounted;
 
 				return 0;
 			}
@@ -1207,6 +1216,14 @@ static FS_FUNC_T fat_fs_func = {
 	.set_entry_time = fat_set_entry_time,
 };
 
+static FS_FUNC_T amap_fat_fs_func;
+
+/* Called once the AMAP is built to switch to the smart allocator */
+void fat_enable_smart_alloc(struct super_block *sb)
+{
+	SDFAT_SB(sb)->fsi.fs_func = &amap_fat_fs_func;
+}
+
 static FS_FUNC_T amap_fat_fs_func = {
 	.alloc_cluster = amap_fat_alloc_cluster,
 	.free_cluster = fat_free_cluster,
@@ -1438,9 +1455,11 @@ s32 mount_fat32(struct super_block *sb, pbr_t *p_pbr)
 			sdfat_log_msg(sb, KERN_WARNING, "failed to create AMAP."
 				" disabling smart allocation. (err:%d)", ret);
 			SDFAT_SB(sb)->options.improved_allocation &= ~(SDFAT_ALLOC_SMART);
-		} else {
-			fsi->fs_func = &amap_fat_fs_func;
 		}
+		/*
+		 * Otherwise the AMAP is built in background after mount,
+		 * and fat_enable_smart_alloc() switches fs_func when ready.
+		 */
 	}
 
 	/* Check dependency of mount options */
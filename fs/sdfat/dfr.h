@@ -36,6 +36,19 @@
 
 #define	DFR_MAX_AU_MOVED		(16)	// Maximum # of AUs for a request
 
+#define	DFR_IDLE_MAX_CAND		(32)	// Large files remembered for the idle scan
+#define	DFR_IDLE_MAX_TARGETS		(8)	// Most fragmented files reported to defrag_daemon
+#define	DFR_IDLE_MIN_SIZE		(8 << 20)	// Only files over 8MB are worth relocating
+#define	DFR_IDLE_FRAGS_PER_MB		(4)	// Report a file with 4 or more fragments per MB
+#define	DFR_IDLE_MAX_CLUS		(1 << 16)	// Maximum # of clusters walked by an idle pass
+#define	DFR_IDLE_INTERVAL		(30 * HZ)	// Interval between idle passes
+
+struct defrag_idle_target {
+	loff_t i_pos;
+	unsigned int nr_frags;
+	unsigned int size_mb;
+};
+
 
 /* Debugging support*/
 #define dfr_err(fmt, args...) pr_err("DFR: " fmt "\n", args)
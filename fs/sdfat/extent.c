@@ -349,3 +349,48 @@ s32 extent_get_clus(struct inode *inode, u32 cluster, u32 *fclus,
 	extent_cache_add(inode, &cid);
 	return 0;
 }
+
+/*
+ * Count the discontiguous runs in the cluster chain of inode,
+ * walking at most max_clus clusters. A NoFatChain file is always a
+ * single run. Caller must hold s_vlock.
+ */
+s32 extent_count_frags(struct inode *inode, u32 max_clus, u32 *nr_frags)
+{
+	struct super_block *sb = inode->i_sb;
+	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
+	FILE_ID_T *fid = &(SDFAT_I(inode)->fid);
+	u32 clus, content, walked = 0;
+
+	*nr_frags = 0;
+	if (IS_CLUS_FREE(fid->start_clu) || IS_CLUS_EOF(fid->start_clu))
+		return 0;
+
+	*nr_frags = 1;
+	if (fid->flags == 0x03)
+		return 0;
+
+	clus = fid->start_clu;
+	while (walked < max_clus) {
+		/* prevent the infinite loop of cluster chain */
+		if (walked > fsi->num_clusters) {
+			sdfat_fs_error(sb, "%s: detected the cluster chain loop",
+					__func__);
+			return -EIO;
+		}
+
+		if (fat_ent_get_safe(sb, clus, &content))
+			return -EIO;
+
+		if (IS_CLUS_EOF(content))
+			break;
+
+		if (content != clus + 1)
+			(*nr_frags)++;
+
+		clus = content;
+		walked++;
+	}
+
+	return 0;
+}
@@ -2018,6 +2018,154 @@ static inline void __init_dfr_info(struct inode *inode)
 #endif
 }
 
+#ifdef	CONFIG_SDFAT_DFR
+/*
+ * Idle-time target selection.
+ * Large regular files are remembered when they are released. While
+ * userspace reports the device idle (dfr_idle), a bounded pass measures
+ * their cluster chains and keeps the most fragmented ones per MB, then
+ * wakes defrag_daemon to relocate them through the usual DFR_REQ chunks.
+ */
+static void __dfr_idle_note_file(struct inode *inode)
+{
+	struct sdfat_sb_info *sbi = SDFAT_SB(inode->i_sb);
+	loff_t i_pos = SDFAT_I(inode)->i_pos;
+	int i;
+
+	if (!sbi->options.defrag || !S_ISREG(inode->i_mode) ||
+		(i_size_read(inode) < DFR_IDLE_MIN_SIZE))
+		return;
+
+	spin_lock(&sbi->dfr_idle_lock);
+	for (i = 0; i < sbi->dfr_idle_nr_cand; i++) {
+		if (sbi->dfr_idle_cand[i] == i_pos)
+			goto out;
+	}
+
+	if (sbi->dfr_idle_nr_cand < DFR_IDLE_MAX_CAND)
+		sbi->dfr_idle_cand[sbi->dfr_idle_nr_cand++] = i_pos;
+out:
+	spin_unlock(&sbi->dfr_idle_lock);
+}
+
+/* Insert into the target table ordered by fragments per MB, caller holds dfr_idle_lock */
+static void __dfr_idle_add_target(struct sdfat_sb_info *sbi, loff_t i_pos,
+		unsigned int nr_frags, unsigned int size_mb)
+{
+	struct defrag_idle_target *t = sbi->dfr_idle_targets;
+	unsigned int ratio = nr_frags / size_mb;
+	int i, n = sbi->dfr_idle_nr_targets;
+
+	/* Drop a stale entry of the same file first */
+	for (i = 0; i < n; i++) {
+		if (t[i].i_pos == i_pos) {
+			memmove(&t[i], &t[i + 1], sizeof(*t) * (n - i - 1));
+			n--;
+			break;
+		}
+	}
+
+	for (i = n; i > 0; i--) {
+		if (t[i - 1].nr_frags / t[i - 1].size_mb >= ratio)
+			break;
+	}
+
+	if (i < DFR_IDLE_MAX_TARGETS) {
+		if (n == DFR_IDLE_MAX_TARGETS)
+			n--;
+		memmove(&t[i + 1], &t[i], sizeof(*t) * (n - i));
+		t[i].i_pos = i_pos;
+		t[i].nr_frags = nr_frags;
+		t[i].size_mb = size_mb;
+		n++;
+	}
+
+	sbi->dfr_idle_nr_targets = n;
+}
+
+static void __dfr_idle_work(struct work_struct *work)
+{
+	struct sdfat_sb_info *sbi = container_of(to_delayed_work(work),
+			struct sdfat_sb_info, dfr_idle_work);
+	struct super_block *sb = sbi->host_sb;
+	u32 budget = DFR_IDLE_MAX_CLUS;
+	int nr_targets, left;
+
+	while (budget) {
+		struct inode *inode;
+		loff_t i_pos;
+		unsigned int size_mb;
+		u32 nr_frags, nr_clus;
+
+		if (sbi->dfr_idle <= 0)
+			return;
+
+		spin_lock(&sbi->dfr_idle_lock);
+		if (!sbi->dfr_idle_nr_cand) {
+			spin_unlock(&sbi->dfr_idle_lock);
+			break;
+		}
+		i_pos = sbi->dfr_idle_cand[--sbi->dfr_idle_nr_cand];
+		spin_unlock(&sbi->dfr_idle_lock);
+
+		/* Only files still in the inode cache, evicted ones come back on release */
+		inode = sdfat_iget(sb, i_pos);
+		if (!inode)
+			continue;
+
+		nr_clus = (u32)(i_size_read(inode) >> sbi->fsi.cluster_size_bits);
+		nr_clus = min(nr_clus, budget);
+		size_mb = max_t(unsigned int,
+				((u64)nr_clus << sbi->fsi.cluster_size_bits) >> 20, 1);
+
+		if (!fsapi_dfr_count_frags(inode, nr_clus, &nr_frags) &&
+			(nr_frags > 1) &&
+			(nr_frags >= size_mb * DFR_IDLE_FRAGS_PER_MB)) {
+			spin_lock(&sbi->dfr_idle_lock);
+			__dfr_idle_add_target(sbi, i_pos, nr_frags, size_mb);
+			spin_unlock(&sbi->dfr_idle_lock);
+		}
+
+		iput(inode);
+		budget -= max(nr_clus, 1U);
+		cond_resched();
+	}
+
+	spin_lock(&sbi->dfr_idle_lock);
+	nr_targets = sbi->dfr_idle_nr_targets;
+	left = sbi->dfr_idle_nr_cand;
+	spin_unlock(&sbi->dfr_idle_lock);
+
+	/* Hand the targets to defrag_daemon unless a defrag is running */
+	if (nr_targets && (atomic_read(&sbi->dfr_info.stat) == DFR_SB_STAT_IDLE)) {
+		char env[32];
+		char *envp[] = { env, NULL };
+
+		snprintf(env, sizeof(env), "DFR_IDLE_TARGETS=%d", nr_targets);
+		kobject_uevent_env(&sbi->sb_kobj, KOBJ_CHANGE, envp);
+	}
+
+	spin_lock(&sbi->dfr_idle_lock);
+	if (left && (sbi->dfr_idle > 0))
+		schedule_delayed_work(&sbi->dfr_idle_work, DFR_IDLE_INTERVAL);
+	spin_unlock(&sbi->dfr_idle_lock);
+}
+
+static void __dfr_idle_stop(struct sdfat_sb_info *sbi)
+{
+	if (!sbi->options.defrag)
+		return;
+
+	spin_lock(&sbi->dfr_idle_lock);
+	sbi->dfr_idle = -1;
+	spin_unlock(&sbi->dfr_idle_lock);
+	cancel_delayed_work_sync(&sbi->dfr_idle_work);
+}
+#else
+static inline void __dfr_idle_note_file(struct inode *inode) { }
+static inline void __dfr_idle_stop(struct sdfat_sb_info *sbi) { }
+#endif /* CONFIG_SDFAT_DFR */
+
 static inline int __alloc_dfr_mem_if_required(struct super_block *sb)
 {
 #ifdef	CONFIG_SDFAT_DFR
@@ -2030,6 +2178,9 @@ static inline int __alloc_dfr_mem_if_required(struct super_block *sb)
 	INIT_LIST_HEAD(&(sbi->dfr_info.entry));
 	mutex_init(&(sbi->dfr_info.lock));
 
+	spin_lock_init(&sbi->dfr_idle_lock);
+	INIT_DELAYED_WORK(&sbi->dfr_idle_work, __dfr_idle_work);
+
 	sbi->dfr_new_clus = kzalloc(PAGE_SIZE, GFP_KERNEL);
 	if (!sbi->dfr_new_clus) {
 		dfr_debug("error %d", -ENOMEM);
@@ -2998,6 +3149,7 @@ static int sdfat_file_release(struct inode *inode, struct file *filp)
 	sdfat_debug_bug_on(SDFAT_I(inode)->fid.size != i_size_read(inode));
 	SDFAT_I(inode)->fid.size = i_size_read(inode);
 	fsapi_sync_fs(sb, 0);
+	__dfr_idle_note_file(inode);
 	return 0;
 }
 
@@ -4075,6 +4227,7 @@ static void sdfat_put_super(struct super_block *sb)
 
 	sdfat_log_msg(sb, KERN_INFO, "trying to unmount...");
 
+	__dfr_idle_stop(sbi);
 	__cancel_delayed_work_sync(sbi);
 
 	if (__is_sb_dirty(sb))
@@ -4463,6 +4616,78 @@ static ssize_t fullau_show(struct sdfat_sb_info *sbi, char *buf)
 }
 SDFAT_ATTR(fullau, 0444, fullau_show, NULL);
 
+#ifdef	CONFIG_SDFAT_DFR
+static ssize_t dfr_idle_show(struct sdfat_sb_info *sbi, char *buf)
+{
+	return snprintf(buf, PAGE_SIZE, "%d\n", max(sbi->dfr_idle, 0));
+}
+
+/* Userspace knows when the device is charging with the screen off */
+static ssize_t dfr_idle_store(struct sdfat_sb_info *sbi, const char *buf, size_t len)
+{
+	unsigned int val;
+	int err;
+
+	if (!sbi->options.defrag)
+		return -EINVAL;
+
+	err = kstrtouint(buf, 0, &val);
+	if (err)
+		return err;
+
+	spin_lock(&sbi->dfr_idle_lock);
+	if (sbi->dfr_idle < 0) {
+		spin_unlock(&sbi->dfr_idle_lock);
+		return -EBUSY;
+	}
+	sbi->dfr_idle = !!val;
+
+	/* Under the lock, so no work is queued after __dfr_idle_stop() */
+	if (val)
+		schedule_delayed_work(&sbi->dfr_idle_work, 0);
+	else
+		cancel_delayed_work(&sbi->dfr_idle_work);
+	spin_unlock(&sbi->dfr_idle_lock);
+
+	return len;
+}
+SDFAT_ATTR(dfr_idle, 0644, dfr_idle_show, dfr_idle_store);
+
+static ssize_t dfr_targets_show(struct sdfat_sb_info *sbi, char *buf)
+{
+	struct defrag_idle_target *t = sbi->dfr_idle_targets;
+	ssize_t len = 0;
+	int i;
+
+	if (!sbi->options.defrag)
+		return 0;
+
+	/* i_pos, fragments, size in MB */
+	spin_lock(&sbi->dfr_idle_lock);
+	for (i = 0; i < sbi->dfr_idle_nr_targets; i++)
+		len += snprintf(buf + len, PAGE_SIZE - len, "%llx %u %u\n",
+				(unsigned long long)t[i].i_pos,
+				t[i].nr_frags, t[i].size_mb);
+	spin_unlock(&sbi->dfr_idle_lock);
+
+	return len;
+}
+
+/* defrag_daemon clears the table once it has taken the targets */
+static ssize_t dfr_targets_store(struct sdfat_sb_info *sbi, const char *buf, size_t len)
+{
+	if (!sbi->options.defrag)
+		return -EINVAL;
+
+	spin_lock(&sbi->dfr_idle_lock);
+	sbi->dfr_idle_nr_targets = 0;
+	spin_unlock(&sbi->dfr_idle_lock);
+
+	return len;
+}
+SDFAT_ATTR(dfr_targets, 0600, dfr_targets_show, dfr_targets_store);
+#endif /* CONFIG_SDFAT_DFR */
+
 static struct attribute *sdfat_attrs[] = {
 	&sdfat_attr_type.attr,
 	&sdfat_attr_eio.attr,
@@ -4470,6 +4695,10 @@ static struct attribute *sdfat_attrs[] = {
 	&sdfat_attr_totalau.attr,
 	&sdfat_attr_cleanau.attr,
 	&sdfat_attr_fullau.attr,
+#ifdef	CONFIG_SDFAT_DFR
+	&sdfat_attr_dfr_idle.attr,
+	&sdfat_attr_dfr_targets.attr,
+#endif
 	NULL,
 };
 
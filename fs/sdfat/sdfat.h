@@ -173,6 +173,15 @@ struct sdfat_sb_info {
 	unsigned int dfr_hint_idx;
 	int dfr_reserved_clus;
 
+	/* idle-time target selection, enabled through sysfs dfr_idle */
+	int dfr_idle;
+	struct delayed_work dfr_idle_work;
+	spinlock_t dfr_idle_lock;
+	loff_t dfr_idle_cand[DFR_IDLE_MAX_CAND];
+	int dfr_idle_nr_cand;
+	struct defrag_idle_target dfr_idle_targets[DFR_IDLE_MAX_TARGETS];
+	int dfr_idle_nr_targets;
+
 #ifdef	CONFIG_SDFAT_DFR_DEBUG
 	int dfr_spo_flag;
 #endif  /* CONFIG_SDFAT_DFR_DEBUG */
@@ -41,6 +41,12 @@
 #include "decompressor.h"
 #include "page_actor.h"
 
+/*
+ * Asynchronous (readahead) blocks are decompressed from this workqueue.  It
+ * is unbound so that the blocks of one readahead window are spread over the
+ * idle cores instead of being decompressed one after the other on the CPU
+ * that issued the read.
+ */
 static struct workqueue_struct *squashfs_read_wq;
 
 struct squashfs_read_request {
@@ -80,7 +86,8 @@ static int squashfs_bio_submit(struct squashfs_read_request *req);
 
 int squashfs_init_read_wq(void)
 {
-	squashfs_read_wq = create_workqueue("SquashFS read wq");
+	squashfs_read_wq = alloc_workqueue("SquashFS read wq",
+					   WQ_UNBOUND | WQ_HIGHPRI, 0);
 	return !!squashfs_read_wq;
 }
 
@@ -326,7 +333,7 @@ static int squashfs_bio_submit(struct squashfs_read_request *req)
 		squashfs_process_blocks(req);
 	else {
 		INIT_WORK(&req->offload, read_wq_handler);
-		schedule_work(&req->offload);
+		queue_work(squashfs_read_wq, &req->offload);
 	}
 	return 0;
 
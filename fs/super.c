@@ -154,6 +154,9 @@ static void destroy_super_work(struct work_struct *work)
 
 	for (i = 0; i < SB_FREEZE_LEVELS; i++)
 		percpu_free_rwsem(&s->s_writers.rw_sem[i]);
+#ifdef CONFIG_DCACHE_LOOKUP_STATS
+	free_percpu(s->s_lookup_stats);
+#endif
 	kfree(s);
 }
 
@@ -214,6 +217,10 @@ static struct super_block *alloc_super(struct file_system_type *type, int flags,
 			goto fail;
 	}
 	init_waitqueue_head(&s->s_writers.wait_unfrozen);
+#ifdef CONFIG_DCACHE_LOOKUP_STATS
+	/* statistics only, a superblock without them still works */
+	s->s_lookup_stats = alloc_percpu(struct dcache_lookup_stats);
+#endif
 	s->s_bdi = &noop_backing_dev_info;
 	s->s_flags = flags;
 	INIT_HLIST_NODE(&s->s_instances);
@@ -19,5 +19,25 @@
 #define FMP_CBC_ALGO_MODE	1
 #define FMP_XTS_ALGO_MODE	2
 
+#define FMP_IV_SIZE		16
+#define FMP_IV_BATCH		8
+
+struct address_space;
+
+/*
+ * State carried across the PRDT entries of one request: the file key is
+ * converted once and copied from the entry holding it, and CBC IVs are
+ * derived for runs of consecutive pages at a time.
+ */
+struct fmp_ufs_cache {
+	const unsigned char *key;
+	unsigned long key_length;
+	unsigned int key_idx;
+	struct address_space *mapping;
+	long long iv_index;
+	int nr_ivs;
+	char ivs[FMP_IV_BATCH][FMP_IV_SIZE];
+};
+
 #endif /* __FMP_H__ */
 
@@ -146,6 +146,7 @@ struct backing_dev_info {
 	unsigned long last_thresh;  /* global/bdi thresh at the last throttle */
 	unsigned long last_nr_dirty; /* global/bdi dirty at the last throttle */
 	unsigned long paused_total; /* approximated sum of pauses. in jiffies */
+	unsigned long fg_sync_stamp; /* jiffies of the last foreground sync */
 
 	unsigned int min_ratio;
 	unsigned int max_ratio, max_prop_frac;
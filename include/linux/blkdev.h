@@ -413,6 +413,8 @@ struct request_queue {
 	unsigned int		in_flight[2];
 	unsigned long long	in_flight_time;
 	ktime_t			in_flight_stamp;
+	/* when the device last drained, 0 while busy (QUEUE_FLAG_IDLE_TRACK) */
+	ktime_t			dev_idle_stamp;
 	/*
 	 * Number of active block driver functions for which blk_drain_queue()
 	 * must wait. Must be incremented around functions that unlock the
@@ -505,6 +507,7 @@ struct request_queue {
 #define QUEUE_FLAG_INIT_DONE   20	/* queue is initialized */
 #define QUEUE_FLAG_NO_SG_MERGE 21	/* don't attempt to merge SG segments*/
 #define QUEUE_FLAG_POLL	       22	/* IO polling enabled if set */
+#define QUEUE_FLAG_IDLE_TRACK  23	/* driver keeps dev_idle_stamp */
 #ifdef CONFIG_JOURNAL_DATA_TAG
 #define QUEUE_FLAG_JOURNAL_TAG     31      /* supports JOURNAL_DATA_TAG */
 #endif
@@ -589,6 +592,8 @@ static inline void queue_flag_clear(unsigned int flag, struct request_queue *q)
 #define blk_queue_noxmerges(q)	\
 	test_bit(QUEUE_FLAG_NOXMERGES, &(q)->queue_flags)
 #define blk_queue_nonrot(q)	test_bit(QUEUE_FLAG_NONROT, &(q)->queue_flags)
+#define blk_queue_idle_track(q)	\
+	test_bit(QUEUE_FLAG_IDLE_TRACK, &(q)->queue_flags)
 #define blk_queue_io_stat(q)	test_bit(QUEUE_FLAG_IO_STAT, &(q)->queue_flags)
 #define blk_queue_add_random(q)	test_bit(QUEUE_FLAG_ADD_RANDOM, &(q)->queue_flags)
 #define blk_queue_stackable(q)	\
@@ -850,6 +855,21 @@ static inline struct request_queue *bdev_get_queue(struct block_device *bdev)
 	return bdev->bd_queue;	/* this is never NULL */
 }
 
+/*
+ * Milliseconds the device behind @q has been idle, 0 while it is busy,
+ * or -1 when its driver does not track it.
+ */
+static inline s64 blk_queue_idle_ms(struct request_queue *q)
+{
+	ktime_t stamp = READ_ONCE(q->dev_idle_stamp);
+
+	if (!blk_queue_idle_track(q))
+		return -1;
+	if (!ktime_to_ns(stamp))
+		return 0;
+	return ktime_ms_delta(ktime_get(), stamp);
+}
+
 /*
  * The basic unit of block I/O is a sector. It is used in a number of contexts
  * in Linux (blk, bio, genhd). The size of one sector is 512 = 2**9
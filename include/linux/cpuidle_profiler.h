@@ -38,16 +38,35 @@ struct cpuidle_profile_state_usage {
 	unsigned long long time;
 };
 
+/*
+ * Always-on histograms in log2 buckets. Residency bucket n counts idle
+ * periods below (16 << n)us, wakeup latency bucket n counts exits below
+ * (1 << n)us. The last bucket also counts everything longer.
+ */
+#define PROFILE_HIST_BUCKETS	16
+#define PROFILE_HIST_RES_SHIFT	4
+
+struct cpuidle_profile_hist {
+	unsigned int residency[PROFILE_HIST_BUCKETS];
+	unsigned int latency[PROFILE_HIST_BUCKETS];
+	unsigned long long latency_sum;
+	unsigned int latency_count;
+};
+
 struct cpuidle_profile_info {
 	ktime_t last_entry_time;
+	ktime_t last_exit_time;
 	int cur_state;
+	int last_state;
 	int state_count;
 
 	struct cpuidle_profile_state_usage *usage;
+	struct cpuidle_profile_hist *hist;
 };
 
 extern void cpuidle_profile_start(int cpu, int state, int sub_state);
 extern void cpuidle_profile_finish(int cpuid, int early_wakeup);
+extern void cpuidle_profile_exit_done(int cpu);
 extern void cpuidle_profile_register(struct cpuidle_driver *drv);
 
 #ifdef CONFIG_CPU_IDLE
@@ -61,4 +80,13 @@ static inline void cpuidle_profile_collect_idle_ip(int mode,
 }
 #endif
 
+#ifdef CONFIG_ARM64_EXYNOS_CPUIDLE
+extern unsigned int cpuidle_profile_exit_latency(int cpu);
+#else
+static inline unsigned int cpuidle_profile_exit_latency(int cpu)
+{
+	return 0;
+}
+#endif
+
 #endif /* CPUIDLE_PROFILE_H */
@@ -341,6 +341,9 @@ struct devfreq_simple_interactive_data {
 	int pm_qos_class_max;
 	struct devfreq_notifier_block nb;
 	struct devfreq_notifier_block nb_max;
+	/* bus domain following BTS bandwidth plans, BTS_PLAN_NONE if none */
+	int bw_plan;
+	struct notifier_block plan_nb;
 };
 #endif
 
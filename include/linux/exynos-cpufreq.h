@@ -8,14 +8,33 @@
  * General Exynos cpufreq driver implementation
  */
 
+#include <linux/list.h>
+
+/*
+ * Asynchronous frequency request. Requests queued for several domains
+ * are applied together with a single ACPM round-trip, then done() is
+ * called from process context with the result.
+ */
+struct exynos_cpufreq_req {
+	struct list_head	list;
+	unsigned int		cpu;	/* any cpu of the target domain */
+	unsigned int		freq;
+	void			(*done)(struct exynos_cpufreq_req *req, int err);
+};
+
 #ifdef CONFIG_ARM_EXYNOS_ACME
 extern unsigned int exynos_cpufreq_get_max_freq(struct cpumask *mask);
 extern void exynos_cpufreq_reset_boot_qos(void);
+extern int exynos_cpufreq_target_async(struct exynos_cpufreq_req *req);
 #else
 static inline unsigned int exynos_cpufreq_get_max_freq(struct cpumask *mask)
 {
 	return 0;
 }
 static inline void exynos_cpufreq_reset_boot_qos(void) {}
+static inline int exynos_cpufreq_target_async(struct exynos_cpufreq_req *req)
+{
+	return -ENODEV;
+}
 #endif
 
@@ -163,6 +163,18 @@ dma_addr_t iovmm_map(struct device *dev, struct scatterlist *sg, off_t offset,
  */
 void iovmm_unmap(struct device *dev, dma_addr_t iova);
 
+/* iovmm_set_deferred_unmap() - batches the TLB invalidation of iovmm_unmap()
+ * @dev: the owner of the IO address space
+ * @enable: true to defer the invalidation, false to flush and stop deferring
+ *
+ * With deferred unmap, iovmm_unmap() removes the mapping from the page table
+ * and returns. The TLB is invalidated once for several unmapped regions, or
+ * shortly after the first of them, and their IO addresses are not given out
+ * again before that. The device must not access an unmapped buffer even if
+ * its TLB entries are still there.
+ */
+void iovmm_set_deferred_unmap(struct device *dev, bool enable);
+
 /*
  * flags to option_iplanes and option_oplanes.
  * inplanes and onplanes is 'input planes' and 'output planes', respectively.
@@ -189,6 +201,7 @@ void iovmm_unmap(struct device *dev, dma_addr_t iova);
 #define iovmm_deactivate(dev)		do { } while (0)
 #define iovmm_map(dev, sg, offset, size, direction, prot) (-ENOSYS)
 #define iovmm_unmap(dev, iova)		do { } while (0)
+#define iovmm_set_deferred_unmap(dev, enable)	do { } while (0)
 #define get_domain_from_dev(dev)	NULL
 static inline dma_addr_t exynos_iovmm_map_userptr(struct device *dev,
 			unsigned long vaddr, size_t size, int prot)
@@ -9,14 +9,18 @@
 #define LOOPBACK_MSG           1
 #define MSG_TO_KERN            2
 #define MSG_TO_USER            3
-#define MSG_TYPE_END           4
+#define MSG_TO_USER_BATCH      4
+#define MSG_TYPE_END           5
 
 #define MOD_NOOP               0
 #define MOD_BINDER             1
 #define MOD_SIG                2
 #define MOD_PKG                3
 #define MOD_CFB                4
-#define MOD_END                5
+#define MOD_FREEZE             5
+#define MOD_END                6
+
+#define KFREECESS_BATCH_MAX    16
 
 typedef enum {
 	ADD_UID,
@@ -42,6 +46,25 @@ struct kfreecess_msg_data
 	pkg_info_t pkg_info;	//MOD_PKG
 };
 
+/* one coalesced MOD_SIG/MOD_BINDER report, per target uid */
+struct kfreecess_event
+{
+	int caller_pid;
+	int target_uid;
+	int flag;
+};
+
+/* MSG_TO_USER_BATCH: events reported within batch_window_ms */
+struct kfreecess_batch_msg
+{
+	int type;
+	int mod;
+	int src_portid;
+	int dst_portid;
+	int count;
+	struct kfreecess_event events[KFREECESS_BATCH_MAX];
+};
+
 typedef void (*freecess_hook)(void* data, unsigned int len);
 
 int sig_report(struct task_struct *caller, struct task_struct *p);
@@ -51,4 +74,5 @@ int cfb_report(int target_uid, const char *reason);
 int register_kfreecess_hook(int mod, freecess_hook hook);
 int unregister_kfreecess_hook(int mod);
 int pkg_stat_show(struct seq_file *m, void *v);
+int freecess_freeze_uid(uid_t uid, bool freeze);
 #endif
\ No newline at end of file
@@ -1459,6 +1459,10 @@ struct super_block {
 	 */
 	struct user_namespace *s_user_ns;
 
+#ifdef CONFIG_DCACHE_LOOKUP_STATS
+	struct dcache_lookup_stats __percpu *s_lookup_stats;
+#endif
+
 	/*
 	 * Keep the lru lists last in the structure so they always sit on their
 	 * own individual cachelines.
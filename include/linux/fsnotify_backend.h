@@ -171,6 +171,7 @@ struct fsnotify_group {
 			spinlock_t	idr_lock;
 			struct idr      idr;
 			struct user_struct      *user;
+			bool		coalesce;	/* IN_COALESCE */
 		} inotify_data;
 #endif
 #ifdef CONFIG_FANOTIFY
@@ -1010,6 +1010,17 @@ struct journal_s
 	u32			j_min_batch_time;
 	u32			j_max_batch_time;
 
+	/*
+	 * adaptive batching: when the last sync request arrived, and the
+	 * mean and mean deviation of the gap between sync requests, in
+	 * nanoseconds [j_state_lock]
+	 */
+	u64			j_last_sync_time;
+	u64			j_sync_gap_avg;
+	u64			j_sync_gap_dev;
+	/* number of sync requests that waited for company */
+	unsigned long		j_sync_batch_waits;
+
 	/* This function is called when a transaction is closed */
 	void			(*j_commit_callback)(journal_t *,
 						     transaction_t *);
@@ -1355,6 +1366,9 @@ int __jbd2_log_start_commit(journal_t *journal, tid_t tid);
 int jbd2_journal_start_commit(journal_t *journal, tid_t *tid);
 int jbd2_log_wait_commit(journal_t *journal, tid_t tid);
 int jbd2_complete_transaction(journal_t *journal, tid_t tid);
+extern bool jbd2_adaptive_batch;
+u64 jbd2_sync_batch_delay(journal_t *journal);
+void jbd2_sync_batch_wait(journal_t *journal, u64 delay);
 int jbd2_log_do_checkpoint(journal_t *journal);
 int jbd2_trans_will_send_data_barrier(journal_t *journal, tid_t tid);
 
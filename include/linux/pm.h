@@ -575,6 +575,9 @@ struct dev_pm_info {
 	bool			syscore:1;
 	bool			no_pm_callbacks:1;	/* Owned by the PM core */
 	bool			is_rpm_disabled:1;	/* Owned by the PM core */
+	ktime_t			resume_start;	/* Owned by the PM core */
+	ktime_t			resume_end;	/* Ditto */
+	struct device		*resume_blocker;	/* Ditto */
 #else
 	unsigned int		should_wakeup:1;
 #endif
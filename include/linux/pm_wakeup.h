@@ -26,6 +26,7 @@
 # error "please don't include this file directly"
 #endif
 
+#include <linux/atomic.h>
 #include <linux/types.h>
 
 struct wake_irq;
@@ -72,6 +73,9 @@ struct wakeup_source {
 	unsigned long		relax_count;
 	unsigned long		expire_count;
 	unsigned long		wakeup_count;
+	/* events reported on an already active source, folded in lazily */
+	atomic_t		lazy_events;
+	atomic_t		lazy_wakeups;
 	bool			active:1;
 	bool			autosleep_enabled:1;
 #ifdef CONFIG_SEC_PM_DEBUG
@@ -79,6 +83,16 @@ struct wakeup_source {
 #endif
 };
 
+static inline unsigned long wakeup_source_event_count(struct wakeup_source *ws)
+{
+	return ws->event_count + atomic_read(&ws->lazy_events);
+}
+
+static inline unsigned long wakeup_source_wakeup_count(struct wakeup_source *ws)
+{
+	return ws->wakeup_count + atomic_read(&ws->lazy_wakeups);
+}
+
 #ifdef CONFIG_PM_SLEEP
 
 /*
@@ -79,6 +79,8 @@ struct pstore_info {
 };
 
 #define	PSTORE_FLAGS_FRAGILE	1
+/* Backend console writes need no serialization, buf_lock is not taken */
+#define	PSTORE_FLAGS_CONSOLE_NOLOCK	2
 
 extern int pstore_register(struct pstore_info *);
 extern void pstore_unregister(struct pstore_info *);
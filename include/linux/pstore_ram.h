@@ -86,8 +86,12 @@ void ramoops_console_write_buf(const char *buf, size_t size);
  * Ramoops platform data
  * @mem_size	memory size for ramoops
  * @mem_address	physical memory address to contain ramoops
+ * @flags	RAMOOPS_FLAG_*
  */
 
+/* Split the console area into one lockless zone per possible CPU */
+#define RAMOOPS_FLAG_CONSOLE_PER_CPU	BIT(0)
+
 struct ramoops_platform_data {
 	unsigned long	mem_size;
 	unsigned long	mem_address;
@@ -97,6 +101,7 @@ struct ramoops_platform_data {
 	unsigned long	ftrace_size;
 	unsigned long	pmsg_size;
 	int		dump_oops;
+	u32		flags;
 	struct persistent_ram_ecc_info ecc_info;
 };
 
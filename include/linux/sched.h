@@ -1367,6 +1367,8 @@ struct sched_statistics {
 	u64			nr_wakeups_passive;
 	u64			nr_wakeups_idle;
 
+	/* set by set_task_cpu(), counted on the next enqueue */
+	u8			xcache_migration;
 
        /* select_idle_sibling() */
        u64                     nr_wakeups_sis_attempts;
@@ -1431,6 +1433,20 @@ struct sched_entity {
 #endif
 };
 
+#ifdef CONFIG_SCHED_WALT_PREDICT
+#define WALT_PRED_BUCKETS	10
+
+/*
+ * Per-task histogram of past window demand. Each bucket covers a tenth
+ * of the window and counts how often the task landed in it recently;
+ * pred_demand is the demand expected for the next window.
+ */
+struct walt_pred {
+	u8 bucket[WALT_PRED_BUCKETS];
+	u32 pred_demand;
+};
+#endif
+
 struct sched_rt_entity {
 	struct list_head run_list;
 	unsigned long timeout;
@@ -1538,6 +1554,11 @@ struct tlbflush_unmap_batch {
 	bool writable;
 };
 
+#ifdef CONFIG_MMAP_SEM_STAT
+/* Bucket i counts times below 16us << (2 * i), the last one the rest */
+#define MMAP_SEM_STAT_BUCKETS	8
+#endif
+
 struct task_struct {
 #ifdef CONFIG_THREAD_INFO_IN_TASK
 	/*
@@ -1570,6 +1591,15 @@ struct task_struct {
 	unsigned int rt_priority;
 	const struct sched_class *sched_class;
 	struct sched_entity se;
+#ifdef CONFIG_SCHED_WALT_PREDICT
+	struct walt_pred pred;
+#endif
+#ifdef CONFIG_SCHED_FRAME_DEADLINE
+	/* local_clock() time the current frame is due, 0 if none */
+	u64 frame_deadline;
+	/* accounted in the frame tasks of its CPU's boost groups */
+	bool frame_queued;
+#endif
 	struct sched_rt_entity rt;
 #ifdef CONFIG_SCHED_USE_FLUID_RT
 	int victim_flag;
@@ -1978,6 +2008,17 @@ struct task_struct {
 	/* bitmask and counter of trace recursion */
 	unsigned long trace_recursion;
 #endif /* CONFIG_TRACING */
+#ifdef CONFIG_TRACE_LATENCY_SNAPSHOT
+	/* local_clock() of the last wakeup, 0 once on a CPU */
+	u64 lat_snapshot_wakeup;
+#endif
+#ifdef CONFIG_MMAP_SEM_STAT
+	/* wait and hold times of our own mm->mmap_sem, see rwsem.c */
+	pid_t mmap_sem_stat_pid;
+	u64 mmap_sem_acquired;
+	u32 mmap_sem_wait_hist[MMAP_SEM_STAT_BUCKETS];
+	u32 mmap_sem_hold_hist[MMAP_SEM_STAT_BUCKETS];
+#endif
 #ifdef CONFIG_KCOV
        /* Coverage collection mode enabled for this task (0 if disabled). */
        enum kcov_mode kcov_mode;
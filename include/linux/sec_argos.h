@@ -7,5 +7,8 @@ extern void argos_dm_hotplug_disable(void);
 
 extern int sec_argos_register_notifier(struct notifier_block *n, char *label);
 extern int sec_argos_unregister_notifier(struct notifier_block *n, char *label);
+extern int sec_argos_register_rate_notifier(struct notifier_block *n, char *label);
+extern int sec_argos_unregister_rate_notifier(struct notifier_block *n, char *label);
+extern unsigned long sec_argos_get_rate(char *label);
 
 #endif
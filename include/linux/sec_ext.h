@@ -54,8 +54,18 @@ extern void sec_bootstat_get_thermal(int *temp);
 #ifdef CONFIG_SEC_INITCALL_DEBUG
 #define SEC_INITCALL_DEBUG_MIN_TIME		10000
 extern void sec_initcall_debug_add(initcall_t fn, unsigned long long t);
+
+/*
+ * Driver probe log @ /proc/probe_debug
+ * show per device probe time and deferrals, slowest first.
+ */
+struct device;
+struct device_driver;
+extern void sec_initcall_debug_add_probe(struct device *dev,
+	struct device_driver *drv, unsigned long long t, bool deferred);
 #else
 #define sec_initcall_debug_add(a,b)		do { } while(0)	
+#define sec_initcall_debug_add_probe(a,b,c,d)	do { } while(0)
 #endif /* CONFIG_SEC_INITCALL_DEBUG */
 
 /*
@@ -201,6 +201,10 @@ struct thermal_attr {
  *			current temperature
  * @last_temperature:	previous temperature read
  * @emul_temperature:	emulated temperature when using CONFIG_THERMAL_EMULATION
+ * @temp_lookahead:	rise in millicelsius the sensor driver expects over
+ *			its prediction horizon, 0 if it does not predict.
+ *			The power allocator regulates on
+ *			@temperature + @temp_lookahead.
  * @passive:		1 if you've crossed a passive trip point, 0 otherwise.
  * @forced_passive:	If > 0, temperature at which to switch on all ACPI
  *			processor cooling devices.  Currently only used by the
@@ -232,6 +236,7 @@ struct thermal_zone_device {
 	int temperature;
 	int last_temperature;
 	int emul_temperature;
+	int temp_lookahead;
 	int passive;
 	unsigned int forced_passive;
 	atomic_t need_update;
@@ -0,0 +1,40 @@
+#ifndef _LINUX_TRACE_LAT_SNAPSHOT_H
+#define _LINUX_TRACE_LAT_SNAPSHOT_H
+
+#include <linux/compiler.h>
+#include <linux/types.h>
+
+struct task_struct;
+
+enum lat_snapshot_type {
+	LAT_SNAPSHOT_WAKEUP,	/* wakeup to running of a top-app task */
+	LAT_SNAPSHOT_BINDER,	/* binder transaction to reply */
+	LAT_SNAPSHOT_MAX,
+};
+
+#ifdef CONFIG_TRACE_LATENCY_SNAPSHOT
+extern u64 lat_snapshot_thresh_us[LAT_SNAPSHOT_MAX];
+
+void __lat_snapshot_trigger(enum lat_snapshot_type type, u64 delta_us,
+			    struct task_struct *p);
+
+/*
+ * Swap the live trace into the snapshot buffer if @delta_us is above the
+ * threshold of @type. Thresholds of 0 are disabled.
+ */
+static inline void lat_snapshot_check(enum lat_snapshot_type type,
+				      u64 delta_us, struct task_struct *p)
+{
+	u64 thresh = READ_ONCE(lat_snapshot_thresh_us[type]);
+
+	if (unlikely(thresh && delta_us > thresh))
+		__lat_snapshot_trigger(type, delta_us, p);
+}
+#else
+static inline void lat_snapshot_check(enum lat_snapshot_type type,
+				      u64 delta_us, struct task_struct *p)
+{
+}
+#endif
+
+#endif /* _LINUX_TRACE_LAT_SNAPSHOT_H */
@@ -467,6 +467,11 @@ struct hci_conn {
 
 	unsigned int	sent;
 
+	/* ACL/LE TX scheduling latency, from hci_send_acl() to the driver */
+	__u32		tx_sched_pkts;
+	__u32		tx_sched_lat_max;
+	__u64		tx_sched_lat_total;
+
 	struct sk_buff_head data_q;
 	struct list_head chan_list;
 
@@ -32,6 +32,8 @@
 struct napi_struct;
 extern unsigned int sysctl_net_busy_read __read_mostly;
 extern unsigned int sysctl_net_busy_poll __read_mostly;
+extern struct cpumask net_busy_poll_cpumask __read_mostly;
+extern bool net_busy_poll_screen_off __read_mostly;
 
 /* return values from ndo_ll_poll */
 #define LL_FLUSH_FAILED		-1
@@ -58,10 +60,20 @@ static inline unsigned long busy_loop_end_time(void)
 	return busy_loop_us_clock() + ACCESS_ONCE(sysctl_net_busy_poll);
 }
 
+/* Spinning only pays off on the CPUs allowed by net.core.busy_poll_cpus
+ * and while the primary display is on.
+ */
+static inline bool net_busy_loop_allowed(void)
+{
+	return !READ_ONCE(net_busy_poll_screen_off) &&
+	       cpumask_test_cpu(raw_smp_processor_id(), &net_busy_poll_cpumask);
+}
+
 static inline bool sk_can_busy_loop(struct sock *sk)
 {
 	return sk->sk_ll_usec && sk->sk_napi_id &&
-	       !need_resched() && !signal_pending(current);
+	       !need_resched() && !signal_pending(current) &&
+	       net_busy_loop_allowed();
 }
 
 
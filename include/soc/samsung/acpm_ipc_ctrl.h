@@ -1,7 +1,11 @@
 #ifndef __ACPM_IPC_CTRL_H__
 #define __ACPM_IPC_CTRL_H__
 
+#include <linux/types.h>
+
 typedef void (*ipc_callback)(unsigned int *cmd, unsigned int size);
+typedef void (*ipc_async_callback)(unsigned int *cmd, unsigned int size,
+		void *priv);
 
 struct ipc_config {
 	unsigned int *cmd;
@@ -11,6 +15,22 @@ struct ipc_config {
 	bool indirection;
 };
 
+/*
+ * Asynchronous request. cmd is sent as is and overwritten with the
+ * response before done() is called from the ACPM IPC irq thread.
+ * The request belongs to acpm_ipc until then; list must be initialised
+ * with INIT_LIST_HEAD() before acpm_ipc_cancel_async() may be used on it.
+ */
+struct ipc_async_req {
+	unsigned int *cmd;
+	ipc_async_callback done;
+	void *priv;
+
+	struct list_head list;
+	unsigned int seq_num;
+	unsigned long long queued;
+};
+
 #define ACPM_IPC_PROTOCOL_OWN			(31)
 #define ACPM_IPC_PROTOCOL_RSP			(30)
 #define ACPM_IPC_PROTOCOL_INDIRECTION		(29)
@@ -29,6 +49,10 @@ unsigned int acpm_ipc_request_channel(struct device_node *np, ipc_callback handl
 unsigned int acpm_ipc_release_channel(struct device_node *np, unsigned int channel_id);
 int acpm_ipc_send_data(unsigned int channel_id, struct ipc_config *cfg);
 int acpm_ipc_send_data_sync(unsigned int channel_id, struct ipc_config *cfg);
+int acpm_ipc_queue_async(unsigned int channel_id, struct ipc_async_req *req);
+void acpm_ipc_flush_async(unsigned int channel_id);
+int acpm_ipc_send_data_async(unsigned int channel_id, struct ipc_async_req *req);
+bool acpm_ipc_cancel_async(unsigned int channel_id, struct ipc_async_req *req);
 int acpm_ipc_set_ch_mode(struct device_node *np, bool polling);
 void exynos_acpm_reboot(void);
 void acpm_stop_log(void);
@@ -55,6 +79,26 @@ static inline int acpm_ipc_send_data_sync(unsigned int channel_id, struct ipc_co
 	return 0;
 }
 
+static inline int acpm_ipc_queue_async(unsigned int channel_id, struct ipc_async_req *req)
+{
+	return 0;
+}
+
+static inline void acpm_ipc_flush_async(unsigned int channel_id)
+{
+	return;
+}
+
+static inline int acpm_ipc_send_data_async(unsigned int channel_id, struct ipc_async_req *req)
+{
+	return 0;
+}
+
+static inline bool acpm_ipc_cancel_async(unsigned int channel_id, struct ipc_async_req *req)
+{
+	return false;
+}
+
 static inline int acpm_ipc_set_ch_mode(struct device_node *np, bool polling)
 {
 	return 0;
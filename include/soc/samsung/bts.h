@@ -11,6 +11,15 @@
 #ifndef __EXYNOS_BTS_H_
 #define __EXYNOS_BTS_H_
 
+#include <linux/notifier.h>
+
+/* Bus domain of a frequency planned from announced bandwidth */
+enum bts_plan_domain {
+	BTS_PLAN_NONE,
+	BTS_PLAN_MIF,
+	BTS_PLAN_INT,
+};
+
 #if defined(CONFIG_EXYNOS8895_BTS)
 #define BUS_WIDTH		16
 #define DISP_UTIL		75
@@ -99,10 +108,19 @@ void bts_update_scen(enum bts_scen_type type, unsigned int val);
 /* bandwidth (KB/s) */
 void bts_update_bw(enum bts_bw_type type, struct bts_bw bw);
 unsigned int bts_calc_bw(enum bts_bw_type type, void *data);
+/* bandwidth (KB/s) of the next configuration */
+void bts_plan_bw(enum bts_bw_type type, struct bts_bw bw);
+unsigned int bts_plan_freq(enum bts_plan_domain domain);
+int bts_plan_register_notifier(struct notifier_block *nb);
+int bts_plan_unregister_notifier(struct notifier_block *nb);
 #else
 #define bts_update_scen(a, b) do {} while(0)
 #define bts_update_bw(a, b) do {} while(0)
 #define bts_calc_bw(a, b) do {} while(0)
+#define bts_plan_bw(a, b) do {} while(0)
+static inline unsigned int bts_plan_freq(enum bts_plan_domain domain) { return 0; }
+static inline int bts_plan_register_notifier(struct notifier_block *nb) { return 0; }
+static inline int bts_plan_unregister_notifier(struct notifier_block *nb) { return 0; }
 #endif
 
 #if defined(CONFIG_EXYNOS5422_BTS) || defined(CONFIG_EXYNOS5433_BTS)	\
@@ -45,9 +45,14 @@ extern unsigned int cal_dfs_get(char *name);
 extern unsigned long cal_dfs_get_max_freq(unsigned int id);
 extern unsigned long cal_dfs_get_min_freq(unsigned int id);
 extern int cal_dfs_set_rate(unsigned int id, unsigned long rate);
+extern int cal_dfs_set_rate_async(unsigned int id, unsigned long rate);
+#define CAL_DFS_BATCH_MAX	8
+extern int cal_dfs_set_rate_batch(unsigned int *id, unsigned long *rate,
+				  int count);
 extern int cal_dfs_set_rate_switch(unsigned int id, unsigned long switch_rate);
 extern unsigned long cal_dfs_cached_get_rate(unsigned int id);
 extern unsigned long cal_dfs_get_rate(unsigned int id);
+extern unsigned long cal_dfs_get_rate_acpm(unsigned int id);
 extern int cal_dfs_get_rate_table(unsigned int id, unsigned long *table);
 extern int cal_dfs_get_asv_table(unsigned int id, unsigned int *table);
 extern int cal_dfs_get_bigturbo_max_freq(unsigned int *table);
@@ -75,6 +75,7 @@ struct ect_dvfs_level
 struct ect_dvfs_domain
 {
 	char *domain_name;
+	unsigned int name_hash;
 	unsigned int domain_offset;
 
 	unsigned int max_frequency;
@@ -141,6 +142,7 @@ struct ect_voltage_table
 struct ect_voltage_domain
 {
 	char *domain_name;
+	unsigned int name_hash;
 	unsigned int domain_offset;
 
 	int num_of_group;
@@ -237,6 +239,7 @@ struct ect_ap_thermal_header
 struct ect_margin_domain
 {
 	char *domain_name;
+	unsigned int name_hash;
 	unsigned int domain_offset;
 
 	int num_of_group;
@@ -302,6 +305,7 @@ struct ect_minlock_header
 struct ect_gen_param_table
 {
 	char *table_name;
+	unsigned int name_hash;
 	unsigned int offset;
 
 	int num_of_col;
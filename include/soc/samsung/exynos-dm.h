@@ -68,6 +68,8 @@ struct exynos_dm_freq {
 
 struct exynos_dm_constraint {
 	struct list_head		node;
+	struct list_head		in_node;		/* on constraint domain's in list */
+	enum exynos_dm_type		master_dm_type;
 
 	bool				guidance;		/* check constraint table by hw guide */
 	u32				table_length;
@@ -105,6 +107,9 @@ struct exynos_dm_data {
 
 	struct list_head		min_clist;
 	struct list_head		max_clist;
+	/* constraints of other domains applying to this domain */
+	struct list_head		min_in_list;
+	struct list_head		max_in_list;
 	u32				constraint_checked;
 #ifdef CONFIG_EXYNOS_ACPM
 	u32				cal_id;
@@ -27,6 +27,7 @@
 #include <linux/slab.h>
 #include <linux/mutex.h>
 #include <linux/debugfs.h>
+#include <linux/workqueue.h>
 
 #include <linux/mfd/samsung/core.h>
 #include <soc/samsung/bcm.h>
@@ -51,6 +52,27 @@
 /* In Exynos, the number of MAX_POWER_DOMAIN is less than 15 */
 #define MAX_PARENT_POWER_DOMAIN	15
 
+#define PD_LAT_BUCKETS		10	/* log2 us, 1us .. 512us and up */
+#define PD_IDLE_BUCKETS		12	/* log2 ms, 1ms .. 2s and up */
+
+/* power on/off latency and idle interval statistics of a domain */
+struct exynos_pd_stat {
+	u64 on_avg_ns;			/* moving average of power on latency */
+	u64 off_avg_ns;			/* moving average of power off latency */
+	u64 on_max_ns;
+	u64 off_max_ns;
+	unsigned int on_hist[PD_LAT_BUCKETS];
+	unsigned int off_hist[PD_LAT_BUCKETS];
+
+	u64 idle_start;			/* when the domain went idle, 0 while in use */
+	u64 idle_avg_ns;		/* moving average of the idle intervals */
+	unsigned int idle_hist[PD_IDLE_BUCKETS];
+
+	unsigned int kept_on;		/* power offs deferred by keep-alive */
+	bool keepalive_expired;
+	struct delayed_work keepalive_work;
+};
+
 struct exynos_pm_domain;
 
 struct exynos_pm_domain {
@@ -69,6 +91,8 @@ struct exynos_pm_domain {
 	struct bcm_info *bcm;
 #endif
 	bool power_down_skipped;
+	unsigned int break_even_us;	/* from DT, 0 to estimate it */
+	struct exynos_pd_stat stat;
 };
 
 struct exynos_pd_dbg_info {
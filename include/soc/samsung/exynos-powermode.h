@@ -45,6 +45,11 @@ static inline char* get_sys_powerdown_str(int mode)
 extern int exynos_cpu_pm_enter(unsigned int cpu, int index);
 extern void exynos_cpu_pm_exit(unsigned int cpu, int enter_failed);
 
+/**
+ * Functions for cpuidle governor
+ */
+extern void exynos_cpu_idle_predict(unsigned int cpu, unsigned int predicted_us);
+
 /**
   IDLE_IP control
  */
@@ -49,6 +49,7 @@ enum PCMMSG {
 	PCM_PLTDAI_MMAP		= 19,
 	PCM_SET_BUFFER		= 20,
 	PCM_SYNCHRONIZE		= 21,
+	PCM_SET_POSITION	= 22,
 };
 
 struct PCMTASK_HW_PARAMS {
@@ -63,6 +64,26 @@ struct PCMTASK_SET_BUFFER {
 	int count;
 };
 
+/* Shared position block for MMAP playback, see struct ABOX_PCM_POSITION.
+ * With no_irq set, PCM_PLTDAI_POINTER is not sent at period boundaries.
+ */
+struct PCMTASK_SET_POSITION {
+	int phyaddr;
+	int size;
+	int no_irq;
+};
+
+/* Written by the firmware whenever the RDMA position advances.
+ * seq is odd while an update is in progress and stays 0 until the first
+ * one; readers retry until they see the same even value on both sides.
+ */
+struct ABOX_PCM_POSITION {
+	unsigned int seq;
+	unsigned int position;		/* byte offset in the ring buffer */
+	unsigned long long frames;	/* frames consumed since trigger */
+	unsigned long long timestamp;	/* system counter when latched */
+};
+
 /* Parameter of the PCMTASK command */
 struct IPC_PCMTASK_MSG {
 	enum PCMMSG msgtype;
@@ -70,6 +91,7 @@ struct IPC_PCMTASK_MSG {
 	union {
 		struct PCMTASK_HW_PARAMS hw_params;
 		struct PCMTASK_SET_BUFFER setbuff;
+		struct PCMTASK_SET_POSITION setpos;
 		unsigned int pointer;
 		int trigger;
 		int synchronize;
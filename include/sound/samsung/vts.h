@@ -12,6 +12,27 @@
 #define __VTS_H
 
 #include <linux/platform_device.h>
+#include <linux/ktime.h>
+
+/**
+ * Voice trigger history which VTS copied to DRAM
+ * @area:	kernel address of the history ring
+ * @addr:	DMA address of the history ring
+ * @size:	size of the history ring in bytes
+ * @pos:	offset in the ring just after the newest sample
+ * @bytes:	bytes copied since the copy started, may exceed size
+ * @trigger:	time of the voice trigger
+ * @tstamp:	time at which the sample before pos was copied
+ */
+struct vts_history {
+	unsigned char *area;
+	dma_addr_t addr;
+	size_t size;
+	size_t pos;
+	size_t bytes;
+	ktime_t trigger;
+	ktime_t tstamp;
+};
 
 #ifdef CONFIG_SND_SOC_SAMSUNG_VTS
 /**
@@ -43,6 +64,15 @@ extern int vts_clear_sram(struct platform_device *pdev);
  */
 extern volatile bool vts_is_on(void);
 extern volatile bool vts_is_recognitionrunning(void);
+
+/**
+ * Get the voice trigger history without copying it
+ * @param[in]	pdev	pointer to struct platform_device of a VTS device
+ * @param[out]	history	filled with the history buffer and its position
+ * @return		0, or -ENODATA if nothing was copied since the last trigger
+ */
+extern int vts_get_history(struct platform_device *pdev,
+		struct vts_history *history);
 #else /* !CONFIG_SND_SOC_SAMSUNG_VTS */
 static inline int vts_acquire_sram(struct platform_device *pdev, int vts)
 { return -ENODEV; }
@@ -51,6 +81,8 @@ static inline int vts_release_sram(struct platform_device *pdev, int vts)
 static inline int vts_clear_sram(struct platform_device *pdev) { return -ENODEV; }
 static inline bool vts_is_on(void) { return false; }
 static inline bool vts_is_recognitionrunning(void) { return false; }
+static inline int vts_get_history(struct platform_device *pdev,
+		struct vts_history *history) { return -ENODEV; }
 #endif /* !CONFIG_SND_SOC_SAMSUNG_VTS */
 
 #endif /* __VTS_H */
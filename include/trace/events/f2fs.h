@@ -1401,6 +1401,30 @@ TRACE_EVENT(f2fs_write_checkpoint,
 		__entry->msg)
 );
 
+TRACE_EVENT(f2fs_cp_blocked,
+
+	TP_PROTO(struct super_block *sb, int reason, unsigned int blocked_us),
+
+	TP_ARGS(sb, reason, blocked_us),
+
+	TP_STRUCT__entry(
+		__field(dev_t,	dev)
+		__field(int,	reason)
+		__field(unsigned int,	blocked_us)
+	),
+
+	TP_fast_assign(
+		__entry->dev		= sb->s_dev;
+		__entry->reason		= reason;
+		__entry->blocked_us	= blocked_us;
+	),
+
+	TP_printk("dev = (%d,%d), checkpoint for %s, blocked = %u us",
+		show_dev(__entry->dev),
+		show_cpreason(__entry->reason),
+		__entry->blocked_us)
+);
+
 DECLARE_EVENT_CLASS(f2fs_discard,
 
 	TP_PROTO(struct block_device *dev, block_t blkstart, block_t blklen),
@@ -23,6 +23,24 @@ TRACE_EVENT(exynos_hpgov_governor_update,
 		    __entry->event, __entry->req_cpu_max, __entry->req_cpu_min)
 );
 
+TRACE_EVENT(exynos_hpgov_cost_model,
+	    TP_PROTO(unsigned int util, unsigned int cost_stay,
+		     unsigned int cost_wake),
+	    TP_ARGS(util, cost_stay, cost_wake),
+	    TP_STRUCT__entry(
+		    __field(unsigned int, util)
+		    __field(unsigned int, cost_stay)
+		    __field(unsigned int, cost_wake)
+	    ),
+	    TP_fast_assign(
+		    __entry->util = util;
+		    __entry->cost_stay = cost_stay;
+		    __entry->cost_wake = cost_wake;
+	    ),
+	    TP_printk("util=%u cost_stay=%uus cost_wake=%uus",
+		    __entry->util, __entry->cost_stay, __entry->cost_wake)
+);
+
 #endif /* _TRACE_HOTPLUG_GOVERNOR_H */
 
 /* This part must be outside protection */
@@ -69,6 +69,7 @@ struct inotify_event {
 /* Flags for sys_inotify_init1.  */
 #define IN_CLOEXEC O_CLOEXEC
 #define IN_NONBLOCK O_NONBLOCK
+#define IN_COALESCE 0x40000000	/* merge IN_MODIFY with a queued one for the same file */
 
 
 #endif /* _UAPI_LINUX_INOTIFY_H */
@@ -712,6 +712,7 @@ enum {
 	TCA_FQ_CODEL_FLOWS,
 	TCA_FQ_CODEL_QUANTUM,
 	TCA_FQ_CODEL_CE_THRESHOLD,
+	TCA_FQ_CODEL_UID_FAIR,
 	__TCA_FQ_CODEL_MAX
 };
 
@@ -736,6 +737,7 @@ struct tc_fq_codel_qd_stats {
 	__u32	new_flows_len;	/* count of flows in new list */
 	__u32	old_flows_len;	/* count of flows in old list */
 	__u32	ce_mark;	/* packets above ce_threshold */
+	__u32	uid_classified;	/* packets queued by socket uid */
 };
 
 struct tc_fq_codel_cl_stats {
@@ -0,0 +1,38 @@
+#ifndef _UAPI_LINUX_PROC_PID_STATS_H
+#define _UAPI_LINUX_PROC_PID_STATS_H
+
+#include <linux/types.h>
+
+/*
+ * /proc/pid_stats: write() an array of __s32 pids, then read() back one
+ * struct proc_pid_stats per pid, in the same order. Every read at offset
+ * 0 samples the processes again, so a poller keeps the fd open and uses
+ * pread(fd, buf, len, 0).
+ */
+
+#define PROC_PID_STATS_MAX	1024	/* pids per write() */
+
+/* proc_pid_stats.flags */
+#define PROC_PID_STATS_VALID	(1 << 0)	/* pid found and visible */
+
+struct proc_pid_stats {
+	__s32	pid;		/* as written, in the reader's pid namespace */
+	__u32	flags;
+	__s32	ppid;
+	__s32	num_threads;
+	__s32	nice;
+	__s16	oom_score_adj;
+	__u8	state;		/* the /proc/<pid>/stat state letter */
+	__u8	__pad;
+	__u64	utime_ns;	/* whole thread group */
+	__u64	stime_ns;
+	__u64	start_time_ns;	/* since boot */
+	__u64	min_flt;
+	__u64	maj_flt;
+	__u64	vsize;		/* bytes */
+	__u64	rss_file;	/* pages */
+	__u64	rss_anon;	/* pages */
+	__u64	swap;		/* pages */
+};
+
+#endif /* _UAPI_LINUX_PROC_PID_STATS_H */
@@ -187,6 +187,7 @@ enum is_set_stream {
 #define V4L2_CID_IS_G_VC2_FRAMEPTR		(V4L2_CID_FIMC_IS_BASE + 71)
 #define V4L2_CID_IS_G_VC3_FRAMEPTR		(V4L2_CID_FIMC_IS_BASE + 72)
 #define V4L2_CID_IS_S_VRA_CONNECTION		(V4L2_CID_FIMC_IS_BASE + 73)
+#define V4L2_CID_IS_S_STREAM_PLAN		(V4L2_CID_FIMC_IS_BASE + 74)
 
 enum is_fw_boot_mode {
 	IS_COLD_BOOT = 0,  /* FrontCamera, 3rd-Party Camera */
@@ -214,6 +214,8 @@ __rwsem_mark_wake(struct rw_semaphore *sem,
 	return sem;
 }
 
+static bool rwsem_optimistic_read_spin(struct rw_semaphore *sem);
+
 /*
  * Wait for the read lock to be granted
  */
@@ -225,6 +227,10 @@ struct rw_semaphore __sched *rwsem_down_read_failed(struct rw_semaphore *sem)
 	struct task_struct *tsk = current;
 	WAKE_Q(wake_q);
 
+	/* spin on a running writer before queueing */
+	if (rwsem_optimistic_read_spin(sem))
+		return sem;
+
 	/* set up my own style of waitqueue */
 	waiter.task = tsk;
 	waiter.type = RWSEM_WAITING_FOR_READ;
@@ -419,6 +425,53 @@ done:
 	return taken;
 }
 
+/*
+ * A reader that failed the fast path still holds its read bias, so once
+ * the writer releases the lock and nobody is queued the count turns
+ * positive and the read lock is ours. Spin for that as long as the
+ * writer is running and the wait list is empty; otherwise fall back to
+ * queueing, which copes with the bias arriving late.
+ */
+static bool rwsem_optimistic_read_spin(struct rw_semaphore *sem)
+{
+	struct task_struct *owner;
+	bool taken = false;
+
+	preempt_disable();
+
+	if (!rwsem_can_spin_on_owner(sem))
+		goto done;
+
+	rcu_read_lock();
+	while (true) {
+		if (READ_ONCE(sem->count) > 0) {
+			/* pairs with the release in __up_write() */
+			smp_rmb();
+			taken = true;
+			break;
+		}
+
+		if (!list_empty(&sem->wait_list) || need_resched())
+			break;
+
+		owner = READ_ONCE(sem->owner);
+		if (owner) {
+			/* see rwsem_spin_on_owner() */
+			barrier();
+			if (!owner->on_cpu)
+				break;
+		} else if (rt_task(current)) {
+			break;
+		}
+
+		cpu_relax_lowlatency();
+	}
+	rcu_read_unlock();
+done:
+	preempt_enable();
+	return taken;
+}
+
 /*
  * Return true if the rwsem has active spinner
  */
@@ -433,6 +486,11 @@ static bool rwsem_optimistic_spin(struct rw_semaphore *sem)
 	return false;
 }
 
+static bool rwsem_optimistic_read_spin(struct rw_semaphore *sem)
+{
+	return false;
+}
+
 static inline bool rwsem_has_spinner(struct rw_semaphore *sem)
 {
 	return false;
@@ -10,18 +10,151 @@
 #include <linux/export.h>
 #include <linux/rwsem.h>
 #include <linux/atomic.h>
+#include <linux/init.h>
+#include <linux/moduleparam.h>
+#include <linux/static_key.h>
 
 #include "rwsem.h"
 
+#ifdef CONFIG_MMAP_SEM_STAT
+/*
+ * Per task histograms of how long the task waited for and held its own
+ * mm->mmap_sem, without lockdep. Off until rwsem.mmap_sem_stat=1.
+ */
+static struct static_key mmap_sem_stat_key = STATIC_KEY_INIT_FALSE;
+static bool mmap_sem_stat_boot;
+
+static int mmap_sem_stat_set(const char *val, const struct kernel_param *kp)
+{
+	bool enable;
+	int ret;
+
+	ret = strtobool(val, &enable);
+	if (ret)
+		return ret;
+
+	/* on the command line, before jump labels can be patched */
+	if (!static_key_initialized) {
+		mmap_sem_stat_boot = enable;
+		return 0;
+	}
+
+	if (enable && !static_key_enabled(&mmap_sem_stat_key))
+		static_key_slow_inc(&mmap_sem_stat_key);
+	else if (!enable && static_key_enabled(&mmap_sem_stat_key))
+		static_key_slow_dec(&mmap_sem_stat_key);
+
+	return 0;
+}
+
+static int mmap_sem_stat_get(char *buffer, const struct kernel_param *kp)
+{
+	return sprintf(buffer, "%c", static_key_enabled(&mmap_sem_stat_key) ?
+		       'Y' : 'N');
+}
+
+static const struct kernel_param_ops mmap_sem_stat_ops = {
+	.set = mmap_sem_stat_set,
+	.get = mmap_sem_stat_get,
+};
+module_param_cb(mmap_sem_stat, &mmap_sem_stat_ops, NULL, 0644);
+
+static int __init mmap_sem_stat_init(void)
+{
+	if (mmap_sem_stat_boot)
+		static_key_slow_inc(&mmap_sem_stat_key);
+	return 0;
+}
+early_initcall(mmap_sem_stat_init);
+
+static inline bool mmap_sem_stat_sem(struct rw_semaphore *sem)
+{
+	return static_key_false(&mmap_sem_stat_key) &&
+	       current->mm && sem == &current->mm->mmap_sem;
+}
+
+static void mmap_sem_stat_account(u32 *hist, u64 ns)
+{
+	u64 t = ns >> 14;	/* ~16us */
+	int i = 0;
+
+	/* fork copies the histograms, start over in the child */
+	if (current->mmap_sem_stat_pid != current->pid) {
+		memset(current->mmap_sem_wait_hist, 0,
+		       sizeof(current->mmap_sem_wait_hist));
+		memset(current->mmap_sem_hold_hist, 0,
+		       sizeof(current->mmap_sem_hold_hist));
+		current->mmap_sem_stat_pid = current->pid;
+	}
+
+	while (t && i < MMAP_SEM_STAT_BUCKETS - 1) {
+		t >>= 2;
+		i++;
+	}
+	hist[i]++;
+}
+
+static inline u64 mmap_sem_stat_wait(struct rw_semaphore *sem)
+{
+	return mmap_sem_stat_sem(sem) ? local_clock() : 0;
+}
+
+static inline void mmap_sem_stat_acquired(struct rw_semaphore *sem, u64 start)
+{
+	u64 now;
+
+	if (!start && !mmap_sem_stat_sem(sem))
+		return;
+
+	now = local_clock();
+	if (start)
+		mmap_sem_stat_account(current->mmap_sem_wait_hist, now - start);
+	current->mmap_sem_acquired = now;
+}
+
+static inline void mmap_sem_stat_release(struct rw_semaphore *sem)
+{
+	u64 start;
+
+	if (!mmap_sem_stat_sem(sem))
+		return;
+
+	start = current->mmap_sem_acquired;
+	if (!start)
+		return;
+
+	current->mmap_sem_acquired = 0;
+	mmap_sem_stat_account(current->mmap_sem_hold_hist,
+			      local_clock() - start);
+}
+#else
+static inline u64 mmap_sem_stat_wait(struct rw_semaphore *sem)
+{
+	return 0;
+}
+
+static inline void mmap_sem_stat_acquired(struct rw_semaphore *sem, u64 start)
+{
+}
+
+static inline void mmap_sem_stat_release(struct rw_semaphore *sem)
+{
+}
+#endif
+
 /*
  * lock for reading
  */
 void __sched down_read(struct rw_semaphore *sem)
 {
+	u64 start;
+
 	might_sleep();
 	rwsem_acquire_read(&sem->dep_map, 0, 0, _RET_IP_);
 
+	start = mmap_sem_stat_wait(sem);
 	LOCK_CONTENDED(sem, __down_read_trylock, __down_read);
+	mmap_sem_stat_acquired(sem, start);
 }
 
 EXPORT_SYMBOL(down_read);
@@ -33,8 +166,10 @@ int down_read_trylock(struct rw_semaphore *sem)
 {
 	int ret = __down_read_trylock(sem);
 
-	if (ret == 1)
+	if (ret == 1) {
 		rwsem_acquire_read(&sem->dep_map, 0, 1, _RET_IP_);
+		mmap_sem_stat_acquired(sem, 0);
+	}
 	return ret;
 }
 
@@ -45,11 +180,15 @@ EXPORT_SYMBOL(down_read_trylock);
  */
 void __sched down_write(struct rw_semaphore *sem)
 {
+	u64 start;
+
 	might_sleep();
 	rwsem_acquire(&sem->dep_map, 0, 0, _RET_IP_);
 
+	start = mmap_sem_stat_wait(sem);
 	LOCK_CONTENDED(sem, __down_write_trylock, __down_write);
 	rwsem_set_owner(sem);
+	mmap_sem_stat_acquired(sem, start);
 }
 
 EXPORT_SYMBOL(down_write);
@@ -64,6 +203,7 @@ int down_write_trylock(struct rw_semaphore *sem)
 	if (ret == 1) {
 		rwsem_acquire(&sem->dep_map, 0, 1, _RET_IP_);
 		rwsem_set_owner(sem);
+		mmap_sem_stat_acquired(sem, 0);
 	}
 
 	return ret;
@@ -78,6 +218,7 @@ void up_read(struct rw_semaphore *sem)
 {
 	rwsem_release(&sem->dep_map, 1, _RET_IP_);
 
+	mmap_sem_stat_release(sem);
 	__up_read(sem);
 }
 
@@ -90,6 +231,7 @@ void up_write(struct rw_semaphore *sem)
 {
 	rwsem_release(&sem->dep_map, 1, _RET_IP_);
 
+	mmap_sem_stat_release(sem);
 	rwsem_clear_owner(sem);
 	__up_write(sem);
 }
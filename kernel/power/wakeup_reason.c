@@ -24,6 +24,7 @@
 #include <linux/sysfs.h>
 #include <linux/init.h>
 #include <linux/spinlock.h>
+#include <linux/string.h>
 #include <linux/notifier.h>
 #include <linux/suspend.h>
 #ifdef CONFIG_SEC_PM_DEBUG
@@ -46,6 +47,29 @@ static ktime_t curr_monotime; /* monotonic time after last suspend */
 static ktime_t last_stime; /* monotonic boottime offset before last suspend */
 static ktime_t curr_stime; /* monotonic boottime offset after last suspend */
 
+/*
+ * Awake time between a resume and the next suspend, charged to the first
+ * wakeup IRQ of that resume, along with the wakeup source that was last
+ * to let go before the system went back to sleep.
+ */
+#define MAX_WAKEUP_STATS	32
+#define WAKEUP_STAT_UNKNOWN	-1
+#define WAKEUP_STAT_MBOX	-2
+#define WAKEUP_STAT_WS_LEN	48
+
+struct wakeup_stat {
+	int irq;
+	unsigned int count;
+	u64 awake_ns;
+	u64 max_ns;
+	char last_ws[WAKEUP_STAT_WS_LEN];
+};
+
+static struct wakeup_stat wakeup_stats[MAX_WAKEUP_STATS];
+static int wakeup_stat_count;
+static unsigned int wakeup_stat_dropped;
+static struct wakeup_stat *curr_stat;
+
 static ssize_t last_resume_reason_show(struct kobject *kobj, struct kobj_attribute *attr,
 		char *buf)
 {
@@ -102,12 +126,52 @@ static ssize_t last_suspend_time_show(struct kobject *kobj,
 				sleep_time.tv_sec, sleep_time.tv_nsec);
 }
 
+static ssize_t wakeup_stats_show(struct kobject *kobj,
+			struct kobj_attribute *attr, char *buf)
+{
+	struct wakeup_stat *stat;
+	struct irq_desc *desc;
+	const char *name;
+	int i, buf_offset = 0;
+
+	buf_offset += scnprintf(buf, PAGE_SIZE,
+			"irq name count awake_ms max_ms last_wakeup_source\n");
+
+	spin_lock(&resume_reason_lock);
+	for (i = 0; i < wakeup_stat_count; i++) {
+		stat = &wakeup_stats[i];
+		if (stat->irq == WAKEUP_STAT_UNKNOWN) {
+			name = "unknown";
+		} else if (stat->irq == WAKEUP_STAT_MBOX) {
+			name = "INT_MBOX";
+		} else {
+			desc = irq_to_desc(stat->irq);
+			name = desc && desc->action && desc->action->name ?
+				desc->action->name : "-";
+		}
+
+		buf_offset += scnprintf(buf + buf_offset, PAGE_SIZE - buf_offset,
+				"%d %s %u %llu %llu %s\n", stat->irq, name,
+				stat->count, div_u64(stat->awake_ns, NSEC_PER_MSEC),
+				div_u64(stat->max_ns, NSEC_PER_MSEC),
+				stat->last_ws[0] ? stat->last_ws : "-");
+	}
+	if (wakeup_stat_dropped)
+		buf_offset += scnprintf(buf + buf_offset, PAGE_SIZE - buf_offset,
+				"dropped %u\n", wakeup_stat_dropped);
+	spin_unlock(&resume_reason_lock);
+
+	return buf_offset;
+}
+
 static struct kobj_attribute resume_reason = __ATTR_RO(last_resume_reason);
 static struct kobj_attribute suspend_time = __ATTR_RO(last_suspend_time);
+static struct kobj_attribute wakeup_stats_attr = __ATTR_RO(wakeup_stats);
 
 static struct attribute *attrs[] = {
 	&resume_reason.attr,
 	&suspend_time.attr,
+	&wakeup_stats_attr.attr,
 	NULL,
 };
 static struct attribute_group attr_group = {
@@ -192,6 +256,68 @@ void log_suspend_abort_reason(const char *fmt, ...)
 	spin_unlock(&resume_reason_lock);
 }
 
+static struct wakeup_stat *wakeup_stat_get(int irq)
+{
+	struct wakeup_stat *stat;
+	int i;
+
+	for (i = 0; i < wakeup_stat_count; i++)
+		if (wakeup_stats[i].irq == irq)
+			return &wakeup_stats[i];
+
+	if (wakeup_stat_count == MAX_WAKEUP_STATS) {
+		wakeup_stat_dropped++;
+		return NULL;
+	}
+
+	stat = &wakeup_stats[wakeup_stat_count++];
+	stat->irq = irq;
+	return stat;
+}
+
+/* Called with resume_reason_lock held after a completed resume */
+static void wakeup_stat_open(void)
+{
+	int irq = WAKEUP_STAT_UNKNOWN;
+
+	curr_stat = NULL;
+	if (suspend_abort)
+		return;
+
+	if (irqcount)
+		irq = irq_list[0];
+#ifdef CONFIG_SEC_PM_DEBUG
+	else if (mbox_wakeup)
+		irq = WAKEUP_STAT_MBOX;
+#endif
+
+	curr_stat = wakeup_stat_get(irq);
+	if (curr_stat)
+		curr_stat->count++;
+}
+
+/* Charge the awake time since the last resume, before the next suspend */
+static void wakeup_stat_close(ktime_t now)
+{
+	char ws[WAKEUP_STAT_WS_LEN + 32] = { 0 };
+	const char *name;
+	u64 awake;
+
+	if (!curr_stat)
+		return;
+
+	pm_get_active_wakeup_sources(ws, sizeof(ws));
+	name = strnchr(ws, sizeof(ws), ':');
+	name = name ? name + 2 : ws;
+
+	awake = ktime_to_ns(ktime_sub(now, curr_stime));
+	curr_stat->awake_ns += awake;
+	if (awake > curr_stat->max_ns)
+		curr_stat->max_ns = awake;
+	strlcpy(curr_stat->last_ws, strim((char *)name), WAKEUP_STAT_WS_LEN);
+	curr_stat = NULL;
+}
+
 /* Detects a suspend and clears all the previous wake up reasons*/
 static int wakeup_reason_pm_event(struct notifier_block *notifier,
 		unsigned long pm_event, void *unused)
@@ -199,6 +325,7 @@ static int wakeup_reason_pm_event(struct notifier_block *notifier,
 	switch (pm_event) {
 	case PM_SUSPEND_PREPARE:
 		spin_lock(&resume_reason_lock);
+		wakeup_stat_close(ktime_get_boottime());
 		irqcount = 0;
 		suspend_abort = false;
 #ifdef CONFIG_SEC_PM_DEBUG
@@ -215,6 +342,9 @@ static int wakeup_reason_pm_event(struct notifier_block *notifier,
 		curr_monotime = ktime_get();
 		/* monotonic time since boot including the time spent in suspend */
 		curr_stime = ktime_get_boottime();
+		spin_lock(&resume_reason_lock);
+		wakeup_stat_open();
+		spin_unlock(&resume_reason_lock);
 		break;
 	default:
 		break;
@@ -43,6 +43,7 @@
 #include <linux/rculist.h>
 #include <linux/poll.h>
 #include <linux/irq_work.h>
+#include <linux/kthread.h>
 #include <linux/utsname.h>
 #include <linux/ctype.h>
 #include <linux/uio.h>
@@ -1735,6 +1736,62 @@ static int console_trylock_for_printk(void)
 	return 1;
 }
 
+/*
+ * Console output is handed to the printk kthread so that callers, which
+ * are often IRQ handlers or hold spinlocks, only pay for storing the
+ * record. Emergencies and anything that may not see the kthread run
+ * again are still printed by the caller.
+ */
+static bool printk_offload = true;
+module_param_named(offload, printk_offload, bool, S_IRUGO | S_IWUSR);
+
+static struct task_struct *printk_kthread;
+static bool printk_kthread_pending;
+
+/* printk may run under rq locks, so do the wake up from irq_work */
+static void printk_kthread_wake(struct irq_work *irq_work)
+{
+	wake_up_process(printk_kthread);
+}
+
+static DEFINE_PER_CPU(struct irq_work, printk_kthread_work) = {
+	.func = printk_kthread_wake,
+};
+
+static bool printk_offload_console(int level)
+{
+	if (!printk_offload || !printk_kthread)
+		return false;
+
+	if (oops_in_progress || system_state != SYSTEM_RUNNING)
+		return false;
+
+	if (level == LOGLEVEL_EMERG)
+		return false;
+
+	WRITE_ONCE(printk_kthread_pending, true);
+	preempt_disable();
+	irq_work_queue(this_cpu_ptr(&printk_kthread_work));
+	preempt_enable();
+	return true;
+}
+
+static int printk_kthread_func(void *data)
+{
+	while (!kthread_should_stop()) {
+		set_current_state(TASK_INTERRUPTIBLE);
+		if (!READ_ONCE(printk_kthread_pending))
+			schedule();
+		__set_current_state(TASK_RUNNING);
+
+		WRITE_ONCE(printk_kthread_pending, false);
+		console_lock();
+		console_unlock();
+	}
+
+	return 0;
+}
+
 int printk_delay_msec __read_mostly;
 
 static inline void printk_delay(void)
@@ -2020,7 +2077,7 @@ asmlinkage int vprintk_emit(int facility, int level,
 	local_irq_restore(flags);
 
 	/* If called from the scheduler, we can not call up(). */
-	if (!in_sched) {
+	if (!in_sched && !printk_offload_console(level)) {
 		lockdep_off();
 		/*
 		 * Disable preemption to avoid being preempted while holding
@@ -2940,6 +2997,12 @@ static int __init printk_late_init(void)
 		}
 	}
 	hotcpu_notifier(console_cpu_notify, 0);
+
+	printk_kthread = kthread_run(printk_kthread_func, NULL, "printk");
+	if (IS_ERR(printk_kthread)) {
+		pr_err("printk: unable to start kthread, console stays synchronous\n");
+		printk_kthread = NULL;
+	}
 	return 0;
 }
 late_initcall(printk_late_init);
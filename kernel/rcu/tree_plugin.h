@@ -59,6 +59,8 @@ DEFINE_PER_CPU(char, rcu_cpu_has_work);
 static cpumask_var_t rcu_nocb_mask; /* CPUs to have callbacks offloaded. */
 static bool have_rcu_nocb_mask;	    /* Was rcu_nocb_mask allocated? */
 static bool __read_mostly rcu_nocb_poll;    /* Offload kthread are to poll. */
+static cpumask_var_t rcu_nocb_affinity; /* CPUs to run rcuo kthreads on. */
+static bool have_rcu_nocb_affinity; /* Was rcu_nocb_affinity allocated? */
 #endif /* #ifdef CONFIG_RCU_NOCB_CPU */
 
 /*
@@ -1811,6 +1813,19 @@ static int __init rcu_nocb_setup(char *str)
 }
 __setup("rcu_nocbs=", rcu_nocb_setup);
 
+/*
+ * Parse the boot-time CPU list the rcuo kthreads are confined to, so
+ * that offloaded callbacks can be kept on the little cores.
+ */
+static int __init rcu_nocb_affinity_setup(char *str)
+{
+	alloc_bootmem_cpumask_var(&rcu_nocb_affinity);
+	have_rcu_nocb_affinity = true;
+	cpulist_parse(str, rcu_nocb_affinity);
+	return 1;
+}
+__setup("rcu_nocb_affinity=", rcu_nocb_affinity_setup);
+
 static int __init parse_rcu_nocb_poll(char *arg)
 {
 	rcu_nocb_poll = 1;
@@ -2414,6 +2429,9 @@ static void rcu_spawn_one_nocb_kthread(struct rcu_state *rsp, int cpu)
 	t = kthread_run(rcu_nocb_kthread, rdp_spawn,
 			"rcuo%c/%d", rsp->abbr, cpu);
 	BUG_ON(IS_ERR(t));
+	if (have_rcu_nocb_affinity &&
+	    cpumask_intersects(rcu_nocb_affinity, cpu_possible_mask))
+		set_cpus_allowed_ptr(t, rcu_nocb_affinity);
 	WRITE_ONCE(rdp_spawn->nocb_kthread, t);
 }
 
@@ -854,6 +854,7 @@ static inline void enqueue_task(struct rq *rq, struct task_struct *p, int flags)
 	update_rq_clock(rq);
 	if (!(flags & ENQUEUE_RESTORE))
 		sched_info_queued(rq, p);
+	rq_sched_xcache_account(rq, p);
 	p->sched_class->enqueue_task(rq, p, flags);
 }
 
@@ -1323,6 +1324,22 @@ void set_task_cpu(struct task_struct *p, unsigned int new_cpu)
 			p->sched_class->migrate_task_rq(p, new_cpu);
 		p->se.nr_migrations++;
 		perf_event_task_migrate(p);
+#ifdef CONFIG_SCHEDSTATS
+		if (!cpus_share_cache(task_cpu(p), new_cpu)) {
+			/*
+			 * Only p->pi_lock may be held here, so the source
+			 * clock is read without its rq lock and the counting
+			 * is left to the enqueue on the new rq.
+			 */
+			u64 clock = READ_ONCE(task_rq(p)->clock_task);
+
+			p->se.statistics.xcache_migration = SCHED_XCACHE_MIGRATED;
+			/* the same test as task_hot(), what it would have kept */
+			if ((s64)(clock - p->se.exec_start) <
+					(s64)sysctl_sched_migration_cost)
+				p->se.statistics.xcache_migration |= SCHED_XCACHE_HOT;
+		}
+#endif
 	}
 
 	__set_task_cpu(p, new_cpu);
@@ -2197,6 +2214,11 @@ static void __sched_fork(unsigned long clone_flags, struct task_struct *p)
 	memset(&p->se.statistics, 0, sizeof(p->se.statistics));
 #endif
 
+#ifdef CONFIG_SCHED_FRAME_DEADLINE
+	p->frame_deadline = 0;
+	p->frame_queued = false;
+#endif
+
 	RB_CLEAR_NODE(&p->dl.rb_node);
 	init_dl_task_timer(&p->dl);
 	__dl_clear_params(p);
@@ -7,6 +7,7 @@
 #include <linux/rcupdate.h>
 #include <linux/kernel_stat.h>
 #include <linux/err.h>
+#include <linux/sched_energy.h>
 
 #include "sched.h"
 
@@ -25,12 +26,21 @@ enum cpuacct_stat_index {
 	CPUACCT_STAT_NSTATS,
 };
 
+/* capacity states of the energy model a cpu's time is split into */
+#define CPUACCT_MAX_CAP_STATES	32
+
+struct cpuacct_cap_time {
+	u64 time[CPUACCT_MAX_CAP_STATES];
+};
+
 /* track cpu usage of a group of tasks and its child groups */
 struct cpuacct {
 	struct cgroup_subsys_state css;
 	/* cpuusage holds pointer to a u64-type object on every cpu */
 	u64 __percpu *cpuusage;
 	struct kernel_cpustat __percpu *cpustat;
+	/* cpu time by capacity state, i.e. by frequency */
+	struct cpuacct_cap_time __percpu *cap_time;
 };
 
 static inline struct cpuacct *css_ca(struct cgroup_subsys_state *css)
@@ -50,9 +60,11 @@ static inline struct cpuacct *parent_ca(struct cpuacct *ca)
 }
 
 static DEFINE_PER_CPU(u64, root_cpuacct_cpuusage);
+static DEFINE_PER_CPU(struct cpuacct_cap_time, root_cpuacct_cap_time);
 static struct cpuacct root_cpuacct = {
 	.cpustat	= &kernel_cpustat,
 	.cpuusage	= &root_cpuacct_cpuusage,
+	.cap_time	= &root_cpuacct_cap_time,
 };
 
 /* create a new cpu accounting group */
@@ -76,8 +88,14 @@ cpuacct_css_alloc(struct cgroup_subsys_state *parent_css)
 	if (!ca->cpustat)
 		goto out_free_cpuusage;
 
+	ca->cap_time = alloc_percpu(struct cpuacct_cap_time);
+	if (!ca->cap_time)
+		goto out_free_cpustat;
+
 	return &ca->css;
 
+out_free_cpustat:
+	free_percpu(ca->cpustat);
 out_free_cpuusage:
 	free_percpu(ca->cpuusage);
 out_free_ca:
@@ -91,6 +109,7 @@ static void cpuacct_css_free(struct cgroup_subsys_state *css)
 {
 	struct cpuacct *ca = css_ca(css);
 
+	free_percpu(ca->cap_time);
 	free_percpu(ca->cpustat);
 	free_percpu(ca->cpuusage);
 	kfree(ca);
@@ -210,6 +229,104 @@ static int cpuacct_stats_show(struct seq_file *sf, void *v)
 	return 0;
 }
 
+#ifdef CONFIG_SMP
+static struct sched_group_energy *cpuacct_sge(int cpu)
+{
+	return sge_array[cpu][SD_LEVEL0];
+}
+
+/* the lowest capacity state which covers the current capacity of cpu */
+static int cpuacct_cap_state(int cpu)
+{
+	struct sched_group_energy *sge = cpuacct_sge(cpu);
+	unsigned long cap;
+	int i, nr;
+
+	if (!sge || !sge->nr_cap_states)
+		return -1;
+
+	cap = (capacity_orig_of(cpu) * arch_scale_freq_capacity(NULL, cpu))
+			>> SCHED_CAPACITY_SHIFT;
+	nr = min_t(int, sge->nr_cap_states, CPUACCT_MAX_CAP_STATES);
+	for (i = 0; i < nr - 1; i++)
+		if (sge->cap_states[i].cap >= cap)
+			break;
+
+	return i;
+}
+
+/* walk the clusters by their first cpu, which stands for the cluster */
+#define for_each_cpuacct_cluster(cpu)					\
+	for_each_possible_cpu(cpu)					\
+		if (cpumask_first(topology_core_cpumask(cpu)) == cpu &&	\
+				cpuacct_sge(cpu))
+
+static u64 cpuacct_cluster_time(struct cpuacct *ca, int first, int state)
+{
+	u64 time = 0;
+	int cpu;
+
+	for_each_cpu(cpu, topology_core_cpumask(first))
+		time += per_cpu_ptr(ca->cap_time, cpu)->time[state];
+
+	return time;
+}
+
+/* per cluster "<capacity>:<ns>" for every capacity state */
+static int cpuacct_cap_time_show(struct seq_file *m, void *v)
+{
+	struct cpuacct *ca = css_ca(seq_css(m));
+	struct sched_group_energy *sge;
+	int cpu, i, nr;
+
+	for_each_cpuacct_cluster(cpu) {
+		sge = cpuacct_sge(cpu);
+		nr = min_t(int, sge->nr_cap_states, CPUACCT_MAX_CAP_STATES);
+
+		seq_printf(m, "cluster%d", topology_physical_package_id(cpu));
+		for (i = 0; i < nr; i++)
+			seq_printf(m, " %lu:%llu", sge->cap_states[i].cap,
+				   cpuacct_cluster_time(ca, cpu, i));
+		seq_putc(m, '\n');
+	}
+
+	return 0;
+}
+
+/*
+ * Busy energy estimated from the energy model, in its power unit times
+ * milliseconds. Idle energy isn't attributable to a group.
+ */
+static int cpuacct_energy_show(struct seq_file *m, void *v)
+{
+	struct cpuacct *ca = css_ca(seq_css(m));
+	struct sched_group_energy *sge;
+	u64 energy, total = 0;
+	int cpu, i, nr;
+
+	for_each_cpuacct_cluster(cpu) {
+		sge = cpuacct_sge(cpu);
+		nr = min_t(int, sge->nr_cap_states, CPUACCT_MAX_CAP_STATES);
+
+		energy = 0;
+		for (i = 0; i < nr; i++)
+			energy += div_u64(cpuacct_cluster_time(ca, cpu, i),
+					  NSEC_PER_MSEC) * sge->cap_states[i].power;
+		seq_printf(m, "cluster%d %llu\n",
+			   topology_physical_package_id(cpu), energy);
+		total += energy;
+	}
+	seq_printf(m, "total %llu\n", total);
+
+	return 0;
+}
+#else
+static inline int cpuacct_cap_state(int cpu)
+{
+	return -1;
+}
+#endif
+
 static struct cftype files[] = {
 	{
 		.name = "usage",
@@ -224,6 +341,16 @@ static struct cftype files[] = {
 		.name = "stat",
 		.seq_show = cpuacct_stats_show,
 	},
+#ifdef CONFIG_SMP
+	{
+		.name = "cap_time",
+		.seq_show = cpuacct_cap_time_show,
+	},
+	{
+		.name = "energy",
+		.seq_show = cpuacct_energy_show,
+	},
+#endif
 	{ }	/* terminate */
 };
 
@@ -235,9 +362,10 @@ static struct cftype files[] = {
 void cpuacct_charge(struct task_struct *tsk, u64 cputime)
 {
 	struct cpuacct *ca;
-	int cpu;
+	int cpu, state;
 
 	cpu = task_cpu(tsk);
+	state = cpuacct_cap_state(cpu);
 
 	rcu_read_lock();
 
@@ -247,6 +375,9 @@ void cpuacct_charge(struct task_struct *tsk, u64 cputime)
 		u64 *cpuusage = per_cpu_ptr(ca->cpuusage, cpu);
 		*cpuusage += cputime;
 
+		if (state >= 0)
+			per_cpu_ptr(ca->cap_time, cpu)->time[state] += cputime;
+
 		ca = parent_ca(ca);
 		if (!ca)
 			break;
@@ -19,6 +19,7 @@
 
 #include "sched.h"
 #include "tune.h"
+#include "walt.h"
 
 struct sugov_tunables {
 	struct gov_attr_set attr_set;
@@ -57,6 +58,7 @@ struct sugov_cpu {
 	/* The fields below are only needed when sharing a policy. */
 	unsigned long util;
 	unsigned long max;
+	unsigned long pred;
 	u64 last_update;
 };
 
@@ -119,8 +121,24 @@ static int sugov_select_scaling_cpu(void)
 static void sugov_update_commit(struct sugov_policy *sg_policy, u64 time,
 				unsigned int next_freq)
 {
+	struct cpufreq_policy *policy = sg_policy->policy;
+
 	sg_policy->last_freq_update_time = time;
 
+	if (policy->fast_switch_enabled) {
+		if (sg_policy->next_freq == next_freq)
+			return;
+
+		sg_policy->next_freq = next_freq;
+		next_freq = cpufreq_driver_fast_switch(policy, next_freq);
+		if (!next_freq)
+			return;
+
+		policy->cur = next_freq;
+		trace_cpu_frequency(next_freq, smp_processor_id());
+		return;
+	}
+
 	if (sg_policy->next_freq != next_freq) {
 		sg_policy->next_freq = next_freq;
 		sg_policy->work_in_progress = true;
@@ -186,6 +204,13 @@ static unsigned int sugov_next_freq_shared(struct sugov_policy *sg_policy,
 	if (util == ULONG_MAX)
 		goto return_max;
 
+	/*
+	 * Let the predicted demand of the tasks queued on a CPU raise its
+	 * utilization, so a burst is served at the right frequency from its
+	 * first window instead of after the history has caught up.
+	 */
+	util = max(util, this_cpu_ptr(&sugov_cpu)->pred);
+
 	for_each_cpu(j, policy->cpus) {
 		struct sugov_cpu *j_sg_cpu;
 		unsigned long j_util, j_max;
@@ -210,6 +235,8 @@ static unsigned int sugov_next_freq_shared(struct sugov_policy *sg_policy,
 		if (j_util == ULONG_MAX)
 			goto return_max;
 
+		j_util = max(j_util, j_sg_cpu->pred);
+
 		j_max = j_sg_cpu->max;
 		if (j_util * max > j_max * util) {
 			util = j_util;
@@ -237,6 +264,7 @@ static void sugov_update_shared(struct update_util_data *hook, u64 time,
 
 	sg_cpu->util = util;
 	sg_cpu->max = max;
+	sg_cpu->pred = min(walt_cpu_pred_util(smp_processor_id()), max);
 	sg_cpu->last_update = time;
 
 	if (sugov_should_update_freq(sg_policy, time)) {
@@ -558,6 +586,8 @@ static int sugov_start(struct cpufreq_policy *policy)
 	sg_policy->work_in_progress = false;
 	sg_policy->need_freq_update = false;
 
+	cpufreq_enable_fast_switch(policy);
+
 	for_each_cpu(cpu, policy->cpus) {
 		struct sugov_cpu *sg_cpu = &per_cpu(sugov_cpu, cpu);
 
@@ -586,6 +616,8 @@ static int sugov_stop(struct cpufreq_policy *policy)
 
 	synchronize_sched();
 
+	cpufreq_disable_fast_switch(policy);
+
 	irq_work_sync(&sg_policy->irq_work);
 	cancel_work_sync(&sg_policy->work);
 	return 0;
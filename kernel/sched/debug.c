@@ -325,9 +325,19 @@ do {									\
 
 	P(ttwu_count);
 	P(ttwu_local);
+	P(nr_xcache_migrations);
+	P(nr_xcache_hot_migrations);
 
 #undef P
 #undef P64
+	{
+		int i;
+
+		SEQ_printf(m, "  .%-30s:", "rq_lat_hist");
+		for (i = 0; i < SCHED_LAT_NR_BUCKETS; i++)
+			SEQ_printf(m, " %u", rq->rq_lat_hist[i]);
+		SEQ_printf(m, "\n");
+	}
 #endif
 	spin_lock_irqsave(&sched_debug_lock, flags);
 	print_cfs_stats(m, cpu);
@@ -2792,6 +2792,7 @@ schedtune_cpu_margin(unsigned long util, int cpu)
 
 #ifdef CONFIG_CGROUP_SCHEDTUNE
 	boost += schedtune_cpu_boost(cpu);
+	boost = max_t(unsigned int, boost, schedtune_cpu_frame_boost(cpu));
 #else
 	boost += get_sysctl_sched_cfs_boost();
 #endif
@@ -3418,6 +3419,7 @@ static int idle_balance(struct rq *this_rq);
 #else /* CONFIG_SMP */
 
 static inline void update_load_avg(struct sched_entity *se, int update_tg) {}
+static inline void cfs_rq_util_change(struct cfs_rq *cfs_rq) {}
 static inline void
 enqueue_entity_load_avg(struct cfs_rq *cfs_rq, struct sched_entity *se) {}
 static inline void
@@ -4715,6 +4717,10 @@ enqueue_task_fair(struct rq *rq, struct task_struct *p, int flags)
 	if (!se) {
 		add_nr_running(rq, 1);
 		schedtune_enqueue_task(p, cpu_of(rq));
+
+		/* Don't wait for the next tick to apply a frame boost */
+		if (schedtune_task_frame_urgent(p))
+			cfs_rq_util_change(&rq->cfs);
 	}
 
 	hrtick_update(rq);
@@ -6723,7 +6729,7 @@ static int cpu_util(int cpu)
 }
 #endif
 /*
- * select_task_rq_fair: Select target runqueue for the waking task in domains
+ * __select_task_rq_fair: Select target runqueue for the waking task in domains
  * that have the 'sd_flag' flag set. In practice, this is SD_BALANCE_WAKE,
  * SD_BALANCE_FORK, or SD_BALANCE_EXEC.
  *
@@ -6735,7 +6741,7 @@ static int cpu_util(int cpu)
  * preempt must be disabled.
  */
 static int
-select_task_rq_fair(struct task_struct *p, int prev_cpu, int sd_flag, int wake_flags)
+__select_task_rq_fair(struct task_struct *p, int prev_cpu, int sd_flag, int wake_flags)
 {
 	struct sched_domain *tmp, *affine_sd = NULL, *sd = NULL;
 	int cpu = smp_processor_id();
@@ -6890,6 +6896,73 @@ select_task_rq_fair(struct task_struct *p, int prev_cpu, int sd_flag, int wake_f
 	return new_cpu;
 }
 
+/*
+ * Apply the SchedTune CPU reservation to the cpu picked for @p.
+ *
+ * A prefer_idle task of the boost group holding the reservation goes to
+ * the reserved cpu when that one is idle and the picked one is not.
+ * Tasks of other groups are moved off the reserved cpu, preferably to an
+ * idle cpu of the same cluster so HMP domain placement is preserved.
+ */
+static int schedtune_reserve_fixup(struct task_struct *p, int cpu)
+{
+	int rcpu, i, fallback = -1;
+
+	rcpu = schedtune_reserved_cpu(p);
+	if (rcpu >= 0) {
+		if (rcpu != cpu && schedtune_prefer_idle(p) && !idle_cpu(cpu) &&
+		    cpu_active(rcpu) && idle_cpu(rcpu) &&
+		    cpumask_test_cpu(rcpu, tsk_cpus_allowed(p)))
+			return rcpu;
+		return cpu;
+	}
+
+	if (!schedtune_cpu_reserved(cpu, p))
+		return cpu;
+
+	for_each_cpu_and(i, cpu_coregroup_mask(cpu), tsk_cpus_allowed(p)) {
+		if (i == cpu || !cpu_active(i))
+			continue;
+		if (idle_cpu(i))
+			return i;
+		if (fallback < 0)
+			fallback = i;
+	}
+
+	return fallback >= 0 ? fallback : cpu;
+}
+
+/*
+ * A task close to its frame deadline should not queue behind others, it
+ * is moved to an idle cpu of the cluster placement picked if there is one.
+ */
+static int schedtune_frame_fixup(struct task_struct *p, int cpu)
+{
+	int i;
+
+	if (!schedtune_task_frame_urgent(p) || idle_cpu(cpu))
+		return cpu;
+
+	for_each_cpu_and(i, cpu_coregroup_mask(cpu), tsk_cpus_allowed(p)) {
+		if (i == cpu || !cpu_active(i))
+			continue;
+		if (idle_cpu(i) && !schedtune_cpu_reserved(i, p))
+			return i;
+	}
+
+	return cpu;
+}
+
+static int
+select_task_rq_fair(struct task_struct *p, int prev_cpu, int sd_flag, int wake_flags)
+{
+	int new_cpu = __select_task_rq_fair(p, prev_cpu, sd_flag, wake_flags);
+
+	new_cpu = schedtune_reserve_fixup(p, new_cpu);
+
+	return schedtune_frame_fixup(p, new_cpu);
+}
+
 /*
  * Called immediately before a task is migrated to a new cpu; task_cpu(p) and
  * cfs_rq_of(p) references at time of call are still valid and identify the
@@ -7567,6 +7640,10 @@ int can_migrate_task(struct task_struct *p, struct lb_env *env)
 	if (throttled_lb_pair(task_group(p), env->src_cpu, env->dst_cpu))
 		return 0;
 
+	/* Keep tasks of other boost groups off a SchedTune reserved cpu */
+	if (schedtune_cpu_reserved(env->dst_cpu, p))
+		return 0;
+
 	if (!cpumask_test_cpu(env->dst_cpu, tsk_cpus_allowed(p))) {
 		int cpu;
 
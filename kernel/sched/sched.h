@@ -593,6 +593,12 @@ extern struct root_domain def_root_domain;
  * (such as the load balancing or the thread migration code), lock
  * acquire operations must be ordered by ascending &runqueue.
  */
+#define SCHED_LAT_NR_BUCKETS	16
+
+/* sched_statistics.xcache_migration */
+#define SCHED_XCACHE_MIGRATED	0x1
+#define SCHED_XCACHE_HOT	0x2
+
 struct rq {
 	/* runqueue lock: */
 	raw_spinlock_t lock;
@@ -682,6 +688,11 @@ struct rq {
 	u64 max_idle_balance_cost;
 #endif
 
+#ifdef CONFIG_SCHED_WALT_PREDICT
+	/* sum of pred_demand of the tasks runnable on this cpu */
+	u64 cum_pred_demand;
+#endif
+
 #ifdef CONFIG_IRQ_TIME_ACCOUNTING
 	u64 prev_irq_time;
 #endif
@@ -720,6 +731,13 @@ struct rq {
 	/* try_to_wake_up() stats */
 	unsigned int ttwu_count;
 	unsigned int ttwu_local;
+
+	/* queue to run latency, bucket n counts [2^(n-1), 2^n) usecs */
+	unsigned int rq_lat_hist[SCHED_LAT_NR_BUCKETS];
+
+	/* migrations in from cpus not sharing our cache, and cache hot ones */
+	unsigned int nr_xcache_migrations;
+	unsigned int nr_xcache_hot_migrations;
 #endif
 
 #ifdef CONFIG_SMP
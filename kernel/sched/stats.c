@@ -45,6 +45,7 @@ static int show_schedstat(struct seq_file *seq, void *v)
 		seq_printf(seq, "timestamp %lu\n", jiffies);
 	} else {
 		struct rq *rq;
+		int i;
 #ifdef CONFIG_SMP
 		struct sched_domain *sd;
 		int dcount = 0;
@@ -63,6 +64,13 @@ static int show_schedstat(struct seq_file *seq, void *v)
 
 		seq_printf(seq, "\n");
 
+		/* queue to run latency histogram and cross-cache migrations */
+		seq_printf(seq, "lat");
+		for (i = 0; i < SCHED_LAT_NR_BUCKETS; i++)
+			seq_printf(seq, " %u", rq->rq_lat_hist[i]);
+		seq_printf(seq, " xmig %u %u\n", rq->nr_xcache_migrations,
+			   rq->nr_xcache_hot_migrations);
+
 #ifdef CONFIG_SMP
 #ifdef DEFAULT_USE_ENERGY_AWARE
 		show_easstat(seq, &rq->eas_stats);
@@ -10,6 +10,8 @@ rq_sched_info_arrive(struct rq *rq, unsigned long long delta)
 	if (rq) {
 		rq->rq_sched_info.run_delay += delta;
 		rq->rq_sched_info.pcount++;
+		rq->rq_lat_hist[min_t(int, fls64(delta >> 10),
+				      SCHED_LAT_NR_BUCKETS - 1)]++;
 	}
 }
 
@@ -29,6 +31,23 @@ rq_sched_info_dequeued(struct rq *rq, unsigned long long delta)
 	if (rq)
 		rq->rq_sched_info.run_delay += delta;
 }
+
+/*
+ * Count a cross-cache migration noted by set_task_cpu(), now that the
+ * new rq's lock is held.
+ */
+static inline void
+rq_sched_xcache_account(struct rq *rq, struct task_struct *p)
+{
+	u8 mig = p->se.statistics.xcache_migration;
+
+	if (unlikely(mig)) {
+		rq->nr_xcache_migrations++;
+		if (mig & SCHED_XCACHE_HOT)
+			rq->nr_xcache_hot_migrations++;
+		p->se.statistics.xcache_migration = 0;
+	}
+}
 # define schedstat_inc(rq, field)	do { (rq)->field++; } while (0)
 # define schedstat_add(rq, field, amt)	do { (rq)->field += (amt); } while (0)
 # define schedstat_set(var, val)	do { var = (val); } while (0)
@@ -42,6 +61,9 @@ rq_sched_info_dequeued(struct rq *rq, unsigned long long delta)
 static inline void
 rq_sched_info_depart(struct rq *rq, unsigned long long delta)
 {}
+static inline void
+rq_sched_xcache_account(struct rq *rq, struct task_struct *p)
+{}
 # define schedstat_inc(rq, field)	do { } while (0)
 # define schedstat_add(rq, field, amt)	do { } while (0)
 # define schedstat_set(var, val)	do { } while (0)
@@ -27,6 +27,18 @@ struct schedtune {
 	/* Boost value for tasks on that SchedTune CGroup */
 	int boost;
 
+	/* Hint to bias scheduling of tasks on that SchedTune CGroup
+	 * towards idle CPUs */
+	int prefer_idle;
+
+	/* CPU kept free of tasks from other groups while this group has
+	 * RUNNABLE tasks, -1 if none */
+	int reserve_cpu;
+
+#ifdef CONFIG_SCHED_FRAME_DEADLINE
+	/* Boost value for the CPU of a task close to its frame deadline */
+	int frame_boost;
+#endif
 };
 
 static inline struct schedtune *css_st(struct cgroup_subsys_state *css)
@@ -56,6 +68,8 @@ static inline struct schedtune *parent_st(struct schedtune *st)
 static struct schedtune
 root_schedtune = {
 	.boost	= 0,
+	.prefer_idle = 0,
+	.reserve_cpu = -1,
 };
 
 /*
@@ -94,11 +108,32 @@ struct boost_groups {
 		/* Count of RUNNABLE tasks on that boost group */
 		unsigned tasks;
 	} group[BOOSTGROUPS_COUNT];
+#ifdef CONFIG_SCHED_FRAME_DEADLINE
+	/* Count of RUNNABLE tasks with a frame deadline */
+	unsigned frame_tasks;
+	/* Earliest frame deadline and highest frame boost among them */
+	u64 frame_deadline;
+	unsigned frame_boost;
+#endif
 };
 
 /* Boost groups affecting each CPU in the system */
 DEFINE_PER_CPU(struct boost_groups, cpu_boost_groups);
 
+/*
+ * CPU reservation
+ * At most one boost group can hold a reserved CPU. While that group has
+ * RUNNABLE tasks anywhere in the system, tasks from other groups are
+ * kept off the reserved CPU at wakeup and load balance time, so a
+ * latency sensitive task waking up finds it idle.
+ */
+static int reserve_idx = -1;
+static int reserve_cpu = -1;
+static DEFINE_SPINLOCK(reserve_lock);
+
+/* Count of RUNNABLE tasks on each boost group, across all CPUs */
+static atomic_t boostgroup_tasks[BOOSTGROUPS_COUNT];
+
 static void
 schedtune_cpu_update(int cpu)
 {
@@ -167,6 +202,7 @@ schedtune_tasks_update(struct task_struct *p, int cpu, int idx, int task_count)
 	int tasks;
 
 	bg = &per_cpu(cpu_boost_groups, cpu);
+	tasks = bg->group[idx].tasks;
 
 	/* Update boosted tasks count while avoiding to make it negative */
 	if (task_count < 0 && bg->group[idx].tasks <= -task_count)
@@ -174,12 +210,116 @@ schedtune_tasks_update(struct task_struct *p, int cpu, int idx, int task_count)
 	else
 		bg->group[idx].tasks += task_count;
 
+	atomic_add((int)bg->group[idx].tasks - tasks, &boostgroup_tasks[idx]);
+
 	/* Boost group activation or deactivation on that RQ */
 	tasks = bg->group[idx].tasks;
 	if (tasks == 1 || tasks == 0)
 		schedtune_cpu_update(cpu);
 }
 
+#ifdef CONFIG_SCHED_FRAME_DEADLINE
+/*
+ * A frame deadline makes its task urgent from FRAME_DEADLINE_WINDOW_NS
+ * before it until as long after, so a late frame still gets the boost
+ * but a forgotten deadline does not keep it forever.
+ */
+#define FRAME_DEADLINE_WINDOW_NS	(4 * NSEC_PER_MSEC)
+
+static inline bool frame_deadline_near(u64 deadline, u64 now)
+{
+	return deadline && deadline <= now + FRAME_DEADLINE_WINDOW_NS &&
+		now <= deadline + FRAME_DEADLINE_WINDOW_NS;
+}
+
+static void schedtune_frame_enqueue(struct task_struct *p, int cpu)
+{
+	struct boost_groups *bg = &per_cpu(cpu_boost_groups, cpu);
+	u64 deadline = READ_ONCE(p->frame_deadline);
+	struct schedtune *st;
+	int frame_boost;
+
+	if (!deadline || p->frame_queued)
+		return;
+
+	rcu_read_lock();
+	st = task_schedtune(p);
+	frame_boost = st->frame_boost;
+	rcu_read_unlock();
+
+	p->frame_queued = true;
+
+	/*
+	 * The earliest deadline is not recomputed when its task leaves, so
+	 * one already past its window is replaced by the new deadline.
+	 */
+	if (!bg->frame_tasks++ || deadline < bg->frame_deadline ||
+	    bg->frame_deadline + FRAME_DEADLINE_WINDOW_NS < local_clock())
+		WRITE_ONCE(bg->frame_deadline, deadline);
+
+	if (bg->frame_tasks == 1 || frame_boost > bg->frame_boost)
+		WRITE_ONCE(bg->frame_boost, frame_boost);
+}
+
+static void schedtune_frame_dequeue(struct task_struct *p, int cpu)
+{
+	struct boost_groups *bg = &per_cpu(cpu_boost_groups, cpu);
+
+	if (!p->frame_queued)
+		return;
+
+	p->frame_queued = false;
+	if (bg->frame_tasks && !--bg->frame_tasks) {
+		WRITE_ONCE(bg->frame_deadline, 0);
+		WRITE_ONCE(bg->frame_boost, 0);
+	}
+}
+
+/*
+ * Returns the frame boost of @cpu while one of its RUNNABLE tasks is
+ * close to its frame deadline, 0 otherwise.
+ */
+int schedtune_cpu_frame_boost(int cpu)
+{
+	struct boost_groups *bg = &per_cpu(cpu_boost_groups, cpu);
+
+	if (!frame_deadline_near(READ_ONCE(bg->frame_deadline), local_clock()))
+		return 0;
+
+	return READ_ONCE(bg->frame_boost);
+}
+
+bool schedtune_task_frame_urgent(struct task_struct *p)
+{
+	return frame_deadline_near(READ_ONCE(p->frame_deadline), local_clock());
+}
+
+static u64
+frame_boost_read(struct cgroup_subsys_state *css, struct cftype *cft)
+{
+	struct schedtune *st = css_st(css);
+
+	return st->frame_boost;
+}
+
+static int
+frame_boost_write(struct cgroup_subsys_state *css, struct cftype *cft,
+	    u64 frame_boost)
+{
+	struct schedtune *st = css_st(css);
+
+	if (frame_boost > 100)
+		return -EINVAL;
+
+	st->frame_boost = frame_boost;
+
+	return 0;
+}
+#else
+static inline void schedtune_frame_enqueue(struct task_struct *p, int cpu) { }
+static inline void schedtune_frame_dequeue(struct task_struct *p, int cpu) { }
+#endif /* CONFIG_SCHED_FRAME_DEADLINE */
+
 /*
  * NOTE: This function must be called while holding the lock on the CPU RQ
  */
@@ -197,6 +337,8 @@ void schedtune_enqueue_task(struct task_struct *p, int cpu)
 	if (p->flags & PF_EXITING)
 		return;
 
+	schedtune_frame_enqueue(p, cpu);
+
 	/* Get task boost group */
 	rcu_read_lock();
 	st = task_schedtune(p);
@@ -220,7 +362,11 @@ void schedtune_dequeue_task(struct task_struct *p, int cpu)
 	 * Thus we avoid any further update, since we do not want to change
 	 * CPU boosting while the task is exiting.
 	 * The last dequeue will be done by cgroup exit() callback.
+	 * Frame accounting does not depend on the boost group, so it is
+	 * always released here.
 	 */
+	schedtune_frame_dequeue(p, cpu);
+
 	if (p->flags & PF_EXITING)
 		return;
 
@@ -278,6 +424,124 @@ int schedtune_task_boost(struct task_struct *p)
 	return task_boost;
 }
 
+int schedtune_prefer_idle(struct task_struct *p)
+{
+	struct schedtune *st;
+	int prefer_idle;
+
+	/* Get prefer_idle value */
+	rcu_read_lock();
+	st = task_schedtune(p);
+	prefer_idle = st->prefer_idle;
+	rcu_read_unlock();
+
+	return prefer_idle;
+}
+
+/*
+ * Returns the CPU reserved for the boost group of @p, or -1 if that group
+ * does not hold the reservation.
+ */
+int schedtune_reserved_cpu(struct task_struct *p)
+{
+	struct schedtune *st;
+	int cpu = -1;
+
+	if (READ_ONCE(reserve_idx) < 0)
+		return -1;
+
+	rcu_read_lock();
+	st = task_schedtune(p);
+	if (st->idx == READ_ONCE(reserve_idx))
+		cpu = READ_ONCE(reserve_cpu);
+	rcu_read_unlock();
+
+	return cpu;
+}
+
+/*
+ * Returns true if @cpu is currently reserved for a boost group with
+ * RUNNABLE tasks other than the one of @p.
+ */
+bool schedtune_cpu_reserved(int cpu, struct task_struct *p)
+{
+	struct schedtune *st;
+	int idx = READ_ONCE(reserve_idx);
+	bool reserved;
+
+	if (idx < 0 || READ_ONCE(reserve_cpu) != cpu)
+		return false;
+
+	if (!atomic_read(&boostgroup_tasks[idx]))
+		return false;
+
+	rcu_read_lock();
+	st = task_schedtune(p);
+	reserved = st->idx != idx;
+	rcu_read_unlock();
+
+	return reserved;
+}
+
+static u64
+prefer_idle_read(struct cgroup_subsys_state *css, struct cftype *cft)
+{
+	struct schedtune *st = css_st(css);
+
+	return st->prefer_idle;
+}
+
+static int
+prefer_idle_write(struct cgroup_subsys_state *css, struct cftype *cft,
+	    u64 prefer_idle)
+{
+	struct schedtune *st = css_st(css);
+
+	st->prefer_idle = !!prefer_idle;
+
+	return 0;
+}
+
+static s64
+reserve_cpu_read(struct cgroup_subsys_state *css, struct cftype *cft)
+{
+	struct schedtune *st = css_st(css);
+
+	return st->reserve_cpu;
+}
+
+static int
+reserve_cpu_write(struct cgroup_subsys_state *css, struct cftype *cft,
+	    s64 cpu)
+{
+	struct schedtune *st = css_st(css);
+	int ret = 0;
+
+	if (cpu < -1 || cpu >= nr_cpu_ids)
+		return -EINVAL;
+
+	spin_lock(&reserve_lock);
+
+	if (cpu >= 0) {
+		/* Only one boost group at a time can hold a CPU */
+		if (reserve_idx >= 0 && reserve_idx != st->idx) {
+			ret = -EBUSY;
+			goto out;
+		}
+		WRITE_ONCE(reserve_cpu, cpu);
+		WRITE_ONCE(reserve_idx, st->idx);
+	} else if (reserve_idx == st->idx) {
+		WRITE_ONCE(reserve_idx, -1);
+		WRITE_ONCE(reserve_cpu, -1);
+	}
+	st->reserve_cpu = cpu;
+
+out:
+	spin_unlock(&reserve_lock);
+
+	return ret;
+}
+
 static u64
 boost_read(struct cgroup_subsys_state *css, struct cftype *cft)
 {
@@ -311,6 +575,23 @@ static struct cftype files[] = {
 		.read_u64 = boost_read,
 		.write_u64 = boost_write,
 	},
+	{
+		.name = "prefer_idle",
+		.read_u64 = prefer_idle_read,
+		.write_u64 = prefer_idle_write,
+	},
+	{
+		.name = "reserve_cpu",
+		.read_s64 = reserve_cpu_read,
+		.write_s64 = reserve_cpu_write,
+	},
+#ifdef CONFIG_SCHED_FRAME_DEADLINE
+	{
+		.name = "frame_boost",
+		.read_u64 = frame_boost_read,
+		.write_u64 = frame_boost_write,
+	},
+#endif
 	{ }	/* terminate */
 };
 
@@ -329,6 +610,7 @@ schedtune_boostgroup_init(struct schedtune *st)
 		bg->group[st->idx].boost = 0;
 		bg->group[st->idx].tasks = 0;
 	}
+	atomic_set(&boostgroup_tasks[st->idx], 0);
 
 	return 0;
 }
@@ -383,6 +665,7 @@ schedtune_css_alloc(struct cgroup_subsys_state *parent_css)
 
 	/* Initialize per CPUs boost group support */
 	st->idx = idx;
+	st->reserve_cpu = -1;
 	if (schedtune_boostgroup_init(st))
 		goto release;
 
@@ -400,6 +683,9 @@ schedtune_boostgroup_release(struct schedtune *st)
 	/* Reset this boost group */
 	schedtune_boostgroup_update(st->idx, 0);
 
+	/* Drop a CPU reservation held by this boost group */
+	reserve_cpu_write(&st->css, NULL, -1);
+
 	/* Keep track of allocated boost groups */
 	allocated_group[st->idx] = NULL;
 }
@@ -53,22 +53,39 @@ int schedtune_cpu_boost(int cpu);
 int schedtune_task_boost(struct task_struct *tsk);
 
 int schedtune_prefer_idle(struct task_struct *tsk);
+int schedtune_reserved_cpu(struct task_struct *tsk);
+bool schedtune_cpu_reserved(int cpu, struct task_struct *tsk);
 
 void schedtune_exit_task(struct task_struct *tsk);
 
 void schedtune_enqueue_task(struct task_struct *p, int cpu);
 void schedtune_dequeue_task(struct task_struct *p, int cpu);
 
+#ifdef CONFIG_SCHED_FRAME_DEADLINE
+int schedtune_cpu_frame_boost(int cpu);
+bool schedtune_task_frame_urgent(struct task_struct *tsk);
+#else
+#define schedtune_cpu_frame_boost(cpu) 0
+#define schedtune_task_frame_urgent(tsk) false
+#endif
+
 #else /* CONFIG_CGROUP_SCHEDTUNE */
 
 #define schedtune_cpu_boost(cpu)  get_sysctl_sched_cfs_boost()
 #define schedtune_task_boost(tsk) get_sysctl_sched_cfs_boost()
 
+#define schedtune_prefer_idle(tsk) 0
+#define schedtune_reserved_cpu(tsk) (-1)
+#define schedtune_cpu_reserved(cpu, tsk) false
+
 #define schedtune_exit_task(task) do { } while (0)
 
 #define schedtune_enqueue_task(task, cpu) do { } while (0)
 #define schedtune_dequeue_task(task, cpu) do { } while (0)
 
+#define schedtune_cpu_frame_boost(cpu) 0
+#define schedtune_task_frame_urgent(tsk) false
+
 #endif /* CONFIG_CGROUP_SCHEDTUNE */
 
 int schedtune_normalize_energy(int energy);
@@ -80,11 +97,18 @@ int schedtune_accept_deltas(int nrg_delta, int cap_delta,
 #define schedtune_cpu_boost(cpu)  0
 #define schedtune_task_boost(tsk) 0
 
+#define schedtune_prefer_idle(tsk) 0
+#define schedtune_reserved_cpu(tsk) (-1)
+#define schedtune_cpu_reserved(cpu, tsk) false
+
 #define schedtune_exit_task(task) do { } while (0)
 
 #define schedtune_enqueue_task(task, cpu) do { } while (0)
 #define schedtune_dequeue_task(task, cpu) do { } while (0)
 
+#define schedtune_cpu_frame_boost(cpu) 0
+#define schedtune_task_frame_urgent(tsk) false
+
 #define schedtune_accept_deltas(nrg_delta, cap_delta, task) nrg_delta
 
 #endif /* CONFIG_SCHED_TUNE */
@@ -69,11 +69,93 @@ static inline void fixup_cum_window_demand(struct rq *rq, s64 delta)
 		rq->cum_window_demand = 0;
 }
 
+#ifdef CONFIG_SCHED_WALT_PREDICT
+/*
+ * Predictive demand. Every window a task completes bumps the bucket its
+ * (frequency invariant) runtime fell into and decays the others, so the
+ * histogram remembers which demand levels the task keeps coming back to.
+ * Windows with no activity are not recorded, which is what lets a UI
+ * thread that idled between frames still be predicted at its frame cost
+ * on the first window after it wakes up.
+ */
+#define WALT_PRED_BUCKET_INC	8
+
+static inline int pred_bucket(u32 runtime)
+{
+	int idx = div64_u64((u64)runtime * WALT_PRED_BUCKETS, walt_ravg_window);
+
+	return min(idx, WALT_PRED_BUCKETS - 1);
+}
+
+static void update_pred_buckets(struct task_struct *p, u32 runtime)
+{
+	u8 *bucket = p->pred.bucket;
+	int i, idx = pred_bucket(runtime);
+
+	for (i = 0; i < WALT_PRED_BUCKETS; i++) {
+		if (i == idx)
+			bucket[i] = min(bucket[i] + WALT_PRED_BUCKET_INC, U8_MAX);
+		else if (bucket[i])
+			bucket[i]--;
+	}
+}
+
+/*
+ * Pick the most popular bucket at or above the one 'runtime' falls into
+ * and predict its lower edge, never less than 'runtime' itself.
+ */
+static u32 get_pred_demand(struct task_struct *p, u32 runtime)
+{
+	u8 *bucket = p->pred.bucket;
+	int i, first = pred_bucket(runtime), best = first;
+	u32 pred;
+
+	for (i = first + 1; i < WALT_PRED_BUCKETS; i++)
+		if (bucket[i] > bucket[best])
+			best = i;
+
+	if (best == first)
+		return runtime;
+
+	pred = div64_u64((u64)best * walt_ravg_window, WALT_PRED_BUCKETS);
+	return max(pred, runtime);
+}
+
+static inline void walt_inc_pred_demand(struct rq *rq, struct task_struct *p)
+{
+	rq->cum_pred_demand += p->pred.pred_demand;
+}
+
+static inline void walt_dec_pred_demand(struct rq *rq, struct task_struct *p)
+{
+	rq->cum_pred_demand -= p->pred.pred_demand;
+	if (unlikely((s64)rq->cum_pred_demand < 0))
+		rq->cum_pred_demand = 0;
+}
+
+unsigned long walt_cpu_pred_util(int cpu)
+{
+	u64 pred;
+
+	if (walt_disabled)
+		return 0;
+
+	pred = READ_ONCE(cpu_rq(cpu)->cum_pred_demand);
+	pred = div64_u64(pred << SCHED_CAPACITY_SHIFT, walt_ravg_window);
+
+	return min_t(u64, pred, capacity_orig_of(cpu));
+}
+#else
+static inline void walt_inc_pred_demand(struct rq *rq, struct task_struct *p) { }
+static inline void walt_dec_pred_demand(struct rq *rq, struct task_struct *p) { }
+#endif /* CONFIG_SCHED_WALT_PREDICT */
+
 void
 walt_inc_cumulative_runnable_avg(struct rq *rq,
 				 struct task_struct *p)
 {
 	rq->cumulative_runnable_avg += p->ravg.demand;
+	walt_inc_pred_demand(rq, p);
 
 	/*
 	 * Add a task's contribution to the cumulative window demand when
@@ -92,6 +174,7 @@ walt_dec_cumulative_runnable_avg(struct rq *rq,
 {
 	rq->cumulative_runnable_avg -= p->ravg.demand;
 	BUG_ON((s64)rq->cumulative_runnable_avg < 0);
+	walt_dec_pred_demand(rq, p);
 
 	/*
 	 * on_rq will be 1 for sleeping tasks. So check if the task
@@ -566,6 +649,9 @@ static void update_history(struct rq *rq, struct task_struct *p,
 	u32 *hist = &p->ravg.sum_history[0];
 	int ridx, widx;
 	u32 max = 0, avg, demand;
+#ifdef CONFIG_SCHED_WALT_PREDICT
+	u32 pred_demand;
+#endif
 	u64 sum = 0;
 
 	/* Ignore windows where task had no activity */
@@ -615,14 +701,27 @@ static void update_history(struct rq *rq, struct task_struct *p,
 	 * average. So add the task demand separately to cumulative window
 	 * demand.
 	 */
+#ifdef CONFIG_SCHED_WALT_PREDICT
+	update_pred_buckets(p, runtime);
+	pred_demand = max(get_pred_demand(p, runtime), demand);
+#endif
+
 	if (!task_has_dl_policy(p) || !p->dl.dl_throttled) {
-		if (task_on_rq_queued(p))
+		if (task_on_rq_queued(p)) {
 			fixup_cumulative_runnable_avg(rq, p, demand);
-		else if (rq->curr == p)
+#ifdef CONFIG_SCHED_WALT_PREDICT
+			walt_dec_pred_demand(rq, p);
+			rq->cum_pred_demand += pred_demand;
+#endif
+		} else if (rq->curr == p) {
 			fixup_cum_window_demand(rq, demand);
+		}
 	}
 
 	p->ravg.demand = demand;
+#ifdef CONFIG_SCHED_WALT_PREDICT
+	p->pred.pred_demand = pred_demand;
+#endif
 
 done:
 	trace_walt_update_history(rq, p, runtime, samples, event);
@@ -897,4 +996,8 @@ void walt_init_new_task_load(struct task_struct *p)
 	p->ravg.demand = init_load_windows;
 	for (i = 0; i < RAVG_HIST_SIZE_MAX; ++i)
 		p->ravg.sum_history[i] = init_load_windows;
+#ifdef CONFIG_SCHED_WALT_PREDICT
+	memset(&p->pred, 0, sizeof(struct walt_pred));
+	p->pred.pred_demand = init_load_windows;
+#endif
 }
@@ -37,6 +37,12 @@ void walt_account_irqtime(int cpu, struct task_struct *curr, u64 delta,
 u64 walt_irqload(int cpu);
 int walt_cpu_high_irqload(int cpu);
 
+#ifdef CONFIG_SCHED_WALT_PREDICT
+unsigned long walt_cpu_pred_util(int cpu);
+#else
+static inline unsigned long walt_cpu_pred_util(int cpu) { return 0; }
+#endif
+
 #else /* CONFIG_SCHED_WALT */
 
 static inline void walt_update_task_ravg(struct task_struct *p, struct rq *rq,
@@ -56,6 +62,7 @@ static inline void walt_init_cpu_efficiency(void) { }
 static inline u64 walt_ktime_clock(void) { return 0; }
 
 #define walt_cpu_high_irqload(cpu) false
+static inline unsigned long walt_cpu_pred_util(int cpu) { return 0; }
 
 #endif /* CONFIG_SCHED_WALT */
 
@@ -1374,6 +1374,11 @@ static void __hrtimer_run_queues(struct hrtimer_cpu_base *cpu_base, ktime_t now)
 			if (basenow.tv64 < hrtimer_get_softexpires_tv64(timer))
 				break;
 
+#ifdef CONFIG_HIGH_RES_TIMERS
+			/* inside its range: this wakeup saved one of its own */
+			if (basenow.tv64 < hrtimer_get_expires_tv64(timer))
+				cpu_base->nr_coalesced++;
+#endif
 			__run_hrtimer(cpu_base, base, timer, &basenow);
 		}
 	}
@@ -271,6 +271,16 @@ static bool tick_check_preferred(struct clock_event_device *curdev,
 			return false;
 	}
 
+	/*
+	 * Between equally rated CPU local devices take the one that keeps
+	 * running in deep idle, so the CPU never needs the broadcast device
+	 * and tick_broadcast_lock on idle entry and exit.
+	 */
+	if (curdev && newdev->rating == curdev->rating &&
+	    cpumask_equal(curdev->cpumask, newdev->cpumask))
+		return (curdev->features & CLOCK_EVT_FEAT_C3STOP) &&
+		       !(newdev->features & CLOCK_EVT_FEAT_C3STOP);
+
 	/*
 	 * Use the higher rated one, but prefer a CPU local device with a lower
 	 * rating than a non-CPU local device
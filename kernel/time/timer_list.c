@@ -168,6 +168,7 @@ static void print_cpu(struct seq_file *m, int cpu, u64 now)
 	P(nr_retries);
 	P(nr_hangs);
 	P(max_hang_time);
+	P(nr_coalesced);
 #endif
 #undef P
 #undef P_ns
@@ -0,0 +1,205 @@
+/*
+ * Latency triggered trace snapshots
+ *
+ * Tracing runs in overwrite mode as a flight recorder. When a wakeup of
+ * a top-app task or a binder reply takes longer than its threshold, the
+ * live buffer is swapped into the snapshot buffer, which can then be
+ * read from "snapshot" while tracing carries on.
+ *
+ * A trigger disarms itself so that the next one does not swap the
+ * captured trace back out. Writing 1 to latency_snapshot/armed arms it
+ * again.
+ */
+#include <linux/fs.h>
+#include <linux/sched.h>
+#include <linux/seq_file.h>
+#include <linux/tracefs.h>
+#include <linux/trace_lat_snapshot.h>
+#include <trace/events/sched.h>
+
+#include "trace.h"
+#include "../sched/tune.h"
+
+u64 lat_snapshot_thresh_us[LAT_SNAPSHOT_MAX] __read_mostly;
+
+static atomic_t lat_snapshot_armed;
+static unsigned long lat_snapshot_count;
+static DEFINE_MUTEX(lat_snapshot_mutex);
+static bool lat_snapshot_probes;
+
+static struct {
+	enum lat_snapshot_type type;
+	u64 delta_us;
+	pid_t pid;
+	char comm[TASK_COMM_LEN];
+} lat_snapshot_last;
+
+static const char * const lat_snapshot_names[LAT_SNAPSHOT_MAX] = {
+	[LAT_SNAPSHOT_WAKEUP]	= "wakeup",
+	[LAT_SNAPSHOT_BINDER]	= "binder",
+};
+
+void __lat_snapshot_trigger(enum lat_snapshot_type type, u64 delta_us,
+			    struct task_struct *p)
+{
+	if (!atomic_xchg(&lat_snapshot_armed, 0))
+		return;
+
+	lat_snapshot_last.type = type;
+	lat_snapshot_last.delta_us = delta_us;
+	lat_snapshot_last.pid = p->pid;
+	memcpy(lat_snapshot_last.comm, p->comm, TASK_COMM_LEN);
+	lat_snapshot_count++;
+
+	tracing_snapshot();
+}
+EXPORT_SYMBOL_GPL(__lat_snapshot_trigger);
+
+static void probe_lat_snapshot_wakeup(void *ignore, struct task_struct *p)
+{
+	if (schedtune_prefer_idle(p))
+		p->lat_snapshot_wakeup = local_clock();
+}
+
+static void probe_lat_snapshot_switch(void *ignore, bool preempt,
+				      struct task_struct *prev,
+				      struct task_struct *next)
+{
+	u64 stamp = next->lat_snapshot_wakeup;
+
+	if (!stamp)
+		return;
+
+	next->lat_snapshot_wakeup = 0;
+	lat_snapshot_check(LAT_SNAPSHOT_WAKEUP,
+			   div_u64(local_clock() - stamp, NSEC_PER_USEC), next);
+}
+
+/* Only hook the scheduler while a wakeup threshold is set */
+static void lat_snapshot_update_probes(void)
+{
+	bool want = lat_snapshot_thresh_us[LAT_SNAPSHOT_WAKEUP] != 0;
+
+	if (want == lat_snapshot_probes)
+		return;
+
+	if (want) {
+		if (register_trace_sched_wakeup(probe_lat_snapshot_wakeup, NULL))
+			return;
+		if (register_trace_sched_wakeup_new(probe_lat_snapshot_wakeup,
+						    NULL))
+			goto fail_wakeup_new;
+		if (register_trace_sched_switch(probe_lat_snapshot_switch, NULL))
+			goto fail_switch;
+	} else {
+		unregister_trace_sched_switch(probe_lat_snapshot_switch, NULL);
+		unregister_trace_sched_wakeup_new(probe_lat_snapshot_wakeup,
+						  NULL);
+		unregister_trace_sched_wakeup(probe_lat_snapshot_wakeup, NULL);
+	}
+	lat_snapshot_probes = want;
+	return;
+
+fail_switch:
+	unregister_trace_sched_wakeup_new(probe_lat_snapshot_wakeup, NULL);
+fail_wakeup_new:
+	unregister_trace_sched_wakeup(probe_lat_snapshot_wakeup, NULL);
+	pr_warn("latency snapshot: unable to hook sched events\n");
+}
+
+static int lat_snapshot_thresh_get(void *data, u64 *val)
+{
+	*val = *(u64 *)data;
+	return 0;
+}
+
+static int lat_snapshot_thresh_set(void *data, u64 val)
+{
+	mutex_lock(&lat_snapshot_mutex);
+	WRITE_ONCE(*(u64 *)data, val);
+	lat_snapshot_update_probes();
+	mutex_unlock(&lat_snapshot_mutex);
+
+	return 0;
+}
+
+DEFINE_SIMPLE_ATTRIBUTE(lat_snapshot_thresh_fops, lat_snapshot_thresh_get,
+			lat_snapshot_thresh_set, "%llu\n");
+
+static int lat_snapshot_armed_get(void *data, u64 *val)
+{
+	*val = atomic_read(&lat_snapshot_armed);
+	return 0;
+}
+
+static int lat_snapshot_armed_set(void *data, u64 val)
+{
+	int ret;
+
+	if (!val) {
+		atomic_set(&lat_snapshot_armed, 0);
+		return 0;
+	}
+
+	/* Triggers run in atomic context and cannot allocate */
+	ret = tracing_alloc_snapshot();
+	if (ret < 0)
+		return ret;
+
+	atomic_set(&lat_snapshot_armed, 1);
+	return 0;
+}
+
+DEFINE_SIMPLE_ATTRIBUTE(lat_snapshot_armed_fops, lat_snapshot_armed_get,
+			lat_snapshot_armed_set, "%llu\n");
+
+static int lat_snapshot_last_show(struct seq_file *m, void *v)
+{
+	seq_printf(m, "count: %lu\n", lat_snapshot_count);
+	if (lat_snapshot_count)
+		seq_printf(m, "last: %s %llu us %s-%d\n",
+			   lat_snapshot_names[lat_snapshot_last.type],
+			   lat_snapshot_last.delta_us,
+			   lat_snapshot_last.comm, lat_snapshot_last.pid);
+	return 0;
+}
+
+static int lat_snapshot_last_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, lat_snapshot_last_show, NULL);
+}
+
+static const struct file_operations lat_snapshot_last_fops = {
+	.open		= lat_snapshot_last_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static __init int lat_snapshot_init(void)
+{
+	struct dentry *d_tracer, *dir;
+
+	d_tracer = tracing_init_dentry();
+	if (IS_ERR(d_tracer))
+		return 0;
+
+	dir = tracefs_create_dir("latency_snapshot", d_tracer);
+	if (!dir) {
+		pr_warn("Could not create tracefs 'latency_snapshot' directory\n");
+		return 0;
+	}
+
+	trace_create_file("wakeup_thresh_us", 0644, dir,
+			  &lat_snapshot_thresh_us[LAT_SNAPSHOT_WAKEUP],
+			  &lat_snapshot_thresh_fops);
+	trace_create_file("binder_thresh_us", 0644, dir,
+			  &lat_snapshot_thresh_us[LAT_SNAPSHOT_BINDER],
+			  &lat_snapshot_thresh_fops);
+	trace_create_file("armed", 0644, dir, NULL, &lat_snapshot_armed_fops);
+	trace_create_file("last", 0444, dir, NULL, &lat_snapshot_last_fops);
+
+	return 0;
+}
+
+device_initcall(lat_snapshot_init);
@@ -3814,6 +3814,9 @@ void hci_send_acl(struct hci_chan *chan, struct sk_buff *skb, __u16 flags)
 
 	BT_DBG("%s chan %p flags 0x%4.4x", hdev->name, chan, flags);
 
+	/* Queue time, replaced by the send time in hci_send_frame() */
+	skb->tstamp = ktime_get();
+
 	hci_queue_acl(chan, &chan->data_q, skb, flags);
 
 	queue_work(hdev->workqueue, &hdev->tx_work);
@@ -4073,6 +4076,24 @@ static void __check_timeout(struct hci_dev *hdev, unsigned int cnt)
 	}
 }
 
+/* Account how long a queued ACL frame waited for the scheduler */
+static void hci_conn_tx_sched_stat(struct hci_conn *conn, struct sk_buff *skb)
+{
+	s64 lat;
+
+	if (!skb->tstamp.tv64)
+		return;
+
+	lat = ktime_us_delta(ktime_get(), skb->tstamp);
+	if (lat < 0)
+		return;
+
+	conn->tx_sched_pkts++;
+	conn->tx_sched_lat_total += lat;
+	if (lat > conn->tx_sched_lat_max)
+		conn->tx_sched_lat_max = lat;
+}
+
 static void hci_sched_acl_pkt(struct hci_dev *hdev)
 {
 	unsigned int cnt = hdev->acl_cnt;
@@ -4098,6 +4119,7 @@ static void hci_sched_acl_pkt(struct hci_dev *hdev)
 			hci_conn_enter_active_mode(chan->conn,
 						   bt_cb(skb)->force_active);
 
+			hci_conn_tx_sched_stat(chan->conn, skb);
 			hci_send_frame(hdev, skb);
 			hdev->acl_last_tx = jiffies;
 
@@ -4269,6 +4291,7 @@ static void hci_sched_le(struct hci_dev *hdev)
 
 			skb = skb_dequeue(&chan->data_q);
 
+			hci_conn_tx_sched_stat(chan->conn, skb);
 			hci_send_frame(hdev, skb);
 			hdev->le_last_tx = jiffies;
 
@@ -114,6 +114,40 @@ static const struct file_operations features_fops = {
 	.release	= single_release,
 };
 
+static int tx_sched_latency_show(struct seq_file *f, void *ptr)
+{
+	struct hci_dev *hdev = f->private;
+	struct hci_conn *conn;
+
+	hci_dev_lock(hdev);
+	list_for_each_entry(conn, &hdev->conn_hash.list, list) {
+		if (conn->type != ACL_LINK && conn->type != LE_LINK)
+			continue;
+
+		seq_printf(f, "%4.4x %pMR %u %llu %u\n", conn->handle,
+			   &conn->dst, conn->tx_sched_pkts,
+			   conn->tx_sched_pkts ?
+			   div_u64(conn->tx_sched_lat_total,
+				   conn->tx_sched_pkts) : 0,
+			   conn->tx_sched_lat_max);
+	}
+	hci_dev_unlock(hdev);
+
+	return 0;
+}
+
+static int tx_sched_latency_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, tx_sched_latency_show, inode->i_private);
+}
+
+static const struct file_operations tx_sched_latency_fops = {
+	.open		= tx_sched_latency_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
 static int device_id_show(struct seq_file *f, void *ptr)
 {
 	struct hci_dev *hdev = f->private;
@@ -370,6 +404,9 @@ void hci_debugfs_create_common(struct hci_dev *hdev)
 	debugfs_create_file("remote_oob", 0400, hdev->debugfs, hdev,
 			    &remote_oob_fops);
 
+	debugfs_create_file("tx_sched_latency", 0444, hdev->debugfs, hdev,
+			    &tx_sched_latency_fops);
+
 	debugfs_create_file("conn_info_min_age", 0644, hdev->debugfs, hdev,
 			    &conn_info_min_age_fops);
 	debugfs_create_file("conn_info_max_age", 0644, hdev->debugfs, hdev,
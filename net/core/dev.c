@@ -138,6 +138,7 @@
 #include <linux/errqueue.h>
 #include <linux/hrtimer.h>
 #include <linux/netfilter_ingress.h>
+#include <linux/fb.h>
 
 #include "net-sysfs.h"
 
@@ -4776,6 +4777,55 @@ void napi_complete_done(struct napi_struct *n, int work_done)
 }
 EXPORT_SYMBOL(napi_complete_done);
 
+#ifdef CONFIG_NET_RX_BUSY_POLL
+/* CPUs sk_busy_loop() may spin on, see net.core.busy_poll_cpus */
+struct cpumask net_busy_poll_cpumask __read_mostly;
+EXPORT_SYMBOL(net_busy_poll_cpumask);
+
+bool net_busy_poll_screen_off __read_mostly;
+EXPORT_SYMBOL(net_busy_poll_screen_off);
+
+#if IS_BUILTIN(CONFIG_FB)
+static int busy_poll_fb_notifier(struct notifier_block *nb,
+				 unsigned long val, void *data)
+{
+	struct fb_event *evdata = data;
+	int blank;
+
+	if (val != FB_EVENT_BLANK)
+		return NOTIFY_OK;
+
+	/* only the primary display (LCD) counts */
+	if (evdata->info->node)
+		return NOTIFY_OK;
+
+	blank = *(int *)evdata->data;
+	if (blank == FB_BLANK_POWERDOWN)
+		WRITE_ONCE(net_busy_poll_screen_off, true);
+	else if (blank == FB_BLANK_UNBLANK)
+		WRITE_ONCE(net_busy_poll_screen_off, false);
+
+	return NOTIFY_OK;
+}
+
+static struct notifier_block busy_poll_fb_block = {
+	.notifier_call = busy_poll_fb_notifier,
+};
+#endif
+
+static void __init busy_poll_init(void)
+{
+	cpumask_copy(&net_busy_poll_cpumask, cpu_possible_mask);
+#if IS_BUILTIN(CONFIG_FB)
+	fb_register_client(&busy_poll_fb_block);
+#endif
+}
+#else
+static inline void busy_poll_init(void)
+{
+}
+#endif /* CONFIG_NET_RX_BUSY_POLL */
+
 /* must be called under rcu_read_lock(), as we dont take a reference */
 struct napi_struct *napi_by_id(unsigned int napi_id)
 {
@@ -7934,6 +7984,7 @@ static int __init net_dev_init(void)
 
 	hotcpu_notifier(dev_cpu_callback, 0);
 	dst_subsys_init();
+	busy_poll_init();
 	rc = 0;
 out:
 	return rc;
@@ -19,6 +19,12 @@
 
 #include <linux/module.h>
 
+#include "mptcp_pacing.h"
+
+static unsigned int pacing_ratio __read_mostly;
+module_param(pacing_ratio, uint, 0644);
+MODULE_PARM_DESC(pacing_ratio, "pace each subflow at this percent of its cwnd rate (0: off, needs the fq qdisc)");
+
 /* The variable 'rate' (i.e., x_r) will be scaled
  * e.g., from B/s to KB/s, MB/s, or GB/s
  * if max_rate > 2^rate_scale_limit
@@ -194,6 +200,8 @@ static void mptcp_balia_cong_avoid(struct sock *sk, u32 ack, u32 acked)
 		return;
 	}
 
+	mptcp_ccc_update_pacing(sk, pacing_ratio);
+
 	if (!tcp_is_cwnd_limited(sk))
 		return;
 
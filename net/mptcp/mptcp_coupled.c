@@ -31,6 +31,12 @@
 
 #include <linux/module.h>
 
+#include "mptcp_pacing.h"
+
+static unsigned int pacing_ratio __read_mostly;
+module_param(pacing_ratio, uint, 0644);
+MODULE_PARM_DESC(pacing_ratio, "pace each subflow at this percent of its cwnd rate (0: off, needs the fq qdisc)");
+
 /* Scaling is done in the numerator with alpha_scale_num and in the denominator
  * with alpha_scale_den.
  *
@@ -191,6 +197,8 @@ static void mptcp_ccc_cong_avoid(struct sock *sk, u32 ack, u32 acked)
 		return;
 	}
 
+	mptcp_ccc_update_pacing(sk, pacing_ratio);
+
 	if (!tcp_is_cwnd_limited(sk))
 		return;
 
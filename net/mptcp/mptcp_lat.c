@@ -0,0 +1,298 @@
+/*
+ *	MPTCP Scheduler for latency-aware aggregation.
+ *
+ *	This scheduler sends on the subflow with the lowest expected delay,
+ *	the smoothed RTT plus the time needed to drain what is already queued
+ *	on the subflow. The preferred subflow is cached at the meta-level and
+ *	is only re-evaluated when its RTT or cwnd changes, when a subflow comes
+ *	or goes, or after one RTT. A full scan is only done when the preferred
+ *	subflow cannot take the segment.
+ *
+ *	This program is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU General Public License
+ *      as published by the Free Software Foundation; either version
+ *      2 of the License, or (at your option) any later version.
+ */
+
+#include <linux/module.h>
+#include <net/mptcp.h>
+
+/* Struct to store the data of the control block */
+struct latsched_cb_data {
+	/* The subflow with the lowest expected delay or NULL */
+	struct tcp_sock *preferred;
+	/* State of the preferred subflow when it was chosen */
+	u32 srtt_us;
+	u32 snd_cwnd;
+	u32 stamp;
+};
+
+static struct latsched_cb_data *latsched_get_cb_data(const struct tcp_sock *tp)
+{
+	return (struct latsched_cb_data *)&tp->mpcb->mptcp_sched[0];
+}
+
+/* Expected delay of a new segment on tp, in the srtt_us scale */
+static u64 latsched_delay(const struct tcp_sock *tp)
+{
+	u32 queued = tp->write_seq - tp->snd_una;
+	u32 wnd = max(tp->snd_cwnd, 1U) * max(tp->mss_cache, 1U);
+
+	return tp->srtt_us + div_u64((u64)tp->srtt_us * queued, wnd);
+}
+
+/* Has the skb already been enqueued into this subsocket? */
+static bool latsched_dont_reinject_skb(const struct tcp_sock *tp,
+				       const struct sk_buff *skb)
+{
+	return skb &&
+		mptcp_pi_to_flag(tp->mptcp->path_index) & TCP_SKB_CB(skb)->path_mask;
+}
+
+static bool latsched_cache_valid(const struct latsched_cb_data *cb_data)
+{
+	const struct tcp_sock *tp = cb_data->preferred;
+
+	if (!tp)
+		return false;
+
+	/* srtt_us moves on every ACK, only a change of 1/8 counts */
+	return abs((int)(tp->srtt_us - cb_data->srtt_us)) <=
+			(cb_data->srtt_us >> 3) &&
+	       tp->snd_cwnd == cb_data->snd_cwnd &&
+	       tcp_time_stamp - cb_data->stamp <
+			usecs_to_jiffies(tp->srtt_us >> 3) + 1;
+}
+
+/* Scan the subflows of the given priority for the lowest expected delay.
+ * Subflows that already carried the skb are only taken if no other is
+ * available.
+ */
+static struct sock *latsched_scan(struct mptcp_cb *mpcb, struct sk_buff *skb,
+				  bool (*selector)(const struct tcp_sock *),
+				  bool zero_wnd_test, struct sock **usedsk)
+{
+	struct sock *sk, *bestsk = NULL;
+	u64 best = U64_MAX, used = U64_MAX;
+
+	mptcp_for_each_sk(mpcb, sk) {
+		struct tcp_sock *tp = tcp_sk(sk);
+		u64 delay;
+
+		if (!(*selector)(tp))
+			continue;
+
+		if (!mptcp_is_available(sk, skb, zero_wnd_test))
+			continue;
+
+		delay = latsched_delay(tp);
+		if (latsched_dont_reinject_skb(tp, skb)) {
+			if (delay < used) {
+				used = delay;
+				*usedsk = sk;
+			}
+			continue;
+		}
+
+		if (delay < best) {
+			best = delay;
+			bestsk = sk;
+		}
+	}
+
+	return bestsk;
+}
+
+/* Pick the preferred subflow among the active ones, without looking at
+ * whether it has room right now.
+ */
+static void latsched_update_preferred(struct mptcp_cb *mpcb,
+				      struct latsched_cb_data *cb_data)
+{
+	struct tcp_sock *tp, *besttp = NULL;
+	u64 best = U64_MAX;
+
+	mptcp_for_each_tp(mpcb, tp) {
+		u64 delay;
+
+		if (!subflow_is_active(tp) ||
+		    mptcp_is_def_unavailable((struct sock *)tp))
+			continue;
+
+		delay = latsched_delay(tp);
+		if (delay < best) {
+			best = delay;
+			besttp = tp;
+		}
+	}
+
+	cb_data->preferred = besttp;
+	if (besttp) {
+		cb_data->srtt_us = besttp->srtt_us;
+		cb_data->snd_cwnd = besttp->snd_cwnd;
+		cb_data->stamp = tcp_time_stamp;
+	}
+}
+
+static struct sock *latsched_get_subflow(struct sock *meta_sk,
+					 struct sk_buff *skb,
+					 bool zero_wnd_test)
+{
+	struct tcp_sock *meta_tp = tcp_sk(meta_sk);
+	struct mptcp_cb *mpcb = meta_tp->mpcb;
+	struct latsched_cb_data *cb_data = latsched_get_cb_data(meta_tp);
+	struct sock *sk, *usedsk = NULL;
+
+	/* if there is only one subflow, bypass the scheduling function */
+	if (mpcb->cnt_subflows == 1) {
+		sk = (struct sock *)mpcb->connection_list;
+		if (!mptcp_is_available(sk, skb, zero_wnd_test))
+			sk = NULL;
+		return sk;
+	}
+
+	/* Answer data_fin on same subflow!!! */
+	if (meta_sk->sk_shutdown & RCV_SHUTDOWN &&
+	    skb && mptcp_is_data_fin(skb)) {
+		mptcp_for_each_sk(mpcb, sk) {
+			if (tcp_sk(sk)->mptcp->path_index == mpcb->dfin_path_index &&
+			    mptcp_is_available(sk, skb, zero_wnd_test))
+				return sk;
+		}
+	}
+
+	if (!latsched_cache_valid(cb_data))
+		latsched_update_preferred(mpcb, cb_data);
+
+	/* Fast path, the preferred subflow has room for the segment */
+	sk = (struct sock *)cb_data->preferred;
+	if (sk && !latsched_dont_reinject_skb(tcp_sk(sk), skb) &&
+	    mptcp_is_available(sk, skb, zero_wnd_test))
+		return sk;
+
+	sk = latsched_scan(mpcb, skb, &subflow_is_active, zero_wnd_test,
+			   &usedsk);
+	if (sk)
+		return sk;
+
+	sk = latsched_scan(mpcb, skb, &subflow_is_backup, zero_wnd_test,
+			   &usedsk);
+	if (sk)
+		return sk;
+
+	/* It has been sent on all available subflows once - give it a
+	 * chance again by restarting its pathmask.
+	 */
+	if (usedsk && skb)
+		TCP_SKB_CB(skb)->path_mask = 0;
+
+	return usedsk;
+}
+
+static struct sk_buff *latsched_next_segment(struct sock *meta_sk,
+					     int *reinject,
+					     struct sock **subsk,
+					     unsigned int *limit)
+{
+	const struct mptcp_cb *mpcb = tcp_sk(meta_sk)->mpcb;
+	struct sk_buff *skb;
+	struct tcp_sock *subtp;
+	unsigned int mss_now;
+	u32 max_segs, window;
+
+	/* As we set it, we have to reset it as well. */
+	*limit = 0;
+	*reinject = 0;
+
+	/* If we are in fallback-mode, just take from the meta-send-queue */
+	if (mpcb->infinite_mapping_snd || mpcb->send_infinite_mapping) {
+		skb = tcp_send_head(meta_sk);
+	} else {
+		skb = skb_peek(&mpcb->reinject_queue);
+		if (skb)
+			*reinject = 1;
+		else
+			skb = tcp_send_head(meta_sk);
+	}
+
+	if (!skb)
+		return NULL;
+
+	*subsk = latsched_get_subflow(meta_sk, skb, false);
+	if (!*subsk)
+		return NULL;
+
+	subtp = tcp_sk(*subsk);
+	mss_now = tcp_current_mss(*subsk);
+
+	if (!*reinject && unlikely(!tcp_snd_wnd_test(tcp_sk(meta_sk), skb, mss_now)))
+		return NULL;
+
+	/* No splitting required, as we will only send one single segment */
+	if (skb->len <= mss_now)
+		return skb;
+
+	/* Limit according to the cwnd/gso-size and then to the subflow's
+	 * window, as the default scheduler does.
+	 */
+	max_segs = min_t(unsigned int, tcp_cwnd_test(subtp, skb),
+			 max_t(u16, (*subsk)->sk_gso_max_segs, 1));
+	if (!max_segs)
+		return NULL;
+
+	window = tcp_wnd_end(subtp) - subtp->write_seq;
+	if (mss_now * max_segs <= skb->len)
+		*limit = mss_now * max_segs;
+	else
+		*limit = min(skb->len, window);
+
+	return skb;
+}
+
+static void latsched_init(struct sock *sk)
+{
+	struct latsched_cb_data *cb_data = latsched_get_cb_data(tcp_sk(sk));
+
+	/* A new subflow may be better than the cached one */
+	cb_data->preferred = NULL;
+}
+
+static void latsched_release(struct sock *sk)
+{
+	struct tcp_sock *tp = tcp_sk(sk);
+	struct latsched_cb_data *cb_data = latsched_get_cb_data(tp);
+
+	if (cb_data->preferred == tp)
+		cb_data->preferred = NULL;
+}
+
+static struct mptcp_sched_ops mptcp_sched_lat = {
+	.get_subflow = latsched_get_subflow,
+	.next_segment = latsched_next_segment,
+	.init = latsched_init,
+	.release = latsched_release,
+	.name = "latency",
+	.owner = THIS_MODULE,
+};
+
+static int __init latsched_register(void)
+{
+	BUILD_BUG_ON(sizeof(struct latsched_cb_data) > MPTCP_SCHED_DATA_SIZE);
+
+	if (mptcp_register_scheduler(&mptcp_sched_lat))
+		return -1;
+
+	return 0;
+}
+
+static void latsched_unregister(void)
+{
+	mptcp_unregister_scheduler(&mptcp_sched_lat);
+}
+
+module_init(latsched_register);
+module_exit(latsched_unregister);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("LATENCY-AWARE MPTCP");
+MODULE_VERSION("0.90");
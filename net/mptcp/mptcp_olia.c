@@ -24,6 +24,12 @@
 
 #include <linux/module.h>
 
+#include "mptcp_pacing.h"
+
+static unsigned int pacing_ratio __read_mostly;
+module_param(pacing_ratio, uint, 0644);
+MODULE_PARM_DESC(pacing_ratio, "pace each subflow at this percent of its cwnd rate (0: off, needs the fq qdisc)");
+
 static int scale = 10;
 
 struct mptcp_olia {
@@ -233,6 +239,8 @@ static void mptcp_olia_cong_avoid(struct sock *sk, u32 ack, u32 acked)
 		return;
 	}
 
+	mptcp_ccc_update_pacing(sk, pacing_ratio);
+
 	ca->mptcp_loss3 = tp->snd_una;
 
 	if (!tcp_is_cwnd_limited(sk))
@@ -0,0 +1,43 @@
+/*
+ *	MPTCP implementation - Pacing of the coupled congestion controllers
+ *
+ *	The coupled controllers set the cwnd of each subflow from the state
+ *	of all of them. Pacing a subflow at the rate of that window spreads
+ *	its segments over the RTT instead of sending them in bursts, which
+ *	keeps the queue of a subflow with a deep bottleneck buffer short.
+ *
+ *	The rate is enforced by the fq packet scheduler.
+ *
+ *	This program is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU General Public License
+ *      as published by the Free Software Foundation; either version
+ *      2 of the License, or (at your option) any later version.
+ */
+#ifndef _MPTCP_PACING_H
+#define _MPTCP_PACING_H
+
+#include <net/tcp.h>
+
+/* Set the pacing rate of the subflow to ratio percent of cwnd * mss / srtt,
+ * twice that in slow start so that the window can still grow.
+ */
+static inline void mptcp_ccc_update_pacing(struct sock *sk, unsigned int ratio)
+{
+	const struct tcp_sock *tp = tcp_sk(sk);
+	u64 rate;
+
+	if (!ratio || !tp->srtt_us)
+		return;
+
+	rate = (u64)tp->mss_cache * USEC_PER_SEC * 8 * ratio / 100;
+	if (tp->snd_cwnd < tp->snd_ssthresh / 2)
+		rate *= 2;
+	rate *= max(tp->snd_cwnd, tp->packets_out);
+
+	/* srtt_us is scaled by 8 */
+	do_div(rate, tp->srtt_us);
+
+	sk->sk_pacing_rate = min_t(u64, rate, sk->sk_max_pacing_rate);
+}
+
+#endif /* _MPTCP_PACING_H */
@@ -2338,7 +2338,13 @@ ring_is_full:
 	po->stats.stats1.tp_drops++;
 	spin_unlock(&sk->sk_receive_queue.lock);
 
-	sk->sk_data_ready(sk);
+	/* With TPACKET_V3 the ring is only full when every block has been
+	 * closed and handed to user space, and prb_close_block() already
+	 * woke the reader for each of them. Waking it again for every packet
+	 * dropped while it drains the ring only adds to the overload.
+	 */
+	if (po->tp_version <= TPACKET_V2)
+		sk->sk_data_ready(sk);
 	kfree_skb(copy_skb);
 	goto drop_n_restore;
 }
@@ -24,6 +24,7 @@
 #include <net/netlink.h>
 #include <net/pkt_sched.h>
 #include <net/codel.h>
+#include <net/inet_sock.h>
 
 /*	Fair Queue CoDel.
  *
@@ -39,6 +40,11 @@
  * head drops only.
  * ECN capability is on by default.
  * Low memory footprint (64 bytes per flow)
+ *
+ * With uid_fair, locally generated packets are queued by the uid of their
+ * socket instead of their 5-tuple, so that each app gets one flow's share
+ * and a bulk upload cannot crowd out an interactive app. Packets without
+ * a socket (forwarded traffic) still use the 5-tuple hash.
  */
 
 struct fq_codel_flow {
@@ -61,15 +67,31 @@ struct fq_codel_sched_data {
 	struct codel_stats cstats;
 	u32		drop_overlimit;
 	u32		new_flow_count;
+	bool		uid_fair;	/* queue local traffic by socket uid */
+	u32		uid_classified;
 
 	struct list_head new_flows;	/* list of new flows */
 	struct list_head old_flows;	/* list of old flows */
 };
 
-static unsigned int fq_codel_hash(const struct fq_codel_sched_data *q,
+static unsigned int fq_codel_hash(struct fq_codel_sched_data *q,
 				  struct sk_buff *skb)
 {
-	u32 hash = skb_get_hash_perturb(skb, &q->perturbation);
+	u32 hash;
+
+	if (q->uid_fair) {
+		const struct sock *sk = skb_to_full_sk(skb);
+
+		if (sk && sk_fullsock(sk)) {
+			q->uid_classified++;
+			hash = siphash_1u32(from_kuid_munged(&init_user_ns,
+							     sk->sk_uid),
+					    &q->perturbation);
+			return reciprocal_scale(hash, q->flows_cnt);
+		}
+	}
+
+	hash = skb_get_hash_perturb(skb, &q->perturbation);
 
 	return reciprocal_scale(hash, q->flows_cnt);
 }
@@ -323,6 +345,7 @@ static const struct nla_policy fq_codel_policy[TCA_FQ_CODEL_MAX + 1] = {
 	[TCA_FQ_CODEL_FLOWS]	= { .type = NLA_U32 },
 	[TCA_FQ_CODEL_QUANTUM]	= { .type = NLA_U32 },
 	[TCA_FQ_CODEL_CE_THRESHOLD] = { .type = NLA_U32 },
+	[TCA_FQ_CODEL_UID_FAIR]	= { .type = NLA_U32 },
 };
 
 static int fq_codel_change(struct Qdisc *sch, struct nlattr *opt)
@@ -371,6 +394,9 @@ static int fq_codel_change(struct Qdisc *sch, struct nlattr *opt)
 	if (tb[TCA_FQ_CODEL_ECN])
 		q->cparams.ecn = !!nla_get_u32(tb[TCA_FQ_CODEL_ECN]);
 
+	if (tb[TCA_FQ_CODEL_UID_FAIR])
+		q->uid_fair = !!nla_get_u32(tb[TCA_FQ_CODEL_UID_FAIR]);
+
 	if (tb[TCA_FQ_CODEL_QUANTUM])
 		q->quantum = max(256U, nla_get_u32(tb[TCA_FQ_CODEL_QUANTUM]));
 
@@ -485,6 +511,9 @@ static int fq_codel_dump(struct Qdisc *sch, struct sk_buff *skb)
 			codel_time_to_us(q->cparams.ce_threshold)))
 		goto nla_put_failure;
 
+	if (nla_put_u32(skb, TCA_FQ_CODEL_UID_FAIR, q->uid_fair))
+		goto nla_put_failure;
+
 	return nla_nest_end(skb, opts);
 
 nla_put_failure:
@@ -504,6 +533,7 @@ static int fq_codel_dump_stats(struct Qdisc *sch, struct gnet_dump *d)
 	st.qdisc_stats.ecn_mark = q->cstats.ecn_mark;
 	st.qdisc_stats.new_flow_count = q->new_flow_count;
 	st.qdisc_stats.ce_mark = q->cstats.ce_mark;
+	st.qdisc_stats.uid_classified = q->uid_classified;
 
 	list_for_each(pos, &q->new_flows)
 		st.qdisc_stats.new_flows_len++;
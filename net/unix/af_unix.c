@@ -439,6 +439,12 @@ static int unix_dgram_peer_wake_me(struct sock *sk, struct sock *other)
 
 	connected = unix_dgram_peer_wake_connect(sk, other);
 
+	/* pairs with the barrier before waitqueue_active() in
+	 * unix_dgram_recvmsg(), the waker must see us queued or we must
+	 * see the freed queue slot.
+	 */
+	smp_mb();
+
 	if (unix_recvq_full(other))
 		return 1;
 
@@ -1696,13 +1702,14 @@ static int unix_dgram_sendmsg(struct socket *sock, struct msghdr *msg,
 	if (len > sk->sk_sndbuf - 32)
 		goto out;
 
-	if (len > SKB_MAX_ALLOC) {
+	/* Anything that does not fit a single page head goes in page
+	 * frags, so large datagrams do not need a high-order linear buffer.
+	 */
+	if (len > SKB_MAX_HEAD(0)) {
 		data_len = min_t(size_t,
-				 len - SKB_MAX_ALLOC,
+				 len - SKB_MAX_HEAD(0),
 				 MAX_SKB_FRAGS * PAGE_SIZE);
-		data_len = PAGE_ALIGN(data_len);
-
-		BUILD_BUG_ON(SKB_MAX_ALLOC < PAGE_SIZE);
+		data_len = min_t(size_t, len, PAGE_ALIGN(data_len));
 	}
 
 	skb = sock_alloc_send_pskb(sk, len - data_len, data_len,
@@ -2155,8 +2162,17 @@ static int unix_dgram_recvmsg(struct socket *sock, struct msghdr *msg,
 		goto out_unlock;
 	}
 
-	wake_up_interruptible_sync_poll(&u->peer_wait,
-					POLLOUT | POLLWRNORM | POLLWRBAND);
+	/* Most receives find nobody waiting for queue space, so skip
+	 * taking the wait queue lock then. The barrier orders the dequeue
+	 * above against the check; waiters queue themselves before looking
+	 * at the receive queue (prepare_to_wait_exclusive() or the barrier
+	 * in unix_dgram_peer_wake_me()).
+	 */
+	smp_mb();
+	if (waitqueue_active(&u->peer_wait))
+		wake_up_interruptible_sync_poll(&u->peer_wait,
+						POLLOUT | POLLWRNORM |
+						POLLWRBAND);
 
 	if (msg->msg_name)
 		unix_copy_addr(msg, skb->sk);
@@ -110,7 +110,12 @@ static struct allowedips_node *find_node(struct allowedips_node *trie, u8 bits,
 {
 	struct allowedips_node *node = trie, *found = NULL;
 
-	while (node && prefix_matches(node, key, bits)) {
+	while (node) {
+		/* Start loading both children while this node is compared. */
+		prefetch(rcu_access_pointer(node->bit[0]));
+		prefetch(rcu_access_pointer(node->bit[1]));
+		if (!prefix_matches(node, key, bits))
+			break;
 		if (rcu_access_pointer(node->peer))
 			found = node;
 		if (node->cidr == bits)
@@ -373,7 +378,10 @@ struct wg_peer *wg_allowedips_lookup_src(struct allowedips *table,
 
 int __init wg_allowedips_slab_init(void)
 {
-	node_cache = KMEM_CACHE(allowedips_node, 0);
+	/* Each node starts on its own cache line, so that the members used
+	 * by find_node() are fetched with a single miss.
+	 */
+	node_cache = KMEM_CACHE(allowedips_node, SLAB_HWCACHE_ALIGN);
 	return node_cache ? 0 : -ENOMEM;
 }
 
@@ -12,6 +12,7 @@
 
 struct wg_peer;
 
+/* Allocated cache line aligned, see wg_allowedips_slab_init(). */
 struct allowedips_node {
 	struct wg_peer __rcu *peer;
 	struct allowedips_node __rcu *bit[2];
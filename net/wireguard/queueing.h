@@ -212,6 +212,7 @@ static inline void wg_queue_enqueue_per_peer_rx(struct sk_buff *skb, enum packet
 
 #ifdef DEBUG
 bool wg_packet_counter_selftest(void);
+bool wg_packet_throughput_selftest(void);
 #endif
 
 #endif /* _WG_QUEUEING_H */
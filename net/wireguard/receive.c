@@ -18,19 +18,25 @@
 #include <net/ip_tunnels.h>
 
 /* Must be called with bh disabled. */
-static void update_rx_stats(struct wg_peer *peer, size_t len)
+static void __update_rx_stats(struct wg_peer *peer, unsigned int packets,
+			      size_t len)
 {
 	struct pcpu_sw_netstats *tstats =
 		get_cpu_ptr(peer->device->dev->tstats);
 
 	u64_stats_update_begin(&tstats->syncp);
-	++tstats->rx_packets;
+	tstats->rx_packets += packets;
 	tstats->rx_bytes += len;
 	peer->rx_bytes += len;
 	u64_stats_update_end(&tstats->syncp);
 	put_cpu_ptr(tstats);
 }
 
+static void update_rx_stats(struct wg_peer *peer, size_t len)
+{
+	__update_rx_stats(peer, 1, len);
+}
+
 #define SKB_TYPE_LE32(skb) (((struct message_header *)(skb)->data)->type)
 
 static size_t validate_header_len(struct sk_buff *skb)
@@ -342,9 +348,12 @@ out:
 
 #include "selftest/counter.c"
 
-static void wg_packet_consume_data_done(struct wg_peer *peer,
-					struct sk_buff *skb,
-					struct endpoint *endpoint)
+/* Returns the length to account in the rx stats, which the poll loop adds up
+ * for the whole batch.
+ */
+static size_t wg_packet_consume_data_done(struct wg_peer *peer,
+					  struct sk_buff *skb,
+					  struct endpoint *endpoint)
 {
 	struct net_device *dev = peer->device->dev;
 	unsigned int len, len_before_trim;
@@ -365,11 +374,11 @@ static void wg_packet_consume_data_done(struct wg_peer *peer,
 
 	/* A packet with length 0 is a keepalive packet */
 	if (unlikely(!skb->len)) {
-		update_rx_stats(peer, message_data_len(0));
 		net_dbg_ratelimited("%s: Receiving keepalive packet from peer %llu (%pISpfsc)\n",
 				    dev->name, peer->internal_id,
 				    &peer->endpoint.addr);
-		goto packet_processed;
+		dev_kfree_skb(skb);
+		return message_data_len(0);
 	}
 
 	wg_timers_data_received(peer);
@@ -421,8 +430,7 @@ static void wg_packet_consume_data_done(struct wg_peer *peer,
 		goto dishonest_packet_peer;
 
 	napi_gro_receive(&peer->napi, skb);
-	update_rx_stats(peer, message_data_len(len_before_trim));
-	return;
+	return message_data_len(len_before_trim);
 
 dishonest_packet_peer:
 	net_dbg_skb_ratelimited("%s: Packet has unallowed src IP (%pISc) from peer %llu (%pISpfsc)\n",
@@ -445,6 +453,7 @@ dishonest_packet_size:
 	goto packet_processed;
 packet_processed:
 	dev_kfree_skb(skb);
+	return 0;
 }
 
 int wg_packet_rx_poll(struct napi_struct *napi, int budget)
@@ -455,6 +464,8 @@ int wg_packet_rx_poll(struct napi_struct *napi, int budget)
 	enum packet_state state;
 	struct sk_buff *skb;
 	int work_done = 0;
+	unsigned int rx_packets = 0;
+	size_t rx_len, rx_bytes = 0;
 	bool free;
 
 	if (unlikely(budget <= 0))
@@ -483,7 +494,11 @@ int wg_packet_rx_poll(struct napi_struct *napi, int budget)
 			goto next;
 
 		wg_reset_packet(skb, false);
-		wg_packet_consume_data_done(peer, skb, &endpoint);
+		rx_len = wg_packet_consume_data_done(peer, skb, &endpoint);
+		if (rx_len) {
+			++rx_packets;
+			rx_bytes += rx_len;
+		}
 		free = false;
 
 next:
@@ -496,6 +511,9 @@ next:
 			break;
 	}
 
+	if (rx_packets)
+		__update_rx_stats(peer, rx_packets, rx_bytes);
+
 	if (work_done < budget)
 		napi_complete_done(napi, work_done);
 
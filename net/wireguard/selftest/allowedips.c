@@ -12,7 +12,9 @@
  * randomized tests done against a trivial implementation, which may take
  * upwards of a half-hour to complete. There's no set of users who should be
  * enabling these, and the only developers that should go anywhere near these
- * nobs are the ones who are reading this comment.
+ * nobs are the ones who are reading this comment. Defining DEBUG_BENCH_TRIE
+ * to be 1 reports the lookup cost of a table the size of a large split
+ * tunnel configuration.
  */
 
 #ifdef DEBUG
@@ -422,6 +424,81 @@ free_locked:
 	return ret;
 }
 
+enum {
+	NUM_BENCH_ROUTES = 4096,
+	NUM_BENCH_QUERIES = 1 << 20
+};
+
+static __init bool bench_test(void)
+{
+	struct wg_peer *peers[16] = { 0 };
+	unsigned int i, found = 0;
+	u64 start, v4_ns, v6_ns;
+	DEFINE_MUTEX(mutex);
+	struct allowedips t;
+	bool ret = false;
+	u8 ip[16];
+
+	mutex_init(&mutex);
+	wg_allowedips_init(&t);
+
+	for (i = 0; i < ARRAY_SIZE(peers); ++i) {
+		peers[i] = kzalloc(sizeof(*peers[i]), GFP_KERNEL);
+		if (unlikely(!peers[i])) {
+			pr_err("allowedips bench self-test malloc: FAIL\n");
+			goto free;
+		}
+		kref_init(&peers[i]->refcount);
+		INIT_LIST_HEAD(&peers[i]->allowedips_list);
+	}
+
+	mutex_lock(&mutex);
+	for (i = 0; i < NUM_BENCH_ROUTES; ++i) {
+		struct wg_peer *peer = peers[i % ARRAY_SIZE(peers)];
+
+		prandom_bytes(ip, 16);
+		if (wg_allowedips_insert_v4(&t, (struct in_addr *)ip,
+					    prandom_u32_max(17) + 8, peer,
+					    &mutex) < 0 ||
+		    wg_allowedips_insert_v6(&t, (struct in6_addr *)ip,
+					    prandom_u32_max(97) + 16, peer,
+					    &mutex) < 0) {
+			pr_err("allowedips bench self-test malloc: FAIL\n");
+			mutex_unlock(&mutex);
+			goto free;
+		}
+	}
+	mutex_unlock(&mutex);
+
+	start = ktime_get_ns();
+	for (i = 0; i < NUM_BENCH_QUERIES; ++i) {
+		prandom_bytes(ip, 4);
+		found += !!lookup(t.root4, 32, ip);
+	}
+	v4_ns = ktime_get_ns() - start;
+
+	start = ktime_get_ns();
+	for (i = 0; i < NUM_BENCH_QUERIES; ++i) {
+		prandom_bytes(ip, 16);
+		found += !!lookup(t.root6, 128, ip);
+	}
+	v6_ns = ktime_get_ns() - start;
+
+	/* The random query generation is included in the cost. */
+	pr_info("allowedips bench self-test: %u routes, v4 %llu ns/lookup, v6 %llu ns/lookup, %u hits\n",
+		NUM_BENCH_ROUTES, div_u64(v4_ns, NUM_BENCH_QUERIES),
+		div_u64(v6_ns, NUM_BENCH_QUERIES), found);
+	ret = true;
+
+free:
+	mutex_lock(&mutex);
+	wg_allowedips_free(&t, &mutex);
+	mutex_unlock(&mutex);
+	for (i = 0; i < ARRAY_SIZE(peers); ++i)
+		kfree(peers[i]);
+	return ret;
+}
+
 static __init inline struct in_addr *ip4(u8 a, u8 b, u8 c, u8 d)
 {
 	static struct in_addr ip;
@@ -649,6 +726,9 @@ bool __init wg_allowedips_selftest(void)
 	if (IS_ENABLED(DEBUG_RANDOM_TRIE) && success)
 		success = randomized_test();
 
+	if (IS_ENABLED(DEBUG_BENCH_TRIE) && success)
+		success = bench_test();
+
 	if (success)
 		pr_info("allowedips self-tests: pass\n");
 
@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Copyright (C) 2015-2019 Jason A. Donenfeld <Jason@zx2c4.com>. All Rights Reserved.
+ */
+
+#ifdef DEBUG
+/* Not a correctness test, the zinc self-tests cover that. This reports the
+ * throughput of the transport data cipher with the implementation selected
+ * for this CPU, so that a missing SIMD path shows up in the log.
+ */
+static u64 __init throughput_mbps(size_t len, u64 packets, u64 ns)
+{
+	return div64_u64((u64)len * 8 * packets * 1000, max_t(u64, ns, 1));
+}
+
+bool __init wg_packet_throughput_selftest(void)
+{
+	static const size_t sizes[] = { 64, 576, 1420 };
+	const u64 duration_ns = 100 * NSEC_PER_MSEC;
+	u8 key[CHACHA20POLY1305_KEY_SIZE] = { 0 };
+	u64 start, enc_ns, dec_ns, enc_packets, dec_packets;
+	bool success = true;
+	u8 *buf;
+	size_t i;
+
+	buf = kzalloc(noise_encrypted_len(1420), GFP_KERNEL);
+	if (unlikely(!buf)) {
+		pr_err("throughput self-test malloc: FAIL\n");
+		return false;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(sizes); ++i) {
+		enc_packets = 0;
+		start = ktime_get_ns();
+		do {
+			chacha20poly1305_encrypt(buf, buf, sizes[i], NULL, 0,
+						 enc_packets++, key);
+			enc_ns = ktime_get_ns() - start;
+		} while (enc_ns < duration_ns);
+
+		/* Decrypt the last packet and encrypt it back, over and over. */
+		dec_packets = 0;
+		start = ktime_get_ns();
+		do {
+			if (!chacha20poly1305_decrypt(buf, buf,
+					noise_encrypted_len(sizes[i]), NULL, 0,
+					enc_packets - 1, key)) {
+				pr_err("throughput self-test %zu: FAIL\n",
+				       sizes[i]);
+				success = false;
+				break;
+			}
+			chacha20poly1305_encrypt(buf, buf, sizes[i], NULL, 0,
+						 enc_packets - 1, key);
+			++dec_packets;
+			dec_ns = ktime_get_ns() - start;
+		} while (dec_ns < duration_ns);
+
+		if (!success)
+			break;
+
+		pr_info("throughput self-test %zu bytes: encrypt %llu Mbps, decrypt+encrypt %llu Mbps\n",
+			sizes[i], throughput_mbps(sizes[i], enc_packets, enc_ns),
+			throughput_mbps(sizes[i], dec_packets, dec_ns));
+	}
+
+	kfree(buf);
+	return success;
+}
+#endif
@@ -245,18 +245,17 @@ void wg_packet_send_keepalive(struct wg_peer *peer)
 static void wg_packet_create_data_done(struct wg_peer *peer, struct sk_buff *first)
 {
 	struct sk_buff *skb, *next;
-	bool is_keepalive, data_sent = false;
+	bool has_data = false;
 
-	wg_timers_any_authenticated_packet_traversal(peer);
-	wg_timers_any_authenticated_packet_sent(peer);
 	skb_list_walk_safe(first, skb, next) {
-		is_keepalive = skb->len == message_data_len(0);
-		if (likely(!wg_socket_send_skb_to_peer(peer, skb,
-				PACKET_CB(skb)->ds) && !is_keepalive))
-			data_sent = true;
+		if (skb->len != message_data_len(0))
+			has_data = true;
 	}
 
-	if (likely(data_sent))
+	wg_timers_any_authenticated_packet_traversal(peer);
+	wg_timers_any_authenticated_packet_sent(peer);
+
+	if (likely(wg_socket_send_skb_list_to_peer(peer, first) && has_data))
 		wg_timers_data_sent(peer);
 
 	keep_key_fresh(peer);
@@ -418,3 +417,5 @@ out_nokey:
 	 */
 	wg_packet_send_queued_handshake_initiation(peer, false);
 }
+
+#include "selftest/throughput.c"
@@ -186,6 +186,43 @@ int wg_socket_send_skb_to_peer(struct wg_peer *peer, struct sk_buff *skb, u8 ds)
 	return ret;
 }
 
+/* Sends the encrypted segments of one packet. The endpoint is looked up once
+ * for the whole list rather than once per datagram. Returns the number of
+ * datagrams sent.
+ */
+unsigned int wg_socket_send_skb_list_to_peer(struct wg_peer *peer,
+					     struct sk_buff *first)
+{
+	struct sk_buff *skb, *next;
+	unsigned int sent = 0;
+	size_t tx_bytes = 0;
+	int ret;
+
+	read_lock_bh(&peer->endpoint_lock);
+	skb_list_walk_safe(first, skb, next) {
+		size_t skb_len = skb->len;
+
+		if (peer->endpoint.addr.sa_family == AF_INET)
+			ret = send4(peer->device, skb, &peer->endpoint,
+				    PACKET_CB(skb)->ds, &peer->endpoint_cache);
+		else if (peer->endpoint.addr.sa_family == AF_INET6)
+			ret = send6(peer->device, skb, &peer->endpoint,
+				    PACKET_CB(skb)->ds, &peer->endpoint_cache);
+		else {
+			dev_kfree_skb(skb);
+			ret = -EAFNOSUPPORT;
+		}
+		if (likely(!ret)) {
+			tx_bytes += skb_len;
+			++sent;
+		}
+	}
+	peer->tx_bytes += tx_bytes;
+	read_unlock_bh(&peer->endpoint_lock);
+
+	return sent;
+}
+
 int wg_socket_send_buffer_to_peer(struct wg_peer *peer, void *buffer,
 				  size_t len, u8 ds)
 {
@@ -314,6 +314,7 @@
 #define IOVA_DRAM_FIRMWARE		(0x80000000)
 #define IOVA_RDMA_BUFFER_BASE		(0x81000000)
 #define IOVA_RDMA_BUFFER(x)		(IOVA_RDMA_BUFFER_BASE + (SZ_1M * x))
+#define IOVA_RDMA_POSITION(x)		(IOVA_RDMA_BUFFER(x) + SZ_1M - SZ_4K)
 #define IOVA_WDMA_BUFFER_BASE		(0x82000000)
 #define IOVA_WDMA_BUFFER(x)		(IOVA_WDMA_BUFFER_BASE + (SZ_1M * x))
 #define IOVA_COMPR_BUFFER_BASE		(0x83000000)
@@ -622,6 +623,13 @@ struct abox_compr_data {
 
 	bool effect_on;
 
+	/* AP wakeups by INTR_DECODED against playing time */
+	unsigned int watermark;
+	u64 wakeups;
+	bool playing;
+	ktime_t play_start;
+	ktime_t play_time;
+
 	wait_queue_head_t flush_wait;
 	wait_queue_head_t exit_wait;
 	wait_queue_head_t ipc_wait;
@@ -684,6 +692,12 @@ struct abox_platform_data {
 	struct snd_pcm_substream *substream;
 	enum abox_platform_type type;
 	struct abox_compr_data compr_data;
+	struct ABOX_PCM_POSITION *pos_area;
+	dma_addr_t pos_addr;
+	/* stream thread moved to SCHED_DEADLINE, and its former policy */
+	struct task_struct *dl_task;
+	int dl_old_policy;
+	int dl_old_prio;
 };
 
 /**
@@ -22,10 +22,12 @@
 #include <linux/iommu.h>
 #include <linux/delay.h>
 #include <linux/memblock.h>
+#include <linux/sched.h>
 
 #include <sound/soc.h>
 #include <sound/pcm_params.h>
 #include <sound/tlv.h>
+#include <sound/hwdep.h>
 
 #include "../../../../drivers/iommu/exynos-iommu.h"
 #include <sound/samsung/abox.h>
@@ -63,6 +65,10 @@
 #define COMPR_ACK		(0x0060)
 #define COMPR_INTR_ACK		(0x0064)
 #define COMPR_INTR_DMA_ACK	(0x0068)
+#define COMPR_WATERMARK		(0x006C)
+
+/* Streams with at least this many fragments are woken by watermark only */
+#define COMPR_DEEP_FRAGMENTS	(4)
 
 /* Interrupt type */
 #define INTR_WAKEUP		(0x0)
@@ -281,6 +287,7 @@ static int abox_rdma_compr_isr_handler(void *priv)
 				data->byte_offset -= runtime->buffer_size;
 
 			snd_compr_fragment_elapsed(data->cstream);
+			data->wakeups++;
 
 			if (!data->start &&
 				runtime->state != SNDRV_PCM_STATE_PAUSED) {
@@ -428,6 +435,17 @@ static int abox_rdma_compr_set_param(struct platform_device *pdev,
 	abox_rdma_mailbox_write(dev, COMPR_PARAM_SAMPLE, data->sample_rate);
 	abox_rdma_mailbox_write(dev, COMPR_PARAM_CH, data->channels);
 	abox_rdma_mailbox_write(dev, COMPR_IP_TYPE, data->codec_id << 16);
+	/*
+	 * With a deep buffer, let the firmware drain half of it before
+	 * raising INTR_DECODED instead of interrupting every fragment.
+	 * 0 keeps the per fragment behaviour.
+	 */
+	if (runtime->fragments >= COMPR_DEEP_FRAGMENTS)
+		data->watermark = rounddown(runtime->buffer_size / 2,
+				runtime->fragment_size);
+	else
+		data->watermark = 0;
+	abox_rdma_mailbox_write(dev, COMPR_WATERMARK, data->watermark);
 	data->created = 0;
 	ret = abox_rdma_mailbox_send_cmd(dev, CMD_COMPR_SET_PARAM);
 	if (IS_ERR_VALUE(ret)) {
@@ -585,6 +603,8 @@ static int abox_rdma_compr_set_params(struct snd_compr_stream *stream,
 
 	data->byte_offset = 0;
 	data->copied_total = 0;
+	data->wakeups = 0;
+	data->play_time = ktime_set(0, 0);
 	data->channels = data->codec_param.codec.ch_in;
 	data->sample_rate = data->codec_param.codec.sample_rate;
 
@@ -648,6 +668,30 @@ static int abox_rdma_compr_set_metadata(struct snd_compr_stream *stream,
 	return 0;
 }
 
+static void abox_rdma_compr_account(struct abox_compr_data *data,
+		bool playing)
+{
+	ktime_t now = ktime_get();
+
+	if (data->playing)
+		data->play_time = ktime_add(data->play_time,
+				ktime_sub(now, data->play_start));
+	data->play_start = now;
+	data->playing = playing;
+}
+
+static u64 abox_rdma_compr_wakeups_per_min(struct abox_compr_data *data)
+{
+	s64 ms = ktime_to_ms(data->play_time);
+
+	if (data->playing)
+		ms += ktime_ms_delta(ktime_get(), data->play_start);
+	if (ms <= 0)
+		return 0;
+
+	return div64_u64(data->wakeups * MSEC_PER_SEC * 60, ms);
+}
+
 static int abox_rdma_compr_trigger(struct snd_compr_stream *stream, int cmd)
 {
 	struct snd_soc_pcm_runtime *rtd = stream->private_data;
@@ -669,6 +713,7 @@ static int abox_rdma_compr_trigger(struct snd_compr_stream *stream, int cmd)
 					ret);
 		}
 
+		abox_rdma_compr_account(data, false);
 		abox_request_dram_on(platform_data->pdev_abox, dev, false);
 		break;
 	case SNDRV_PCM_TRIGGER_STOP:
@@ -698,6 +743,10 @@ static int abox_rdma_compr_trigger(struct snd_compr_stream *stream, int cmd)
 		}
 
 		data->start = false;
+		abox_rdma_compr_account(data, false);
+		dev_info(dev, "%s: %llu wakeups, %llu per minute\n", __func__,
+				data->wakeups,
+				abox_rdma_compr_wakeups_per_min(data));
 
 		/* reset */
 		data->stop_ack = 0;
@@ -716,6 +765,7 @@ static int abox_rdma_compr_trigger(struct snd_compr_stream *stream, int cmd)
 
 		abox_request_dram_on(platform_data->pdev_abox, dev, true);
 
+		abox_rdma_compr_account(data, true);
 		data->start = 1;
 		ret = abox_rdma_mailbox_send_cmd(dev, CMD_COMPR_START);
 		if (IS_ERR_VALUE(ret))
@@ -1110,7 +1160,8 @@ static const struct snd_pcm_hardware abox_rdma_hardware = {
 	.info			= SNDRV_PCM_INFO_INTERLEAVED
 				| SNDRV_PCM_INFO_BLOCK_TRANSFER
 				| SNDRV_PCM_INFO_MMAP
-				| SNDRV_PCM_INFO_MMAP_VALID,
+				| SNDRV_PCM_INFO_MMAP_VALID
+				| SNDRV_PCM_INFO_NO_PERIOD_WAKEUP,
 	.formats		= ABOX_SAMPLE_FORMATS,
 	.channels_min		= 1,
 	.channels_max		= 8,
@@ -1149,6 +1200,66 @@ static irqreturn_t abox_rdma_irq_handler(int irq, void *dev_id,
 	return IRQ_HANDLED;
 }
 
+static unsigned int dl_runtime_pct;
+module_param(dl_runtime_pct, uint, 0644);
+MODULE_PARM_DESC(dl_runtime_pct,
+		"Run SCHED_FIFO/RR stream threads as SCHED_DEADLINE with this % of the period (0: off)");
+
+/*
+ * The thread which sets up a low latency stream is the one which feeds it
+ * (audio HAL, AAudio/fast mixer). It is moved from FIFO to a DEADLINE
+ * reservation with the ABOX period as its period and deadline. It sleeps
+ * on the period interrupt, and a DEADLINE task waking after its deadline
+ * gets a new one from the wake up, so the reservation follows the
+ * interrupt instead of drifting against it.
+ */
+static void abox_rdma_dl_reserve(struct device *dev,
+		struct abox_platform_data *data, struct snd_pcm_hw_params *params)
+{
+	struct sched_attr attr = { .size = sizeof(attr) };
+	u64 period;
+	int ret;
+
+	if (!dl_runtime_pct || data->dl_task || !rt_task(current))
+		return;
+
+	period = div_u64((u64)params_period_size(params) * NSEC_PER_SEC,
+			params_rate(params));
+	attr.sched_policy = SCHED_DEADLINE;
+	attr.sched_period = attr.sched_deadline = period;
+	attr.sched_runtime = div_u64(period * min(dl_runtime_pct, 100U), 100);
+
+	data->dl_old_policy = current->policy;
+	data->dl_old_prio = current->rt_priority;
+	ret = sched_setattr(current, &attr);
+	if (ret < 0) {
+		dev_warn(dev, "%s[%d]: deadline %lluns/%lluns refused: %d\n",
+				__func__, current->pid, attr.sched_runtime,
+				period, ret);
+		return;
+	}
+
+	get_task_struct(current);
+	data->dl_task = current;
+	dev_info(dev, "%s[%d]: deadline %lluns/%lluns\n", __func__,
+			current->pid, attr.sched_runtime, period);
+}
+
+static void abox_rdma_dl_release(struct abox_platform_data *data)
+{
+	struct sched_param param = { .sched_priority = data->dl_old_prio };
+	struct task_struct *p = data->dl_task;
+
+	if (!p)
+		return;
+
+	/* unless someone else changed it meanwhile */
+	if (p->policy == SCHED_DEADLINE)
+		sched_setscheduler_nocheck(p, data->dl_old_policy, &param);
+	put_task_struct(p);
+	data->dl_task = NULL;
+}
+
 static int abox_rdma_hw_params(struct snd_pcm_substream *substream,
 	struct snd_pcm_hw_params *params)
 {
@@ -1192,6 +1303,18 @@ static int abox_rdma_hw_params(struct snd_pcm_substream *substream,
 	pcmtask_msg->param.setbuff.count = params_periods(params);
 	abox_rdma_request_ipc(dev, msg.ipcid, &msg, sizeof(msg), 0, 1);
 
+	if (data->pos_area) {
+		memset(data->pos_area, 0, sizeof(*data->pos_area));
+		pcmtask_msg->msgtype = PCM_SET_POSITION;
+		pcmtask_msg->param.setpos.phyaddr = IOVA_RDMA_POSITION(id);
+		pcmtask_msg->param.setpos.size = sizeof(*data->pos_area);
+		/* runtime->no_period_wakeup is only set after this returns */
+		pcmtask_msg->param.setpos.no_irq =
+			(params->info & SNDRV_PCM_INFO_NO_PERIOD_WAKEUP) &&
+			(params->flags & SNDRV_PCM_HW_PARAMS_NO_PERIOD_WAKEUP);
+		abox_rdma_request_ipc(dev, msg.ipcid, &msg, sizeof(msg), 0, 1);
+	}
+
 	pcmtask_msg->msgtype = PCM_PLTDAI_HW_PARAMS;
 	pcmtask_msg->param.hw_params.sample_rate = params_rate(params);
 	pcmtask_msg->param.hw_params.bit_depth = params_width(params);
@@ -1209,6 +1332,8 @@ static int abox_rdma_hw_params(struct snd_pcm_substream *substream,
 	abox_request_big_freq_dai(dev, data->abox_data, rtd->cpu_dai, big);
 	abox_request_hmp_boost_dai(dev, data->abox_data, rtd->cpu_dai, hmp);
 
+	abox_rdma_dl_reserve(dev, data, params);
+
 	dev_info(dev, "%s:Total=%zu PrdSz=%u(%u) #Prds=%u rate=%u, width=%d, channels=%u\n",
 			snd_pcm_stream_str(substream), runtime->dma_bytes,
 			params_period_size(params), params_period_bytes(params),
@@ -1245,6 +1370,8 @@ static int abox_rdma_hw_free(struct snd_pcm_substream *substream)
 	abox_request_big_freq_dai(dev, data->abox_data, rtd->cpu_dai, 0);
 	abox_request_hmp_boost_dai(dev, data->abox_data, rtd->cpu_dai, 0);
 
+	abox_rdma_dl_release(data);
+
 	return snd_pcm_lib_free_pages(substream);
 }
 
@@ -1275,6 +1402,8 @@ static int abox_rdma_prepare(struct snd_pcm_substream *substream)
 			sizeof(msg), 0, 1);
 
 	data->pointer = IOVA_RDMA_BUFFER(id);
+	if (data->pos_area)
+		memset(data->pos_area, 0, sizeof(*data->pos_area));
 
 	return result;
 }
@@ -1335,6 +1464,33 @@ static int abox_rdma_trigger(struct snd_pcm_substream *substream, int cmd)
 	return result;
 }
 
+/* Read the position published by the firmware in the shared block.
+ * Returns false until the firmware has written it once, or if it is
+ * stuck in the middle of an update.
+ */
+static bool abox_rdma_read_position(struct abox_platform_data *data,
+		ssize_t *pointer)
+{
+	struct ABOX_PCM_POSITION *pos = data->pos_area;
+	unsigned int seq, retry = 3;
+
+	if (!pos)
+		return false;
+
+	do {
+		seq = READ_ONCE(pos->seq);
+		if (!seq)
+			return false;
+		rmb();
+		*pointer = READ_ONCE(pos->position);
+		rmb();
+		if (!(seq & 1) && seq == READ_ONCE(pos->seq))
+			return true;
+	} while (--retry);
+
+	return false;
+}
+
 static snd_pcm_uframes_t abox_rdma_pointer(struct snd_pcm_substream *substream)
 {
 	struct snd_soc_pcm_runtime *rtd = substream->private_data;
@@ -1347,7 +1503,9 @@ static snd_pcm_uframes_t abox_rdma_pointer(struct snd_pcm_substream *substream)
 	u32 status = readl(data->sfr_base + ABOX_RDMA_STATUS);
 	bool progress = (status & ABOX_RDMA_PROGRESS_MASK) ? true : false;
 
-	if (data->pointer >= IOVA_RDMA_BUFFER(id)) {
+	if (abox_rdma_read_position(data, &pointer)) {
+		/* firmware keeps the shared block up to date */
+	} else if (data->pointer >= IOVA_RDMA_BUFFER(id)) {
 		pointer = data->pointer - IOVA_RDMA_BUFFER(id);
 	} else if (((data->type == PLATFORM_NORMAL) ||
 			(data->type == PLATFORM_SYNC)) && progress) {
@@ -1495,6 +1653,66 @@ static struct snd_pcm_ops abox_rdma_ops = {
 	.mmap		= abox_rdma_mmap,
 };
 
+/*
+ * The shared position block is exported read-only through a hwdep node,
+ * so an exclusive MMAP client can follow the DMA without any syscall.
+ */
+static int abox_rdma_pos_mmap(struct snd_hwdep *hw, struct file *file,
+		struct vm_area_struct *vma)
+{
+	struct abox_platform_data *data = hw->private_data;
+	struct device *dev = &data->pdev_abox->dev;
+
+	if (vma->vm_end - vma->vm_start > PAGE_SIZE || vma->vm_pgoff)
+		return -EINVAL;
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+	vma->vm_flags &= ~VM_MAYWRITE;
+
+	return dma_mmap_coherent(dev, vma, data->pos_area, data->pos_addr,
+			PAGE_SIZE);
+}
+
+static int abox_rdma_new_position(struct snd_soc_pcm_runtime *runtime)
+{
+	struct snd_pcm *pcm = runtime->pcm;
+	struct device *dev = runtime->platform->dev;
+	struct abox_platform_data *data = dev_get_drvdata(dev);
+	struct device *dev_abox = &data->pdev_abox->dev;
+	struct snd_hwdep *hw;
+	int result;
+
+	data->pos_area = dmam_alloc_coherent(dev_abox, PAGE_SIZE,
+			&data->pos_addr, GFP_KERNEL);
+	if (!data->pos_area)
+		return -ENOMEM;
+
+	result = iommu_map(data->abox_data->iommu_domain,
+			IOVA_RDMA_POSITION(data->id), data->pos_addr,
+			PAGE_SIZE, 0);
+	if (IS_ERR_VALUE(result))
+		goto err;
+
+	result = snd_hwdep_new(runtime->card->snd_card, "ABOX RDMA position",
+			pcm->device, &hw);
+	if (IS_ERR_VALUE(result)) {
+		iommu_unmap(data->abox_data->iommu_domain,
+				IOVA_RDMA_POSITION(data->id), PAGE_SIZE);
+		goto err;
+	}
+	snprintf(hw->name, sizeof(hw->name), "ABOX RDMA%d position",
+			data->id);
+	hw->private_data = data;
+	hw->ops.mmap = abox_rdma_pos_mmap;
+
+	return 0;
+err:
+	dmam_free_coherent(dev_abox, PAGE_SIZE, data->pos_area,
+			data->pos_addr);
+	data->pos_area = NULL;
+	return result;
+}
+
 static int abox_rdma_new(struct snd_soc_pcm_runtime *runtime)
 {
 	struct snd_pcm *pcm = runtime->pcm;
@@ -1525,6 +1743,9 @@ static int abox_rdma_new(struct snd_soc_pcm_runtime *runtime)
 				substream->dma_buffer.addr,
 				BUFFER_BYTES_MAX, 0);
 #endif
+		/* playback keeps working from the SFR without it */
+		if (IS_ERR_VALUE(abox_rdma_new_position(runtime)))
+			dev_warn(dev, "no shared position block\n");
 	}
 
 	return result;
@@ -1532,7 +1753,6 @@ static int abox_rdma_new(struct snd_soc_pcm_runtime *runtime)
 
 static void abox_rdma_free(struct snd_pcm *pcm)
 {
-#ifdef USE_FIXED_MEMORY
 	struct snd_pcm_substream *substream = pcm->streams[STR].substream;
 	struct snd_soc_pcm_runtime *runtime = substream->private_data;
 	struct snd_soc_platform *platform = runtime->platform;
@@ -1540,9 +1760,13 @@ static void abox_rdma_free(struct snd_pcm *pcm)
 	struct abox_platform_data *data = dev_get_drvdata(dev);
 	int id = data->id;
 
+#ifdef USE_FIXED_MEMORY
 	iommu_unmap(data->abox_data->iommu_domain, IOVA_RDMA_BUFFER(id),
 			BUFFER_BYTES_MAX);
 #endif
+	if (data->pos_area)
+		iommu_unmap(data->abox_data->iommu_domain,
+				IOVA_RDMA_POSITION(id), PAGE_SIZE);
 	snd_pcm_lib_preallocate_free_for_all(pcm);
 }
 
@@ -1614,6 +1838,20 @@ struct snd_soc_platform_driver abox_rdma = {
 	.pcm_free	= abox_rdma_free,
 };
 
+static ssize_t compr_stats_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct abox_platform_data *platform_data = dev_get_drvdata(dev);
+	struct abox_compr_data *data = &platform_data->compr_data;
+
+	return scnprintf(buf, PAGE_SIZE,
+			"watermark: %u\nwakeups: %llu\nwakeups_per_min: %llu\n",
+			data->watermark, data->wakeups,
+			abox_rdma_compr_wakeups_per_min(data));
+}
+
+static DEVICE_ATTR_RO(compr_stats);
+
 static int samsung_abox_rdma_probe(struct platform_device *pdev)
 {
 	struct device *dev = &pdev->dev;
@@ -1678,6 +1916,13 @@ static int samsung_abox_rdma_probe(struct platform_device *pdev)
 	else
 		data->type = PLATFORM_NORMAL;
 
+	if (data->type == PLATFORM_COMPRESS) {
+		result = device_create_file(dev, &dev_attr_compr_stats);
+		if (IS_ERR_VALUE(result))
+			dev_warn(dev, "Failed to create file: %s\n",
+					"compr_stats");
+	}
+
 	data->quirks = abox_probe_quirks(np);
 
 	result = of_property_read_u32_array(np, "pm_qos_lit", data->pm_qos_lit,
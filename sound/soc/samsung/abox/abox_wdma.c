@@ -28,6 +28,7 @@
 
 #include "../../../../drivers/iommu/exynos-iommu.h"
 #include <sound/samsung/abox.h>
+#include <sound/samsung/vts.h>
 #include "abox_util.h"
 #include "abox_gic.h"
 #include "abox.h"
@@ -197,6 +198,30 @@ static int abox_wdma_prepare(struct snd_pcm_substream *substream)
 	return result;
 }
 
+/*
+ * A capture which follows a voice trigger is spliced after the VTS history
+ * by userspace, which maps the history instead of copying it. Report where
+ * the history ends relative to the capture start, so that any gap shows up.
+ */
+static void abox_wdma_report_vts_history(struct device *dev,
+		struct abox_platform_data *data)
+{
+	struct platform_device *pdev_vts = data->abox_data->pdev_vts;
+	struct vts_history history;
+	ktime_t now = ktime_get();
+
+	if (!pdev_vts || vts_get_history(pdev_vts, &history) < 0)
+		return;
+
+	/* stale history of an earlier trigger */
+	if (ktime_ms_delta(now, history.trigger) > MSEC_PER_SEC * 5)
+		return;
+
+	dev_info(dev, "VTS history %zu bytes at %zu, capture starts %lldus after it\n",
+			history.bytes, history.pos,
+			ktime_us_delta(now, history.tstamp));
+}
+
 static int abox_wdma_trigger(struct snd_pcm_substream *substream, int cmd)
 {
 	struct snd_soc_pcm_runtime *rtd = substream->private_data;
@@ -223,6 +248,9 @@ static int abox_wdma_trigger(struct snd_pcm_substream *substream, int cmd)
 		if (memblock_is_memory(runtime->dma_addr))
 			abox_request_dram_on(data->pdev_abox, dev, true);
 
+		if (cmd == SNDRV_PCM_TRIGGER_START)
+			abox_wdma_report_vts_history(dev, data);
+
 		pcmtask_msg->param.trigger = 1;
 		result = abox_request_ipc(dev_abox,
 				msg.ipcid, &msg, sizeof(msg), 1, 0);
@@ -553,6 +553,30 @@ volatile bool vts_is_recognitionrunning(void)
 }
 EXPORT_SYMBOL(vts_is_recognitionrunning);
 
+int vts_get_history(struct platform_device *pdev, struct vts_history *history)
+{
+	struct vts_data *data = platform_get_drvdata(pdev);
+	struct vts_platform_data *platform_data;
+
+	if (!data || !data->pdev_vtsdma[0])
+		return -ENODEV;
+
+	platform_data = platform_get_drvdata(data->pdev_vtsdma[0]);
+	if (!data->history_bytes)
+		return -ENODATA;
+
+	history->area = data->dmab.area;
+	history->addr = data->dmab.addr;
+	history->size = data->dmab.bytes;
+	history->pos = platform_data->pointer;
+	history->bytes = data->history_bytes;
+	history->trigger = data->trigger_tstamp;
+	history->tstamp = data->history_tstamp;
+
+	return 0;
+}
+EXPORT_SYMBOL(vts_get_history);
+
 static struct snd_soc_dai_driver vts_dai[] = {
 	{
 		.name = "vts-tri",
@@ -1326,6 +1350,9 @@ static irqreturn_t vts_voice_triggered_handler(int irq, void *dev_id)
 			dev_warn(dev, "Unknown VTS Execution Mode!!\n");
 		}
 
+		data->trigger_tstamp = ktime_get();
+		data->history_bytes = 0;
+
 		kobject_uevent_env(&dev->kobj, KOBJ_CHANGE, envp);
 		wake_lock_timeout(&data->wake_lock,
 				VTS_TRIGGERED_TIMEOUT_MS);
@@ -1351,9 +1378,14 @@ static irqreturn_t vts_trigger_period_elapsed_handler(int irq, void *dev_id)
 			 __func__, (platform_data->id ? "VTS-RECORD" :
 			 "VTS-TRIGGER"), data->dma_area_vts, pointer);
 
-		if (pointer)
-			platform_data->pointer = (pointer -
-					 data->dma_area_vts);
+		if (pointer) {
+			u32 offset = pointer - data->dma_area_vts;
+
+			data->history_bytes += (offset + data->dmab.bytes -
+					platform_data->pointer) % data->dmab.bytes;
+			data->history_tstamp = ktime_get();
+			platform_data->pointer = offset;
+		}
 		vts_ipc_ack(data, 1);
 
 
@@ -2146,9 +2178,9 @@ static int samsung_vts_probe(struct platform_device *pdev)
 		result = -ENOMEM;
 		goto error;
 	}
-	data->dmab.bytes = LOG_BUFFER_BYTES_MAX;
-	data->dmab.dev.dev = dev;
-	data->dmab.dev.type = SNDRV_DMA_TYPE_DEV;
+	data->dmab_log.bytes = LOG_BUFFER_BYTES_MAX;
+	data->dmab_log.dev.dev = dev;
+	data->dmab_log.dev.type = SNDRV_DMA_TYPE_DEV;
 
 	data->clk_rco = devm_clk_get_and_prepare(dev, "rco");
 	if (IS_ERR(data->clk_rco)) {
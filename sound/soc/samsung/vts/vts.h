@@ -284,6 +284,10 @@ struct vts_data {
 	struct snd_dma_buffer dmab;
 	struct snd_dma_buffer dmab_rec;
 	struct snd_dma_buffer dmab_log;
+	/* trigger history copy, see vts_get_history() */
+	ktime_t trigger_tstamp;
+	ktime_t history_tstamp;
+	u32 history_bytes;
 	u32 target_size;
 	volatile enum trigger active_trigger;
 	u32 voicerecog_start;
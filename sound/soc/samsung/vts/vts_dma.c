@@ -116,6 +116,7 @@ static int vts_platform_trigger(struct snd_pcm_substream *substream, int cmd)
 	case SNDRV_PCM_TRIGGER_PAUSE_RELEASE:
 		if (data->type == PLATFORM_VTS_TRIGGER_RECORD) {
 			dev_dbg(dev, "%s VTS_IRQ_AP_START_COPY\n", __func__);
+			data->vts_data->history_bytes = 0;
 			result = vts_start_ipc_transaction(dev, data->vts_data, VTS_IRQ_AP_START_COPY, &values, 1, 1);
 		} else {
 			dev_dbg(dev, "%s VTS_IRQ_AP_START_REC\n", __func__);